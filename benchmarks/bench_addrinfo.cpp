@@ -0,0 +1,68 @@
+// FakeIP 解析结果构造基准：系统 getaddrinfo/freeaddrinfo 解析虚拟 IP 字面量（旧路径）
+// vs AddrInfoBuilder 在池块中直接构造 + 归还（新路径）
+// 用法：antigravity_bench_addrinfo [迭代次数]（默认 200000）
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#ifdef _WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#else
+#include <arpa/inet.h>
+#include <netdb.h>
+#endif
+
+#include "network/AddrInfoBuilder.hpp"
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    template <typename Fn>
+    double NsPerOp(int iterations, Fn&& fn) {
+        const auto t0 = Clock::now();
+        for (int i = 0; i < iterations; i++) fn();
+        return std::chrono::duration<double, std::nano>(Clock::now() - t0).count() / iterations;
+    }
+}
+
+int main(int argc, char** argv) {
+    const int iterations = argc > 1 ? std::atoi(argv[1]) : 200000;
+#ifdef _WIN32
+    WSADATA wsa;
+    if (WSAStartup(MAKEWORD(2, 2), &wsa) != 0) return 1;
+#endif
+    const uint32_t ip = inet_addr("198.18.0.5");
+    const int families[] = {AF_INET, AF_INET6};
+    for (int family : families) {
+        addrinfo hints{};
+        hints.ai_family = family;
+        hints.ai_socktype = SOCK_STREAM;
+        const char* literal = family == AF_INET6 ? "::ffff:198.18.0.5" : "198.18.0.5";
+        int failures = 0;
+
+        const double system = NsPerOp(iterations, [&]() {
+            addrinfo* result = nullptr;
+            if (getaddrinfo(literal, "443", &hints, &result) != 0) {
+                failures++;
+                return;
+            }
+            freeaddrinfo(result);
+        });
+        auto& pool = Network::AddrInfoPool::Instance();
+        const double built = NsPerOp(iterations, [&]() {
+            addrinfo* result = nullptr;
+            if (!Network::AddrInfoBuilder::Build(pool, ip, 443, &hints, "api.example.com", false, &result)) {
+                failures++;
+                return;
+            }
+            pool.Release(result);
+        });
+        std::printf("family=%s system getaddrinfo: %.0f ns/op | builder: %.0f ns/op | speedup %.1fx failures=%d\n",
+                    family == AF_INET6 ? "AF_INET6" : "AF_INET", system, built, system / built, failures);
+    }
+#ifdef _WIN32
+    WSACleanup();
+#endif
+    return 0;
+}
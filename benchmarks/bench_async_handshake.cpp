@@ -0,0 +1,179 @@
+// 并发握手基准：阻塞握手占用工作线程（IOCP 完成回调里同步握手的模型）对比 epoll 驱动的非阻塞状态机
+// 用法：antigravity_bench_async_handshake [并发数] [单程延迟ms] [阻塞线程数] [协议 socks5|pipelined|http]
+//       （默认 10000 10 16 socks5）
+// 代理替身（benchmarks/epoll_proxy_stand_in.hpp）运行在 fork 出的子进程里，两侧各自占用一半 fd 配额。
+// 两种方式使用同一个 Network::ProxyHandshake 状态机，只有 I/O 方式不同：
+// - blocking：T 个线程，每个线程依次阻塞完成握手（同一时刻最多 T 个握手在途）
+// - epoll   ：1 个线程，全部握手同时在途
+#include <signal.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "epoll_handshake_driver.hpp"
+#include "epoll_proxy_stand_in.hpp"
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+    using Network::ProxyHandshake;
+
+    void RaiseFdLimit() {
+        rlimit lim{};
+        if (getrlimit(RLIMIT_NOFILE, &lim) == 0 && lim.rlim_cur < lim.rlim_max) {
+            lim.rlim_cur = lim.rlim_max;
+            setrlimit(RLIMIT_NOFILE, &lim);
+        }
+    }
+
+    // 阻塞 I/O 驱动同一个状态机
+    bool BlockingHandshake(uint16_t proxyPort, ProxyHandshake::Protocol protocol) {
+        const int fd = socket(AF_INET, SOCK_STREAM, 0);
+        if (fd < 0) return false;
+        int one = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        addr.sin_port = htons(proxyPort);
+        ProxyHandshake hs;
+        bool ok = connect(fd, (sockaddr*)&addr, sizeof(addr)) == 0 && hs.Start(protocol, "example.com", 443);
+        while (ok) {
+            const ProxyHandshake::Want want = hs.Next();
+            if (want == ProxyHandshake::Want::Done || want == ProxyHandshake::Want::Failed) break;
+            if (want == ProxyHandshake::Want::Send) {
+                const ssize_t n = send(fd, hs.SendData(), hs.SendSize(), MSG_NOSIGNAL);
+                if (n <= 0) ok = false;
+                else hs.OnSent((size_t)n);
+                continue;
+            }
+            const bool peek = want == ProxyHandshake::Want::Peek;
+            const ssize_t n = recv(fd, hs.RecvBuffer(), hs.RecvSize(), peek ? MSG_PEEK : 0);
+            if (n < 0) ok = false;
+            else if (peek) hs.OnPeeked((size_t)n);
+            else hs.OnReceived((size_t)n);
+        }
+        close(fd);
+        return ok && hs.Next() == ProxyHandshake::Want::Done;
+    }
+
+    struct Summary {
+        double wallMs = 0;
+        double p50Ms = 0;
+        double p99Ms = 0;
+        int failures = 0;
+    };
+
+    void Percentiles(std::vector<double>& latUs, Summary* s) {
+        std::sort(latUs.begin(), latUs.end());
+        if (latUs.empty()) return;
+        s->p50Ms = latUs[latUs.size() / 2] / 1000.0;
+        s->p99Ms = latUs[latUs.size() * 99 / 100] / 1000.0;
+    }
+
+    Summary RunBlocking(uint16_t port, ProxyHandshake::Protocol protocol, int count, int threads) {
+        std::atomic<int> next{0};
+        std::atomic<int> failures{0};
+        std::vector<std::vector<double>> lat((size_t)threads);
+        const auto t0 = Clock::now();
+        std::vector<std::thread> workers;
+        for (int t = 0; t < threads; t++) {
+            workers.emplace_back([&, t]() {
+                while (next.fetch_add(1) < count) {
+                    const auto s = Clock::now();
+                    if (!BlockingHandshake(port, protocol)) failures.fetch_add(1);
+                    lat[(size_t)t].push_back(std::chrono::duration<double, std::micro>(Clock::now() - s).count());
+                }
+            });
+        }
+        for (auto& w : workers) w.join();
+        Summary sum;
+        sum.wallMs = std::chrono::duration<double, std::milli>(Clock::now() - t0).count();
+        sum.failures = failures.load();
+        std::vector<double> all;
+        for (auto& v : lat) all.insert(all.end(), v.begin(), v.end());
+        Percentiles(all, &sum);
+        return sum;
+    }
+
+    Summary RunEpoll(uint16_t port, ProxyHandshake::Protocol protocol, int count) {
+        BenchSupport::EpollHandshakeDriver driver;
+        const auto t0 = Clock::now();
+        for (int i = 0; i < count; i++) driver.Add(port, protocol, "example.com", 443);
+        driver.Run(120000);
+        Summary sum;
+        sum.wallMs = std::chrono::duration<double, std::milli>(Clock::now() - t0).count();
+        std::vector<double> lat;
+        for (const auto& r : driver.Results()) {
+            if (!r.ok) sum.failures++;
+            else lat.push_back(r.latencyUs);
+        }
+        Percentiles(lat, &sum);
+        return sum;
+    }
+
+    void Print(const char* name, int count, const Summary& s) {
+        std::printf("  %-22s %6d handshakes in %8.1f ms (%9.0f/s), p50 %7.1f ms, p99 %7.1f ms, failures %d\n", name,
+                    count, s.wallMs, s.wallMs > 0 ? count * 1000.0 / s.wallMs : 0.0, s.p50Ms, s.p99Ms, s.failures);
+    }
+}
+
+int main(int argc, char** argv) {
+    const int count = argc > 1 ? std::max(1, std::atoi(argv[1])) : 10000;
+    const int oneWayMs = argc > 2 ? std::max(0, std::atoi(argv[2])) : 10;
+    const int threads = argc > 3 ? std::max(1, std::atoi(argv[3])) : 16;
+    const std::string proto = argc > 4 ? argv[4] : "socks5";
+    const ProxyHandshake::Protocol protocol = proto == "http"        ? ProxyHandshake::Protocol::Http
+                                              : proto == "pipelined" ? ProxyHandshake::Protocol::Socks5Pipelined
+                                                                     : ProxyHandshake::Protocol::Socks5;
+    RaiseFdLimit();
+
+    // 子进程运行代理替身，通过管道把端口交给父进程
+    int pipeFds[2];
+    if (pipe(pipeFds) != 0) return 1;
+    const pid_t child = fork();
+    if (child < 0) return 1;
+    if (child == 0) {
+        close(pipeFds[0]);
+        BenchSupport::EpollProxyStandIn proxy;
+        BenchSupport::EpollProxyStandIn::Options options;
+        options.oneWayDelayMs = oneWayMs;
+        uint16_t port = proxy.Listen(options) ? proxy.Port() : 0;
+        (void)!write(pipeFds[1], &port, sizeof(port));
+        close(pipeFds[1]);
+        if (port != 0) proxy.Run();
+        _exit(0);
+    }
+    close(pipeFds[1]);
+    uint16_t port = 0;
+    if (read(pipeFds[0], &port, sizeof(port)) != (ssize_t)sizeof(port) || port == 0) {
+        std::fprintf(stderr, "stand-in proxy failed to start\n");
+        return 1;
+    }
+    close(pipeFds[0]);
+
+    // 阻塞方式按线程数限流，只跑一小部分即可看出吞吐上限
+    const int blockingCount = std::min(count, threads * 20);
+    std::printf("protocol=%s injected_rtt=%dms\n", proto.c_str(), oneWayMs * 2);
+    const Summary blocking = RunBlocking(port, protocol, blockingCount, threads);
+    const Summary async = RunEpoll(port, protocol, count);
+    char name[64];
+    std::snprintf(name, sizeof(name), "blocking (%d threads)", threads);
+    Print(name, blockingCount, blocking);
+    Print("epoll (1 thread)", count, async);
+
+    kill(child, SIGKILL);
+    waitpid(child, nullptr, 0);
+    return blocking.failures + async.failures == 0 ? 0 : 2;
+}
@@ -0,0 +1,100 @@
+// Debug 诊断单次调用开销基准：文本拼接（Logger::Debug 调用点的写法）vs 延迟格式化二进制记录（BinaryLog::Record）
+// 用法：antigravity_bench_binary_log [线程数...]（默认 1 4）
+// 两组都用 SOCKS5 握手日志的典型参数：socket 句柄、目标地址、端口、4 字节响应头十六进制转储。
+// - text：调用线程上完成 to_string / inet_ntop / 十六进制转储与字符串拼接（不含写文件，只是下限）
+// - binary：编码格式 id、时间戳与原始参数写入本线程缓冲，并摊入周期性写 .blog 文件的开销
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "core/BinaryLog.hpp"
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+    constexpr int kCallsPerThread = 200000;
+    const char* kPath = "antigravity_bench_binary_log.blog";
+
+    std::string SockaddrToString(const sockaddr* addr) {
+        const auto* addr4 = (const sockaddr_in*)addr;
+        char buf[INET_ADDRSTRLEN] = {};
+        if (!inet_ntop(AF_INET, &addr4->sin_addr, buf, sizeof(buf))) return "";
+        return std::string(buf) + ":" + std::to_string(ntohs(addr4->sin_port));
+    }
+
+    std::string HexDump(const uint8_t* data, size_t len) {
+        static const char* kHex = "0123456789ABCDEF";
+        std::string out;
+        for (size_t i = 0; i < len; i++) {
+            if (i) out.push_back(' ');
+            out.push_back(kHex[data[i] >> 4]);
+            out.push_back(kHex[data[i] & 0xF]);
+        }
+        return out;
+    }
+
+    template <typename Fn>
+    double RunThreads(unsigned threadCount, Fn&& logOne) {
+        std::vector<double> perThreadNs(threadCount);
+        std::vector<std::thread> threads;
+        for (unsigned t = 0; t < threadCount; t++) {
+            threads.emplace_back([&, t]() {
+                const auto t0 = Clock::now();
+                for (int i = 0; i < kCallsPerThread; i++) logOne(i);
+                perThreadNs[t] = std::chrono::duration<double, std::nano>(Clock::now() - t0).count() / kCallsPerThread;
+            });
+        }
+        for (auto& th : threads) th.join();
+        double sum = 0;
+        for (double v : perThreadNs) sum += v;
+        return sum / threadCount;
+    }
+}
+
+int main(int argc, char** argv) {
+    std::vector<unsigned> threadCounts;
+    for (int i = 1; i < argc; i++) threadCounts.push_back((unsigned)std::strtoul(argv[i], nullptr, 10));
+    if (threadCounts.empty()) threadCounts = {1, 4};
+
+    sockaddr_in dst{};
+    dst.sin_family = AF_INET;
+    dst.sin_port = htons(443);
+    dst.sin_addr.s_addr = htonl(0xC6120001);
+    const uint8_t header[4] = {0x05, 0x00, 0x00, 0x01};
+    const char* fmt = "SOCKS5: [3/3] 收到响应头, sock={}, dst={}, REP={}, bytes={}";
+
+    Core::BinaryLog& log = Core::BinaryLog::Instance();
+    const uint16_t id = log.Register(0, __FILE__, __LINE__, fmt,
+                                     decltype(Core::BinaryLog::SignatureOf(0ull, Core::BinaryLogAddr{nullptr}, header[1],
+                                                                           Core::BinaryLogHex{nullptr, 0}))::value);
+    size_t sink = 0;
+    for (unsigned n : threadCounts) {
+        const double textNs = RunThreads(n, [&](int i) {
+            const std::string line = "SOCKS5: [3/3] 收到响应头, sock=" + std::to_string((unsigned long long)(1000 + i)) +
+                                     ", dst=" + SockaddrToString((const sockaddr*)&dst) +
+                                     ", REP=" + std::to_string(header[1]) + ", bytes=" + HexDump(header, 4);
+            sink += line.size();
+        });
+
+        std::remove(kPath);
+        const uint64_t droppedBefore = log.DroppedCount();
+        log.Start([]() { return std::string(kPath); }, 1ull << 30);
+        const double binaryNs = RunThreads(n, [&](int i) {
+            log.Record(id, (unsigned long long)(1000 + i), Core::BinaryLogAddr{(const sockaddr*)&dst}, header[1],
+                       Core::BinaryLogHex{header, 4});
+            // 无间隔连续写入远超真实速率，写线程 50ms 一批来不及取；每 1024 条在调用线程上刷一次，
+            // 避免缓冲写满后测到的是丢弃路径。刷新（含写文件）耗时计入结果，按条摊薄
+            if ((i & 1023) == 1023) log.Flush();
+        });
+        log.Stop(true);
+        std::printf("threads=%u text: %.0f ns | binary: %.0f ns dropped=%llu | speedup %.1fx\n", n, textNs, binaryNs,
+                    (unsigned long long)(log.DroppedCount() - droppedBefore), textNs / binaryNs);
+    }
+    if (sink == SIZE_MAX) std::printf("%zu\n", sink);
+    std::remove(kPath);
+    return 0;
+}
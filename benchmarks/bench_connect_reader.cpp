@@ -0,0 +1,125 @@
+// HTTP CONNECT 响应头读取基准：旧的逐字节 recv + 每字节 find 对比 PeekReader（MSG_PEEK 后一次消费）
+// 用法：antigravity_bench_connect_reader [次数] [响应头字节数]（默认 20000 200）
+// 使用 AF_UNIX socketpair：写端一次写入“响应头 + 隧道首包”，读端读取响应头并校验首包未被吞掉。
+// 统计每次握手的 recv 系统调用次数与耗时。
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+#include "network/PeekReader.hpp"
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    const std::string kDelimiter = "\r\n\r\n";
+    const std::string kTunnelPayload = "\x16\x03\x01\x02\x00";
+
+    std::string BuildResponse(size_t targetBytes) {
+        std::string r = "HTTP/1.1 200 Connection established\r\nProxy-Agent: bench/1.0\r\n";
+        for (int i = 0; r.size() + kDelimiter.size() < targetBytes; i++) {
+            r += "X-Pad-" + std::to_string(i) + ": ";
+            r.append(std::min<size_t>(24, targetBytes - std::min(targetBytes, r.size() + 4)), 'p');
+            r += "\r\n";
+        }
+        return r + "\r\n";
+    }
+
+    // 与改动前 SocketIo::RecvUntil 相同的算法（POSIX 版）
+    bool LegacyRecvUntil(int fd, std::string* out, int maxBytes, long* syscalls) {
+        out->clear();
+        out->reserve((size_t)maxBytes);
+        while ((int)out->size() < maxBytes) {
+            char ch = '\0';
+            (*syscalls)++;
+            const ssize_t n = recv(fd, &ch, 1, 0);
+            if (n <= 0) return false;
+            out->push_back(ch);
+            if (out->size() >= kDelimiter.size() && out->find(kDelimiter) != std::string::npos) return true;
+        }
+        return false;
+    }
+
+    struct PosixIo {
+        int fd;
+        long* syscalls;
+        int Peek(char* buf, int len) {
+            (*syscalls)++;
+            return (int)recv(fd, buf, (size_t)len, MSG_PEEK);
+        }
+        int Take(char* buf, int len) {
+            (*syscalls)++;
+            return (int)recv(fd, buf, (size_t)len, 0);
+        }
+        bool WouldBlock() const { return errno == EAGAIN || errno == EWOULDBLOCK; }
+    };
+
+    bool PeekRecvUntil(int fd, std::string* out, int maxBytes, long* syscalls) {
+        PosixIo io{fd, syscalls};
+        out->resize((size_t)maxBytes);
+        size_t used = 0;
+        // 数据已全部写入，阻塞 socket 上不会出现 Wait 以外的等待
+        for (;;) {
+            const auto st = Network::PeekReader::ReadStep(io, &(*out)[0], (size_t)maxBytes, &used, kDelimiter);
+            if (st == Network::PeekReader::Step::Done) break;
+            if (st != Network::PeekReader::Step::Wait) return false;
+        }
+        out->resize(used);
+        return true;
+    }
+
+    struct Result {
+        double nsPerOp = 0;
+        double syscallsPerOp = 0;
+        bool ok = true;
+    };
+
+    template <typename Reader>
+    Result Run(int iterations, const std::string& response, Reader reader) {
+        int fds[2];
+        if (socketpair(AF_UNIX, SOCK_STREAM, 0, fds) != 0) return Result{0, 0, false};
+        const std::string wire = response + kTunnelPayload;
+        long syscalls = 0;
+        Result res;
+        std::string header;
+        double totalNs = 0;
+        char payload[16];
+        for (int i = 0; i < iterations && res.ok; i++) {
+            if (write(fds[1], wire.data(), wire.size()) != (ssize_t)wire.size()) res.ok = false;
+            const auto t0 = Clock::now();
+            if (!reader(fds[0], &header, 1024, &syscalls)) res.ok = false;
+            totalNs += std::chrono::duration<double, std::nano>(Clock::now() - t0).count();
+            // 隧道首包必须完整留在 socket 中
+            const ssize_t n = recv(fds[0], payload, sizeof(payload), 0);
+            if (header != response || n != (ssize_t)kTunnelPayload.size() ||
+                std::string(payload, (size_t)n) != kTunnelPayload) {
+                res.ok = false;
+            }
+        }
+        close(fds[0]);
+        close(fds[1]);
+        res.nsPerOp = totalNs / iterations;
+        res.syscallsPerOp = (double)syscalls / iterations;
+        return res;
+    }
+}
+
+int main(int argc, char** argv) {
+    const int iterations = argc > 1 ? std::max(1, std::atoi(argv[1])) : 20000;
+    const size_t headerBytes = argc > 2 ? (size_t)std::max(32, std::atoi(argv[2])) : 200;
+    const std::string response = BuildResponse(std::min<size_t>(headerBytes, 1000));
+
+    const Result legacy = Run(iterations, response, LegacyRecvUntil);
+    const Result peek = Run(iterations, response, PeekRecvUntil);
+    std::printf("iterations=%d header_bytes=%zu\n", iterations, response.size());
+    std::printf("  byte-at-a-time: %6.1f recv calls/handshake, %8.0f ns/handshake%s\n", legacy.syscallsPerOp,
+                legacy.nsPerOp, legacy.ok ? "" : "  (VERIFY FAILED)");
+    std::printf("  peek reader   : %6.1f recv calls/handshake, %8.0f ns/handshake%s\n", peek.syscallsPerOp,
+                peek.nsPerOp, peek.ok ? "" : "  (VERIFY FAILED)");
+    return legacy.ok && peek.ok ? 0 : 1;
+}
@@ -0,0 +1,115 @@
+// 并发解析合并基准：64 线程同时解析同一个新名字（浏览器连接风暴），对比 DnsCache 不合并 / 合并两种模式
+// 用法：antigravity_bench_dns_coalesce [线程数] [轮数] [解析延迟ms] [解析并发上限]（默认 64 20 20 4）
+// 解析后端为假解析器：固定延迟模拟一次 DNS 往返，同时最多处理“并发上限”个请求（模拟系统解析服务的
+// 有限工作线程，超出部分排队），并统计实际调用次数。
+// 每轮换一个新名字保证缓存未命中；所有线程在同一起跑线等待后同时发起，统计调用方看到的耗时（avg / p99）。
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "network/DnsCache.hpp"
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    struct Result {
+        int resolverCalls = 0;
+        double avgUs = 0;
+        double p99Us = 0;
+        uint64_t coalesced = 0;
+    };
+
+    Result Run(int threads, int rounds, int delayMs, int concurrency, bool coalesce) {
+        std::atomic<int> calls{0};
+        std::mutex slotMtx;
+        std::condition_variable slotCv;
+        int busy = 0;
+        Network::DnsCache cache([&](const std::string&, int, std::vector<sockaddr_storage>* out) {
+            calls.fetch_add(1);
+            {
+                std::unique_lock<std::mutex> lock(slotMtx);
+                slotCv.wait(lock, [&]() { return busy < concurrency; });
+                busy++;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(delayMs));
+            {
+                std::lock_guard<std::mutex> lock(slotMtx);
+                busy--;
+            }
+            slotCv.notify_one();
+            sockaddr_storage ss{};
+            reinterpret_cast<sockaddr_in*>(&ss)->sin_family = AF_INET;
+            out->push_back(ss);
+            return 0;
+        });
+        Network::DnsCache::Options options;
+        options.coalesceWaitMs = coalesce ? 5000 : 0;
+        cache.Configure(options);
+
+        std::vector<double> samples;
+        std::mutex samplesMtx;
+        for (int r = 0; r < rounds; r++) {
+            const std::string name = "burst" + std::to_string(r) + ".example.com";
+            std::mutex startMtx;
+            std::condition_variable startCv;
+            bool go = false;
+            std::vector<std::thread> workers;
+            for (int t = 0; t < threads; t++) {
+                workers.emplace_back([&]() {
+                    {
+                        std::unique_lock<std::mutex> lock(startMtx);
+                        startCv.wait(lock, [&]() { return go; });
+                    }
+                    sockaddr_storage addr{};
+                    int len = 0;
+                    int err = 0;
+                    const auto t0 = Clock::now();
+                    cache.Resolve(name, AF_INET, 443, &addr, &len, &err);
+                    const double us = std::chrono::duration<double, std::micro>(Clock::now() - t0).count();
+                    std::lock_guard<std::mutex> lock(samplesMtx);
+                    samples.push_back(us);
+                });
+            }
+            {
+                std::lock_guard<std::mutex> lock(startMtx);
+                go = true;
+            }
+            startCv.notify_all();
+            for (auto& w : workers) w.join();
+        }
+
+        std::sort(samples.begin(), samples.end());
+        Result res;
+        res.resolverCalls = calls.load();
+        double sum = 0;
+        for (double v : samples) sum += v;
+        res.avgUs = samples.empty() ? 0 : sum / samples.size();
+        res.p99Us = samples.empty() ? 0 : samples[samples.size() * 99 / 100];
+        res.coalesced = cache.GetStats().coalesced;
+        return res;
+    }
+}
+
+int main(int argc, char** argv) {
+    const int threads = argc > 1 ? std::atoi(argv[1]) : 64;
+    const int rounds = argc > 2 ? std::atoi(argv[2]) : 20;
+    const int delayMs = argc > 3 ? std::atoi(argv[3]) : 20;
+    const int concurrency = argc > 4 ? std::max(1, std::atoi(argv[4])) : 4;
+
+    const Result plain = Run(threads, rounds, delayMs, concurrency, false);
+    const Result merged = Run(threads, rounds, delayMs, concurrency, true);
+    std::printf("threads=%d rounds=%d resolver_delay=%dms resolver_concurrency=%d\n", threads, rounds, delayMs,
+                concurrency);
+    std::printf("  no coalescing: resolver calls %d, avg %.0f us, p99 %.0f us\n", plain.resolverCalls, plain.avgUs,
+                plain.p99Us);
+    std::printf("  singleflight : resolver calls %d, avg %.0f us, p99 %.0f us, coalesced %llu\n", merged.resolverCalls,
+                merged.avgUs, merged.p99Us, (unsigned long long)merged.coalesced);
+    return 0;
+}
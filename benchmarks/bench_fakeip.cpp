@@ -0,0 +1,209 @@
+// FakeIP 反向查询吞吐基准：旧版（全局 mutex + unordered_map）vs 槽位表（顺序锁，读端无锁）
+// 用法：antigravity_bench_fakeip [读线程数...]（默认 1 2 4 8）
+// 场景：一个写线程持续按 Ring Buffer 分配新域名，N 个读线程随机查询已分配地址，
+// 模拟多个 IOCP 工作线程在 connect 时并发调用 GetDomain。
+// 另附 10 万域名场景：旧版双 unordered_map vs 稠密槽位 + arena + 开放寻址索引的
+// 常驻内存（按 operator new 统计）与单线程正/反向查询延迟。
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <new>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "network/FakeIpTable.hpp"
+
+// 统计常驻堆字节数（每块前置 16 字节记录大小，仅基准进程内生效）
+static size_t g_liveBytes = 0;
+
+void* operator new(size_t size) {
+    void* raw = std::malloc(size + 16);
+    if (!raw) throw std::bad_alloc();
+    *static_cast<size_t*>(raw) = size;
+    g_liveBytes += size;
+    return static_cast<char*>(raw) + 16;
+}
+
+void* operator new[](size_t size) { return operator new(size); }
+
+void operator delete(void* p) noexcept {
+    if (!p) return;
+    void* raw = static_cast<char*>(p) - 16;
+    g_liveBytes -= *static_cast<size_t*>(raw);
+    std::free(raw);
+}
+
+void operator delete[](void* p) noexcept { operator delete(p); }
+void operator delete(void* p, size_t) noexcept { operator delete(p); }
+void operator delete[](void* p, size_t) noexcept { operator delete(p); }
+
+namespace {
+    constexpr uint32_t kPoolSize = 1u << 17; // 默认 /15
+    constexpr uint32_t kLiveDomains = 8192;
+    constexpr int kDurationMs = 300;
+
+    uint32_t NextRand(uint32_t* state) {
+        *state = *state * 1664525u + 1013904223u;
+        return *state >> 8;
+    }
+
+    std::string DomainOf(uint32_t n) {
+        return "host" + std::to_string(n) + ".cdn.example.com";
+    }
+
+    // 旧实现的读写路径：所有操作串行在同一把锁上
+    struct LockedMap {
+        std::mutex mtx;
+        std::unordered_map<uint32_t, std::string> ipToDomain;
+
+        void Put(uint32_t offset, const std::string& domain) {
+            std::lock_guard<std::mutex> lock(mtx);
+            ipToDomain[offset] = domain;
+        }
+        bool Get(uint32_t offset, std::string* out) {
+            std::lock_guard<std::mutex> lock(mtx);
+            auto it = ipToDomain.find(offset);
+            if (it == ipToDomain.end()) return false;
+            *out = it->second;
+            return true;
+        }
+    };
+
+    struct SlotTable {
+        Network::FakeIpSlotTable table;
+        SlotTable() { table.Reset(kPoolSize); }
+        void Put(uint32_t offset, const std::string& domain) { table.Publish(offset, domain); }
+        bool Get(uint32_t offset, std::string* out) { return table.Read(offset, out); }
+    };
+
+    // 返回读端总吞吐（百万次/秒）
+    template <typename Store>
+    double Run(Store& store, unsigned readerCount) {
+        for (uint32_t i = 0; i < kLiveDomains; i++) store.Put(i, DomainOf(i));
+
+        std::atomic<bool> stop{false};
+        std::atomic<uint64_t> total{0};
+        std::vector<std::thread> readers;
+        for (unsigned r = 0; r < readerCount; r++) {
+            readers.emplace_back([&, r]() {
+                uint32_t seed = 99 + r;
+                std::string out;
+                uint64_t n = 0;
+                while (!stop.load(std::memory_order_relaxed)) {
+                    store.Get(NextRand(&seed) % kLiveDomains, &out);
+                    n++;
+                }
+                total.fetch_add(n);
+            });
+        }
+        std::thread writer([&]() {
+            uint32_t n = kLiveDomains;
+            while (!stop.load(std::memory_order_relaxed)) {
+                store.Put(n % kLiveDomains, DomainOf(n));
+                n++;
+                // 真实场景里分配远少于查询：每次分配后稍作停顿
+                std::this_thread::sleep_for(std::chrono::microseconds(10));
+            }
+        });
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(kDurationMs));
+        stop.store(true);
+        writer.join();
+        for (auto& t : readers) t.join();
+        return (double)total.load() / (kDurationMs * 1000.0);
+    }
+
+    // 形如 "img123.s45.cdn-example.com" 的域名，长度 20~40 字节
+    std::string RealisticDomain(uint32_t n) {
+        static const char* zones[] = {"cdn-example.com", "googleapis.com", "static.example.net", "a.io"};
+        return "img" + std::to_string(n) + ".s" + std::to_string(n % 97) + "." + zones[n % 4];
+    }
+
+    template <typename Fn>
+    double NsPerOp(size_t iterations, Fn&& fn) {
+        size_t sink = 0;
+        const auto t0 = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < iterations; i++) sink += fn(i);
+        const auto t1 = std::chrono::steady_clock::now();
+        if (sink == SIZE_MAX) std::printf("%zu\n", sink);
+        return std::chrono::duration<double, std::nano>(t1 - t0).count() / (double)iterations;
+    }
+
+    void BenchPool(uint32_t domainCount) {
+        std::vector<std::string> domains;
+        for (uint32_t i = 0; i < domainCount; i++) domains.push_back(RealisticDomain(i));
+        std::vector<uint32_t> probes;
+        uint32_t seed = 5;
+        for (int i = 0; i < 65536; i++) probes.push_back(1 + NextRand(&seed) % domainCount);
+        const size_t iterations = 2000000;
+
+        // 旧实现：IP -> Domain 与 Domain -> IP 两张 unordered_map
+        size_t before = g_liveBytes;
+        auto* ipToDomain = new std::unordered_map<uint32_t, std::string>();
+        auto* domainToIp = new std::unordered_map<std::string, uint32_t>();
+        for (uint32_t i = 0; i < domainCount; i++) {
+            (*ipToDomain)[i + 1] = domains[i];
+            (*domainToIp)[domains[i]] = i + 1;
+        }
+        const size_t oldBytes = g_liveBytes - before;
+        char buf[Network::FakeIpSlotTable::kDomainMax + 8];
+        // 两边都把域名拷到调用方缓冲区，对应 GetDomain 返回副本的真实开销
+        const double oldReverse = NsPerOp(iterations, [&](size_t i) {
+            const std::string& d = ipToDomain->find(probes[i & 0xFFFF])->second;
+            std::memcpy(buf, d.data(), d.size());
+            return d.size();
+        });
+        const double oldForward = NsPerOp(iterations, [&](size_t i) {
+            return (size_t)domainToIp->find(domains[probes[i & 0xFFFF] - 1])->second;
+        });
+        delete ipToDomain;
+        delete domainToIp;
+
+        // 新实现：稠密槽位 + arena + 开放寻址正向索引
+        before = g_liveBytes;
+        auto* table = new Network::FakeIpSlotTable();
+        table->Reset(kPoolSize);
+        for (uint32_t i = 0; i < domainCount; i++) table->Publish(i + 1, domains[i]);
+        const size_t newBytes = g_liveBytes - before;
+        const auto mem = table->GetMemoryStats();
+        const double newReverse = NsPerOp(iterations, [&](size_t i) {
+            return table->Read(probes[i & 0xFFFF], buf);
+        });
+        const double newForward = NsPerOp(iterations, [&](size_t i) {
+            uint32_t offset = 0;
+            table->FindDomain(domains[probes[i & 0xFFFF] - 1], &offset);
+            return (size_t)offset;
+        });
+        delete table;
+
+        std::printf("domains=%u unordered_maps: %.1f MB, ip->domain %.1f ns, domain->ip %.1f ns\n",
+                    domainCount, oldBytes / 1048576.0, oldReverse, oldForward);
+        std::printf("domains=%u slot-table:     %.1f MB (slots %.1f, arena %.1f, index %.1f), "
+                    "ip->domain %.1f ns, domain->ip %.1f ns\n",
+                    domainCount, newBytes / 1048576.0, mem.slotBytes / 1048576.0, mem.arenaBytes / 1048576.0,
+                    mem.indexBytes / 1048576.0, newReverse, newForward);
+    }
+}
+
+int main(int argc, char** argv) {
+    std::vector<unsigned> threads;
+    for (int i = 1; i < argc; i++) threads.push_back((unsigned)std::strtoul(argv[i], nullptr, 10));
+    if (threads.empty()) threads = {1, 2, 4, 8};
+
+    for (unsigned n : threads) {
+        LockedMap locked;
+        SlotTable slots;
+        const double a = Run(locked, n);
+        const double b = Run(slots, n);
+        std::printf("readers=%u mutex+map=%.2f Mops/s seqlock-slots=%.2f Mops/s speedup=%.1fx\n",
+                    n, a, b, b / a);
+    }
+    BenchPool(100000);
+    return 0;
+}
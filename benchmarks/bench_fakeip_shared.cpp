@@ -0,0 +1,127 @@
+// FakeIP 跨进程共享表（文件持久化模式）基准：不同容量下的打开与查询开销
+// 用法：antigravity_bench_fakeip_shared [容量...]（默认 4096 16384 65536 131072）
+// 每个容量依次测量：
+// - create：新建映射文件并初始化（含清零整表）
+// - reopen：关闭后重新打开已有文件（只校验文件头/表头，不扫描条目）
+// - rescan：对照组，打开后遍历全部条目重建 ip 索引（无持久化索引的格式需要付出的代价）
+// - get / find：表满后随机命中查询（ip -> domain / domain -> ip）
+// - scan：对照组，旧版线性扫描单次查询
+// 注：reopen 测的是页缓存热时的开销；冷启动还要加上按需缺页读取，同样只触及被访问的页
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "network/FakeIpShared.hpp"
+#include "network/SharedMemory.hpp"
+
+namespace {
+    using Table = Network::SharedFakeIpTable;
+    using Clock = std::chrono::steady_clock;
+
+    uint32_t NextRand(uint32_t* state) {
+        *state = *state * 1664525u + 1013904223u;
+        return *state >> 8;
+    }
+
+    std::string DomainOf(uint32_t n) {
+        return "img" + std::to_string(n) + ".s" + std::to_string(n % 97) + ".cdn-example.com";
+    }
+
+    double UsSince(Clock::time_point t0) {
+        return std::chrono::duration<double, std::micro>(Clock::now() - t0).count();
+    }
+
+    void BenchCapacity(uint32_t capacity) {
+        const std::string path = "antigravity_bench_fakeip_" + std::to_string(capacity) + ".map";
+        const size_t bytes = Table::FileBytesFor(capacity);
+        std::remove(path.c_str());
+
+        // create
+        auto t0 = Clock::now();
+        {
+            Network::SharedMemoryRegion region;
+            bool exclusive = false;
+            Table table;
+            if (!region.OpenFile(path, bytes, &exclusive) || !table.AttachFile(region.Data(), bytes, capacity, exclusive)) {
+                std::printf("capacity=%u: 打开映射文件失败\n", capacity);
+                return;
+            }
+            const double createUs = UsSince(t0);
+            for (uint32_t i = 0; i < capacity; i++) table.Put(0xC6120001 + i, DomainOf(i), table.NextStamp());
+            std::printf("capacity=%u file=%.1f MB create=%.0f us", capacity, bytes / 1048576.0, createUs);
+        }
+
+        // reopen
+        Network::SharedMemoryRegion region;
+        Table table;
+        bool exclusive = false;
+        t0 = Clock::now();
+        region.OpenFile(path, bytes, &exclusive);
+        table.AttachFile(region.Data(), bytes, capacity, exclusive);
+        const double reopenUs = UsSince(t0);
+
+        // rescan（对照组）
+        t0 = Clock::now();
+        std::unordered_map<uint32_t, uint32_t> rebuilt;
+        rebuilt.reserve(capacity);
+        const Table::Entry* entries = Table::EntriesOf(static_cast<Table::FileHeader*>(region.Data()) + 1, capacity);
+        for (uint32_t i = 0; i < capacity; i++) {
+            const uint32_t ip = entries[i].ip.load(std::memory_order_relaxed);
+            if (ip != 0) rebuilt[ip] = i;
+        }
+        const double rescanUs = UsSince(t0);
+
+        std::vector<uint32_t> probes;
+        uint32_t seed = 7;
+        for (int i = 0; i < 65536; i++) probes.push_back(NextRand(&seed) % capacity);
+        std::vector<std::string> domains;
+        for (int i = 0; i < 4096; i++) domains.push_back(DomainOf(probes[i]));
+
+        const size_t iterations = 1000000;
+        std::string out;
+        size_t sink = 0;
+        t0 = Clock::now();
+        for (size_t i = 0; i < iterations; i++) sink += table.Get(0xC6120001 + probes[i & 0xFFFF], &out) ? out.size() : 0;
+        const double getNs = UsSince(t0) * 1000.0 / iterations;
+
+        t0 = Clock::now();
+        for (size_t i = 0; i < iterations; i++) {
+            uint32_t ip = 0;
+            table.FindDomain(domains[i & 0xFFF], &ip);
+            sink += ip;
+        }
+        const double findNs = UsSince(t0) * 1000.0 / iterations;
+
+        // 旧版线性扫描（只比较 ip 字段，已是下限）
+        const size_t scanIterations = 2000;
+        t0 = Clock::now();
+        for (size_t i = 0; i < scanIterations; i++) {
+            const uint32_t want = 0xC6120001 + probes[i];
+            for (uint32_t j = 0; j < capacity; j++) {
+                if (entries[j].ip.load(std::memory_order_relaxed) == want) {
+                    sink += j;
+                    break;
+                }
+            }
+        }
+        const double scanNs = UsSince(t0) * 1000.0 / scanIterations;
+        if (sink == SIZE_MAX) std::printf("%zu\n", sink);
+
+        std::printf(" reopen=%.1f us rescan=%.0f us get=%.1f ns find=%.1f ns scan=%.0f ns\n",
+                    reopenUs, rescanUs, getNs, findNs, scanNs);
+        region.Close();
+        std::remove(path.c_str());
+    }
+}
+
+int main(int argc, char** argv) {
+    std::vector<uint32_t> capacities;
+    for (int i = 1; i < argc; i++) capacities.push_back((uint32_t)std::strtoul(argv[i], nullptr, 10));
+    if (capacities.empty()) capacities = {4096, 16384, 65536, 131072};
+    for (uint32_t capacity : capacities) BenchCapacity(capacity);
+    return 0;
+}
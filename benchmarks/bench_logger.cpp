@@ -0,0 +1,111 @@
+// 日志写入单次调用延迟基准：同步模式（每行加锁 + 查大小 + 打开/追加/关闭文件）vs 异步模式（入队即返回）
+// 用法：antigravity_bench_logger [线程数...]（默认 1 4）
+// 同步路径复刻 Logger::WriteToFile 的步骤（跨进程互斥以进程内 mutex 代替，stat 代替 GetFileAttributesExA）；
+// 异步路径直接使用 Core::AsyncLogWriter，sink 写常驻 FILE*，每批检查一次大小。
+// 两种模式都在调用线程上构造同样的整行字符串，统计的是调用方看到的耗时（含 p99）。
+// 压测是无间隔的连续写入，远超真实日志速率，异步模式会按丢弃策略丢掉一部分（输出中的 dropped）。
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <sys/stat.h>
+#include <thread>
+#include <vector>
+
+#include "core/LogQueue.hpp"
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+    constexpr int kCallsPerThread = 20000;
+    constexpr unsigned long long kMaxLogBytes = 10ull * 1024 * 1024;
+    const char* kPath = "antigravity_bench_logger.log";
+
+    std::string MakeLine(unsigned thread, int i) {
+        return "[2026-01-11 12:00:00] [PID:4242][TID:" + std::to_string(1000 + thread) +
+               "] [信息] 代理隧道就绪: api.example.com:443 via 127.0.0.1:7890 #" + std::to_string(i);
+    }
+
+    std::mutex g_syncMtx;
+
+    void SyncWrite(const std::string& message) {
+        std::lock_guard<std::mutex> lock(g_syncMtx);
+        struct stat st;
+        const unsigned long long size = (stat(kPath, &st) == 0) ? (unsigned long long)st.st_size : 0;
+        std::ofstream f;
+        if (size > 0 && size + message.size() + 1 > kMaxLogBytes) {
+            f.open(kPath, std::ios::out | std::ios::trunc);
+        } else {
+            f.open(kPath, std::ios::out | std::ios::app);
+        }
+        if (f.is_open()) f << message << "\n";
+    }
+
+    struct Result {
+        double avgNs;
+        double p99Ns;
+    };
+
+    template <typename Fn>
+    Result RunThreads(unsigned threadCount, Fn&& logOne) {
+        std::vector<std::vector<double>> samples(threadCount);
+        std::vector<std::thread> threads;
+        for (unsigned t = 0; t < threadCount; t++) {
+            threads.emplace_back([&, t]() {
+                samples[t].reserve(kCallsPerThread);
+                for (int i = 0; i < kCallsPerThread; i++) {
+                    const auto t0 = Clock::now();
+                    logOne(MakeLine(t, i));
+                    samples[t].push_back(std::chrono::duration<double, std::nano>(Clock::now() - t0).count());
+                }
+            });
+        }
+        for (auto& th : threads) th.join();
+        std::vector<double> all;
+        for (auto& s : samples) all.insert(all.end(), s.begin(), s.end());
+        std::sort(all.begin(), all.end());
+        double sum = 0;
+        for (double v : all) sum += v;
+        return {sum / all.size(), all[all.size() * 99 / 100]};
+    }
+}
+
+int main(int argc, char** argv) {
+    std::vector<unsigned> threadCounts;
+    for (int i = 1; i < argc; i++) threadCounts.push_back((unsigned)std::strtoul(argv[i], nullptr, 10));
+    if (threadCounts.empty()) threadCounts = {1, 4};
+
+    for (unsigned n : threadCounts) {
+        std::remove(kPath);
+        const Result sync = RunThreads(n, [](const std::string& line) { SyncWrite(line); });
+
+        std::remove(kPath);
+        FILE* file = std::fopen(kPath, "ab");
+        uint64_t dropped = 0;
+        {
+            Core::AsyncLogWriter writer(8192, [&](const std::string& batch, uint64_t droppedNow) {
+                dropped += droppedNow;
+                if (!file) return;
+                if ((unsigned long long)std::ftell(file) + batch.size() > kMaxLogBytes) {
+                    file = std::freopen(kPath, "wb", file);
+                    if (!file) return;
+                }
+                std::fwrite(batch.data(), 1, batch.size(), file);
+                std::fflush(file);
+            });
+            writer.Start();
+            const Result async = RunThreads(n, [&](std::string line) { writer.Push(line, false); });
+            writer.Stop();
+            std::printf("threads=%u sync: avg %.0f ns p99 %.0f ns | async: avg %.0f ns p99 %.0f ns dropped=%llu "
+                        "| speedup %.1fx\n",
+                        n, sync.avgNs, sync.p99Ns, async.avgNs, async.p99Ns, (unsigned long long)dropped,
+                        sync.avgNs / async.avgNs);
+        }
+        if (file) std::fclose(file);
+    }
+    std::remove(kPath);
+    return 0;
+}
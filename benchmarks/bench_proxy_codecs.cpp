@@ -0,0 +1,190 @@
+// 代理协议编解码微基准：改动前的逐字节 push_back / ostringstream / std::stoi 写法对比 Socks5Codec / HttpConnectCodec
+// 用法：antigravity_bench_proxy_codecs [次数]（默认 2000000）
+// 每组统计单次耗时与单次堆分配次数（operator new 计数）；旧写法按改动前的 Socks5Client / HttpConnectClient /
+// Socks5Udp::Wrap 原样复刻（去掉 socket 与日志）。
+#include <arpa/inet.h>
+#include <netinet/in.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "network/HttpConnectCodec.hpp"
+#include "network/Socks5Codec.hpp"
+
+// 统计全局 operator new 调用次数（仅基准进程内生效）
+static size_t g_allocCount = 0;
+
+void* operator new(size_t size) {
+    g_allocCount++;
+    if (void* p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, size_t) noexcept { std::free(p); }
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+    namespace S5 = Network::Socks5;
+    namespace HC = Network::HttpConnect;
+
+    volatile size_t g_sink = 0;
+
+    // ===== 旧写法 =====
+    std::vector<uint8_t> LegacySocks5Request(const std::string& host, uint16_t port) {
+        std::vector<uint8_t> request;
+        request.push_back(S5::VERSION);
+        request.push_back(S5::CMD_CONNECT);
+        request.push_back(0x00);
+        in_addr addr{};
+        in6_addr addr6{};
+        if (inet_pton(AF_INET, host.c_str(), &addr) == 1) {
+            request.push_back(S5::ATYP_IPV4);
+            const uint8_t* b = (const uint8_t*)&addr;
+            for (int i = 0; i < 4; ++i) request.push_back(b[i]);
+        } else if (inet_pton(AF_INET6, host.c_str(), &addr6) == 1) {
+            request.push_back(S5::ATYP_IPV6);
+            const uint8_t* b = (const uint8_t*)&addr6;
+            for (int i = 0; i < 16; ++i) request.push_back(b[i]);
+        } else {
+            request.push_back(S5::ATYP_DOMAIN);
+            request.push_back((uint8_t)host.size());
+            for (char c : host) request.push_back((uint8_t)c);
+        }
+        request.push_back((port >> 8) & 0xFF);
+        request.push_back(port & 0xFF);
+        return request;
+    }
+
+    std::string LegacyHttpRequest(const std::string& host, uint16_t port) {
+        std::string hostForHeader = host;
+        in6_addr addr6{};
+        if (inet_pton(AF_INET6, host.c_str(), &addr6) == 1) hostForHeader = "[" + host + "]";
+        std::ostringstream request;
+        request << "CONNECT " << hostForHeader << ":" << port << " HTTP/1.1\r\n";
+        request << "Host: " << hostForHeader << ":" << port << "\r\n";
+        request << "\r\n";
+        return request.str();
+    }
+
+    int LegacyParseStatusCode(const std::string& response) {
+        size_t spacePos = response.find(' ');
+        if (spacePos == std::string::npos || spacePos + 4 > response.length()) return -1;
+        std::string codeStr = response.substr(spacePos + 1, 3);
+        try {
+            return std::stoi(codeStr);
+        } catch (...) {
+            return -1;
+        }
+    }
+
+    bool LegacyUdpWrap(const std::string& host, uint16_t port, const uint8_t* payload, size_t payloadLen,
+                       std::vector<uint8_t>* outPacket) {
+        outPacket->clear();
+        uint8_t atyp = S5::ATYP_DOMAIN;
+        std::vector<uint8_t> addrBytes;
+        in_addr addr4{};
+        in6_addr addr6{};
+        if (inet_pton(AF_INET, host.c_str(), &addr4) == 1) {
+            atyp = S5::ATYP_IPV4;
+            addrBytes.resize(4);
+            std::memcpy(addrBytes.data(), &addr4, 4);
+        } else if (inet_pton(AF_INET6, host.c_str(), &addr6) == 1) {
+            atyp = S5::ATYP_IPV6;
+            addrBytes.resize(16);
+            std::memcpy(addrBytes.data(), &addr6, 16);
+        } else {
+            addrBytes.push_back((uint8_t)host.size());
+            addrBytes.insert(addrBytes.end(), host.begin(), host.end());
+        }
+        outPacket->reserve(2 + 1 + 1 + addrBytes.size() + 2 + payloadLen);
+        outPacket->push_back(0x00);
+        outPacket->push_back(0x00);
+        outPacket->push_back(0x00);
+        outPacket->push_back(atyp);
+        outPacket->insert(outPacket->end(), addrBytes.begin(), addrBytes.end());
+        outPacket->push_back((uint8_t)((port >> 8) & 0xFF));
+        outPacket->push_back((uint8_t)(port & 0xFF));
+        outPacket->insert(outPacket->end(), payload, payload + payloadLen);
+        return true;
+    }
+
+    template <typename Fn>
+    void Run(const char* name, int iterations, Fn fn) {
+        const size_t allocBefore = g_allocCount;
+        const auto t0 = Clock::now();
+        for (int i = 0; i < iterations; i++) fn(i);
+        const double ns = std::chrono::duration<double, std::nano>(Clock::now() - t0).count() / iterations;
+        const double allocs = (double)(g_allocCount - allocBefore) / iterations;
+        std::printf("  %-34s %8.1f ns/op  %5.2f allocs/op\n", name, ns, allocs);
+    }
+}
+
+int main(int argc, char** argv) {
+    const int iterations = argc > 1 ? std::max(1, std::atoi(argv[1])) : 2000000;
+    const std::string hosts[] = {"api.example.com", "203.0.113.7", "2001:db8::1"};
+    const std::string response = "HTTP/1.1 200 Connection established\r\nProxy-Agent: bench/1.0\r\n\r\n";
+    uint8_t payload[1200];
+    std::memset(payload, 0xAB, sizeof(payload));
+
+    std::printf("SOCKS5 CONNECT 请求编码\n");
+    Run("legacy vector::push_back", iterations, [&](int i) {
+        g_sink += LegacySocks5Request(hosts[i % 3], 443).size();
+    });
+    Run("Socks5::EncodeRequest", iterations, [&](int i) {
+        uint8_t buf[S5::kMaxRequestBytes];
+        g_sink += S5::EncodeRequest(S5::CMD_CONNECT, hosts[i % 3], 443, buf, sizeof(buf));
+    });
+
+    std::printf("SOCKS5 CONNECT 响应解码（域名 BND）\n");
+    const uint8_t reply[] = {5, 0, 0, 3, 11, 'e', 'x', 'a', 'm', 'p', 'l', 'e', '.', 'c', 'o', 'm', 0x01, 0xBB};
+    Run("Socks5::DecodeReply", iterations, [&](int i) {
+        S5::Reply r;
+        size_t need = 0;
+        g_sink += (size_t)S5::DecodeReply(reply, sizeof(reply) - (size_t)(i & 1), &r, &need) + r.length;
+    });
+
+    std::printf("HTTP CONNECT 请求编码\n");
+    Run("legacy ostringstream", iterations, [&](int i) {
+        g_sink += LegacyHttpRequest(hosts[i % 3], 443).size();
+    });
+    Run("HttpConnect::EncodeRequest", iterations, [&](int i) {
+        char buf[HC::kMaxRequestBytes];
+        g_sink += HC::EncodeRequest(hosts[i % 3], 443, buf, sizeof(buf));
+    });
+
+    std::printf("HTTP CONNECT 状态码解析\n");
+    Run("legacy substr + std::stoi", iterations, [&](int) { g_sink += (size_t)LegacyParseStatusCode(response); });
+    Run("HttpConnect::DecodeResponse", iterations, [&](int) {
+        HC::Response r;
+        g_sink += (size_t)HC::DecodeResponse(response.data(), response.size(), &r) + (size_t)r.status;
+    });
+
+    std::printf("SOCKS5 UDP 封装（1200 字节 payload）\n");
+    std::vector<uint8_t> packet;
+    Run("legacy Wrap (vector 拼接)", iterations, [&](int i) {
+        LegacyUdpWrap(hosts[i % 3], 443, payload, sizeof(payload), &packet);
+        g_sink += packet.size();
+    });
+    Run("EncodeUdpHeader + 固定缓冲区", iterations, [&](int i) {
+        uint8_t buf[S5::kMaxUdpHeaderBytes + sizeof(payload)];
+        const size_t n = S5::EncodeUdpHeader(hosts[i % 3], 443, buf, sizeof(buf));
+        std::memcpy(buf + n, payload, sizeof(payload));
+        g_sink += n + sizeof(payload);
+    });
+    Run("DecodeUdpHeader", iterations, [&](int i) {
+        uint8_t buf[64];
+        const size_t n = S5::EncodeUdpHeader(hosts[i % 3], 443, buf, sizeof(buf));
+        S5::UdpHeader h;
+        g_sink += (size_t)S5::DecodeUdpHeader(buf, n, &h) + h.length;
+    });
+    return 0;
+}
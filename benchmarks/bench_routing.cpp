@@ -0,0 +1,203 @@
+// 路由匹配微基准：索引化 MatchRouting vs 旧版线性扫描
+// 用法：antigravity_bench_routing [规则内域名模式数...]（默认 10000 100000）
+// 另附 CIDR 场景：约 8k 条 IPv4 + 2k 条 IPv6 前缀（模拟国内 IP 列表），
+// 以及热路径接口（string_view + RouteDecision）的每次调用堆分配次数统计。
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <string>
+#include <vector>
+
+#include "core/Config.hpp"
+#include "routing_reference.hpp"
+
+// 统计全局 operator new 调用次数（仅基准进程内生效）
+static size_t g_allocCount = 0;
+
+// GCC 把替换后的 operator delete 内联进调用点后，会把其中的 free 与 operator new 配对误报
+#if defined(__GNUC__) && !defined(__clang__) && __GNUC__ >= 11
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+
+void* operator new(size_t size) {
+    g_allocCount++;
+    if (void* p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, size_t) noexcept { std::free(p); }
+
+namespace {
+    uint32_t NextRand(uint32_t* state) {
+        *state = *state * 1664525u + 1013904223u;
+        return *state >> 8;
+    }
+
+    std::string RandomLabel(uint32_t* seed) {
+        std::string s;
+        const int len = 3 + (int)(NextRand(seed) % 8);
+        for (int i = 0; i < len; i++) s.push_back((char)('a' + NextRand(seed) % 26));
+        return s;
+    }
+
+    // 模拟 GFW/直连列表：4 条规则均分模式，约 90% 为 ".domain.tld" 后缀，少量精确/通配符
+    Core::ProxyRules BuildRules(size_t patternCount, std::vector<std::string>* sampleHosts) {
+        const char* tlds[] = {"com", "net", "org", "cn", "io", "co.jp"};
+        uint32_t seed = 42;
+        Core::ProxyRules rules;
+        rules.routing.rules.resize(4);
+        for (size_t i = 0; i < rules.routing.rules.size(); i++) {
+            rules.routing.rules[i].name = "list-" + std::to_string(i);
+            rules.routing.rules[i].action = (i % 2) ? "direct" : "proxy";
+        }
+        for (size_t i = 0; i < patternCount; i++) {
+            const std::string base = RandomLabel(&seed) + "." + tlds[NextRand(&seed) % 6];
+            const uint32_t kind = NextRand(&seed) % 100;
+            std::string pattern;
+            if (kind < 90) pattern = "." + base;
+            else if (kind < 99) pattern = base;
+            else pattern = "*" + RandomLabel(&seed) + "*";
+            rules.routing.rules[i % 4].domains.push_back(pattern);
+            if (sampleHosts && (i % 97) == 0) sampleHosts->push_back("www." + base);
+        }
+        rules.CompileRoutingRules();
+        return rules;
+    }
+
+    template <typename Fn>
+    double MeasureNsPerCall(const std::vector<std::string>& hosts, size_t iterations, Fn&& fn) {
+        size_t sink = 0;
+        const auto t0 = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < iterations; i++) {
+            sink += fn(hosts[i % hosts.size()]) ? 1 : 0;
+        }
+        const auto t1 = std::chrono::steady_clock::now();
+        if (sink == SIZE_MAX) std::printf("%zu\n", sink);
+        return std::chrono::duration<double, std::nano>(t1 - t0).count() / (double)iterations;
+    }
+
+    std::string RandomIpv4(uint32_t* seed) {
+        const uint32_t a = NextRand(seed) ^ (NextRand(seed) << 16);
+        return std::to_string(a >> 24) + "." + std::to_string((a >> 16) & 0xFF) + "." +
+               std::to_string((a >> 8) & 0xFF) + "." + std::to_string(a & 0xFF);
+    }
+
+    std::string RandomIpv6(uint32_t* seed) {
+        char buf[64];
+        std::snprintf(buf, sizeof(buf), "24%02x:%x:%x::%x", NextRand(seed) % 4, NextRand(seed) % 8,
+                      NextRand(seed) % 0xFFFF, NextRand(seed) % 0xFFFF);
+        return buf;
+    }
+
+    void BenchCidr() {
+        uint32_t seed = 7;
+        Core::ProxyRules rules;
+        Core::RoutingRule cn;
+        cn.name = "cn-ip";
+        cn.action = "direct";
+        for (int i = 0; i < 8000; i++) {
+            cn.ip_cidrs_v4.push_back(RandomIpv4(&seed) + "/" + std::to_string(12 + NextRand(&seed) % 13));
+        }
+        for (int i = 0; i < 2000; i++) {
+            cn.ip_cidrs_v6.push_back(RandomIpv6(&seed) + "/" + std::to_string(20 + NextRand(&seed) % 29));
+        }
+        rules.routing.rules.push_back(cn);
+        rules.CompileRoutingRules();
+
+        std::vector<std::string> v4;
+        std::vector<std::string> v6;
+        for (int i = 0; i < 4096; i++) {
+            v4.push_back(RandomIpv4(&seed));
+            v6.push_back(RandomIpv6(&seed));
+        }
+
+        std::string action;
+        std::string rule;
+        const double indexed4 = MeasureNsPerCall(v4, 200000, [&](const std::string& ip) {
+            return rules.MatchRouting("", ip, false, 443, "tcp", &action, &rule);
+        });
+        const double linear4 = MeasureNsPerCall(v4, 20000, [&](const std::string& ip) {
+            return ReferenceMatchRouting(rules, "", ip, false, 443, "tcp", &action, &rule);
+        });
+        const double indexed6 = MeasureNsPerCall(v6, 200000, [&](const std::string& ip) {
+            return rules.MatchRouting("", ip, true, 443, "tcp", &action, &rule);
+        });
+        const double linear6 = MeasureNsPerCall(v6, 20000, [&](const std::string& ip) {
+            return ReferenceMatchRouting(rules, "", ip, true, 443, "tcp", &action, &rule);
+        });
+        std::printf("cidr v4=%zu nodes=%zu indexed=%.1f ns/call linear=%.1f ns/call speedup=%.1fx\n",
+                    rules.compiled_cidr_v4_trie.PrefixCount(), rules.compiled_cidr_v4_trie.NodeCount(),
+                    indexed4, linear4, linear4 / indexed4);
+        std::printf("cidr v6=%zu nodes=%zu indexed=%.1f ns/call linear=%.1f ns/call speedup=%.1fx\n",
+                    rules.compiled_cidr_v6_trie.PrefixCount(), rules.compiled_cidr_v6_trie.NodeCount(),
+                    indexed6, linear6, linear6 / indexed6);
+    }
+
+    void BenchAllocations() {
+        std::vector<std::string> hosts;
+        Core::ProxyRules rules = BuildRules(10000, &hosts);
+        hosts.push_back("WWW.Example.COM.");
+        hosts.push_back("10.1.2.3");
+        const size_t calls = hosts.size();
+
+        std::string action;
+        std::string rule;
+        size_t before = g_allocCount;
+        for (const auto& h : hosts) rules.MatchRouting(h, "", false, 443, "tcp", &action, &rule);
+        const double legacy = (double)(g_allocCount - before) / (double)calls;
+
+        before = g_allocCount;
+        for (const auto& h : hosts) ReferenceMatchRouting(rules, h, "", false, 443, "tcp", &action, &rule);
+        const double linear = (double)(g_allocCount - before) / (double)calls;
+
+        before = g_allocCount;
+        size_t direct = 0;
+        for (const auto& h : hosts) {
+            const Core::RouteDecision d = rules.MatchRouting(std::string_view(h), std::string_view(), false, 443,
+                                                             Core::RouteProtocol::Tcp);
+            direct += d.IsDirect() ? 1 : 0;
+        }
+        const double fast = (double)(g_allocCount - before) / (double)calls;
+
+        const double fastNs = MeasureNsPerCall(hosts, 200000, [&](const std::string& h) {
+            return rules.MatchRouting(std::string_view(h), std::string_view(), false, 443,
+                                      Core::RouteProtocol::Tcp).Matched();
+        });
+        std::printf("alloc/call: linear-scan=%.2f string-api=%.2f decision-api=%.2f "
+                    "(decision-api %.1f ns/call, direct=%zu)\n",
+                    linear, legacy, fast, fastNs, direct);
+    }
+}
+
+int main(int argc, char** argv) {
+    std::vector<size_t> sizes;
+    for (int i = 1; i < argc; i++) sizes.push_back((size_t)std::strtoull(argv[i], nullptr, 10));
+    if (sizes.empty()) sizes = {10000, 100000};
+
+    for (size_t n : sizes) {
+        std::vector<std::string> hosts;
+        Core::ProxyRules rules = BuildRules(n, &hosts);
+        // 混入未命中的域名，覆盖“走默认动作”的最坏路径
+        for (size_t i = 0, cnt = hosts.size(); i < cnt; i++) hosts.push_back("miss" + std::to_string(i) + ".example");
+
+        const size_t iterations = 200000;
+        const size_t linearIterations = n >= 100000 ? 200 : 2000;
+        std::string action;
+        std::string rule;
+        const double indexed = MeasureNsPerCall(hosts, iterations, [&](const std::string& h) {
+            return rules.MatchRouting(h, "", false, 443, "tcp", &action, &rule);
+        });
+        const double linear = MeasureNsPerCall(hosts, linearIterations, [&](const std::string& h) {
+            return ReferenceMatchRouting(rules, h, "", false, 443, "tcp", &action, &rule);
+        });
+        std::printf("patterns=%zu trie_nodes=%zu globs=%zu indexed=%.1f ns/call linear=%.1f ns/call speedup=%.1fx\n",
+                    n, rules.compiled_domain_trie.NodeCount(), rules.compiled_domain_globs.size(),
+                    indexed, linear, linear / indexed);
+    }
+    BenchCidr();
+    BenchAllocations();
+    return 0;
+}
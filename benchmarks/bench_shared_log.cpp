@@ -0,0 +1,171 @@
+// 多进程日志写入基准：跨进程锁逐行写文件（同步模式）vs 每进程共享内存日志环 + 收集进程（log_shared_ring）
+// 用法：antigravity_bench_shared_log [进程数...]（默认 1 4 8）
+// 同步路径复刻 Logger::WriteToFile：持跨进程锁（flock 代替命名互斥量）→ 查大小 → 打开/追加/关闭文件；
+// 共享环路径：调用方只写本进程的环，父进程担任收集者每 50ms 合并写出。
+// 每个子进程连续写 kLinesPerProcess 行，统计调用方看到的单次耗时（avg / p99），子进程通过管道回报。
+// 仅 POSIX（fork + shm_open）；Windows 下命名段与 CreateProcess 的组合不在此基准范围内。
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <string>
+#include <thread>
+#include <vector>
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+#include "core/SharedLogRing.hpp"
+
+#ifndef _WIN32
+namespace {
+    using Clock = std::chrono::steady_clock;
+    constexpr int kLinesPerProcess = 20000;
+    constexpr unsigned long long kMaxLogBytes = 10ull * 1024 * 1024;
+    const char* kLogPath = "antigravity_bench_shared_log.log";
+    const char* kLockPath = "antigravity_bench_shared_log.lock";
+
+    struct Result {
+        double avgNs;
+        double p99Ns;
+    };
+
+    std::string MakeLine(int proc, int i) {
+        return "[2026-01-11 12:00:00] [PID:" + std::to_string(4000 + proc) +
+               "][TID:1] [信息] 代理隧道就绪: api.example.com:443 via 127.0.0.1:7890 #" + std::to_string(i);
+    }
+
+    void SyncWrite(int lockFd, const std::string& line) {
+        flock(lockFd, LOCK_EX);
+        struct stat st;
+        const unsigned long long size = (stat(kLogPath, &st) == 0) ? (unsigned long long)st.st_size : 0;
+        const bool truncate = size > 0 && size + line.size() + 1 > kMaxLogBytes;
+        FILE* f = std::fopen(kLogPath, truncate ? "wb" : "ab");
+        if (f) {
+            std::fwrite(line.data(), 1, line.size(), f);
+            std::fputc('\n', f);
+            std::fclose(f);
+        }
+        flock(lockFd, LOCK_UN);
+    }
+
+    // 子进程：逐行计时，把 avg/p99 写回管道
+    template <typename Fn>
+    void RunChild(int proc, int pipeFd, Fn&& logOne) {
+        std::vector<double> samples;
+        samples.reserve(kLinesPerProcess);
+        for (int i = 0; i < kLinesPerProcess; i++) {
+            const std::string line = MakeLine(proc, i);
+            const auto t0 = Clock::now();
+            logOne(line);
+            samples.push_back(std::chrono::duration<double, std::nano>(Clock::now() - t0).count());
+        }
+        std::sort(samples.begin(), samples.end());
+        double sum = 0;
+        for (double v : samples) sum += v;
+        const Result r{sum / samples.size(), samples[samples.size() * 99 / 100]};
+        if (write(pipeFd, &r, sizeof(r)) != (ssize_t)sizeof(r)) _exit(1);
+    }
+
+    template <typename ChildFn>
+    Result RunProcesses(int count, ChildFn&& child, const std::function<void()>& whileWaiting) {
+        int fds[2];
+        if (pipe(fds) != 0) return {0, 0};
+        std::vector<pid_t> pids;
+        for (int p = 0; p < count; p++) {
+            const pid_t pid = fork();
+            if (pid == 0) {
+                close(fds[0]);
+                child(p, fds[1]);
+                _exit(0);
+            }
+            pids.push_back(pid);
+        }
+        close(fds[1]);
+        int remaining = count;
+        while (remaining > 0) {
+            if (whileWaiting) whileWaiting();
+            for (pid_t& pid : pids) {
+                if (pid > 0 && waitpid(pid, nullptr, WNOHANG) == pid) {
+                    pid = 0;
+                    remaining--;
+                }
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        }
+        Result total{0, 0};
+        Result r{};
+        int n = 0;
+        while (read(fds[0], &r, sizeof(r)) == (ssize_t)sizeof(r)) {
+            total.avgNs += r.avgNs;
+            total.p99Ns = std::max(total.p99Ns, r.p99Ns);
+            n++;
+        }
+        close(fds[0]);
+        if (n > 0) total.avgNs /= n;
+        return total;
+    }
+}
+
+int main(int argc, char** argv) {
+    std::vector<int> counts;
+    for (int i = 1; i < argc; i++) counts.push_back(std::atoi(argv[i]));
+    if (counts.empty()) counts = {1, 4, 8};
+
+    for (int n : counts) {
+        std::remove(kLogPath);
+        const Result sync = RunProcesses(n, [](int proc, int pipeFd) {
+            const int lockFd = open(kLockPath, O_RDWR | O_CREAT, 0600);
+            RunChild(proc, pipeFd, [&](const std::string& line) { SyncWrite(lockFd, line); });
+            close(lockFd);
+        }, nullptr);
+
+        std::remove(kLogPath);
+        const std::string prefix = "Local\\AgpBenchLog_" + std::to_string(getpid()) + "_" + std::to_string(n);
+        FILE* file = std::fopen(kLogPath, "ab");
+        uint64_t dropped = 0;
+        Core::SharedLogHub collector(prefix, 512 * 1024, [&](const std::string& batch, uint64_t d) {
+            dropped += d;
+            if (file) std::fwrite(batch.data(), 1, batch.size(), file);
+        });
+        collector.Start(false);
+        collector.PumpOnce();
+        auto lastPump = Clock::now();
+        const Result ring = RunProcesses(n, [&](int proc, int pipeFd) {
+            Core::SharedLogHub hub(prefix, 512 * 1024, [](const std::string&, uint64_t) {});
+            if (!hub.Start(true)) _exit(2);
+            RunChild(proc, pipeFd, [&](const std::string& line) { hub.Push(line); });
+            hub.Stop();
+        }, [&]() {
+            // 收集者节奏与泵线程一致：每 50ms 一轮
+            if (Clock::now() - lastPump >= std::chrono::milliseconds(Core::SharedLogHub::kPumpIntervalMs)) {
+                collector.PumpOnce();
+                lastPump = Clock::now();
+            }
+        });
+        collector.PumpOnce();
+        collector.Stop();
+        if (file) std::fclose(file);
+        Network::SharedMemoryRegion::Remove(prefix + "_Dir");
+
+        std::printf("processes=%d sync(lock): avg %.0f ns p99 %.0f ns | ring: avg %.0f ns p99 %.0f ns dropped=%llu "
+                    "| speedup %.1fx\n",
+                    n, sync.avgNs, sync.p99Ns, ring.avgNs, ring.p99Ns, (unsigned long long)dropped,
+                    sync.avgNs / ring.avgNs);
+    }
+    std::remove(kLogPath);
+    std::remove(kLockPath);
+    return 0;
+}
+#else
+int main() {
+    std::printf("bench_shared_log 仅支持 POSIX（fork + shm_open）\n");
+    return 0;
+}
+#endif
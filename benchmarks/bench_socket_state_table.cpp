@@ -0,0 +1,253 @@
+// 分片 socket 状态表基准：改动前“每类状态一张全局 map + 一把全局锁、每次发送先 getsockopt(SO_TYPE)”
+// 对比 Network::SocketStateTable（按 SOCKET 一张分片表 + 按 OVERLAPPED 一张分片表）
+// 用法：antigravity_bench_socket_state_table [socket 数] [每线程操作数] [churn 千分比]（默认 100000 200000 20）
+// 每次操作模拟一次 UDP overlapped WSASend：查类型 → 查默认目标头 → 登记 pending → 立即完成并取回；
+// 以 churn 千分比的概率改为 closesocket + 重新 socket()（清掉该 socket 的全部状态再重建）。
+// 旧模型的 getsockopt 是真实系统调用（对一个本地 UDP fd 调用），新模型只在重建后首次查询时调用一次。
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "network/SocketStateTable.hpp"
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+    using Key = uintptr_t;
+
+    int g_udpFd = -1;
+    std::atomic<uint64_t> g_sink{0};
+
+    int QuerySocketType() {
+        int type = 0;
+        socklen_t len = sizeof(type);
+        getsockopt(g_udpFd, SOL_SOCKET, SO_TYPE, &type, &len);
+        return type;
+    }
+
+    // 与 Hooks 中的结构大小相当
+    struct Target {
+        std::string host;
+        uint16_t port = 0;
+    };
+
+    struct UdpContext {
+        uint8_t header[262] = {};
+        size_t headerLen = 10;
+        bool relayConnected = true;
+    };
+
+    struct SendCtx {
+        Key socket = 0;
+        uint8_t header[262] = {};
+    };
+
+    // 每个 key 一个 OVERLAPPED 地址：按 socket 编号取 64 字节对齐的伪地址
+    Key OverlappedOf(Key s) { return (Key)0x7f0000000000ull + s * 16; }
+
+    // ============= 旧模型：按状态类别分表，全局锁 =============
+    struct Legacy {
+        std::mutex targetsMtx;
+        std::unordered_map<Key, Target> targets;
+        std::mutex udpMtx;
+        std::unordered_map<Key, std::unique_ptr<UdpContext>> udp;
+        std::mutex ovlMtx;
+        std::unordered_map<Key, std::shared_ptr<SendCtx>> ovlSend;
+
+        void Open(Key s) {
+            {
+                std::lock_guard<std::mutex> lock(targetsMtx);
+                targets[s] = Target{"203.0.113.7", 443};
+            }
+            std::lock_guard<std::mutex> lock(udpMtx);
+            udp[s].reset(new UdpContext());
+        }
+
+        void Close(Key s) {
+            {
+                std::lock_guard<std::mutex> lock(targetsMtx);
+                targets.erase(s);
+            }
+            {
+                std::lock_guard<std::mutex> lock(udpMtx);
+                udp.erase(s);
+            }
+            // 旧实现关闭时扫描整张 overlapped 表
+            std::lock_guard<std::mutex> lock(ovlMtx);
+            for (auto it = ovlSend.begin(); it != ovlSend.end();) {
+                if (it->second->socket == s) it = ovlSend.erase(it);
+                else ++it;
+            }
+        }
+
+        void Send(Key s) {
+            if (QuerySocketType() != SOCK_DGRAM) return;
+            auto ctx = std::make_shared<SendCtx>();
+            ctx->socket = s;
+            bool relayConnected = false;
+            {
+                std::lock_guard<std::mutex> lock(udpMtx); // TryGetUdpProxyDefaultHeader
+                auto it = udp.find(s);
+                if (it == udp.end()) return;
+                std::copy(it->second->header, it->second->header + it->second->headerLen, ctx->header);
+            }
+            {
+                std::lock_guard<std::mutex> lock(udpMtx); // TryGetUdpRelayAddr
+                auto it = udp.find(s);
+                relayConnected = it != udp.end() && it->second->relayConnected;
+            }
+            if (!relayConnected) return;
+            const Key ovl = OverlappedOf(s);
+            {
+                std::lock_guard<std::mutex> lock(ovlMtx);
+                ovlSend[ovl] = ctx;
+            }
+            // 完成：先查 ConnectEx 表（此处省略为同一把锁），再取回发送上下文
+            std::shared_ptr<SendCtx> done;
+            {
+                std::lock_guard<std::mutex> lock(ovlMtx);
+                auto it = ovlSend.find(ovl);
+                if (it != ovlSend.end()) {
+                    done = std::move(it->second);
+                    ovlSend.erase(it);
+                }
+            }
+            if (done) g_sink.fetch_add(done->header[0], std::memory_order_relaxed);
+        }
+    };
+
+    // ============= 新模型：SocketStateTable =============
+    struct Sharded {
+        struct SocketState {
+            Target target;
+            std::unique_ptr<UdpContext> udp;
+            int soType = 0;
+        };
+        struct PendingOverlapped {
+            std::shared_ptr<SendCtx> udpSend;
+        };
+
+        Network::SocketStateTable<Key, SocketState> sockets;
+        Network::SocketStateTable<Key, PendingOverlapped> pending;
+
+        void Open(Key s) {
+            sockets.Upsert(s, [](SocketState& st) {
+                st.target = Target{"203.0.113.7", 443};
+                st.udp.reset(new UdpContext());
+            });
+        }
+
+        void Close(Key s) {
+            SocketState st;
+            sockets.Take(s, &st);
+            if (!st.udp) return;
+            pending.Erase(OverlappedOf(s)); // Hooks 中为 EraseIf，仅 UDP socket 关闭时执行
+        }
+
+        void Send(Key s) {
+            auto ctx = std::make_shared<SendCtx>();
+            ctx->socket = s;
+            bool relayConnected = false;
+            int soType = 0;
+            sockets.Visit(s, [&](SocketState& st) {
+                soType = st.soType;
+                if (!st.udp) return;
+                std::copy(st.udp->header, st.udp->header + st.udp->headerLen, ctx->header);
+                relayConnected = st.udp->relayConnected;
+            });
+            if (soType == 0) {
+                // 首次查询：锁外 getsockopt，再缓存
+                soType = QuerySocketType();
+                sockets.Upsert(s, [&](SocketState& st) { st.soType = soType; });
+            }
+            if (soType != SOCK_DGRAM || !relayConnected) return;
+            const Key ovl = OverlappedOf(s);
+            pending.Upsert(ovl, [&](PendingOverlapped& p) { p.udpSend = ctx; });
+            std::shared_ptr<SendCtx> done;
+            pending.Update(ovl, [&](PendingOverlapped& p) {
+                done = std::move(p.udpSend);
+                return false;
+            });
+            if (done) g_sink.fetch_add(done->header[0], std::memory_order_relaxed);
+        }
+    };
+
+    struct Rng {
+        uint64_t state;
+        uint64_t Next() {
+            state ^= state << 13;
+            state ^= state >> 7;
+            state ^= state << 17;
+            return state;
+        }
+    };
+
+    template <typename Model>
+    double Run(Model& model, size_t sockets, int threads, size_t opsPerThread, int churnPerMille) {
+        std::vector<std::thread> workers;
+        std::atomic<bool> go{false};
+        for (int t = 0; t < threads; t++) {
+            workers.emplace_back([&, t]() {
+                Rng rng{0x9E3779B97F4A7C15ull ^ (uint64_t)(t + 1) * 0x2545F4914F6CDD1Dull};
+                while (!go.load(std::memory_order_acquire)) {
+                }
+                for (size_t i = 0; i < opsPerThread; i++) {
+                    const uint64_t r = rng.Next();
+                    const Key s = (Key)((r >> 16) % sockets + 1) * 4; // SOCKET 值为 4 的倍数
+                    if ((int)(r % 1000) < churnPerMille) {
+                        model.Close(s);
+                        model.Open(s);
+                    } else {
+                        model.Send(s);
+                    }
+                }
+            });
+        }
+        const auto t0 = Clock::now();
+        go.store(true, std::memory_order_release);
+        for (auto& w : workers) w.join();
+        const double sec = std::chrono::duration<double>(Clock::now() - t0).count();
+        return (double)threads * opsPerThread / sec / 1e6;
+    }
+}
+
+int main(int argc, char** argv) {
+    const size_t sockets = argc > 1 ? (size_t)std::max(1, std::atoi(argv[1])) : 100000;
+    const size_t ops = argc > 2 ? (size_t)std::max(1, std::atoi(argv[2])) : 200000;
+    const int churn = argc > 3 ? std::max(0, std::min(1000, std::atoi(argv[3]))) : 20;
+
+    g_udpFd = socket(AF_INET, SOCK_DGRAM, 0);
+    if (g_udpFd < 0) {
+        std::fprintf(stderr, "socket() failed\n");
+        return 1;
+    }
+
+    std::printf("sockets=%zu ops/thread=%zu churn=%d/1000 hw_threads=%u\n", sockets, ops, churn,
+                std::thread::hardware_concurrency());
+    for (int threads : {1, 2, 4, 8}) {
+        auto legacy = std::make_unique<Legacy>();
+        auto sharded = std::make_unique<Sharded>();
+        for (size_t i = 1; i <= sockets; i++) {
+            legacy->Open((Key)i * 4);
+            sharded->Open((Key)i * 4);
+        }
+        const double legacyMops = Run(*legacy, sockets, threads, ops, churn);
+        const double shardedMops = Run(*sharded, sockets, threads, ops, churn);
+        std::printf("  threads=%d  legacy (global maps + getsockopt): %6.2f Mops/s   sharded table: %6.2f Mops/s"
+                    "   x%.2f\n",
+                    threads, legacyMops, shardedMops, shardedMops / legacyMops);
+    }
+    close(g_udpFd);
+    return 0;
+}
@@ -0,0 +1,211 @@
+// SOCKS5 握手延迟基准：逐步握手（认证协商 -> CONNECT，两个 RTT）对比流水线握手（一次发出，一个 RTT）
+// 用法：antigravity_bench_socks5_pipeline [轮数] [单程延迟ms]（默认 50 10）
+// 代理为本地替身（benchmarks/socks5_stand_in.hpp），按批注入单程延迟；客户端为 POSIX 阻塞 socket，
+// 报文编解码与 Socks5Client 共用 network/Socks5Codec.hpp。
+// 最后对“不接受流水线”的严格替身演示回退：首个流水线连接失败后改走逐步握手。
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include "network/Socks5Codec.hpp"
+#include "socks5_stand_in.hpp"
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+    namespace S5 = Network::Socks5;
+
+    enum class Outcome { Ok, Failed, PipelineRejected };
+
+    int Dial(uint16_t port) {
+        int fd = socket(AF_INET, SOCK_STREAM, 0);
+        if (fd < 0) return -1;
+        int one = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        addr.sin_port = htons(port);
+        if (connect(fd, (sockaddr*)&addr, sizeof(addr)) != 0) {
+            close(fd);
+            return -1;
+        }
+        return fd;
+    }
+
+    bool SendAll(int fd, const uint8_t* p, size_t len) {
+        while (len > 0) {
+            const ssize_t n = send(fd, p, len, MSG_NOSIGNAL);
+            if (n <= 0) return false;
+            p += n;
+            len -= (size_t)n;
+        }
+        return true;
+    }
+
+    // 读到 CONNECT 响应完整为止（offset 之前是已处理的字节），不多读
+    bool ReadReply(int fd, uint8_t* buf, size_t offset, size_t* have, S5::Reply* reply) {
+        size_t want = offset + S5::kMinReplyBytes;
+        for (;;) {
+            size_t need = 0;
+            if (*have >= offset) {
+                const auto st = S5::DecodeReply(buf + offset, *have - offset, reply, &need);
+                if (st == S5::DecodeStatus::Done) return true;
+                if (st == S5::DecodeStatus::Invalid) return false;
+                want = std::max(want, offset + need);
+            }
+            const ssize_t n = recv(fd, buf + *have, want - *have, 0);
+            if (n <= 0) return false;
+            *have += (size_t)n;
+        }
+    }
+
+    Outcome Sequential(int fd, const std::string& host, uint16_t port) {
+        uint8_t buf[S5::kMethodReplyBytes + S5::kMaxReplyBytes];
+        const size_t greetingLen = S5::EncodeGreeting(buf, sizeof(buf));
+        if (!SendAll(fd, buf, greetingLen)) return Outcome::Failed;
+        size_t have = 0;
+        while (have < S5::kMethodReplyBytes) {
+            const ssize_t n = recv(fd, buf + have, S5::kMethodReplyBytes - have, 0);
+            if (n <= 0) return Outcome::Failed;
+            have += (size_t)n;
+        }
+        uint8_t method = S5::AUTH_NO_ACCEPTABLE;
+        if (S5::DecodeMethodReply(buf, have, &method) != S5::DecodeStatus::Done || method != S5::AUTH_NONE) {
+            return Outcome::Failed;
+        }
+        const size_t reqLen = S5::EncodeRequest(S5::CMD_CONNECT, host, port, buf, sizeof(buf));
+        if (reqLen == 0 || !SendAll(fd, buf, reqLen)) return Outcome::Failed;
+        have = 0;
+        S5::Reply reply;
+        if (!ReadReply(fd, buf, 0, &have, &reply)) return Outcome::Failed;
+        return reply.rep == S5::REPLY_SUCCESS ? Outcome::Ok : Outcome::Failed;
+    }
+
+    // 与 Socks5Client::HandshakePipelined 相同的判定：认证响应之后断开 / CONNECT 响应无效 => 代理不接受流水线
+    Outcome Pipelined(int fd, const std::string& host, uint16_t port) {
+        uint8_t buf[S5::kGreetingBytes + S5::kMaxRequestBytes];
+        size_t len = S5::EncodeGreeting(buf, sizeof(buf));
+        const size_t reqLen = S5::EncodeRequest(S5::CMD_CONNECT, host, port, buf + len, sizeof(buf) - len);
+        if (reqLen == 0 || !SendAll(fd, buf, len + reqLen)) return Outcome::Failed;
+
+        uint8_t reply[S5::kMethodReplyBytes + S5::kMaxReplyBytes];
+        size_t have = 0;
+        size_t want = S5::kMethodReplyBytes + S5::kMinReplyBytes;
+        bool methodChecked = false;
+        for (;;) {
+            if (!methodChecked && have >= S5::kMethodReplyBytes) {
+                uint8_t method = S5::AUTH_NO_ACCEPTABLE;
+                if (S5::DecodeMethodReply(reply, have, &method) != S5::DecodeStatus::Done ||
+                    method != S5::AUTH_NONE) {
+                    return Outcome::Failed;
+                }
+                methodChecked = true;
+            }
+            if (methodChecked) {
+                S5::Reply parsed;
+                size_t need = 0;
+                const auto st = S5::DecodeReply(reply + S5::kMethodReplyBytes, have - S5::kMethodReplyBytes,
+                                                &parsed, &need);
+                if (st == S5::DecodeStatus::Done) return parsed.rep == S5::REPLY_SUCCESS ? Outcome::Ok : Outcome::Failed;
+                if (st == S5::DecodeStatus::Invalid) return Outcome::PipelineRejected;
+                want = std::max(want, S5::kMethodReplyBytes + need);
+            }
+            const ssize_t n = recv(fd, reply + have, want - have, 0);
+            if (n <= 0) return have >= S5::kMethodReplyBytes ? Outcome::PipelineRejected : Outcome::Failed;
+            have += (size_t)n;
+        }
+    }
+
+    struct Result {
+        double avgUs = 0;
+        double p50Us = 0;
+        double p99Us = 0;
+        int failures = 0;
+    };
+
+    Result Run(uint16_t proxyPort, int rounds, bool pipelined) {
+        std::vector<double> samples;
+        Result res;
+        for (int i = 0; i < rounds; i++) {
+            const int fd = Dial(proxyPort);
+            if (fd < 0) {
+                res.failures++;
+                continue;
+            }
+            // 只计握手时间（代理 TCP 连接在两种模式下相同）
+            const auto t0 = Clock::now();
+            const Outcome out = pipelined ? Pipelined(fd, "example.com", 443) : Sequential(fd, "example.com", 443);
+            const double us = std::chrono::duration<double, std::micro>(Clock::now() - t0).count();
+            close(fd);
+            if (out != Outcome::Ok) {
+                res.failures++;
+                continue;
+            }
+            samples.push_back(us);
+        }
+        std::sort(samples.begin(), samples.end());
+        double sum = 0;
+        for (double v : samples) sum += v;
+        if (!samples.empty()) {
+            res.avgUs = sum / samples.size();
+            res.p50Us = samples[samples.size() / 2];
+            res.p99Us = samples[samples.size() * 99 / 100];
+        }
+        return res;
+    }
+}
+
+int main(int argc, char** argv) {
+    const int rounds = argc > 1 ? std::max(1, std::atoi(argv[1])) : 50;
+    const int oneWayMs = argc > 2 ? std::max(0, std::atoi(argv[2])) : 10;
+
+    std::printf("rounds=%d injected_rtt=%dms\n", rounds, oneWayMs * 2);
+    for (int delay : {0, oneWayMs}) {
+        BenchSupport::Socks5StandIn proxy;
+        BenchSupport::Socks5StandIn::Options options;
+        options.oneWayDelayMs = delay;
+        if (!proxy.Start(options)) {
+            std::fprintf(stderr, "stand-in proxy failed to start, errno=%d\n", errno);
+            return 1;
+        }
+        const Result seq = Run(proxy.Port(), rounds, false);
+        const Result pipe = Run(proxy.Port(), rounds, true);
+        std::printf("  rtt=%2dms sequential: avg %8.0f us, p50 %8.0f us, p99 %8.0f us, failures %d\n", delay * 2,
+                    seq.avgUs, seq.p50Us, seq.p99Us, seq.failures);
+        std::printf("  rtt=%2dms pipelined : avg %8.0f us, p50 %8.0f us, p99 %8.0f us, failures %d\n", delay * 2,
+                    pipe.avgUs, pipe.p50Us, pipe.p99Us, pipe.failures);
+        proxy.Stop();
+    }
+
+    // 回退演示：严格代理断开流水线连接；客户端记住后改走逐步握手
+    BenchSupport::Socks5StandIn strict;
+    BenchSupport::Socks5StandIn::Options options;
+    options.rejectPipelining = true;
+    if (!strict.Start(options)) return 1;
+    bool pipelineRejected = false;
+    int ok = 0;
+    int failed = 0;
+    for (int i = 0; i < 5; i++) {
+        const int fd = Dial(strict.Port());
+        if (fd < 0) return 1;
+        const Outcome out = pipelineRejected ? Sequential(fd, "example.com", 443) : Pipelined(fd, "example.com", 443);
+        close(fd);
+        if (out == Outcome::PipelineRejected) pipelineRejected = true;
+        if (out == Outcome::Ok) ok++;
+        else failed++;
+    }
+    std::printf("  strict proxy fallback: %d ok, %d failed (proxy rejected %llu pipelined requests)\n", ok, failed,
+                (unsigned long long)strict.Rejected());
+    strict.Stop();
+    return 0;
+}
@@ -0,0 +1,225 @@
+// UDP Associate 预建池基准：QUIC 首包延迟——冷启动（TCP 建连 + 认证协商 + UDP ASSOCIATE + 首包往返）
+// 对比从池中取已建好的关联（只剩首包往返）
+// 用法：antigravity_bench_udp_associate_pool [轮数] [单程延迟ms] [请求间隔ms]（默认 50 10 50）
+// 代理为本地替身（benchmarks/socks5_stand_in.hpp），TCP 与 relay 都按批注入单程延迟；回环上的 TCP 建连
+// 没有网络延迟，这里在 connect 之后补睡一个 RTT。首包由新建的 UDP socket connect 到 relay 后发出，
+// 收到 relay 回显即计为首包完成（与 Hooks 中应用 socket 接管关联后的路径一致）。
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "network/Socks5Codec.hpp"
+#include "network/WarmPool.hpp"
+#include "socks5_stand_in.hpp"
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+    namespace S5 = Network::Socks5;
+
+    int g_rttMs = 0;
+
+    // 与 Network::Socks5Udp::UdpAssociateResult 对应：控制连接 + relay 地址
+    struct Association {
+        int controlFd = -1;
+        sockaddr_in relay{};
+    };
+
+    int Dial(uint16_t port) {
+        int fd = socket(AF_INET, SOCK_STREAM, 0);
+        if (fd < 0) return -1;
+        int one = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        addr.sin_port = htons(port);
+        if (connect(fd, (sockaddr*)&addr, sizeof(addr)) != 0) {
+            close(fd);
+            return -1;
+        }
+        if (g_rttMs > 0) std::this_thread::sleep_for(std::chrono::milliseconds(g_rttMs));
+        return fd;
+    }
+
+    bool SendAll(int fd, const uint8_t* p, size_t len) {
+        while (len > 0) {
+            const ssize_t n = send(fd, p, len, MSG_NOSIGNAL);
+            if (n <= 0) return false;
+            p += n;
+            len -= (size_t)n;
+        }
+        return true;
+    }
+
+    bool RecvExact(int fd, uint8_t* p, size_t len) {
+        while (len > 0) {
+            const ssize_t n = recv(fd, p, len, 0);
+            if (n <= 0) return false;
+            p += n;
+            len -= (size_t)n;
+        }
+        return true;
+    }
+
+    // 认证协商 + UDP ASSOCIATE（DST=0.0.0.0:0），成功时填写 relay 地址
+    bool Associate(int fd, sockaddr_in* relay) {
+        uint8_t buf[S5::kMaxReplyBytes];
+        size_t len = S5::EncodeGreeting(buf, sizeof(buf));
+        if (!SendAll(fd, buf, len) || !RecvExact(fd, buf, S5::kMethodReplyBytes)) return false;
+        uint8_t method = S5::AUTH_NO_ACCEPTABLE;
+        if (S5::DecodeMethodReply(buf, S5::kMethodReplyBytes, &method) != S5::DecodeStatus::Done ||
+            method != S5::AUTH_NONE) {
+            return false;
+        }
+        len = S5::EncodeRequest(S5::CMD_UDP_ASSOCIATE, "0.0.0.0", 0, buf, sizeof(buf));
+        if (len == 0 || !SendAll(fd, buf, len)) return false;
+        size_t have = 0;
+        size_t want = S5::kMinReplyBytes;
+        for (;;) {
+            S5::Reply parsed;
+            size_t need = 0;
+            const auto st = S5::DecodeReply(buf, have, &parsed, &need);
+            if (st == S5::DecodeStatus::Done) {
+                if (parsed.rep != S5::REPLY_SUCCESS || parsed.atyp != S5::ATYP_IPV4) return false;
+                relay->sin_family = AF_INET;
+                std::memcpy(&relay->sin_addr, parsed.bndAddr, 4);
+                relay->sin_port = htons(parsed.bndPort);
+                return true;
+            }
+            if (st == S5::DecodeStatus::Invalid) return false;
+            want = std::max(want, need);
+            const ssize_t n = recv(fd, buf + have, want - have, 0);
+            if (n <= 0) return false;
+            have += (size_t)n;
+        }
+    }
+
+    bool DialAssociation(uint16_t port, Association* out) {
+        const int fd = Dial(port);
+        if (fd < 0) return false;
+        if (!Associate(fd, &out->relay)) {
+            close(fd);
+            return false;
+        }
+        out->controlFd = fd;
+        return true;
+    }
+
+    // 新建 UDP socket 接管关联，发出一个封装好的首包并等待回显
+    bool FirstPacket(const Association& assoc, const std::vector<uint8_t>& datagram) {
+        const int udp = socket(AF_INET, SOCK_DGRAM, 0);
+        if (udp < 0) return false;
+        timeval tv{2, 0};
+        setsockopt(udp, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+        uint8_t echo[2048];
+        const bool ok = connect(udp, (const sockaddr*)&assoc.relay, sizeof(assoc.relay)) == 0 &&
+                        send(udp, datagram.data(), datagram.size(), 0) == (ssize_t)datagram.size() &&
+                        recv(udp, echo, sizeof(echo), 0) == (ssize_t)datagram.size();
+        close(udp);
+        return ok;
+    }
+
+    struct Result {
+        double avgUs = 0;
+        double p50Us = 0;
+        double p99Us = 0;
+        int failures = 0;
+    };
+
+    Result Summarize(std::vector<double>& samples, int failures) {
+        Result res;
+        res.failures = failures;
+        std::sort(samples.begin(), samples.end());
+        double sum = 0;
+        for (double v : samples) sum += v;
+        if (!samples.empty()) {
+            res.avgUs = sum / samples.size();
+            res.p50Us = samples[samples.size() / 2];
+            res.p99Us = samples[samples.size() * 99 / 100];
+        }
+        return res;
+    }
+
+    // pool 为空时走冷启动路径（与 Hooks 中池未命中的回退一致）
+    Result Run(uint16_t proxyPort, int rounds, int gapMs, const std::vector<uint8_t>& datagram,
+               Network::WarmPool<Association>* pool) {
+        std::vector<double> samples;
+        int failures = 0;
+        for (int i = 0; i < rounds; i++) {
+            // 请求间隔不计时，给后台补充留出时间
+            std::this_thread::sleep_for(std::chrono::milliseconds(gapMs));
+            const auto t0 = Clock::now();
+            Association assoc;
+            bool ok = (pool && pool->Acquire(&assoc)) || DialAssociation(proxyPort, &assoc);
+            ok = ok && FirstPacket(assoc, datagram);
+            const double us = std::chrono::duration<double, std::micro>(Clock::now() - t0).count();
+            if (assoc.controlFd >= 0) close(assoc.controlFd);
+            if (!ok) {
+                failures++;
+                continue;
+            }
+            samples.push_back(us);
+        }
+        return Summarize(samples, failures);
+    }
+}
+
+int main(int argc, char** argv) {
+    const int rounds = argc > 1 ? std::max(1, std::atoi(argv[1])) : 50;
+    const int oneWayMs = argc > 2 ? std::max(0, std::atoi(argv[2])) : 10;
+    const int gapMs = argc > 3 ? std::max(0, std::atoi(argv[3])) : 50;
+
+    BenchSupport::Socks5StandIn proxy;
+    BenchSupport::Socks5StandIn::Options options;
+    options.oneWayDelayMs = oneWayMs;
+    if (!proxy.Start(options)) {
+        std::fprintf(stderr, "stand-in proxy failed to start, errno=%d\n", errno);
+        return 1;
+    }
+    g_rttMs = oneWayMs * 2;
+    const uint16_t port = proxy.Port();
+
+    // QUIC Initial 包一般填充到 1200 字节
+    std::vector<uint8_t> datagram(S5::kMaxUdpHeaderBytes + 1200, 0xC3);
+    const size_t headerLen = S5::EncodeUdpHeader("203.0.113.7", 443, datagram.data(), datagram.size());
+    std::memset(datagram.data() + headerLen, 0xC3, 1200);
+    datagram.resize(headerLen + 1200);
+
+    std::printf("rounds=%d injected_rtt=%dms gap=%dms\n", rounds, g_rttMs, gapMs);
+    const Result cold = Run(port, rounds, gapMs, datagram, nullptr);
+
+    Network::WarmPool<Association> pool([port](Association* out) { return DialAssociation(port, out); },
+                                        [](Association a) { close(a.controlFd); });
+    Network::WarmPool<Association>::Options poolOptions;
+    poolOptions.maxIdle = 1;
+    pool.Configure(poolOptions);
+    pool.StartRefiller();
+    const Result warm = Run(port, rounds, gapMs, datagram, &pool);
+    pool.Stop();
+    pool.Drain();
+    const auto stats = pool.GetStats();
+
+    std::printf("  cold  (connect+greeting+ASSOCIATE+first packet): avg %8.0f us, p50 %8.0f us, p99 %8.0f us, "
+                "failures %d\n",
+                cold.avgUs, cold.p50Us, cold.p99Us, cold.failures);
+    std::printf("  warm  (pooled association+first packet)        : avg %8.0f us, p50 %8.0f us, p99 %8.0f us, "
+                "failures %d\n",
+                warm.avgUs, warm.p50Us, warm.p99Us, warm.failures);
+    std::printf("  pool: hits %llu, misses %llu, dialed %llu, expired %llu; relays opened %llu\n",
+                (unsigned long long)stats.hits, (unsigned long long)stats.misses, (unsigned long long)stats.dialed,
+                (unsigned long long)stats.expired, (unsigned long long)proxy.UdpAssociations());
+    proxy.Stop();
+    return 0;
+}
@@ -0,0 +1,165 @@
+// connected UDP 发送吞吐基准：改动前的“每包取 host + 编码头 + vector 拼接 + send”对比“预编码头 + 两段 iovec 聚集发送”
+// 用法：antigravity_bench_udp_gather_send [包数] [payload 字节]（默认 1000000 1200）
+// 发送端 connect 到本机 UDP 接收端（模拟 relay），接收线程持续排空；统计发送端 pps 与单包堆分配次数。
+// 两种写法都按 Hooks.cpp 的方式经过“加锁 + 按 socket 查上下文”，只有取头与拼包方式不同：
+// - legacy：复制 defaultTargetHost，EncodeUdpHeader 后 resize 新 vector 并 memcpy 头与 payload，再 send
+// - gather：拷出 UdpProxyContext 里预编码的头（几十字节），sendmsg 发送 [头, 用户 payload] 两段
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <new>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "network/Socks5Codec.hpp"
+
+// 统计全局 operator new 调用次数（仅基准进程内生效）
+static std::atomic<size_t> g_allocCount{0};
+
+// 理由同 bench_routing：GCC 对替换后的 new/delete 误报 -Wmismatched-new-delete
+#if defined(__GNUC__) && !defined(__clang__) && __GNUC__ >= 11
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+
+void* operator new(size_t size) {
+    g_allocCount.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, size_t) noexcept { std::free(p); }
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+    namespace S5 = Network::Socks5;
+
+    // 与 Hooks.cpp 的 UdpProxyContext 中和发送相关的字段一致
+    struct Context {
+        std::string defaultTargetHost;
+        uint16_t defaultTargetPort = 0;
+        uint8_t defaultHeader[S5::kMaxUdpHeaderBytes] = {};
+        size_t defaultHeaderLen = 0;
+    };
+
+    std::mutex g_mtx;
+    std::unordered_map<int, Context> g_contexts;
+
+    bool LegacySend(int fd, const uint8_t* payload, size_t len) {
+        std::string host;
+        uint16_t port = 0;
+        {
+            std::lock_guard<std::mutex> lock(g_mtx);
+            auto it = g_contexts.find(fd);
+            if (it == g_contexts.end()) return false;
+            host = it->second.defaultTargetHost;
+            port = it->second.defaultTargetPort;
+        }
+        uint8_t header[S5::kMaxUdpHeaderBytes];
+        const size_t headerLen = S5::EncodeUdpHeader(host, port, header, sizeof(header));
+        if (headerLen == 0) return false;
+        std::vector<uint8_t> packet;
+        packet.resize(headerLen + len);
+        std::memcpy(packet.data(), header, headerLen);
+        std::memcpy(packet.data() + headerLen, payload, len);
+        return send(fd, packet.data(), packet.size(), 0) == (ssize_t)packet.size();
+    }
+
+    bool GatherSend(int fd, const uint8_t* payload, size_t len) {
+        uint8_t header[S5::kMaxUdpHeaderBytes];
+        size_t headerLen = 0;
+        {
+            std::lock_guard<std::mutex> lock(g_mtx);
+            auto it = g_contexts.find(fd);
+            if (it == g_contexts.end() || it->second.defaultHeaderLen == 0) return false;
+            headerLen = it->second.defaultHeaderLen;
+            std::memcpy(header, it->second.defaultHeader, headerLen);
+        }
+        iovec iov[2];
+        iov[0].iov_base = header;
+        iov[0].iov_len = headerLen;
+        iov[1].iov_base = (void*)payload;
+        iov[1].iov_len = len;
+        msghdr msg{};
+        msg.msg_iov = iov;
+        msg.msg_iovlen = 2;
+        return sendmsg(fd, &msg, 0) == (ssize_t)(headerLen + len);
+    }
+
+    template <typename Fn>
+    void Run(const char* name, int fd, int packets, const std::vector<uint8_t>& payload, Fn fn) {
+        int failures = 0;
+        const size_t allocBefore = g_allocCount.load();
+        const auto t0 = Clock::now();
+        for (int i = 0; i < packets; i++) {
+            if (!fn(fd, payload.data(), payload.size())) failures++;
+        }
+        const double sec = std::chrono::duration<double>(Clock::now() - t0).count();
+        const double allocs = (double)(g_allocCount.load() - allocBefore) / packets;
+        std::printf("  %-30s %10.0f pps  %7.1f ns/pkt  %5.2f allocs/pkt  failures %d\n", name, packets / sec,
+                    sec * 1e9 / packets, allocs, failures);
+    }
+}
+
+int main(int argc, char** argv) {
+    const int packets = argc > 1 ? std::max(1, std::atoi(argv[1])) : 1000000;
+    const size_t payloadLen = argc > 2 ? (size_t)std::max(1, std::atoi(argv[2])) : 1200;
+
+    // 接收端（relay 替身）：非阻塞排空，丢包不影响发送端计时
+    const int rx = socket(AF_INET, SOCK_DGRAM, 0);
+    const int tx = socket(AF_INET, SOCK_DGRAM, 0);
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    socklen_t addrLen = sizeof(addr);
+    if (rx < 0 || tx < 0 || bind(rx, (sockaddr*)&addr, sizeof(addr)) != 0 ||
+        getsockname(rx, (sockaddr*)&addr, &addrLen) != 0 || connect(tx, (sockaddr*)&addr, sizeof(addr)) != 0) {
+        std::fprintf(stderr, "loopback UDP setup failed\n");
+        return 1;
+    }
+    int rcvbuf = 8 << 20;
+    setsockopt(rx, SOL_SOCKET, SO_RCVBUF, &rcvbuf, sizeof(rcvbuf));
+    timeval tv{0, 100000};
+    setsockopt(rx, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+    std::atomic<bool> stop{false};
+    std::atomic<uint64_t> received{0};
+    std::thread drain([&]() {
+        std::vector<uint8_t> buf(65536);
+        while (!stop.load()) {
+            if (recv(rx, buf.data(), buf.size(), 0) > 0) received.fetch_add(1, std::memory_order_relaxed);
+        }
+    });
+
+    const std::string host = "rr3---sn-example.googlevideo.com";
+    {
+        Context& ctx = g_contexts[tx];
+        ctx.defaultTargetHost = host;
+        ctx.defaultTargetPort = 443;
+        ctx.defaultHeaderLen = S5::EncodeUdpHeader(host, 443, ctx.defaultHeader, sizeof(ctx.defaultHeader));
+    }
+    std::vector<uint8_t> payload(payloadLen, 0xAB);
+
+    std::printf("connected UDP send, payload=%zu bytes, target=%s:443\n", payloadLen, host.c_str());
+    Run("legacy (Wrap + send)", tx, packets, payload, LegacySend);
+    Run("gather (cached header + iovec)", tx, packets, payload, GatherSend);
+
+    stop.store(true);
+    drain.join();
+    std::printf("  receiver drained %llu packets\n", (unsigned long long)received.load());
+    close(tx);
+    close(rx);
+    return 0;
+}
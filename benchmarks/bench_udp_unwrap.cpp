@@ -0,0 +1,202 @@
+// SOCKS5 UDP 接收解封装基准：改动前的“每包分配 len + 262 临时 vector → 解封装 → memcpy 到用户缓冲”
+// 对比“[用户缓冲, 栈上 tail] 分散接收 → 原地 memmove”（Network::UdpRecv::UnwrapInPlace）
+// 用法：antigravity_bench_udp_unwrap [每组包数] [目标 pps] [payload 字节]（默认 300000 100000 1200）
+// 两部分：
+// - 内存：不经 socket，用 memcpy 模拟内核拷贝，只看用户态开销（ns/包、堆分配/包）
+// - socket：发送线程按目标 pps 匀速向本机 UDP 发送，接收线程阻塞接收并解封装；
+//   统计接收线程在该负载下每包消耗的 CPU 时间（CLOCK_THREAD_CPUTIME_ID）与堆分配次数
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "network/UdpRecvBuffer.hpp"
+
+// 统计全局 operator new 调用次数（仅基准进程内生效）
+static std::atomic<size_t> g_allocCount{0};
+
+void* operator new(size_t size) {
+    g_allocCount.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, size_t) noexcept { std::free(p); }
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+    namespace S5 = Network::Socks5;
+    using Network::UdpRecv::kTailBytes;
+
+    volatile size_t g_sink = 0;
+
+    // 旧写法：临时 vector + 解析 + memcpy（与改动前 DetourRecv 相同，去掉 socket 部分）
+    size_t LegacyUnwrap(const uint8_t* packet, size_t n, uint8_t* user, size_t userLen) {
+        std::vector<uint8_t> tmp;
+        tmp.resize(userLen + kTailBytes);
+        std::memcpy(tmp.data(), packet, n); // 内核拷贝
+        S5::UdpHeader h;
+        if (S5::DecodeUdpHeader(tmp.data(), n, &h) != S5::DecodeStatus::Done) return 0;
+        const size_t payloadLen = std::min(n - h.length, userLen);
+        std::memcpy(user, tmp.data() + h.length, payloadLen);
+        return payloadLen;
+    }
+
+    size_t InPlaceUnwrap(const uint8_t* packet, size_t n, uint8_t* user, size_t userLen) {
+        uint8_t tail[kTailBytes];
+        const size_t inUser = std::min(n, userLen);
+        std::memcpy(user, packet, inUser); // 内核分散拷贝
+        std::memcpy(tail, packet + inUser, n - inUser);
+        Network::UdpRecv::Source src;
+        size_t payloadLen = 0;
+        Network::UdpRecv::UnwrapInPlace(user, userLen, tail, n, &src, &payloadLen);
+        return payloadLen;
+    }
+
+    double ThreadCpuNs() {
+        timespec ts{};
+        clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+        return ts.tv_sec * 1e9 + ts.tv_nsec;
+    }
+
+    template <typename Fn>
+    void RunMemory(const char* name, int packets, Fn fn) {
+        const size_t allocBefore = g_allocCount.load();
+        const auto t0 = Clock::now();
+        for (int i = 0; i < packets; i++) g_sink += fn();
+        const double ns = std::chrono::duration<double, std::nano>(Clock::now() - t0).count() / packets;
+        const double allocs = (double)(g_allocCount.load() - allocBefore) / packets;
+        std::printf("  %-28s %8.1f ns/pkt  %5.2f allocs/pkt\n", name, ns, allocs);
+    }
+
+    // 接收端：阻塞接收 packets 个包（或超时），返回每包 CPU ns；received 为实际收到的包数
+    template <typename RecvFn>
+    double Receive(int fd, int packets, RecvFn recvOne, int* received, double* allocsPerPkt) {
+        const size_t allocBefore = g_allocCount.load();
+        const double cpu0 = ThreadCpuNs();
+        int got = 0;
+        while (got < packets) {
+            if (!recvOne(fd)) break; // 超时：发送端已结束
+            got++;
+        }
+        const double cpu = ThreadCpuNs() - cpu0;
+        *received = got;
+        *allocsPerPkt = got ? (double)(g_allocCount.load() - allocBefore) / got : 0;
+        return got ? cpu / got : 0;
+    }
+
+    void Send(int fd, int packets, int pps, const std::vector<uint8_t>& datagram) {
+        const auto interval = std::chrono::nanoseconds(1000000000LL / std::max(1, pps));
+        auto next = Clock::now();
+        for (int i = 0; i < packets; i++) {
+            while (Clock::now() < next) {
+            }
+            send(fd, datagram.data(), datagram.size(), 0);
+            next += interval;
+        }
+    }
+
+    template <typename RecvFn>
+    void RunSocket(const char* name, int rx, int tx, int packets, int pps, const std::vector<uint8_t>& datagram,
+                   RecvFn recvOne) {
+        int received = 0;
+        double allocs = 0;
+        double cpuNs = 0;
+        const auto t0 = Clock::now();
+        std::thread receiver([&]() { cpuNs = Receive(rx, packets, recvOne, &received, &allocs); });
+        Send(tx, packets, pps, datagram);
+        receiver.join();
+        const double sec = std::chrono::duration<double>(Clock::now() - t0).count();
+        std::printf("  %-28s %8.0f pps received  %7.1f cpu-ns/pkt  %5.2f allocs/pkt  lost %d\n", name,
+                    received / sec, cpuNs, allocs, packets - received);
+    }
+}
+
+int main(int argc, char** argv) {
+    const int packets = argc > 1 ? std::max(1, std::atoi(argv[1])) : 300000;
+    const int pps = argc > 2 ? std::max(1, std::atoi(argv[2])) : 100000;
+    const size_t payloadLen = argc > 3 ? (size_t)std::max(1, std::atoi(argv[3])) : 1200;
+    const size_t userLen = 2048; // 应用的接收缓冲（QUIC 实现常用 1500~64K）
+
+    std::vector<uint8_t> datagram(S5::kMaxUdpHeaderBytes + payloadLen);
+    const size_t headerLen = S5::EncodeUdpHeader("203.0.113.7", 443, datagram.data(), datagram.size());
+    datagram.resize(headerLen + payloadLen);
+    std::memset(datagram.data() + headerLen, 0xCD, payloadLen);
+    std::vector<uint8_t> user(userLen);
+
+    std::printf("内存（payload=%zu, 用户缓冲=%zu）\n", payloadLen, userLen);
+    RunMemory("legacy (tmp vector + memcpy)", packets, [&]() {
+        return LegacyUnwrap(datagram.data(), datagram.size(), user.data(), user.size());
+    });
+    RunMemory("in-place (scatter + memmove)", packets, [&]() {
+        return InPlaceUnwrap(datagram.data(), datagram.size(), user.data(), user.size());
+    });
+
+    // 本机 UDP：rx 模拟应用侧已 connect 到 relay 的 socket
+    const int rx = socket(AF_INET, SOCK_DGRAM, 0);
+    const int tx = socket(AF_INET, SOCK_DGRAM, 0);
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    socklen_t addrLen = sizeof(addr);
+    if (rx < 0 || tx < 0 || bind(rx, (sockaddr*)&addr, sizeof(addr)) != 0 ||
+        getsockname(rx, (sockaddr*)&addr, &addrLen) != 0 || connect(tx, (sockaddr*)&addr, sizeof(addr)) != 0) {
+        std::fprintf(stderr, "loopback UDP setup failed\n");
+        return 1;
+    }
+    int rcvbuf = 8 << 20;
+    setsockopt(rx, SOL_SOCKET, SO_RCVBUF, &rcvbuf, sizeof(rcvbuf));
+    timeval tv{0, 200000};
+    setsockopt(rx, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+
+    std::printf("socket（目标 %d pps, payload=%zu）\n", pps, payloadLen);
+    RunSocket("legacy (tmp vector + memcpy)", rx, tx, packets, pps, datagram, [&](int fd) {
+        std::vector<uint8_t> tmp;
+        tmp.resize(user.size() + kTailBytes);
+        const ssize_t n = recv(fd, tmp.data(), tmp.size(), 0);
+        if (n <= 0) return false;
+        S5::UdpHeader h;
+        if (S5::DecodeUdpHeader(tmp.data(), (size_t)n, &h) != S5::DecodeStatus::Done) return true;
+        const size_t len = std::min((size_t)n - h.length, user.size());
+        std::memcpy(user.data(), tmp.data() + h.length, len);
+        g_sink += len;
+        return true;
+    });
+    RunSocket("in-place (scatter + memmove)", rx, tx, packets, pps, datagram, [&](int fd) {
+        uint8_t tail[kTailBytes];
+        iovec iov[2];
+        iov[0].iov_base = user.data();
+        iov[0].iov_len = user.size();
+        iov[1].iov_base = tail;
+        iov[1].iov_len = sizeof(tail);
+        msghdr msg{};
+        msg.msg_iov = iov;
+        msg.msg_iovlen = 2;
+        const ssize_t n = recvmsg(fd, &msg, 0);
+        if (n <= 0) return false;
+        Network::UdpRecv::Source src;
+        size_t len = 0;
+        Network::UdpRecv::UnwrapInPlace(user.data(), user.size(), tail, (size_t)n, &src, &len);
+        g_sink += len;
+        return true;
+    });
+
+    close(tx);
+    close(rx);
+    return 0;
+}
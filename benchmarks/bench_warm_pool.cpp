@@ -0,0 +1,193 @@
+// 代理预连接池基准：冷启动（TCP 建连 + 认证协商 + CONNECT）对比从池中取已协商连接（只剩 CONNECT）
+// 用法：antigravity_bench_warm_pool [轮数] [单程延迟ms] [请求间隔ms]（默认 50 10 50）
+// 代理为本地替身（benchmarks/socks5_stand_in.hpp），按批注入单程延迟。回环上的 TCP 建连没有网络延迟，
+// 这里在 connect 之后补睡一个 RTT 模拟真实链路上的三次握手。池使用 network/WarmPool.hpp，后台补充。
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "network/Socks5Codec.hpp"
+#include "network/WarmPool.hpp"
+#include "socks5_stand_in.hpp"
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+    namespace S5 = Network::Socks5;
+
+    int g_rttMs = 0;
+
+    int Dial(uint16_t port) {
+        int fd = socket(AF_INET, SOCK_STREAM, 0);
+        if (fd < 0) return -1;
+        int one = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        addr.sin_port = htons(port);
+        if (connect(fd, (sockaddr*)&addr, sizeof(addr)) != 0) {
+            close(fd);
+            return -1;
+        }
+        if (g_rttMs > 0) std::this_thread::sleep_for(std::chrono::milliseconds(g_rttMs));
+        return fd;
+    }
+
+    bool SendAll(int fd, const uint8_t* p, size_t len) {
+        while (len > 0) {
+            const ssize_t n = send(fd, p, len, MSG_NOSIGNAL);
+            if (n <= 0) return false;
+            p += n;
+            len -= (size_t)n;
+        }
+        return true;
+    }
+
+    bool RecvExact(int fd, uint8_t* p, size_t len) {
+        while (len > 0) {
+            const ssize_t n = recv(fd, p, len, 0);
+            if (n <= 0) return false;
+            p += n;
+            len -= (size_t)n;
+        }
+        return true;
+    }
+
+    bool Negotiate(int fd) {
+        uint8_t buf[S5::kGreetingBytes];
+        const size_t len = S5::EncodeGreeting(buf, sizeof(buf));
+        if (!SendAll(fd, buf, len) || !RecvExact(fd, buf, S5::kMethodReplyBytes)) return false;
+        uint8_t method = S5::AUTH_NO_ACCEPTABLE;
+        return S5::DecodeMethodReply(buf, S5::kMethodReplyBytes, &method) == S5::DecodeStatus::Done &&
+               method == S5::AUTH_NONE;
+    }
+
+    bool Connect(int fd, const std::string& host, uint16_t port) {
+        uint8_t buf[S5::kMaxRequestBytes];
+        const size_t len = S5::EncodeRequest(S5::CMD_CONNECT, host, port, buf, sizeof(buf));
+        if (len == 0 || !SendAll(fd, buf, len)) return false;
+        uint8_t reply[S5::kMaxReplyBytes];
+        size_t have = 0;
+        size_t want = S5::kMinReplyBytes;
+        for (;;) {
+            S5::Reply parsed;
+            size_t need = 0;
+            const auto st = S5::DecodeReply(reply, have, &parsed, &need);
+            if (st == S5::DecodeStatus::Done) return parsed.rep == S5::REPLY_SUCCESS;
+            if (st == S5::DecodeStatus::Invalid) return false;
+            want = std::max(want, need);
+            const ssize_t n = recv(fd, reply + have, want - have, 0);
+            if (n <= 0) return false;
+            have += (size_t)n;
+        }
+    }
+
+    struct Result {
+        double avgUs = 0;
+        double p50Us = 0;
+        double p99Us = 0;
+        int failures = 0;
+    };
+
+    Result Summarize(std::vector<double>& samples, int failures) {
+        Result res;
+        res.failures = failures;
+        std::sort(samples.begin(), samples.end());
+        double sum = 0;
+        for (double v : samples) sum += v;
+        if (!samples.empty()) {
+            res.avgUs = sum / samples.size();
+            res.p50Us = samples[samples.size() / 2];
+            res.p99Us = samples[samples.size() * 99 / 100];
+        }
+        return res;
+    }
+
+    // pool 为空时走冷启动路径（与 Hooks 中池未命中的回退一致）
+    Result Run(uint16_t proxyPort, int rounds, int gapMs, Network::WarmPool<int>* pool) {
+        std::vector<double> samples;
+        int failures = 0;
+        for (int i = 0; i < rounds; i++) {
+            // 请求间隔不计时，给后台补充留出时间
+            std::this_thread::sleep_for(std::chrono::milliseconds(gapMs));
+            const auto t0 = Clock::now();
+            int fd = -1;
+            if (!pool || !pool->Acquire(&fd)) {
+                fd = Dial(proxyPort);
+                if (fd >= 0 && !Negotiate(fd)) {
+                    close(fd);
+                    fd = -1;
+                }
+            }
+            const bool ok = fd >= 0 && Connect(fd, "example.com", 443);
+            const double us = std::chrono::duration<double, std::micro>(Clock::now() - t0).count();
+            if (fd >= 0) close(fd);
+            if (!ok) {
+                failures++;
+                continue;
+            }
+            samples.push_back(us);
+        }
+        return Summarize(samples, failures);
+    }
+}
+
+int main(int argc, char** argv) {
+    const int rounds = argc > 1 ? std::max(1, std::atoi(argv[1])) : 50;
+    const int oneWayMs = argc > 2 ? std::max(0, std::atoi(argv[2])) : 10;
+    const int gapMs = argc > 3 ? std::max(0, std::atoi(argv[3])) : 50;
+
+    BenchSupport::Socks5StandIn proxy;
+    BenchSupport::Socks5StandIn::Options options;
+    options.oneWayDelayMs = oneWayMs;
+    if (!proxy.Start(options)) {
+        std::fprintf(stderr, "stand-in proxy failed to start, errno=%d\n", errno);
+        return 1;
+    }
+    g_rttMs = oneWayMs * 2;
+    const uint16_t port = proxy.Port();
+
+    std::printf("rounds=%d injected_rtt=%dms gap=%dms\n", rounds, g_rttMs, gapMs);
+    const Result cold = Run(port, rounds, gapMs, nullptr);
+
+    Network::WarmPool<int> pool(
+        [port](int* out) {
+            const int fd = Dial(port);
+            if (fd < 0) return false;
+            if (!Negotiate(fd)) {
+                close(fd);
+                return false;
+            }
+            *out = fd;
+            return true;
+        },
+        [](int fd) { close(fd); });
+    Network::WarmPool<int>::Options poolOptions;
+    poolOptions.maxIdle = 2;
+    pool.Configure(poolOptions);
+    pool.StartRefiller();
+    const Result warm = Run(port, rounds, gapMs, &pool);
+    pool.Stop();
+    pool.Drain();
+    const auto stats = pool.GetStats();
+
+    std::printf("  cold  (connect+greeting+CONNECT): avg %8.0f us, p50 %8.0f us, p99 %8.0f us, failures %d\n",
+                cold.avgUs, cold.p50Us, cold.p99Us, cold.failures);
+    std::printf("  warm  (pooled+CONNECT)          : avg %8.0f us, p50 %8.0f us, p99 %8.0f us, failures %d\n",
+                warm.avgUs, warm.p50Us, warm.p99Us, warm.failures);
+    std::printf("  pool: hits %llu, misses %llu, dialed %llu, expired %llu\n", (unsigned long long)stats.hits,
+                (unsigned long long)stats.misses, (unsigned long long)stats.dialed, (unsigned long long)stats.expired);
+    proxy.Stop();
+    return 0;
+}
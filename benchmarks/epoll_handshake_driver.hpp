@@ -0,0 +1,186 @@
+#pragma once
+// 用 epoll 驱动 Network::ProxyHandshake（Linux 测试/基准共用）
+// 单线程推进任意数量的并发握手：非阻塞 connect -> 按状态机的 Next() 发送/读取/peek，
+// 遇到 EAGAIN 就回到 epoll 等待（边沿触发，同时关注读写）。与 Windows 上重叠 I/O 驱动的区别只在 I/O 层，
+// 协议推进完全由状态机决定。
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "network/ProxyHandshake.hpp"
+
+namespace BenchSupport {
+    class EpollHandshakeDriver {
+    public:
+        using Clock = std::chrono::steady_clock;
+        using Protocol = Network::ProxyHandshake::Protocol;
+        using Error = Network::ProxyHandshake::Error;
+
+        struct Result {
+            bool finished = false;
+            bool ok = false;
+            Error error = Error::None;
+            int sysError = 0;     // connect/send/recv 的 errno（协议失败为 0）
+            double latencyUs = 0; // 从发起 connect 到握手结束
+            int fd = -1;          // 握手成功后保留的隧道 socket（由调用方关闭）
+        };
+
+        EpollHandshakeDriver() : m_epoll(epoll_create1(0)) {}
+
+        ~EpollHandshakeDriver() {
+            for (auto& c : m_conns) {
+                if (c && c->fd >= 0) close(c->fd);
+            }
+            for (auto& r : m_results) {
+                if (r.fd >= 0) close(r.fd);
+            }
+            if (m_epoll >= 0) close(m_epoll);
+        }
+
+        // 发起一个到 127.0.0.1:proxyPort 的握手，返回结果下标；失败立即记录在结果里
+        size_t Add(uint16_t proxyPort, Protocol protocol, const std::string& host, uint16_t port) {
+            const size_t index = m_results.size();
+            m_results.emplace_back();
+            auto conn = std::make_unique<Conn>();
+            conn->index = index;
+            conn->start = Clock::now();
+            conn->fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK, 0);
+            if (conn->fd < 0) {
+                Finish(*conn, false, errno);
+                return index;
+            }
+            int one = 1;
+            setsockopt(conn->fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+            conn->hs.Start(protocol, host, port);
+            sockaddr_in addr{};
+            addr.sin_family = AF_INET;
+            addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+            addr.sin_port = htons(proxyPort);
+            if (connect(conn->fd, (sockaddr*)&addr, sizeof(addr)) != 0 && errno != EINPROGRESS) {
+                Finish(*conn, false, errno);
+                return index;
+            }
+            epoll_event ev{};
+            ev.events = EPOLLIN | EPOLLOUT | EPOLLET;
+            ev.data.ptr = conn.get();
+            epoll_ctl(m_epoll, EPOLL_CTL_ADD, conn->fd, &ev);
+            conn->registered = true;
+            m_pending++;
+            m_conns.push_back(std::move(conn));
+            return index;
+        }
+
+        // 推进全部握手，直到完成或超时；返回是否全部完成
+        bool Run(int timeoutMs) {
+            const auto deadline = Clock::now() + std::chrono::milliseconds(timeoutMs);
+            epoll_event events[512];
+            while (m_pending > 0) {
+                const auto left = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - Clock::now()).count();
+                if (left <= 0) return false;
+                const int n = epoll_wait(m_epoll, events, 512, (int)left);
+                for (int i = 0; i < n; i++) {
+                    Conn* c = static_cast<Conn*>(events[i].data.ptr);
+                    if (c->fd < 0) continue;
+                    if (c->connecting) {
+                        int soError = 0;
+                        socklen_t len = sizeof(soError);
+                        getsockopt(c->fd, SOL_SOCKET, SO_ERROR, &soError, &len);
+                        if (soError != 0) {
+                            Finish(*c, false, soError);
+                            continue;
+                        }
+                        if (!(events[i].events & EPOLLOUT)) continue;
+                        c->connecting = false;
+                    }
+                    Step(*c);
+                }
+            }
+            return true;
+        }
+
+        const std::vector<Result>& Results() const { return m_results; }
+        std::vector<Result>& Results() { return m_results; }
+
+    private:
+        struct Conn {
+            int fd = -1;
+            bool connecting = true;
+            bool registered = false;
+            size_t index = 0;
+            Clock::time_point start;
+            Network::ProxyHandshake hs;
+        };
+
+        // 推进到需要等待（EAGAIN）或结束
+        void Step(Conn& c) {
+            using Want = Network::ProxyHandshake::Want;
+            for (;;) {
+                switch (c.hs.Next()) {
+                    case Want::Send: {
+                        const ssize_t n = send(c.fd, c.hs.SendData(), c.hs.SendSize(), MSG_NOSIGNAL);
+                        if (n < 0) {
+                            if (errno == EAGAIN || errno == EWOULDBLOCK) return;
+                            Finish(c, false, errno);
+                            return;
+                        }
+                        c.hs.OnSent((size_t)n);
+                        break;
+                    }
+                    case Want::Recv:
+                    case Want::Peek: {
+                        const bool peek = c.hs.Next() == Want::Peek;
+                        const ssize_t n = recv(c.fd, c.hs.RecvBuffer(), c.hs.RecvSize(), peek ? MSG_PEEK : 0);
+                        if (n < 0) {
+                            if (errno == EAGAIN || errno == EWOULDBLOCK) return;
+                            Finish(c, false, errno);
+                            return;
+                        }
+                        if (peek) c.hs.OnPeeked((size_t)n);
+                        else c.hs.OnReceived((size_t)n);
+                        break;
+                    }
+                    case Want::Done:
+                        Finish(c, true, 0);
+                        return;
+                    case Want::Failed:
+                        Finish(c, false, 0);
+                        return;
+                }
+            }
+        }
+
+        void Finish(Conn& c, bool ok, int sysError) {
+            Result& r = m_results[c.index];
+            r.finished = true;
+            r.ok = ok;
+            r.error = c.hs.GetError();
+            r.sysError = sysError;
+            r.latencyUs = std::chrono::duration<double, std::micro>(Clock::now() - c.start).count();
+            if (c.registered) {
+                epoll_ctl(m_epoll, EPOLL_CTL_DEL, c.fd, nullptr);
+                c.registered = false;
+                m_pending--;
+            }
+            if (c.fd >= 0) {
+                if (ok) r.fd = c.fd;
+                else close(c.fd);
+            }
+            c.fd = -1;
+        }
+
+        int m_epoll = -1;
+        size_t m_pending = 0;
+        std::vector<std::unique_ptr<Conn>> m_conns;
+        std::vector<Result> m_results;
+    };
+}
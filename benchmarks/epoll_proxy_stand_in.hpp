@@ -0,0 +1,276 @@
+#pragma once
+// 基准/测试用的事件驱动代理替身（Linux epoll，单线程，可承载上万并发连接）
+// - 同一端口同时接受 SOCKS5（首字节 0x05，只支持无认证）与 HTTP CONNECT（首字节 'C'）
+// - CONNECT 不真正连接上游，直接回复成功，之后把收到的数据原样回显
+// - 注入延迟：每批读到的数据处理后，回复延迟 2 * oneWayDelayMs 写出（与 socks5_stand_in.hpp 相同，
+//   一批里同时到达的多条消息只付一次延迟）。延迟恒定，待写队列按到期时间天然有序
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <string>
+#include <thread>
+#include <unordered_map>
+
+#include "network/Socks5Codec.hpp"
+
+namespace BenchSupport {
+    class EpollProxyStandIn {
+    public:
+        struct Options {
+            int oneWayDelayMs = 0;
+        };
+
+        ~EpollProxyStandIn() { Stop(); }
+
+        // 监听 127.0.0.1 的随机端口并启动事件线程，返回是否成功
+        bool Start(const Options& options) {
+            if (!Listen(options)) return false;
+            m_loop = std::thread([this]() { Run(); });
+            return true;
+        }
+
+        // 只创建监听 socket，不启动线程（调用方在自己的线程/子进程里调用 Run）
+        bool Listen(const Options& options) {
+            m_options = options;
+            m_listen = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK, 0);
+            if (m_listen < 0) return false;
+            int one = 1;
+            setsockopt(m_listen, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+            sockaddr_in addr{};
+            addr.sin_family = AF_INET;
+            addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+            socklen_t len = sizeof(addr);
+            if (bind(m_listen, (sockaddr*)&addr, sizeof(addr)) != 0 || listen(m_listen, 65535) != 0 ||
+                getsockname(m_listen, (sockaddr*)&addr, &len) != 0) {
+                close(m_listen);
+                m_listen = -1;
+                return false;
+            }
+            m_port = ntohs(addr.sin_port);
+            m_epoll = epoll_create1(0);
+            m_wake = eventfd(0, EFD_NONBLOCK);
+            if (m_epoll < 0 || m_wake < 0) return false;
+            Watch(m_listen, EPOLLIN, &m_listen);
+            Watch(m_wake, EPOLLIN, &m_wake);
+            return true;
+        }
+
+        void Stop() {
+            if (m_listen < 0) return;
+            m_stopping.store(true);
+            const uint64_t one = 1;
+            (void)!write(m_wake, &one, sizeof(one));
+            if (m_loop.joinable()) m_loop.join();
+            for (auto& kv : m_conns) close(kv.first);
+            m_conns.clear();
+            close(m_listen);
+            close(m_wake);
+            close(m_epoll);
+            m_listen = -1;
+        }
+
+        uint16_t Port() const { return m_port; }
+        uint64_t Handshakes() const { return m_handshakes.load(); }
+
+        // 事件循环（Stop 后返回）
+        void Run() {
+            epoll_event events[256];
+            while (!m_stopping.load()) {
+                const int n = epoll_wait(m_epoll, events, 256, NextTimeoutMs());
+                for (int i = 0; i < n; i++) {
+                    void* tag = events[i].data.ptr;
+                    if (tag == &m_wake) continue;
+                    if (tag == &m_listen) {
+                        AcceptAll();
+                        continue;
+                    }
+                    const int fd = (int)(intptr_t)tag;
+                    if (events[i].events & (EPOLLIN | EPOLLHUP | EPOLLERR)) OnReadable(fd);
+                    if (events[i].events & EPOLLOUT) Flush(fd);
+                }
+                FlushDue();
+            }
+        }
+
+    private:
+        using Clock = std::chrono::steady_clock;
+        enum class Stage { Detect, Greeting, Request, HttpHeader, Relay };
+
+        struct Conn {
+            uint64_t id = 0;
+            Stage stage = Stage::Detect;
+            std::string in;
+            std::string out; // 已到期但 socket 暂不可写的数据
+        };
+
+        struct Delayed {
+            Clock::time_point due;
+            int fd;
+            uint64_t id;
+            std::string bytes;
+        };
+
+        void Watch(int fd, uint32_t events, void* tag) {
+            epoll_event ev{};
+            ev.events = events;
+            ev.data.ptr = tag;
+            epoll_ctl(m_epoll, EPOLL_CTL_ADD, fd, &ev);
+        }
+
+        int NextTimeoutMs() const {
+            if (m_delayed.empty()) return 100;
+            const auto left = std::chrono::duration_cast<std::chrono::milliseconds>(m_delayed.front().due - Clock::now());
+            return left.count() <= 0 ? 0 : (int)left.count() + 1;
+        }
+
+        void AcceptAll() {
+            for (;;) {
+                const int fd = accept4(m_listen, nullptr, nullptr, SOCK_NONBLOCK);
+                if (fd < 0) return;
+                int one = 1;
+                setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+                Conn& c = m_conns[fd];
+                c = Conn();
+                c.id = ++m_nextId;
+                Watch(fd, EPOLLIN | EPOLLOUT | EPOLLET, (void*)(intptr_t)fd);
+            }
+        }
+
+        void CloseConn(int fd) {
+            epoll_ctl(m_epoll, EPOLL_CTL_DEL, fd, nullptr);
+            close(fd);
+            m_conns.erase(fd);
+        }
+
+        void OnReadable(int fd) {
+            auto it = m_conns.find(fd);
+            if (it == m_conns.end()) return;
+            Conn& c = it->second;
+            char chunk[4096];
+            bool eof = false;
+            for (;;) {
+                const ssize_t n = recv(fd, chunk, sizeof(chunk), 0);
+                if (n > 0) {
+                    c.in.append(chunk, (size_t)n);
+                    continue;
+                }
+                if (n == 0 || (errno != EAGAIN && errno != EWOULDBLOCK)) eof = true;
+                break;
+            }
+            std::string reply;
+            if (!Process(c, &reply)) eof = true;
+            if (!reply.empty()) {
+                if (m_options.oneWayDelayMs <= 0) {
+                    c.out += reply;
+                    Flush(fd);
+                } else {
+                    m_delayed.push_back(Delayed{Clock::now() + std::chrono::milliseconds(2 * m_options.oneWayDelayMs),
+                                                fd, c.id, std::move(reply)});
+                }
+            }
+            if (eof) CloseConn(fd);
+        }
+
+        // 解析已到达的数据，生成回复；协议错误返回 false
+        bool Process(Conn& c, std::string* reply) {
+            namespace S5 = Network::Socks5;
+            for (;;) {
+                if (c.in.empty()) return true;
+                switch (c.stage) {
+                    case Stage::Detect:
+                        if ((uint8_t)c.in[0] == S5::VERSION) c.stage = Stage::Greeting;
+                        else if (c.in[0] == 'C') c.stage = Stage::HttpHeader;
+                        else return false;
+                        break;
+                    case Stage::Greeting: {
+                        if (c.in.size() < 2 || c.in.size() < 2u + (uint8_t)c.in[1]) return true;
+                        c.in.erase(0, 2u + (uint8_t)c.in[1]);
+                        reply->push_back((char)S5::VERSION);
+                        reply->push_back((char)S5::AUTH_NONE);
+                        c.stage = Stage::Request;
+                        break;
+                    }
+                    case Stage::Request: {
+                        // 请求与响应同构（CMD 位于 REP 的位置），直接复用响应解码器
+                        S5::Reply req;
+                        size_t need = 0;
+                        const auto st = S5::DecodeReply((const uint8_t*)c.in.data(), c.in.size(), &req, &need);
+                        if (st == S5::DecodeStatus::Invalid) return false;
+                        if (st != S5::DecodeStatus::Done) return true;
+                        c.in.erase(0, req.length);
+                        static const char kReply[10] = {5, 0, 0, 1, 0, 0, 0, 0, 0, 0};
+                        reply->append(kReply, sizeof(kReply));
+                        m_handshakes.fetch_add(1);
+                        c.stage = Stage::Relay;
+                        break;
+                    }
+                    case Stage::HttpHeader: {
+                        const size_t end = c.in.find("\r\n\r\n");
+                        if (end == std::string::npos) return c.in.size() <= 4096;
+                        c.in.erase(0, end + 4);
+                        reply->append("HTTP/1.1 200 Connection Established\r\n\r\n");
+                        m_handshakes.fetch_add(1);
+                        c.stage = Stage::Relay;
+                        break;
+                    }
+                    case Stage::Relay:
+                        reply->append(c.in);
+                        c.in.clear();
+                        return true;
+                }
+            }
+        }
+
+        void FlushDue() {
+            const auto now = Clock::now();
+            while (!m_delayed.empty() && m_delayed.front().due <= now) {
+                Delayed d = std::move(m_delayed.front());
+                m_delayed.pop_front();
+                auto it = m_conns.find(d.fd);
+                if (it == m_conns.end() || it->second.id != d.id) continue;
+                it->second.out += d.bytes;
+                Flush(d.fd);
+            }
+        }
+
+        void Flush(int fd) {
+            auto it = m_conns.find(fd);
+            if (it == m_conns.end()) return;
+            std::string& out = it->second.out;
+            while (!out.empty()) {
+                const ssize_t n = send(fd, out.data(), out.size(), MSG_NOSIGNAL);
+                if (n > 0) {
+                    out.erase(0, (size_t)n);
+                    continue;
+                }
+                if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) return; // 等 EPOLLOUT
+                CloseConn(fd);
+                return;
+            }
+        }
+
+        Options m_options;
+        int m_listen = -1;
+        int m_epoll = -1;
+        int m_wake = -1;
+        uint16_t m_port = 0;
+        std::atomic<bool> m_stopping{false};
+        std::thread m_loop;
+        std::unordered_map<int, Conn> m_conns;
+        std::deque<Delayed> m_delayed;
+        uint64_t m_nextId = 0;
+        std::atomic<uint64_t> m_handshakes{0};
+    };
+}
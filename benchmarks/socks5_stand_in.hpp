@@ -0,0 +1,242 @@
+#pragma once
+// 基准用的本地 SOCKS5 代理替身（POSIX，仅 Linux 基准使用）
+// - 只支持无认证；CONNECT 不真正连接上游，直接回复成功（BND=0.0.0.0:0），之后把收到的数据原样回显
+// - 注入延迟：每批读到的数据先等 oneWayDelayMs 再处理（客户端 -> 代理），每批回复再等 oneWayDelayMs
+//   才写出（代理 -> 客户端）。一批里同时到达的多条消息只付一次延迟，因此流水线握手比逐步握手少一个 RTT
+// - rejectPipelining：模拟不接受流水线的严格代理——回复认证请求后，若同一批里还有数据就直接断开
+// - UDP ASSOCIATE：在 127.0.0.1 随机端口开一个 relay（BND 即该地址），把收到的数据报连同 SOCKS5 头
+//   原样回给发送方（收到后同样先等 oneWayDelayMs、回写前再等 oneWayDelayMs）；控制连接断开时关闭 relay
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "network/Socks5Codec.hpp"
+
+namespace BenchSupport {
+    class Socks5StandIn {
+    public:
+        struct Options {
+            int oneWayDelayMs = 0;
+            bool rejectPipelining = false;
+        };
+
+        ~Socks5StandIn() { Stop(); }
+
+        // 监听 127.0.0.1 的随机端口，返回是否成功
+        bool Start(const Options& options) {
+            m_options = options;
+            m_listen = socket(AF_INET, SOCK_STREAM, 0);
+            if (m_listen < 0) return false;
+            int one = 1;
+            setsockopt(m_listen, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+            sockaddr_in addr{};
+            addr.sin_family = AF_INET;
+            addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+            socklen_t len = sizeof(addr);
+            if (bind(m_listen, (sockaddr*)&addr, sizeof(addr)) != 0 || listen(m_listen, 1024) != 0 ||
+                getsockname(m_listen, (sockaddr*)&addr, &len) != 0) {
+                close(m_listen);
+                m_listen = -1;
+                return false;
+            }
+            m_port = ntohs(addr.sin_port);
+            m_acceptor = std::thread([this]() { AcceptLoop(); });
+            return true;
+        }
+
+        void Stop() {
+            if (m_listen < 0) return;
+            m_stopping.store(true);
+            shutdown(m_listen, SHUT_RDWR);
+            if (m_acceptor.joinable()) m_acceptor.join();
+            close(m_listen);
+            m_listen = -1;
+            std::vector<std::thread> workers;
+            {
+                std::lock_guard<std::mutex> lock(m_mtx);
+                for (int fd : m_conns) shutdown(fd, SHUT_RDWR);
+                workers.swap(m_workers);
+            }
+            for (auto& w : workers) w.join();
+        }
+
+        uint16_t Port() const { return m_port; }
+        uint64_t Handshakes() const { return m_handshakes.load(); }
+        uint64_t Rejected() const { return m_rejected.load(); }
+        uint64_t UdpAssociations() const { return m_udpAssociations.load(); }
+
+    private:
+        void AcceptLoop() {
+            while (!m_stopping.load()) {
+                int fd = accept(m_listen, nullptr, nullptr);
+                if (fd < 0) {
+                    if (m_stopping.load()) return;
+                    continue;
+                }
+                int one = 1;
+                setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+                std::lock_guard<std::mutex> lock(m_mtx);
+                m_conns.push_back(fd);
+                m_workers.emplace_back([this, fd]() { Serve(fd); });
+            }
+        }
+
+        void Delay() const {
+            if (m_options.oneWayDelayMs > 0) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(m_options.oneWayDelayMs));
+            }
+        }
+
+        static bool WriteAll(int fd, const uint8_t* p, size_t len) {
+            while (len > 0) {
+                const ssize_t n = send(fd, p, len, MSG_NOSIGNAL);
+                if (n <= 0) return false;
+                p += n;
+                len -= (size_t)n;
+            }
+            return true;
+        }
+
+        struct UdpRelay {
+            int fd = -1;
+            std::atomic<bool> stop{false};
+            std::thread thread;
+        };
+
+        bool StartUdpRelay(UdpRelay* relay, sockaddr_in* bnd) {
+            relay->fd = socket(AF_INET, SOCK_DGRAM, 0);
+            if (relay->fd < 0) return false;
+            bnd->sin_family = AF_INET;
+            bnd->sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+            socklen_t len = sizeof(*bnd);
+            timeval tv{0, 50000}; // 定期醒来检查 stop
+            if (bind(relay->fd, (sockaddr*)bnd, sizeof(*bnd)) != 0 ||
+                getsockname(relay->fd, (sockaddr*)bnd, &len) != 0 ||
+                setsockopt(relay->fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv)) != 0) {
+                close(relay->fd);
+                relay->fd = -1;
+                return false;
+            }
+            m_udpAssociations.fetch_add(1);
+            relay->thread = std::thread([this, relay]() {
+                std::vector<uint8_t> buf(65536);
+                while (!relay->stop.load()) {
+                    sockaddr_in from{};
+                    socklen_t fromLen = sizeof(from);
+                    const ssize_t n = recvfrom(relay->fd, buf.data(), buf.size(), 0, (sockaddr*)&from, &fromLen);
+                    if (n <= 0) continue;
+                    Delay();
+                    Delay();
+                    sendto(relay->fd, buf.data(), (size_t)n, 0, (sockaddr*)&from, fromLen);
+                }
+            });
+            return true;
+        }
+
+        static void StopUdpRelay(UdpRelay* relay) {
+            if (relay->fd < 0) return;
+            relay->stop.store(true);
+            if (relay->thread.joinable()) relay->thread.join();
+            close(relay->fd);
+            relay->fd = -1;
+        }
+
+        void Serve(int fd) {
+            enum class Stage { Greeting, Request, Relay };
+            Stage stage = Stage::Greeting;
+            UdpRelay relay;
+            std::vector<uint8_t> in;
+            uint8_t chunk[4096];
+            for (;;) {
+                const ssize_t n = recv(fd, chunk, sizeof(chunk), 0);
+                if (n <= 0) break;
+                Delay();
+                in.insert(in.end(), chunk, chunk + n);
+
+                std::vector<uint8_t> out;
+                bool closeNow = false;
+                for (bool progressed = true; progressed && !closeNow;) {
+                    progressed = false;
+                    if (stage == Stage::Greeting && in.size() >= 2 && in.size() >= 2u + in[1]) {
+                        const size_t used = 2u + in[1];
+                        in.erase(in.begin(), in.begin() + used);
+                        out.push_back(Network::Socks5::VERSION);
+                        out.push_back(Network::Socks5::AUTH_NONE);
+                        if (m_options.rejectPipelining && !in.empty()) {
+                            m_rejected.fetch_add(1);
+                            closeNow = true;
+                            break;
+                        }
+                        stage = Stage::Request;
+                        progressed = true;
+                    } else if (stage == Stage::Request) {
+                        // 请求与响应同构（CMD 位于 REP 的位置），直接复用响应解码器
+                        Network::Socks5::Reply req;
+                        size_t need = 0;
+                        const auto st = Network::Socks5::DecodeReply(in.data(), in.size(), &req, &need);
+                        if (st == Network::Socks5::DecodeStatus::Invalid) {
+                            closeNow = true;
+                            break;
+                        }
+                        if (st != Network::Socks5::DecodeStatus::Done) break;
+                        in.erase(in.begin(), in.begin() + req.length);
+                        uint8_t reply[10] = {Network::Socks5::VERSION, Network::Socks5::REPLY_SUCCESS, 0x00,
+                                             Network::Socks5::ATYP_IPV4, 0, 0, 0, 0, 0, 0};
+                        if (req.rep == Network::Socks5::CMD_UDP_ASSOCIATE) {
+                            sockaddr_in bnd{};
+                            if (relay.fd >= 0 || !StartUdpRelay(&relay, &bnd)) {
+                                closeNow = true;
+                                break;
+                            }
+                            std::memcpy(reply + 4, &bnd.sin_addr, 4);
+                            std::memcpy(reply + 8, &bnd.sin_port, 2);
+                        }
+                        out.insert(out.end(), reply, reply + sizeof(reply));
+                        m_handshakes.fetch_add(1);
+                        stage = Stage::Relay;
+                        progressed = true;
+                    } else if (stage == Stage::Relay && !in.empty()) {
+                        out.insert(out.end(), in.begin(), in.end());
+                        in.clear();
+                    }
+                }
+                if (!out.empty()) {
+                    Delay();
+                    if (!WriteAll(fd, out.data(), out.size())) break;
+                }
+                if (closeNow) break;
+            }
+            StopUdpRelay(&relay);
+            std::lock_guard<std::mutex> lock(m_mtx);
+            for (size_t i = 0; i < m_conns.size(); i++) {
+                if (m_conns[i] == fd) {
+                    m_conns.erase(m_conns.begin() + (long)i);
+                    break;
+                }
+            }
+            close(fd);
+        }
+
+        Options m_options;
+        int m_listen = -1;
+        uint16_t m_port = 0;
+        std::atomic<bool> m_stopping{false};
+        std::thread m_acceptor;
+        std::mutex m_mtx;
+        std::vector<int> m_conns;
+        std::vector<std::thread> m_workers;
+        std::atomic<uint64_t> m_handshakes{0};
+        std::atomic<uint64_t> m_rejected{0};
+        std::atomic<uint64_t> m_udpAssociations{0};
+    };
+}
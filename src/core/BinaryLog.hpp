@@ -0,0 +1,755 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <type_traits>
+#include <vector>
+#ifdef _WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#else
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+namespace Core {
+    // ============= 延迟格式化的二进制日志（.blog） =============
+    // 设计意图：Debug 级诊断在热路径上的主要开销是字符串拼接（to_string、地址转文本、十六进制转储），
+    // 而不是 I/O。这里参考 NanoLog：每个调用点只在首次执行时登记一次“格式串 + 参数类型签名”，
+    // 之后每次只把 {格式 id, 时间戳, 原始参数} 追加到本线程的字节环形缓冲；后台线程定期把各线程
+    // 缓冲成块写入文件，格式串随文件写出一次。文本化推迟到离线解码（tools/blog_decode）。
+    //
+    // 格式串使用 {} 占位，参数类型决定渲染方式：整数十进制、BinaryLogHex 十六进制字节、
+    // BinaryLogAddr 为 ip:port。解码器与在线文本回退共用同一个渲染函数，输出完全一致。
+    //
+    // 文件布局（小端）：
+    //   文件头 32 字节：magic "AGPBLOG\0"、version、pid、打开时的墙钟（Unix ns）与单调时钟（ns）
+    //   之后为帧序列：[u8 类型][u32 负载长度][负载]
+    //     1 = 格式定义：u16 id、u8 等级、u32 行号、str 文件、str 格式串、str 类型签名
+    //     2 = 记录块：u32 tid，随后为若干条记录 [u16 id][u64 单调时钟 ns][参数...]
+    //     3 = 丢弃统计：u32 tid、u64 条数（线程缓冲满时丢弃新记录）
+    //   str = varint 长度 + 字节。每个文件都从头写出全部已登记格式，单个文件可独立解码。
+
+    // 参数包装：按字节记录（最多 kMaxHexBytes 字节），解码时渲染为 "05 01 00"
+    struct BinaryLogHex {
+        const void* data;
+        size_t len;
+    };
+
+    // 参数包装：记录 IPv4/IPv6 地址与端口，解码时渲染为 "1.2.3.4:443" / "[::1]:443"
+    struct BinaryLogAddr {
+        const sockaddr* addr;
+    };
+
+    class BinaryLog {
+    public:
+        static constexpr char kMagic[8] = {'A', 'G', 'P', 'B', 'L', 'O', 'G', 0};
+        static constexpr uint32_t kVersion = 1;
+        static constexpr size_t kFileHeaderBytes = 32;
+        static constexpr uint8_t kFrameFormat = 1;
+        static constexpr uint8_t kFrameChunk = 2;
+        static constexpr uint8_t kFrameDropped = 3;
+
+        static constexpr size_t kThreadBufferBytes = 64 * 1024;
+        static constexpr size_t kMaxRecordBytes = 2048;
+        static constexpr size_t kMaxStringBytes = 512;
+        static constexpr size_t kMaxHexBytes = 256;
+        static constexpr int kFlushIntervalMs = 50;
+
+        // ---------- 参数类型签名（编译期） ----------
+        template <typename T, typename = void>
+        struct ArgTag;
+
+        template <typename... Args>
+        struct Signature {
+            static constexpr char value[sizeof...(Args) + 1] = {ArgTag<std::decay_t<Args>>::value..., 0};
+        };
+
+        // 仅用于 decltype：由调用点的实参推导签名，不求值实参
+        template <typename... Args>
+        static Signature<Args...> SignatureOf(const Args&...);
+
+        static BinaryLog& Instance() {
+            // 有意不析构：进程退出时写线程可能已被终止，析构中 join 会卡住（退出路径见 Stop）
+            static BinaryLog* s_instance = new BinaryLog();
+            return *s_instance;
+        }
+
+        // 登记调用点（每个调用点只在首次执行时调用一次），返回格式 id（从 1 开始）
+        uint16_t Register(int level, const char* file, int line, const char* fmt, const char* signature) {
+            std::lock_guard<std::mutex> lock(m_formatMtx);
+            if (m_formats.size() >= 0xFFFF) return 0;
+            m_formats.push_back(Format{level, line, BaseName(file), fmt, signature});
+            return static_cast<uint16_t>(m_formats.size());
+        }
+
+        // 开始写二进制日志。pathProvider 每批调用一次，返回值变化即切换文件（按日期/进程命名由调用方决定）；
+        // 单个文件超过 maxBytes 时截断重写（与文本日志的“超限覆盖”一致）
+        bool Start(std::function<std::string()> pathProvider, uint64_t maxBytes) {
+            std::lock_guard<std::mutex> lock(m_flushMtx);
+            if (m_running.load(std::memory_order_relaxed)) return true;
+            m_pathProvider = std::move(pathProvider);
+            m_maxBytes = maxBytes;
+            m_stop.store(false, std::memory_order_relaxed);
+            m_running.store(true, std::memory_order_release);
+            m_thread = std::thread([this]() { Run(); });
+            return true;
+        }
+
+        bool IsRunning() const { return m_running.load(std::memory_order_acquire); }
+
+        // 停止记录并写出积压。join=false 用于持有 Loader Lock 的退出路径：只通知写线程，
+        // 且仅在拿得到刷新锁时写出（写线程可能已被强制终止在锁内）
+        void Stop(bool join) {
+            if (!m_running.exchange(false, std::memory_order_acq_rel)) return;
+            {
+                std::lock_guard<std::mutex> lock(m_wakeMtx);
+                m_stop.store(true, std::memory_order_relaxed);
+            }
+            m_wake.notify_one();
+            if (join) {
+                if (m_thread.joinable()) m_thread.join();
+                Flush();
+                CloseFile();
+            } else {
+                std::unique_lock<std::mutex> lock(m_flushMtx, std::try_to_lock);
+                if (lock.owns_lock()) {
+                    FlushLocked();
+                    if (m_file) std::fflush(m_file);
+                }
+            }
+        }
+
+        // 立即把各线程缓冲写入文件
+        void Flush() {
+            std::lock_guard<std::mutex> lock(m_flushMtx);
+            FlushLocked();
+        }
+
+        // 热路径：编码一条记录追加到本线程缓冲；缓冲满时丢弃并计数
+        template <typename... Args>
+        void Record(uint16_t id, const Args&... args) {
+            if (id == 0) return;
+            ThreadBuffer* buffer = CurrentBuffer();
+            if (!buffer) return;
+            uint8_t scratch[kMaxRecordBytes];
+            Encoder enc(scratch, sizeof(scratch));
+            enc.Fixed16(id);
+            enc.Fixed64(NowNs());
+            (EncodeArg(&enc, args), ...);
+            if (enc.Overflowed() || !buffer->Write(scratch, enc.Size())) {
+                buffer->dropped.fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+
+        // 未开启二进制日志时的文本回退：与解码器同一渲染路径
+        template <typename... Args>
+        static std::string FormatText(const char* fmt, const Args&... args) {
+            uint8_t scratch[kMaxRecordBytes];
+            Encoder enc(scratch, sizeof(scratch));
+            (EncodeArg(&enc, args), ...);
+            Reader reader(scratch, enc.Overflowed() ? 0 : enc.Size());
+            std::string out;
+            Render(fmt, Signature<Args...>::value, &reader, &out);
+            return out;
+        }
+
+        // 已丢弃记录总数（所有线程）
+        uint64_t DroppedCount() {
+            std::lock_guard<std::mutex> lock(m_buffersMtx);
+            uint64_t total = m_retiredDropped;
+            for (ThreadBuffer* b : m_buffers) total += b->dropped.load(std::memory_order_relaxed);
+            return total;
+        }
+
+        // ---------- 解码（离线工具与测试共用） ----------
+        struct DecodedRecord {
+            int64_t wallNs = 0; // Unix 纪元纳秒
+            uint32_t pid = 0;
+            uint32_t tid = 0;
+            int level = 0;
+            std::string file;
+            int line = 0;
+            std::string text;   // 已渲染；丢弃统计帧渲染为说明文字，level 取 -1
+        };
+
+        // 解码整个 .blog 文件内容；遇到截断/损坏的尾部时停止并返回 false（之前的记录已回调）
+        static bool Decode(const uint8_t* data, size_t size, const std::function<void(const DecodedRecord&)>& onRecord) {
+            if (size < kFileHeaderBytes || std::memcmp(data, kMagic, sizeof(kMagic)) != 0) return false;
+            Reader header(data + 8, kFileHeaderBytes - 8);
+            uint32_t version = 0, pid = 0;
+            uint64_t wallAtOpen = 0, tickAtOpen = 0;
+            if (!header.Fixed32(&version) || version != kVersion || !header.Fixed32(&pid) ||
+                !header.Fixed64(&wallAtOpen) || !header.Fixed64(&tickAtOpen)) {
+                return false;
+            }
+
+            std::vector<Format> formats;
+            size_t pos = kFileHeaderBytes;
+            while (pos < size) {
+                if (size - pos < 5) return false;
+                const uint8_t type = data[pos];
+                uint32_t len = 0;
+                std::memcpy(&len, data + pos + 1, 4);
+                pos += 5;
+                if (size - pos < len) return false;
+                Reader frame(data + pos, len);
+                pos += len;
+
+                if (type == kFrameFormat) {
+                    uint16_t id = 0;
+                    uint8_t level = 0;
+                    uint32_t line = 0;
+                    Format f;
+                    if (!frame.Fixed16(&id) || !frame.Fixed8(&level) || !frame.Fixed32(&line) ||
+                        !frame.String(&f.file) || !frame.String(&f.fmt) || !frame.String(&f.signature)) {
+                        return false;
+                    }
+                    f.level = level;
+                    f.line = static_cast<int>(line);
+                    if (id == 0) return false;
+                    if (formats.size() < id) formats.resize(id);
+                    formats[id - 1] = std::move(f);
+                } else if (type == kFrameChunk || type == kFrameDropped) {
+                    uint32_t tid = 0;
+                    if (!frame.Fixed32(&tid)) return false;
+                    DecodedRecord rec;
+                    rec.pid = pid;
+                    rec.tid = tid;
+                    if (type == kFrameDropped) {
+                        uint64_t count = 0;
+                        if (!frame.Fixed64(&count)) return false;
+                        rec.level = -1;
+                        rec.wallNs = static_cast<int64_t>(wallAtOpen);
+                        rec.text = "线程缓冲已满，丢弃 " + std::to_string(count) + " 条";
+                        onRecord(rec);
+                        continue;
+                    }
+                    while (!frame.AtEnd()) {
+                        uint16_t id = 0;
+                        uint64_t tick = 0;
+                        if (!frame.Fixed16(&id) || !frame.Fixed64(&tick) || id == 0 || id > formats.size() ||
+                            formats[id - 1].fmt.empty()) {
+                            return false;
+                        }
+                        const Format& f = formats[id - 1];
+                        rec.level = f.level;
+                        rec.file = f.file;
+                        rec.line = f.line;
+                        rec.wallNs = static_cast<int64_t>(wallAtOpen) + (static_cast<int64_t>(tick) - static_cast<int64_t>(tickAtOpen));
+                        rec.text.clear();
+                        if (!Render(f.fmt.c_str(), f.signature.c_str(), &frame, &rec.text)) return false;
+                        onRecord(rec);
+                    }
+                } else {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+    private:
+        struct Format {
+            int level = 0;
+            int line = 0;
+            std::string file;
+            std::string fmt;
+            std::string signature;
+        };
+
+        // ---------- 编码 ----------
+        class Encoder {
+        public:
+            Encoder(uint8_t* buf, size_t cap) : m_buf(buf), m_cap(cap) {}
+            void Fixed8(uint8_t v) { Bytes(&v, 1); }
+            void Fixed16(uint16_t v) { Bytes(&v, 2); }
+            void Fixed32(uint32_t v) { Bytes(&v, 4); }
+            void Fixed64(uint64_t v) { Bytes(&v, 8); }
+            void Varint(uint64_t v) {
+                while (v >= 0x80) {
+                    Fixed8(static_cast<uint8_t>(v | 0x80));
+                    v >>= 7;
+                }
+                Fixed8(static_cast<uint8_t>(v));
+            }
+            void Bytes(const void* p, size_t n) {
+                if (n > m_cap - m_size) {
+                    m_overflow = true;
+                    return;
+                }
+                std::memcpy(m_buf + m_size, p, n);
+                m_size += n;
+            }
+            // 长度前缀字节串；放不下时截断到剩余空间（保证记录仍可解码）
+            void LengthPrefixed(const void* p, size_t n, size_t limit) {
+                if (n > limit) n = limit;
+                const size_t room = (m_cap > m_size + 10) ? (m_cap - m_size - 10) : 0;
+                if (n > room) n = room;
+                Varint(n);
+                Bytes(p, n);
+            }
+            size_t Size() const { return m_size; }
+            bool Overflowed() const { return m_overflow; }
+
+        private:
+            uint8_t* m_buf;
+            size_t m_cap;
+            size_t m_size = 0;
+            bool m_overflow = false;
+        };
+
+        // ---------- 解码游标（越界即失败） ----------
+        class Reader {
+        public:
+            Reader(const uint8_t* p, size_t n) : m_p(p), m_n(n) {}
+            bool AtEnd() const { return m_pos >= m_n; }
+            bool Bytes(void* out, size_t n) {
+                if (m_n - m_pos < n) return false;
+                std::memcpy(out, m_p + m_pos, n);
+                m_pos += n;
+                return true;
+            }
+            bool Fixed8(uint8_t* v) { return Bytes(v, 1); }
+            bool Fixed16(uint16_t* v) { return Bytes(v, 2); }
+            bool Fixed32(uint32_t* v) { return Bytes(v, 4); }
+            bool Fixed64(uint64_t* v) { return Bytes(v, 8); }
+            bool Varint(uint64_t* v) {
+                uint64_t result = 0;
+                for (int shift = 0; shift < 64; shift += 7) {
+                    uint8_t b = 0;
+                    if (!Fixed8(&b)) return false;
+                    result |= static_cast<uint64_t>(b & 0x7F) << shift;
+                    if (!(b & 0x80)) {
+                        *v = result;
+                        return true;
+                    }
+                }
+                return false;
+            }
+            bool View(std::string_view* out) {
+                uint64_t n = 0;
+                if (!Varint(&n) || m_n - m_pos < n) return false;
+                *out = std::string_view(reinterpret_cast<const char*>(m_p + m_pos), static_cast<size_t>(n));
+                m_pos += static_cast<size_t>(n);
+                return true;
+            }
+            bool String(std::string* out) {
+                std::string_view v;
+                if (!View(&v)) return false;
+                out->assign(v.data(), v.size());
+                return true;
+            }
+
+        private:
+            const uint8_t* m_p;
+            size_t m_n;
+            size_t m_pos = 0;
+        };
+
+        template <typename T>
+        static void EncodeArg(Encoder* enc, const T& v) {
+            using U = std::decay_t<T>;
+            if constexpr (std::is_same_v<U, bool>) {
+                enc->Varint(v ? 1 : 0);
+            } else if constexpr (std::is_enum_v<U>) {
+                EncodeArg(enc, static_cast<std::underlying_type_t<U>>(v));
+            } else if constexpr (std::is_integral_v<U> && std::is_signed_v<U>) {
+                const int64_t s = static_cast<int64_t>(v);
+                enc->Varint((static_cast<uint64_t>(s) << 1) ^ static_cast<uint64_t>(s >> 63)); // zigzag
+            } else if constexpr (std::is_integral_v<U>) {
+                enc->Varint(static_cast<uint64_t>(v));
+            } else if constexpr (std::is_floating_point_v<U>) {
+                const double d = static_cast<double>(v);
+                enc->Bytes(&d, sizeof(d));
+            } else if constexpr (std::is_same_v<U, const char*> || std::is_same_v<U, char*>) {
+                const char* s = "(null)";
+                if constexpr (std::is_array_v<T>) {
+                    s = v; // 字面量 / 字符数组：地址不可能为空
+                } else if (v) {
+                    s = v;
+                }
+                enc->LengthPrefixed(s, std::strlen(s), kMaxStringBytes);
+            } else if constexpr (std::is_same_v<U, std::string> || std::is_same_v<U, std::string_view>) {
+                enc->LengthPrefixed(v.data(), v.size(), kMaxStringBytes);
+            } else if constexpr (std::is_same_v<U, BinaryLogHex>) {
+                enc->Varint(v.data ? v.len : 0);
+                enc->LengthPrefixed(v.data, v.data ? v.len : 0, kMaxHexBytes);
+            } else if constexpr (std::is_same_v<U, BinaryLogAddr>) {
+                EncodeAddr(enc, v.addr);
+            } else if constexpr (std::is_pointer_v<U>) {
+                enc->Varint(static_cast<uint64_t>(reinterpret_cast<uintptr_t>(v)));
+            } else {
+                static_assert(sizeof(U) == 0, "BinaryLog: 不支持的参数类型");
+            }
+        }
+
+        // 地址：u8 族（0 未知 / 4 / 6）+ 地址字节 + u16 端口（host order）
+        static void EncodeAddr(Encoder* enc, const sockaddr* addr) {
+            if (addr && addr->sa_family == AF_INET) {
+                const sockaddr_in* in4 = reinterpret_cast<const sockaddr_in*>(addr);
+                enc->Fixed8(4);
+                enc->Bytes(&in4->sin_addr, 4);
+                enc->Fixed16(ntohs(in4->sin_port));
+            } else if (addr && addr->sa_family == AF_INET6) {
+                const sockaddr_in6* in6 = reinterpret_cast<const sockaddr_in6*>(addr);
+                enc->Fixed8(6);
+                enc->Bytes(&in6->sin6_addr, 16);
+                enc->Fixed16(ntohs(in6->sin6_port));
+            } else {
+                enc->Fixed8(0);
+            }
+        }
+
+        // 按签名逐个消费参数，替换格式串中的 {}；多余的 {} 原样保留
+        static bool Render(const char* fmt, const char* signature, Reader* reader, std::string* out) {
+            const char* sig = signature;
+            for (const char* p = fmt; *p; p++) {
+                if (p[0] == '{' && p[1] == '}' && *sig) {
+                    if (!RenderArg(*sig++, reader, out)) return false;
+                    p++;
+                    continue;
+                }
+                out->push_back(*p);
+            }
+            // 参数多于占位符：仍需消费，保证后续记录对齐
+            std::string ignored;
+            while (*sig) {
+                if (!RenderArg(*sig++, reader, &ignored)) return false;
+            }
+            return true;
+        }
+
+        static bool RenderArg(char tag, Reader* reader, std::string* out) {
+            uint64_t u = 0;
+            switch (tag) {
+            case 'b':
+                if (!reader->Varint(&u)) return false;
+                out->append(u ? "true" : "false");
+                return true;
+            case 'i':
+                if (!reader->Varint(&u)) return false;
+                out->append(std::to_string(static_cast<int64_t>((u >> 1) ^ (~(u & 1) + 1))));
+                return true;
+            case 'u':
+                if (!reader->Varint(&u)) return false;
+                out->append(std::to_string(u));
+                return true;
+            case 'p': {
+                if (!reader->Varint(&u)) return false;
+                char buf[24];
+                std::snprintf(buf, sizeof(buf), "0x%llx", static_cast<unsigned long long>(u));
+                out->append(buf);
+                return true;
+            }
+            case 'f': {
+                double d = 0;
+                if (!reader->Bytes(&d, sizeof(d))) return false;
+                char buf[32];
+                std::snprintf(buf, sizeof(buf), "%g", d);
+                out->append(buf);
+                return true;
+            }
+            case 's': {
+                std::string_view v;
+                if (!reader->View(&v)) return false;
+                out->append(v.data(), v.size());
+                return true;
+            }
+            case 'x': {
+                uint64_t total = 0;
+                std::string_view v;
+                if (!reader->Varint(&total) || !reader->View(&v)) return false;
+                static const char* kHex = "0123456789ABCDEF";
+                for (size_t i = 0; i < v.size(); i++) {
+                    if (i) out->push_back(' ');
+                    const uint8_t b = static_cast<uint8_t>(v[i]);
+                    out->push_back(kHex[b >> 4]);
+                    out->push_back(kHex[b & 0xF]);
+                }
+                if (total > v.size()) out->append(" ...(" + std::to_string(total) + " bytes)");
+                return true;
+            }
+            case 'a': {
+                uint8_t family = 0;
+                if (!reader->Fixed8(&family)) return false;
+                if (family == 0) {
+                    out->append("(未知地址)");
+                    return true;
+                }
+                uint8_t ip[16] = {0};
+                uint16_t port = 0;
+                const size_t n = (family == 4) ? 4 : 16;
+                if ((family != 4 && family != 6) || !reader->Bytes(ip, n) || !reader->Fixed16(&port)) return false;
+                char buf[64] = {0};
+                if (family == 4) {
+                    std::snprintf(buf, sizeof(buf), "%u.%u.%u.%u:%u", ip[0], ip[1], ip[2], ip[3], port);
+                } else {
+                    char text[INET6_ADDRSTRLEN] = {0};
+                    inet_ntop(AF_INET6, ip, text, sizeof(text));
+                    std::snprintf(buf, sizeof(buf), "[%s]:%u", text, port);
+                }
+                out->append(buf);
+                return true;
+            }
+            default:
+                return false;
+            }
+        }
+
+        // ---------- 线程缓冲（单生产者 / 单消费者字节环） ----------
+        struct ThreadBuffer {
+            std::unique_ptr<uint8_t[]> data{new uint8_t[kThreadBufferBytes]};
+            std::atomic<uint64_t> head{0}; // 生产者写入总字节数
+            std::atomic<uint64_t> tail{0}; // 消费者读取总字节数
+            std::atomic<uint64_t> dropped{0};
+            uint64_t reportedDropped = 0;  // 仅消费者访问
+            std::atomic<bool> retired{false};
+            uint32_t tid = 0;
+
+            bool Write(const uint8_t* p, size_t n) {
+                const uint64_t h = head.load(std::memory_order_relaxed);
+                if (h + n - tail.load(std::memory_order_acquire) > kThreadBufferBytes) return false;
+                const size_t at = static_cast<size_t>(h % kThreadBufferBytes);
+                const size_t first = (n < kThreadBufferBytes - at) ? n : (kThreadBufferBytes - at);
+                std::memcpy(data.get() + at, p, first);
+                std::memcpy(data.get(), p + first, n - first);
+                head.store(h + n, std::memory_order_release);
+                return true;
+            }
+
+            // 把全部已提交字节追加到 out，返回字节数
+            size_t ReadAll(std::string* out) {
+                const uint64_t t = tail.load(std::memory_order_relaxed);
+                const uint64_t h = head.load(std::memory_order_acquire);
+                const size_t n = static_cast<size_t>(h - t);
+                const size_t at = static_cast<size_t>(t % kThreadBufferBytes);
+                const size_t first = (n < kThreadBufferBytes - at) ? n : (kThreadBufferBytes - at);
+                out->append(reinterpret_cast<const char*>(data.get() + at), first);
+                out->append(reinterpret_cast<const char*>(data.get()), n - first);
+                tail.store(h, std::memory_order_release);
+                return n;
+            }
+        };
+
+        // 线程退出时标记缓冲为退役，由写线程写完剩余内容后回收
+        struct BufferHolder {
+            ThreadBuffer* buffer = nullptr;
+            ~BufferHolder() {
+                if (buffer) buffer->retired.store(true, std::memory_order_release);
+            }
+        };
+
+        ThreadBuffer* CurrentBuffer() {
+            thread_local BufferHolder t_holder;
+            if (!t_holder.buffer) {
+                ThreadBuffer* b = new ThreadBuffer();
+                b->tid = CurrentThreadId();
+                std::lock_guard<std::mutex> lock(m_buffersMtx);
+                m_buffers.push_back(b);
+                t_holder.buffer = b;
+            }
+            return t_holder.buffer;
+        }
+
+        static uint32_t CurrentThreadId() {
+#ifdef _WIN32
+            return static_cast<uint32_t>(GetCurrentThreadId());
+#else
+            static std::atomic<uint32_t> s_next{1};
+            thread_local uint32_t t_id = s_next.fetch_add(1);
+            return t_id;
+#endif
+        }
+
+        static uint32_t CurrentProcessId() {
+#ifdef _WIN32
+            return static_cast<uint32_t>(GetCurrentProcessId());
+#else
+            return static_cast<uint32_t>(getpid());
+#endif
+        }
+
+        static uint64_t NowNs() {
+            return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count());
+        }
+
+        static std::string BaseName(const char* path) {
+            const char* base = path;
+            for (const char* p = path; *p; p++) {
+                if (*p == '/' || *p == '\\') base = p + 1;
+            }
+            return base;
+        }
+
+        // ---------- 写线程 ----------
+        static void AppendFrame(std::string* out, uint8_t type, const std::string& payload) {
+            const uint32_t len = static_cast<uint32_t>(payload.size());
+            out->push_back(static_cast<char>(type));
+            out->append(reinterpret_cast<const char*>(&len), 4);
+            out->append(payload);
+        }
+
+        void Run() {
+            while (!m_stop.load(std::memory_order_relaxed)) {
+                Flush();
+                std::unique_lock<std::mutex> lock(m_wakeMtx);
+                m_wake.wait_for(lock, std::chrono::milliseconds(kFlushIntervalMs),
+                                [this]() { return m_stop.load(std::memory_order_relaxed); });
+            }
+        }
+
+        // 调用方持有 m_flushMtx。先取出各线程数据，再写格式定义：格式登记先于记录入队，
+        // 因此取数之后读到的格式数一定覆盖已取出的全部记录
+        void FlushLocked() {
+            std::string pending;
+            {
+                std::lock_guard<std::mutex> lock(m_buffersMtx);
+                for (size_t i = 0; i < m_buffers.size();) {
+                    ThreadBuffer* b = m_buffers[i];
+                    const bool retired = b->retired.load(std::memory_order_acquire);
+                    std::string payload(reinterpret_cast<const char*>(&b->tid), 4);
+                    if (b->ReadAll(&payload) > 0) AppendFrame(&pending, kFrameChunk, payload);
+                    const uint64_t dropped = b->dropped.load(std::memory_order_relaxed);
+                    if (dropped != b->reportedDropped) {
+                        std::string drop(reinterpret_cast<const char*>(&b->tid), 4);
+                        const uint64_t delta = dropped - b->reportedDropped;
+                        drop.append(reinterpret_cast<const char*>(&delta), 8);
+                        AppendFrame(&pending, kFrameDropped, drop);
+                        b->reportedDropped = dropped;
+                    }
+                    if (retired) {
+                        m_retiredDropped += dropped;
+                        delete b;
+                        m_buffers[i] = m_buffers.back();
+                        m_buffers.pop_back();
+                    } else {
+                        i++;
+                    }
+                }
+            }
+            if (pending.empty() || !m_pathProvider) return;
+
+            const std::string path = m_pathProvider();
+            if (!m_file || path != m_path || m_fileBytes + pending.size() > m_maxBytes) {
+                if (!OpenFile(path)) return;
+            }
+            std::string formats;
+            {
+                std::lock_guard<std::mutex> lock(m_formatMtx);
+                for (; m_formatsWritten < m_formats.size(); m_formatsWritten++) {
+                    const Format& f = m_formats[m_formatsWritten];
+                    uint8_t scratch[kMaxRecordBytes * 2];
+                    Encoder enc(scratch, sizeof(scratch));
+                    enc.Fixed16(static_cast<uint16_t>(m_formatsWritten + 1));
+                    enc.Fixed8(static_cast<uint8_t>(f.level));
+                    enc.Fixed32(static_cast<uint32_t>(f.line));
+                    enc.LengthPrefixed(f.file.data(), f.file.size(), kMaxStringBytes);
+                    enc.LengthPrefixed(f.fmt.data(), f.fmt.size(), kMaxRecordBytes);
+                    enc.LengthPrefixed(f.signature.data(), f.signature.size(), kMaxStringBytes);
+                    AppendFrame(&formats, kFrameFormat, std::string(reinterpret_cast<const char*>(scratch), enc.Size()));
+                }
+            }
+            WriteRaw(formats);
+            WriteRaw(pending);
+            std::fflush(m_file);
+        }
+
+        bool OpenFile(const std::string& path) {
+            CloseFile();
+            m_file = std::fopen(path.c_str(), "wb");
+            if (!m_file) return false;
+            m_path = path;
+            m_fileBytes = 0;
+            m_formatsWritten = 0; // 新文件须重新写出全部格式，保证可独立解码
+
+            const int64_t wallNs = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::system_clock::now().time_since_epoch()).count();
+            const uint64_t tickNs = NowNs();
+            const uint32_t pid = CurrentProcessId();
+            std::string header(kMagic, sizeof(kMagic));
+            header.append(reinterpret_cast<const char*>(&kVersion), 4);
+            header.append(reinterpret_cast<const char*>(&pid), 4);
+            header.append(reinterpret_cast<const char*>(&wallNs), 8);
+            header.append(reinterpret_cast<const char*>(&tickNs), 8);
+            WriteRaw(header);
+            return true;
+        }
+
+        void WriteRaw(const std::string& bytes) {
+            if (!m_file || bytes.empty()) return;
+            m_fileBytes += std::fwrite(bytes.data(), 1, bytes.size(), m_file);
+        }
+
+        void CloseFile() {
+            if (m_file) std::fclose(m_file);
+            m_file = nullptr;
+            m_path.clear();
+        }
+
+        std::mutex m_formatMtx;
+        std::vector<Format> m_formats;        // 只追加
+
+        std::mutex m_buffersMtx;
+        std::vector<ThreadBuffer*> m_buffers;
+        uint64_t m_retiredDropped = 0;        // 受 m_buffersMtx 保护
+
+        std::mutex m_flushMtx;                // 以下文件状态受其保护
+        std::function<std::string()> m_pathProvider;
+        uint64_t m_maxBytes = 0;
+        FILE* m_file = nullptr;
+        std::string m_path;
+        uint64_t m_fileBytes = 0;
+        size_t m_formatsWritten = 0;
+
+        std::atomic<bool> m_running{false};
+        std::atomic<bool> m_stop{false};
+        std::mutex m_wakeMtx;
+        std::condition_variable m_wake;
+        std::thread m_thread;
+    };
+
+    // ---------- 参数类型标签 ----------
+    template <typename T>
+    struct BinaryLog::ArgTag<T, std::enable_if_t<std::is_same_v<T, bool>>> { static constexpr char value = 'b'; };
+    template <typename T>
+    struct BinaryLog::ArgTag<T, std::enable_if_t<std::is_enum_v<T>>> {
+        static constexpr char value = std::is_signed_v<std::underlying_type_t<T>> ? 'i' : 'u';
+    };
+    template <typename T>
+    struct BinaryLog::ArgTag<T, std::enable_if_t<std::is_integral_v<T> && !std::is_same_v<T, bool> && std::is_signed_v<T>>> {
+        static constexpr char value = 'i';
+    };
+    template <typename T>
+    struct BinaryLog::ArgTag<T, std::enable_if_t<std::is_integral_v<T> && !std::is_same_v<T, bool> && !std::is_signed_v<T>>> {
+        static constexpr char value = 'u';
+    };
+    template <typename T>
+    struct BinaryLog::ArgTag<T, std::enable_if_t<std::is_floating_point_v<T>>> { static constexpr char value = 'f'; };
+    template <typename T>
+    struct BinaryLog::ArgTag<T, std::enable_if_t<std::is_same_v<T, const char*> || std::is_same_v<T, char*> ||
+                                                 std::is_same_v<T, std::string> || std::is_same_v<T, std::string_view>>> {
+        static constexpr char value = 's';
+    };
+    template <typename T>
+    struct BinaryLog::ArgTag<T, std::enable_if_t<std::is_same_v<T, BinaryLogHex>>> { static constexpr char value = 'x'; };
+    template <typename T>
+    struct BinaryLog::ArgTag<T, std::enable_if_t<std::is_same_v<T, BinaryLogAddr>>> { static constexpr char value = 'a'; };
+    template <typename T>
+    struct BinaryLog::ArgTag<T, std::enable_if_t<std::is_pointer_v<T> && !std::is_same_v<T, const char*> &&
+                                                 !std::is_same_v<T, char*>>> {
+        static constexpr char value = 'p';
+    };
+}
@@ -0,0 +1,99 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+namespace Core {
+    // ============= CIDR 多比特前缀树（4-bit 步长，IPv4/IPv6 通用） =============
+    // 设计意图：导入整份国内 IP 列表（约 8k 条 v4 + 2k 条 v6）后，逐规则逐 CIDR 比较
+    // 会让每次 connect 付出数万次比较；这里把前缀编译为 16 叉 Trie（前缀长度不足 4 的
+    // 倍数时按“前缀展开”铺到多个槽位），查询 v4 最多 8 步、v6 最多 32 步。
+    //
+    // 注意：路由语义是“规则名次优先”而非“最长前缀优先”——同一地址命中的
+    // 所有前缀都会把名次列表交给 visitor，由调用方取满足过滤条件的最小名次。
+    class CidrPrefixTrie {
+    public:
+        // addr 为网络字节序（大端）；prefixBits 超出的位被忽略
+        void Insert(const uint8_t* addr, int prefixBits, uint32_t rank) {
+            m_prefixCount++;
+            if (prefixBits <= 0) {
+                PushRank(&m_rootRanks, rank);
+                return;
+            }
+            uint32_t node = 0;
+            int level = 0;
+            while (prefixBits - level * kStride > kStride) {
+                const int nib = NibbleAt(addr, level);
+                uint32_t child = m_nodes[node].child[nib];
+                if (child == 0) {
+                    child = static_cast<uint32_t>(m_nodes.size());
+                    m_nodes[node].child[nib] = child;
+                    m_nodes.emplace_back();
+                }
+                node = child;
+                level++;
+            }
+            const int rem = prefixBits - level * kStride; // 1..4
+            const int span = 1 << (kStride - rem);
+            const int base = NibbleAt(addr, level) & ~(span - 1);
+            for (int v = base; v < base + span; v++) {
+                uint32_t& slot = m_nodes[node].slotRanks[v];
+                if (slot == 0) {
+                    m_rankLists.emplace_back();
+                    slot = static_cast<uint32_t>(m_rankLists.size());
+                }
+                PushRank(&m_rankLists[slot - 1], rank);
+            }
+        }
+
+        // 沿地址逐 nibble 向下走，依次把路径上覆盖该地址的名次列表（升序）交给 visitor；
+        // visitor 返回 false 可提前终止。查询过程不分配内存。
+        template <typename Visitor>
+        void Lookup(const uint8_t* addr, int addrBits, Visitor&& visitor) const {
+            if (m_prefixCount == 0) return;
+            if (!m_rootRanks.empty() && !visitor(m_rootRanks)) return;
+            uint32_t node = 0;
+            const int levels = addrBits / kStride;
+            for (int level = 0; level < levels; level++) {
+                const Node& n = m_nodes[node];
+                const int nib = NibbleAt(addr, level);
+                if (n.slotRanks[nib] != 0 && !visitor(m_rankLists[n.slotRanks[nib] - 1])) return;
+                node = n.child[nib];
+                if (node == 0) return;
+            }
+        }
+
+        void Clear() {
+            m_nodes.assign(1, Node{});
+            m_rankLists.clear();
+            m_rootRanks.clear();
+            m_prefixCount = 0;
+        }
+
+        size_t PrefixCount() const { return m_prefixCount; }
+        size_t NodeCount() const { return m_nodes.size(); }
+
+    private:
+        static constexpr int kStride = 4;
+
+        struct Node {
+            uint32_t child[16] = {};     // 0 表示无子节点（根节点不会作为子节点出现）
+            uint32_t slotRanks[16] = {}; // m_rankLists 下标 + 1；0 表示该槽位无前缀终点
+        };
+
+        static int NibbleAt(const uint8_t* addr, int level) {
+            const uint8_t b = addr[level >> 1];
+            return (level & 1) ? (b & 0x0F) : (b >> 4);
+        }
+
+        static void PushRank(std::vector<uint32_t>* ranks, uint32_t rank) {
+            // 插入方按名次递增插入；同一规则重复/重叠前缀只记一次
+            if (!ranks->empty() && ranks->back() == rank) return;
+            ranks->push_back(rank);
+        }
+
+        std::vector<Node> m_nodes = std::vector<Node>(1);
+        std::vector<std::vector<uint32_t>> m_rankLists;
+        std::vector<uint32_t> m_rootRanks; // /0 前缀
+        size_t m_prefixCount = 0;
+    };
+}
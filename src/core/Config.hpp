@@ -12,19 +12,46 @@
 #include <cstdint>
 #include <string_view>
 #include <utility>
+#include <atomic>
 #include "Logger.hpp"
+#include "DomainTrie.hpp"
+#include "CidrTrie.hpp"
 
 namespace Core {
     struct ProxyConfig {
         std::string host = "127.0.0.1";
         int port = 7890;
         std::string type = "socks5";
+        // SOCKS5 流水线握手：认证协商与 CONNECT 一次发出（仅无认证代理；代理不兼容时自动回退）
+        bool socks5_pipeline = false;
+        // ConnectEx 完成后的代理握手改为重叠 I/O 异步推进，不占用应用的 IOCP 工作线程
+        bool async_handshake = false;
     };
 
     struct FakeIPConfig {
         bool enabled = true;
         std::string cidr = "198.18.0.0/15";
         // 注：max_entries 已废弃，Ring Buffer 策略下自动循环复用地址池
+        // 跨进程共享映射条目数（每条约 330 字节，含索引）；不同容量的进程各用各的共享段
+        uint32_t shared_capacity = 4096;
+        // 非空时共享映射改为文件支持的 mmap，进程重启后映射仍在（相对路径相对 DLL 目录）
+        std::string shared_file;
+    };
+
+    // 进程内 DNS 结果缓存（direct + FakeIP 重解析、WSAConnectByName 共用；代理主机名由 ProxyEndpoint 单独缓存）
+    struct DnsCacheConfig {
+        bool enabled = true;
+        int ttl_ms = 60000;
+        int negative_ttl_ms = 5000;
+        int max_entries = 1024;
+    };
+
+    // 到 SOCKS5 代理的预连接池（已建连并完成认证协商的空闲连接，供 UDP Associate 控制连接等内部连接取用）
+    struct WarmPoolConfig {
+        bool enabled = false;
+        int max_idle = 2;
+        int ttl_ms = 30000;
+        int udp_associations = 1; // 预建的完整 UDP Associate 数量（udp_mode=proxy 时生效，0 表示不预建）
     };
 
     struct TimeoutConfig {
@@ -54,6 +81,29 @@ namespace Core {
         std::vector<RoutingRule> rules;
     };
 
+    // ============= 路由决策（热路径紧凑表示） =============
+    // 设计意图：connect/getaddrinfo 热路径上不再用字符串承载 action/protocol，
+    // 避免每次匹配的 ToLower/拷贝/字符串比较；规则名仅在需要打日志时按下标取出。
+    enum class RouteAction : uint8_t {
+        Proxy = 0,
+        Direct = 1,
+    };
+
+    enum class RouteProtocol : uint8_t {
+        Tcp = 0,
+        Udp = 1,
+        Other = 2, // 配置中出现的未知协议名（仅用于兼容旧字符串接口）
+    };
+
+    struct RouteDecision {
+        static constexpr uint32_t kNoRule = UINT32_MAX;
+        RouteAction action = RouteAction::Proxy;
+        uint32_t ruleIndex = kNoRule; // compiled_rules 下标；kNoRule 表示未命中（走默认 action）
+
+        bool Matched() const { return ruleIndex != kNoRule; }
+        bool IsDirect() const { return action == RouteAction::Direct; }
+    };
+
     // ============= 代理路由规则 =============
     // 用于控制哪些端口走代理、DNS 53 端口的特殊处理策略
     struct ProxyRules {
@@ -108,10 +158,29 @@ namespace Core {
             std::vector<std::string> domains; // lowercased
             std::vector<PortRange> port_ranges;
             std::vector<std::string> protocols; // lowercased
+            RouteAction action_value = RouteAction::Proxy;
+            uint8_t protocol_mask = kAllProtocols;
+        };
+
+        static constexpr uint8_t kAllProtocols = 0xFF;
+
+        // 含通配符、无法进入 Trie 的域名模式（按名次升序，仍走 GlobMatch）
+        struct DomainGlobEntry {
+            std::string pattern;
+            uint32_t rank = 0;
         };
 
         std::vector<CompiledRoutingRule> compiled_rules;
         std::vector<size_t> compiled_order;
+        RouteAction compiled_default_action = RouteAction::Proxy;
+        // 编译代次：每次 CompileRoutingRules 递增（进程内全局唯一），供决策缓存判断条目是否过期
+        uint32_t compiled_generation = 0;
+
+        // 域名/CIDR 索引：rank 为规则在 compiled_order 中的位置（越小优先级越高）
+        DomainSuffixTrie compiled_domain_trie;
+        std::vector<DomainGlobEntry> compiled_domain_globs;
+        CidrPrefixTrie compiled_cidr_v4_trie;
+        CidrPrefixTrie compiled_cidr_v6_trie;
 
         // 编译统计（用于启动日志摘要，便于快速判断规则是否生效）
         size_t compiled_valid_cidr_v4 = 0;
@@ -188,7 +257,7 @@ namespace Core {
             return ParseIPv4View(ip, outHostOrder);
         }
 
-        static bool ParseIPv6(const std::string& ip, std::array<uint8_t, 16>* out) {
+        static bool ParseIPv6(std::string_view ip, std::array<uint8_t, 16>* out) {
             if (!out) return false;
             std::string_view s = TrimView(ip);
             if (s.empty()) return false;
@@ -295,7 +364,7 @@ namespace Core {
             if (!TryParseUInt32(bitsPart, &bitsU, 10) || bitsU > 128) return false;
             const int bits = (int)bitsU;
             std::array<uint8_t, 16> addr{};
-            if (!ParseIPv6(std::string(ipPart), &addr)) return false;
+            if (!ParseIPv6(ipPart, &addr)) return false;
             out->network = addr;
             out->prefix = bits;
             if (bits == 0) {
@@ -328,8 +397,8 @@ namespace Core {
             return (ip[fullBytes] & mask) == (rule.network[fullBytes] & mask);
         }
 
-        static bool GlobMatch(const std::string& pattern, const std::string& text) {
-            size_t p = 0, t = 0, star = std::string::npos, match = 0;
+        static bool GlobMatch(std::string_view pattern, std::string_view text) {
+            size_t p = 0, t = 0, star = std::string_view::npos, match = 0;
             while (t < text.size()) {
                 if (p < pattern.size() && (pattern[p] == '?' || pattern[p] == text[t])) {
                     p++;
@@ -337,7 +406,7 @@ namespace Core {
                 } else if (p < pattern.size() && pattern[p] == '*') {
                     star = p++;
                     match = t;
-                } else if (star != std::string::npos) {
+                } else if (star != std::string_view::npos) {
                     p = star + 1;
                     t = ++match;
                 } else {
@@ -402,6 +471,24 @@ namespace Core {
             return false;
         }
 
+        static RouteProtocol ParseRouteProtocol(std::string_view name) {
+            auto eq = [&](const char* lit) {
+                const size_t n = std::char_traits<char>::length(lit);
+                if (name.size() != n) return false;
+                for (size_t i = 0; i < n; i++) {
+                    if (std::tolower((unsigned char)name[i]) != lit[i]) return false;
+                }
+                return true;
+            };
+            if (eq("tcp")) return RouteProtocol::Tcp;
+            if (eq("udp")) return RouteProtocol::Udp;
+            return RouteProtocol::Other;
+        }
+
+        static uint8_t ProtocolBit(RouteProtocol protocol) {
+            return static_cast<uint8_t>(1u << static_cast<uint8_t>(protocol));
+        }
+
         static bool MatchProtocol(const char* protocol, const std::vector<std::string>& protocols) {
             if (protocols.empty()) return true;
             std::string p = protocol ? ToLower(protocol) : "";
@@ -411,7 +498,13 @@ namespace Core {
             return false;
         }
 
+        static uint32_t NextRoutingGeneration() {
+            static std::atomic<uint32_t> s_generation{0};
+            return s_generation.fetch_add(1, std::memory_order_relaxed) + 1;
+        }
+
         void CompileRoutingRules() {
+            compiled_generation = NextRoutingGeneration();
             compiled_rules.clear();
             compiled_order.clear();
             compiled_valid_cidr_v4 = 0;
@@ -489,10 +582,18 @@ namespace Core {
                     std::string norm = ToLower(proto);
                     if (!norm.empty()) cr.protocols.push_back(norm);
                 }
+                cr.action_value = (cr.raw.action == "direct") ? RouteAction::Direct : RouteAction::Proxy;
+                if (!cr.protocols.empty()) {
+                    cr.protocol_mask = 0;
+                    for (const auto& proto : cr.protocols) cr.protocol_mask |= ProtocolBit(ParseRouteProtocol(proto));
+                }
 
                 compiled_rules.push_back(cr);
             }
 
+            compiled_default_action = (ToLower(routing.default_action) == "direct") ? RouteAction::Direct
+                                                                                    : RouteAction::Proxy;
+
             const bool useNumber = (ToLower(routing.priority_mode) == "number");
             compiled_order.resize(compiled_rules.size());
             for (size_t i = 0; i < compiled_order.size(); i++) compiled_order[i] = i;
@@ -502,83 +603,159 @@ namespace Core {
                         return compiled_rules[a].raw.priority > compiled_rules[b].raw.priority;
                     });
             }
+
+            BuildRoutingIndex();
+        }
+
+        // 按最终优先级顺序构建域名 Trie / 通配符列表 / CIDR 名次列表
+        void BuildRoutingIndex() {
+            compiled_domain_trie.Clear();
+            compiled_domain_globs.clear();
+            compiled_cidr_v4_trie.Clear();
+            compiled_cidr_v6_trie.Clear();
+            for (size_t rank = 0; rank < compiled_order.size(); rank++) {
+                const auto& rule = compiled_rules[compiled_order[rank]];
+                if (!rule.raw.enabled) continue;
+                const uint32_t r = static_cast<uint32_t>(rank);
+                for (const auto& pattern : rule.domains) {
+                    if (!compiled_domain_trie.Insert(pattern, r)) {
+                        compiled_domain_globs.push_back(DomainGlobEntry{pattern, r});
+                    }
+                }
+                for (const auto& c : rule.v4) {
+                    int bits = 0;
+                    while (bits < 32 && (c.mask & (0x80000000u >> bits))) bits++;
+                    uint8_t addr[4];
+                    Ipv4ToBytes(c.network, addr);
+                    compiled_cidr_v4_trie.Insert(addr, bits, r);
+                }
+                for (const auto& c : rule.v6) {
+                    compiled_cidr_v6_trie.Insert(c.network.data(), c.prefix, r);
+                }
+            }
+        }
+
+        static void Ipv4ToBytes(uint32_t hostOrder, uint8_t out[4]) {
+            out[0] = static_cast<uint8_t>(hostOrder >> 24);
+            out[1] = static_cast<uint8_t>(hostOrder >> 16);
+            out[2] = static_cast<uint8_t>(hostOrder >> 8);
+            out[3] = static_cast<uint8_t>(hostOrder);
+        }
+
+        static bool RulePassesFilters(const CompiledRoutingRule& rule, RouteProtocol protocol, uint16_t port) {
+            return (rule.protocol_mask & ProtocolBit(protocol)) != 0 && MatchPort(port, rule.port_ranges);
+        }
+
+        // 规则名（仅日志使用）；未命中返回空串
+        const std::string& RouteRuleName(const RouteDecision& decision) const {
+            static const std::string kEmpty;
+            if (!decision.Matched() || decision.ruleIndex >= compiled_rules.size()) return kEmpty;
+            return compiled_rules[decision.ruleIndex].raw.name;
         }
 
+        // 兼容接口：字符串 action/rule 输出（测试与非热路径使用）
         bool MatchRouting(const std::string& host, const std::string& ip, bool ipIsV6, uint16_t port,
                           const char* protocol, std::string* outAction, std::string* outRule) const {
             if (!routing.enabled) return false;
-            std::string action = ToLower(routing.default_action);
-            if (action != "proxy" && action != "direct") {
-                action = "proxy";
-            }
+            const RouteDecision d = MatchRouting(std::string_view(host), std::string_view(ip), ipIsV6, port,
+                                                 ParseRouteProtocol(protocol ? protocol : ""));
+            if (outAction) *outAction = (d.action == RouteAction::Direct) ? "direct" : "proxy";
+            if (outRule) *outRule = RouteRuleName(d);
+            return d.Matched();
+        }
 
-            std::string ipStr = ip;
-            std::string hostStr = host;
-            if (!hostStr.empty() && hostStr.back() == '.') hostStr.pop_back();
-            // 性能优化：域名匹配热路径避免重复 ToLower/分配；统一在此处转为小写
-            if (!hostStr.empty()) hostStr = ToLower(std::move(hostStr));
+        // 热路径接口：host/ip 以 string_view 传入，命中路径不做堆分配。
+        // routing 关闭时返回 {Proxy, kNoRule}，与旧接口“action 为空 => 继续代理流程”一致。
+        RouteDecision MatchRouting(std::string_view host, std::string_view ip, bool ipIsV6, uint16_t port,
+                                   RouteProtocol protocol) const {
+            RouteDecision decision{};
+            if (!routing.enabled) return decision;
+            decision.action = compiled_default_action;
+
+            if (!host.empty() && host.back() == '.') host.remove_suffix(1);
+            // 域名统一转小写：合法域名不超过 253 字节，使用栈缓冲；仅病态超长输入才回退堆分配
+            char lowerBuf[256];
+            std::string lowerHeap;
+            bool hasUpper = false;
+            for (char c : host) {
+                if (c >= 'A' && c <= 'Z') {
+                    hasUpper = true;
+                    break;
+                }
+            }
+            if (hasUpper) {
+                char* dst = lowerBuf;
+                if (host.size() > sizeof(lowerBuf)) {
+                    lowerHeap.resize(host.size());
+                    dst = &lowerHeap[0];
+                }
+                for (size_t i = 0; i < host.size(); i++) {
+                    dst[i] = (char)std::tolower((unsigned char)host[i]);
+                }
+                host = std::string_view(dst, host.size());
+            }
 
-            const bool hasHost = !hostStr.empty();
-            const bool hasIp = !ipStr.empty();
+            const bool hasHost = !host.empty();
 
             std::array<uint8_t, 16> ip6{};
             uint32_t ip4 = 0;
             bool ip4Valid = false;
             bool ip6Valid = false;
-            if (hasIp) {
+            if (!ip.empty()) {
                 if (ipIsV6) {
-                    ip6Valid = ParseIPv6(ipStr, &ip6);
+                    ip6Valid = ParseIPv6(ip, &ip6);
                 } else {
-                    ip4Valid = ParseIPv4(ipStr, &ip4);
+                    ip4Valid = ParseIPv4View(ip, &ip4);
                 }
-            } else if (!hostStr.empty()) {
+            } else if (hasHost) {
                 // host 可能是 IP 字面量
-                ip4Valid = ParseIPv4(hostStr, &ip4);
-                ip6Valid = !ip4Valid && ParseIPv6(hostStr, &ip6);
+                ip4Valid = ParseIPv4View(host, &ip4);
+                ip6Valid = !ip4Valid && ParseIPv6(host, &ip6);
             }
 
-            for (size_t idx : compiled_order) {
-                const auto& rule = compiled_rules[idx];
-                if (!rule.raw.enabled) continue;
-                if (!MatchProtocol(protocol, rule.protocols)) continue;
-                if (!MatchPort(port, rule.port_ranges)) continue;
-
-                bool matched = false;
-                if (hasHost && !rule.domains.empty()) {
-                    for (const auto& pattern : rule.domains) {
-                        if (MatchDomainPattern(pattern, hostStr)) {
-                            matched = true;
-                            break;
-                        }
-                    }
-                }
-                if (!matched && ip4Valid && !rule.v4.empty()) {
-                    for (const auto& r : rule.v4) {
-                        if (MatchCidrV4(ip4, r)) {
-                            matched = true;
-                            break;
-                        }
-                    }
-                }
-                if (!matched && ip6Valid && !rule.v6.empty()) {
-                    for (const auto& r : rule.v6) {
-                        if (MatchCidrV6(ip6, r)) {
-                            matched = true;
-                            break;
-                        }
+            // 名次越小优先级越高：三类索引各自只需找“比当前最优更靠前”的命中
+            const uint32_t kNoMatch = UINT32_MAX;
+            uint32_t best = kNoMatch;
+            auto passes = [&](uint32_t rank) {
+                return RulePassesFilters(compiled_rules[compiled_order[rank]], protocol, port);
+            };
+
+            // 名次列表升序：取第一个满足过滤条件且优于当前结果的名次
+            auto visitRanks = [&](const std::vector<uint32_t>& ranks) {
+                for (uint32_t rank : ranks) {
+                    if (rank >= best) break;
+                    if (passes(rank)) {
+                        best = rank;
+                        break;
                     }
                 }
+                return best != 0;
+            };
 
-                if (matched) {
-                    if (outAction) *outAction = rule.raw.action.empty() ? action : rule.raw.action;
-                    if (outRule) *outRule = rule.raw.name;
-                    return true;
+            if (hasHost) {
+                compiled_domain_trie.Lookup(host, visitRanks);
+                for (const auto& g : compiled_domain_globs) {
+                    if (g.rank >= best) break;
+                    if (passes(g.rank) && GlobMatch(g.pattern, host)) best = g.rank;
                 }
             }
 
-            if (outAction) *outAction = action;
-            if (outRule) *outRule = "";
-            return false;
+            if (ip4Valid) {
+                uint8_t addr[4];
+                Ipv4ToBytes(ip4, addr);
+                compiled_cidr_v4_trie.Lookup(addr, 32, visitRanks);
+            }
+            if (ip6Valid) {
+                compiled_cidr_v6_trie.Lookup(ip6.data(), 128, visitRanks);
+            }
+
+            if (best != kNoMatch) {
+                const size_t idx = compiled_order[best];
+                const auto& rule = compiled_rules[idx];
+                decision.ruleIndex = static_cast<uint32_t>(idx);
+                if (!rule.raw.action.empty()) decision.action = rule.action_value;
+            }
+            return decision;
         }
     };
 
@@ -590,8 +767,11 @@ namespace Core {
             return s;
         }
 
-        // 判断路径是否为绝对路径（Windows 盘符或 UNC 路径）
+        // 判断路径是否为绝对路径（Windows 盘符或 UNC 路径；非 Windows 构建另认 / 开头）
         static bool IsAbsolutePath(const std::string& path) {
+#ifndef _WIN32
+            if (!path.empty() && path[0] == '/') return true;
+#endif
             if (path.size() >= 2 && std::isalpha(static_cast<unsigned char>(path[0])) && path[1] == ':') {
                 return true;
             }
@@ -602,8 +782,11 @@ namespace Core {
             return false;
         }
 
-        // 获取当前 DLL 所在目录（用于定位与 DLL 同目录的配置文件）
+        // 获取当前 DLL 所在目录（用于定位与 DLL 同目录的配置文件；非 Windows 构建返回空，按相对路径读取）
         static std::string GetModuleDirectory() {
+#ifndef _WIN32
+            return "";
+#else
             char modulePath[MAX_PATH] = {0};
             HMODULE hModule = NULL;
             if (!GetModuleHandleExA(
@@ -624,11 +807,14 @@ namespace Core {
                 }
             }
             return std::string(modulePath);
+#endif
         }
 
     public:
         ProxyConfig proxy;
         FakeIPConfig fakeIp;
+        DnsCacheConfig dnsCache;
+        WarmPoolConfig warmPool;
         TimeoutConfig timeout;
         ProxyRules rules;               // 代理路由规则
         bool trafficLogging = false;    // Phase 3: 是否启用流量监控日志
@@ -726,6 +912,14 @@ namespace Core {
                     Logger::SetLevel(LogLevel::Info);
                     Logger::Warn("配置: log_level 无效(" + logLevelStr + ")，已回退为 info (可选: debug/info/warn/error)");
                 }
+                // 异步日志：热路径只入队，由后台写线程批量写入常驻文件句柄（队列满时丢弃并计数）
+                Logger::SetAsync(j.value("log_async", false));
+                // 二进制调试日志：AGP_LOG_DEBUG 调用点只记录格式 id + 原始参数，离线用 blog_decode 还原
+                Logger::SetBinaryLog(j.value("log_binary", false));
+                // 共享内存日志环：每进程只写自己的环，由选出的收集进程合并写入日志文件（不再逐行争抢跨进程锁）
+                if (j.value("log_shared_ring", false) && !Logger::SetSharedRing(true)) {
+                    Logger::Warn("共享日志环初始化失败，回退为本进程写入");
+                }
                 if (!resolvedPath.empty()) {
                     Logger::Info("使用配置文件路径: " + resolvedPath);
                 }
@@ -735,6 +929,8 @@ namespace Core {
                     proxy.host = p.value("host", "127.0.0.1");
                     proxy.port = p.value("port", 7890);
                     proxy.type = p.value("type", "socks5");
+                    proxy.socks5_pipeline = p.value("socks5_pipeline", false);
+                    proxy.async_handshake = p.value("async_handshake", false);
                 }
 
                 // 配置校验：统一 proxy.type 大小写，并对关键字段做防御性修正，避免运行期异常
@@ -777,6 +973,60 @@ namespace Core {
                     fakeIp.enabled = fip.value("enabled", true);
                     fakeIp.cidr = fip.value("cidr", "198.18.0.0/15");
                     // max_entries 已废弃，Ring Buffer 策略下无需配置上限
+                    const int sharedCapacity = fip.value("shared_capacity", 4096);
+                    if (sharedCapacity < 256 || sharedCapacity > 262144) {
+                        Logger::Warn("配置: fake_ip.shared_capacity 超出范围 [256, 262144] (" +
+                                     std::to_string(sharedCapacity) + ")，已回退为 4096");
+                        fakeIp.shared_capacity = 4096;
+                    } else {
+                        fakeIp.shared_capacity = static_cast<uint32_t>(sharedCapacity);
+                    }
+                    fakeIp.shared_file = fip.value("shared_file", "");
+                    if (!fakeIp.shared_file.empty() && !IsAbsolutePath(fakeIp.shared_file)) {
+                        const std::string dllDir = GetModuleDirectory();
+                        if (!dllDir.empty()) fakeIp.shared_file = dllDir + "\\" + fakeIp.shared_file;
+                    }
+                }
+
+                if (j.contains("dns_cache")) {
+                    auto& dc = j["dns_cache"];
+                    dnsCache.enabled = dc.value("enabled", true);
+                    dnsCache.ttl_ms = dc.value("ttl", 60000);
+                    dnsCache.negative_ttl_ms = dc.value("negative_ttl", 5000);
+                    dnsCache.max_entries = dc.value("max_entries", 1024);
+                }
+                if (dnsCache.ttl_ms <= 0 || dnsCache.negative_ttl_ms < 0) {
+                    Logger::Warn("配置: dns_cache.ttl/negative_ttl 非法，已回退为 60000/5000");
+                    dnsCache.ttl_ms = 60000;
+                    dnsCache.negative_ttl_ms = 5000;
+                }
+                if (dnsCache.max_entries < 16 || dnsCache.max_entries > 65536) {
+                    Logger::Warn("配置: dns_cache.max_entries 超出范围 [16, 65536] (" +
+                                 std::to_string(dnsCache.max_entries) + ")，已回退为 1024");
+                    dnsCache.max_entries = 1024;
+                }
+
+                if (j.contains("warm_pool")) {
+                    auto& wp = j["warm_pool"];
+                    warmPool.enabled = wp.value("enabled", false);
+                    warmPool.max_idle = wp.value("max_idle", 2);
+                    warmPool.ttl_ms = wp.value("ttl", 30000);
+                    warmPool.udp_associations = wp.value("udp_associations", 1);
+                }
+                if (warmPool.max_idle < 1 || warmPool.max_idle > 16) {
+                    Logger::Warn("配置: warm_pool.max_idle 超出范围 [1, 16] (" +
+                                 std::to_string(warmPool.max_idle) + ")，已回退为 2");
+                    warmPool.max_idle = 2;
+                }
+                if (warmPool.ttl_ms < 1000 || warmPool.ttl_ms > 600000) {
+                    Logger::Warn("配置: warm_pool.ttl 超出范围 [1000, 600000] (" +
+                                 std::to_string(warmPool.ttl_ms) + ")，已回退为 30000");
+                    warmPool.ttl_ms = 30000;
+                }
+                if (warmPool.udp_associations < 0 || warmPool.udp_associations > 8) {
+                    Logger::Warn("配置: warm_pool.udp_associations 超出范围 [0, 8] (" +
+                                 std::to_string(warmPool.udp_associations) + ")，已回退为 1");
+                    warmPool.udp_associations = 1;
                 }
 
                 if (j.contains("timeout")) {
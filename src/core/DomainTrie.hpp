@@ -0,0 +1,115 @@
+#pragma once
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace Core {
+    // ============= 域名后缀 Trie（按 label 反序索引） =============
+    // 设计意图：路由规则中的域名列表可能达到数千~数万条（GFW/直连列表），
+    // 逐条 MatchDomainPattern 的成本为 O(规则数 × 模式数)；这里把可索引的模式编译成
+    // 反序 label 树（com -> example -> www），查询成本降为 O(host label 数)。
+    //
+    // 可索引的模式（输入须已小写）：
+    // - "example.com"    精确匹配
+    // - ".example.com"   根域 + 任意子域
+    // - "*.example.com"  仅任意子域（与 GlobMatch 语义一致：'*' 可跨越 '.'）
+    // 其余含 '*'/'?' 的模式返回 false，由调用方放入通配符列表走 GlobMatch。
+    //
+    // 节点内只存“规则名次”（rank，越小优先级越高），插入方按名次递增插入，保证列表有序。
+    class DomainSuffixTrie {
+    public:
+        bool Insert(std::string_view pattern, uint32_t rank) {
+            if (pattern.empty()) return false;
+            bool exact = true;
+            bool sub = false;
+            if (pattern.size() >= 2 && pattern[0] == '*' && pattern[1] == '.') {
+                pattern.remove_prefix(2);
+                exact = false;
+                sub = true;
+            } else if (pattern[0] == '.') {
+                pattern.remove_prefix(1);
+                sub = true;
+            }
+            if (pattern.empty()) return false;
+            if (pattern.find_first_of("*?") != std::string_view::npos) return false;
+
+            uint32_t node = 0;
+            ForEachLabelReversed(pattern, [&](std::string_view label, bool) {
+                node = GetOrAddChild(node, label);
+                return true;
+            });
+            if (exact) PushRank(&m_nodes[node].exactRanks, rank);
+            if (sub) PushRank(&m_nodes[node].subRanks, rank);
+            m_patternCount++;
+            return true;
+        }
+
+        // 沿 host 的 label 反序向下走，依次把命中的名次列表交给 visitor（升序）。
+        // visitor 返回 false 可提前终止（调用方已找到不可能被超越的结果）。
+        // host 须已小写且去掉末尾 '.'；查询过程不分配内存。
+        template <typename Visitor>
+        void Lookup(std::string_view host, Visitor&& visitor) const {
+            if (host.empty() || m_nodes.size() <= 1) return;
+            uint32_t node = 0;
+            ForEachLabelReversed(host, [&](std::string_view label, bool hasMore) {
+                const auto& children = m_nodes[node].children;
+                auto it = children.find(label);
+                if (it == children.end()) return false;
+                node = it->second;
+                const auto& ranks = hasMore ? m_nodes[node].subRanks : m_nodes[node].exactRanks;
+                if (!ranks.empty() && !visitor(ranks)) return false;
+                return true;
+            });
+        }
+
+        void Clear() {
+            m_nodes.assign(1, Node{});
+            m_patternCount = 0;
+        }
+
+        size_t PatternCount() const { return m_patternCount; }
+        size_t NodeCount() const { return m_nodes.size(); }
+
+    private:
+        struct Node {
+            std::map<std::string, uint32_t, std::less<>> children;
+            std::vector<uint32_t> exactRanks; // host 恰好止于此节点
+            std::vector<uint32_t> subRanks;   // host 在此节点之后仍有 label（子域）
+        };
+
+        // 从右向左切分 label；fn(label, hasMore) 返回 false 时停止
+        template <typename Fn>
+        static void ForEachLabelReversed(std::string_view s, Fn&& fn) {
+            size_t end = s.size();
+            while (true) {
+                const size_t dot = s.rfind('.', end == 0 ? std::string_view::npos : end - 1);
+                const bool hasMore = (dot != std::string_view::npos) && end > 0;
+                const size_t begin = hasMore ? dot + 1 : 0;
+                if (!fn(s.substr(begin, end - begin), hasMore)) return;
+                if (!hasMore) return;
+                end = dot;
+            }
+        }
+
+        uint32_t GetOrAddChild(uint32_t node, std::string_view label) {
+            auto it = m_nodes[node].children.find(label);
+            if (it != m_nodes[node].children.end()) return it->second;
+            const uint32_t id = static_cast<uint32_t>(m_nodes.size());
+            m_nodes[node].children.emplace(std::string(label), id);
+            m_nodes.emplace_back();
+            return id;
+        }
+
+        static void PushRank(std::vector<uint32_t>* ranks, uint32_t rank) {
+            // 同一规则内重复模式只记一次；跨规则按插入顺序天然递增
+            if (!ranks->empty() && ranks->back() == rank) return;
+            ranks->push_back(rank);
+        }
+
+        std::vector<Node> m_nodes = std::vector<Node>(1);
+        size_t m_patternCount = 0;
+    };
+}
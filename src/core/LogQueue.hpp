@@ -0,0 +1,205 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+namespace Core {
+    // ============= 异步日志队列（有界 MPSC 环形缓冲） =============
+    // 设计意图：热路径线程只做一次 CAS + 字符串 move，不碰文件、不等跨进程锁。
+    // 采用 Vyukov 有界队列：每个单元带序号，生产者 CAS 领取写位置，写完发布序号；
+    // 唯一的消费者（写线程）按序号判断单元是否已就绪。队列满时直接丢弃并计数，不阻塞调用方。
+    class LogQueue {
+    public:
+        // capacity 向上取整为 2 的幂
+        explicit LogQueue(size_t capacity) {
+            size_t cap = 2;
+            while (cap < capacity) cap <<= 1;
+            m_mask = cap - 1;
+            m_cells.reset(new Cell[cap]);
+            for (size_t i = 0; i < cap; i++) m_cells[i].seq.store(i, std::memory_order_relaxed);
+        }
+
+        LogQueue(const LogQueue&) = delete;
+        LogQueue& operator=(const LogQueue&) = delete;
+
+        // 多生产者：成功返回 true，line 换回一个已清空的旧缓冲（复用容量）；
+        // 队列满时丢弃该条（line 保持原样）并返回 false
+        bool TryPush(std::string& line) {
+            size_t pos = m_enqueuePos.load(std::memory_order_relaxed);
+            for (;;) {
+                Cell& cell = m_cells[pos & m_mask];
+                const size_t seq = cell.seq.load(std::memory_order_acquire);
+                const intptr_t diff = (intptr_t)seq - (intptr_t)pos;
+                if (diff == 0) {
+                    if (m_enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                        cell.line.swap(line);
+                        cell.seq.store(pos + 1, std::memory_order_release);
+                        return true;
+                    }
+                } else if (diff < 0) {
+                    m_dropped.fetch_add(1, std::memory_order_relaxed);
+                    return false;
+                } else {
+                    pos = m_enqueuePos.load(std::memory_order_relaxed);
+                }
+            }
+        }
+
+        // 单消费者：把已就绪的记录逐行追加到 batch（每行补 '\n'），直到队列空或 batch 超过 maxBytes。
+        // 返回取出的条数。某生产者领取位置后尚未写完时在该处停止，下次再取
+        size_t DrainTo(std::string* batch, size_t maxBytes) {
+            size_t count = 0;
+            while (batch->size() < maxBytes) {
+                Cell& cell = m_cells[m_dequeuePos & m_mask];
+                if (cell.seq.load(std::memory_order_acquire) != m_dequeuePos + 1) break;
+                batch->append(cell.line);
+                batch->push_back('\n');
+                cell.line.clear(); // 保留容量，生产者 swap 进来时复用
+                cell.seq.store(m_dequeuePos + m_mask + 1, std::memory_order_release);
+                m_dequeuePos++;
+                count++;
+            }
+            return count;
+        }
+
+        // 近似积压条数（仅用于决定是否提前唤醒写线程）
+        size_t ApproxSize() const {
+            const size_t enq = m_enqueuePos.load(std::memory_order_relaxed);
+            const size_t deq = m_dequeueSnapshot.load(std::memory_order_relaxed);
+            return enq > deq ? enq - deq : 0;
+        }
+
+        // 供消费者在每批结束时更新 ApproxSize 的参照点
+        void PublishProgress() { m_dequeueSnapshot.store(m_dequeuePos, std::memory_order_relaxed); }
+
+        size_t Capacity() const { return m_mask + 1; }
+        uint64_t Dropped() const { return m_dropped.load(std::memory_order_relaxed); }
+
+    private:
+        struct Cell {
+            std::atomic<size_t> seq{0};
+            std::string line;
+        };
+
+        std::unique_ptr<Cell[]> m_cells;
+        size_t m_mask = 0;
+        alignas(64) std::atomic<size_t> m_enqueuePos{0};
+        alignas(64) size_t m_dequeuePos = 0; // 仅消费者访问
+        std::atomic<size_t> m_dequeueSnapshot{0};
+        std::atomic<uint64_t> m_dropped{0};
+    };
+
+    // ============= 异步日志写线程 =============
+    // 写线程定期（或积压过半/高等级日志时立即）取出一批记录，交给 sink 一次性落盘；
+    // sink 负责文件句柄、大小与日期检查，因此这些开销按批摊薄而非按行支付。
+    // sink(batch, droppedSinceLastFlush)：batch 可能为空（仅上报丢弃数）
+    class AsyncLogWriter {
+    public:
+        using Sink = std::function<void(const std::string& batch, uint64_t dropped)>;
+
+        static constexpr size_t kMaxBatchBytes = 256 * 1024;
+        static constexpr int kFlushIntervalMs = 50;
+
+        AsyncLogWriter(size_t capacity, Sink sink) : m_queue(capacity), m_sink(std::move(sink)) {}
+        ~AsyncLogWriter() { Stop(); }
+
+        AsyncLogWriter(const AsyncLogWriter&) = delete;
+        AsyncLogWriter& operator=(const AsyncLogWriter&) = delete;
+
+        void Start() {
+            std::lock_guard<std::mutex> lock(m_wakeMtx);
+            if (m_thread.joinable()) return;
+            m_stop.store(false, std::memory_order_relaxed);
+            m_thread = std::thread([this]() { Run(); });
+        }
+
+        // 热路径：入队；urgent（警告/错误）或积压过半时唤醒写线程，否则等定时批量写出
+        bool Push(std::string& line, bool urgent) {
+            const bool ok = m_queue.TryPush(line);
+            if ((urgent || m_queue.ApproxSize() > m_queue.Capacity() / 2) &&
+                m_sleeping.load(std::memory_order_relaxed)) {
+                m_wake.notify_one();
+            }
+            return ok;
+        }
+
+        // 在调用线程上立即写出当前积压（写线程正在写时等它写完）
+        void Flush() {
+            std::lock_guard<std::mutex> lock(m_consumerMtx);
+            DrainLocked();
+        }
+
+        // 进程退出路径：其他线程可能已被强制终止（甚至终止在 sink 内持有消费锁），
+        // 只在能拿到消费锁时写出积压，绝不等待
+        void FlushNoWait() {
+            std::unique_lock<std::mutex> lock(m_consumerMtx, std::try_to_lock);
+            if (lock.owns_lock()) DrainLocked();
+        }
+
+        // 通知写线程退出但不等待（持有 Loader Lock 时只能这样做）
+        void RequestStop() {
+            m_stop.store(true, std::memory_order_relaxed);
+            m_wake.notify_one();
+        }
+
+        // 停止写线程并写出剩余记录（不可在持有 Loader Lock 时调用）
+        void Stop() {
+            {
+                std::lock_guard<std::mutex> lock(m_wakeMtx);
+                if (!m_thread.joinable()) return;
+                m_stop.store(true, std::memory_order_relaxed);
+            }
+            m_wake.notify_one();
+            m_thread.join();
+            Flush();
+        }
+
+        uint64_t Dropped() const { return m_queue.Dropped(); }
+
+    private:
+        void DrainLocked() {
+            for (;;) {
+                const uint64_t dropped = m_queue.Dropped();
+                m_batch.clear();
+                m_queue.DrainTo(&m_batch, kMaxBatchBytes);
+                if (m_batch.empty() && dropped == m_reportedDropped) break;
+                m_sink(m_batch, dropped - m_reportedDropped);
+                m_reportedDropped = dropped;
+            }
+            m_queue.PublishProgress();
+        }
+
+        void Run() {
+            while (!m_stop.load(std::memory_order_relaxed)) {
+                {
+                    std::lock_guard<std::mutex> lock(m_consumerMtx);
+                    DrainLocked();
+                }
+                std::unique_lock<std::mutex> lock(m_wakeMtx);
+                m_sleeping.store(true, std::memory_order_relaxed);
+                // 生产者的唤醒不持锁，可能错过；定时醒来兜底，最多延迟一个周期
+                m_wake.wait_for(lock, std::chrono::milliseconds(kFlushIntervalMs),
+                                [this]() { return m_stop.load(std::memory_order_relaxed); });
+                m_sleeping.store(false, std::memory_order_relaxed);
+            }
+        }
+
+        LogQueue m_queue;
+        Sink m_sink;
+        std::string m_batch;            // 受 m_consumerMtx 保护
+        uint64_t m_reportedDropped = 0; // 受 m_consumerMtx 保护
+        std::mutex m_consumerMtx;
+        std::mutex m_wakeMtx;
+        std::condition_variable m_wake;
+        std::atomic<bool> m_sleeping{false};
+        std::atomic<bool> m_stop{false};
+        std::thread m_thread;
+    };
+}
@@ -1,4 +1,10 @@
 #pragma once
+
+#ifndef _WIN32
+// 注入 DLL 只面向 Windows；Linux 上编译 Config.hpp 的单元测试/基准改用测试侧的 stderr 替身，
+// 本头文件不包含未经测试的非 Windows 日志实现。
+#include "../../tests/logger_stub.hpp"
+#else
 #include <fstream>
 #include <atomic>
 #include <mutex>
@@ -16,6 +22,10 @@
 #include <iomanip>
 #include <sstream>
 
+#include "BinaryLog.hpp"
+#include "LogQueue.hpp"
+#include "SharedLogRing.hpp"
+
 namespace Core {
     // 日志等级（用于控制输出粒度：默认 Info；需要更细粒度排障时可切到 Debug）
     enum class LogLevel : int {
@@ -76,6 +86,36 @@ namespace Core {
             return s_mutex;
         }
 
+        // 持有跨进程日志锁；互斥量不可用时退化为进程内互斥，保证不崩溃（但多进程一致性会弱一些）
+        class LogFileLock {
+        public:
+            LogFileLock() {
+                m_mutex = GetCrossProcessLogMutex();
+                DWORD waitRc = WAIT_FAILED;
+                if (m_mutex) {
+                    waitRc = WaitForSingleObject(m_mutex, INFINITE);
+                }
+                m_locked = (m_mutex != NULL) && (waitRc == WAIT_OBJECT_0 || waitRc == WAIT_ABANDONED);
+                if (!m_locked) {
+                    m_fallbackLock = std::unique_lock<std::mutex>(FallbackMutex());
+                }
+            }
+            ~LogFileLock() {
+                if (m_locked) ReleaseMutex(m_mutex);
+            }
+            LogFileLock(const LogFileLock&) = delete;
+            LogFileLock& operator=(const LogFileLock&) = delete;
+
+        private:
+            static std::mutex& FallbackMutex() {
+                static std::mutex s_fallbackMtx;
+                return s_fallbackMtx;
+            }
+            HANDLE m_mutex = NULL;
+            bool m_locked = false;
+            std::unique_lock<std::mutex> m_fallbackLock;
+        };
+
         // ========== 日志目录相关函数 ==========
         
         // 获取 DLL 所在目录（用于定位日志目录）
@@ -159,19 +199,24 @@ namespace Core {
         // ========== 原有辅助函数 ==========
         
         static std::string GetTimestamp() {
+            // 同一秒内复用上次格式化结果（每线程一份），热路径不必每行都走 localtime + put_time
+            thread_local time_t s_lastSecond = 0;
+            thread_local char s_text[32] = {0};
             auto now = std::time(nullptr);
-            struct tm tm;
-            localtime_s(&tm, &now);
-            std::ostringstream oss;
-            oss << std::put_time(&tm, "%Y-%m-%d %H:%M:%S");
-            return oss.str();
+            if (now != s_lastSecond) {
+                struct tm tm;
+                localtime_s(&tm, &now);
+                strftime(s_text, sizeof(s_text), "%Y-%m-%d %H:%M:%S", &tm);
+                s_lastSecond = now;
+            }
+            return s_text;
         }
 
-        static std::string GetPidTidPrefix() {
-            // 在多进程/多线程混写同一个日志文件时，PID/TID 有助于定位来源
-            DWORD pid = GetCurrentProcessId();
-            DWORD tid = GetCurrentThreadId();
-            return "[PID:" + std::to_string(pid) + "][TID:" + std::to_string(tid) + "]";
+        static const std::string& GetPidTidPrefix() {
+            // 在多进程/多线程混写同一个日志文件时，PID/TID 有助于定位来源（线程内不变，只拼一次）
+            thread_local const std::string s_prefix = "[PID:" + std::to_string(GetCurrentProcessId()) +
+                                                      "][TID:" + std::to_string(GetCurrentThreadId()) + "]";
+            return s_prefix;
         }
 
         // 获取今日日志文件完整路径（如：C:\xxx\logs\proxy-20260111.log）
@@ -206,6 +251,35 @@ namespace Core {
             return (static_cast<ULONGLONG>(data.nFileSizeHigh) << 32) | data.nFileSizeLow;
         }
 
+        // 今日二进制调试日志路径（按进程分文件：proxy-20260111-1234.blog），每批写出前调用一次；
+        // 日期变化时顺带清理其他日期的 .blog
+        static std::string GetTodayBinaryLogName() {
+            static std::string s_lastDay;
+            auto now = std::time(nullptr);
+            struct tm tm;
+            localtime_s(&tm, &now);
+            char day[16] = {0};
+            strftime(day, sizeof(day), "%Y%m%d", &tm);
+            const std::string logDir = GetLogDirectory();
+            const std::string prefix = logDir.empty() ? "" : (logDir + "\\");
+            if (s_lastDay != day) {
+                s_lastDay = day;
+                WIN32_FIND_DATAA findData{};
+                HANDLE hFind = FindFirstFileA((prefix + "proxy-*.blog").c_str(), &findData);
+                if (hFind != INVALID_HANDLE_VALUE) {
+                    const std::string todayPrefix = std::string("proxy-") + day + "-";
+                    do {
+                        if (findData.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) continue;
+                        if (std::string(findData.cFileName).compare(0, todayPrefix.size(), todayPrefix) != 0) {
+                            DeleteFileA((prefix + findData.cFileName).c_str());
+                        }
+                    } while (FindNextFileA(hFind, &findData));
+                    FindClose(hFind);
+                }
+            }
+            return prefix + "proxy-" + day + "-" + std::to_string(GetCurrentProcessId()) + ".blog";
+        }
+
         // 清理旧日志文件，只保留当天的日志
         static void CleanupOldLogs(const std::string& todayLog) {
             std::string logDir = GetLogDirectory();
@@ -242,51 +316,135 @@ namespace Core {
             DeleteFileA(oldLog1.c_str());
         }
 
-        static void WriteToFile(const std::string& message) {
-            // 按日期写日志并清理旧文件，避免历史日志堆积
-            static std::string s_todayLog;
-            // 需求：单文件 10MB 达到即覆盖写入（不轮转、不备份）
-            static const ULONGLONG kMaxLogBytes = 10ull * 1024 * 1024; // 10MB
-
-            // 多进程注入场景：使用跨进程互斥量保证“检查+截断+写入”的原子性
-            HANDLE hMutex = GetCrossProcessLogMutex();
-            DWORD waitRc = WAIT_FAILED;
-            if (hMutex) {
-                waitRc = WaitForSingleObject(hMutex, INFINITE);
-            }
-            const bool locked = (hMutex != NULL) && (waitRc == WAIT_OBJECT_0 || waitRc == WAIT_ABANDONED);
-
-            // 如果跨进程互斥不可用，退化为进程内互斥，保证不崩溃（但多进程一致性会弱一些）
-            static std::mutex s_fallbackMtx;
-            std::unique_lock<std::mutex> fallbackLock;
-            if (!locked) {
-                fallbackLock = std::unique_lock<std::mutex>(s_fallbackMtx);
-            }
+        // 需求：单文件 10MB 达到即覆盖写入（不轮转、不备份）
+        static constexpr ULONGLONG kMaxLogBytes = 10ull * 1024 * 1024; // 10MB
 
+        // 按日期切换日志文件并清理旧文件，避免历史日志堆积（调用方须持有 LogFileLock）
+        static const std::string& RollToToday() {
+            static std::string s_todayLog;
             std::string todayLog = GetTodayLogName();
             if (s_todayLog != todayLog) {
                 s_todayLog = todayLog;
                 CleanupOldLogs(s_todayLog);
             }
+            return s_todayLog;
+        }
+
+        static void WriteToFile(const std::string& message) {
+            // 多进程注入场景：使用跨进程互斥量保证“检查+截断+写入”的原子性
+            LogFileLock lock;
+            const std::string& todayLog = RollToToday();
 
             // 判断本次写入是否会超过上限；超过则直接截断覆盖写入
-            const ULONGLONG currentSize = GetFileSizeBytes(s_todayLog);
+            const ULONGLONG currentSize = GetFileSizeBytes(todayLog);
             const ULONGLONG appendBytes = static_cast<ULONGLONG>(message.size() + 1); // + '\n'
             const bool needTruncate = (currentSize > 0 && (currentSize + appendBytes) > kMaxLogBytes);
 
             std::ofstream logFile;
             if (needTruncate) {
-                logFile.open(s_todayLog, std::ios::out | std::ios::trunc);
+                logFile.open(todayLog, std::ios::out | std::ios::trunc);
             } else {
-                logFile.open(s_todayLog, std::ios::out | std::ios::app);
+                logFile.open(todayLog, std::ios::out | std::ios::app);
             }
             if (logFile.is_open()) {
                 logFile << message << "\n";
             }
+        }
+
+        // ========== 异步模式（log_async） ==========
+        // 热路径线程把格式化好的行推入无锁队列即返回；写线程按批（默认每 50ms，警告/错误立即）
+        // 写入常驻文件句柄，跨进程锁、日期切换与大小检查每批只做一次。
+        // 队列满时丢弃新日志并计数，下一批开头补一行丢弃统计。
+        static constexpr size_t kAsyncQueueCapacity = 8192;
+
+        static std::atomic<bool>& AsyncStorage() {
+            static std::atomic<bool> s_async{false};
+            return s_async;
+        }
+
+        // 有意不析构：DLL 卸载/进程退出时在 Loader Lock 内 join 写线程会死锁，退出路径见 Shutdown
+        static AsyncLogWriter& AsyncWriter() {
+            static AsyncLogWriter* s_writer = new AsyncLogWriter(kAsyncQueueCapacity, &WriteBatch);
+            return *s_writer;
+        }
+
+        // 写线程上执行：一批日志一次 WriteFile
+        static void WriteBatch(const std::string& batch, uint64_t dropped) {
+            static HANDLE s_file = INVALID_HANDLE_VALUE;
+            static std::string s_openPath;
+
+            std::string notice;
+            if (dropped > 0) {
+                notice = "[" + GetTimestamp() + "] " + GetPidTidPrefix() + " [警告] 日志缓冲已满，丢弃 " +
+                         std::to_string(dropped) + " 条\n";
+            }
+
+            LogFileLock lock;
+            const std::string& todayLog = RollToToday();
+            if (s_file != INVALID_HANDLE_VALUE && s_openPath != todayLog) {
+                CloseHandle(s_file);
+                s_file = INVALID_HANDLE_VALUE;
+            }
+            if (s_file == INVALID_HANDLE_VALUE) {
+                // 允许其他进程同时读写/删除（同步模式进程仍按行打开同一文件；跨天清理会删除旧文件）
+                s_file = CreateFileA(todayLog.c_str(), GENERIC_WRITE,
+                                     FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, NULL, OPEN_ALWAYS,
+                                     FILE_ATTRIBUTE_NORMAL, NULL);
+                if (s_file == INVALID_HANDLE_VALUE) return;
+                s_openPath = todayLog;
+            }
+
+            // 其他进程也在写同一文件：大小以句柄实时查询为准，每批一次
+            LARGE_INTEGER size{};
+            const ULONGLONG appendBytes = static_cast<ULONGLONG>(notice.size() + batch.size());
+            if (GetFileSizeEx(s_file, &size) && size.QuadPart > 0 &&
+                static_cast<ULONGLONG>(size.QuadPart) + appendBytes > kMaxLogBytes) {
+                LARGE_INTEGER zero{};
+                SetFilePointerEx(s_file, zero, NULL, FILE_BEGIN);
+                SetEndOfFile(s_file);
+            }
+            LARGE_INTEGER zero{};
+            SetFilePointerEx(s_file, zero, NULL, FILE_END);
+            auto writeAll = [](const std::string& data) {
+                size_t offset = 0;
+                while (offset < data.size()) {
+                    DWORD written = 0;
+                    const DWORD chunk = static_cast<DWORD>(std::min<size_t>(data.size() - offset, 1u << 20));
+                    if (!WriteFile(s_file, data.data() + offset, chunk, &written, NULL) || written == 0) return;
+                    offset += written;
+                }
+            };
+            writeAll(notice);
+            writeAll(batch);
+        }
 
-            if (locked) {
-                ReleaseMutex(hMutex);
+        // ========== 共享内存日志环（log_shared_ring） ==========
+        // 每个进程只写自己的命名环段，选出的收集进程每 50ms 合并各环、按时间排序后经 WriteBatch 写出；
+        // 热路径不再等待跨进程日志锁（收集进程每批仍持锁一次，兼容同时存在的同步模式进程）。
+        static constexpr uint32_t kSharedRingBytes = 512 * 1024;
+
+        static std::atomic<bool>& SharedStorage() {
+            static std::atomic<bool> s_shared{false};
+            return s_shared;
+        }
+
+        // 有意不析构：理由同 AsyncWriter
+        static SharedLogHub& SharedHub() {
+            static SharedLogHub* s_hub =
+                new SharedLogHub("Local\\AntigravityProxy_Log", kSharedRingBytes, &WriteBatch);
+            return *s_hub;
+        }
+
+        static void Emit(std::string line, LogLevel level) {
+            if (SharedStorage().load(std::memory_order_relaxed)) {
+                SharedHub().Push(line);
+                return;
             }
+            if (AsyncStorage().load(std::memory_order_relaxed)) {
+                AsyncWriter().Push(line, level >= LogLevel::Warn);
+                return;
+            }
+            WriteToFile(line);
         }
 
     public:
@@ -314,30 +472,109 @@ namespace Core {
             return true;
         }
 
+        // 切换异步模式；开启时启动写线程，关闭时把积压写出后回到同步按行写入
+        static void SetAsync(bool enabled) {
+            if (enabled) {
+                AsyncWriter().Start();
+                AsyncStorage().store(true, std::memory_order_relaxed);
+            } else if (AsyncStorage().exchange(false, std::memory_order_relaxed)) {
+                AsyncWriter().Flush();
+            }
+        }
+
+        static bool IsAsync() {
+            return AsyncStorage().load(std::memory_order_relaxed);
+        }
+
+        // 异步模式 / 共享环模式下因缓冲满而丢弃的日志条数（累计；同步模式返回 0）
+        static uint64_t GetDroppedCount() {
+            if (SharedStorage().load(std::memory_order_relaxed)) return SharedHub().Dropped();
+            return AsyncStorage().load(std::memory_order_relaxed) ? AsyncWriter().Dropped() : 0;
+        }
+
+        // 切换共享日志环模式；共享段不可用（或目录槽位已满）时返回 false，保持原写入方式
+        static bool SetSharedRing(bool enabled) {
+            if (enabled) {
+                if (!SharedHub().Start()) return false;
+                SharedStorage().store(true, std::memory_order_relaxed);
+                return true;
+            }
+            if (SharedStorage().exchange(false, std::memory_order_relaxed)) SharedHub().Stop();
+            return true;
+        }
+
+        static bool IsSharedRing() {
+            return SharedStorage().load(std::memory_order_relaxed);
+        }
+
+        // 二进制调试日志（log_binary）：开启后 AGP_LOG_DEBUG 只记录格式 id 与原始参数，
+        // 写入 logs\\proxy-日期-PID.blog，用 blog_decode 离线还原为文本
+        static void SetBinaryLog(bool enabled) {
+            if (enabled) {
+                BinaryLog::Instance().Start(&GetTodayBinaryLogName, kMaxLogBytes);
+            } else {
+                BinaryLog::Instance().Stop(true);
+            }
+        }
+
+        static bool IsBinaryLogEnabled() {
+            return BinaryLog::Instance().IsRunning();
+        }
+
+        // DLL_PROCESS_DETACH 调用：回到同步模式并尽力写出积压。此时持有 Loader Lock，
+        // 不能 join 写线程；进程退出时写线程可能已被终止，故只在拿得到消费锁时写出
+        static void Shutdown() {
+            BinaryLog::Instance().Stop(false);
+            // 共享环：收集进程做最后一轮并交出租约；否则标记退出，由收集进程取空本进程的环
+            if (SharedStorage().exchange(false, std::memory_order_relaxed)) SharedHub().Shutdown();
+            if (!AsyncStorage().exchange(false, std::memory_order_relaxed)) return;
+            AsyncWriter().RequestStop();
+            AsyncWriter().FlushNoWait();
+        }
+
         static void Log(const std::string& message) {
             // 将无等级的 Log 视为 Info 级别，确保可被 log_level 控制
             if (!IsEnabled(LogLevel::Info)) return;
-            WriteToFile("[" + GetTimestamp() + "] " + GetPidTidPrefix() + " " + message);
+            Emit("[" + GetTimestamp() + "] " + GetPidTidPrefix() + " " + message, LogLevel::Info);
         }
 
         static void Error(const std::string& message) {
             if (!IsEnabled(LogLevel::Error)) return;
-            WriteToFile("[" + GetTimestamp() + "] " + GetPidTidPrefix() + " [错误] " + message);
+            Emit("[" + GetTimestamp() + "] " + GetPidTidPrefix() + " [错误] " + message, LogLevel::Error);
         }
 
         static void Info(const std::string& message) {
             if (!IsEnabled(LogLevel::Info)) return;
-            WriteToFile("[" + GetTimestamp() + "] " + GetPidTidPrefix() + " [信息] " + message);
+            Emit("[" + GetTimestamp() + "] " + GetPidTidPrefix() + " [信息] " + message, LogLevel::Info);
         }
 
         static void Warn(const std::string& message) {
             if (!IsEnabled(LogLevel::Warn)) return;
-            WriteToFile("[" + GetTimestamp() + "] " + GetPidTidPrefix() + " [警告] " + message);
+            Emit("[" + GetTimestamp() + "] " + GetPidTidPrefix() + " [警告] " + message, LogLevel::Warn);
         }
 
         static void Debug(const std::string& message) {
             if (!IsEnabled(LogLevel::Debug)) return;
-            WriteToFile("[" + GetTimestamp() + "] " + GetPidTidPrefix() + " [调试] " + message);
+            Emit("[" + GetTimestamp() + "] " + GetPidTidPrefix() + " [调试] " + message, LogLevel::Debug);
         }
     };
 }
+
+// 延迟格式化的调试日志：格式串用 {} 占位，参数按类型渲染（BinaryLogHex / BinaryLogAddr 见 BinaryLog.hpp）。
+// 开启 log_binary 时每个调用点只登记一次格式，之后只记录格式 id 与原始参数；否则按同一规则渲染为文本
+// 走 Logger::Debug。Debug 未开启时参数不求值。
+#define AGP_LOG_DEBUG(fmt, ...)                                                                            \
+    do {                                                                                                   \
+        if (::Core::Logger::IsEnabled(::Core::LogLevel::Debug)) {                                          \
+            if (::Core::BinaryLog::Instance().IsRunning()) {                                               \
+                static const uint16_t agpLogId_ = ::Core::BinaryLog::Instance().Register(                  \
+                    static_cast<int>(::Core::LogLevel::Debug), __FILE__, __LINE__, fmt,                    \
+                    decltype(::Core::BinaryLog::SignatureOf(__VA_ARGS__))::value);                         \
+                ::Core::BinaryLog::Instance().Record(agpLogId_, ##__VA_ARGS__);                            \
+            } else {                                                                                       \
+                ::Core::Logger::Debug(::Core::BinaryLog::FormatText(fmt, ##__VA_ARGS__));                  \
+            }                                                                                              \
+        }                                                                                                  \
+    } while (0)
+
+#endif // _WIN32
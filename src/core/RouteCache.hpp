@@ -0,0 +1,185 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include "Config.hpp"
+
+namespace Core {
+    // ============= 路由决策缓存（分片 + CLOCK 淘汰） =============
+    // 设计意图：Chromium 类客户端会反复连接同一批 host:port，每次 connect 都重跑
+    // MatchRouting（域名 Trie + 通配符 + CIDR）并不划算。这里在路由引擎前加一层
+    // 有界缓存：key = (host, ip, port, protocol)，value = RouteDecision。
+    // - 失效：条目记录 ProxyRules::compiled_generation，规则重新编译后旧条目自然失效
+    // - 有界：每个分片固定容量，CLOCK（二次机会）淘汰，内存上限恒定
+    // - 并发：按 key 哈希分片，每片一把小锁，避免全局锁成为 IOCP 线程的汇聚点
+    class RouteDecisionCache {
+    public:
+        static constexpr size_t kShardCount = 16;
+        static constexpr size_t kDefaultShardCapacity = 256;
+
+        struct Stats {
+            uint64_t hits = 0;
+            uint64_t misses = 0;
+            uint64_t evictions = 0;
+        };
+
+        explicit RouteDecisionCache(size_t shardCapacity = kDefaultShardCapacity) {
+            if (shardCapacity == 0) shardCapacity = 1;
+            for (auto& shard : m_shards) {
+                shard.entries.resize(shardCapacity);
+                shard.index.reserve(shardCapacity * 2);
+            }
+        }
+
+        static RouteDecisionCache& Instance() {
+            static RouteDecisionCache instance;
+            return instance;
+        }
+
+        // 查缓存，未命中则走 rules.MatchRouting 并回填；语义与直接调用 MatchRouting 完全一致
+        RouteDecision Match(const ProxyRules& rules, std::string_view host, std::string_view ip, bool ipIsV6,
+                            uint16_t port, RouteProtocol protocol) {
+            // routing 关闭时无需缓存（MatchRouting 立即返回）
+            if (!rules.routing.enabled) return rules.MatchRouting(host, ip, ipIsV6, port, protocol);
+
+            const uint64_t hash = HashKey(host, ip, ipIsV6, port, protocol);
+            Shard& shard = m_shards[hash % kShardCount];
+            {
+                std::lock_guard<std::mutex> lock(shard.mtx);
+                auto it = shard.index.find(hash);
+                if (it != shard.index.end()) {
+                    Entry& e = shard.entries[it->second];
+                    if (e.generation == rules.compiled_generation && e.Matches(host, ip, ipIsV6, port, protocol)) {
+                        e.referenced = true;
+                        m_hits.fetch_add(1, std::memory_order_relaxed);
+                        return e.decision;
+                    }
+                }
+            }
+
+            m_misses.fetch_add(1, std::memory_order_relaxed);
+            const RouteDecision decision = rules.MatchRouting(host, ip, ipIsV6, port, protocol);
+
+            std::lock_guard<std::mutex> lock(shard.mtx);
+            auto it = shard.index.find(hash);
+            size_t slot = 0;
+            if (it != shard.index.end()) {
+                // 同 hash：旧代条目或（极少见的）哈希碰撞，直接覆盖
+                slot = it->second;
+            } else {
+                slot = EvictOne(&shard);
+                shard.index[hash] = slot;
+            }
+            Entry& e = shard.entries[slot];
+            e.used = true;
+            e.referenced = false;
+            e.hash = hash;
+            e.host.assign(host.data(), host.size());
+            e.ip.assign(ip.data(), ip.size());
+            e.ipIsV6 = ipIsV6;
+            e.port = port;
+            e.protocol = protocol;
+            e.generation = rules.compiled_generation;
+            e.decision = decision;
+            return decision;
+        }
+
+        Stats GetStats() const {
+            Stats s;
+            s.hits = m_hits.load(std::memory_order_relaxed);
+            s.misses = m_misses.load(std::memory_order_relaxed);
+            s.evictions = m_evictions.load(std::memory_order_relaxed);
+            return s;
+        }
+
+        size_t Size() {
+            size_t n = 0;
+            for (auto& shard : m_shards) {
+                std::lock_guard<std::mutex> lock(shard.mtx);
+                n += shard.index.size();
+            }
+            return n;
+        }
+
+        void Clear() {
+            for (auto& shard : m_shards) {
+                std::lock_guard<std::mutex> lock(shard.mtx);
+                for (auto& e : shard.entries) e = Entry{};
+                shard.index.clear();
+                shard.hand = 0;
+            }
+        }
+
+    private:
+        struct Entry {
+            bool used = false;
+            bool referenced = false;
+            bool ipIsV6 = false;
+            RouteProtocol protocol = RouteProtocol::Tcp;
+            uint16_t port = 0;
+            uint32_t generation = 0;
+            uint64_t hash = 0;
+            std::string host;
+            std::string ip;
+            RouteDecision decision{};
+
+            bool Matches(std::string_view h, std::string_view addr, bool v6, uint16_t p, RouteProtocol proto) const {
+                return used && port == p && protocol == proto && ipIsV6 == v6 && host == h && ip == addr;
+            }
+        };
+
+        struct Shard {
+            std::mutex mtx;
+            std::vector<Entry> entries;
+            std::unordered_map<uint64_t, size_t> index; // key hash -> entries 下标
+            size_t hand = 0;
+        };
+
+        // CLOCK：跳过近期被访问过的条目（清除其引用位），淘汰第一个未引用条目
+        size_t EvictOne(Shard* shard) {
+            const size_t cap = shard->entries.size();
+            while (true) {
+                Entry& e = shard->entries[shard->hand];
+                const size_t slot = shard->hand;
+                shard->hand = (shard->hand + 1) % cap;
+                if (!e.used) return slot;
+                if (e.referenced) {
+                    e.referenced = false;
+                    continue;
+                }
+                shard->index.erase(e.hash);
+                e.used = false;
+                m_evictions.fetch_add(1, std::memory_order_relaxed);
+                return slot;
+            }
+        }
+
+        // FNV-1a 64：字段之间插入分隔，避免 ("ab","c") 与 ("a","bc") 碰撞
+        static uint64_t HashKey(std::string_view host, std::string_view ip, bool ipIsV6, uint16_t port,
+                                RouteProtocol protocol) {
+            uint64_t h = 1469598103934665603ull;
+            auto mix = [&](uint8_t b) {
+                h ^= b;
+                h *= 1099511628211ull;
+            };
+            for (char c : host) mix(static_cast<uint8_t>(c));
+            mix(0xFF);
+            for (char c : ip) mix(static_cast<uint8_t>(c));
+            mix(ipIsV6 ? 1 : 0);
+            mix(static_cast<uint8_t>(port >> 8));
+            mix(static_cast<uint8_t>(port & 0xFF));
+            mix(static_cast<uint8_t>(protocol));
+            return h;
+        }
+
+        std::array<Shard, kShardCount> m_shards;
+        std::atomic<uint64_t> m_hits{0};
+        std::atomic<uint64_t> m_misses{0};
+        std::atomic<uint64_t> m_evictions{0};
+    };
+}
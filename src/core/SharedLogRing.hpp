@@ -0,0 +1,670 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+#ifndef _WIN32
+#include <unistd.h>
+#endif
+
+#include "../network/SharedMemory.hpp"
+
+namespace Core {
+    // ============= 每进程共享内存日志环（多生产者 / 单消费者，跨进程） =============
+    // 设计意图：同步日志每行都要等 Local\AntigravityProxy_LogFileMutex（INFINITE），
+    // 子进程风暴时各进程的 hook 线程互相等对方的磁盘写入。这里每个进程只往自己的命名段写：
+    // - 生产者（本进程任意线程）CAS 领取 reserve 游标上的一段字节，写完记录后以 release
+    //   写入记录头的 size 字段作为“已提交”标记；不持锁、不等其他进程
+    // - 消费者（被选出的收集进程，见 SharedLogHub）按顺序读取已提交记录，遇到尚未提交的
+    //   记录即停（下轮再取）；读完把这段字节清零后推进 read，生产者据此判断剩余空间
+    // - 记录不跨越环尾：尾部放不下时先写一条填充记录占满剩余空间，记录本身从环首开始
+    // - 空间不足时丢弃该行并计数（dropped），由收集进程在日志中补一行丢弃统计
+    //
+    // 记录布局（8 字节对齐）：[u32 size（含头部，0 = 未提交，最高位 = 填充）][u32 length][u64 stamp][payload]
+    // stamp 为单调时钟 ns（系统范围：Windows QPC / Linux CLOCK_MONOTONIC），收集时用于跨进程排序。
+    //
+    // 进程中的某个线程在“领取后、提交前”被强制终止时，该记录永远不会提交，本环后续记录
+    // 会一直等到该进程退出（收集进程随后丢弃整个环）。正常运行中不会出现这种情况。
+    class SharedLogRing {
+    public:
+        static constexpr uint32_t kMagic = 0x474C5241; // "ARLG"
+        static constexpr uint32_t kVersion = 1;
+        static constexpr uint32_t kPadBit = 0x80000000u;
+
+        static_assert(std::atomic<uint32_t>::is_always_lock_free, "共享段要求 32 位原子无锁");
+        static_assert(std::atomic<uint64_t>::is_always_lock_free, "共享段要求 64 位原子无锁");
+
+        struct Header {
+            std::atomic<uint32_t> state;    // 0 未初始化 / 1 初始化中 / 2 就绪
+            uint32_t magic;
+            uint32_t version;
+            uint32_t capacity;              // 数据区字节数（2 的幂）
+            uint32_t ownerPid;
+            std::atomic<uint32_t> consumer; // 当前消费者 PID（0 = 无），见 SharedLogHub
+            uint32_t reserved0[10];
+            alignas(64) std::atomic<uint64_t> reserve; // 生产者已领取的总字节数
+            alignas(64) std::atomic<uint64_t> read;    // 消费者已释放的总字节数
+            std::atomic<uint64_t> dropped;
+            uint64_t reserved1[6];
+        };
+        static_assert(sizeof(Header) == 192, "环形日志段头部须保持 192 字节");
+
+        struct RecordHeader {
+            std::atomic<uint32_t> size;
+            uint32_t length;
+            uint64_t stamp;
+        };
+        static_assert(sizeof(RecordHeader) == 16, "记录头须保持 16 字节");
+
+        static size_t RequiredBytes(uint32_t capacity) { return sizeof(Header) + capacity; }
+
+        // 单条日志上限：超出部分截断，保证一条长日志不会占满整个环
+        uint32_t MaxPayload() const { return m_header ? m_header->capacity / 4 : 0; }
+
+        // 绑定到一段共享内存（新建段须为全 0）；capacity 须为 2 的幂且不小于 4KB
+        bool Attach(void* base, size_t bytes, uint32_t capacity, uint32_t ownerPid) {
+            m_header = nullptr;
+            if (!base || capacity < 4096 || (capacity & (capacity - 1)) != 0 || bytes < RequiredBytes(capacity)) {
+                return false;
+            }
+            Header* header = static_cast<Header*>(base);
+            uint32_t state = 0;
+            if (header->state.compare_exchange_strong(state, 1, std::memory_order_acq_rel)) {
+                header->magic = kMagic;
+                header->version = kVersion;
+                header->capacity = capacity;
+                header->ownerPid = ownerPid;
+                header->state.store(2, std::memory_order_release);
+            } else {
+                for (int i = 0; i < 100000 && header->state.load(std::memory_order_acquire) != 2; i++) {
+                    std::this_thread::yield();
+                }
+                if (header->state.load(std::memory_order_acquire) != 2) return false;
+            }
+            if (header->magic != kMagic || header->version != kVersion || header->capacity != capacity) return false;
+            m_header = header;
+            m_data = reinterpret_cast<uint8_t*>(header + 1);
+            m_corrupt = false;
+            return true;
+        }
+
+        bool IsAttached() const { return m_header != nullptr; }
+        Header* HeaderPtr() const { return m_header; }
+
+        // 多生产者：写入一条记录；空间不足时丢弃并计数，返回 false
+        bool TryWrite(uint64_t stamp, const char* data, size_t len) {
+            if (!m_header) return false;
+            if (len > MaxPayload()) len = MaxPayload();
+            const uint64_t cap = m_header->capacity;
+            const uint64_t need = Align8(sizeof(RecordHeader) + len);
+            uint64_t pos = m_header->reserve.load(std::memory_order_relaxed);
+            uint64_t pad = 0;
+            for (;;) {
+                const uint64_t at = pos & (cap - 1);
+                pad = (cap - at < need) ? (cap - at) : 0;
+                if (pos + pad + need - m_header->read.load(std::memory_order_acquire) > cap) {
+                    m_header->dropped.fetch_add(1, std::memory_order_relaxed);
+                    return false;
+                }
+                if (m_header->reserve.compare_exchange_weak(pos, pos + pad + need, std::memory_order_relaxed)) break;
+            }
+            if (pad) {
+                SizeAt(pos & (cap - 1))->store(static_cast<uint32_t>(pad) | kPadBit, std::memory_order_release);
+                pos += pad;
+            }
+            RecordHeader* rec = reinterpret_cast<RecordHeader*>(m_data + (pos & (cap - 1)));
+            rec->length = static_cast<uint32_t>(len);
+            rec->stamp = stamp;
+            std::memcpy(reinterpret_cast<uint8_t*>(rec + 1), data, len);
+            rec->size.store(static_cast<uint32_t>(need), std::memory_order_release);
+            return true;
+        }
+
+        // 单消费者：按顺序回调已提交记录（payload 指向环内，回调返回后失效），随后释放这段空间。
+        // 返回记录条数。发现记录头越界（段被破坏）时停止并标记 IsCorrupt，不再消费
+        size_t Drain(const std::function<void(uint64_t stamp, std::string_view line)>& onRecord) {
+            if (!m_header || m_corrupt) return 0;
+            const uint64_t cap = m_header->capacity;
+            const uint64_t start = m_header->read.load(std::memory_order_relaxed);
+            const uint64_t end = m_header->reserve.load(std::memory_order_acquire);
+            uint64_t pos = start;
+            size_t count = 0;
+            while (pos < end) {
+                const uint64_t at = pos & (cap - 1);
+                const uint32_t word = SizeAt(at)->load(std::memory_order_acquire);
+                if (word == 0) break; // 生产者尚未提交
+                const uint64_t bytes = word & ~kPadBit;
+                if (bytes < 8 || (bytes & 7) != 0 || bytes > cap - at || pos + bytes > end) {
+                    m_corrupt = true;
+                    break;
+                }
+                if (!(word & kPadBit)) {
+                    const RecordHeader* rec = reinterpret_cast<const RecordHeader*>(m_data + at);
+                    if (bytes < sizeof(RecordHeader) || sizeof(RecordHeader) + (uint64_t)rec->length > bytes) {
+                        m_corrupt = true;
+                        break;
+                    }
+                    onRecord(rec->stamp, std::string_view(reinterpret_cast<const char*>(rec + 1), rec->length));
+                    count++;
+                }
+                pos += bytes;
+            }
+            if (pos != start) {
+                // 清零后再释放：下一圈的记录起点不一定与本圈对齐，残留字节不能被误认为已提交
+                const uint64_t from = start & (cap - 1);
+                const uint64_t n = pos - start;
+                const uint64_t first = std::min<uint64_t>(n, cap - from);
+                std::memset(m_data + from, 0, static_cast<size_t>(first));
+                std::memset(m_data, 0, static_cast<size_t>(n - first));
+                m_header->read.store(pos, std::memory_order_release);
+            }
+            return count;
+        }
+
+        // 已领取但尚未释放的字节数（0 表示环已空）
+        uint64_t PendingBytes() const {
+            if (!m_header) return 0;
+            return m_header->reserve.load(std::memory_order_acquire) - m_header->read.load(std::memory_order_acquire);
+        }
+
+        uint64_t Dropped() const { return m_header ? m_header->dropped.load(std::memory_order_relaxed) : 0; }
+        bool IsCorrupt() const { return m_corrupt; }
+
+    private:
+        static uint64_t Align8(uint64_t n) { return (n + 7) & ~uint64_t(7); }
+        std::atomic<uint32_t>* SizeAt(uint64_t at) const { return reinterpret_cast<std::atomic<uint32_t>*>(m_data + at); }
+
+        Header* m_header = nullptr;
+        uint8_t* m_data = nullptr;
+        bool m_corrupt = false;
+    };
+
+    // ============= 日志环目录（跨进程） =============
+    // 固定槽位表：每个启用共享环的进程占一个槽（PID + 心跳），收集进程据此找到各进程的环。
+    // 收集者以租约选出：collectorPid 为空或心跳超时时 CAS 抢占；在任者每轮刷新心跳。
+    class SharedLogDirectory {
+    public:
+        static constexpr uint32_t kMagic = 0x474C4441; // "ADLG"
+        static constexpr uint32_t kVersion = 1;
+        static constexpr uint32_t kSlots = 64;
+
+        struct Slot {
+            std::atomic<uint32_t> pid;     // 0 = 空闲
+            std::atomic<uint32_t> closing; // 进程已退出（环中可能仍有待收集的日志）
+            std::atomic<uint64_t> beat;    // 最近心跳（单调时钟 ms）
+            std::atomic<uint32_t> generation; // 每次登记递增：PID 被复用时收集者据此重新打开环
+            uint32_t reserved;
+        };
+        static_assert(sizeof(Slot) == 24, "目录槽位须保持 24 字节");
+
+        struct Header {
+            std::atomic<uint32_t> state;
+            uint32_t magic;
+            uint32_t version;
+            uint32_t slotCount;
+            std::atomic<uint32_t> collectorPid;
+            uint32_t reserved0;
+            std::atomic<uint64_t> collectorBeat;
+            uint64_t reserved1[4];
+        };
+        static_assert(sizeof(Header) == 64, "目录段头部须保持 64 字节");
+
+        static size_t RequiredBytes() { return sizeof(Header) + kSlots * sizeof(Slot); }
+
+        bool Attach(void* base, size_t bytes) {
+            m_header = nullptr;
+            if (!base || bytes < RequiredBytes()) return false;
+            Header* header = static_cast<Header*>(base);
+            uint32_t state = 0;
+            if (header->state.compare_exchange_strong(state, 1, std::memory_order_acq_rel)) {
+                header->magic = kMagic;
+                header->version = kVersion;
+                header->slotCount = kSlots;
+                header->state.store(2, std::memory_order_release);
+            } else {
+                for (int i = 0; i < 100000 && header->state.load(std::memory_order_acquire) != 2; i++) {
+                    std::this_thread::yield();
+                }
+                if (header->state.load(std::memory_order_acquire) != 2) return false;
+            }
+            if (header->magic != kMagic || header->version != kVersion || header->slotCount != kSlots) return false;
+            m_header = header;
+            m_slots = reinterpret_cast<Slot*>(header + 1);
+            return true;
+        }
+
+        // 占用一个槽位；已有同 PID 的槽（PID 被系统复用、旧进程的槽尚未回收）时直接接管。
+        // 返回槽下标，槽位已满返回 -1
+        int Register(uint32_t pid, uint64_t nowMs) {
+            if (!m_header) return -1;
+            int index = -1;
+            for (uint32_t i = 0; i < kSlots && index < 0; i++) {
+                if (m_slots[i].pid.load(std::memory_order_acquire) == pid) index = static_cast<int>(i);
+            }
+            for (uint32_t i = 0; i < kSlots && index < 0; i++) {
+                uint32_t expected = 0;
+                if (m_slots[i].pid.compare_exchange_strong(expected, pid, std::memory_order_acq_rel)) {
+                    index = static_cast<int>(i);
+                }
+            }
+            if (index < 0) return -1;
+            m_slots[index].generation.fetch_add(1, std::memory_order_relaxed);
+            m_slots[index].closing.store(0, std::memory_order_relaxed);
+            m_slots[index].beat.store(nowMs, std::memory_order_release);
+            return index;
+        }
+
+        Slot& SlotAt(uint32_t index) const { return m_slots[index]; }
+
+        // 成为（或继续担任）收集者返回 true；previous 返回被接替的前任 PID（0 = 无前任或本就是自己）
+        bool AcquireCollector(uint32_t pid, uint64_t nowMs, uint64_t staleMs, uint32_t* previous) {
+            if (previous) *previous = 0;
+            if (!m_header) return false;
+            uint32_t current = m_header->collectorPid.load(std::memory_order_acquire);
+            if (current == pid) {
+                m_header->collectorBeat.store(nowMs, std::memory_order_release);
+                return true;
+            }
+            const uint64_t beat = m_header->collectorBeat.load(std::memory_order_acquire);
+            if (current != 0 && nowMs < beat + staleMs) return false;
+            if (!m_header->collectorPid.compare_exchange_strong(current, pid, std::memory_order_acq_rel)) return false;
+            m_header->collectorBeat.store(nowMs, std::memory_order_release);
+            if (previous) *previous = current;
+            return true;
+        }
+
+        bool IsCollector(uint32_t pid) const {
+            return m_header && m_header->collectorPid.load(std::memory_order_acquire) == pid;
+        }
+
+        void ReleaseCollector(uint32_t pid) {
+            if (!m_header) return;
+            uint32_t expected = pid;
+            m_header->collectorPid.compare_exchange_strong(expected, 0, std::memory_order_acq_rel);
+        }
+
+    private:
+        Header* m_header = nullptr;
+        Slot* m_slots = nullptr;
+    };
+
+    // ============= 本进程的共享日志端点（生产 + 可能的收集） =============
+    // 每个进程：
+    // - 创建自己的环段（<prefix>_Ring_<pid>）并在目录中登记；日志行只写入本进程的环
+    // - 后台泵线程每 kPumpIntervalMs 刷新心跳并尝试获取收集者租约
+    // 收集者：打开（并持有）所有登记进程的环，逐环取出记录，按 stamp 合并排序后交给 sink 一次写出。
+    // 持有映射意味着某进程退出后其环仍可读，收集者读空后才回收槽位。
+    //
+    // 每个环同一时刻只允许一个消费者：环头 consumer 字段以 CAS 认领。收集者接替前任时
+    // 一并接管前任认领的环；进程退出时若没有收集者认领本进程的环，则自己取空后退出。
+    // 收集者卡顿超过 staleMs 时可能被接替；前任恢复后在下一轮发现租约已失并放弃所有环。
+    //
+    // Push 不持锁：先登记在途写入再检查 m_ready。退出流程清掉 m_ready 后等在途写入归零，
+    // 才取空本进程的环并解除映射；限时内等不到（进程退出时写线程可能停在 Push 中途）则保留映射。
+    class SharedLogHub {
+    public:
+        using Sink = std::function<void(const std::string& batch, uint64_t dropped)>;
+
+        static constexpr int kPumpIntervalMs = 50;
+        static constexpr uint64_t kDefaultStaleMs = 3000;
+        static constexpr uint64_t kWriterWaitMs = 200;
+
+        SharedLogHub(std::string prefix, uint32_t ringCapacity, Sink sink, uint64_t staleMs = kDefaultStaleMs)
+            : m_prefix(std::move(prefix)), m_capacity(ringCapacity), m_sink(std::move(sink)), m_staleMs(staleMs),
+              m_pid(CurrentProcessId()) {
+            m_peers.resize(SharedLogDirectory::kSlots);
+        }
+
+        SharedLogHub(const SharedLogHub&) = delete;
+        SharedLogHub& operator=(const SharedLogHub&) = delete;
+
+        // 打开目录与本进程的环并登记；startPump=false 时不启动泵线程（测试逐轮调用 PumpOnce）
+        bool Start(bool startPump = true) {
+            std::lock_guard<std::mutex> lock(m_pumpMtx);
+            if (m_ready.load(std::memory_order_acquire)) return true;
+            // 上次退出时有写入未结束，环映射被保留：不再复用，回退为本进程写入
+            if (m_ringPinned) return false;
+            bool created = false;
+            if (!m_dirRegion.Open(m_prefix + "_Dir", SharedLogDirectory::RequiredBytes(), &created) ||
+                !m_directory.Attach(m_dirRegion.Data(), m_dirRegion.Size())) {
+                m_dirRegion.Close();
+                return false;
+            }
+            // 先建环再登记：收集者看到槽位时环一定已存在
+            const std::string ringName = RingName(m_pid);
+            if (!m_ringRegion.Open(ringName, SharedLogRing::RequiredBytes(m_capacity), &created) ||
+                !m_ring.Attach(m_ringRegion.Data(), m_ringRegion.Size(), m_capacity, m_pid)) {
+                m_ringRegion.Close();
+                m_dirRegion.Close();
+                return false;
+            }
+            if (!RegisterLocked()) {
+                m_ringRegion.Close();
+                Network::SharedMemoryRegion::Remove(ringName);
+                m_dirRegion.Close();
+                return false;
+            }
+            m_ready.store(true, std::memory_order_release);
+            if (startPump) {
+                m_stop.store(false, std::memory_order_relaxed);
+                m_thread = std::thread([this]() { Run(); });
+            }
+            return true;
+        }
+
+        bool IsReady() const { return m_ready.load(std::memory_order_acquire); }
+
+        // 热路径：写入本进程的环；环满时丢弃并计数
+        bool Push(const std::string& line) {
+            // 与 ExitLocked 的 m_ready/m_writers 构成 Dekker 式握手，两侧都需 seq_cst
+            m_writers.fetch_add(1, std::memory_order_seq_cst);
+            bool written = false;
+            if (m_ready.load(std::memory_order_seq_cst)) written = m_ring.TryWrite(NowNs(), line.data(), line.size());
+            m_writers.fetch_sub(1, std::memory_order_release);
+            return written;
+        }
+
+        // 一轮：刷新心跳；持有收集者租约时收集全部环并写出
+        void PumpOnce() {
+            std::lock_guard<std::mutex> lock(m_pumpMtx);
+            PumpLocked();
+        }
+
+        bool IsCollector() const { return m_directory.IsCollector(m_pid); }
+        uint64_t Dropped() const { return m_ring.Dropped(); }
+
+        // 停止泵线程（不可在持有 Loader Lock 时调用），随后执行退出流程
+        void Stop() {
+            {
+                std::lock_guard<std::mutex> lock(m_wakeMtx);
+                m_stop.store(true, std::memory_order_relaxed);
+            }
+            m_wake.notify_one();
+            if (m_thread.joinable()) m_thread.join();
+            std::lock_guard<std::mutex> lock(m_pumpMtx);
+            ExitLocked();
+        }
+
+        // 进程退出路径（持有 Loader Lock）：只通知泵线程，且仅在拿得到泵锁时执行退出流程
+        void Shutdown() {
+            {
+                std::lock_guard<std::mutex> lock(m_wakeMtx);
+                m_stop.store(true, std::memory_order_relaxed);
+            }
+            m_wake.notify_one();
+            std::unique_lock<std::mutex> lock(m_pumpMtx, std::try_to_lock);
+            if (lock.owns_lock()) ExitLocked();
+        }
+
+        // 测试用：模拟进程被强制终止（不做任何退出流程，停掉泵线程后原样丢下共享状态）
+        void Abandon() {
+            {
+                std::lock_guard<std::mutex> lock(m_wakeMtx);
+                m_stop.store(true, std::memory_order_relaxed);
+            }
+            m_wake.notify_one();
+            if (m_thread.joinable()) m_thread.join();
+            m_ready.store(false, std::memory_order_release);
+        }
+
+    private:
+        struct Peer {
+            uint32_t pid = 0;
+            uint32_t generation = 0;
+            std::unique_ptr<Network::SharedMemoryRegion> region;
+            SharedLogRing ring;
+            bool owned = false; // 已认领为消费者
+            uint64_t reportedDropped = 0;
+        };
+
+        struct Pending {
+            uint64_t stamp;
+            std::string line;
+        };
+
+        std::string RingName(uint32_t pid) const { return m_prefix + "_Ring_" + std::to_string(pid); }
+
+        void Run() {
+            while (!m_stop.load(std::memory_order_relaxed)) {
+                PumpOnce();
+                std::unique_lock<std::mutex> lock(m_wakeMtx);
+                m_wake.wait_for(lock, std::chrono::milliseconds(kPumpIntervalMs),
+                                [this]() { return m_stop.load(std::memory_order_relaxed); });
+            }
+        }
+
+        bool RegisterLocked() {
+            m_slot = m_directory.Register(m_pid, NowMs());
+            if (m_slot < 0) return false;
+            m_generation = m_directory.SlotAt(static_cast<uint32_t>(m_slot)).generation.load(std::memory_order_acquire);
+            return true;
+        }
+
+        void PumpLocked() {
+            if (!m_ready.load(std::memory_order_acquire)) return;
+            const SharedLogDirectory::Slot& slot = m_directory.SlotAt(static_cast<uint32_t>(m_slot));
+            if (slot.pid.load(std::memory_order_acquire) != m_pid ||
+                slot.generation.load(std::memory_order_acquire) != m_generation) {
+                // 本进程卡顿超过 staleMs，槽位被收集者当作过期回收：重新登记（环段仍由本进程持有）
+                if (!RegisterLocked()) return;
+            }
+            const uint64_t now = NowMs();
+            m_directory.SlotAt(static_cast<uint32_t>(m_slot)).beat.store(now, std::memory_order_release);
+            uint32_t previous = 0;
+            if (!m_directory.AcquireCollector(m_pid, now, m_staleMs, &previous)) {
+                // 租约已被接替（本进程曾卡顿）：放下所有环，由新收集者接管
+                CloseAllPeers();
+                return;
+            }
+            if (previous != 0) m_previousCollector = previous;
+            Collect(now);
+        }
+
+        void Collect(uint64_t now) {
+            m_pending.clear();
+            uint64_t dropped = 0;
+            for (uint32_t i = 0; i < SharedLogDirectory::kSlots; i++) {
+                SharedLogDirectory::Slot& slot = m_directory.SlotAt(i);
+                const uint32_t pid = slot.pid.load(std::memory_order_acquire);
+                Peer& peer = m_peers[i];
+                if (pid == 0) {
+                    ClosePeer(&peer);
+                    continue;
+                }
+                const uint32_t generation = slot.generation.load(std::memory_order_acquire);
+                if ((peer.pid != pid || peer.generation != generation) && !OpenPeer(&peer, pid, generation)) {
+                    // 环段已不存在（进程退出且无人持有）：槽位过期后回收
+                    if (IsSlotGone(slot, now)) FreeSlot(i, pid);
+                    continue;
+                }
+                if (!ClaimPeer(&peer)) continue;
+                peer.ring.Drain([this](uint64_t stamp, std::string_view line) {
+                    m_pending.push_back(Pending{stamp, std::string(line)});
+                });
+                const uint64_t ringDropped = peer.ring.Dropped();
+                dropped += ringDropped - peer.reportedDropped;
+                peer.reportedDropped = ringDropped;
+                if (peer.ring.IsCorrupt() || (IsSlotGone(slot, now) && peer.ring.PendingBytes() == 0)) {
+                    ClosePeer(&peer);
+                    FreeSlot(i, pid);
+                }
+            }
+            if (m_pending.empty() && dropped == 0) return;
+            // 各环内部已按写入顺序排列；跨进程按单调时钟合并（同一时刻保持环内顺序）
+            std::stable_sort(m_pending.begin(), m_pending.end(),
+                             [](const Pending& a, const Pending& b) { return a.stamp < b.stamp; });
+            m_batch.clear();
+            for (const Pending& p : m_pending) {
+                m_batch.append(p.line);
+                m_batch.push_back('\n');
+            }
+            m_sink(m_batch, dropped);
+        }
+
+        bool OpenPeer(Peer* peer, uint32_t pid, uint32_t generation) {
+            ClosePeer(peer);
+            std::unique_ptr<Network::SharedMemoryRegion> region(new Network::SharedMemoryRegion());
+            bool created = false;
+            const std::string name = RingName(pid);
+            if (!region->Open(name, SharedLogRing::RequiredBytes(m_capacity), &created)) return false;
+            if (created) {
+                // 只有本次打开才创建了段：原进程已退出且段已释放，不能认领一个空壳
+                region->Close();
+                Network::SharedMemoryRegion::Remove(name);
+                return false;
+            }
+            if (!peer->ring.Attach(region->Data(), region->Size(), m_capacity, pid)) return false;
+            peer->pid = pid;
+            peer->generation = generation;
+            peer->region = std::move(region);
+            peer->owned = false;
+            peer->reportedDropped = 0;
+            return true;
+        }
+
+        // 认领环的消费权：空闲、或属于已被本进程接替的前任收集者时接管
+        bool ClaimPeer(Peer* peer) {
+            if (peer->owned) return true;
+            std::atomic<uint32_t>& consumer = peer->ring.HeaderPtr()->consumer;
+            uint32_t current = consumer.load(std::memory_order_acquire);
+            if (current != 0 && current != m_pid && current != m_previousCollector) return false;
+            if (current != m_pid && !consumer.compare_exchange_strong(current, m_pid, std::memory_order_acq_rel)) {
+                return false;
+            }
+            peer->owned = true;
+            peer->reportedDropped = peer->ring.Dropped(); // 接管前的丢弃数已由前任上报
+            return true;
+        }
+
+        void ClosePeer(Peer* peer) {
+            if (peer->owned && peer->ring.IsAttached()) {
+                uint32_t expected = m_pid;
+                peer->ring.HeaderPtr()->consumer.compare_exchange_strong(expected, 0, std::memory_order_acq_rel);
+            }
+            peer->region.reset();
+            peer->ring = SharedLogRing();
+            peer->pid = 0;
+            peer->owned = false;
+        }
+
+        void CloseAllPeers() {
+            for (Peer& peer : m_peers) {
+                if (peer.region) ClosePeer(&peer);
+            }
+        }
+
+        bool IsSlotGone(const SharedLogDirectory::Slot& slot, uint64_t now) const {
+            if (slot.closing.load(std::memory_order_acquire)) return true;
+            const uint64_t beat = slot.beat.load(std::memory_order_acquire);
+            return now > beat + m_staleMs;
+        }
+
+        void FreeSlot(uint32_t index, uint32_t pid) {
+            if (pid == m_pid) return; // 本进程的槽由退出流程处理
+            // 只在确认进程已正常退出时删除段名：仅是心跳超时的进程可能还活着，稍后会重新登记
+            if (m_directory.SlotAt(index).closing.load(std::memory_order_acquire)) {
+                Network::SharedMemoryRegion::Remove(RingName(pid));
+            }
+            uint32_t expected = pid;
+            m_directory.SlotAt(index).pid.compare_exchange_strong(expected, 0, std::memory_order_acq_rel);
+        }
+
+        // 退出流程：收集者做最后一轮并交出租约；否则在无人认领本进程的环时自己取空
+        void ExitLocked() {
+            if (!m_ready.exchange(false, std::memory_order_seq_cst)) return;
+            const bool quiesced = WaitForWriters();
+            SharedLogDirectory::Slot& slot = m_directory.SlotAt(static_cast<uint32_t>(m_slot));
+            if (m_directory.IsCollector(m_pid)) {
+                Collect(NowMs());
+                CloseAllPeers();
+                m_directory.ReleaseCollector(m_pid);
+            }
+            std::atomic<uint32_t>& consumer = m_ring.HeaderPtr()->consumer;
+            uint32_t expected = 0;
+            if (consumer.compare_exchange_strong(expected, m_pid, std::memory_order_acq_rel)) {
+                m_pending.clear();
+                m_ring.Drain([this](uint64_t stamp, std::string_view line) {
+                    m_pending.push_back(Pending{stamp, std::string(line)});
+                });
+                m_batch.clear();
+                for (const Pending& p : m_pending) {
+                    m_batch.append(p.line);
+                    m_batch.push_back('\n');
+                }
+                const uint64_t dropped = m_ring.Dropped();
+                if (!m_batch.empty() || dropped != 0) m_sink(m_batch, dropped);
+                // 环已取空且无人持有：直接归还槽位
+                uint32_t pid = m_pid;
+                slot.pid.compare_exchange_strong(pid, 0, std::memory_order_acq_rel);
+                if (quiesced) m_ringRegion.Close();
+                else m_ringPinned = true;
+                Network::SharedMemoryRegion::Remove(RingName(m_pid));
+                return;
+            }
+            // 收集者持有本进程环的映射：标记退出，它取空后回收槽位
+            slot.closing.store(1, std::memory_order_release);
+        }
+
+        // 等待已越过 m_ready 检查的 Push 写完；超时返回 false
+        bool WaitForWriters() const {
+            const uint64_t deadline = NowMs() + kWriterWaitMs;
+            while (m_writers.load(std::memory_order_seq_cst) != 0) {
+                if (NowMs() >= deadline) return false;
+                std::this_thread::yield();
+            }
+            return true;
+        }
+
+        static uint32_t CurrentProcessId() {
+#ifdef _WIN32
+            return static_cast<uint32_t>(GetCurrentProcessId());
+#else
+            return static_cast<uint32_t>(getpid());
+#endif
+        }
+
+        static uint64_t NowNs() {
+            return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count());
+        }
+
+        static uint64_t NowMs() { return NowNs() / 1000000; }
+
+        std::string m_prefix;
+        uint32_t m_capacity;
+        Sink m_sink;
+        uint64_t m_staleMs;
+        uint32_t m_pid;
+
+        Network::SharedMemoryRegion m_dirRegion;
+        SharedLogDirectory m_directory;
+        Network::SharedMemoryRegion m_ringRegion;
+        SharedLogRing m_ring;
+        int m_slot = -1;
+        uint32_t m_generation = 0;
+        std::atomic<bool> m_ready{false};
+        std::atomic<uint32_t> m_writers{0}; // 在途 Push 数
+        bool m_ringPinned = false;          // 退出时等不到在途写入，环映射保留到进程结束
+
+        std::mutex m_pumpMtx;                 // 以下收集状态受其保护
+        std::vector<Peer> m_peers;            // 按目录槽位下标
+        uint32_t m_previousCollector = 0;
+        std::vector<Pending> m_pending;
+        std::string m_batch;
+
+        std::atomic<bool> m_stop{false};
+        std::mutex m_wakeMtx;
+        std::condition_variable m_wake;
+        std::thread m_thread;
+    };
+}
@@ -0,0 +1,171 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace Core {
+    // ============= 并发请求合并（singleflight） =============
+    // 设计意图：浏览器对同一主机并发开多条连接时，各线程会同时对同一名字发起解析。
+    // 这里按 key 合并：第一个调用方（leader）执行 fn，其余调用方（waiter）等待并共享同一结果。
+    // - 有界等待：waiter 最多等 waitMs，超时返回 TimedOut，由调用方决定回退策略
+    // - 取消：Cancel/CancelAll 唤醒对应 waiter 并返回 Cancelled；leader 照常完成，结果只交给自己。
+    //   被取消的 key 立即从在途表移除，之后的调用方会重新发起
+    // - cancelToken：单个 waiter 的取消标志（例如调用方所在连接已关闭），等待期间按切片轮询
+    // leader 总是同步执行 fn，不受 waitMs 约束；fn 不应抛异常（与本仓库其余代码一致，不使用异常）
+    template <typename T>
+    class SingleFlight {
+    public:
+        enum class Status {
+            Leader,    // 本调用方执行了 fn
+            Shared,    // 复用了其他调用方的结果
+            TimedOut,  // 等待超过 waitMs
+            Cancelled, // 等待期间被取消
+        };
+
+        struct Stats {
+            uint64_t leaders = 0;
+            uint64_t shared = 0;
+            uint64_t timeouts = 0;
+            uint64_t cancels = 0;
+        };
+
+        // waiter 轮询 cancelToken 的切片长度
+        static constexpr uint32_t kPollSliceMs = 10;
+
+        Status Do(const std::string& key, const std::function<T()>& fn, uint32_t waitMs, T* out,
+                  const std::atomic<bool>* cancelToken = nullptr) {
+            std::shared_ptr<Call> call;
+            bool leader = false;
+            {
+                std::lock_guard<std::mutex> lock(m_mtx);
+                auto it = m_calls.find(key);
+                if (it != m_calls.end()) {
+                    call = it->second;
+                    call->waiters++;
+                } else {
+                    call = std::make_shared<Call>();
+                    m_calls.emplace(key, call);
+                    leader = true;
+                }
+            }
+
+            if (leader) {
+                T value = fn();
+                {
+                    std::lock_guard<std::mutex> lock(m_mtx);
+                    auto it = m_calls.find(key);
+                    if (it != m_calls.end() && it->second == call) m_calls.erase(it);
+                    call->value = value;
+                    call->done = true;
+                }
+                m_cv.notify_all();
+                m_leaders.fetch_add(1, std::memory_order_relaxed);
+                if (out) *out = std::move(value);
+                return Status::Leader;
+            }
+
+            const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(waitMs);
+            std::unique_lock<std::mutex> lock(m_mtx);
+            for (;;) {
+                if (call->done) {
+                    if (out) *out = call->value;
+                    m_shared.fetch_add(1, std::memory_order_relaxed);
+                    return Status::Shared;
+                }
+                if (call->cancelled) {
+                    m_cancels.fetch_add(1, std::memory_order_relaxed);
+                    return Status::Cancelled;
+                }
+                if (cancelToken && cancelToken->load(std::memory_order_acquire)) {
+                    call->waiters--;
+                    m_cancels.fetch_add(1, std::memory_order_relaxed);
+                    return Status::Cancelled;
+                }
+                const auto now = std::chrono::steady_clock::now();
+                if (now >= deadline) {
+                    call->waiters--;
+                    m_timeouts.fetch_add(1, std::memory_order_relaxed);
+                    return Status::TimedOut;
+                }
+                auto slice = deadline - now;
+                if (cancelToken) slice = std::min<decltype(slice)>(slice, std::chrono::milliseconds(kPollSliceMs));
+                m_cv.wait_for(lock, slice);
+            }
+        }
+
+        // 取消 key 的在途请求，返回被唤醒的 waiter 数
+        size_t Cancel(const std::string& key) {
+            size_t woken = 0;
+            {
+                std::lock_guard<std::mutex> lock(m_mtx);
+                auto it = m_calls.find(key);
+                if (it == m_calls.end()) return 0;
+                it->second->cancelled = true;
+                woken = it->second->waiters;
+                m_calls.erase(it);
+            }
+            m_cv.notify_all();
+            return woken;
+        }
+
+        size_t CancelAll() {
+            size_t woken = 0;
+            {
+                std::lock_guard<std::mutex> lock(m_mtx);
+                for (auto& kv : m_calls) {
+                    kv.second->cancelled = true;
+                    woken += kv.second->waiters;
+                }
+                m_calls.clear();
+            }
+            m_cv.notify_all();
+            return woken;
+        }
+
+        // key 的在途请求当前挂起的 waiter 数（不含 leader）
+        size_t Waiters(const std::string& key) {
+            std::lock_guard<std::mutex> lock(m_mtx);
+            auto it = m_calls.find(key);
+            return it == m_calls.end() ? 0 : it->second->waiters;
+        }
+
+        size_t InFlight() {
+            std::lock_guard<std::mutex> lock(m_mtx);
+            return m_calls.size();
+        }
+
+        Stats GetStats() const {
+            Stats s;
+            s.leaders = m_leaders.load(std::memory_order_relaxed);
+            s.shared = m_shared.load(std::memory_order_relaxed);
+            s.timeouts = m_timeouts.load(std::memory_order_relaxed);
+            s.cancels = m_cancels.load(std::memory_order_relaxed);
+            return s;
+        }
+
+    private:
+        struct Call {
+            T value{};
+            size_t waiters = 0;
+            bool done = false;
+            bool cancelled = false;
+        };
+
+        std::mutex m_mtx;
+        // 所有在途请求共用一个条件变量：完成/取消都是低频事件，被错误唤醒的 waiter 重新检查自己的 Call 即可
+        std::condition_variable m_cv;
+        std::unordered_map<std::string, std::shared_ptr<Call>> m_calls;
+
+        std::atomic<uint64_t> m_leaders{0};
+        std::atomic<uint64_t> m_shared{0};
+        std::atomic<uint64_t> m_timeouts{0};
+        std::atomic<uint64_t> m_cancels{0};
+    };
+}
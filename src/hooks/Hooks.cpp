@@ -18,14 +18,22 @@
 #include <atomic>
 #include <memory>
 #include "../core/Config.hpp"
+#include "../core/RouteCache.hpp"
 #include "../core/Logger.hpp"
 #include "../network/SocketWrapper.hpp"
 #include "../network/FakeIP.hpp"
+#include "../network/AddrInfoBuilder.hpp"
+#include "../network/DnsCache.hpp"
+#include "../network/ProxyEndpoint.hpp"
+#include "../network/ProxyHandshake.hpp"
 #include "../network/Socks5.hpp"
 #include "../network/Socks5Udp.hpp"
 #include "../network/HttpConnect.hpp"
 #include "../network/SocketIo.hpp"
+#include "../network/WarmPool.hpp"
 #include "../network/TrafficMonitor.hpp"
+#include "../network/UdpRecvBuffer.hpp"
+#include "../network/SocketStateTable.hpp"
 #include "../injection/ProcessInjector.hpp"
 
 // ============= 函数指针类型定义 =============
@@ -34,6 +42,8 @@ typedef int (WSAAPI *WSAConnect_t)(SOCKET, const struct sockaddr*, int, LPWSABUF
 typedef struct hostent* (WSAAPI *gethostbyname_t)(const char* name);
 typedef int (WSAAPI *getaddrinfo_t)(PCSTR, PCSTR, const ADDRINFOA*, PADDRINFOA*);
 typedef int (WSAAPI *getaddrinfoW_t)(PCWSTR, PCWSTR, const ADDRINFOW*, PADDRINFOW*);
+typedef void (WSAAPI *freeaddrinfo_t)(PADDRINFOA);
+typedef void (WSAAPI *FreeAddrInfoW_t)(PADDRINFOW);
 typedef int (WSAAPI *send_t)(SOCKET, const char*, int, int);
 typedef int (WSAAPI *recv_t)(SOCKET, char*, int, int);
 typedef int (WSAAPI *sendto_t)(SOCKET, const char*, int, int, const struct sockaddr*, int);
@@ -67,6 +77,8 @@ WSAConnect_t fpWSAConnect = NULL;
 gethostbyname_t fpGetHostByName = NULL;
 getaddrinfo_t fpGetAddrInfo = NULL;
 getaddrinfoW_t fpGetAddrInfoW = NULL;
+freeaddrinfo_t fpFreeAddrInfo = NULL;
+FreeAddrInfoW_t fpFreeAddrInfoW = NULL;
 send_t fpSend = NULL;
 recv_t fpRecv = NULL;
 sendto_t fpSendTo = NULL;
@@ -105,29 +117,6 @@ struct SocketTargetInfo {
     uint16_t port = 0;
     ULONGLONG establishedTick = 0;
 };
-static std::unordered_map<SOCKET, SocketTargetInfo> g_socketTargets;
-static std::mutex g_socketTargetsMtx;
-
-static void RememberSocketTarget(SOCKET s, const std::string& host, uint16_t port) {
-    if (s == INVALID_SOCKET || host.empty() || port == 0) return;
-    std::lock_guard<std::mutex> lock(g_socketTargetsMtx);
-    g_socketTargets[s] = SocketTargetInfo{host, port, GetTickCount64()};
-}
-
-static bool TryGetSocketTarget(SOCKET s, SocketTargetInfo* out) {
-    if (!out || s == INVALID_SOCKET) return false;
-    std::lock_guard<std::mutex> lock(g_socketTargetsMtx);
-    auto it = g_socketTargets.find(s);
-    if (it == g_socketTargets.end()) return false;
-    *out = it->second;
-    return true;
-}
-
-static void ForgetSocketTarget(SOCKET s) {
-    if (s == INVALID_SOCKET) return;
-    std::lock_guard<std::mutex> lock(g_socketTargetsMtx);
-    g_socketTargets.erase(s);
-}
 
 // ConnectEx 异步上下文
 struct ConnectExContext {
@@ -141,14 +130,13 @@ struct ConnectExContext {
     ULONGLONG createdTick; // 记录创建时间，便于清理超时上下文
 };
 
-static std::unordered_map<LPOVERLAPPED, ConnectExContext> g_connectExPending;
-static std::mutex g_connectExMtx;
 static std::mutex g_connectExHookMtx;
 // ConnectEx 在不同 Provider 下可能返回不同函数指针，这里按 CatalogEntryId 记录各自的 trampoline
 static std::unordered_map<DWORD, LPFN_CONNECTEX> g_connectExOriginalByCatalog;
 // ConnectEx 目标函数指针可能被多个 Provider 复用，这里按“目标函数地址”记录 trampoline，便于复用与补全 Catalog 映射
 static std::unordered_map<void*, LPFN_CONNECTEX> g_connectExTrampolineByTarget;
 static const ULONGLONG kConnectExPendingTtlMs = 60000; // 超过 60 秒的上下文视为过期
+static const ULONGLONG kConnectExPurgeIntervalMs = 5000; // 过期扫描的最小间隔
 
 // ============= UDP/QUIC 代理支持（SOCKS5 UDP Associate） =============
 
@@ -165,17 +153,19 @@ struct UdpProxyContext {
     std::string defaultTargetHost;
     uint16_t defaultTargetPort = 0;
     bool hasDefaultTarget = false;
+    // default target 对应的 SOCKS5 UDP 头：目标变化时编码一次，发送时只拷贝这几十字节
+    uint8_t defaultHeader[Network::Socks5::kMaxUdpHeaderBytes] = {};
+    size_t defaultHeaderLen = 0;
 
     ULONGLONG createdTick = 0;
 };
-static std::unordered_map<SOCKET, UdpProxyContext> g_udpProxy;
-static std::mutex g_udpProxyMtx;
 
 // UDP Overlapped 上下文（用于 IOCP/CompletionRoutine 场景下解封装/调整 bytesTransferred）
 struct UdpOverlappedSendCtx {
     SOCKET sock = INVALID_SOCKET;
     std::vector<WSABUF> bufs;            // [0]=header, [1..]=用户 payload（仅复制描述符，不复制数据）
-    std::vector<uint8_t> header;         // SOCKS5 UDP 头（需保持到完成）
+    uint8_t header[Network::Socks5::kMaxUdpHeaderBytes] = {}; // SOCKS5 UDP 头（需保持到完成）
+    size_t headerLen = 0;
     DWORD userBytes = 0;                 // 用户视角 payload bytes（不含 header）
     LPDWORD userBytesPtr = nullptr;      // 指向用户 lpNumberOfBytesSent（可为空）
     LPWSAOVERLAPPED_COMPLETION_ROUTINE userCompletion = nullptr;
@@ -183,7 +173,10 @@ struct UdpOverlappedSendCtx {
 
 struct UdpOverlappedRecvCtx {
     SOCKET sock = INVALID_SOCKET;
-    std::vector<uint8_t> recvBuf;        // 实际接收缓冲区（包含 SOCKS5 UDP 头 + payload）
+    // 原地模式：直接收进用户缓冲，头部挤出的尾部字节落在 tail，完成时在用户缓冲内 memmove
+    bool inPlace = false;
+    uint8_t tail[Network::UdpRecv::kTailBytes];
+    std::vector<uint8_t> recvBuf;        // 非原地模式的接收缓冲区（包含 SOCKS5 UDP 头 + payload），来自 RecvBufferPool
     LPWSABUF userBufs = nullptr;
     DWORD userBufCount = 0;
     LPDWORD userBytesPtr = nullptr;
@@ -195,12 +188,66 @@ struct UdpOverlappedRecvCtx {
     int fromTmpLen = (int)sizeof(fromTmp);
 
     LPWSAOVERLAPPED_COMPLETION_ROUTINE userCompletion = nullptr;
+
+    ~UdpOverlappedRecvCtx() {
+        Network::UdpRecv::RecvBufferPool::Instance().Release(std::move(recvBuf));
+    }
+};
+
+// ============= 分片状态表 =============
+// 设计意图：原先“目标 / UDP 上下文 / ConnectEx / UDP Overlapped”各有一张全局表和一把全局锁，
+// 一次 UDP WSASend 要拿三把锁，所有 IOCP 线程都挤在这几把锁上。现在按 key 合并为两张分片表：
+// - g_sockets：以 SOCKET 为 key，目标、UDP 上下文与缓存的 SO_TYPE 放在同一条目里，每个 detour 只查一次
+// - g_pendingOverlapped：以 OVERLAPPED* 为 key；完成端（GQCS/WSAGetOverlappedResult）只拿得到
+//   OVERLAPPED，因此挂起的操作不能并入 SOCKET 表，但 ConnectEx 与 UDP 收发合并为一个条目、一次查找
+// 条目在 closesocket 时整体删除，避免句柄复用后沿用旧状态。
+struct SocketState {
+    SocketTargetInfo target;              // host 为空表示未记录
+    std::unique_ptr<UdpProxyContext> udp; // 仅 udp_mode=proxy 下建立过 UDP Associate 的 socket 才有
+    int soType = 0;                       // 缓存的 SO_TYPE（0 = 尚未读取）
+
+    bool Empty() const { return target.host.empty() && !udp && soType == 0; }
 };
+static Network::SocketStateTable<SOCKET, SocketState> g_sockets;
+
+struct PendingOverlapped {
+    bool hasConnectEx = false;
+    ConnectExContext connectEx{};
+    std::shared_ptr<UdpOverlappedSendCtx> udpSend;
+    std::shared_ptr<UdpOverlappedRecvCtx> udpRecv;
 
-static std::unordered_map<LPWSAOVERLAPPED, std::shared_ptr<UdpOverlappedSendCtx>> g_udpOvlSend;
-static std::unordered_map<LPWSAOVERLAPPED, std::shared_ptr<UdpOverlappedRecvCtx>> g_udpOvlRecv;
-static std::mutex g_udpOvlMtx;
-static SOCKET ConnectTcpToProxyServer(const Core::ProxyConfig& proxy);
+    bool Empty() const { return !hasConnectEx && !udpSend && !udpRecv; }
+};
+static Network::SocketStateTable<LPOVERLAPPED, PendingOverlapped> g_pendingOverlapped;
+
+static void RememberSocketTarget(SOCKET s, const std::string& host, uint16_t port) {
+    if (s == INVALID_SOCKET || host.empty() || port == 0) return;
+    g_sockets.Upsert(s, [&](SocketState& st) { st.target = SocketTargetInfo{host, port, GetTickCount64()}; });
+}
+
+static bool TryGetSocketTarget(SOCKET s, SocketTargetInfo* out) {
+    if (!out || s == INVALID_SOCKET) return false;
+    bool found = false;
+    g_sockets.Visit(s, [&](SocketState& st) {
+        if (st.target.host.empty()) return;
+        *out = st.target;
+        found = true;
+    });
+    return found;
+}
+
+// 在分片锁内访问 socket 的 UDP 上下文（只做字段读写）；没有 UDP 上下文时返回 false
+template <typename Fn>
+static bool WithUdpProxyContext(SOCKET s, Fn&& fn) {
+    bool found = false;
+    g_sockets.Visit(s, [&](SocketState& st) {
+        if (!st.udp) return;
+        found = true;
+        fn(*st.udp);
+    });
+    return found;
+}
+static SOCKET ConnectTcpToProxyServer(const Core::ProxyConfig& proxy, bool* socks5Negotiated = nullptr);
 
 // 为了避免日志被大量非目标进程淹没，这里仅首次记录“跳过注入”的进程名
 static std::unordered_map<std::string, bool> g_loggedSkipProcesses;
@@ -656,11 +703,33 @@ static void LogLanguageServerNodeCompatInjectOnce(const std::string& childProces
     });
 }
 
-// 统一 socket 类型判定入口：只读取一次 SO_TYPE，避免热路径重复 getsockopt
+// 一次查表：返回 socket 类型，存在 UDP 上下文时在分片锁内执行 onUdp(UdpProxyContext&)。
+// SO_TYPE 每个 socket 只读取一次并缓存在 g_sockets 中（closesocket 时随条目删除）；读取失败返回 0 且不缓存。
+template <typename Fn>
+static int LookupSocketState(SOCKET s, Fn&& onUdp) {
+    int soType = 0;
+    g_sockets.Visit(s, [&](SocketState& st) {
+        soType = st.soType;
+        if (soType != 0 && st.udp) onUdp(*st.udp);
+    });
+    if (soType != 0) return soType;
+    if (!TryGetSocketType(s, &soType) || soType == 0) return 0;
+    g_sockets.Upsert(s, [&](SocketState& st) {
+        st.soType = soType;
+        if (st.udp) onUdp(*st.udp);
+    });
+    return soType;
+}
+
+static int GetCachedSocketType(SOCKET s) {
+    return LookupSocketState(s, [](UdpProxyContext&) {});
+}
+
+// 统一 socket 类型判定入口：SO_TYPE 按 socket 缓存，避免热路径重复 getsockopt
 // 兼容性策略：读取失败时仍按 SOCK_STREAM 处理（保持历史行为，降低误判风险）
 static int GetSocketTypeForProxyDecision(SOCKET s, bool* outKnown = nullptr) {
-    int soType = 0;
-    const bool known = TryGetSocketType(s, &soType);
+    const int soType = GetCachedSocketType(s);
+    const bool known = soType != 0;
     if (outKnown) *outKnown = known;
     return known ? soType : SOCK_STREAM;
 }
@@ -984,6 +1053,49 @@ static bool IsProxySelfTarget(const std::string& host, uint16_t port, const Core
     return port == proxy.port && (host == proxy.host || host == "127.0.0.1");
 }
 
+// 进程内 DNS 缓存：首次使用时按配置初始化；解析后端使用原始 getaddrinfo（绕开 FakeIP hook）
+static Network::DnsCache& GetDnsCache() {
+    static std::once_flag s_once;
+    std::call_once(s_once, []() {
+        const Core::DnsCacheConfig& dc = Core::Config::Instance().dnsCache;
+        Network::DnsCache::Options options;
+        options.enabled = dc.enabled;
+        options.ttlMs = (uint32_t)dc.ttl_ms;
+        options.negativeTtlMs = (uint32_t)dc.negative_ttl_ms;
+        options.refreshAheadMs = options.ttlMs / 6;
+        options.maxEntries = (size_t)dc.max_entries;
+        // 并发解析同一名字时，跟随者最多等待一个连接超时
+        options.coalesceWaitMs = (uint32_t)Core::Config::Instance().timeout.connect_ms;
+        Network::DnsCache::Instance().Configure(options,
+            [](const std::string& name, int family, std::vector<sockaddr_storage>* out) {
+                if (fpGetAddrInfo) return Network::DnsCache::ResolveWith(fpGetAddrInfo, name, family, out);
+                return Network::DnsCache::SystemResolve(name, family, out);
+            });
+    });
+    return Network::DnsCache::Instance();
+}
+
+// 代理端点：主机名只在首次使用时同步解析，之后后台刷新；连接在多个地址间轮换，失败的地址进入冷却
+static Network::ProxyEndpoint& GetProxyEndpoint(const Core::ProxyConfig& proxy) {
+    static std::once_flag s_once;
+    std::call_once(s_once, []() {
+        Network::ProxyEndpoint::Instance().Configure(std::string(), 0, 0,
+            [](const std::string& name, int family, std::vector<sockaddr_storage>* out) {
+                if (fpGetAddrInfo) return Network::DnsCache::ResolveWith(fpGetAddrInfo, name, family, out);
+                return Network::DnsCache::SystemResolve(name, family, out);
+            });
+    });
+    auto& endpoint = Network::ProxyEndpoint::Instance();
+    endpoint.Ensure(proxy.host, (uint16_t)proxy.port, (uint32_t)Core::Config::Instance().dnsCache.ttl_ms);
+    return endpoint;
+}
+
+static void ReportProxyConnectResult(const Core::ProxyConfig& proxy, const sockaddr* proxyAddr, bool ok) {
+    auto& endpoint = GetProxyEndpoint(proxy);
+    if (ok) endpoint.ReportSuccess(proxyAddr);
+    else endpoint.ReportFailure(proxyAddr);
+}
+
 static bool BuildProxyAddr(const Core::ProxyConfig& proxy, sockaddr_in* proxyAddr, const sockaddr_in* baseAddr) {
     if (!proxyAddr) return false;
     if (baseAddr) {
@@ -992,23 +1104,15 @@ static bool BuildProxyAddr(const Core::ProxyConfig& proxy, sockaddr_in* proxyAdd
         memset(proxyAddr, 0, sizeof(sockaddr_in));
         proxyAddr->sin_family = AF_INET;
     }
-    if (inet_pton(AF_INET, proxy.host.c_str(), &proxyAddr->sin_addr) != 1) {
-        // 尝试使用 DNS 解析代理主机名（仅 IPv4）
-        addrinfo hints{};
-        hints.ai_family = AF_INET;
-        hints.ai_socktype = SOCK_STREAM;
-        hints.ai_protocol = IPPROTO_TCP;
-        addrinfo* res = nullptr;
-        int rc = fpGetAddrInfo ? fpGetAddrInfo(proxy.host.c_str(), nullptr, &hints, &res)
-                               : getaddrinfo(proxy.host.c_str(), nullptr, &hints, &res);
-        if (rc != 0 || !res) {
-            Core::Logger::Error("代理地址解析失败: " + proxy.host + ", 错误码=" + std::to_string(rc));
-            return false;
-        }
-        auto* addr = (sockaddr_in*)res->ai_addr;
-        proxyAddr->sin_addr = addr->sin_addr;
-        freeaddrinfo(res);
+    // IP 字面量直接使用；主机名取缓存的解析结果（仅 IPv4）
+    sockaddr_storage picked{};
+    int pickedLen = 0;
+    int rc = 0;
+    if (!GetProxyEndpoint(proxy).Pick(AF_INET, &picked, &pickedLen, &rc)) {
+        Core::Logger::Error("代理地址解析失败: " + proxy.host + ", 错误码=" + std::to_string(rc));
+        return false;
     }
+    proxyAddr->sin_addr = ((sockaddr_in*)&picked)->sin_addr;
     proxyAddr->sin_port = htons(proxy.port);
     return true;
 }
@@ -1021,53 +1125,16 @@ static bool BuildProxyAddrV6(const Core::ProxyConfig& proxy, sockaddr_in6* proxy
         memset(proxyAddr, 0, sizeof(sockaddr_in6));
     }
     proxyAddr->sin6_family = AF_INET6;
-    
-    in6_addr addr6{};
-    if (inet_pton(AF_INET6, proxy.host.c_str(), &addr6) == 1) {
-        proxyAddr->sin6_addr = addr6;
-    } else {
-        in_addr addr4{};
-        if (inet_pton(AF_INET, proxy.host.c_str(), &addr4) == 1) {
-            // IPv4 代理地址映射为 IPv6，兼容双栈 socket
-            unsigned char* bytes = reinterpret_cast<unsigned char*>(&proxyAddr->sin6_addr);
-            memset(bytes, 0, 16);
-            bytes[10] = 0xff;
-            bytes[11] = 0xff;
-            memcpy(bytes + 12, &addr4, sizeof(addr4));
-        } else {
-            // 优先解析 IPv6，失败则回退 IPv4 并映射
-            addrinfo hints{};
-            hints.ai_family = AF_INET6;
-            hints.ai_socktype = SOCK_STREAM;
-            hints.ai_protocol = IPPROTO_TCP;
-            addrinfo* res = nullptr;
-            int rc = fpGetAddrInfo ? fpGetAddrInfo(proxy.host.c_str(), nullptr, &hints, &res)
-                                   : getaddrinfo(proxy.host.c_str(), nullptr, &hints, &res);
-            if (rc == 0 && res) {
-                proxyAddr->sin6_addr = ((sockaddr_in6*)res->ai_addr)->sin6_addr;
-                freeaddrinfo(res);
-            } else {
-                if (res) freeaddrinfo(res);
-                addrinfo hints4{};
-                hints4.ai_family = AF_INET;
-                hints4.ai_socktype = SOCK_STREAM;
-                hints4.ai_protocol = IPPROTO_TCP;
-                rc = fpGetAddrInfo ? fpGetAddrInfo(proxy.host.c_str(), nullptr, &hints4, &res)
-                                   : getaddrinfo(proxy.host.c_str(), nullptr, &hints4, &res);
-                if (rc != 0 || !res) {
-                    Core::Logger::Error("代理地址解析失败: " + proxy.host + ", 错误码=" + std::to_string(rc));
-                    return false;
-                }
-                in_addr resolved4 = ((sockaddr_in*)res->ai_addr)->sin_addr;
-                freeaddrinfo(res);
-                unsigned char* bytes = reinterpret_cast<unsigned char*>(&proxyAddr->sin6_addr);
-                memset(bytes, 0, 16);
-                bytes[10] = 0xff;
-                bytes[11] = 0xff;
-                memcpy(bytes + 12, &resolved4, sizeof(resolved4));
-            }
-        }
+
+    // IPv6 字面量直接使用；IPv4 字面量映射为 v4-mapped；主机名优先 AAAA，其次 A 映射（兼容双栈 socket）
+    sockaddr_storage picked{};
+    int pickedLen = 0;
+    int rc = 0;
+    if (!GetProxyEndpoint(proxy).Pick(AF_INET6, &picked, &pickedLen, &rc)) {
+        Core::Logger::Error("代理地址解析失败: " + proxy.host + ", 错误码=" + std::to_string(rc));
+        return false;
     }
+    proxyAddr->sin6_addr = ((sockaddr_in6*)&picked)->sin6_addr;
     proxyAddr->sin6_port = htons(proxy.port);
     return true;
 }
@@ -1097,22 +1164,38 @@ static size_t CopyBytesToWsabufs(const uint8_t* src, size_t srcLen, WSABUF* dstB
     return copied;
 }
 
-static bool SendUdpPacketWithRetry(SOCKET s, const uint8_t* data, int len, int flags, int timeoutMs) {
-    if (!data || len <= 0) return true;
-    if (!fpSend) {
+// 以 [SOCKS5 UDP 头, 用户 payload] 两段 WSABUF 聚集发送一次：payload 不再拷贝进临时 vector
+// 设计意图：与 overlapped 路径（UdpOverlappedSendCtx）一致，头只有几十字节，由调用方放在栈上。
+static bool SendUdpGather(SOCKET s, const uint8_t* header, size_t headerLen,
+                          const char* payload, int payloadLen, int flags) {
+    if (!header || headerLen == 0 || payloadLen < 0) {
         WSASetLastError(WSAEINVAL);
         return false;
     }
+    WSABUF bufs[2];
+    bufs[0].buf = (CHAR*)header;
+    bufs[0].len = (ULONG)headerLen;
+    bufs[1].buf = (CHAR*)payload;
+    bufs[1].len = (ULONG)payloadLen;
+    const DWORD count = (payload && payloadLen > 0) ? 2 : 1;
+    const DWORD total = (DWORD)headerLen + (count == 2 ? (DWORD)payloadLen : 0);
+    DWORD sent = 0;
+    int rc = fpWSASend ? fpWSASend(s, bufs, count, &sent, (DWORD)flags, NULL, NULL)
+                       : WSASend(s, bufs, count, &sent, (DWORD)flags, NULL, NULL);
+    if (rc != 0) return false;
+    if (sent != total) {
+        // UDP 理论上不应 partial send；这里按失败处理，避免上层误判
+        WSASetLastError(WSAEMSGSIZE);
+        return false;
+    }
+    return true;
+}
+
+// 同上，遇到 WSAEWOULDBLOCK 时等待可写后重试（用于用户以为“已经发出”的路径，如 send/ConnectEx 首包）
+static bool SendUdpGatherWithRetry(SOCKET s, const uint8_t* header, size_t headerLen,
+                                   const char* payload, int payloadLen, int flags, int timeoutMs) {
     for (;;) {
-        int sent = fpSend(s, (const char*)data, len, flags);
-        if (sent == len) {
-            return true;
-        }
-        if (sent > 0) {
-            // UDP 理论上不应 partial send；这里按失败处理，避免上层误判
-            WSASetLastError(WSAEMSGSIZE);
-            return false;
-        }
+        if (SendUdpGather(s, header, headerLen, payload, payloadLen, flags)) return true;
         int err = WSAGetLastError();
         if (err == WSAEWOULDBLOCK || err == WSAEINPROGRESS) {
             if (!Network::SocketIo::WaitWritable(s, timeoutMs)) return false;
@@ -1144,6 +1227,88 @@ static bool FillUserSockaddr(sockaddr* userFrom, LPINT userFromLen, const sockad
     return true;
 }
 
+// 同步接收一个 SOCKS5 UDP 数据报并把 payload 解封装进用户 WSABUF（recv/recvfrom/WSARecv/WSARecvFrom 共用）
+// - 单段且 >= kTailBytes：按 [用户缓冲, 栈上 tail] 分散接收后原地解封装，无临时缓冲、无整包二次拷贝
+// - 其他情况：收进线程局部缓冲再拷贝
+// 成功返回 0，*outBytes 为 payload 字节数；payload 放不下时拷贝能放下的部分并以 WSAEMSGSIZE 失败；
+// 头部非法时以 WSAECONNRESET 失败。src 非空时回填来源地址（域名来源 *srcLen=0）。
+static int RecvUdpProxyPayload(SOCKET s, LPWSABUF userBufs, DWORD userCount, LPDWORD flags,
+                               sockaddr_storage* src, int* srcLen, size_t* outBytes) {
+    *outBytes = 0;
+    if (srcLen) *srcLen = 0;
+    const size_t userCap = SumWsabufBytes(userBufs, userCount);
+    const bool inPlace = userBufs && userCount == 1 && userBufs[0].buf && userCap >= Network::UdpRecv::kTailBytes;
+
+    uint8_t tail[Network::UdpRecv::kTailBytes];
+    WSABUF ib[2];
+    DWORD ibCount = 1;
+    uint8_t* scratch = nullptr;
+    if (inPlace) {
+        ib[0] = userBufs[0];
+        ib[1].buf = (CHAR*)tail;
+        ib[1].len = (ULONG)sizeof(tail);
+        ibCount = 2;
+    } else {
+        scratch = Network::UdpRecv::ThreadScratch(userCap + Network::UdpRecv::kTailBytes);
+        ib[0].buf = (CHAR*)scratch;
+        ib[0].len = (ULONG)(userCap + Network::UdpRecv::kTailBytes);
+    }
+
+    DWORD bytes = 0;
+    int rc = fpWSARecv ? fpWSARecv(s, ib, ibCount, &bytes, flags, NULL, NULL)
+                       : WSARecv(s, ib, ibCount, &bytes, flags, NULL, NULL);
+    if (rc != 0) return rc;
+    if (bytes == 0) return 0; // 空数据报：与直接 recv 一致返回 0 字节
+
+    bool truncated = false;
+    if (inPlace) {
+        Network::UdpRecv::Source from;
+        const auto st = Network::UdpRecv::UnwrapInPlace((uint8_t*)userBufs[0].buf, userBufs[0].len, tail, bytes, &from, outBytes);
+        if (st == Network::UdpRecv::UnwrapStatus::Invalid) {
+            WSASetLastError(WSAECONNRESET);
+            return SOCKET_ERROR;
+        }
+        truncated = st == Network::UdpRecv::UnwrapStatus::Truncated;
+        if (src && srcLen) {
+            Network::Socks5Udp::AddressToSockaddr(from.atyp, from.addr, from.addrLen, from.port, src, srcLen);
+        }
+    } else {
+        Network::Socks5Udp::UnwrapResult unwrap{};
+        if (!Network::Socks5Udp::Unwrap(scratch, (size_t)bytes, &unwrap)) {
+            WSASetLastError(WSAECONNRESET);
+            return SOCKET_ERROR;
+        }
+        *outBytes = CopyBytesToWsabufs(unwrap.payload, unwrap.payloadLen, userBufs, userCount);
+        truncated = *outBytes < unwrap.payloadLen;
+        if (src && srcLen) {
+            *src = unwrap.src;
+            *srcLen = unwrap.srcLen;
+        }
+    }
+    if (truncated) {
+        WSASetLastError(WSAEMSGSIZE);
+        return SOCKET_ERROR;
+    }
+    return 0;
+}
+
+// overlapped 接收的缓冲描述：可原地时为 [用户缓冲, ctx->tail]，否则为池中取出的 ctx->recvBuf。
+// WSABUF 数组本身只需在投递调用期间有效，被描述的内存（用户缓冲/ctx）需活到完成
+static DWORD PrepareUdpOverlappedRecvBufs(UdpOverlappedRecvCtx* ctx, WSABUF ib[2]) {
+    const size_t userCap = SumWsabufBytes(ctx->userBufs, ctx->userBufCount);
+    ctx->inPlace = ctx->userBufs && ctx->userBufCount == 1 && ctx->userBufs[0].buf && userCap >= Network::UdpRecv::kTailBytes;
+    if (ctx->inPlace) {
+        ib[0] = ctx->userBufs[0];
+        ib[1].buf = (CHAR*)ctx->tail;
+        ib[1].len = (ULONG)sizeof(ctx->tail);
+        return 2;
+    }
+    ctx->recvBuf = Network::UdpRecv::RecvBufferPool::Instance().Acquire(userCap + Network::UdpRecv::kTailBytes);
+    ib[0].buf = (CHAR*)ctx->recvBuf.data();
+    ib[0].len = (ULONG)ctx->recvBuf.size();
+    return 1;
+}
+
 static bool BuildUdpRelayAddrForSocketFamily(int socketFamily, const sockaddr_storage& relay, int relayLen,
                                              sockaddr_storage* out, int* outLen) {
     if (!out || !outLen || relayLen <= 0) return false;
@@ -1186,110 +1351,237 @@ static bool BuildUdpRelayAddrForSocketFamily(int socketFamily, const sockaddr_st
     return false;
 }
 
-static SOCKET ConnectTcpToProxyServer(const Core::ProxyConfig& proxy) {
+static SOCKET DialTcpToProxyServer(const Core::ProxyConfig& proxy) {
     // 说明：UDP Associate 需要一个到代理的 TCP 控制连接
-    // 这里使用最小实现：仅支持 IP 直连或常规 DNS 解析（建议 proxy.host 填 127.0.0.1/::1）
+    // 这里使用最小实现：IP 直连，或使用 ProxyEndpoint 缓存的主机名解析结果（建议 proxy.host 填 127.0.0.1/::1）
     int family = AF_INET;
     in6_addr tmp6{};
     if (!proxy.host.empty() && inet_pton(AF_INET6, proxy.host.c_str(), &tmp6) == 1) {
         family = AF_INET6;
     }
 
-    SOCKET tcpSock = socket(family, SOCK_STREAM, IPPROTO_TCP);
-    if (tcpSock == INVALID_SOCKET) {
-        int err = WSAGetLastError();
-        Core::Logger::Error("SOCKS5 UDP: 创建 TCP 控制连接失败, WSA错误码=" + std::to_string(err));
-        return INVALID_SOCKET;
-    }
-
-    // 非阻塞 connect + WaitConnect，避免卡死目标进程
-    u_long nb = 1;
-    ioctlsocket(tcpSock, FIONBIO, &nb);
-
-    sockaddr_storage proxyAddrSs{};
-    int proxyAddrLen = 0;
-    if (family == AF_INET6) {
-        sockaddr_in6 proxyAddr6{};
-        if (!BuildProxyAddrV6(proxy, &proxyAddr6, nullptr)) {
-            if (fpCloseSocket) fpCloseSocket(tcpSock);
-            return INVALID_SOCKET;
+    // 主机名解析出多个地址时逐个尝试：失败的地址进入冷却，下一次 BuildProxyAddr 会轮换到其他地址
+    auto& config = Core::Config::Instance();
+    const size_t attempts = std::max<size_t>(1, std::min<size_t>(GetProxyEndpoint(proxy).AddressCount(), 3));
+    SOCKET tcpSock = INVALID_SOCKET;
+    for (size_t attempt = 0; attempt < attempts; attempt++) {
+        sockaddr_storage proxyAddrSs{};
+        int proxyAddrLen = 0;
+        if (family == AF_INET6) {
+            sockaddr_in6 proxyAddr6{};
+            if (!BuildProxyAddrV6(proxy, &proxyAddr6, nullptr)) return INVALID_SOCKET;
+            memcpy(&proxyAddrSs, &proxyAddr6, sizeof(proxyAddr6));
+            proxyAddrLen = (int)sizeof(proxyAddr6);
+        } else {
+            sockaddr_in proxyAddr{};
+            if (!BuildProxyAddr(proxy, &proxyAddr, nullptr)) return INVALID_SOCKET;
+            memcpy(&proxyAddrSs, &proxyAddr, sizeof(proxyAddr));
+            proxyAddrLen = (int)sizeof(proxyAddr);
         }
-        memcpy(&proxyAddrSs, &proxyAddr6, sizeof(proxyAddr6));
-        proxyAddrLen = (int)sizeof(proxyAddr6);
-    } else {
-        sockaddr_in proxyAddr{};
-        if (!BuildProxyAddr(proxy, &proxyAddr, nullptr)) {
-            if (fpCloseSocket) fpCloseSocket(tcpSock);
+
+        tcpSock = socket(family, SOCK_STREAM, IPPROTO_TCP);
+        if (tcpSock == INVALID_SOCKET) {
+            int err = WSAGetLastError();
+            Core::Logger::Error("SOCKS5 UDP: 创建 TCP 控制连接失败, WSA错误码=" + std::to_string(err));
             return INVALID_SOCKET;
         }
-        memcpy(&proxyAddrSs, &proxyAddr, sizeof(proxyAddr));
-        proxyAddrLen = (int)sizeof(proxyAddr);
-    }
 
-    int rc = fpConnect ? fpConnect(tcpSock, (sockaddr*)&proxyAddrSs, proxyAddrLen)
-                       : connect(tcpSock, (sockaddr*)&proxyAddrSs, proxyAddrLen);
-    if (rc != 0) {
-        int err = WSAGetLastError();
-        if (err == WSAEWOULDBLOCK || err == WSAEINPROGRESS) {
-            auto& config = Core::Config::Instance();
-            if (!Network::SocketIo::WaitConnect(tcpSock, config.timeout.connect_ms)) {
-                int werr = WSAGetLastError();
-                Core::Logger::Error("SOCKS5 UDP: 连接代理服务器失败, proxy=" + proxy.host + ":" + std::to_string(proxy.port) +
-                                    ", WSA错误码=" + std::to_string(werr));
-                if (fpCloseSocket) fpCloseSocket(tcpSock);
-                return INVALID_SOCKET;
+        // 非阻塞 connect + WaitConnect，避免卡死目标进程
+        u_long nb = 1;
+        ioctlsocket(tcpSock, FIONBIO, &nb);
+
+        int rc = fpConnect ? fpConnect(tcpSock, (sockaddr*)&proxyAddrSs, proxyAddrLen)
+                           : connect(tcpSock, (sockaddr*)&proxyAddrSs, proxyAddrLen);
+        int err = 0;
+        if (rc != 0) {
+            err = WSAGetLastError();
+            if (err == WSAEWOULDBLOCK || err == WSAEINPROGRESS) {
+                err = Network::SocketIo::WaitConnect(tcpSock, config.timeout.connect_ms) ? 0 : WSAGetLastError();
             }
-        } else {
-            Core::Logger::Error("SOCKS5 UDP: 连接代理服务器失败, proxy=" + proxy.host + ":" + std::to_string(proxy.port) +
-                                ", WSA错误码=" + std::to_string(err));
-            if (fpCloseSocket) fpCloseSocket(tcpSock);
-            return INVALID_SOCKET;
         }
+        if (err == 0) {
+            ReportProxyConnectResult(proxy, (sockaddr*)&proxyAddrSs, true);
+            break;
+        }
+        Core::Logger::Error("SOCKS5 UDP: 连接代理服务器失败, proxy=" + proxy.host + ":" + std::to_string(proxy.port) +
+                            ", WSA错误码=" + std::to_string(err) +
+                            ", 尝试=" + std::to_string(attempt + 1) + "/" + std::to_string(attempts));
+        ReportProxyConnectResult(proxy, (sockaddr*)&proxyAddrSs, false);
+        if (fpCloseSocket) fpCloseSocket(tcpSock);
+        tcpSock = INVALID_SOCKET;
     }
+    if (tcpSock == INVALID_SOCKET) return INVALID_SOCKET;
 
     // 连接完成后切回阻塞：后续握手使用 SocketIo::SendAll/RecvExact（内部兼容 EWOULDBLOCK）
-    nb = 0;
+    u_long nb = 0;
     ioctlsocket(tcpSock, FIONBIO, &nb);
     return tcpSock;
 }
 
+// 预连接池：首次取用时创建并启动后台补充（不在 DllMain 中建线程）；有意泄漏，补充线程不在卸载阶段 join
+static std::atomic<Network::WarmPool<SOCKET>*> g_warmPool{nullptr};
+static std::once_flag g_warmPoolOnce;
+
+static Network::WarmPool<SOCKET>& GetWarmPool() {
+    std::call_once(g_warmPoolOnce, []() {
+        auto* pool = new Network::WarmPool<SOCKET>(
+            [](SOCKET* out) {
+                auto& config = Core::Config::Instance();
+                SOCKET s = DialTcpToProxyServer(config.proxy);
+                if (s == INVALID_SOCKET) return false;
+                if (!Network::Socks5Udp::NegotiateNoAuth(s, config.timeout.send_ms, config.timeout.recv_ms)) {
+                    CloseSocketCompat(s);
+                    return false;
+                }
+                *out = s;
+                return true;
+            },
+            [](SOCKET s) { CloseSocketCompat(s); },
+            [](SOCKET s) { return Network::SocketIo::IsIdleConnectionAlive(s); });
+        const auto& config = Core::Config::Instance();
+        Network::WarmPool<SOCKET>::Options options;
+        options.maxIdle = (config.warmPool.enabled && config.proxy.type == "socks5") ? (size_t)config.warmPool.max_idle : 0;
+        options.ttlMs = (uint32_t)config.warmPool.ttl_ms;
+        pool->Configure(options);
+        pool->StartRefiller();
+        g_warmPool.store(pool, std::memory_order_release);
+    });
+    return *g_warmPool.load(std::memory_order_acquire);
+}
+
+// ============= UDP Associate 预建池 =============
+// 设计意图：预连接池只省掉 TCP 建连与认证协商，首包仍要等一次 UDP ASSOCIATE 往返。这里把整条关联
+// （控制连接 + relay 地址）提前建好，EnsureUdpProxyReady 取用后直接 connect relay 发首包。
+// - 请求中的 DST 与按需建立时一样为 0.0.0.0:0，relay 不绑定具体客户端端口，任意 UDP socket 都可接管
+//   （应用的 UDP socket 由应用创建，无法替换成预先绑定的 socket，因此只预建控制连接与 relay 地址）
+// - 关联随控制连接存亡（RFC 1928）：取用前检查控制连接存活，存活超过 warm_pool.ttl 的直接关闭
+// - 应用一般先经 TCP 拿到 Alt-Svc 再发起 QUIC，因此在首个代理 TCP 连接时就开始预建
+// 与预连接池一样首次使用时创建、有意泄漏，补充线程不在卸载阶段 join。
+using UdpAssociation = Network::Socks5Udp::UdpAssociateResult;
+static std::atomic<Network::WarmPool<UdpAssociation>*> g_udpAssocPool{nullptr};
+static std::once_flag g_udpAssocPoolOnce;
+
+static bool UdpAssociationPoolEnabled() {
+    const auto& config = Core::Config::Instance();
+    return config.warmPool.enabled && config.warmPool.udp_associations > 0 && config.proxy.port != 0 &&
+           config.proxy.type == "socks5" && config.rules.udp_mode == "proxy";
+}
+
+static Network::WarmPool<UdpAssociation>& GetUdpAssociationPool() {
+    std::call_once(g_udpAssocPoolOnce, []() {
+        auto* pool = new Network::WarmPool<UdpAssociation>(
+            [](UdpAssociation* out) {
+                auto& config = Core::Config::Instance();
+                SOCKET tcp = DialTcpToProxyServer(config.proxy);
+                if (tcp == INVALID_SOCKET) return false;
+                if (!Network::Socks5Udp::UdpAssociate(tcp, nullptr, 0, out, false)) {
+                    CloseSocketCompat(tcp);
+                    return false;
+                }
+                return true;
+            },
+            [](UdpAssociation a) { CloseSocketCompat(a.controlSock); },
+            [](UdpAssociation a) { return Network::SocketIo::IsIdleConnectionAlive(a.controlSock); });
+        const auto& config = Core::Config::Instance();
+        Network::WarmPool<UdpAssociation>::Options options;
+        options.maxIdle = UdpAssociationPoolEnabled() ? (size_t)config.warmPool.udp_associations : 0;
+        options.ttlMs = (uint32_t)config.warmPool.ttl_ms;
+        pool->Configure(options);
+        pool->StartRefiller();
+        g_udpAssocPool.store(pool, std::memory_order_release);
+    });
+    return *g_udpAssocPool.load(std::memory_order_acquire);
+}
+
+static bool AcquireWarmUdpAssociation(UdpAssociation* out) {
+    if (!UdpAssociationPoolEnabled() || !GetUdpAssociationPool().Acquire(out)) return false;
+    if (Core::Logger::IsEnabled(Core::LogLevel::Debug)) {
+        Core::Logger::Debug("SOCKS5 UDP: 使用预建的 UDP Associate, control=" +
+                            std::to_string((unsigned long long)out->controlSock) +
+                            ", relay=" + SockaddrToString((const sockaddr*)&out->relayAddr));
+    }
+    return true;
+}
+
+// socks5Negotiated 非空时允许取用预连接池中已完成认证协商的连接（*socks5Negotiated 置 true），
+// 池空或未启用时按原路径同步建连
+static SOCKET ConnectTcpToProxyServer(const Core::ProxyConfig& proxy, bool* socks5Negotiated) {
+    if (socks5Negotiated) {
+        *socks5Negotiated = false;
+        SOCKET pooled = INVALID_SOCKET;
+        if (Core::Config::Instance().warmPool.enabled && proxy.type == "socks5" && GetWarmPool().Acquire(&pooled)) {
+            *socks5Negotiated = true;
+            if (Core::Logger::IsEnabled(Core::LogLevel::Debug)) {
+                Core::Logger::Debug("SOCKS5 UDP: 使用预连接池中的控制连接, sock=" + std::to_string((unsigned long long)pooled));
+            }
+            return pooled;
+        }
+    }
+    return DialTcpToProxyServer(proxy);
+}
+
 static void DropUdpOverlappedContext(LPWSAOVERLAPPED ovl) {
     if (!ovl) return;
-    std::lock_guard<std::mutex> lock(g_udpOvlMtx);
-    g_udpOvlSend.erase(ovl);
-    g_udpOvlRecv.erase(ovl);
+    g_pendingOverlapped.Update(ovl, [](PendingOverlapped& p) {
+        p.udpSend.reset();
+        p.udpRecv.reset();
+        return !p.Empty();
+    });
+}
+
+// 登记 UDP overlapped 上下文（投递前调用，完成端按 OVERLAPPED 取回）
+static void SaveUdpOverlappedSend(LPWSAOVERLAPPED ovl, std::shared_ptr<UdpOverlappedSendCtx> ctx) {
+    g_pendingOverlapped.Upsert(ovl, [&](PendingOverlapped& p) { p.udpSend = std::move(ctx); });
+}
+
+static void SaveUdpOverlappedRecv(LPWSAOVERLAPPED ovl, std::shared_ptr<UdpOverlappedRecvCtx> ctx) {
+    g_pendingOverlapped.Upsert(ovl, [&](PendingOverlapped& p) { p.udpRecv = std::move(ctx); });
 }
 
 static void CleanupUdpOverlappedBySocket(SOCKET s) {
-    std::lock_guard<std::mutex> lock(g_udpOvlMtx);
-    for (auto it = g_udpOvlSend.begin(); it != g_udpOvlSend.end(); ) {
-        if (it->second && it->second->sock == s) it = g_udpOvlSend.erase(it);
-        else ++it;
-    }
-    for (auto it = g_udpOvlRecv.begin(); it != g_udpOvlRecv.end(); ) {
-        if (it->second && it->second->sock == s) it = g_udpOvlRecv.erase(it);
-        else ++it;
-    }
+    // 低频（仅关闭/回退时）：逐分片扫描
+    g_pendingOverlapped.EraseIf([s](LPOVERLAPPED, PendingOverlapped& p) {
+        if (p.udpSend && p.udpSend->sock == s) p.udpSend.reset();
+        if (p.udpRecv && p.udpRecv->sock == s) p.udpRecv.reset();
+        return p.Empty();
+    });
 }
 
+static void CloseUdpControlSocket(SOCKET control) {
+    if (control == INVALID_SOCKET) return;
+    // 关闭控制连接：使用原始 closesocket，避免递归进入 DetourCloseSocket
+    if (fpCloseSocket) fpCloseSocket(control);
+    else closesocket(control);
+}
+
+// 释放 socket 的 UDP 上下文（保留目标与类型缓存），关闭控制连接并清理其 overlapped 上下文
 static void CleanupUdpProxyContext(SOCKET s) {
     SOCKET control = INVALID_SOCKET;
-    {
-        std::lock_guard<std::mutex> lock(g_udpProxyMtx);
-        auto it = g_udpProxy.find(s);
-        if (it != g_udpProxy.end()) {
-            control = it->second.controlSock;
-            g_udpProxy.erase(it);
+    g_sockets.Update(s, [&](SocketState& st) {
+        if (st.udp) {
+            control = st.udp->controlSock;
+            st.udp.reset();
         }
-    }
-    if (control != INVALID_SOCKET) {
-        // 关闭控制连接：使用原始 closesocket，避免递归进入 DetourCloseSocket
-        if (fpCloseSocket) fpCloseSocket(control);
-        else closesocket(control);
-    }
+        return !st.Empty();
+    });
+    if (control == INVALID_SOCKET) return;
+    CloseUdpControlSocket(control);
     CleanupUdpOverlappedBySocket(s);
 }
 
+// 需持有 socket 所在分片的锁（或 ctx 尚未发布）。目标未变化时不重复赋值/编码，sendto 每包都会走到这里
+static bool SetUdpDefaultTargetLocked(UdpProxyContext* ctx, const std::string& host, uint16_t port) {
+    if (host.empty() || port == 0) return false;
+    if (ctx->hasDefaultTarget && ctx->defaultTargetPort == port && ctx->defaultTargetHost == host) return true;
+    const size_t n = Network::Socks5::EncodeUdpHeader(host, port, ctx->defaultHeader, sizeof(ctx->defaultHeader));
+    if (n == 0) return false; // 无法编码（如域名超长）：保留旧目标，由调用方按封装失败处理
+    ctx->defaultHeaderLen = n;
+    ctx->defaultTargetHost = host;
+    ctx->defaultTargetPort = port;
+    ctx->hasDefaultTarget = true;
+    return true;
+}
+
 static bool EnsureUdpProxyReady(
     SOCKET udpSock,
     int socketFamily,
@@ -1319,69 +1611,51 @@ static bool EnsureUdpProxyReady(
     }
 
     // 1) 确保存在 UDP Associate 控制连接 + relay 地址
-    // 性能优化：阻塞 I/O（connect/UdpAssociate）放到锁外执行，降低 g_udpProxyMtx 竞争
-    bool needCreateContext = false;
-    {
-        std::lock_guard<std::mutex> lock(g_udpProxyMtx);
-        auto it = g_udpProxy.find(udpSock);
-        if (it == g_udpProxy.end()) {
-            needCreateContext = true;
-        } else if (!defaultTargetHost.empty() && defaultTargetPort != 0) {
-            it->second.defaultTargetHost = defaultTargetHost;
-            it->second.defaultTargetPort = defaultTargetPort;
-            it->second.hasDefaultTarget = true;
-        }
-    }
+    // 性能优化：阻塞 I/O（connect/UdpAssociate）放到锁外执行，分片锁内只做字段读写
+    const bool needCreateContext = !WithUdpProxyContext(udpSock, [&](UdpProxyContext& ctx) {
+        SetUdpDefaultTargetLocked(&ctx, defaultTargetHost, defaultTargetPort);
+    });
 
     if (needCreateContext) {
-        UdpProxyContext created{};
-        created.udpSock = udpSock;
-        created.createdTick = GetTickCount64();
-
-        SOCKET tcp = ConnectTcpToProxyServer(config.proxy);
-        if (tcp == INVALID_SOCKET) {
-            WSASetLastError(WSAECONNREFUSED);
-            return false;
-        }
+        auto created = std::make_unique<UdpProxyContext>();
+        created->udpSock = udpSock;
+        created->createdTick = GetTickCount64();
 
         Network::Socks5Udp::UdpAssociateResult assoc{};
-        if (!Network::Socks5Udp::UdpAssociate(tcp, nullptr, 0, &assoc)) {
-            if (fpCloseSocket) fpCloseSocket(tcp);
-            else closesocket(tcp);
-            WSASetLastError(WSAECONNREFUSED);
-            return false;
-        }
+        if (!AcquireWarmUdpAssociation(&assoc)) {
+            bool negotiated = false;
+            SOCKET tcp = ConnectTcpToProxyServer(config.proxy, &negotiated);
+            if (tcp == INVALID_SOCKET) {
+                WSASetLastError(WSAECONNREFUSED);
+                return false;
+            }
 
-        created.controlSock = tcp;
-        created.relayAddr = assoc.relayAddr;
-        created.relayAddrLen = assoc.relayAddrLen;
-        created.relayConnected = false;
-        if (!defaultTargetHost.empty() && defaultTargetPort != 0) {
-            created.defaultTargetHost = defaultTargetHost;
-            created.defaultTargetPort = defaultTargetPort;
-            created.hasDefaultTarget = true;
+            if (!Network::Socks5Udp::UdpAssociate(tcp, nullptr, 0, &assoc, negotiated)) {
+                if (fpCloseSocket) fpCloseSocket(tcp);
+                else closesocket(tcp);
+                WSASetLastError(WSAECONNREFUSED);
+                return false;
+            }
         }
 
+        created->controlSock = assoc.controlSock;
+        created->relayAddr = assoc.relayAddr;
+        created->relayAddrLen = assoc.relayAddrLen;
+        created->relayConnected = false;
+        SetUdpDefaultTargetLocked(created.get(), defaultTargetHost, defaultTargetPort);
+
         SOCKET orphanControl = INVALID_SOCKET;
-        {
-            std::lock_guard<std::mutex> lock(g_udpProxyMtx);
-            auto it = g_udpProxy.find(udpSock);
-            if (it == g_udpProxy.end()) {
-                g_udpProxy[udpSock] = std::move(created);
+        g_sockets.Upsert(udpSock, [&](SocketState& st) {
+            st.soType = SOCK_DGRAM;
+            if (!st.udp) {
+                st.udp = std::move(created);
             } else {
                 // 并发场景下若已被其他线程初始化，复用已有上下文并关闭当前临时控制连接
-                orphanControl = created.controlSock;
-                if (!defaultTargetHost.empty() && defaultTargetPort != 0) {
-                    it->second.defaultTargetHost = defaultTargetHost;
-                    it->second.defaultTargetPort = defaultTargetPort;
-                    it->second.hasDefaultTarget = true;
-                }
+                orphanControl = created->controlSock;
+                SetUdpDefaultTargetLocked(st.udp.get(), defaultTargetHost, defaultTargetPort);
             }
-        }
-        if (orphanControl != INVALID_SOCKET) {
-            if (fpCloseSocket) fpCloseSocket(orphanControl);
-            else closesocket(orphanControl);
-        }
+        });
+        CloseUdpControlSocket(orphanControl);
     }
 
     // 2) 确保 UDP socket 已 connect 到 relay（让 select/IOCP/readiness 与原 socket 绑定，满足 QUIC 等高性能实现）
@@ -1389,25 +1663,28 @@ static bool EnsureUdpProxyReady(
     if (!connectRelay) {
         return true;
     }
+    sockaddr_storage relayAddr{};
+    int relayAddrLen = 0;
+    bool alreadyConnected = false;
+    if (!WithUdpProxyContext(udpSock, [&](UdpProxyContext& ctx) {
+            alreadyConnected = ctx.relayConnected;
+            relayAddr = ctx.relayAddr;
+            relayAddrLen = ctx.relayAddrLen;
+        })) {
+        WSASetLastError(WSAECONNREFUSED);
+        return false;
+    }
+    if (alreadyConnected) {
+        return true;
+    }
     sockaddr_storage relayForSock{};
     int relayForSockLen = 0;
-    {
-        std::lock_guard<std::mutex> lock(g_udpProxyMtx);
-        auto it = g_udpProxy.find(udpSock);
-        if (it == g_udpProxy.end()) {
-            WSASetLastError(WSAECONNREFUSED);
-            return false;
-        }
-        if (it->second.relayConnected) {
-            return true;
-        }
-        if (!BuildUdpRelayAddrForSocketFamily(socketFamily, it->second.relayAddr, it->second.relayAddrLen, &relayForSock, &relayForSockLen)) {
-            Core::Logger::Error("UDP 代理: relay 地址族不兼容, sock=" + std::to_string((unsigned long long)udpSock) +
-                                ", socketFamily=" + std::to_string(socketFamily) +
-                                ", relayFamily=" + std::to_string((int)it->second.relayAddr.ss_family));
-            WSASetLastError(WSAEAFNOSUPPORT);
-            return false;
-        }
+    if (!BuildUdpRelayAddrForSocketFamily(socketFamily, relayAddr, relayAddrLen, &relayForSock, &relayForSockLen)) {
+        Core::Logger::Error("UDP 代理: relay 地址族不兼容, sock=" + std::to_string((unsigned long long)udpSock) +
+                            ", socketFamily=" + std::to_string(socketFamily) +
+                            ", relayFamily=" + std::to_string((int)relayAddr.ss_family));
+        WSASetLastError(WSAEAFNOSUPPORT);
+        return false;
     }
 
     int rc = fpConnect ? fpConnect(udpSock, (sockaddr*)&relayForSock, relayForSockLen)
@@ -1424,15 +1701,12 @@ static bool EnsureUdpProxyReady(
     }
 
     bool newlyConnected = false;
-    {
-        std::lock_guard<std::mutex> lock(g_udpProxyMtx);
-        auto it = g_udpProxy.find(udpSock);
-        if (it == g_udpProxy.end()) {
-            WSASetLastError(WSAECONNREFUSED);
-            return false;
-        }
-        newlyConnected = !it->second.relayConnected;
-        it->second.relayConnected = true;
+    if (!WithUdpProxyContext(udpSock, [&](UdpProxyContext& ctx) {
+            newlyConnected = !ctx.relayConnected;
+            ctx.relayConnected = true;
+        })) {
+        WSASetLastError(WSAECONNREFUSED);
+        return false;
     }
 
     // 仅在首次 connect relay 时输出，避免刷屏
@@ -1447,56 +1721,97 @@ static bool EnsureUdpProxyReady(
 static bool TryGetUdpProxyDefaultTarget(SOCKET s, std::string* outHost, uint16_t* outPort) {
     if (outHost) outHost->clear();
     if (outPort) *outPort = 0;
-    std::lock_guard<std::mutex> lock(g_udpProxyMtx);
-    auto it = g_udpProxy.find(s);
-    if (it == g_udpProxy.end()) return false;
-    if (!it->second.hasDefaultTarget) return false;
-    if (outHost) *outHost = it->second.defaultTargetHost;
-    if (outPort) *outPort = it->second.defaultTargetPort;
-    return true;
+    bool found = false;
+    WithUdpProxyContext(s, [&](UdpProxyContext& ctx) {
+        if (!ctx.hasDefaultTarget) return;
+        if (outHost) *outHost = ctx.defaultTargetHost;
+        if (outPort) *outPort = ctx.defaultTargetPort;
+        found = true;
+    });
+    return found;
 }
 
-static void UpdateUdpProxyDefaultTarget(SOCKET s, const std::string& host, uint16_t port) {
-    if (s == INVALID_SOCKET || host.empty() || port == 0) return;
-    std::lock_guard<std::mutex> lock(g_udpProxyMtx);
-    auto it = g_udpProxy.find(s);
-    if (it == g_udpProxy.end()) return;
-    it->second.defaultTargetHost = host;
-    it->second.defaultTargetPort = port;
-    it->second.hasDefaultTarget = true;
+// 更新 default target；header 非空时同时拷出该目标的 SOCKS5 UDP 头（cap 至少 kMaxUdpHeaderBytes）
+static size_t UpdateUdpProxyDefaultTarget(SOCKET s, const std::string& host, uint16_t port, uint8_t* header = nullptr) {
+    if (s == INVALID_SOCKET || host.empty() || port == 0) return 0;
+    size_t headerLen = 0;
+    WithUdpProxyContext(s, [&](UdpProxyContext& ctx) {
+        if (!SetUdpDefaultTargetLocked(&ctx, host, port) || !header) return;
+        memcpy(header, ctx.defaultHeader, ctx.defaultHeaderLen);
+        headerLen = ctx.defaultHeaderLen;
+    });
+    return headerLen;
+}
+
+// sendto/WSASendTo 的快路径：relay 已连接时一次查表完成“更新 default target + 记录目标 + 拷出头”。
+// *relayReady 为 false 时未做任何修改，调用方走 EnsureUdpProxyReady；返回 0 表示该目标无法编码
+static size_t UpdateUdpSendTarget(SOCKET s, const std::string& host, uint16_t port, uint8_t* header, bool* relayReady) {
+    size_t headerLen = 0;
+    *relayReady = false;
+    g_sockets.Visit(s, [&](SocketState& st) {
+        if (!st.udp || !st.udp->relayConnected) return;
+        *relayReady = true;
+        if (!SetUdpDefaultTargetLocked(st.udp.get(), host, port)) return;
+        memcpy(header, st.udp->defaultHeader, st.udp->defaultHeaderLen);
+        headerLen = st.udp->defaultHeaderLen;
+        // 目标不变时不重写（每包都会走到这里）
+        if (st.target.port != port || st.target.host != host) {
+            st.target = SocketTargetInfo{host, port, GetTickCount64()};
+        }
+    });
+    return headerLen;
+}
+
+// connected UDP 发送的快路径：一次查表拿到 socket 类型与预编码的头（不复制 host 字符串）。
+// 返回头长度，0 表示不是已代理的 UDP socket；*relayConnected 为 false 时调用方需先 EnsureUdpProxyReady
+static size_t LookupUdpProxyDefaultHeader(SOCKET s, uint8_t* header, bool* relayConnected) {
+    size_t headerLen = 0;
+    if (relayConnected) *relayConnected = false;
+    LookupSocketState(s, [&](UdpProxyContext& ctx) {
+        if (ctx.defaultHeaderLen == 0) return;
+        memcpy(header, ctx.defaultHeader, ctx.defaultHeaderLen);
+        headerLen = ctx.defaultHeaderLen;
+        if (relayConnected) *relayConnected = ctx.relayConnected;
+    });
+    return headerLen;
+}
+
+// 接收路径的判定：一次查表确认该 socket 已建立 UDP Associate（relay 地址有效）
+static bool IsUdpProxiedSocket(SOCKET s) {
+    bool proxied = false;
+    LookupSocketState(s, [&](UdpProxyContext& ctx) { proxied = ctx.relayAddrLen > 0; });
+    return proxied;
 }
 
 static bool TryGetUdpRelayAddr(SOCKET s, sockaddr_storage* out, int* outLen) {
     if (!out || !outLen) return false;
-    std::lock_guard<std::mutex> lock(g_udpProxyMtx);
-    auto it = g_udpProxy.find(s);
-    if (it == g_udpProxy.end()) return false;
-    if (it->second.relayAddrLen <= 0) return false;
-    *out = it->second.relayAddr;
-    *outLen = it->second.relayAddrLen;
-    return true;
+    bool found = false;
+    WithUdpProxyContext(s, [&](UdpProxyContext& ctx) {
+        if (ctx.relayAddrLen <= 0) return;
+        *out = ctx.relayAddr;
+        *outLen = ctx.relayAddrLen;
+        found = true;
+    });
+    return found;
 }
 
 static void MarkUdpRelayConnected(SOCKET s) {
-    std::lock_guard<std::mutex> lock(g_udpProxyMtx);
-    auto it = g_udpProxy.find(s);
-    if (it == g_udpProxy.end()) return;
-    it->second.relayConnected = true;
+    WithUdpProxyContext(s, [](UdpProxyContext& ctx) { ctx.relayConnected = true; });
 }
 
 static bool HandleUdpOverlappedCompletion(LPWSAOVERLAPPED ovl, DWORD internalBytes, DWORD* outUserBytes) {
     if (!ovl) return false;
 
-    // 1) 发送：仅需要把 bytesTransferred 修正为 payload 长度
+    // 一次查表取出该 OVERLAPPED 上的 UDP 上下文（发送优先，与原先两张表的处理顺序一致）
     std::shared_ptr<UdpOverlappedSendCtx> sendCtx;
-    {
-        std::lock_guard<std::mutex> lock(g_udpOvlMtx);
-        auto it = g_udpOvlSend.find(ovl);
-        if (it != g_udpOvlSend.end()) {
-            sendCtx = it->second;
-            g_udpOvlSend.erase(it);
-        }
-    }
+    std::shared_ptr<UdpOverlappedRecvCtx> recvCtx;
+    g_pendingOverlapped.Update(ovl, [&](PendingOverlapped& p) {
+        if (p.udpSend) sendCtx = std::move(p.udpSend);
+        else recvCtx = std::move(p.udpRecv);
+        return !p.Empty();
+    });
+
+    // 1) 发送：仅需要把 bytesTransferred 修正为 payload 长度
     if (sendCtx) {
         const DWORD userBytes = sendCtx->userBytes;
         if (sendCtx->userBytesPtr) {
@@ -1507,32 +1822,39 @@ static bool HandleUdpOverlappedCompletion(LPWSAOVERLAPPED ovl, DWORD internalByt
     }
 
     // 2) 接收：需要解封装并回填用户 buffers / from
-    std::shared_ptr<UdpOverlappedRecvCtx> recvCtx;
-    {
-        std::lock_guard<std::mutex> lock(g_udpOvlMtx);
-        auto it = g_udpOvlRecv.find(ovl);
-        if (it != g_udpOvlRecv.end()) {
-            recvCtx = it->second;
-            g_udpOvlRecv.erase(it);
-        }
-    }
     if (!recvCtx) return false;
 
-    if (internalBytes == 0 || recvCtx->recvBuf.empty()) {
+    if (internalBytes == 0 || (!recvCtx->inPlace && recvCtx->recvBuf.empty())) {
         if (recvCtx->userBytesPtr) *recvCtx->userBytesPtr = 0;
         if (outUserBytes) *outUserBytes = 0;
         return true;
     }
 
     const size_t n = (size_t)internalBytes;
-    if (n > recvCtx->recvBuf.size()) {
+    Network::Socks5Udp::UnwrapResult unwrap{};
+    size_t copied = 0;
+    bool unwrapped = false;
+    if (recvCtx->inPlace) {
+        // 原地：payload 已在用户缓冲内，挪到开头即可（截断时与旧实现一致，只返回能放下的部分）
+        Network::UdpRecv::Source src;
+        const auto st = Network::UdpRecv::UnwrapInPlace((uint8_t*)recvCtx->userBufs[0].buf, recvCtx->userBufs[0].len,
+                                                        recvCtx->tail, n, &src, &copied);
+        unwrapped = st != Network::UdpRecv::UnwrapStatus::Invalid;
+        if (unwrapped) {
+            Network::Socks5Udp::AddressToSockaddr(src.atyp, src.addr, src.addrLen, src.port, &unwrap.src, &unwrap.srcLen);
+        }
+    } else if (n <= recvCtx->recvBuf.size()) {
+        unwrapped = Network::Socks5Udp::Unwrap(recvCtx->recvBuf.data(), n, &unwrap);
+        if (unwrapped) {
+            copied = CopyBytesToWsabufs(unwrap.payload, unwrap.payloadLen, recvCtx->userBufs, recvCtx->userBufCount);
+        }
+    } else {
         if (recvCtx->userBytesPtr) *recvCtx->userBytesPtr = 0;
         if (outUserBytes) *outUserBytes = 0;
         return true;
     }
 
-    Network::Socks5Udp::UnwrapResult unwrap{};
-    if (!Network::Socks5Udp::Unwrap(recvCtx->recvBuf.data(), n, &unwrap)) {
+    if (!unwrapped) {
         // 解封装失败：清空返回，避免上层解析到“代理协议头”
         if (ShouldLogUdpProxyFail()) {
             Core::Logger::Warn("UDP 解封装失败, sock=" + std::to_string((unsigned long long)recvCtx->sock) +
@@ -1544,9 +1866,6 @@ static bool HandleUdpOverlappedCompletion(LPWSAOVERLAPPED ovl, DWORD internalByt
         return true;
     }
 
-    // 回填 payload -> 用户缓冲区
-    const size_t copied = CopyBytesToWsabufs(unwrap.payload, unwrap.payloadLen, recvCtx->userBufs, recvCtx->userBufCount);
-
     // 回填 from（若能解析出 sockaddr）
     if (recvCtx->userFromLen) {
         if (unwrap.srcLen > 0) {
@@ -1574,18 +1893,10 @@ static void CALLBACK UdpProxyCompletionRoutine(
 
     if (lpOverlapped) {
         // 先取出 user callback（因为 HandleUdpOverlappedCompletion 会 erase 上下文）
-        {
-            std::lock_guard<std::mutex> lock(g_udpOvlMtx);
-            auto itS = g_udpOvlSend.find(lpOverlapped);
-            if (itS != g_udpOvlSend.end() && itS->second) {
-                userCb = itS->second->userCompletion;
-            } else {
-                auto itR = g_udpOvlRecv.find(lpOverlapped);
-                if (itR != g_udpOvlRecv.end() && itR->second) {
-                    userCb = itR->second->userCompletion;
-                }
-            }
-        }
+        g_pendingOverlapped.Visit(lpOverlapped, [&](PendingOverlapped& p) {
+            if (p.udpSend) userCb = p.udpSend->userCompletion;
+            else if (p.udpRecv) userCb = p.udpRecv->userCompletion;
+        });
 
         if (dwError == 0) {
             HandleUdpOverlappedCompletion(lpOverlapped, cbTransferred, &userBytes);
@@ -1604,6 +1915,14 @@ static void CALLBACK UdpProxyCompletionRoutine(
 static bool ResolveNameToAddrWithFamily(const std::string& node, const std::string& service, int family,
                                         sockaddr_storage* out, int* outLen, int* outErr) {
     if (!out || !outLen) return false;
+    // 缓存按 (name, family) 保存地址、取用时填端口；服务名解析不出端口时绕过缓存，保持系统的错误语义
+    uint16_t port = 0;
+    if (service.empty() || (port = ParseServiceNameToPortA(service.c_str(), "tcp")) != 0) {
+        int err = 0;
+        const bool ok = GetDnsCache().Resolve(node, family, port, out, outLen, &err);
+        if (outErr) *outErr = err;
+        return ok;
+    }
     addrinfo hints{};
     hints.ai_family = family;
     hints.ai_socktype = SOCK_STREAM;
@@ -1738,12 +2057,8 @@ static bool DoProxyHandshake(SOCKET s, const std::string& host, uint16_t port) {
     if (handshakeBudgetMs <= 0) {
         handshakeBudgetMs = 5000;
     }
-    if (Core::Logger::IsEnabled(Core::LogLevel::Debug)) {
-        Core::Logger::Debug("代理握手: 开始, sock=" + std::to_string((unsigned long long)s) +
-                            ", type=" + config.proxy.type +
-                            ", 目标=" + host + ":" + std::to_string(port) +
-                            ", 预算=" + std::to_string(handshakeBudgetMs) + "ms");
-    }
+    AGP_LOG_DEBUG("代理握手: 开始, sock={}, type={}, 目标={}:{}, 预算={}ms", (unsigned long long)s,
+                  config.proxy.type, host, port, handshakeBudgetMs);
     if (config.proxy.type == "socks5") {
         if (!Network::Socks5Client::Handshake(s, host, port, handshakeBudgetMs)) {
             Core::Logger::Error("SOCKS5 握手失败, sock=" + std::to_string((unsigned long long)s) +
@@ -1777,38 +2092,46 @@ static bool DoProxyHandshake(SOCKET s, const std::string& host, uint16_t port) {
     return true;
 }
 
+static std::atomic<ULONGLONG> g_connectExLastPurgeTick{0};
+
 static void PurgeStaleConnectExContexts(ULONGLONG now) {
-    // 清理长时间未完成的 ConnectEx 上下文，避免内存堆积
-    for (auto it = g_connectExPending.begin(); it != g_connectExPending.end(); ) {
-        if (now - it->second.createdTick > kConnectExPendingTtlMs) {
-            it = g_connectExPending.erase(it);
-        } else {
-            ++it;
-        }
+    // 清理长时间未完成的 ConnectEx 上下文，避免内存堆积；需扫描全部分片，因此限频执行
+    ULONGLONG last = g_connectExLastPurgeTick.load(std::memory_order_relaxed);
+    if (now - last < kConnectExPurgeIntervalMs ||
+        !g_connectExLastPurgeTick.compare_exchange_strong(last, now, std::memory_order_relaxed)) {
+        return;
     }
+    g_pendingOverlapped.EraseIf([now](LPOVERLAPPED, PendingOverlapped& p) {
+        if (p.hasConnectEx && now - p.connectEx.createdTick > kConnectExPendingTtlMs) p.hasConnectEx = false;
+        return p.Empty();
+    });
 }
 
 static void SaveConnectExContext(LPOVERLAPPED ovl, const ConnectExContext& ctx) {
-    std::lock_guard<std::mutex> lock(g_connectExMtx);
     ULONGLONG now = GetTickCount64();
     PurgeStaleConnectExContexts(now);
-    ConnectExContext copy = ctx;
-    copy.createdTick = now;
-    g_connectExPending[ovl] = copy;
+    g_pendingOverlapped.Upsert(ovl, [&](PendingOverlapped& p) {
+        p.connectEx = ctx;
+        p.connectEx.createdTick = now;
+        p.hasConnectEx = true;
+    });
 }
 
-static bool PopConnectExContext(LPOVERLAPPED ovl, ConnectExContext* out) {
-    std::lock_guard<std::mutex> lock(g_connectExMtx);
-    auto it = g_connectExPending.find(ovl);
-    if (it == g_connectExPending.end()) return false;
-    if (out) *out = it->second;
-    g_connectExPending.erase(it);
-    return true;
+// 取出并移除 ConnectEx 上下文；tcpOnly 为 true 时跳过 UDP ConnectEx（保留在表中）
+static bool PopConnectExContext(LPOVERLAPPED ovl, ConnectExContext* out, bool tcpOnly = false) {
+    bool found = false;
+    g_pendingOverlapped.Update(ovl, [&](PendingOverlapped& p) {
+        if (!p.hasConnectEx || (tcpOnly && p.connectEx.isUdp)) return true;
+        if (out) *out = p.connectEx;
+        p.hasConnectEx = false;
+        found = true;
+        return !p.Empty();
+    });
+    return found;
 }
 
 static void DropConnectExContext(LPOVERLAPPED ovl) {
-    std::lock_guard<std::mutex> lock(g_connectExMtx);
-    g_connectExPending.erase(ovl);
+    PopConnectExContext(ovl, nullptr);
 }
 
 // ConnectEx 连接完成后更新上下文，避免 send 报 WSAENOTCONN
@@ -1840,17 +2163,17 @@ static bool HandleConnectExCompletion(LPOVERLAPPED ovl, DWORD* outSentBytes) {
     // UDP ConnectEx：不做 TCP 握手，改为发送 SOCKS5 UDP 封装数据
     if (ctx.isUdp) {
         MarkUdpRelayConnected(ctx.sock);
-        UpdateUdpProxyDefaultTarget(ctx.sock, ctx.host, ctx.port);
+        uint8_t header[Network::Socks5::kMaxUdpHeaderBytes];
+        const size_t headerLen = UpdateUdpProxyDefaultTarget(ctx.sock, ctx.host, ctx.port, header);
         RememberSocketTarget(ctx.sock, ctx.host, ctx.port);
 
         if (ctx.sendBuf && ctx.sendLen > 0) {
-            std::vector<uint8_t> packet;
-            if (!Network::Socks5Udp::Wrap(ctx.host, ctx.port, (const uint8_t*)ctx.sendBuf, (size_t)ctx.sendLen, &packet)) {
+            if (headerLen == 0) {
                 WSASetLastError(WSAECONNREFUSED);
                 return false;
             }
             auto& config = Core::Config::Instance();
-            if (!SendUdpPacketWithRetry(ctx.sock, packet.data(), (int)packet.size(), 0, config.timeout.send_ms)) {
+            if (!SendUdpGatherWithRetry(ctx.sock, header, headerLen, (const char*)ctx.sendBuf, (int)ctx.sendLen, 0, config.timeout.send_ms)) {
                 int err = WSAGetLastError();
                 Core::Logger::Error("ConnectEx(UDP) 发送首包失败, sock=" + std::to_string((unsigned long long)ctx.sock) +
                                     ", bytes=" + std::to_string((unsigned long long)ctx.sendLen) +
@@ -1893,6 +2216,276 @@ static bool HandleConnectExCompletion(LPOVERLAPPED ovl, DWORD* outSentBytes) {
     return true;
 }
 
+// ============= ConnectEx 异步握手 =============
+// 设计意图：HandleConnectExCompletion 在应用的 GetQueuedCompletionStatus(Ex) 里同步握手，握手期间应用的
+// IOCP 工作线程（以及同一批出队的其他完成事件）都被卡住。启用 proxy.async_handshake 后：
+// - 出队时截下 ConnectEx 的完成事件（不交给应用），握手由 ProxyHandshake 状态机以重叠 I/O 推进
+// - socket 已绑定应用的完成端口，无法再绑定私有端口：我们自己的 WSASend/WSARecv 使用 hEvent 低位置 1 的
+//   事件（完成不进入应用的完成端口），由线程池等待（RegisterWaitForSingleObject）回调推进，回调不阻塞
+// - HTTP 响应头需要 peek：先投递 0 字节 WSARecv 等待可读，再用 MSG_PEEK 取当前数据（此时不会阻塞）
+// - 握手与首包发送结束后，用 PostQueuedCompletionStatus 把原 OVERLAPPED 投回应用的完成端口；
+//   失败时把 OVERLAPPED.Internal 置为错误状态，应用随后的 WSAGetOverlappedResult 能看到失败
+// - 超时：等待带握手预算，超时后 CancelIoEx，等取消完成（OVERLAPPED 不再被内核引用）再收尾
+static const ULONG_PTR kStatusConnectionRefused = 0xC0000236; // STATUS_CONNECTION_REFUSED
+static const ULONG_PTR kStatusIoTimeout = 0xC00000B5;         // STATUS_IO_TIMEOUT
+
+struct AsyncHandshakeOp {
+    enum class Io { None, Send, Recv, WaitReadable, Payload };
+
+    OVERLAPPED ovl{};
+    HANDLE event = NULL;
+    HANDLE wait = NULL;
+    Io io = Io::None;
+    bool cancelled = false;
+    ULONGLONG deadlineTick = 0;
+    ConnectExContext ctx{};
+    DWORD payloadSent = 0;
+    HANDLE appPort = NULL;
+    ULONG_PTR appKey = 0;
+    LPOVERLAPPED appOvl = nullptr;
+    Network::ProxyHandshake machine;
+};
+
+static void AsyncHandshakePump(AsyncHandshakeOp* op);
+static VOID CALLBACK AsyncHandshakeWaitCallback(PVOID param, BOOLEAN timedOut);
+
+static const char* AsyncHandshakeErrorText(Network::ProxyHandshake::Error error) {
+    using Error = Network::ProxyHandshake::Error;
+    switch (error) {
+        case Error::Encode: return "目标地址无法编码";
+        case Error::Closed: return "连接被关闭";
+        case Error::BadMethod: return "不支持的认证方式";
+        case Error::BadReply: return "响应无效";
+        case Error::Rejected: return "代理拒绝";
+        case Error::TooLong: return "响应头过长";
+        case Error::PipelineRejected: return "代理不支持流水线握手";
+        default: return "I/O 失败";
+    }
+}
+
+static void FinishAsyncHandshake(AsyncHandshakeOp* op, bool ok, int err) {
+    const ConnectExContext& ctx = op->ctx;
+    const std::string sockText = std::to_string((unsigned long long)ctx.sock);
+    const std::string target = ctx.host + ":" + std::to_string(ctx.port);
+    if (ok) {
+        RememberSocketTarget(ctx.sock, ctx.host, ctx.port);
+        if (ctx.bytesSent) *ctx.bytesSent = op->payloadSent;
+        const auto& config = Core::Config::Instance();
+        Core::Logger::Info("代理隧道就绪(异步): sock=" + sockText + ", type=" + config.proxy.type +
+                           ", 代理=" + config.proxy.host + ":" + std::to_string(config.proxy.port) +
+                           ", 目标=" + target);
+    } else {
+        const auto& m = op->machine;
+        if (m.GetError() == Network::ProxyHandshake::Error::PipelineRejected) {
+            Network::Socks5Client::RejectPipeline(ctx.sock, "异步握手响应无效");
+        }
+        std::string detail = m.GetError() != Network::ProxyHandshake::Error::None
+                                 ? AsyncHandshakeErrorText(m.GetError())
+                                 : (op->cancelled ? "握手预算耗尽" : "I/O 失败");
+        if (m.GetError() == Network::ProxyHandshake::Error::Rejected) {
+            detail += m.GetProtocol() == Network::ProxyHandshake::Protocol::Http
+                          ? ", 状态码=" + std::to_string(m.HttpStatus())
+                          : ", REP=" + std::to_string(m.ReplyCode());
+        }
+        Core::Logger::Error("代理握手失败(异步): sock=" + sockText + ", 目标=" + target + ", 原因=" + detail +
+                            ", WSA错误码=" + std::to_string(err));
+    }
+
+    // 投回应用：失败时写入错误状态（应用通过 WSAGetOverlappedResult/Internal 判断结果）
+    op->appOvl->Internal = ok ? 0 : (err == WSAETIMEDOUT ? kStatusIoTimeout : kStatusConnectionRefused);
+    op->appOvl->InternalHigh = ok ? op->payloadSent : 0;
+    if (!PostQueuedCompletionStatus(op->appPort, ok ? op->payloadSent : 0, op->appKey, op->appOvl)) {
+        Core::Logger::Error("代理握手(异步): 投递 ConnectEx 完成事件失败, sock=" + sockText +
+                            ", 错误码=" + std::to_string(GetLastError()));
+    }
+    CloseHandle(op->event);
+    delete op;
+}
+
+// 投递一次重叠 I/O 并登记等待；失败返回 false（此时没有 I/O 在途）
+static bool IssueAsyncHandshakeIo(AsyncHandshakeOp* op, AsyncHandshakeOp::Io io, char* buf, ULONG len) {
+    memset(&op->ovl, 0, sizeof(op->ovl));
+    // hEvent 低位置 1：完成只置位事件，不进入应用的完成端口
+    op->ovl.hEvent = (HANDLE)((ULONG_PTR)op->event | 1);
+    ResetEvent(op->event);
+    WSABUF wsaBuf{len, buf};
+    DWORD bytes = 0;
+    DWORD flags = 0;
+    LPWSAOVERLAPPED ovl = (LPWSAOVERLAPPED)&op->ovl;
+    int rc = 0;
+    if (io == AsyncHandshakeOp::Io::Send || io == AsyncHandshakeOp::Io::Payload) {
+        rc = fpWSASend ? fpWSASend(op->ctx.sock, &wsaBuf, 1, &bytes, 0, ovl, NULL)
+                       : WSASend(op->ctx.sock, &wsaBuf, 1, &bytes, 0, ovl, NULL);
+    } else {
+        rc = fpWSARecv ? fpWSARecv(op->ctx.sock, &wsaBuf, 1, &bytes, &flags, ovl, NULL)
+                       : WSARecv(op->ctx.sock, &wsaBuf, 1, &bytes, &flags, ovl, NULL);
+    }
+    if (rc != 0 && WSAGetLastError() != WSA_IO_PENDING) return false;
+    op->io = io;
+
+    // 立即完成时事件同样会被置位，统一在回调里取结果
+    const ULONGLONG now = GetTickCount64();
+    const DWORD waitMs = op->deadlineTick > now ? (DWORD)(op->deadlineTick - now) : 1;
+    if (!RegisterWaitForSingleObject(&op->wait, op->event, AsyncHandshakeWaitCallback, op, waitMs,
+                                     WT_EXECUTEONLYONCE)) {
+        const DWORD regErr = GetLastError();
+        CancelIoEx((HANDLE)op->ctx.sock, &op->ovl);
+        WaitForSingleObject(op->event, INFINITE);
+        WSASetLastError((int)regErr);
+        return false;
+    }
+    return true;
+}
+
+static void AsyncHandshakePump(AsyncHandshakeOp* op) {
+    using Want = Network::ProxyHandshake::Want;
+    auto& m = op->machine;
+    bool issued = false;
+    switch (m.Next()) {
+        case Want::Send:
+            issued = IssueAsyncHandshakeIo(op, AsyncHandshakeOp::Io::Send, (char*)m.SendData(), (ULONG)m.SendSize());
+            break;
+        case Want::Recv:
+            issued = IssueAsyncHandshakeIo(op, AsyncHandshakeOp::Io::Recv, (char*)m.RecvBuffer(), (ULONG)m.RecvSize());
+            break;
+        case Want::Peek:
+            issued = IssueAsyncHandshakeIo(op, AsyncHandshakeOp::Io::WaitReadable, (char*)m.RecvBuffer(), 0);
+            break;
+        case Want::Done:
+            if (op->ctx.sendBuf && op->payloadSent < op->ctx.sendLen) {
+                issued = IssueAsyncHandshakeIo(op, AsyncHandshakeOp::Io::Payload,
+                                               (char*)op->ctx.sendBuf + op->payloadSent,
+                                               op->ctx.sendLen - op->payloadSent);
+                break;
+            }
+            FinishAsyncHandshake(op, true, 0);
+            return;
+        case Want::Failed:
+            FinishAsyncHandshake(op, false, WSAECONNREFUSED);
+            return;
+    }
+    if (!issued) FinishAsyncHandshake(op, false, WSAGetLastError());
+}
+
+static VOID CALLBACK AsyncHandshakeWaitCallback(PVOID param, BOOLEAN timedOut) {
+    auto* op = static_cast<AsyncHandshakeOp*>(param);
+    // WT_EXECUTEONLYONCE 的等待仍需注销；UnregisterWait 不阻塞，可在回调内调用
+    UnregisterWait(op->wait);
+    op->wait = NULL;
+
+    if (timedOut) {
+        op->cancelled = true;
+        CancelIoEx((HANDLE)op->ctx.sock, &op->ovl);
+        if (!RegisterWaitForSingleObject(&op->wait, op->event, AsyncHandshakeWaitCallback, op, INFINITE,
+                                         WT_EXECUTEONLYONCE)) {
+            WaitForSingleObject(op->event, INFINITE);
+            FinishAsyncHandshake(op, false, WSAETIMEDOUT);
+        }
+        return;
+    }
+
+    DWORD bytes = 0;
+    DWORD flags = 0;
+    LPWSAOVERLAPPED ovl = (LPWSAOVERLAPPED)&op->ovl;
+    const BOOL ok = fpWSAGetOverlappedResult ? fpWSAGetOverlappedResult(op->ctx.sock, ovl, &bytes, FALSE, &flags)
+                                             : WSAGetOverlappedResult(op->ctx.sock, ovl, &bytes, FALSE, &flags);
+    if (op->cancelled) {
+        FinishAsyncHandshake(op, false, WSAETIMEDOUT);
+        return;
+    }
+    if (!ok) {
+        FinishAsyncHandshake(op, false, WSAGetLastError());
+        return;
+    }
+
+    auto& m = op->machine;
+    switch (op->io) {
+        case AsyncHandshakeOp::Io::Send:
+            m.OnSent(bytes);
+            break;
+        case AsyncHandshakeOp::Io::Recv:
+            m.OnReceived(bytes);
+            break;
+        case AsyncHandshakeOp::Io::WaitReadable: {
+            // 0 字节读已完成：数据已到达（或对端关闭），peek 不会阻塞
+            const int n = fpRecv ? fpRecv(op->ctx.sock, (char*)m.RecvBuffer(), (int)m.RecvSize(), MSG_PEEK)
+                                 : recv(op->ctx.sock, (char*)m.RecvBuffer(), (int)m.RecvSize(), MSG_PEEK);
+            if (n == SOCKET_ERROR) {
+                const int err = WSAGetLastError();
+                if (err != WSAEWOULDBLOCK) {
+                    FinishAsyncHandshake(op, false, err);
+                    return;
+                }
+                break; // 虚假唤醒：状态不变，重新等待可读
+            }
+            m.OnPeeked((size_t)n);
+            break;
+        }
+        case AsyncHandshakeOp::Io::Payload:
+            op->payloadSent += bytes;
+            break;
+        default:
+            break;
+    }
+    AsyncHandshakePump(op);
+}
+
+// GetQueuedCompletionStatus(Ex) 出队时调用：若 ovl 是待握手的 TCP ConnectEx，则转入异步握手并返回 true
+// （本次完成事件不交给应用，握手结束后重新投递）；其他情况返回 false，按原逻辑处理
+static bool TryDeferConnectExCompletion(HANDLE port, ULONG_PTR key, LPOVERLAPPED ovl) {
+    const auto& config = Core::Config::Instance();
+    if (!config.proxy.async_handshake || !port || !ovl) return false;
+    using Protocol = Network::ProxyHandshake::Protocol;
+    Protocol protocol = Protocol::Socks5;
+    if (config.proxy.type == "socks5") {
+        const bool pipelined = config.proxy.socks5_pipeline &&
+                               !Network::Socks5Client::PipelineRejected().load(std::memory_order_relaxed);
+        protocol = pipelined ? Protocol::Socks5Pipelined : Protocol::Socks5;
+    } else if (config.proxy.type == "http") {
+        protocol = Protocol::Http;
+    } else {
+        return false;
+    }
+
+    ConnectExContext ctx{};
+    if (!PopConnectExContext(ovl, &ctx, true)) return false;
+    // 连接本身失败：交回应用（与同步路径一致，由应用看到连接错误）
+    if (!UpdateConnectExContext(ctx.sock)) return false;
+
+    auto* op = new AsyncHandshakeOp();
+    op->ctx = ctx;
+    op->appPort = port;
+    op->appKey = key;
+    op->appOvl = ovl;
+    int budgetMs = config.timeout.connect_ms + config.timeout.send_ms + config.timeout.recv_ms;
+    if (budgetMs <= 0) budgetMs = 5000;
+    op->deadlineTick = GetTickCount64() + (ULONGLONG)budgetMs;
+    op->event = CreateEventW(NULL, TRUE, FALSE, NULL);
+    if (!op->event) {
+        // 无法异步：放回上下文，由调用方走同步握手
+        delete op;
+        SaveConnectExContext(ovl, ctx);
+        return false;
+    }
+    AGP_LOG_DEBUG("代理握手(异步): 开始, sock={}, type={}, 目标={}:{}, 预算={}ms", (unsigned long long)ctx.sock,
+                  config.proxy.type, ctx.host, ctx.port, budgetMs);
+    op->machine.Start(protocol, ctx.host, ctx.port);
+    AsyncHandshakePump(op);
+    return true;
+}
+
+// 剩余等待时间：INFINITE 保持不变；已超时返回 false
+static bool RemainingCompletionWaitMs(ULONGLONG startTick, DWORD totalMs, DWORD* outMs) {
+    if (totalMs == INFINITE) {
+        *outMs = INFINITE;
+        return true;
+    }
+    const ULONGLONG elapsed = GetTickCount64() - startTick;
+    if (elapsed >= totalMs) return false;
+    *outMs = totalMs - (DWORD)elapsed;
+    return true;
+}
+
 BOOL PASCAL DetourConnectEx(
     SOCKET s,
     const struct sockaddr* name,
@@ -1903,6 +2496,13 @@ BOOL PASCAL DetourConnectEx(
     LPOVERLAPPED lpOverlapped
 );
 
+// ============= 路由决策入口（带缓存） =============
+// 同一 host:port 会被反复连接；经分片缓存命中时跳过完整规则匹配，规则重编译后自动失效
+static Core::RouteDecision MatchRouteCached(std::string_view host, std::string_view ip, bool ipIsV6,
+                                            uint16_t port, Core::RouteProtocol protocol) {
+    return Core::RouteDecisionCache::Instance().Match(Core::Config::Instance().rules, host, ip, ipIsV6, port, protocol);
+}
+
 // ============= UDP 代理连接逻辑（用于 QUIC/HTTP3 等 UDP 协议） =============
 
 static bool ShouldProxyUdpByRule(const sockaddr* name, const std::string& originalHost, uint16_t originalPort) {
@@ -1935,13 +2535,12 @@ static bool ShouldProxyUdpByRule(const sockaddr* name, const std::string& origin
     std::string addrIp;
     bool addrIsV6 = false;
     SockaddrToIp(name, &addrIp, &addrIsV6);
-    std::string routeAction;
-    std::string routeRule;
-    config.rules.MatchRouting(originalHost, addrIp, addrIsV6, originalPort, "udp", &routeAction, &routeRule);
-    routeAction = Core::ProxyRules::ToLower(std::move(routeAction));
-    if (routeAction == "direct") {
+    const Core::RouteDecision route = MatchRouteCached(originalHost, addrIp, addrIsV6, originalPort,
+                                                       Core::RouteProtocol::Udp);
+    if (route.IsDirect()) {
         if (Core::Logger::IsEnabled(Core::LogLevel::Debug)) {
-            Core::Logger::Debug("[Route] UDP direct, rule=" + (routeRule.empty() ? std::string("(default)") : routeRule) +
+            Core::Logger::Debug("[Route] UDP direct, rule=" +
+                                (route.Matched() ? config.rules.RouteRuleName(route) : std::string("(default)")) +
                                 ", target=" + originalHost + ":" + std::to_string(originalPort));
         }
         return false;
@@ -2147,16 +2746,16 @@ static BOOL PerformProxyUdpConnectEx(
     // 立即完成：此时需要同步发送首包（若有），并修正 bytesSent 为 payload 长度
     UpdateConnectExContext(s);
     MarkUdpRelayConnected(s);
-    UpdateUdpProxyDefaultTarget(s, originalHost, originalPort);
+    uint8_t header[Network::Socks5::kMaxUdpHeaderBytes];
+    const size_t headerLen = UpdateUdpProxyDefaultTarget(s, originalHost, originalPort, header);
     RememberSocketTarget(s, originalHost, originalPort);
 
     if (lpSendBuffer && dwSendDataLength > 0) {
-        std::vector<uint8_t> packet;
-        if (!Network::Socks5Udp::Wrap(originalHost, originalPort, (const uint8_t*)lpSendBuffer, (size_t)dwSendDataLength, &packet)) {
+        if (headerLen == 0) {
             WSASetLastError(WSAECONNREFUSED);
             return FALSE;
         }
-        if (!SendUdpPacketWithRetry(s, packet.data(), (int)packet.size(), 0, config.timeout.send_ms)) {
+        if (!SendUdpGatherWithRetry(s, header, headerLen, (const char*)lpSendBuffer, (int)dwSendDataLength, 0, config.timeout.send_ms)) {
             int serr = WSAGetLastError();
             Core::Logger::Error("ConnectEx(UDP) 发送首包失败, sock=" + std::to_string((unsigned long long)s) +
                                 ", WSA错误码=" + std::to_string(serr));
@@ -2175,6 +2774,9 @@ static BOOL PerformProxyUdpConnectEx(
 int PerformProxyConnect(SOCKET s, const struct sockaddr* name, int namelen, bool isWsa) {
     auto& config = Core::Config::Instance();
     LogRuntimeConfigSummaryOnce();
+    if (UdpAssociationPoolEnabled()) {
+        GetUdpAssociationPool(); // 首次调用时启动后台预建
+    }
     
     // 超时控制
     Network::SocketWrapper sock(s);
@@ -2323,20 +2925,14 @@ int PerformProxyConnect(SOCKET s, const struct sockaddr* name, int namelen, bool
     
     // BYPASS: 跳过本地回环地址，避免代理死循环
     if (IsLoopbackHost(originalHost)) {
-        if (Core::Logger::IsEnabled(Core::LogLevel::Debug)) {
-            Core::Logger::Debug("BYPASS(loopback): sock=" + std::to_string((unsigned long long)s) +
-                                ", target=" + originalHost + ":" + std::to_string(originalPort));
-        }
+        AGP_LOG_DEBUG("BYPASS(loopback): sock={}, target={}:{}", (unsigned long long)s, originalHost, originalPort);
         return isWsa ? fpWSAConnect(s, name, namelen, NULL, NULL, NULL, NULL) : fpConnect(s, name, namelen);
     }
     
     // BYPASS: 如果目标端口就是代理端口，直连（防止代理自连接）
     if (IsProxySelfTarget(originalHost, originalPort, config.proxy)) {
-        if (Core::Logger::IsEnabled(Core::LogLevel::Debug)) {
-            Core::Logger::Debug("BYPASS(proxy-self): sock=" + std::to_string((unsigned long long)s) +
-                                ", target=" + originalHost + ":" + std::to_string(originalPort) +
-                                ", proxy=" + config.proxy.host + ":" + std::to_string(config.proxy.port));
-        }
+        AGP_LOG_DEBUG("BYPASS(proxy-self): sock={}, target={}:{}, proxy={}:{}", (unsigned long long)s,
+                      originalHost, originalPort, config.proxy.host, config.proxy.port);
         return isWsa ? fpWSAConnect(s, name, namelen, NULL, NULL, NULL, NULL) : fpConnect(s, name, namelen);
     }
 
@@ -2344,14 +2940,13 @@ int PerformProxyConnect(SOCKET s, const struct sockaddr* name, int namelen, bool
     std::string addrIp;
     bool addrIsV6 = false;
     SockaddrToIp(name, &addrIp, &addrIsV6);
-    std::string routeAction;
-    std::string routeRule;
-    const bool routeMatched = config.rules.MatchRouting(originalHost, addrIp, addrIsV6, originalPort, "tcp",
-                                                        &routeAction, &routeRule);
-    if (!routeAction.empty() && routeAction == "direct") {
+    const Core::RouteDecision route = MatchRouteCached(originalHost, addrIp, addrIsV6, originalPort,
+                                                       Core::RouteProtocol::Tcp);
+    if (route.IsDirect()) {
         if (ShouldLogRouteDecisionInfo()) {
             Core::Logger::Info("[Route] direct" +
-                               std::string(routeMatched ? (" rule=" + routeRule) : " rule=(default)") +
+                               std::string(route.Matched() ? (" rule=" + config.rules.RouteRuleName(route))
+                                                           : " rule=(default)") +
                                ", target=" + originalHost + ":" + std::to_string(originalPort));
         }
         // CRIT-3: 若底层 sockaddr 仍为 FakeIP，则 direct 直连必失败；这里做兜底重解析
@@ -2374,9 +2969,9 @@ int PerformProxyConnect(SOCKET s, const struct sockaddr* name, int namelen, bool
         }
         return isWsa ? fpWSAConnect(s, name, namelen, NULL, NULL, NULL, NULL)
                      : fpConnect(s, name, namelen);
-    } else if (routeMatched) {
+    } else if (route.Matched()) {
         if (ShouldLogRouteDecisionInfo()) {
-            Core::Logger::Info("[Route] proxy rule=" + routeRule +
+            Core::Logger::Info("[Route] proxy rule=" + config.rules.RouteRuleName(route) +
                                ", target=" + originalHost + ":" + std::to_string(originalPort));
         }
     }
@@ -2418,12 +3013,14 @@ int PerformProxyConnect(SOCKET s, const struct sockaddr* name, int namelen, bool
         
         // 修改目标地址为代理服务器（按地址族构造）
         int result = 0;
+        sockaddr_storage proxyTarget{};
         if (name->sa_family == AF_INET6) {
             sockaddr_in6 proxyAddr6{};
             if (!BuildProxyAddrV6(config.proxy, &proxyAddr6, (sockaddr_in6*)name)) {
                 WSASetLastError(WSAEINVAL);
                 return SOCKET_ERROR;
             }
+            memcpy(&proxyTarget, &proxyAddr6, sizeof(proxyAddr6));
             result = isWsa ?
                 fpWSAConnect(s, (sockaddr*)&proxyAddr6, sizeof(proxyAddr6), NULL, NULL, NULL, NULL) :
                 fpConnect(s, (sockaddr*)&proxyAddr6, sizeof(proxyAddr6));
@@ -2433,6 +3030,7 @@ int PerformProxyConnect(SOCKET s, const struct sockaddr* name, int namelen, bool
                 WSASetLastError(WSAEINVAL);
                 return SOCKET_ERROR;
             }
+            memcpy(&proxyTarget, &proxyAddr, sizeof(proxyAddr));
             result = isWsa ? 
                 fpWSAConnect(s, (sockaddr*)&proxyAddr, sizeof(proxyAddr), NULL, NULL, NULL, NULL) :
                 fpConnect(s, (sockaddr*)&proxyAddr, sizeof(proxyAddr));
@@ -2446,14 +3044,19 @@ int PerformProxyConnect(SOCKET s, const struct sockaddr* name, int namelen, bool
                     int waitErr = WSAGetLastError();
                     Core::Logger::Error("连接代理服务器失败, sock=" + std::to_string((unsigned long long)s) +
                                         ", WSA错误码=" + std::to_string(waitErr));
+                    ReportProxyConnectResult(config.proxy, (sockaddr*)&proxyTarget, false);
+                    WSASetLastError(waitErr);
                     return SOCKET_ERROR;
                 }
             } else {
                 Core::Logger::Error("连接代理服务器失败, sock=" + std::to_string((unsigned long long)s) +
                                     ", WSA错误码=" + std::to_string(err));
+                ReportProxyConnectResult(config.proxy, (sockaddr*)&proxyTarget, false);
+                WSASetLastError(err);
                 return result;
             }
         }
+        ReportProxyConnectResult(config.proxy, (sockaddr*)&proxyTarget, true);
         
         if (!DoProxyHandshake(s, originalHost, originalPort)) {
             return SOCKET_ERROR;
@@ -2504,10 +3107,7 @@ int WSAAPI DetourShutdown(SOCKET s, int how) {
     int rc = fpShutdown(s, how);
     if (rc == SOCKET_ERROR) {
         int err = WSAGetLastError();
-        if (Core::Logger::IsEnabled(Core::LogLevel::Debug)) {
-            Core::Logger::Debug("shutdown: 失败, sock=" + std::to_string((unsigned long long)s) +
-                                ", WSA错误码=" + std::to_string(err));
-        }
+        AGP_LOG_DEBUG("shutdown: 失败, sock={}, WSA错误码={}", (unsigned long long)s, err);
         WSASetLastError(err);
     }
     return rc;
@@ -2545,18 +3145,27 @@ int WSAAPI DetourCloseSocket(SOCKET s) {
         return rc;
     }
 
-    // UDP 代理：关闭对应的 UDP Associate 控制连接并清理 Overlapped 上下文
-    CleanupUdpProxyContext(s);
-
-    // 关闭成功后清理映射，避免句柄复用导致的误关联
-    ForgetSocketTarget(s);
-
-    if (Core::Logger::IsEnabled(Core::LogLevel::Debug)) {
-        Core::Logger::Debug("closesocket: 完成, sock=" + std::to_string((unsigned long long)s));
+    // 关闭成功后整体删除该 socket 的状态，避免句柄复用导致的误关联
+    SocketState state;
+    if (g_sockets.Take(s, &state) && state.udp) {
+        // UDP 代理：关闭对应的 UDP Associate 控制连接并清理 Overlapped 上下文
+        CloseUdpControlSocket(state.udp->controlSock);
+        CleanupUdpOverlappedBySocket(s);
     }
+
+    AGP_LOG_DEBUG("closesocket: 完成, sock={}", (unsigned long long)s);
     return rc;
 }
 
+// freeaddrinfo 与 FreeAddrInfoW 均已 hook 时才自行构造结果：否则池内块可能被系统释放函数误释放
+static std::atomic<bool> g_addrInfoFreeHooked{false};
+
+// 服务名给了但解析不出端口（未知服务名或 "0"）时不自行构造，交给系统保持原有错误语义
+static bool CanSynthesizeFakeIpResult(bool hasService, uint16_t port) {
+    if (!g_addrInfoFreeHooked.load(std::memory_order_acquire)) return false;
+    return !hasService || port != 0;
+}
+
 int WSAAPI DetourGetAddrInfo(PCSTR pNodeName, PCSTR pServiceName, 
                               const ADDRINFOA* pHints, PADDRINFOA* ppResult) {
     auto& config = Core::Config::Instance();
@@ -2566,14 +3175,13 @@ int WSAAPI DetourGetAddrInfo(PCSTR pNodeName, PCSTR pServiceName,
     // 如果启用了 FakeIP 且有域名请求
     if (pNodeName && config.fakeIp.enabled) {
         std::string node = pNodeName;
-        std::string routeAction;
-        std::string routeRule;
         const uint16_t port = ParseServiceNameToPortA(pServiceName, "tcp");
-        const bool routeMatched = config.rules.MatchRouting(node, "", false, port, "tcp", &routeAction, &routeRule);
-        if (!routeAction.empty() && routeAction == "direct") {
+        const Core::RouteDecision route = MatchRouteCached(node, std::string_view(), false, port,
+                                                           Core::RouteProtocol::Tcp);
+        if (route.IsDirect()) {
             if (Core::Logger::IsEnabled(Core::LogLevel::Debug)) {
                 Core::Logger::Debug("[Route] DNS bypass FakeIP, rule=" +
-                                    std::string(routeMatched ? routeRule : "(default)") +
+                                    (route.Matched() ? config.rules.RouteRuleName(route) : std::string("(default)")) +
                                     ", host=" + node +
                                     (port ? (":" + std::to_string(port)) : std::string("")));
             }
@@ -2584,9 +3192,15 @@ int WSAAPI DetourGetAddrInfo(PCSTR pNodeName, PCSTR pServiceName,
             if (Core::Logger::IsEnabled(Core::LogLevel::Debug)) {
                 Core::Logger::Debug("拦截到域名解析: " + node);
             }
-            // 分配虚拟 IP，并让原始 getaddrinfo 生成结果结构（保证 freeaddrinfo 释放契约一致）
+            // 分配虚拟 IP：优先在进程内直接构造结果（块来自 AddrInfoPool，由 DetourFreeAddrInfo 归还）
             uint32_t fakeIp = Network::FakeIP::Instance().Alloc(node);
             if (fakeIp != 0) {
+                if (CanSynthesizeFakeIpResult(pServiceName != NULL, port) &&
+                    Network::AddrInfoBuilder::Build(Network::AddrInfoPool::Instance(), fakeIp, port, pHints,
+                                                    pNodeName, false, ppResult)) {
+                    return 0;
+                }
+                // 构造失败（服务名无法解析、非预期 family、池耗尽）：让原始 getaddrinfo 以虚拟 IP 字面量生成结果
                 std::string fakeIpStr = Network::FakeIP::IpToString(fakeIp);
 
                 // 兼容仅请求 IPv6 结果的调用方：返回 v4-mapped IPv6，避免 getaddrinfo 因 family 不匹配直接失败
@@ -2624,14 +3238,13 @@ int WSAAPI DetourGetAddrInfoW(PCWSTR pNodeName, PCWSTR pServiceName,
     // 如果启用了 FakeIP 且有域名请求
     if (pNodeName && config.fakeIp.enabled) {
         std::string nodeUtf8 = WideToUtf8(pNodeName);
-        std::string routeAction;
-        std::string routeRule;
         const uint16_t port = ParseServiceNameToPortW(pServiceName, "tcp");
-        const bool routeMatched = config.rules.MatchRouting(nodeUtf8, "", false, port, "tcp", &routeAction, &routeRule);
-        if (!routeAction.empty() && routeAction == "direct") {
+        const Core::RouteDecision route = MatchRouteCached(nodeUtf8, std::string_view(), false, port,
+                                                           Core::RouteProtocol::Tcp);
+        if (route.IsDirect()) {
             if (Core::Logger::IsEnabled(Core::LogLevel::Debug)) {
                 Core::Logger::Debug("[Route] DNS bypass FakeIP, rule=" +
-                                    std::string(routeMatched ? routeRule : "(default)") +
+                                    (route.Matched() ? config.rules.RouteRuleName(route) : std::string("(default)")) +
                                     ", host=" + nodeUtf8 +
                                     (port ? (":" + std::to_string(port)) : std::string("")));
             }
@@ -2642,9 +3255,15 @@ int WSAAPI DetourGetAddrInfoW(PCWSTR pNodeName, PCWSTR pServiceName,
             if (Core::Logger::IsEnabled(Core::LogLevel::Debug)) {
                 Core::Logger::Debug("拦截到域名解析(W): " + nodeUtf8);
             }
-            // 分配虚拟 IP，并让原始 GetAddrInfoW 生成结果结构（保证 FreeAddrInfoW/freeaddrinfo 契约一致）
+            // 分配虚拟 IP：优先在进程内直接构造结果（块来自 AddrInfoPool，由 DetourFreeAddrInfoW 归还）
             uint32_t fakeIp = Network::FakeIP::Instance().Alloc(nodeUtf8);
             if (fakeIp != 0) {
+                if (CanSynthesizeFakeIpResult(pServiceName != NULL, port) &&
+                    Network::AddrInfoBuilder::Build(Network::AddrInfoPool::Instance(), fakeIp, port, pHints,
+                                                    pNodeName, false, ppResult)) {
+                    return 0;
+                }
+                // 构造失败：让原始 GetAddrInfoW 以虚拟 IP 字面量生成结果
                 std::string fakeIpStr = Network::FakeIP::IpToString(fakeIp);
 
                 // 兼容仅请求 IPv6 结果的调用方：返回 v4-mapped IPv6，避免 GetAddrInfoW 因 family 不匹配直接失败
@@ -2673,19 +3292,31 @@ int WSAAPI DetourGetAddrInfoW(PCWSTR pNodeName, PCWSTR pServiceName,
     return fpGetAddrInfoW(pNodeName, pServiceName, pHints, ppResult);
 }
 
+// 本地构造的结果归还 AddrInfoPool，其余交给系统释放
+void WSAAPI DetourFreeAddrInfo(PADDRINFOA pAddrInfo) {
+    if (!pAddrInfo) return;
+    if (Network::AddrInfoPool::Instance().Release(pAddrInfo)) return;
+    if (fpFreeAddrInfo) fpFreeAddrInfo(pAddrInfo);
+}
+
+void WSAAPI DetourFreeAddrInfoW(PADDRINFOW pAddrInfo) {
+    if (!pAddrInfo) return;
+    if (Network::AddrInfoPool::Instance().Release(pAddrInfo)) return;
+    if (fpFreeAddrInfoW) fpFreeAddrInfoW(pAddrInfo);
+}
+
 struct hostent* WSAAPI DetourGetHostByName(const char* name) {
     auto& config = Core::Config::Instance();
     if (!fpGetHostByName) return NULL;
 
     if (name && config.fakeIp.enabled) {
         std::string node = name;
-        std::string routeAction;
-        std::string routeRule;
-        const bool routeMatched = config.rules.MatchRouting(node, "", false, 0, "tcp", &routeAction, &routeRule);
-        if (!routeAction.empty() && routeAction == "direct") {
+        const Core::RouteDecision route = MatchRouteCached(node, std::string_view(), false, 0,
+                                                           Core::RouteProtocol::Tcp);
+        if (route.IsDirect()) {
             if (Core::Logger::IsEnabled(Core::LogLevel::Debug)) {
                 Core::Logger::Debug("[Route] DNS bypass FakeIP, rule=" +
-                                    std::string(routeMatched ? routeRule : "(default)") +
+                                    (route.Matched() ? config.rules.RouteRuleName(route) : std::string("(default)")) +
                                     ", host=" + node);
             }
             return fpGetHostByName(name);
@@ -2696,8 +3327,8 @@ struct hostent* WSAAPI DetourGetHostByName(const char* name) {
             }
             uint32_t fakeIp = Network::FakeIP::Instance().Alloc(node);
             if (fakeIp != 0) {
-                std::string fakeIpStr = Network::FakeIP::IpToString(fakeIp);
-                return fpGetHostByName(fakeIpStr.c_str());
+                // 与 winsock 一致：结果位于线程局部缓冲，调用方不释放
+                return Network::AddrInfoBuilder::BuildHostEnt(fakeIp, name);
             }
         }
     }
@@ -2919,14 +3550,10 @@ BOOL PASCAL DetourConnectEx(
         return FALSE;
     }
     
-    // Hook 调用日志：仅在 Debug 下记录参数，避免热路径字符串拼接开销
-    if (Core::Logger::IsEnabled(Core::LogLevel::Debug)) {
-        const std::string dst = SockaddrToString(name);
-        Core::Logger::Debug("ConnectEx: 调用, sock=" + std::to_string((unsigned long long)s) +
-                            ", dst=" + (dst.empty() ? "(未知)" : dst) +
-                            ", send_len=" + std::to_string((unsigned long long)dwSendDataLength) +
-                            ", overlapped=" + std::to_string((unsigned long long)(ULONG_PTR)lpOverlapped));
-    }
+    // Hook 调用日志：仅在 Debug 下记录参数；开启 log_binary 时只记录原始参数，不做字符串拼接
+    AGP_LOG_DEBUG("ConnectEx: 调用, sock={}, dst={}, send_len={}, overlapped={}", (unsigned long long)s,
+                  Core::BinaryLogAddr{name}, (unsigned long long)dwSendDataLength,
+                  (unsigned long long)(ULONG_PTR)lpOverlapped);
 
     auto& config = Core::Config::Instance();
     LogRuntimeConfigSummaryOnce();
@@ -3058,14 +3685,13 @@ BOOL PASCAL DetourConnectEx(
     std::string addrIp;
     bool addrIsV6 = false;
     SockaddrToIp(name, &addrIp, &addrIsV6);
-    std::string routeAction;
-    std::string routeRule;
-    const bool routeMatched = config.rules.MatchRouting(originalHost, addrIp, addrIsV6, originalPort, "tcp",
-                                                        &routeAction, &routeRule);
-    if (!routeAction.empty() && routeAction == "direct") {
+    const Core::RouteDecision route = MatchRouteCached(originalHost, addrIp, addrIsV6, originalPort,
+                                                       Core::RouteProtocol::Tcp);
+    if (route.IsDirect()) {
         if (ShouldLogRouteDecisionInfo()) {
             Core::Logger::Info("[Route] direct" +
-                               std::string(routeMatched ? (" rule=" + routeRule) : " rule=(default)") +
+                               std::string(route.Matched() ? (" rule=" + config.rules.RouteRuleName(route))
+                                                           : " rule=(default)") +
                                ", target=" + originalHost + ":" + std::to_string(originalPort));
         }
         // CRIT-3: direct + FakeIP 兜底重解析，避免“直连虚拟地址”必失败
@@ -3086,9 +3712,9 @@ BOOL PASCAL DetourConnectEx(
                                originalHost + ":" + std::to_string(originalPort));
         }
         return originalConnectEx(s, name, namelen, lpSendBuffer, dwSendDataLength, lpdwBytesSent, lpOverlapped);
-    } else if (routeMatched) {
+    } else if (route.Matched()) {
         if (ShouldLogRouteDecisionInfo()) {
-            Core::Logger::Info("[Route] proxy rule=" + routeRule +
+            Core::Logger::Info("[Route] proxy rule=" + config.rules.RouteRuleName(route) +
                                ", target=" + originalHost + ":" + std::to_string(originalPort));
         }
     }
@@ -3248,7 +3874,22 @@ BOOL WINAPI DetourGetQueuedCompletionStatus(
         SetLastError(ERROR_INVALID_FUNCTION);
         return FALSE;
     }
-    BOOL result = fpGetQueuedCompletionStatus(CompletionPort, lpNumberOfBytes, lpCompletionKey, lpOverlapped, dwMilliseconds);
+    BOOL result = FALSE;
+    const ULONGLONG startTick = GetTickCount64();
+    DWORD waitMs = dwMilliseconds;
+    for (;;) {
+        result = fpGetQueuedCompletionStatus(CompletionPort, lpNumberOfBytes, lpCompletionKey, lpOverlapped, waitMs);
+        // 异步握手：截下 ConnectEx 完成事件，握手结束后会重新投递，这里继续等待下一个事件
+        if (!result || !lpOverlapped || !*lpOverlapped ||
+            !TryDeferConnectExCompletion(CompletionPort, lpCompletionKey ? *lpCompletionKey : 0, *lpOverlapped)) {
+            break;
+        }
+        if (!RemainingCompletionWaitMs(startTick, dwMilliseconds, &waitMs)) {
+            *lpOverlapped = NULL;
+            SetLastError(WAIT_TIMEOUT);
+            return FALSE;
+        }
+    }
     if (result && lpOverlapped && *lpOverlapped) {
         // FIX-1: 单事件版本 - result=TRUE 表示 IOCP 操作成功
         DWORD sentBytes = 0;
@@ -3293,10 +3934,34 @@ BOOL WINAPI DetourGetQueuedCompletionStatusEx(
     }
     
     // 调用原始函数获取批量 IOCP 事件
-    BOOL result = fpGetQueuedCompletionStatusEx(
-        CompletionPort, lpCompletionPortEntries, ulCount,
-        ulNumEntriesRemoved, dwMilliseconds, fAlertable
-    );
+    BOOL result = FALSE;
+    const ULONGLONG startTick = GetTickCount64();
+    DWORD waitMs = dwMilliseconds;
+    for (;;) {
+        result = fpGetQueuedCompletionStatusEx(
+            CompletionPort, lpCompletionPortEntries, ulCount,
+            ulNumEntriesRemoved, waitMs, fAlertable
+        );
+        if (!result || !lpCompletionPortEntries || !ulNumEntriesRemoved || *ulNumEntriesRemoved == 0) break;
+        // 异步握手：移除被截下的 ConnectEx 完成事件（握手结束后重新投递），其余事件保持顺序
+        ULONG kept = 0;
+        for (ULONG i = 0; i < *ulNumEntriesRemoved; i++) {
+            const OVERLAPPED_ENTRY& entry = lpCompletionPortEntries[i];
+            if (entry.lpOverlapped && entry.Internal == 0 &&
+                TryDeferConnectExCompletion(CompletionPort, entry.lpCompletionKey, entry.lpOverlapped)) {
+                continue;
+            }
+            if (kept != i) lpCompletionPortEntries[kept] = entry;
+            kept++;
+        }
+        *ulNumEntriesRemoved = kept;
+        if (kept > 0) break;
+        // 整批都被截下：在剩余时间内继续等待，避免向应用返回空批次
+        if (!RemainingCompletionWaitMs(startTick, dwMilliseconds, &waitMs)) {
+            SetLastError(WAIT_TIMEOUT);
+            return FALSE;
+        }
+    }
     
     if (result && lpCompletionPortEntries && ulNumEntriesRemoved && *ulNumEntriesRemoved > 0) {
         // FIX-1: 遍历所有完成的事件，检查 IOCP 完成状态后再处理
@@ -3591,11 +4256,19 @@ int WSAAPI DetourSend(SOCKET s, const char* buf, int len, int flags) {
 
     // UDP/QUIC：若该 UDP socket 已进入 udp_mode=proxy，则需要封装为 SOCKS5 UDP 报文
     if (config.proxy.port != 0 && config.rules.udp_mode == "proxy") {
-        int soType = 0;
-        if (TryGetSocketType(s, &soType) && soType == SOCK_DGRAM) {
-            std::string host;
-            uint16_t port = 0;
-            if (TryGetUdpProxyDefaultTarget(s, &host, &port) && !host.empty() && port != 0) {
+        // 快路径：一次查表拿到预编码的头（只有 UDP socket 才有 UDP 上下文，无需再 getsockopt(SO_TYPE)）；
+        // relay 已连接时不再复制 host 字符串、也不再 getsockname
+        uint8_t header[Network::Socks5::kMaxUdpHeaderBytes];
+        bool relayConnected = false;
+        size_t headerLen = LookupUdpProxyDefaultHeader(s, header, &relayConnected);
+        if (headerLen > 0) {
+            if (!relayConnected) {
+                std::string host;
+                uint16_t port = 0;
+                if (!TryGetUdpProxyDefaultTarget(s, &host, &port) || host.empty() || port == 0) {
+                    WSASetLastError(WSAECONNREFUSED);
+                    return SOCKET_ERROR;
+                }
                 sockaddr_storage local{};
                 int localLen = (int)sizeof(local);
                 const int family = (getsockname(s, (sockaddr*)&local, &localLen) == 0) ? (int)local.ss_family : AF_INET;
@@ -3603,21 +4276,15 @@ int WSAAPI DetourSend(SOCKET s, const char* buf, int len, int flags) {
                 if (!EnsureUdpProxyReady(s, family, host, port, true)) {
                     return SOCKET_ERROR;
                 }
+            }
 
-                std::vector<uint8_t> packet;
-                if (!Network::Socks5Udp::Wrap(host, port, (const uint8_t*)buf, (size_t)len, &packet)) {
-                    WSASetLastError(WSAECONNREFUSED);
-                    return SOCKET_ERROR;
-                }
-
-                if (!SendUdpPacketWithRetry(s, packet.data(), (int)packet.size(), flags, config.timeout.send_ms)) {
-                    return SOCKET_ERROR;
-                }
-
-                // 流量监控日志：记录用户 payload（不含 SOCKS5 UDP 头）
-                Network::TrafficMonitor::Instance().LogSend(s, buf, len);
-                return len;
+            if (!SendUdpGatherWithRetry(s, header, headerLen, buf, len, flags, config.timeout.send_ms)) {
+                return SOCKET_ERROR;
             }
+
+            // 流量监控日志：记录用户 payload（不含 SOCKS5 UDP 头）
+            Network::TrafficMonitor::Instance().LogSend(s, buf, len);
+            return len;
         }
     }
 
@@ -3631,35 +4298,19 @@ int WSAAPI DetourRecv(SOCKET s, char* buf, int len, int flags) {
 
     // UDP/QUIC：若该 UDP socket 已进入 udp_mode=proxy，则 recv 得到的是 SOCKS5 UDP Reply，需要解封装
     if (config.proxy.port != 0 && config.rules.udp_mode == "proxy") {
-        int soType = 0;
-        if (TryGetSocketType(s, &soType) && soType == SOCK_DGRAM) {
-            sockaddr_storage relay{};
-            int relayLen = 0;
-            if (TryGetUdpRelayAddr(s, &relay, &relayLen)) {
-                const int cap = len + (int)Network::Socks5Udp::kMaxUdpHeaderBytes;
-                std::vector<uint8_t> tmp;
-                tmp.resize(cap > 0 ? (size_t)cap : 0);
-
-                int rc = fpRecv(s, (char*)tmp.data(), (int)tmp.size(), flags);
-                if (rc <= 0) return rc;
-
-                Network::Socks5Udp::UnwrapResult unwrap{};
-                if (!Network::Socks5Udp::Unwrap(tmp.data(), (size_t)rc, &unwrap)) {
-                    WSASetLastError(WSAECONNRESET);
-                    return SOCKET_ERROR;
-                }
-
-                const size_t payloadLen = unwrap.payloadLen;
-                if ((int)payloadLen > len) {
-                    memcpy(buf, unwrap.payload, (size_t)len);
-                    WSASetLastError(WSAEMSGSIZE);
-                    return SOCKET_ERROR;
-                }
-
-                memcpy(buf, unwrap.payload, payloadLen);
+        if (IsUdpProxiedSocket(s)) {
+            WSABUF ub{};
+            ub.buf = buf;
+            ub.len = len > 0 ? (ULONG)len : 0;
+            DWORD wsaFlags = (DWORD)flags;
+            size_t payloadLen = 0;
+            if (RecvUdpProxyPayload(s, &ub, 1, &wsaFlags, nullptr, nullptr, &payloadLen) != 0) {
+                return SOCKET_ERROR;
+            }
+            if (payloadLen > 0) {
                 Network::TrafficMonitor::Instance().LogRecv(s, buf, (int)payloadLen);
-                return (int)payloadLen;
             }
+            return (int)payloadLen;
         }
     }
 
@@ -3680,11 +4331,18 @@ int WSAAPI DetourWSASend(
 
     // UDP/QUIC：connected UDP socket 可能走 WSASend，需要封装 SOCKS5 UDP 头
     if (config.proxy.port != 0 && config.rules.udp_mode == "proxy") {
-        int soType = 0;
-        if (TryGetSocketType(s, &soType) && soType == SOCK_DGRAM) {
-            std::string host;
-            uint16_t port = 0;
-            if (TryGetUdpProxyDefaultTarget(s, &host, &port) && !host.empty() && port != 0) {
+        // 一次查表拿到预编码的头；只有 relay 尚未连接时才走慢路径（复制目标、getsockname、connect relay）
+        uint8_t header[Network::Socks5::kMaxUdpHeaderBytes];
+        bool relayConnected = false;
+        const size_t headerLen = LookupUdpProxyDefaultHeader(s, header, &relayConnected);
+        if (headerLen > 0) {
+            if (!relayConnected) {
+                std::string host;
+                uint16_t port = 0;
+                if (!TryGetUdpProxyDefaultTarget(s, &host, &port) || host.empty() || port == 0) {
+                    WSASetLastError(WSAECONNREFUSED);
+                    return SOCKET_ERROR;
+                }
                 sockaddr_storage local{};
                 int localLen = (int)sizeof(local);
                 const int family = (getsockname(s, (sockaddr*)&local, &localLen) == 0) ? (int)local.ss_family : AF_INET;
@@ -3692,73 +4350,65 @@ int WSAAPI DetourWSASend(
                 if (!EnsureUdpProxyReady(s, family, host, port, true)) {
                     return SOCKET_ERROR;
                 }
+            }
 
-                std::vector<uint8_t> header;
-                if (!Network::Socks5Udp::Wrap(host, port, nullptr, 0, &header)) {
-                    WSASetLastError(WSAECONNREFUSED);
-                    return SOCKET_ERROR;
-                }
-
-                const DWORD userBytes = (DWORD)SumWsabufBytes(lpBuffers, dwBufferCount);
-
-                // 流量监控日志：记录用户 payload（不含 SOCKS5 UDP 头）
-                if (lpBuffers && dwBufferCount > 0) {
-                    Network::TrafficMonitor::Instance().LogSend(s, lpBuffers[0].buf, lpBuffers[0].len);
-                }
-
-                if (!lpOverlapped) {
-                    std::vector<WSABUF> bufs;
-                    bufs.reserve((size_t)dwBufferCount + 1);
-                    WSABUF h{};
-                    h.buf = (CHAR*)header.data();
-                    h.len = (ULONG)header.size();
-                    bufs.push_back(h);
-                    for (DWORD i = 0; i < dwBufferCount; ++i) {
-                        bufs.push_back(lpBuffers[i]);
-                    }
-                    int rc = fpWSASend(s, bufs.data(), (DWORD)bufs.size(), lpNumberOfBytesSent, dwFlags, NULL, NULL);
-                    if (rc == 0 && lpNumberOfBytesSent) {
-                        *lpNumberOfBytesSent = userBytes;
-                    }
-                    return rc;
-                }
+            const DWORD userBytes = (DWORD)SumWsabufBytes(lpBuffers, dwBufferCount);
 
-                auto ctx = std::make_shared<UdpOverlappedSendCtx>();
-                ctx->sock = s;
-                ctx->header = std::move(header);
-                ctx->userBytes = userBytes;
-                ctx->userBytesPtr = lpNumberOfBytesSent;
-                ctx->userCompletion = lpCompletionRoutine;
+            // 流量监控日志：记录用户 payload（不含 SOCKS5 UDP 头）
+            if (lpBuffers && dwBufferCount > 0) {
+                Network::TrafficMonitor::Instance().LogSend(s, lpBuffers[0].buf, lpBuffers[0].len);
+            }
 
-                ctx->bufs.reserve((size_t)dwBufferCount + 1);
+            if (!lpOverlapped) {
+                std::vector<WSABUF> bufs;
+                bufs.reserve((size_t)dwBufferCount + 1);
                 WSABUF h{};
-                h.buf = (CHAR*)ctx->header.data();
-                h.len = (ULONG)ctx->header.size();
-                ctx->bufs.push_back(h);
+                h.buf = (CHAR*)header;
+                h.len = (ULONG)headerLen;
+                bufs.push_back(h);
                 for (DWORD i = 0; i < dwBufferCount; ++i) {
-                    ctx->bufs.push_back(lpBuffers[i]);
+                    bufs.push_back(lpBuffers[i]);
                 }
-
-                {
-                    std::lock_guard<std::mutex> lock(g_udpOvlMtx);
-                    g_udpOvlSend[lpOverlapped] = ctx;
+                int rc = fpWSASend(s, bufs.data(), (DWORD)bufs.size(), lpNumberOfBytesSent, dwFlags, NULL, NULL);
+                if (rc == 0 && lpNumberOfBytesSent) {
+                    *lpNumberOfBytesSent = userBytes;
                 }
+                return rc;
+            }
 
-                const auto cb = lpCompletionRoutine ? UdpProxyCompletionRoutine : nullptr;
-                int rc = fpWSASend(s, ctx->bufs.data(), (DWORD)ctx->bufs.size(), lpNumberOfBytesSent, dwFlags, lpOverlapped, cb);
-                if (rc == SOCKET_ERROR) {
-                    int err = WSAGetLastError();
-                    if (err != WSA_IO_PENDING) {
-                        DropUdpOverlappedContext(lpOverlapped);
-                    } else {
-                        if (lpNumberOfBytesSent) *lpNumberOfBytesSent = 0;
-                    }
-                    WSASetLastError(err);
-                    return SOCKET_ERROR;
+            auto ctx = std::make_shared<UdpOverlappedSendCtx>();
+            ctx->sock = s;
+            memcpy(ctx->header, header, headerLen);
+            ctx->headerLen = headerLen;
+            ctx->userBytes = userBytes;
+            ctx->userBytesPtr = lpNumberOfBytesSent;
+            ctx->userCompletion = lpCompletionRoutine;
+
+            ctx->bufs.reserve((size_t)dwBufferCount + 1);
+            WSABUF h{};
+            h.buf = (CHAR*)ctx->header;
+            h.len = (ULONG)ctx->headerLen;
+            ctx->bufs.push_back(h);
+            for (DWORD i = 0; i < dwBufferCount; ++i) {
+                ctx->bufs.push_back(lpBuffers[i]);
+            }
+
+            SaveUdpOverlappedSend(lpOverlapped, ctx);
+
+            const auto cb = lpCompletionRoutine ? UdpProxyCompletionRoutine : nullptr;
+            int rc = fpWSASend(s, ctx->bufs.data(), (DWORD)ctx->bufs.size(), lpNumberOfBytesSent, dwFlags, lpOverlapped, cb);
+            if (rc == SOCKET_ERROR) {
+                int err = WSAGetLastError();
+                if (err != WSA_IO_PENDING) {
+                    DropUdpOverlappedContext(lpOverlapped);
+                } else {
+                    if (lpNumberOfBytesSent) *lpNumberOfBytesSent = 0;
                 }
-                if (lpNumberOfBytesSent) *lpNumberOfBytesSent = userBytes;
-                return rc;
+                WSASetLastError(err);
+                return SOCKET_ERROR;
             }
+            if (lpNumberOfBytesSent) *lpNumberOfBytesSent = userBytes;
+            return rc;
         }
     }
 
@@ -3779,87 +4429,56 @@ int WSAAPI DetourWSARecv(
 
     // UDP/QUIC：connected UDP socket 可能走 WSARecv，需要解封装 SOCKS5 UDP Reply
     if (config.proxy.port != 0 && config.rules.udp_mode == "proxy") {
-        int soType = 0;
-        if (TryGetSocketType(s, &soType) && soType == SOCK_DGRAM) {
-            sockaddr_storage relay{};
-            int relayLen = 0;
-            if (TryGetUdpRelayAddr(s, &relay, &relayLen)) {
-                const size_t userCap = SumWsabufBytes(lpBuffers, dwBufferCount);
-                const size_t cap = userCap + Network::Socks5Udp::kMaxUdpHeaderBytes;
-
-                if (!lpOverlapped) {
-                    std::vector<uint8_t> tmp;
-                    tmp.resize(cap);
-                    WSABUF ib{};
-                    ib.buf = (CHAR*)tmp.data();
-                    ib.len = (ULONG)tmp.size();
-
-                    DWORD bytes = 0;
-                    int rc = fpWSARecv(s, &ib, 1, &bytes, lpFlags, NULL, NULL);
-                    if (rc != 0) return rc;
-
-                    Network::Socks5Udp::UnwrapResult unwrap{};
-                    if (!Network::Socks5Udp::Unwrap(tmp.data(), (size_t)bytes, &unwrap)) {
-                        WSASetLastError(WSAECONNRESET);
-                        return SOCKET_ERROR;
-                    }
-
-                    const size_t copied = CopyBytesToWsabufs(unwrap.payload, unwrap.payloadLen, lpBuffers, dwBufferCount);
-                    if (lpNumberOfBytesRecvd) *lpNumberOfBytesRecvd = (DWORD)copied;
-                    if (copied < unwrap.payloadLen) {
-                        WSASetLastError(WSAEMSGSIZE);
-                        return SOCKET_ERROR;
-                    }
-                    if (lpBuffers && dwBufferCount > 0 && copied > 0) {
-                        Network::TrafficMonitor::Instance().LogRecv(s, lpBuffers[0].buf, (int)copied);
-                    }
-                    return 0;
+        if (IsUdpProxiedSocket(s)) {
+            if (!lpOverlapped) {
+                size_t copied = 0;
+                const int rc = RecvUdpProxyPayload(s, lpBuffers, dwBufferCount, lpFlags, nullptr, nullptr, &copied);
+                if (lpNumberOfBytesRecvd) *lpNumberOfBytesRecvd = (DWORD)copied;
+                if (rc != 0) return rc;
+                if (lpBuffers && dwBufferCount > 0 && copied > 0) {
+                    Network::TrafficMonitor::Instance().LogRecv(s, lpBuffers[0].buf, (int)copied);
                 }
+                return 0;
+            }
 
-                auto ctx = std::make_shared<UdpOverlappedRecvCtx>();
-                ctx->sock = s;
-                ctx->recvBuf.resize(cap);
-                ctx->userBufs = lpBuffers;
-                ctx->userBufCount = dwBufferCount;
-                ctx->userBytesPtr = lpNumberOfBytesRecvd;
-                ctx->userFlagsPtr = lpFlags;
-                ctx->userCompletion = lpCompletionRoutine;
+            auto ctx = std::make_shared<UdpOverlappedRecvCtx>();
+            ctx->sock = s;
+            ctx->userBufs = lpBuffers;
+            ctx->userBufCount = dwBufferCount;
+            ctx->userBytesPtr = lpNumberOfBytesRecvd;
+            ctx->userFlagsPtr = lpFlags;
+            ctx->userCompletion = lpCompletionRoutine;
 
-                WSABUF ib{};
-                ib.buf = (CHAR*)ctx->recvBuf.data();
-                ib.len = (ULONG)ctx->recvBuf.size();
+            WSABUF ib[2];
+            const DWORD ibCount = PrepareUdpOverlappedRecvBufs(ctx.get(), ib);
 
-                {
-                    std::lock_guard<std::mutex> lock(g_udpOvlMtx);
-                    g_udpOvlRecv[lpOverlapped] = ctx;
-                }
+            SaveUdpOverlappedRecv(lpOverlapped, ctx);
 
-                const auto cb = lpCompletionRoutine ? UdpProxyCompletionRoutine : nullptr;
-                int rc = fpWSARecv(s, &ib, 1, lpNumberOfBytesRecvd, lpFlags, lpOverlapped, cb);
-                if (rc == SOCKET_ERROR) {
-                    int err = WSAGetLastError();
-                    if (err != WSA_IO_PENDING) {
-                        DropUdpOverlappedContext(lpOverlapped);
-                    } else {
-                        if (lpNumberOfBytesRecvd) *lpNumberOfBytesRecvd = 0;
-                    }
-                    WSASetLastError(err);
-                    return SOCKET_ERROR;
+            const auto cb = lpCompletionRoutine ? UdpProxyCompletionRoutine : nullptr;
+            int rc = fpWSARecv(s, ib, ibCount, lpNumberOfBytesRecvd, lpFlags, lpOverlapped, cb);
+            if (rc == SOCKET_ERROR) {
+                int err = WSAGetLastError();
+                if (err != WSA_IO_PENDING) {
+                    DropUdpOverlappedContext(lpOverlapped);
+                } else {
+                    if (lpNumberOfBytesRecvd) *lpNumberOfBytesRecvd = 0;
                 }
+                WSASetLastError(err);
+                return SOCKET_ERROR;
+            }
 
-                // 立即完成：立刻解封装并回填用户 buffers（避免上层读到 SOCKS5 UDP 头）
-                if (lpNumberOfBytesRecvd) {
-                    DWORD userBytes = 0;
-                    const DWORD internalBytes = *lpNumberOfBytesRecvd;
-                    HandleUdpOverlappedCompletion(lpOverlapped, internalBytes, &userBytes);
-                    *lpNumberOfBytesRecvd = userBytes;
-                }
-                if (lpCompletionRoutine) {
-                    const DWORD cbFlags = lpFlags ? *lpFlags : 0;
-                    lpCompletionRoutine(0, lpNumberOfBytesRecvd ? *lpNumberOfBytesRecvd : 0, lpOverlapped, cbFlags);
-                }
-                return rc;
+            // 立即完成：立刻解封装并回填用户 buffers（避免上层读到 SOCKS5 UDP 头）
+            if (lpNumberOfBytesRecvd) {
+                DWORD userBytes = 0;
+                const DWORD internalBytes = *lpNumberOfBytesRecvd;
+                HandleUdpOverlappedCompletion(lpOverlapped, internalBytes, &userBytes);
+                *lpNumberOfBytesRecvd = userBytes;
             }
+            if (lpCompletionRoutine) {
+                const DWORD cbFlags = lpFlags ? *lpFlags : 0;
+                lpCompletionRoutine(0, lpNumberOfBytesRecvd ? *lpNumberOfBytesRecvd : 0, lpOverlapped, cbFlags);
+            }
+            return rc;
         }
     }
 
@@ -3881,44 +4500,38 @@ int WSAAPI DetourRecvFrom(SOCKET s, char* buf, int len, int flags, struct sockad
 
     auto& config = Core::Config::Instance();
     if (config.proxy.port != 0 && config.rules.udp_mode == "proxy") {
-        int soType = 0;
-        if (TryGetSocketType(s, &soType) && soType == SOCK_DGRAM) {
-            sockaddr_storage relay{};
-            int relayLen = 0;
-            if (TryGetUdpRelayAddr(s, &relay, &relayLen)) {
-                const int cap = len + (int)Network::Socks5Udp::kMaxUdpHeaderBytes;
-                std::vector<uint8_t> tmp;
-                tmp.resize(cap > 0 ? (size_t)cap : 0);
-
-                sockaddr_storage fromTmp{};
-                int fromTmpLen = (int)sizeof(fromTmp);
-                int rc = fpRecvFrom(s, (char*)tmp.data(), (int)tmp.size(), flags, (sockaddr*)&fromTmp, &fromTmpLen);
-                if (rc <= 0) return rc;
-
-                Network::Socks5Udp::UnwrapResult unwrap{};
-                if (!Network::Socks5Udp::Unwrap(tmp.data(), (size_t)rc, &unwrap)) {
-                    WSASetLastError(WSAECONNRESET);
-                    return SOCKET_ERROR;
-                }
-
+        if (IsUdpProxiedSocket(s)) {
+            WSABUF ub{};
+            ub.buf = buf;
+            ub.len = len > 0 ? (ULONG)len : 0;
+            DWORD wsaFlags = (DWORD)flags;
+            sockaddr_storage src{};
+            int srcLen = 0;
+            size_t payloadLen = 0;
+            const int rc = RecvUdpProxyPayload(s, &ub, 1, &wsaFlags, &src, &srcLen, &payloadLen);
+            if (rc != 0) {
+                const int err = WSAGetLastError();
+                if (err != WSAEMSGSIZE) return SOCKET_ERROR;
+                // 截断：与正常返回一样回填 from
                 if (fromlen) {
-                    if (unwrap.srcLen > 0) {
-                        FillUserSockaddr(from, fromlen, unwrap.src, unwrap.srcLen);
-                    } else {
-                        *fromlen = 0;
-                    }
+                    if (srcLen > 0) FillUserSockaddr(from, fromlen, src, srcLen);
+                    else *fromlen = 0;
                 }
+                WSASetLastError(err);
+                return SOCKET_ERROR;
+            }
 
-                if ((int)unwrap.payloadLen > len) {
-                    memcpy(buf, unwrap.payload, (size_t)len);
-                    WSASetLastError(WSAEMSGSIZE);
-                    return SOCKET_ERROR;
+            if (fromlen) {
+                if (srcLen > 0) {
+                    FillUserSockaddr(from, fromlen, src, srcLen);
+                } else {
+                    *fromlen = 0;
                 }
-
-                memcpy(buf, unwrap.payload, unwrap.payloadLen);
-                Network::TrafficMonitor::Instance().LogRecv(s, buf, (int)unwrap.payloadLen);
-                return (int)unwrap.payloadLen;
             }
+            if (payloadLen > 0) {
+                Network::TrafficMonitor::Instance().LogRecv(s, buf, (int)payloadLen);
+            }
+            return (int)payloadLen;
         }
     }
 
@@ -3939,100 +4552,74 @@ int WSAAPI DetourWSARecvFrom(
 
     auto& config = Core::Config::Instance();
     if (config.proxy.port != 0 && config.rules.udp_mode == "proxy") {
-        int soType = 0;
-        if (TryGetSocketType(s, &soType) && soType == SOCK_DGRAM) {
-            sockaddr_storage relay{};
-            int relayLen = 0;
-            if (TryGetUdpRelayAddr(s, &relay, &relayLen)) {
-                const size_t userCap = SumWsabufBytes(lpBuffers, dwBufferCount);
-                const size_t cap = userCap + Network::Socks5Udp::kMaxUdpHeaderBytes;
-
-                if (!lpOverlapped) {
-                    std::vector<uint8_t> tmp;
-                    tmp.resize(cap);
-                    WSABUF ib{};
-                    ib.buf = (CHAR*)tmp.data();
-                    ib.len = (ULONG)tmp.size();
-
-                    sockaddr_storage fromTmp{};
-                    int fromTmpLen = (int)sizeof(fromTmp);
-                    DWORD bytes = 0;
-                    int rc = fpWSARecvFrom(s, &ib, 1, &bytes, lpFlags, (sockaddr*)&fromTmp, &fromTmpLen, NULL, NULL);
-                    if (rc != 0) return rc;
-
-                    Network::Socks5Udp::UnwrapResult unwrap{};
-                    if (!Network::Socks5Udp::Unwrap(tmp.data(), (size_t)bytes, &unwrap)) {
-                        WSASetLastError(WSAECONNRESET);
-                        return SOCKET_ERROR;
-                    }
-
-                    const size_t copied = CopyBytesToWsabufs(unwrap.payload, unwrap.payloadLen, lpBuffers, dwBufferCount);
-                    if (lpNumberOfBytesRecvd) *lpNumberOfBytesRecvd = (DWORD)copied;
-                    if (lpFromlen) {
-                        if (unwrap.srcLen > 0) {
-                            FillUserSockaddr(lpFrom, lpFromlen, unwrap.src, unwrap.srcLen);
-                        } else {
-                            *lpFromlen = 0;
-                        }
-                    }
-                    if (copied < unwrap.payloadLen) {
-                        WSASetLastError(WSAEMSGSIZE);
-                        return SOCKET_ERROR;
-                    }
-                    if (lpBuffers && dwBufferCount > 0 && copied > 0) {
-                        Network::TrafficMonitor::Instance().LogRecv(s, lpBuffers[0].buf, (int)copied);
-                    }
-                    return 0;
-                }
-
-                auto ctx = std::make_shared<UdpOverlappedRecvCtx>();
-                ctx->sock = s;
-                ctx->recvBuf.resize(cap);
-                ctx->userBufs = lpBuffers;
-                ctx->userBufCount = dwBufferCount;
-                ctx->userBytesPtr = lpNumberOfBytesRecvd;
-                ctx->userFlagsPtr = lpFlags;
-                ctx->userFrom = lpFrom;
-                ctx->userFromLen = lpFromlen;
-                ctx->userCompletion = lpCompletionRoutine;
-
-                WSABUF ib{};
-                ib.buf = (CHAR*)ctx->recvBuf.data();
-                ib.len = (ULONG)ctx->recvBuf.size();
-
-                {
-                    std::lock_guard<std::mutex> lock(g_udpOvlMtx);
-                    g_udpOvlRecv[lpOverlapped] = ctx;
-                }
-
-                const auto cb = lpCompletionRoutine ? UdpProxyCompletionRoutine : nullptr;
-                int rc = fpWSARecvFrom(s, &ib, 1, lpNumberOfBytesRecvd, lpFlags,
-                                       (sockaddr*)&ctx->fromTmp, &ctx->fromTmpLen,
-                                       lpOverlapped, cb);
-                if (rc == SOCKET_ERROR) {
-                    int err = WSAGetLastError();
-                    if (err != WSA_IO_PENDING) {
-                        DropUdpOverlappedContext(lpOverlapped);
+        if (IsUdpProxiedSocket(s)) {
+            if (!lpOverlapped) {
+                sockaddr_storage src{};
+                int srcLen = 0;
+                size_t copied = 0;
+                const int rc = RecvUdpProxyPayload(s, lpBuffers, dwBufferCount, lpFlags, &src, &srcLen, &copied);
+                const int err = rc != 0 ? WSAGetLastError() : 0;
+                if (rc != 0 && err != WSAEMSGSIZE) return rc;
+                if (lpNumberOfBytesRecvd) *lpNumberOfBytesRecvd = (DWORD)copied;
+                if (lpFromlen) {
+                    if (srcLen > 0) {
+                        FillUserSockaddr(lpFrom, lpFromlen, src, srcLen);
                     } else {
-                        if (lpNumberOfBytesRecvd) *lpNumberOfBytesRecvd = 0;
+                        *lpFromlen = 0;
                     }
+                }
+                if (rc != 0) {
                     WSASetLastError(err);
                     return SOCKET_ERROR;
                 }
-
-                // 立即完成：立刻解封装并回填用户 buffers / from
-                if (lpNumberOfBytesRecvd) {
-                    DWORD userBytes = 0;
-                    const DWORD internalBytes = *lpNumberOfBytesRecvd;
-                    HandleUdpOverlappedCompletion(lpOverlapped, internalBytes, &userBytes);
-                    *lpNumberOfBytesRecvd = userBytes;
+                if (lpBuffers && dwBufferCount > 0 && copied > 0) {
+                    Network::TrafficMonitor::Instance().LogRecv(s, lpBuffers[0].buf, (int)copied);
                 }
-                if (lpCompletionRoutine) {
-                    const DWORD cbFlags = lpFlags ? *lpFlags : 0;
-                    lpCompletionRoutine(0, lpNumberOfBytesRecvd ? *lpNumberOfBytesRecvd : 0, lpOverlapped, cbFlags);
+                return 0;
+            }
+
+            auto ctx = std::make_shared<UdpOverlappedRecvCtx>();
+            ctx->sock = s;
+            ctx->userBufs = lpBuffers;
+            ctx->userBufCount = dwBufferCount;
+            ctx->userBytesPtr = lpNumberOfBytesRecvd;
+            ctx->userFlagsPtr = lpFlags;
+            ctx->userFrom = lpFrom;
+            ctx->userFromLen = lpFromlen;
+            ctx->userCompletion = lpCompletionRoutine;
+
+            WSABUF ib[2];
+            const DWORD ibCount = PrepareUdpOverlappedRecvBufs(ctx.get(), ib);
+
+            SaveUdpOverlappedRecv(lpOverlapped, ctx);
+
+            const auto cb = lpCompletionRoutine ? UdpProxyCompletionRoutine : nullptr;
+            int rc = fpWSARecvFrom(s, ib, ibCount, lpNumberOfBytesRecvd, lpFlags,
+                                   (sockaddr*)&ctx->fromTmp, &ctx->fromTmpLen,
+                                   lpOverlapped, cb);
+            if (rc == SOCKET_ERROR) {
+                int err = WSAGetLastError();
+                if (err != WSA_IO_PENDING) {
+                    DropUdpOverlappedContext(lpOverlapped);
+                } else {
+                    if (lpNumberOfBytesRecvd) *lpNumberOfBytesRecvd = 0;
                 }
-                return rc;
+                WSASetLastError(err);
+                return SOCKET_ERROR;
+            }
+
+            // 立即完成：立刻解封装并回填用户 buffers / from
+            if (lpNumberOfBytesRecvd) {
+                DWORD userBytes = 0;
+                const DWORD internalBytes = *lpNumberOfBytesRecvd;
+                HandleUdpOverlappedCompletion(lpOverlapped, internalBytes, &userBytes);
+                *lpNumberOfBytesRecvd = userBytes;
+            }
+            if (lpCompletionRoutine) {
+                const DWORD cbFlags = lpFlags ? *lpFlags : 0;
+                lpCompletionRoutine(0, lpNumberOfBytesRecvd ? *lpNumberOfBytesRecvd : 0, lpOverlapped, cbFlags);
             }
+            return rc;
         }
     }
 
@@ -4049,8 +4636,7 @@ int WSAAPI DetourSendTo(SOCKET s, const char* buf, int len, int flags, const str
 
     auto& config = Core::Config::Instance();
     if (config.proxy.port != 0) {
-        int soType = 0;
-        if (TryGetSocketType(s, &soType) && soType == SOCK_DGRAM) {
+        if (GetCachedSocketType(s) == SOCK_DGRAM) {
             sockaddr_storage peer{};
             int peerLen = (int)sizeof(peer);
             const sockaddr* dst = to;
@@ -4107,24 +4693,29 @@ int WSAAPI DetourSendTo(SOCKET s, const char* buf, int len, int flags, const str
                     }
                 }
 
-                if (!EnsureUdpProxyReady(s, family, host, port, true)) {
-                    if (config.rules.udp_fallback == "direct" && dst) {
-                        if (ShouldLogUdpProxyFail()) {
-                            const int err = WSAGetLastError();
-                            Core::Logger::Warn("sendto: UDP 代理失败，回退为 direct, sock=" + std::to_string((unsigned long long)s) +
-                                               ", target=" + host + ":" + std::to_string(port) +
-                                               ", WSA错误码=" + std::to_string(err));
+                // 快路径：relay 已连接时一次查表完成“更新 default target + 记录目标 + 拷出头”
+                uint8_t header[Network::Socks5::kMaxUdpHeaderBytes];
+                bool relayReady = false;
+                size_t headerLen = UpdateUdpSendTarget(s, host, port, header, &relayReady);
+                if (!relayReady) {
+                    if (!EnsureUdpProxyReady(s, family, host, port, true)) {
+                        if (config.rules.udp_fallback == "direct" && dst) {
+                            if (ShouldLogUdpProxyFail()) {
+                                const int err = WSAGetLastError();
+                                Core::Logger::Warn("sendto: UDP 代理失败，回退为 direct, sock=" + std::to_string((unsigned long long)s) +
+                                                   ", target=" + host + ":" + std::to_string(port) +
+                                                   ", WSA错误码=" + std::to_string(err));
+                            }
+                            CleanupUdpProxyContext(s);
+                            return fpSendTo(s, buf, len, flags, to, tolen);
                         }
-                        CleanupUdpProxyContext(s);
-                        return fpSendTo(s, buf, len, flags, to, tolen);
+                        return SOCKET_ERROR;
                     }
-                    return SOCKET_ERROR;
+                    headerLen = UpdateUdpProxyDefaultTarget(s, host, port, header);
+                    RememberSocketTarget(s, host, port);
                 }
-                UpdateUdpProxyDefaultTarget(s, host, port);
-                RememberSocketTarget(s, host, port);
 
-                std::vector<uint8_t> packet;
-                if (!Network::Socks5Udp::Wrap(host, port, (const uint8_t*)buf, (size_t)len, &packet)) {
+                if (headerLen == 0) {
                     if (config.rules.udp_fallback == "direct" && dst) {
                         if (ShouldLogUdpProxyFail()) {
                             Core::Logger::Warn("sendto: UDP 封装失败，回退为 direct, sock=" + std::to_string((unsigned long long)s) +
@@ -4137,9 +4728,7 @@ int WSAAPI DetourSendTo(SOCKET s, const char* buf, int len, int flags, const str
                     return SOCKET_ERROR;
                 }
 
-                int sent = fpSend ? fpSend(s, (const char*)packet.data(), (int)packet.size(), flags)
-                                  : send(s, (const char*)packet.data(), (int)packet.size(), flags);
-                if (sent == SOCKET_ERROR) {
+                if (!SendUdpGather(s, header, headerLen, buf, len, flags)) {
                     return SOCKET_ERROR;
                 }
                 return len; // 用户视角：仅 payload 长度
@@ -4164,8 +4753,7 @@ int WSAAPI DetourWSASendTo(
 
     auto& config = Core::Config::Instance();
     if (config.proxy.port != 0) {
-        int soType = 0;
-        if (TryGetSocketType(s, &soType) && soType == SOCK_DGRAM) {
+        if (GetCachedSocketType(s) == SOCK_DGRAM) {
             sockaddr_storage peer{};
             int peerLen = (int)sizeof(peer);
             const sockaddr* dst = lpTo;
@@ -4224,24 +4812,29 @@ int WSAAPI DetourWSASendTo(
                     }
                 }
 
-                if (!EnsureUdpProxyReady(s, family, host, port, true)) {
-                    if (config.rules.udp_fallback == "direct" && dst) {
-                        if (ShouldLogUdpProxyFail()) {
-                            const int err = WSAGetLastError();
-                            Core::Logger::Warn("WSASendTo: UDP 代理失败，回退为 direct, sock=" + std::to_string((unsigned long long)s) +
-                                               ", target=" + host + ":" + std::to_string(port) +
-                                               ", WSA错误码=" + std::to_string(err));
+                // 快路径：relay 已连接时一次查表完成“更新 default target + 记录目标 + 拷出头”
+                uint8_t header[Network::Socks5::kMaxUdpHeaderBytes];
+                bool relayReady = false;
+                size_t headerLen = UpdateUdpSendTarget(s, host, port, header, &relayReady);
+                if (!relayReady) {
+                    if (!EnsureUdpProxyReady(s, family, host, port, true)) {
+                        if (config.rules.udp_fallback == "direct" && dst) {
+                            if (ShouldLogUdpProxyFail()) {
+                                const int err = WSAGetLastError();
+                                Core::Logger::Warn("WSASendTo: UDP 代理失败，回退为 direct, sock=" + std::to_string((unsigned long long)s) +
+                                                   ", target=" + host + ":" + std::to_string(port) +
+                                                   ", WSA错误码=" + std::to_string(err));
+                            }
+                            CleanupUdpProxyContext(s);
+                            return fpWSASendTo(s, lpBuffers, dwBufferCount, lpNumberOfBytesSent, dwFlags, lpTo, iToLen, lpOverlapped, lpCompletionRoutine);
                         }
-                        CleanupUdpProxyContext(s);
-                        return fpWSASendTo(s, lpBuffers, dwBufferCount, lpNumberOfBytesSent, dwFlags, lpTo, iToLen, lpOverlapped, lpCompletionRoutine);
+                        return SOCKET_ERROR;
                     }
-                    return SOCKET_ERROR;
+                    headerLen = UpdateUdpProxyDefaultTarget(s, host, port, header);
+                    RememberSocketTarget(s, host, port);
                 }
-                UpdateUdpProxyDefaultTarget(s, host, port);
-                RememberSocketTarget(s, host, port);
 
-                std::vector<uint8_t> header;
-                if (!Network::Socks5Udp::Wrap(host, port, nullptr, 0, &header)) {
+                if (headerLen == 0) {
                     if (config.rules.udp_fallback == "direct" && dst) {
                         if (ShouldLogUdpProxyFail()) {
                             Core::Logger::Warn("WSASendTo: UDP 封装失败，回退为 direct, sock=" + std::to_string((unsigned long long)s) +
@@ -4261,8 +4854,8 @@ int WSAAPI DetourWSASendTo(
                     std::vector<WSABUF> bufs;
                     bufs.reserve((size_t)dwBufferCount + 1);
                     WSABUF h{};
-                    h.buf = (CHAR*)header.data();
-                    h.len = (ULONG)header.size();
+                    h.buf = (CHAR*)header;
+                    h.len = (ULONG)headerLen;
                     bufs.push_back(h);
                     for (DWORD i = 0; i < dwBufferCount; ++i) {
                         bufs.push_back(lpBuffers[i]);
@@ -4278,24 +4871,22 @@ int WSAAPI DetourWSASendTo(
                 // Overlapped：保存上下文，等待完成时修正 bytesTransferred
                 auto ctx = std::make_shared<UdpOverlappedSendCtx>();
                 ctx->sock = s;
-                ctx->header = std::move(header);
+                memcpy(ctx->header, header, headerLen);
+                ctx->headerLen = headerLen;
                 ctx->userBytes = userBytes;
                 ctx->userBytesPtr = lpNumberOfBytesSent;
                 ctx->userCompletion = lpCompletionRoutine;
 
                 ctx->bufs.reserve((size_t)dwBufferCount + 1);
                 WSABUF h{};
-                h.buf = (CHAR*)ctx->header.data();
-                h.len = (ULONG)ctx->header.size();
+                h.buf = (CHAR*)ctx->header;
+                h.len = (ULONG)ctx->headerLen;
                 ctx->bufs.push_back(h);
                 for (DWORD i = 0; i < dwBufferCount; ++i) {
                     ctx->bufs.push_back(lpBuffers[i]);
                 }
 
-                {
-                    std::lock_guard<std::mutex> lock(g_udpOvlMtx);
-                    g_udpOvlSend[lpOverlapped] = ctx;
-                }
+                SaveUdpOverlappedSend(lpOverlapped, ctx);
 
                 // 走 WSASend（socket 已 connect 到 relay）
                 const auto cb = lpCompletionRoutine ? UdpProxyCompletionRoutine : nullptr;
@@ -4371,6 +4962,20 @@ namespace Hooks {
             Core::Logger::Error("Hook GetAddrInfoW 失败");
         }
         
+        // Hook freeaddrinfo/FreeAddrInfoW（归还 FakeIP 本地构造的结果块）
+        bool freeHooked = true;
+        if (MH_CreateHookApi(L"ws2_32.dll", "freeaddrinfo",
+                             (LPVOID)DetourFreeAddrInfo, (LPVOID*)&fpFreeAddrInfo) != MH_OK) {
+            Core::Logger::Error("Hook freeaddrinfo 失败");
+            freeHooked = false;
+        }
+        if (MH_CreateHookApi(L"ws2_32.dll", "FreeAddrInfoW",
+                             (LPVOID)DetourFreeAddrInfoW, (LPVOID*)&fpFreeAddrInfoW) != MH_OK) {
+            Core::Logger::Error("Hook FreeAddrInfoW 失败");
+            freeHooked = false;
+        }
+        g_addrInfoFreeHooked.store(freeHooked, std::memory_order_release);
+        
         // Hook WSAConnectByNameA/W
         if (MH_CreateHookApi(L"ws2_32.dll", "WSAConnectByNameA", 
                              (LPVOID)DetourWSAConnectByNameA, (LPVOID*)&fpWSAConnectByNameA) != MH_OK) {
@@ -4479,35 +5084,51 @@ namespace Hooks {
     }
     
     void Uninstall() {
+        // 停止本地构造 addrinfo；已发出的池块仍需 hook 在位才能正确归还，DLL 按设计随进程常驻
+        g_addrInfoFreeHooked.store(false, std::memory_order_release);
         {
-            // 清理未完成的 ConnectEx 上下文，避免卸载后残留
-            std::lock_guard<std::mutex> lock(g_connectExMtx);
-            g_connectExPending.clear();
-        }
-        {
-            // 清理 UDP 代理上下文：关闭 SOCKS5 UDP Associate 控制连接
-            std::unordered_map<SOCKET, UdpProxyContext> tmp;
-            {
-                std::lock_guard<std::mutex> lock(g_udpProxyMtx);
-                tmp.swap(g_udpProxy);
+            const Network::DnsCache::Stats dns = Network::DnsCache::Instance().GetStats();
+            if (dns.hits + dns.negativeHits + dns.misses > 0) {
+                Core::Logger::Info("DNS 缓存统计: 命中=" + std::to_string(dns.hits) +
+                                   ", 负缓存命中=" + std::to_string(dns.negativeHits) +
+                                   ", 未命中=" + std::to_string(dns.misses) +
+                                   ", 提前刷新=" + std::to_string(dns.refreshes) +
+                                   ", 命中率=" + std::to_string((int)(dns.HitRate() * 100)) + "%");
             }
-            for (auto& kv : tmp) {
-                if (kv.second.controlSock != INVALID_SOCKET) {
-                    if (fpCloseSocket) fpCloseSocket(kv.second.controlSock);
-                    else closesocket(kv.second.controlSock);
-                }
-            }
-        }
-        {
-            // 清理 UDP Overlapped 上下文，避免卸载后泄漏
-            std::lock_guard<std::mutex> lock(g_udpOvlMtx);
-            g_udpOvlSend.clear();
-            g_udpOvlRecv.clear();
         }
+        if (auto* pool = g_warmPool.load(std::memory_order_acquire)) {
+            // 只关闭空闲连接并禁止补充，不 join 补充线程（Uninstall 可能在 DllMain 中执行）
+            const auto stats = pool->GetStats();
+            Core::Logger::Info("预连接池统计: 命中=" + std::to_string(stats.hits) +
+                               ", 未命中=" + std::to_string(stats.misses) +
+                               ", 建连=" + std::to_string(stats.dialed) +
+                               ", 建连失败=" + std::to_string(stats.dialFailures) +
+                               ", 过期=" + std::to_string(stats.expired) +
+                               ", 失效=" + std::to_string(stats.dead));
+            Network::WarmPool<SOCKET>::Options off;
+            off.maxIdle = 0;
+            pool->Configure(off);
+        }
+        if (auto* pool = g_udpAssocPool.load(std::memory_order_acquire)) {
+            const auto stats = pool->GetStats();
+            Core::Logger::Info("UDP Associate 预建池统计: 命中=" + std::to_string(stats.hits) +
+                               ", 未命中=" + std::to_string(stats.misses) +
+                               ", 建立=" + std::to_string(stats.dialed) +
+                               ", 建立失败=" + std::to_string(stats.dialFailures) +
+                               ", 过期=" + std::to_string(stats.expired) +
+                               ", 失效=" + std::to_string(stats.dead));
+            Network::WarmPool<UdpAssociation>::Options off;
+            off.maxIdle = 0;
+            pool->Configure(off);
+        }
+        // 清理未完成的 ConnectEx / UDP Overlapped 上下文，避免卸载后残留
+        g_pendingOverlapped.TakeAll();
         {
-            // 清理 socket -> 原始目标映射，避免卸载后残留
-            std::lock_guard<std::mutex> lock(g_socketTargetsMtx);
-            g_socketTargets.clear();
+            // 清理 socket 状态（目标映射、类型缓存、UDP 代理上下文）：在分片锁外关闭 SOCKS5 UDP Associate 控制连接
+            auto states = g_sockets.TakeAll();
+            for (auto& kv : states) {
+                if (kv.second.udp) CloseUdpControlSocket(kv.second.udp->controlSock);
+            }
         }
         {
             // 清理 ConnectEx Provider trampoline 映射，避免卸载后残留
@@ -4516,6 +5137,16 @@ namespace Hooks {
             g_connectExTrampolineByTarget.clear();
             fpConnectEx = NULL;
         }
+        {
+            const Core::RouteDecisionCache::Stats route = Core::RouteDecisionCache::Instance().GetStats();
+            const uint64_t lookups = route.hits + route.misses;
+            if (lookups > 0) {
+                Core::Logger::Info("路由决策缓存统计: 命中=" + std::to_string(route.hits) +
+                                   ", 未命中=" + std::to_string(route.misses) +
+                                   ", 淘汰=" + std::to_string(route.evictions) +
+                                   ", 命中率=" + std::to_string((int)(route.hits * 100 / lookups)) + "%");
+            }
+        }
         MH_DisableHook(MH_ALL_HOOKS);
         MH_Uninitialize();
     }
@@ -51,6 +51,7 @@ BOOL WINAPI DllMain(HINSTANCE hinstDLL, DWORD fdwReason, LPVOID lpvReserved) {
         Hooks::Uninstall();
         VersionProxy::Uninitialize();
         Core::Logger::Info("Antigravity-Proxy DLL 已卸载");
+        Core::Logger::Shutdown();
         break;
     }
     }
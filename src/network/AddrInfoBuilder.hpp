@@ -0,0 +1,245 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <new>
+#ifdef _WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#else
+#include <netdb.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#endif
+
+namespace Network {
+    // ============= FakeIP 解析结果的本地构造 =============
+    // 设计意图：FakeIP 命中后旧实现再调一次系统 getaddrinfo/gethostbyname（传入虚拟 IP 字面量）
+    // 只为让系统分配结果结构，每次拦截都多一趟系统解析器。这里直接在进程内构造：
+    // - addrinfo 链：整条链放在一个固定大小的块里（条目 + sockaddr + canonname），块来自 AddrInfoPool
+    // - freeaddrinfo / FreeAddrInfoW 被 hook：指针属于本池时归还到池，否则交给系统释放
+    // - hostent：与 winsock 语义一致，结果放在线程局部缓冲，下次同线程调用前有效，调用方不释放
+    // 构造失败（参数超出支持范围、池耗尽）时返回 false，调用方回退到原有的系统解析路径。
+    //
+    // 注意：池内存从不归还系统。hook 一旦装上即不卸载（DLL 随进程常驻），
+    // 因此不会出现“池块被系统 freeaddrinfo 释放”的情况。
+
+    // 固定大小块池：按 arena 批量分配，空闲块串成单链表；Owns 只做地址范围比较（无系统调用）
+    class AddrInfoPool {
+    public:
+        static constexpr size_t kBlockBytes = 2048;
+        static constexpr size_t kBlocksPerArena = 64;
+        static constexpr size_t kMaxArenas = 128; // 上限 16MB：调用方长期不释放时停止增长，回退系统解析
+
+        static AddrInfoPool& Instance() {
+            // 有意不析构：进程退出阶段仍可能有线程调用 freeaddrinfo
+            static AddrInfoPool* s_pool = new AddrInfoPool();
+            return *s_pool;
+        }
+
+        // 取一个清零的块；池已达上限时返回 nullptr
+        void* Acquire() {
+            FreeBlock* block = nullptr;
+            {
+                std::lock_guard<std::mutex> lock(m_mtx);
+                if (!m_free && !GrowLocked()) return nullptr;
+                block = m_free;
+                m_free = block->next;
+                m_inUse++;
+            }
+            std::memset(block, 0, kBlockBytes);
+            return block;
+        }
+
+        // 指针是本池某个块的起始地址时归还并返回 true；否则不处理，返回 false
+        bool Release(void* p) {
+            if (!Owns(p)) return false;
+            FreeBlock* block = static_cast<FreeBlock*>(p);
+            std::lock_guard<std::mutex> lock(m_mtx);
+            block->next = m_free;
+            m_free = block;
+            m_inUse--;
+            return true;
+        }
+
+        bool Owns(const void* p) const {
+            const uintptr_t addr = reinterpret_cast<uintptr_t>(p);
+            const size_t count = m_arenaCount.load(std::memory_order_acquire);
+            for (size_t i = 0; i < count; i++) {
+                const uintptr_t base = reinterpret_cast<uintptr_t>(m_arenas[i]);
+                if (addr >= base && addr < base + kBlockBytes * kBlocksPerArena) {
+                    return (addr - base) % kBlockBytes == 0;
+                }
+            }
+            return false;
+        }
+
+        size_t InUse() {
+            std::lock_guard<std::mutex> lock(m_mtx);
+            return m_inUse;
+        }
+
+    private:
+        struct FreeBlock {
+            FreeBlock* next;
+        };
+
+        bool GrowLocked() {
+            const size_t count = m_arenaCount.load(std::memory_order_relaxed);
+            if (count >= kMaxArenas) return false;
+            uint8_t* arena = new (std::nothrow) uint8_t[kBlockBytes * kBlocksPerArena];
+            if (!arena) return false;
+            for (size_t i = kBlocksPerArena; i-- > 0;) {
+                FreeBlock* block = reinterpret_cast<FreeBlock*>(arena + i * kBlockBytes);
+                block->next = m_free;
+                m_free = block;
+            }
+            m_arenas[count] = arena;
+            m_arenaCount.store(count + 1, std::memory_order_release); // 先写 arena 指针再发布数量
+            return true;
+        }
+
+        std::mutex m_mtx;
+        FreeBlock* m_free = nullptr;
+        size_t m_inUse = 0;
+        uint8_t* m_arenas[kMaxArenas] = {};
+        std::atomic<size_t> m_arenaCount{0};
+    };
+
+    class AddrInfoBuilder {
+    public:
+        // 每个结果最多的条目数（socktype 为 0 且 expandSockTypes 时展开为 TCP/UDP/RAW 三条）
+        static constexpr size_t kMaxEntries = 3;
+        // canonname 最多字符数（含结尾 0），超出时不构造
+        static constexpr size_t kMaxCanonChars = 256;
+
+        // 构造指向 ipv4（network order）的 addrinfo 链。
+        // - family：hints 为 AF_UNSPEC/AF_INET 时返回 IPv4；AF_INET6 时返回 v4-mapped IPv6（::ffff:a.b.c.d）
+        // - socktype/protocol 取自 hints；socktype 为 0 时 expandSockTypes=false 返回一条 socktype=0 的结果
+        //   （Windows 对数字地址的行为），为 true 时展开 TCP/UDP/RAW 三条（glibc 行为）
+        // - AI_CANONNAME：首条结果的 ai_canonname 为 canonName（通常是原始域名）
+        // 其他 family、超长 canonName 或池耗尽时返回 false（*out 不变）
+        template <typename AddrInfoT, typename CharT>
+        static bool Build(AddrInfoPool& pool, uint32_t ipv4, uint16_t port, const AddrInfoT* hints,
+                          const CharT* canonName, bool expandSockTypes, AddrInfoT** out) {
+            if (!out) return false;
+            const int family = hints ? hints->ai_family : AF_UNSPEC;
+            if (family != AF_UNSPEC && family != AF_INET && family != AF_INET6) return false;
+            const int flags = hints ? hints->ai_flags : 0;
+
+            int sockTypes[kMaxEntries] = {0};
+            int protocols[kMaxEntries] = {0};
+            size_t entries = 0;
+            const int hintType = hints ? hints->ai_socktype : 0;
+            const int hintProto = hints ? hints->ai_protocol : 0;
+            if (hintType != 0 || !expandSockTypes) {
+                sockTypes[0] = hintType;
+                protocols[0] = hintProto != 0 ? hintProto : DefaultProtocol(hintType);
+                entries = 1;
+            } else {
+                const int types[kMaxEntries] = {SOCK_STREAM, SOCK_DGRAM, SOCK_RAW};
+                for (int type : types) {
+                    // 指定了 protocol 时只保留与之匹配的类型（RAW 可承载任意协议）
+                    if (hintProto != 0 && type != SOCK_RAW && DefaultProtocol(type) != hintProto) continue;
+                    sockTypes[entries] = type;
+                    protocols[entries] = (type == SOCK_RAW) ? hintProto : DefaultProtocol(type);
+                    entries++;
+                }
+            }
+            if (entries == 0) return false;
+
+            size_t canonChars = 0;
+            if ((flags & AI_CANONNAME) && canonName) {
+                while (canonName[canonChars]) canonChars++;
+                canonChars++;
+                if (canonChars > kMaxCanonChars) return false;
+            }
+
+            const size_t addrBytes = (family == AF_INET6) ? sizeof(sockaddr_in6) : sizeof(sockaddr_in);
+            const size_t addrStride = AlignUp(addrBytes, alignof(sockaddr_in6));
+            const size_t entriesBytes = AlignUp(sizeof(AddrInfoT) * entries, alignof(sockaddr_in6));
+            static_assert(AlignUp(sizeof(AddrInfoT) * kMaxEntries, 16) + 32 * kMaxEntries +
+                              kMaxCanonChars * sizeof(CharT) <= AddrInfoPool::kBlockBytes,
+                          "AddrInfoPool 块容纳不下最大结果");
+
+            uint8_t* block = static_cast<uint8_t*>(pool.Acquire());
+            if (!block) return false;
+            AddrInfoT* infos = reinterpret_cast<AddrInfoT*>(block);
+            uint8_t* addrs = block + entriesBytes;
+            for (size_t i = 0; i < entries; i++) {
+                sockaddr* addr = reinterpret_cast<sockaddr*>(addrs + i * addrStride);
+                FillSockaddr(addr, family, ipv4, port);
+                AddrInfoT& ai = infos[i];
+                ai.ai_flags = 0;
+                ai.ai_family = (family == AF_INET6) ? AF_INET6 : AF_INET;
+                ai.ai_socktype = sockTypes[i];
+                ai.ai_protocol = protocols[i];
+                ai.ai_addrlen = static_cast<decltype(ai.ai_addrlen)>(addrBytes);
+                ai.ai_addr = addr;
+                ai.ai_canonname = nullptr;
+                ai.ai_next = (i + 1 < entries) ? &infos[i + 1] : nullptr;
+            }
+            if (canonChars) {
+                CharT* canon = reinterpret_cast<CharT*>(addrs + entries * addrStride);
+                std::memcpy(canon, canonName, canonChars * sizeof(CharT));
+                infos[0].ai_canonname = canon;
+            }
+            *out = infos;
+            return true;
+        }
+
+        // 构造 gethostbyname 风格的结果（线程局部缓冲，下次同线程调用前有效）。name 超长时截断
+        template <typename HostEntT = hostent>
+        static HostEntT* BuildHostEnt(uint32_t ipv4, const char* name) {
+            struct Storage {
+                HostEntT entry;
+                char* aliases[1];
+                char* addrList[2];
+                in_addr addr;
+                char name[kMaxCanonChars];
+            };
+            thread_local Storage t_storage;
+            Storage& s = t_storage;
+            std::memset(&s, 0, sizeof(s));
+            if (name) {
+                std::strncpy(s.name, name, sizeof(s.name) - 1);
+            }
+            s.addr.s_addr = ipv4;
+            s.addrList[0] = reinterpret_cast<char*>(&s.addr);
+            s.entry.h_name = s.name;
+            s.entry.h_aliases = s.aliases;
+            s.entry.h_addrtype = AF_INET;
+            s.entry.h_length = sizeof(in_addr);
+            s.entry.h_addr_list = s.addrList;
+            return &s.entry;
+        }
+
+    private:
+        static constexpr size_t AlignUp(size_t n, size_t align) { return (n + align - 1) & ~(align - 1); }
+
+        static int DefaultProtocol(int sockType) {
+            if (sockType == SOCK_STREAM) return IPPROTO_TCP;
+            if (sockType == SOCK_DGRAM) return IPPROTO_UDP;
+            return 0;
+        }
+
+        static void FillSockaddr(sockaddr* addr, int family, uint32_t ipv4, uint16_t port) {
+            if (family == AF_INET6) {
+                sockaddr_in6* in6 = reinterpret_cast<sockaddr_in6*>(addr);
+                in6->sin6_family = AF_INET6;
+                in6->sin6_port = htons(port);
+                uint8_t* bytes = reinterpret_cast<uint8_t*>(&in6->sin6_addr);
+                bytes[10] = 0xFF;
+                bytes[11] = 0xFF;
+                std::memcpy(bytes + 12, &ipv4, 4);
+            } else {
+                sockaddr_in* in4 = reinterpret_cast<sockaddr_in*>(addr);
+                in4->sin_family = AF_INET;
+                in4->sin_port = htons(port);
+                in4->sin_addr.s_addr = ipv4;
+            }
+        }
+    };
+}
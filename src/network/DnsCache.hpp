@@ -0,0 +1,414 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "../core/SingleFlight.hpp"
+#ifdef _WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#else
+#include <netdb.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#endif
+
+namespace Network {
+    // ============= 进程内 DNS 结果缓存（正/负缓存 + 热点提前刷新） =============
+    // 设计意图：direct + FakeIP 重解析、WSAConnectByName 走代理、代理主机名解析每次都同步调用系统
+    // getaddrinfo（IPv6 优先时还要串行两次），在连接风暴下是明显的阻塞点。这里按 (name, family)
+    // 缓存解析出的全部地址（端口为 0，取用时再填）：
+    // - 正缓存：ttlMs 内直接命中；系统 getaddrinfo 不暴露记录 TTL，统一使用配置的 TTL
+    // - 负缓存：解析失败（NXDOMAIN 等）在 negativeTtlMs 内直接返回同一错误码，避免反复打系统解析器；
+    //   EAI_AGAIN 是临时失败（解析器超时/暂不可用），不缓存，下一次访问直接重试
+    // - 提前刷新：热点条目（本轮命中 >= kHotHits）在过期前 refreshAheadMs 内被访问时，
+    //   交给后台线程重新解析并原地替换；刷新失败时保留旧结果直到过期
+    // - 有界：条目数超过 maxEntries 时先清过期条目，仍满则淘汰最早过期的条目
+    // - 合并：同一 (name, family) 的并发未命中只由一个线程调用解析后端，其余线程最多等待
+    //   coalesceWaitMs 后共享结果（超时/取消返回 EAI_AGAIN）；Configure/Clear/Stop 会取消在途等待
+    // 解析后端可注入（测试用假解析器；Hooks 中使用原始 getaddrinfo，绕开自身的 FakeIP hook）。
+    class DnsCache {
+    public:
+        // 返回 0 表示成功并填充 out（至少一个地址），否则返回 EAI_* 错误码
+        using Resolver = std::function<int(const std::string& name, int family, std::vector<sockaddr_storage>* out)>;
+        using NowFn = std::function<uint64_t()>;
+
+        static constexpr uint32_t kHotHits = 2;
+
+        struct Options {
+            bool enabled = true;
+            uint32_t ttlMs = 60000;
+            uint32_t negativeTtlMs = 5000;
+            uint32_t refreshAheadMs = 10000;
+            size_t maxEntries = 1024;
+            uint32_t coalesceWaitMs = 5000; // 0 表示不合并并发解析
+        };
+
+        struct Stats {
+            uint64_t hits = 0;
+            uint64_t negativeHits = 0;
+            uint64_t misses = 0;
+            uint64_t refreshes = 0;
+            uint64_t evictions = 0;
+            uint64_t coalesced = 0; // 未命中但复用了其他线程的在途解析
+
+            double HitRate() const {
+                const uint64_t total = hits + negativeHits + misses + coalesced;
+                return total ? (double)(hits + negativeHits) / (double)total : 0.0;
+            }
+        };
+
+        explicit DnsCache(Resolver resolver = Resolver(), NowFn now = NowFn())
+            : m_resolver(resolver ? std::move(resolver) : Resolver(&SystemResolve)),
+              m_now(now ? std::move(now) : NowFn(&SteadyNowMs)) {}
+
+        ~DnsCache() { Stop(); }
+
+        static DnsCache& Instance() {
+            // 有意不析构：后台刷新线程不在 DllMain 卸载阶段 join（loader lock 下等待线程会死锁）
+            static DnsCache* s_cache = new DnsCache();
+            return *s_cache;
+        }
+
+        // 应在首次解析前调用；resolver 为空时保持原后端
+        void Configure(const Options& options, Resolver resolver = Resolver()) {
+            std::lock_guard<std::mutex> lock(m_mtx);
+            m_options = options;
+            if (m_options.maxEntries == 0) m_options.maxEntries = 1;
+            if (resolver) m_resolver = std::move(resolver);
+            m_entries.clear();
+            m_flight.CancelAll();
+        }
+
+        // backgroundRefresh=false 时刷新请求只排队，由调用方 PumpRefresh 执行（测试用）
+        void SetBackgroundRefresh(bool enabled) {
+            std::lock_guard<std::mutex> lock(m_mtx);
+            m_backgroundRefresh = enabled;
+        }
+
+        // 解析 name 的首个地址并填入端口；outErr 在失败时为 EAI_* 错误码
+        bool Resolve(const std::string& name, int family, uint16_t port, sockaddr_storage* out, int* outLen,
+                     int* outErr) {
+            if (!out || !outLen) return false;
+            std::vector<sockaddr_storage> addrs;
+            if (!ResolveAll(name, family, &addrs, outErr)) return false;
+            *out = addrs.front();
+            SetPort(out, port);
+            *outLen = SockaddrLen(*out);
+            return true;
+        }
+
+        // 解析 name 的全部地址（端口为 0）；cancelToken 置位时放弃等待其他线程的在途解析
+        bool ResolveAll(const std::string& name, int family, std::vector<sockaddr_storage>* out, int* outErr,
+                        const std::atomic<bool>* cancelToken = nullptr) {
+            if (!out || name.empty()) return false;
+            const std::string key = MakeKey(name, family);
+            bool enabled = false;
+            uint32_t coalesceWaitMs = 0;
+            {
+                std::unique_lock<std::mutex> lock(m_mtx);
+                enabled = m_options.enabled;
+                coalesceWaitMs = m_options.coalesceWaitMs;
+                if (enabled) {
+                    auto it = m_entries.find(key);
+                    const uint64_t now = m_now();
+                    if (it != m_entries.end() && now < it->second.expiresAt) {
+                        Entry& e = it->second;
+                        if (e.error != 0) {
+                            m_negativeHits.fetch_add(1, std::memory_order_relaxed);
+                            if (outErr) *outErr = e.error;
+                            return false;
+                        }
+                        m_hits.fetch_add(1, std::memory_order_relaxed);
+                        e.hits++;
+                        *out = e.addrs;
+                        if (outErr) *outErr = 0;
+                        if (!e.refreshing && e.hits >= kHotHits && now + m_options.refreshAheadMs >= e.expiresAt) {
+                            e.refreshing = true;
+                            QueueRefreshLocked(key, name, family);
+                        }
+                        return true;
+                    }
+                }
+            }
+
+            auto lookup = [&]() {
+                Lookup result;
+                // 上一轮 leader 可能刚写回缓存并退出在途表：再查一次，避免紧随其后的调用方重复解析
+                if (enabled && PeekFresh(key, &result)) return result;
+                result.rc = CallResolver(name, family, &result.addrs);
+                if (enabled) Store(key, result.rc, result.addrs, false);
+                return result;
+            };
+            Lookup result;
+            if (coalesceWaitMs == 0) {
+                result = lookup();
+                if (enabled) m_misses.fetch_add(1, std::memory_order_relaxed);
+            } else {
+                switch (m_flight.Do(key, lookup, coalesceWaitMs, &result, cancelToken)) {
+                case Core::SingleFlight<Lookup>::Status::Leader:
+                    if (enabled) m_misses.fetch_add(1, std::memory_order_relaxed);
+                    break;
+                case Core::SingleFlight<Lookup>::Status::Shared:
+                    m_coalesced.fetch_add(1, std::memory_order_relaxed);
+                    break;
+                default:
+                    result.rc = EAI_AGAIN;
+                    break;
+                }
+            }
+            if (outErr) *outErr = result.rc;
+            if (result.rc != 0) return false;
+            *out = std::move(result.addrs);
+            return true;
+        }
+
+        // 执行排队中的刷新请求，返回执行条数
+        size_t PumpRefresh() {
+            size_t done = 0;
+            for (;;) {
+                RefreshTask task;
+                {
+                    std::lock_guard<std::mutex> lock(m_mtx);
+                    if (m_refreshQueue.empty()) break;
+                    task = std::move(m_refreshQueue.front());
+                    m_refreshQueue.pop_front();
+                }
+                RunRefresh(task);
+                done++;
+            }
+            return done;
+        }
+
+        Stats GetStats() const {
+            Stats s;
+            s.hits = m_hits.load(std::memory_order_relaxed);
+            s.negativeHits = m_negativeHits.load(std::memory_order_relaxed);
+            s.misses = m_misses.load(std::memory_order_relaxed);
+            s.refreshes = m_refreshes.load(std::memory_order_relaxed);
+            s.evictions = m_evictions.load(std::memory_order_relaxed);
+            s.coalesced = m_coalesced.load(std::memory_order_relaxed);
+            return s;
+        }
+
+        size_t Size() {
+            std::lock_guard<std::mutex> lock(m_mtx);
+            return m_entries.size();
+        }
+
+        void Clear() {
+            {
+                std::lock_guard<std::mutex> lock(m_mtx);
+                m_entries.clear();
+            }
+            m_flight.CancelAll();
+        }
+
+        // 丢弃排队的刷新、取消在途的合并等待，再 join 刷新线程（会阻塞，不可在 DllMain 中调用）
+        void Stop() {
+            {
+                std::lock_guard<std::mutex> lock(m_mtx);
+                m_stopping = true;
+                m_refreshQueue.clear();
+            }
+            m_cv.notify_all();
+            m_flight.CancelAll();
+            if (m_worker.joinable()) m_worker.join();
+        }
+
+        static int SockaddrLen(const sockaddr_storage& addr) {
+            return addr.ss_family == AF_INET6 ? (int)sizeof(sockaddr_in6) : (int)sizeof(sockaddr_in);
+        }
+
+        static void SetPort(sockaddr_storage* addr, uint16_t port) {
+            if (addr->ss_family == AF_INET6) {
+                reinterpret_cast<sockaddr_in6*>(addr)->sin6_port = htons(port);
+            } else {
+                reinterpret_cast<sockaddr_in*>(addr)->sin_port = htons(port);
+            }
+        }
+
+        // 默认后端：系统 getaddrinfo（仅 TCP 结果，去掉端口）
+        static int SystemResolve(const std::string& name, int family, std::vector<sockaddr_storage>* out) {
+            return ResolveWith(&::getaddrinfo, name, family, out);
+        }
+
+        // 以给定的 getaddrinfo 实现解析（Hooks 传入原始函数指针）
+        template <typename GetAddrInfoFn>
+        static int ResolveWith(GetAddrInfoFn fn, const std::string& name, int family,
+                               std::vector<sockaddr_storage>* out) {
+            addrinfo hints{};
+            hints.ai_family = family;
+            hints.ai_socktype = SOCK_STREAM;
+            hints.ai_protocol = IPPROTO_TCP;
+            addrinfo* res = nullptr;
+            const int rc = fn(name.c_str(), nullptr, &hints, &res);
+            if (rc != 0 || !res) {
+                if (res) freeaddrinfo(res);
+                return rc != 0 ? rc : EAI_FAIL;
+            }
+            for (const addrinfo* p = res; p; p = p->ai_next) {
+                if (!p->ai_addr || p->ai_addrlen <= 0 || p->ai_addrlen > sizeof(sockaddr_storage)) continue;
+                if (p->ai_family != AF_INET && p->ai_family != AF_INET6) continue;
+                sockaddr_storage addr{};
+                std::memcpy(&addr, p->ai_addr, p->ai_addrlen);
+                SetPort(&addr, 0);
+                out->push_back(addr);
+            }
+            freeaddrinfo(res);
+            return out->empty() ? EAI_FAIL : 0;
+        }
+
+    private:
+        struct Entry {
+            std::vector<sockaddr_storage> addrs;
+            int error = 0;
+            uint64_t expiresAt = 0;
+            uint32_t hits = 0;
+            bool refreshing = false;
+        };
+
+        struct Lookup {
+            int rc = EAI_FAIL;
+            std::vector<sockaddr_storage> addrs;
+        };
+
+        struct RefreshTask {
+            std::string key;
+            std::string name;
+            int family = 0;
+        };
+
+        static uint64_t SteadyNowMs() {
+            return (uint64_t)std::chrono::duration_cast<std::chrono::milliseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count();
+        }
+
+        static std::string MakeKey(const std::string& name, int family) {
+            std::string key = std::to_string(family);
+            key.push_back('|');
+            key.reserve(key.size() + name.size());
+            for (char c : name) key.push_back((c >= 'A' && c <= 'Z') ? (char)(c - 'A' + 'a') : c);
+            return key;
+        }
+
+        bool PeekFresh(const std::string& key, Lookup* out) {
+            std::lock_guard<std::mutex> lock(m_mtx);
+            auto it = m_entries.find(key);
+            if (it == m_entries.end() || m_now() >= it->second.expiresAt) return false;
+            out->rc = it->second.error;
+            out->addrs = it->second.addrs;
+            return true;
+        }
+
+        int CallResolver(const std::string& name, int family, std::vector<sockaddr_storage>* out) {
+            Resolver resolver;
+            {
+                std::lock_guard<std::mutex> lock(m_mtx);
+                resolver = m_resolver;
+            }
+            const int rc = resolver(name, family, out);
+            if (rc == 0 && out->empty()) return EAI_FAIL;
+            return rc;
+        }
+
+        // refresh=true：刷新失败不覆盖仍有效的正缓存
+        void Store(const std::string& key, int rc, const std::vector<sockaddr_storage>& addrs, bool refresh) {
+            std::lock_guard<std::mutex> lock(m_mtx);
+            const uint64_t now = m_now();
+            auto it = m_entries.find(key);
+            if (refresh) {
+                if (it == m_entries.end()) return; // 刷新期间被 Clear/淘汰
+                it->second.refreshing = false;
+                if (rc != 0) return;
+            }
+            if (rc == EAI_AGAIN) return;
+            if (it == m_entries.end()) {
+                if (m_entries.size() >= m_options.maxEntries) EvictLocked(now);
+                it = m_entries.emplace(key, Entry()).first;
+            }
+            Entry& e = it->second;
+            e.error = rc;
+            e.addrs = (rc == 0) ? addrs : std::vector<sockaddr_storage>();
+            e.expiresAt = now + (rc == 0 ? m_options.ttlMs : m_options.negativeTtlMs);
+            e.hits = 0;
+            e.refreshing = false;
+        }
+
+        void EvictLocked(uint64_t now) {
+            for (auto it = m_entries.begin(); it != m_entries.end();) {
+                if (now >= it->second.expiresAt && !it->second.refreshing) {
+                    it = m_entries.erase(it);
+                    m_evictions.fetch_add(1, std::memory_order_relaxed);
+                } else {
+                    ++it;
+                }
+            }
+            if (m_entries.size() < m_options.maxEntries) return;
+            auto oldest = m_entries.begin();
+            for (auto it = m_entries.begin(); it != m_entries.end(); ++it) {
+                if (it->second.expiresAt < oldest->second.expiresAt) oldest = it;
+            }
+            m_entries.erase(oldest);
+            m_evictions.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        void QueueRefreshLocked(const std::string& key, const std::string& name, int family) {
+            if (m_stopping) return;
+            m_refreshQueue.push_back(RefreshTask{key, name, family});
+            if (!m_backgroundRefresh) return;
+            if (!m_worker.joinable()) {
+                m_worker = std::thread([this]() { WorkerLoop(); });
+            }
+            m_cv.notify_one();
+        }
+
+        void WorkerLoop() {
+            for (;;) {
+                RefreshTask task;
+                {
+                    std::unique_lock<std::mutex> lock(m_mtx);
+                    m_cv.wait(lock, [this]() { return m_stopping || !m_refreshQueue.empty(); });
+                    if (m_stopping) return;
+                    task = std::move(m_refreshQueue.front());
+                    m_refreshQueue.pop_front();
+                }
+                RunRefresh(task);
+            }
+        }
+
+        void RunRefresh(const RefreshTask& task) {
+            std::vector<sockaddr_storage> addrs;
+            const int rc = CallResolver(task.name, task.family, &addrs);
+            m_refreshes.fetch_add(1, std::memory_order_relaxed);
+            Store(task.key, rc, addrs, true);
+        }
+
+        std::mutex m_mtx;
+        std::condition_variable m_cv;
+        Options m_options;
+        Resolver m_resolver;
+        NowFn m_now;
+        std::unordered_map<std::string, Entry> m_entries;
+        std::deque<RefreshTask> m_refreshQueue;
+        Core::SingleFlight<Lookup> m_flight;
+        std::thread m_worker;
+        bool m_backgroundRefresh = true;
+        bool m_stopping = false;
+
+        std::atomic<uint64_t> m_hits{0};
+        std::atomic<uint64_t> m_negativeHits{0};
+        std::atomic<uint64_t> m_misses{0};
+        std::atomic<uint64_t> m_refreshes{0};
+        std::atomic<uint64_t> m_evictions{0};
+        std::atomic<uint64_t> m_coalesced{0};
+    };
+}
@@ -1,6 +1,5 @@
 #pragma once
 #include <string>
-#include <unordered_map>
 #include <mutex>
 #include <vector>
 #include <winsock2.h>
@@ -14,129 +13,98 @@
 #include <cstdint>
 #include "../core/Config.hpp"
 #include "../core/Logger.hpp"
+#include "FakeIpTable.hpp"
+#include "FakeIpShared.hpp"
+#include "SharedMemory.hpp"
 
 namespace Network {
     
     // FakeIP 管理器 (Ring Buffer 策略)
     // 默认使用 198.18.0.0/15 (保留用于基准测试的网络，不容易冲突)
+    // 并发模型：Alloc/回填为单写者（m_mtx 串行化）；IsFakeIP/GetDomain 命中路径不加锁
     class FakeIP {
-        std::unordered_map<uint32_t, std::string> m_ipToDomain;  // IP(host order) -> Domain
-        std::unordered_map<std::string, uint32_t> m_domainToIp;  // Domain -> IP(host order)
-        std::mutex m_mtx;
+        FakeIpSlotTable m_slots;   // 偏移(ip - baseIp) <-> Domain（稠密槽位 + arena + 开放寻址正向索引）
+        std::mutex m_mtx;          // 写端锁：Alloc / 共享映射回填
         std::once_flag m_initOnce; // 用于线程安全的延迟初始化（避免 m_initialized 数据竞争）
         
+        // 以下三项仅在 m_initOnce 内写入，之后只读（call_once 保证对后续调用方可见）
         uint32_t m_baseIp;      // 网段起始 IP (host order)
         uint32_t m_mask;        // 子网掩码 (host order)
-        uint32_t m_networkSize; // 可用 IP 数量
-        uint32_t m_cursor;      // 当前分配游标 (0 ~ networkSize-1)
+        uint32_t m_networkSize; // 可用 IP 数量（受槽位表上限约束）
+        uint32_t m_cursor;      // 当前分配游标 (0 ~ networkSize-1)，受 m_mtx 保护
 
-        // ============= 跨进程共享映射（最佳努力） =============
-        static constexpr uint32_t kSharedMagic = 0x4650494D; // "FIPM"
-        static constexpr uint32_t kSharedCapacity = 4096;
-        static constexpr size_t kSharedDomainMax = 255;
-        static constexpr const char* kSharedMapName = "Local\\AntigravityProxy_FakeIP_Map";
-        static constexpr const char* kSharedMutexName = "Local\\AntigravityProxy_FakeIP_Mutex";
+        // ============= 跨进程共享映射（最佳努力，无跨进程锁） =============
+        // 布局、顺序锁协议与崩溃语义见 FakeIpShared.hpp；布局变更时同步修改段名前缀，避免与旧版本 DLL 混用同一段。
+        // 段名带容量后缀：fake_ip.shared_capacity 不同的进程各用各的段，不会因布局不一致而退化
+        static constexpr const char* kSharedMapPrefix = "Local\\AntigravityProxy_FakeIP_Map_v4_";
 
-        struct SharedEntry {
-            uint32_t ip;       // host order
-            uint64_t tick;     // 最近写入时间（GetTickCount64）
-            char domain[kSharedDomainMax + 1];
-        };
-
-        struct SharedTable {
-            uint32_t magic;
-            uint32_t capacity;
-            uint32_t cursor;
-            uint32_t reserved;
-            SharedEntry entries[kSharedCapacity];
-        };
-
-        HANDLE m_sharedMap = NULL;
-        HANDLE m_sharedMutex = NULL;
-        SharedTable* m_shared = nullptr;
+        SharedMemoryRegion m_sharedRegion;
+        SharedFakeIpTable m_shared;
         std::once_flag m_sharedOnce;
 
-        bool LockShared() {
-            if (!m_sharedMutex) return false;
-            DWORD wait = WaitForSingleObject(m_sharedMutex, INFINITE);
-            return (wait == WAIT_OBJECT_0 || wait == WAIT_ABANDONED);
-        }
-
-        void UnlockShared() {
-            if (m_sharedMutex) ReleaseMutex(m_sharedMutex);
+        // 文件支持的共享映射（fake_ip.shared_file）：唯一使用者负责校验/重建文件，然后降级为共享锁
+        bool AttachSharedFile(const std::string& path, uint32_t capacity) {
+            bool exclusive = false;
+            const size_t bytes = SharedFakeIpTable::FileBytesFor(capacity);
+            if (!m_sharedRegion.OpenFile(path, bytes, &exclusive)) {
+                Core::Logger::Warn("FakeIP: 共享映射文件打开失败或容量与其他进程不一致 (" + path + ")，改用命名共享段");
+                return false;
+            }
+            const bool attached = m_shared.AttachFile(m_sharedRegion.Data(), bytes, capacity, exclusive);
+            m_sharedRegion.DowngradeToShared();
+            if (!attached) {
+                m_sharedRegion.Close();
+                Core::Logger::Warn("FakeIP: 共享映射文件格式不匹配且被其他进程占用 (" + path + ")，改用命名共享段");
+                return false;
+            }
+            Core::Logger::Info("FakeIP: 共享映射使用文件 " + path + " (容量=" + std::to_string(capacity) +
+                               (exclusive ? ", 首个使用者" : "") + ")");
+            return true;
         }
 
         void EnsureSharedInitialized() {
             std::call_once(m_sharedOnce, [this]() {
-                m_sharedMutex = CreateMutexA(NULL, FALSE, kSharedMutexName);
-                const bool locked = LockShared();
-
-                m_sharedMap = CreateFileMappingA(
-                    INVALID_HANDLE_VALUE, NULL, PAGE_READWRITE, 0,
-                    static_cast<DWORD>(sizeof(SharedTable)), kSharedMapName
-                );
-                if (!m_sharedMap) {
-                    if (locked) UnlockShared();
-                    return;
-                }
-                DWORD mapErr = GetLastError();
-                m_shared = (SharedTable*)MapViewOfFile(m_sharedMap, FILE_MAP_ALL_ACCESS, 0, 0, sizeof(SharedTable));
-                if (!m_shared) {
-                    CloseHandle(m_sharedMap);
-                    m_sharedMap = NULL;
-                    if (locked) UnlockShared();
-                    return;
-                }
+                const auto& config = Core::Config::Instance().fakeIp;
+                const uint32_t capacity = config.shared_capacity;
+                if (!config.shared_file.empty() && AttachSharedFile(config.shared_file, capacity)) return;
 
-                const bool needInit = (mapErr != ERROR_ALREADY_EXISTS) ||
-                                      (m_shared->magic != kSharedMagic) ||
-                                      (m_shared->capacity != kSharedCapacity);
-                if (needInit) {
-                    std::memset(m_shared, 0, sizeof(SharedTable));
-                    m_shared->magic = kSharedMagic;
-                    m_shared->capacity = kSharedCapacity;
-                    m_shared->cursor = 0;
+                bool created = false;
+                const size_t bytes = SharedFakeIpTable::RequiredBytes(capacity);
+                const std::string name = kSharedMapPrefix + std::to_string(capacity);
+                if (!m_sharedRegion.Open(name, bytes, &created)) return;
+                if (!m_shared.Attach(m_sharedRegion.Data(), bytes, capacity)) {
+                    m_sharedRegion.Close();
+                    Core::Logger::Warn("FakeIP: 跨进程共享映射布局不匹配或初始化超时，仅使用本进程映射");
                 }
-
-                if (locked) UnlockShared();
             });
         }
 
         void SharedPut(uint32_t ipHostOrder, const std::string& domain) {
             if (domain.empty()) return;
             EnsureSharedInitialized();
-            if (!m_shared) return;
-            if (!LockShared()) return;
-            uint32_t idx = m_shared->cursor++ % kSharedCapacity;
-            SharedEntry& entry = m_shared->entries[idx];
-            entry.ip = ipHostOrder;
-            entry.tick = GetTickCount64();
-            std::memset(entry.domain, 0, sizeof(entry.domain));
-            const size_t n = (domain.size() < kSharedDomainMax) ? domain.size() : kSharedDomainMax;
-            if (n > 0) {
-                std::memcpy(entry.domain, domain.data(), n);
-                entry.domain[n] = '\0';
-            }
-            UnlockShared();
+            if (!m_shared.IsAttached()) return;
+            m_shared.Put(ipHostOrder, domain, m_shared.NextStamp());
+        }
+
+        // 域名在共享映射中已有地址（其他进程分配，或文件模式下上次运行分配）时返回其偏移，
+        // 让同一域名跨进程/跨重启保持同一个 FakeIP
+        bool SharedFindOffset(const std::string& domain, uint32_t* outOffset) {
+            EnsureSharedInitialized();
+            if (!m_shared.IsAttached()) return false;
+            uint32_t ip = 0;
+            if (!m_shared.FindDomain(domain, &ip)) return false;
+            if ((ip & m_mask) != m_baseIp) return false;
+            const uint32_t offset = ip - m_baseIp;
+            if (offset == 0 || offset >= m_networkSize - 1) return false;
+            *outOffset = offset;
+            return true;
         }
 
         std::string SharedGet(uint32_t ipHostOrder) {
             EnsureSharedInitialized();
-            if (!m_shared) return "";
-            if (!LockShared()) return "";
-            const SharedEntry* best = nullptr;
-            uint64_t bestTick = 0;
-            for (uint32_t i = 0; i < kSharedCapacity; i++) {
-                const SharedEntry& entry = m_shared->entries[i];
-                if (entry.ip == ipHostOrder && entry.domain[0] != '\0') {
-                    if (entry.tick >= bestTick) {
-                        bestTick = entry.tick;
-                        best = &entry;
-                    }
-                }
-            }
-            std::string result = best ? std::string(best->domain) : "";
-            UnlockShared();
+            if (!m_shared.IsAttached()) return "";
+            std::string result;
+            m_shared.Get(ipHostOrder, &result);
             return result;
         }
 
@@ -165,6 +133,12 @@ namespace Network {
                     ParseCidr("198.18.0.0/15", m_baseIp, m_mask);
                     m_networkSize = ~m_mask + 1;
                 }
+                // 超大网段（/1 ~ /7）只使用前 kMaxSlots 个地址，避免槽位页表过大
+                if (m_networkSize > FakeIpSlotTable::kMaxSlots) {
+                    m_networkSize = FakeIpSlotTable::kMaxSlots;
+                    Core::Logger::Warn("FakeIP: 网段过大，仅使用前 " + std::to_string(m_networkSize) + " 个地址");
+                }
+                m_slots.Reset(m_networkSize);
             });
         }
 
@@ -218,10 +192,9 @@ namespace Network {
             EnsureInitialized();
         }
 
-        // FIX-3: 检查是否为虚拟 IP（加锁保护，避免与初始化/分配操作产生 data race）
+        // FIX-3: 检查是否为虚拟 IP（base/mask 初始化后不变，call_once 已建立可见性，无需加锁）
         bool IsFakeIP(uint32_t ipNetworkOrder) {
             EnsureInitialized();
-            std::lock_guard<std::mutex> lock(m_mtx);
             uint32_t ip = ntohl(ipNetworkOrder);
             return (ip & m_mask) == m_baseIp;
         }
@@ -230,48 +203,71 @@ namespace Network {
         // 返回网络字节序 IP
         uint32_t Alloc(const std::string& domain) {
             EnsureInitialized();
+            const uint32_t domainHash = FakeIpSlotTable::HashDomain(domain);
+            uint32_t existing = 0;
+
+            // 0. 无锁快路径：同一域名的并发解析（浏览器连接风暴）命中时不进入写端锁
+            if (m_slots.TryFindDomain(domain, domainHash, &existing)) {
+                const uint32_t existingIp = m_baseIp | existing;
+                if (Core::Logger::IsEnabled(Core::LogLevel::Debug)) {
+                    Core::Logger::Debug("FakeIP: 命中 " + domain + " -> " + IpToString(htonl(existingIp)));
+                }
+                return htonl(existingIp);
+            }
+
             std::lock_guard<std::mutex> lock(m_mtx);
             
-            // 1. 如果已存在映射，直接返回
-            auto it = m_domainToIp.find(domain);
-            if (it != m_domainToIp.end()) {
+            // 1. 如果已存在映射，直接返回（哈希只算一次，查询与登记共用）
+            if (m_slots.FindDomain(domain, domainHash, &existing)) {
                 // 可选：更新 LRU？Ring Buffer 不需要 LRU，由于空间只要够大，复用率低
+                const uint32_t existingIp = m_baseIp | existing;
                 if (Core::Logger::IsEnabled(Core::LogLevel::Debug)) {
-                    Core::Logger::Debug("FakeIP: 命中 " + domain + " -> " + IpToString(htonl(it->second)));
+                    Core::Logger::Debug("FakeIP: 命中 " + domain + " -> " + IpToString(htonl(existingIp)));
                 }
-                return htonl(it->second);
+                return htonl(existingIp);
             }
             
             // 2. 分配新 IP
+            if (domain.empty() || domain.size() > FakeIpSlotTable::kDomainMax) {
+                Core::Logger::Warn("FakeIP: 域名为空或超长 (len=" + std::to_string(domain.size()) + ")，不分配");
+                return 0;
+            }
             if (m_networkSize <= 2) {
                 // 防御性检查：网段过小会导致无法分配（此处记录告警便于排障）
                 Core::Logger::Warn("FakeIP: 地址池过小，无法分配 (networkSize=" + std::to_string(m_networkSize) + ")");
                 return 0;
             }
 
-            // 游标移动
-            uint32_t offset = m_cursor++;
-            // 简单的 Ring Buffer: 超过范围回到 1
-            if (m_cursor >= m_networkSize - 1) { 
-                m_cursor = 1; 
-                Core::Logger::Debug("FakeIP: 地址池循环回绕");
+            // 共享映射里已有该域名且本进程对应槽位空闲：沿用同一地址（不移动游标）
+            uint32_t offset = 0;
+            char probe[FakeIpSlotTable::kDomainMax + 8];
+            if (!SharedFindOffset(domain, &offset) || m_slots.WriterRead(offset, probe) != 0) {
+                // 游标移动
+                offset = m_cursor++;
+                // 简单的 Ring Buffer: 超过范围回到 1
+                if (m_cursor >= m_networkSize - 1) { 
+                    m_cursor = 1; 
+                    Core::Logger::Debug("FakeIP: 地址池循环回绕");
+                }
             }
 
             uint32_t newIp = m_baseIp | offset;
 
-            // 3. 检查并清理旧映射 (Collision handling)
-            auto oldIt = m_ipToDomain.find(newIp);
-            if (oldIt != m_ipToDomain.end()) {
-                // 把旧域名从反向表中移除
-                m_domainToIp.erase(oldIt->second);
-                if (Core::Logger::IsEnabled(Core::LogLevel::Debug)) {
-                    Core::Logger::Debug("FakeIP: 回收 " + IpToString(htonl(newIp)) + " (原域名: " + oldIt->second + ")");
+            // 3. 检查旧映射 (Collision handling)：Publish 会把旧域名从正向索引中移除
+            if (Core::Logger::IsEnabled(Core::LogLevel::Debug)) {
+                char oldBuf[FakeIpSlotTable::kDomainMax + 8];
+                const size_t oldLen = m_slots.WriterRead(offset, oldBuf);
+                if (oldLen > 0) {
+                    Core::Logger::Debug("FakeIP: 回收 " + IpToString(htonl(newIp)) + " (原域名: " +
+                                        std::string(oldBuf, oldLen) + ")");
                 }
             }
 
-            // 4. 建立新映射
-            m_ipToDomain[newIp] = domain;
-            m_domainToIp[domain] = newIp;
+            // 4. 建立新映射（槽位与正向索引一并更新）
+            if (!m_slots.Publish(offset, domain, domainHash)) {
+                Core::Logger::Warn("FakeIP: 槽位写入失败 (内存不足?)，不分配 " + domain);
+                return 0;
+            }
 
             // 同步写入跨进程共享映射，降低多进程 miss 概率
             SharedPut(newIp, domain);
@@ -282,25 +278,33 @@ namespace Network {
             return htonl(newIp);
         }
         
-        // 根据虚拟 IP 获取域名
+        // 根据虚拟 IP 获取域名（命中路径无锁；共享映射命中后才进入写端锁回填）
         std::string GetDomain(uint32_t ipNetworkOrder) {
             EnsureInitialized();
-            std::lock_guard<std::mutex> lock(m_mtx);
             uint32_t ip = ntohl(ipNetworkOrder);
-            
-            auto it = m_ipToDomain.find(ip);
-            if (it != m_ipToDomain.end()) {
-                if (Core::Logger::IsEnabled(Core::LogLevel::Debug)) {
-                    Core::Logger::Debug("FakeIP: 查询命中 " + IpToString(ipNetworkOrder) + " -> " + it->second);
+            const bool inPool = ((ip & m_mask) == m_baseIp) && (ip - m_baseIp) < m_slots.SlotCount();
+            const uint32_t offset = ip - m_baseIp;
+
+            if (inPool) {
+                std::string domain;
+                if (m_slots.Read(offset, &domain)) {
+                    if (Core::Logger::IsEnabled(Core::LogLevel::Debug)) {
+                        Core::Logger::Debug("FakeIP: 查询命中 " + IpToString(ipNetworkOrder) + " -> " + domain);
+                    }
+                    return domain;
                 }
-                return it->second;
             }
 
-            // 本进程未命中时，尝试从跨进程共享映射回填
+            // 本进程未命中时，尝试从跨进程共享映射回填（共享表无锁读取，只有回填需要写端锁）
             std::string sharedDomain = SharedGet(ip);
             if (!sharedDomain.empty()) {
-                m_ipToDomain[ip] = sharedDomain;
-                m_domainToIp[sharedDomain] = ip;
+                if (inPool) {
+                    std::lock_guard<std::mutex> lock(m_mtx);
+                    // 加锁前可能已有 Alloc 写入该槽位，此时以本进程映射为准
+                    std::string current;
+                    if (m_slots.Read(offset, &current)) return current;
+                    m_slots.Publish(offset, sharedDomain);
+                }
                 if (Core::Logger::IsEnabled(Core::LogLevel::Debug)) {
                     Core::Logger::Debug("FakeIP: 共享映射命中 " + IpToString(ipNetworkOrder) + " -> " + sharedDomain);
                 }
@@ -0,0 +1,381 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <thread>
+
+namespace Network {
+    // ============= FakeIP 跨进程共享表（哈希索引 + 顺序锁，无跨进程互斥） =============
+    // 设计意图：子进程刚注入时本地 FakeIP 表为空，每次本地未命中都要查共享表；
+    // 旧实现在命名互斥锁内线性扫描 4096 条 × 272 字节（约 1.1MB），且以 INFINITE 等待，
+    // 任一进程卡死/崩溃在锁内都会拖住所有进程的 DNS。这里改为：
+    // - 共享段内附带两张组相联索引（IP -> 条目、域名哈希 -> 条目），查询只触及 1~2 条缓存行
+    // - 条目仍为 Ring Buffer：写者以原子 fetch-add 领取游标，覆盖最旧条目
+    // - 每个条目带序号（seq）：写者 CAS 偶数 -> 奇数占有条目，写完置为下一个偶数；
+    //   读者读前读后 seq 一致且为偶数才采信，否则重试（有上限）
+    // - 索引槽保存 {条目 seq, 条目下标 + 1}（64 位），以 CAS 更新，不做删除：条目被覆盖后
+    //   seq 变化，旧索引自然失配；带 seq 比较可避免两个写者对同一槽位的 ABA 覆盖导致丢映射
+    // - 同一 IP 多条有效记录时取 tick 最大者（与旧版线性扫描的“最新写入优先”一致）
+    // - 桶满时挤掉 tick 最小的记录：该记录提前查不到，效果等同于被 Ring Buffer 淘汰
+    //
+    // 进程在写入中途崩溃：该条目 seq 停留在奇数。读者重试若干次后把它当作无效条目跳过
+    // （等同未命中，不会读到半截域名）；写者领取到奇数条目时跳过并继续领取下一个。
+    // 代价是该条目在共享段生命周期内不再可用（容量中少一条），所有进程退出、
+    // 命名段释放后自然恢复（文件持久化模式下保留到文件重建）。初始化同理：初始化者崩溃
+    // 会使 state 停在“初始化中”，其他进程等待超时后放弃共享映射（仅退化为本进程映射，
+    // 不影响 DNS）；文件模式下下一个独占打开者会重建文件。
+    //
+    // 共享段中的 std::atomic 依赖“无锁原子 + 全零即有效初值”，两者在 x86/x64 上均成立。
+    //
+    // tick 取自头部的逻辑时钟（NextStamp），随表一起保存：文件持久化模式下重启后时钟
+    // 接着递增，不会出现“开机时间归零导致新记录比旧记录 tick 小”的问题。
+    // 文件持久化模式在表前再加一个独立的文件头（见 AttachFile）。
+    class SharedFakeIpTable {
+    public:
+        static constexpr uint32_t kMagic = 0x32504946; // "FIP2"
+        static constexpr uint32_t kVersion = 3;
+        static constexpr size_t kDomainMax = 255;
+        static constexpr uint32_t kWays = 8; // 每桶 64 字节，恰好一条缓存行
+
+        static_assert(std::atomic<uint32_t>::is_always_lock_free, "共享段要求 32 位原子无锁");
+        static_assert(std::atomic<uint64_t>::is_always_lock_free, "共享段要求 64 位原子无锁");
+
+        struct Entry {
+            std::atomic<uint32_t> seq;        // 偶数：稳定；奇数：写入中（或写者已崩溃）
+            std::atomic<uint32_t> ip;         // host order；0 表示空条目
+            std::atomic<uint32_t> domainHash; // FNV-1a 32
+            std::atomic<uint32_t> domainLen;
+            std::atomic<uint64_t> tick;       // 最近写入序号（调用方提供，通常取 NextStamp()）
+            std::atomic<uint64_t> words[(kDomainMax + 1) / 8];
+        };
+
+        struct Header {
+            std::atomic<uint32_t> state; // 0 未初始化 / 1 初始化中 / 2 就绪
+            uint32_t magic;
+            uint32_t version;
+            uint32_t capacity;
+            uint32_t bucketCount;
+            std::atomic<uint32_t> cursor;
+            std::atomic<uint64_t> clock;     // 逻辑时钟，见 NextStamp
+            uint32_t reserved[8];
+        };
+        static_assert(sizeof(Header) == 64, "共享段头部须保持 64 字节");
+
+        // ============= 文件持久化布局（fake_ip.shared_file） =============
+        // 文件 = 64 字节文件头 + 与命名段完全相同的表区域。文件头有自己的 magic/版本，
+        // 与表头版本（kVersion）相互独立：任一不符时，由独占打开者重建整个文件
+        struct FileHeader {
+            uint64_t magic;
+            uint32_t version;
+            uint32_t capacity;
+            uint64_t tableBytes;
+            uint64_t reserved[5];
+        };
+        static_assert(sizeof(FileHeader) == 64, "文件头须保持 64 字节");
+        static constexpr uint64_t kFileMagic = 0x50414D5049464741ull; // "AGFIPMAP"
+        static constexpr uint32_t kFileVersion = 1;
+
+        static uint32_t BucketCountFor(uint32_t capacity) {
+            // 索引槽约为条目数的 4 倍（平均每桶 2 条）：4096 条时整表期望溢出桶数 < 1
+            uint32_t buckets = 1;
+            while ((uint64_t)buckets * kWays < (uint64_t)capacity * 4) buckets <<= 1;
+            return buckets;
+        }
+
+        static size_t RequiredBytes(uint32_t capacity) {
+            const size_t buckets = BucketCountFor(capacity);
+            return sizeof(Header) + buckets * kWays * sizeof(uint64_t) * 2 + (size_t)capacity * sizeof(Entry);
+        }
+
+        static size_t FileBytesFor(uint32_t capacity) { return sizeof(FileHeader) + RequiredBytes(capacity); }
+
+        // 条目数组在段内的位置（布局唯一来源，测试也用它模拟崩溃写者）
+        static Entry* EntriesOf(void* base, uint32_t capacity) {
+            const size_t buckets = BucketCountFor(capacity);
+            return reinterpret_cast<Entry*>(static_cast<uint8_t*>(base) + sizeof(Header) +
+                                            buckets * kWays * sizeof(uint64_t) * 2);
+        }
+
+        static uint32_t HashDomain(std::string_view domain) {
+            uint32_t h = 2166136261u;
+            for (char c : domain) {
+                h ^= static_cast<uint8_t>(c);
+                h *= 16777619u;
+            }
+            return h;
+        }
+
+        // 绑定到一段共享内存（新建段须为全 0）。第一个到达者完成初始化，其余进程等待就绪；
+        // 头部与期望布局不一致时拒绝绑定（不在他人使用中重建）
+        bool Attach(void* base, size_t bytes, uint32_t capacity) {
+            m_header = nullptr;
+            if (!base || capacity == 0 || bytes < RequiredBytes(capacity)) return false;
+            Header* header = static_cast<Header*>(base);
+            const uint32_t buckets = BucketCountFor(capacity);
+
+            uint32_t state = 0;
+            if (header->state.compare_exchange_strong(state, 1, std::memory_order_acq_rel)) {
+                header->magic = kMagic;
+                header->version = kVersion;
+                header->capacity = capacity;
+                header->bucketCount = buckets;
+                header->state.store(2, std::memory_order_release);
+            } else {
+                // 初始化只是几次写入；等待有上限，防止初始化者崩溃导致永久阻塞
+                for (int i = 0; i < 100000 && header->state.load(std::memory_order_acquire) != 2; i++) {
+                    std::this_thread::yield();
+                }
+                if (header->state.load(std::memory_order_acquire) != 2) return false;
+            }
+            if (header->magic != kMagic || header->version != kVersion || header->capacity != capacity ||
+                header->bucketCount != buckets) {
+                return false;
+            }
+
+            m_header = header;
+            m_ipBuckets = reinterpret_cast<std::atomic<uint64_t>*>(header + 1);
+            m_domainBuckets = m_ipBuckets + (size_t)buckets * kWays;
+            m_entries = EntriesOf(base, capacity);
+            m_capacity = capacity;
+            m_bucketMask = buckets - 1;
+            return true;
+        }
+
+        // 绑定到文件映射（大小须为 FileBytesFor(capacity)）。exclusive 表示调用方是文件的唯一使用者：
+        // 此时文件头/表头任一不符（新文件、旧版本、容量变化、上次初始化中途崩溃）都会清零重建；
+        // 非独占时只校验，不符则拒绝绑定。打开已有文件只读头部，不扫描条目，代价与容量无关
+        bool AttachFile(void* base, size_t bytes, uint32_t capacity, bool exclusive) {
+            m_header = nullptr;
+            if (!base || capacity == 0 || bytes != FileBytesFor(capacity)) return false;
+            FileHeader* file = static_cast<FileHeader*>(base);
+            const size_t tableBytes = bytes - sizeof(FileHeader);
+            const bool fileOk = file->magic == kFileMagic && file->version == kFileVersion &&
+                                file->capacity == capacity && file->tableBytes == tableBytes;
+            if (fileOk && Attach(file + 1, tableBytes, capacity)) return true;
+            if (!exclusive) return false;
+
+            std::memset(base, 0, bytes);
+            file->version = kFileVersion;
+            file->capacity = capacity;
+            file->tableBytes = tableBytes;
+            file->magic = kFileMagic; // 最后写 magic：重建中途崩溃时下次仍判定为无效
+            return Attach(file + 1, tableBytes, capacity);
+        }
+
+        bool IsAttached() const { return m_header != nullptr; }
+
+        // 领取下一个写入序号（全表单调递增，跨进程、跨重启有效）
+        uint64_t NextStamp() { return m_header ? m_header->clock.fetch_add(1, std::memory_order_relaxed) + 1 : 0; }
+
+        // 写入 ip -> domain；同一 (ip, domain) 已是最新记录时只刷新 tick，不占用新条目。
+        // 连续领取到被占用的条目（写者崩溃遗留）超过上限时放弃本次写入，返回 false
+        bool Put(uint32_t ip, std::string_view domain, uint64_t tick) {
+            if (!m_header || ip == 0 || domain.empty()) return false;
+            if (domain.size() > kDomainMax) domain = domain.substr(0, kDomainMax);
+            const uint32_t domainHash = HashDomain(domain);
+
+            Snapshot snap;
+            const uint32_t existing = FindDomainSlot(domain, domainHash, &snap);
+            if (existing != kNone && snap.ip == ip && FindIpSlot(ip, nullptr) == existing &&
+                RefreshTick(existing, snap.seq, tick)) {
+                return true;
+            }
+
+            for (int attempt = 0; attempt < kPutAttempts; attempt++) {
+                const uint32_t slot = m_header->cursor.fetch_add(1, std::memory_order_relaxed) % m_capacity;
+                Entry& e = m_entries[slot];
+                uint32_t seq = e.seq.load(std::memory_order_relaxed);
+                if ((seq & 1) || !e.seq.compare_exchange_strong(seq, seq + 1, std::memory_order_acquire)) continue;
+                std::atomic_thread_fence(std::memory_order_release);
+
+                e.ip.store(ip, std::memory_order_relaxed);
+                e.domainHash.store(domainHash, std::memory_order_relaxed);
+                e.domainLen.store(static_cast<uint32_t>(domain.size()), std::memory_order_relaxed);
+                e.tick.store(tick, std::memory_order_relaxed);
+                const size_t wordCount = (domain.size() + 7) / 8;
+                for (size_t i = 0; i < wordCount; i++) {
+                    uint64_t w = 0;
+                    const size_t n = (domain.size() - i * 8 < 8) ? (domain.size() - i * 8) : 8;
+                    std::memcpy(&w, domain.data() + i * 8, n);
+                    e.words[i].store(w, std::memory_order_relaxed);
+                }
+                e.seq.store(seq + 2, std::memory_order_release);
+
+                const uint64_t ref = ((uint64_t)(seq + 2) << 32) | (slot + 1);
+                IndexInsert(m_ipBuckets + (size_t)BucketOfIp(ip) * kWays, ref, tick,
+                            [&](const Snapshot& other) { return other.ip == ip; },
+                            [&](const Snapshot& other) { return BucketOfIp(other.ip) == BucketOfIp(ip); });
+                IndexInsert(m_domainBuckets + (size_t)(domainHash & m_bucketMask) * kWays, ref, tick,
+                            [&](const Snapshot& other) {
+                                return other.domainHash == domainHash && other.Domain() == domain;
+                            },
+                            [&](const Snapshot& other) {
+                                return (other.domainHash & m_bucketMask) == (domainHash & m_bucketMask);
+                            });
+                return true;
+            }
+            return false;
+        }
+
+        // 查询 ip 对应的最新域名
+        bool Get(uint32_t ip, std::string* out) const {
+            Snapshot snap;
+            if (FindIpSlot(ip, &snap) == kNone) return false;
+            out->assign(snap.domain, snap.domainLen);
+            return true;
+        }
+
+        // 查询 domain 最近一次写入的 ip
+        bool FindDomain(std::string_view domain, uint32_t* outIp) const {
+            if (domain.size() > kDomainMax) domain = domain.substr(0, kDomainMax);
+            Snapshot snap;
+            if (FindDomainSlot(domain, HashDomain(domain), &snap) == kNone) return false;
+            *outIp = snap.ip;
+            return true;
+        }
+
+        uint32_t Capacity() const { return m_header ? m_capacity : 0; }
+
+    private:
+        static constexpr uint32_t kNone = UINT32_MAX;
+        static constexpr int kPutAttempts = 8;
+        static constexpr int kReadAttempts = 64;
+
+        // 条目的一致性快照（seq 校验通过后的私有副本）
+        struct Snapshot {
+            uint32_t seq = 0;
+            uint32_t ip = 0;
+            uint32_t domainHash = 0;
+            uint32_t domainLen = 0;
+            uint64_t tick = 0;
+            char domain[kDomainMax + 8];
+
+            std::string_view Domain() const { return std::string_view(domain, domainLen); }
+        };
+
+        uint32_t BucketOfIp(uint32_t ip) const {
+            uint32_t h = ip * 2654435761u;
+            h ^= h >> 16;
+            return h & m_bucketMask;
+        }
+
+        // 顺序锁读取；条目长期处于奇数（写入中或写者已崩溃）时返回 false
+        bool ReadEntry(uint32_t slot, Snapshot* out) const {
+            const Entry& e = m_entries[slot];
+            for (int attempt = 0; attempt < kReadAttempts; attempt++) {
+                const uint32_t before = e.seq.load(std::memory_order_acquire);
+                if ((before & 1) == 0) {
+                    out->seq = before;
+                    out->ip = e.ip.load(std::memory_order_relaxed);
+                    out->domainHash = e.domainHash.load(std::memory_order_relaxed);
+                    out->tick = e.tick.load(std::memory_order_relaxed);
+                    uint32_t len = e.domainLen.load(std::memory_order_relaxed);
+                    if (len > kDomainMax) len = kDomainMax; // 撕裂读取时的防御，随后 seq 校验会丢弃
+                    out->domainLen = len;
+                    for (size_t i = 0; i < (len + 7) / 8; i++) {
+                        const uint64_t w = e.words[i].load(std::memory_order_relaxed);
+                        std::memcpy(out->domain + i * 8, &w, 8);
+                    }
+                    std::atomic_thread_fence(std::memory_order_acquire);
+                    if (e.seq.load(std::memory_order_relaxed) == before) return true;
+                }
+                if (attempt >= 16) std::this_thread::yield();
+            }
+            return false;
+        }
+
+        uint32_t FindIpSlot(uint32_t ip, Snapshot* out) const {
+            if (!m_header || ip == 0) return kNone;
+            const std::atomic<uint64_t>* ways = m_ipBuckets + (size_t)BucketOfIp(ip) * kWays;
+            uint32_t best = kNone;
+            uint64_t bestTick = 0;
+            Snapshot snap;
+            for (uint32_t w = 0; w < kWays; w++) {
+                const uint32_t ref = static_cast<uint32_t>(ways[w].load(std::memory_order_acquire));
+                if (ref == 0 || ref > m_capacity) continue;
+                if (!ReadEntry(ref - 1, &snap) || snap.ip != ip || snap.domainLen == 0) continue;
+                if (best != kNone && snap.tick < bestTick) continue;
+                best = ref - 1;
+                bestTick = snap.tick;
+                if (out) *out = snap;
+            }
+            return best;
+        }
+
+        uint32_t FindDomainSlot(std::string_view domain, uint32_t domainHash, Snapshot* out) const {
+            if (!m_header) return kNone;
+            const std::atomic<uint64_t>* ways = m_domainBuckets + (size_t)(domainHash & m_bucketMask) * kWays;
+            uint32_t best = kNone;
+            uint64_t bestTick = 0;
+            Snapshot snap;
+            for (uint32_t w = 0; w < kWays; w++) {
+                const uint32_t ref = static_cast<uint32_t>(ways[w].load(std::memory_order_acquire));
+                if (ref == 0 || ref > m_capacity) continue;
+                if (!ReadEntry(ref - 1, &snap) || snap.ip == 0) continue;
+                if (snap.domainHash != domainHash || snap.Domain() != domain) continue;
+                if (best != kNone && snap.tick < bestTick) continue;
+                best = ref - 1;
+                bestTick = snap.tick;
+                *out = snap;
+            }
+            return best;
+        }
+
+        // 刷新 tick：tick 是单个 64 位原子，不经过 seq（seq 同时是索引的版本号，不能变）。
+        // 与并发改写竞争时新内容可能得到本次 tick，二者同为“当前时间”，不影响正确性
+        bool RefreshTick(uint32_t slot, uint32_t expectSeq, uint64_t tick) {
+            Entry& e = m_entries[slot];
+            if (e.seq.load(std::memory_order_acquire) != expectSeq) return false;
+            e.tick.store(tick, std::memory_order_relaxed);
+            return true;
+        }
+
+        // 选路：同 key 旧记录 > 空槽/已失配（seq 已变化或条目不可读） > tick 最小者。
+        // 以 64 位 CAS 落槽，期间被他人改动则重新选路
+        template <typename SameKey, typename SameBucket>
+        void IndexInsert(std::atomic<uint64_t>* ways, uint64_t ref, uint64_t tick, SameKey&& sameKey,
+                         SameBucket&& sameBucket) {
+            Snapshot snap;
+            for (int attempt = 0; attempt < kPutAttempts; attempt++) {
+                int target = -1;
+                int stale = -1;
+                int oldest = -1;
+                uint64_t oldestTick = 0;
+                uint64_t seen[kWays];
+                for (uint32_t w = 0; w < kWays; w++) {
+                    seen[w] = ways[w].load(std::memory_order_acquire);
+                    if (seen[w] == ref) return; // 已指向本条目的本版本
+                    const uint32_t slot = static_cast<uint32_t>(seen[w]);
+                    const uint32_t seq = static_cast<uint32_t>(seen[w] >> 32);
+                    if (slot == 0 || slot > m_capacity || !ReadEntry(slot - 1, &snap) || snap.seq != seq ||
+                        snap.ip == 0 || !sameBucket(snap)) {
+                        if (stale < 0) stale = (int)w;
+                        continue;
+                    }
+                    if (sameKey(snap)) {
+                        if (snap.tick > tick) return; // 已有更新的同 key 记录
+                        if (target < 0) target = (int)w;
+                        continue;
+                    }
+                    if (oldest < 0 || snap.tick < oldestTick) {
+                        oldest = (int)w;
+                        oldestTick = snap.tick;
+                    }
+                }
+                if (target < 0) target = (stale >= 0) ? stale : oldest;
+                uint64_t expected = seen[target];
+                if (ways[target].compare_exchange_strong(expected, ref, std::memory_order_acq_rel)) return;
+            }
+        }
+
+        Header* m_header = nullptr;
+        std::atomic<uint64_t>* m_ipBuckets = nullptr;
+        std::atomic<uint64_t>* m_domainBuckets = nullptr;
+        Entry* m_entries = nullptr;
+        uint32_t m_capacity = 0;
+        uint32_t m_bucketMask = 0;
+    };
+}
@@ -0,0 +1,396 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+namespace Network {
+    // ============= FakeIP 地址池表（单写者 + 顺序锁，读端无锁） =============
+    // 设计意图：FakeIP 地址池是连续网段，IP 与“偏移 = ip - baseIp”一一对应，
+    // 因此反向映射无需哈希，直接以偏移为下标的稠密槽位数组即可。
+    // - 槽位只存 {seq, 块句柄, 长度}（12 字节），域名字节放在按大小分级的 arena 块中，
+    //   同一域名只存一份，正向索引（域名 -> 偏移）直接比对 arena 中的字节，不再另存副本
+    // - 正向索引为线性探测开放寻址表，桶内保存预先算好的 32 位哈希，删除用后移填补（无墓碑）
+    // - 写端（Alloc / 共享映射回填）由 FakeIP::m_mtx 串行化，保证单写者
+    // - 读端（Read）不加锁：按槽位序号（seq）读取，奇数表示写入中，读前读后 seq
+    //   不一致即重试；arena 块被回收复用时槽位 seq 必然已前进，因此不会读到错配内容
+    // - 槽位页与 arena 分块一经发布永不释放（直到 Reset/析构），读端拿到指针后可放心访问
+    class FakeIpSlotTable {
+    public:
+        static constexpr size_t kDomainMax = 255;         // 与 DNS 名称上限一致
+        static constexpr uint32_t kPageSlots = 1024;      // 每页槽位数（12KB/页）
+        static constexpr uint32_t kMaxSlots = 1u << 24;   // 上限：/8 网段
+
+        struct MemoryStats {
+            size_t slotBytes = 0;   // 已分配槽位页
+            size_t arenaBytes = 0;  // 已分配 arena 分块
+            size_t indexBytes = 0;  // 正向索引桶数组
+            size_t liveDomains = 0;
+        };
+
+        FakeIpSlotTable() = default;
+        FakeIpSlotTable(const FakeIpSlotTable&) = delete;
+        FakeIpSlotTable& operator=(const FakeIpSlotTable&) = delete;
+        ~FakeIpSlotTable() { FreeAll(); }
+
+        // 重置容量（仅允许在尚无读者时调用，例如 FakeIP 初始化阶段）
+        void Reset(uint32_t slotCount) {
+            FreeAll();
+            if (slotCount > kMaxSlots) slotCount = kMaxSlots;
+            const uint32_t pageCount = (slotCount + kPageSlots - 1) / kPageSlots;
+            if (pageCount == 0) return;
+            // 最坏情况下每个槽位占用最大块，按此上限预留分块指针表（/15 时仅 4KB）
+            const uint64_t worstWords = (uint64_t)slotCount * kMaxBlockWords;
+            const uint32_t chunkCount = (uint32_t)((worstWords + kChunkWords - 1) / kChunkWords);
+            m_pages.reset(new (std::nothrow) std::atomic<Page*>[pageCount]);
+            m_chunks.reset(new (std::nothrow) std::atomic<std::atomic<uint64_t>*>[chunkCount]);
+            if (!m_pages || !m_chunks) {
+                FreeAll();
+                return;
+            }
+            for (uint32_t i = 0; i < pageCount; i++) m_pages[i].store(nullptr, std::memory_order_relaxed);
+            for (uint32_t i = 0; i < chunkCount; i++) m_chunks[i].store(nullptr, std::memory_order_relaxed);
+            m_pageCount = pageCount;
+            m_chunkCapacity = chunkCount;
+            m_slotCount = slotCount;
+        }
+
+        uint32_t SlotCount() const { return m_slotCount; }
+
+        // 预先计算域名哈希（FNV-1a 32），供 FindDomain/Publish 复用，避免一次分配算两遍
+        static uint32_t HashDomain(std::string_view domain) {
+            uint32_t h = 2166136261u;
+            for (char c : domain) {
+                h ^= static_cast<uint8_t>(c);
+                h *= 16777619u;
+            }
+            return h;
+        }
+
+        // 写端：正向查询 domain 当前对应的偏移
+        bool FindDomain(std::string_view domain, uint32_t hash, uint32_t* outOffset) const {
+            if (m_index.empty()) return false;
+            const size_t mask = m_index.size() - 1;
+            for (size_t i = hash & mask;; i = (i + 1) & mask) {
+                const Bucket& b = m_index[i];
+                if (b.offsetPlus1 == 0) return false;
+                if (b.hash == hash && SlotEquals(b.offsetPlus1 - 1, domain)) {
+                    *outOffset = b.offsetPlus1 - 1;
+                    return true;
+                }
+            }
+        }
+
+        bool FindDomain(std::string_view domain, uint32_t* outOffset) const {
+            return FindDomain(domain, HashDomain(domain), outOffset);
+        }
+
+        // 读端：无锁正向查询。提示表按哈希直接映射最近一次发布的偏移，取到后用 Read 校验内容；
+        // 提示陈旧、被同桶域名覆盖或槽位已回收时返回 false，调用方再加锁走 FindDomain
+        bool TryFindDomain(std::string_view domain, uint32_t hash, uint32_t* outOffset) const {
+            const uint32_t hint = m_hints[hash & (kHintCount - 1)].load(std::memory_order_acquire);
+            if (hint == 0) return false;
+            char buf[kDomainMax + 8];
+            const size_t len = Read(hint - 1, buf);
+            if (len == 0 || len != domain.size() || std::memcmp(buf, domain.data(), len) != 0) return false;
+            *outOffset = hint - 1;
+            return true;
+        }
+
+        // 写端：发布 offset -> domain（空串表示清空槽位），并维护正向索引：
+        // 旧域名若仍指向本槽位则移除；新域名总是改指向本槽位。域名过长或内存不足返回 false
+        bool Publish(uint32_t offset, std::string_view domain, uint32_t hash) {
+            if (offset >= m_slotCount || domain.size() > kDomainMax) return false;
+            Page* page = EnsurePage(offset / kPageSlots);
+            if (!page) return false;
+            Slot& slot = page->slots[offset % kPageSlots];
+
+            uint32_t block = 0;
+            if (!domain.empty()) {
+                block = AllocBlock(domain.size());
+                if (block == kNoBlock) return false;
+                if (!EnsureIndexRoom()) {
+                    FreeBlock(block, domain.size());
+                    return false;
+                }
+                WriteBlock(block, domain);
+            }
+
+            const uint32_t oldBlock = slot.block.load(std::memory_order_relaxed);
+            const size_t oldLen = slot.len.load(std::memory_order_relaxed);
+            if (oldLen > 0) {
+                char oldBuf[kDomainMax + 8];
+                CopyBlock(oldBlock, oldLen, oldBuf);
+                IndexErase(std::string_view(oldBuf, oldLen), HashDomain(std::string_view(oldBuf, oldLen)), offset);
+            }
+
+            const uint32_t seq = slot.seq.load(std::memory_order_relaxed);
+            slot.seq.store(seq + 1, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_release);
+            slot.block.store(block, std::memory_order_relaxed);
+            slot.len.store(static_cast<uint16_t>(domain.size()), std::memory_order_relaxed);
+            slot.seq.store(seq + 2, std::memory_order_release);
+
+            // 旧块只能在 seq 前进之后回收：此后仍持有旧句柄的读者必然校验失败并重试
+            if (oldLen > 0) FreeBlock(oldBlock, oldLen);
+            if (!domain.empty()) {
+                IndexAssign(domain, hash, offset);
+                m_hints[hash & (kHintCount - 1)].store(offset + 1, std::memory_order_release);
+            }
+            return true;
+        }
+
+        bool Publish(uint32_t offset, std::string_view domain) {
+            return Publish(offset, domain, HashDomain(domain));
+        }
+
+        // 写端：读取自己已发布的内容（单写者前提下无需校验 seq）
+        size_t WriterRead(uint32_t offset, char* out) const {
+            const Slot* slot = FindSlot(offset);
+            if (!slot) return 0;
+            const size_t len = slot->len.load(std::memory_order_relaxed);
+            if (len > 0) CopyBlock(slot->block.load(std::memory_order_relaxed), len, out);
+            return len;
+        }
+
+        // 读端：无锁读取 offset 对应域名，out 至少 kDomainMax + 8 字节；返回长度（0 表示空槽）
+        size_t Read(uint32_t offset, char* out) const {
+            const Slot* slot = FindSlot(offset);
+            if (!slot) return 0;
+            for (uint32_t spins = 0;; spins++) {
+                const uint32_t before = slot->seq.load(std::memory_order_acquire);
+                if ((before & 1) == 0) {
+                    size_t len = slot->len.load(std::memory_order_relaxed);
+                    const uint32_t block = slot->block.load(std::memory_order_relaxed);
+                    if (len > kDomainMax) len = kDomainMax; // 撕裂读取时的防御，随后 seq 校验会丢弃
+                    if (len > 0 && !CopyBlock(block, len, out)) len = 0;
+                    std::atomic_thread_fence(std::memory_order_acquire);
+                    if (slot->seq.load(std::memory_order_relaxed) == before) return len;
+                }
+                // 写端临界区只有几十条指令，绝大多数情况下自旋即可；长时间不一致时让出时间片
+                if (spins >= 64) std::this_thread::yield();
+            }
+        }
+
+        bool Read(uint32_t offset, std::string* out) const {
+            char buf[kDomainMax + 8];
+            const size_t len = Read(offset, buf);
+            if (len == 0) return false;
+            out->assign(buf, len);
+            return true;
+        }
+
+        MemoryStats GetMemoryStats() const {
+            MemoryStats s;
+            for (uint32_t i = 0; i < m_pageCount; i++) {
+                if (m_pages[i].load(std::memory_order_relaxed)) s.slotBytes += sizeof(Page);
+            }
+            s.arenaBytes = (size_t)m_chunkUsed * kChunkWords * sizeof(uint64_t);
+            s.indexBytes = m_index.capacity() * sizeof(Bucket);
+            s.liveDomains = m_indexCount;
+            return s;
+        }
+
+    private:
+        // ---- arena：64KB 分块，按 1/2/4/8/16/32 个 8 字节字分级，空闲块按级回收 ----
+        static constexpr uint32_t kChunkWords = 8192;
+        static constexpr uint32_t kMaxBlockWords = 32;
+        static constexpr int kClassCount = 6;
+        static constexpr uint32_t kNoBlock = UINT32_MAX;
+        static constexpr uint32_t kHintCount = 4096; // 无锁正向查询提示表（16KB）
+
+        struct Slot {
+            std::atomic<uint32_t> seq{0};
+            std::atomic<uint32_t> block{0}; // arena 全局字下标
+            std::atomic<uint16_t> len{0};   // 0 表示空槽
+        };
+
+        struct Page {
+            Slot slots[kPageSlots];
+        };
+
+        struct Bucket {
+            uint32_t hash = 0;
+            uint32_t offsetPlus1 = 0; // 0 表示空桶
+        };
+
+        static int ClassOf(size_t len) {
+            const size_t words = (len + 7) / 8;
+            int cls = 0;
+            while ((1u << cls) < words) cls++;
+            return cls;
+        }
+
+        uint32_t AllocBlock(size_t len) {
+            const int cls = ClassOf(len);
+            auto& freeList = m_freeBlocks[cls];
+            if (!freeList.empty()) {
+                const uint32_t block = freeList.back();
+                freeList.pop_back();
+                return block;
+            }
+            const uint32_t words = 1u << cls;
+            // 块不跨分块：当前分块剩余不足时整体切到下一块（尾部少量浪费）
+            if (m_chunkUsed == 0 || m_bumpWords + words > kChunkWords) {
+                if (m_chunkUsed >= m_chunkCapacity) return kNoBlock;
+                auto* chunk = new (std::nothrow) std::atomic<uint64_t>[kChunkWords];
+                if (!chunk) return kNoBlock;
+                m_chunks[m_chunkUsed].store(chunk, std::memory_order_release);
+                m_chunkUsed++;
+                m_bumpWords = 0;
+            }
+            const uint32_t block = (m_chunkUsed - 1) * kChunkWords + m_bumpWords;
+            m_bumpWords += words;
+            return block;
+        }
+
+        void FreeBlock(uint32_t block, size_t len) {
+            m_freeBlocks[ClassOf(len)].push_back(block);
+        }
+
+        void WriteBlock(uint32_t block, std::string_view domain) {
+            std::atomic<uint64_t>* words = m_chunks[block / kChunkWords].load(std::memory_order_relaxed) +
+                                           block % kChunkWords;
+            const size_t wordCount = (domain.size() + 7) / 8;
+            for (size_t i = 0; i < wordCount; i++) {
+                uint64_t w = 0;
+                const size_t n = (domain.size() - i * 8 < 8) ? (domain.size() - i * 8) : 8;
+                std::memcpy(&w, domain.data() + i * 8, n);
+                words[i].store(w, std::memory_order_relaxed);
+            }
+        }
+
+        bool CopyBlock(uint32_t block, size_t len, char* out) const {
+            const uint32_t chunkIndex = block / kChunkWords;
+            if (chunkIndex >= m_chunkCapacity) return false;
+            const std::atomic<uint64_t>* chunk = m_chunks[chunkIndex].load(std::memory_order_acquire);
+            if (!chunk) return false;
+            const std::atomic<uint64_t>* words = chunk + block % kChunkWords;
+            const size_t wordCount = (len + 7) / 8;
+            if (block % kChunkWords + wordCount > kChunkWords) return false;
+            // 整字拷贝：out 约定至少 kDomainMax + 8 字节，尾部多写的字节不计入长度
+            for (size_t i = 0; i < wordCount; i++) {
+                const uint64_t w = words[i].load(std::memory_order_relaxed);
+                std::memcpy(out + i * 8, &w, 8);
+            }
+            return true;
+        }
+
+        bool SlotEquals(uint32_t offset, std::string_view domain) const {
+            char buf[kDomainMax + 8];
+            const size_t len = WriterRead(offset, buf);
+            return len == domain.size() && std::memcmp(buf, domain.data(), len) == 0;
+        }
+
+        // ---- 正向索引（仅写端访问） ----
+        bool EnsureIndexRoom() {
+            if (!m_index.empty() && (m_indexCount + 1) * 4 <= m_index.size() * 3) return true;
+            const size_t newSize = m_index.empty() ? 1024 : m_index.size() * 2;
+            std::vector<Bucket> old;
+            old.swap(m_index);
+            m_index.resize(newSize);
+            const size_t mask = newSize - 1;
+            for (const Bucket& b : old) {
+                if (b.offsetPlus1 == 0) continue;
+                size_t i = b.hash & mask;
+                while (m_index[i].offsetPlus1 != 0) i = (i + 1) & mask;
+                m_index[i] = b;
+            }
+            return true;
+        }
+
+        void IndexAssign(std::string_view domain, uint32_t hash, uint32_t offset) {
+            const size_t mask = m_index.size() - 1;
+            size_t i = hash & mask;
+            for (;; i = (i + 1) & mask) {
+                Bucket& b = m_index[i];
+                if (b.offsetPlus1 == 0) break;
+                // 同名域名已存在（回填场景）：改指向新槽位
+                if (b.hash == hash && SlotEquals(b.offsetPlus1 - 1, domain)) {
+                    b.offsetPlus1 = offset + 1;
+                    return;
+                }
+            }
+            m_index[i].hash = hash;
+            m_index[i].offsetPlus1 = offset + 1;
+            m_indexCount++;
+        }
+
+        // 仅当 domain 的索引项指向 offset 时删除；后移填补保持探测链连续
+        void IndexErase(std::string_view domain, uint32_t hash, uint32_t offset) {
+            if (m_index.empty()) return;
+            const size_t mask = m_index.size() - 1;
+            size_t i = hash & mask;
+            for (;; i = (i + 1) & mask) {
+                const Bucket& b = m_index[i];
+                if (b.offsetPlus1 == 0) return;
+                if (b.hash == hash && SlotEquals(b.offsetPlus1 - 1, domain)) break;
+            }
+            if (m_index[i].offsetPlus1 != offset + 1) return;
+            m_indexCount--;
+            size_t hole = i;
+            for (size_t j = (i + 1) & mask; m_index[j].offsetPlus1 != 0; j = (j + 1) & mask) {
+                const size_t home = m_index[j].hash & mask;
+                // j 的理想位置不在 (hole, j] 区间内，说明可以搬到 hole
+                const bool movable = (hole <= j) ? (home <= hole || home > j) : (home <= hole && home > j);
+                if (movable) {
+                    m_index[hole] = m_index[j];
+                    hole = j;
+                }
+            }
+            m_index[hole] = Bucket{};
+        }
+
+        // ---- 槽位页 ----
+        const Slot* FindSlot(uint32_t offset) const {
+            if (offset >= m_slotCount) return nullptr;
+            const Page* page = m_pages[offset / kPageSlots].load(std::memory_order_acquire);
+            return page ? &page->slots[offset % kPageSlots] : nullptr;
+        }
+
+        Page* EnsurePage(uint32_t index) {
+            Page* page = m_pages[index].load(std::memory_order_relaxed);
+            if (page) return page;
+            page = new (std::nothrow) Page();
+            if (!page) return nullptr;
+            m_pages[index].store(page, std::memory_order_release);
+            return page;
+        }
+
+        void FreeAll() {
+            for (uint32_t i = 0; i < m_pageCount; i++) delete m_pages[i].load(std::memory_order_relaxed);
+            for (uint32_t i = 0; i < m_chunkUsed; i++) delete[] m_chunks[i].load(std::memory_order_relaxed);
+            m_pages.reset();
+            m_chunks.reset();
+            m_pageCount = 0;
+            m_slotCount = 0;
+            m_chunkCapacity = 0;
+            m_chunkUsed = 0;
+            m_bumpWords = 0;
+            for (auto& list : m_freeBlocks) list.clear();
+            m_index.clear();
+            m_index.shrink_to_fit();
+            m_indexCount = 0;
+            for (auto& hint : m_hints) hint.store(0, std::memory_order_relaxed);
+        }
+
+        std::unique_ptr<std::atomic<Page*>[]> m_pages;
+        uint32_t m_pageCount = 0;
+        uint32_t m_slotCount = 0;
+
+        std::unique_ptr<std::atomic<std::atomic<uint64_t>*>[]> m_chunks;
+        uint32_t m_chunkCapacity = 0;
+        uint32_t m_chunkUsed = 0;
+        uint32_t m_bumpWords = 0;
+        std::vector<uint32_t> m_freeBlocks[kClassCount];
+
+        std::vector<Bucket> m_index;
+        size_t m_indexCount = 0;
+        std::atomic<uint32_t> m_hints[kHintCount] = {}; // 偏移 + 1，0 表示空
+    };
+}
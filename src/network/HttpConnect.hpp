@@ -8,6 +8,7 @@
 #include <iomanip>
 #include "../core/Config.hpp"
 #include "../core/Logger.hpp"
+#include "HttpConnectCodec.hpp"
 #include "SocketIo.hpp"
 
 namespace Network {
@@ -35,20 +36,17 @@ namespace Network {
                                     ", 目标=" + targetHost + ":" + std::to_string(targetPort));
             }
 
-            // 构造 CONNECT 请求
-            // 格式: CONNECT host:port HTTP/1.1\r\nHost: host:port\r\n\r\n
-            std::string hostForHeader = targetHost;
-            in6_addr addr6{};
-            if (inet_pton(AF_INET6, targetHost.c_str(), &addr6) == 1) {
-                // IPv6 字面量需要方括号包裹，符合 HTTP CONNECT 语法
-                hostForHeader = "[" + targetHost + "]";
+            // 构造 CONNECT 请求（写入栈上缓冲区）
+            char request[HttpConnect::kMaxRequestBytes];
+            const size_t requestLen = HttpConnect::EncodeRequest(targetHost, targetPort, request, sizeof(request));
+            if (requestLen == 0) {
+                Core::Logger::Error("HTTP CONNECT: 目标地址无法编码, sock=" + std::to_string((unsigned long long)sock) +
+                                    ", len=" + std::to_string(targetHost.size()));
+                WSASetLastError(WSAEINVAL);
+                return false;
             }
-            std::ostringstream request;
-            request << "CONNECT " << hostForHeader << ":" << targetPort << " HTTP/1.1\r\n";
-            request << "Host: " << hostForHeader << ":" << targetPort << "\r\n";
-            request << "\r\n";
-            
-            std::string requestStr = request.str();
+            // 请求行只在日志里用到，按需生成
+            auto requestLine = [&]() { return FirstLine(std::string(request, requestLen)); };
             auto& config = Core::Config::Instance();
             const int recvTimeout = NormalizeTimeoutMs(config.timeout.recv_ms);
             const int sendTimeout = NormalizeTimeoutMs(config.timeout.send_ms);
@@ -71,7 +69,7 @@ namespace Network {
 
             if (Core::Logger::IsEnabled(Core::LogLevel::Debug)) {
                 Core::Logger::Debug("HTTP CONNECT: 发送请求, sock=" + std::to_string((unsigned long long)sock) +
-                                    ", line=\"" + FirstLine(requestStr) + "\"" +
+                                    ", line=\"" + requestLine() + "\"" +
                                     ", 预算=" + std::to_string(handshakeBudgetMs) + "ms");
             }
             
@@ -79,16 +77,16 @@ namespace Network {
             // 使用统一 IO 封装，兼容非阻塞套接字
             const int sendStepTimeout = stepTimeout(sendTimeout, "发送请求");
             if (sendStepTimeout <= 0) return false;
-            if (!SocketIo::SendAll(sock, requestStr.c_str(), (int)requestStr.length(), sendStepTimeout)) {
+            if (!SocketIo::SendAll(sock, request, (int)requestLen, sendStepTimeout)) {
                 int err = WSAGetLastError();
                 Core::Logger::Error("HTTP CONNECT: 发送请求失败, sock=" + std::to_string((unsigned long long)sock) +
                                     ", WSA错误码=" + std::to_string(err) +
-                                    ", line=\"" + FirstLine(requestStr) + "\"");
+                                    ", line=\"" + requestLine() + "\"");
                 return false;
             }
             if (Core::Logger::IsEnabled(Core::LogLevel::Debug)) {
                 Core::Logger::Debug("HTTP CONNECT: 请求已发送, sock=" + std::to_string((unsigned long long)sock) +
-                                    ", bytes=" + std::to_string(requestStr.size()));
+                                    ", bytes=" + std::to_string(requestLen));
             }
             
             // 接收响应
@@ -112,7 +110,7 @@ namespace Network {
             
             // 解析状态码
             // 期望格式: HTTP/1.x 200 ...
-            int statusCode = ParseStatusCode(response);
+            const int statusCode = HttpConnect::ParseStatusCode(response.data(), response.size());
             if (statusCode == -1) {
                 Core::Logger::Error("HTTP CONNECT: 解析响应状态码失败, sock=" + std::to_string((unsigned long long)sock) +
                                     ", line=\"" + FirstLine(response) + "\"");
@@ -184,26 +182,5 @@ namespace Network {
             if (end == std::string::npos) end = s.size();
             return s.substr(0, end);
         }
-
-        /**
-         * 解析 HTTP 响应状态码
-         * @param response HTTP 响应字符串
-         * @return 状态码，解析失败返回 -1
-         */
-        static int ParseStatusCode(const std::string& response) {
-            // 查找第一行: "HTTP/1.x NNN ..."
-            size_t spacePos = response.find(' ');
-            if (spacePos == std::string::npos || spacePos + 4 > response.length()) {
-                return -1;
-            }
-            
-            // 提取状态码 (3位数字)
-            std::string codeStr = response.substr(spacePos + 1, 3);
-            try {
-                return std::stoi(codeStr);
-            } catch (...) {
-                return -1;
-            }
-        }
     };
 }
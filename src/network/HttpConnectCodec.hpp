@@ -0,0 +1,121 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#ifdef _WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#else
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#endif
+
+namespace Network {
+namespace HttpConnect {
+
+    // ============= HTTP CONNECT 报文编解码（不涉及 socket） =============
+    // 设计意图：与 Socks5Codec 相同，请求写入调用方给定的缓冲区，响应从已读到的字节中解析，
+    // 阻塞握手与非阻塞握手状态机共用。
+
+    // 响应头以空行结束
+    constexpr const char* kHeaderEnd = "\r\n\r\n";
+    // 响应头上限（与阻塞握手 RecvUntil 的上限一致）
+    constexpr size_t kMaxResponseBytes = 1024;
+    // "CONNECT " + "[host]:port" + " HTTP/1.1\r\nHost: " + "[host]:port" + "\r\n\r\n"，host 最长 255
+    constexpr size_t kMaxAuthorityBytes = 1 + 255 + 1 + 1 + 5;
+    constexpr size_t kMaxRequestBytes = 8 + kMaxAuthorityBytes + 17 + kMaxAuthorityBytes + 4;
+
+    // 写入 CONNECT 请求，返回字节数；host 为空/过长或缓冲区不足时返回 0
+    // 格式: CONNECT host:port HTTP/1.1\r\nHost: host:port\r\n\r\n（IPv6 字面量加方括号）
+    inline size_t EncodeRequest(const std::string& host, uint16_t port, char* buf, size_t cap) {
+        if (!buf || host.empty() || host.size() > 255) return 0;
+        in6_addr addr6{};
+        const bool v6 = inet_pton(AF_INET6, host.c_str(), &addr6) == 1;
+        // authority = host:port（IPv6 加方括号）；端口手工转十进制，避免 snprintf 的格式解析开销
+        char authority[kMaxAuthorityBytes];
+        size_t a = 0;
+        if (v6) authority[a++] = '[';
+        std::memcpy(authority + a, host.data(), host.size());
+        a += host.size();
+        if (v6) authority[a++] = ']';
+        authority[a++] = ':';
+        char digits[5];
+        size_t nd = 0;
+        unsigned value = port;
+        do {
+            digits[nd++] = (char)('0' + value % 10);
+            value /= 10;
+        } while (value != 0);
+        while (nd > 0) authority[a++] = digits[--nd];
+        const size_t total = 8 + a + 17 + a + 4;
+        if (cap < total) return 0;
+        size_t pos = 0;
+        auto put = [&](const char* s, size_t n) {
+            std::memcpy(buf + pos, s, n);
+            pos += n;
+        };
+        put("CONNECT ", 8);
+        put(authority, a);
+        put(" HTTP/1.1\r\nHost: ", 17);
+        put(authority, a);
+        put("\r\n\r\n", 4);
+        return pos;
+    }
+
+    // 解析状态行 "HTTP/1.x NNN ..."，返回状态码；格式不符返回 -1
+    inline int ParseStatusCode(const char* p, size_t len) {
+        if (!p || len < 12 || std::memcmp(p, "HTTP/", 5) != 0) return -1;
+        const void* space = std::memchr(p, ' ', len);
+        if (!space) return -1;
+        const size_t pos = (size_t)((const char*)space - p) + 1;
+        if (pos + 3 > len) return -1;
+        int code = 0;
+        for (size_t i = pos; i < pos + 3; i++) {
+            if (p[i] < '0' || p[i] > '9') return -1;
+            code = code * 10 + (p[i] - '0');
+        }
+        return code;
+    }
+
+    enum class DecodeStatus {
+        NeedMore, // 还没见到空行
+        Done,     // 响应头完整，status/length 有效
+        Invalid,  // 状态行不符合 HTTP 格式
+        TooLong,  // 超过 kMaxResponseBytes 仍未见到空行
+    };
+
+    struct Response {
+        int status = 0;
+        size_t length = 0; // 响应头字节数（含空行），之后为隧道数据
+    };
+
+    // 从已读到的字节中解析响应头；scanFrom 为上次已确认不含空行的前缀长度（增量解析时避免重复扫描）
+    inline DecodeStatus DecodeResponse(const char* p, size_t len, Response* out, size_t scanFrom = 0) {
+        if (!p) return DecodeStatus::NeedMore;
+        const size_t d = 4;
+        size_t i = scanFrom >= d ? scanFrom - (d - 1) : 0;
+        size_t end = 0;
+        while (i + d <= len) {
+            const void* hit = std::memchr(p + i, '\r', len - d + 1 - i);
+            if (!hit) break;
+            i = (size_t)((const char*)hit - p);
+            if (std::memcmp(p + i, kHeaderEnd, d) == 0) {
+                end = i + d;
+                break;
+            }
+            i++;
+        }
+        if (end == 0) return len >= kMaxResponseBytes ? DecodeStatus::TooLong : DecodeStatus::NeedMore;
+        if (end > kMaxResponseBytes) return DecodeStatus::TooLong;
+        const int status = ParseStatusCode(p, end);
+        if (status < 0) return DecodeStatus::Invalid;
+        if (out) {
+            out->status = status;
+            out->length = end;
+        }
+        return DecodeStatus::Done;
+    }
+
+}
+}
@@ -0,0 +1,66 @@
+#pragma once
+#include <cstddef>
+#include <cstring>
+#include <string>
+
+namespace Network {
+namespace PeekReader {
+
+    // ============= 基于 MSG_PEEK 的分隔符读取 =============
+    // 设计意图：HTTP CONNECT 响应头只有一两百字节，但之前逐字节 recv 且每字节都对整个缓冲区 find，
+    // 一次握手要数百次系统调用、扫描代价为平方级。这里先 peek 当前可读数据，在其中找分隔符：
+    // - 找到：只消费到分隔符末尾（一次 recv），分隔符之后的隧道数据留在 socket 里
+    // - 未找到：peek 到的字节必然都属于头部，整段消费后等待更多数据
+    // 每个字节只扫描一次（跨批次时回看 delimiter.size()-1 字节），典型响应 2 次系统调用完成。
+    // 与传输无关：io 提供 Peek/Take（语义同 recv(MSG_PEEK)/recv：>0 字节数，0 对端关闭，<0 失败）
+    // 与 WouldBlock()（最近一次失败是否为“暂无数据”），阻塞 socket、非阻塞 socket 与基准共用。
+
+    enum class Step {
+        Done,    // 已读到分隔符，used 为头部总长（含分隔符）
+        Wait,    // 暂无数据，调用方等待可读后再调用
+        Closed,  // 对端关闭
+        Failed,  // 读取失败
+        TooLong, // 已读满 cap 仍未见分隔符
+    };
+
+    // 在 buf[0, len) 中从 scanFrom 起查找分隔符，返回分隔符结束位置；未找到返回 npos
+    inline size_t FindEnd(const char* buf, size_t len, size_t scanFrom, const std::string& delimiter) {
+        const size_t d = delimiter.size();
+        if (d == 0 || len < d) return std::string::npos;
+        size_t i = scanFrom;
+        while (i + d <= len) {
+            const void* hit = std::memchr(buf + i, delimiter[0], len - d + 1 - i);
+            if (!hit) return std::string::npos;
+            i = (size_t)((const char*)hit - buf);
+            if (std::memcmp(buf + i, delimiter.data(), d) == 0) return i + d;
+            i++;
+        }
+        return std::string::npos;
+    }
+
+    // 推进一轮读取。used 为 buf 中已消费的字节数，调用方在多轮之间保持（初始为 0）
+    template <typename Io>
+    Step ReadStep(Io& io, char* buf, size_t cap, size_t* used, const std::string& delimiter) {
+        if (*used >= cap) return Step::TooLong;
+        const int peeked = io.Peek(buf + *used, (int)(cap - *used));
+        if (peeked == 0) return Step::Closed;
+        if (peeked < 0) return io.WouldBlock() ? Step::Wait : Step::Failed;
+
+        // 上一轮末尾可能是分隔符的前半段，回看 d-1 字节
+        const size_t d = delimiter.size();
+        const size_t scanFrom = *used >= d ? *used - (d - 1) : 0;
+        const size_t avail = *used + (size_t)peeked;
+        const size_t end = FindEnd(buf, avail, scanFrom, delimiter);
+        const size_t take = (end == std::string::npos ? avail : end) - *used;
+
+        // 已 peek 到的数据一定可读，Take 不会阻塞；短读时按实际消费推进
+        const int got = io.Take(buf + *used, (int)take);
+        if (got == 0) return Step::Closed;
+        if (got < 0) return io.WouldBlock() ? Step::Wait : Step::Failed;
+        *used += (size_t)got;
+        if (end != std::string::npos && (size_t)got == take) return Step::Done;
+        return *used >= cap ? Step::TooLong : Step::Wait;
+    }
+
+}
+}
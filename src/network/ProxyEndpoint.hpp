@@ -0,0 +1,355 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "DnsCache.hpp"
+#include "../core/SingleFlight.hpp"
+#ifndef _WIN32
+#include <arpa/inet.h>
+#endif
+
+namespace Network {
+    // ============= 代理服务器地址解析（缓存 + 后台刷新 + 轮换/故障转移） =============
+    // 设计意图：proxy.host 填主机名时，旧实现在每次代理连接（connect / WSAConnect / UDP 控制连接）
+    // 都同步调用一次 getaddrinfo，且只取第一个地址：代理地址失效时每次连接都要先付一次 DNS 往返再失败。
+    // 这里对代理端点单独维护：
+    // - 首次使用时同步解析一次（AF_UNSPEC，一次拿到全部 A/AAAA），之后由后台线程按 refreshMs 刷新；
+    //   刷新失败保留旧地址。连接路径不再等待 DNS
+    // - 解析从未成功时，失败后 kRetryAfterFailureMs 内直接返回上次错误，不再每次连接都打一次解析器
+    // - Pick 在健康地址间轮换；ReportFailure 让地址进入冷却（指数退避，上限 kMaxCooldownMs），
+    //   全部处于冷却时仍返回最早恢复的地址（不因健康度直接拒绝连接）；ReportSuccess 清除冷却
+    // - proxy.host 为 IP 字面量时只有一个固定地址，不做任何解析
+    // AF_INET6 请求（双栈 socket）优先 AAAA 结果，其次为 A 结果的 v4-mapped 形式，与 BuildProxyAddrV6 的语义一致。
+    class ProxyEndpoint {
+    public:
+        using Resolver = DnsCache::Resolver;
+        using NowFn = DnsCache::NowFn;
+
+        static constexpr uint32_t kRetryAfterFailureMs = 2000;
+        static constexpr uint32_t kBaseCooldownMs = 5000;
+        static constexpr uint32_t kMaxCooldownMs = 60000;
+        static constexpr uint32_t kInitialWaitMs = 5000; // 并发首次解析时跟随者的最长等待
+
+        explicit ProxyEndpoint(Resolver resolver = Resolver(), NowFn now = NowFn())
+            : m_resolver(resolver ? std::move(resolver) : Resolver(&DnsCache::SystemResolve)),
+              m_now(now ? std::move(now) : NowFn(&SteadyNowMs)) {}
+
+        ~ProxyEndpoint() { Stop(); }
+
+        static ProxyEndpoint& Instance() {
+            // 有意不析构：理由同 DnsCache::Instance
+            static ProxyEndpoint* s_endpoint = new ProxyEndpoint();
+            return *s_endpoint;
+        }
+
+        // 指定代理主机与端口；与当前一致时不做任何事，变化时清空已解析地址
+        // resolver 为空时保持原后端；refreshMs 为 0 时不启动后台刷新
+        void Configure(const std::string& host, uint16_t port, uint32_t refreshMs, Resolver resolver = Resolver()) {
+            std::lock_guard<std::mutex> lock(m_mtx);
+            if (resolver) m_resolver = std::move(resolver);
+            m_refreshMs = refreshMs;
+            if (m_configured && host == m_host && port == m_port) return;
+            m_configured = true;
+            m_host = host;
+            m_port = port;
+            m_addrs.clear();
+            m_lastError = 0;
+            m_retryAt = 0;
+            m_generation++;
+            sockaddr_storage literal{};
+            m_isLiteral = ParseLiteral(host, port, &literal);
+            if (m_isLiteral) m_addrs.push_back(Candidate{literal, 0, 0});
+        }
+
+        // 仅在 host/port 与当前不同时重新配置（调用方每次连接都可调用）
+        void Ensure(const std::string& host, uint16_t port, uint32_t refreshMs) {
+            {
+                std::lock_guard<std::mutex> lock(m_mtx);
+                if (m_configured && host == m_host && port == m_port) return;
+            }
+            Configure(host, port, refreshMs);
+        }
+
+        // 取一个代理地址（端口已填）。family 为 AF_INET 时只返回 IPv4；AF_INET6 时返回 IPv6 或 v4-mapped
+        bool Pick(int family, sockaddr_storage* out, int* outLen, int* outErr) {
+            if (!out || !outLen) return false;
+            if (!EnsureResolved(outErr)) return false;
+
+            std::lock_guard<std::mutex> lock(m_mtx);
+            const uint64_t now = m_now();
+            // 候选分层：AF_INET6 时先 AAAA 后 A（映射），AF_INET 时只有 A；层内轮换健康地址
+            const int tiers[2] = {family == AF_INET6 ? AF_INET6 : AF_INET, family == AF_INET6 ? AF_INET : 0};
+            size_t chosen = 0;
+            bool found = false;
+            bool healthy = false;
+            const size_t start = m_cursor++;
+            for (int tier : tiers) {
+                if (tier == 0 || healthy) continue;
+                std::vector<size_t> order;
+                for (size_t i = 0; i < m_addrs.size(); i++) {
+                    if (m_addrs[i].addr.ss_family == tier) order.push_back(i);
+                }
+                for (size_t k = 0; k < order.size() && !healthy; k++) {
+                    const size_t idx = order[(start + k) % order.size()];
+                    // 全部冷却时退回最早恢复的地址
+                    if (!found || m_addrs[idx].coolUntil < m_addrs[chosen].coolUntil) chosen = idx;
+                    found = true;
+                    healthy = m_addrs[idx].coolUntil <= now;
+                    if (healthy) chosen = idx;
+                }
+            }
+            if (!found) {
+                if (outErr) *outErr = EAI_FAMILY;
+                return false;
+            }
+
+            const sockaddr_storage& picked = m_addrs[chosen].addr;
+            if (family == AF_INET6 && picked.ss_family == AF_INET) {
+                MapToV6(reinterpret_cast<const sockaddr_in&>(picked), out);
+            } else {
+                *out = picked;
+            }
+            *outLen = DnsCache::SockaddrLen(*out);
+            if (outErr) *outErr = 0;
+            return true;
+        }
+
+        // 连接该地址失败：进入冷却，之后的 Pick 优先其他地址
+        void ReportFailure(const sockaddr* addr) {
+            std::lock_guard<std::mutex> lock(m_mtx);
+            Candidate* c = FindLocked(addr);
+            if (!c) return;
+            c->failures = std::min<uint32_t>(c->failures + 1, 16);
+            uint64_t cooldown = (uint64_t)kBaseCooldownMs << (c->failures - 1);
+            if (cooldown > kMaxCooldownMs) cooldown = kMaxCooldownMs;
+            c->coolUntil = m_now() + cooldown;
+        }
+
+        void ReportSuccess(const sockaddr* addr) {
+            std::lock_guard<std::mutex> lock(m_mtx);
+            Candidate* c = FindLocked(addr);
+            if (!c) return;
+            c->failures = 0;
+            c->coolUntil = 0;
+        }
+
+        // 同步重新解析一次；失败时保留旧地址。返回是否成功
+        bool RefreshNow(int* outErr = nullptr) {
+            std::string host;
+            uint16_t port = 0;
+            uint64_t generation = 0;
+            Resolver resolver;
+            {
+                std::lock_guard<std::mutex> lock(m_mtx);
+                if (!m_configured || m_isLiteral) return m_configured;
+                host = m_host;
+                port = m_port;
+                generation = m_generation;
+                resolver = m_resolver;
+            }
+            std::vector<sockaddr_storage> resolved;
+            int rc = resolver(host, AF_UNSPEC, &resolved);
+            if (rc == 0 && resolved.empty()) rc = EAI_FAIL;
+            if (outErr) *outErr = rc;
+
+            std::lock_guard<std::mutex> lock(m_mtx);
+            m_refreshes++;
+            if (generation != m_generation) return false; // 解析期间被重新配置
+            if (rc != 0) {
+                m_lastError = rc;
+                if (m_addrs.empty()) m_retryAt = m_now() + kRetryAfterFailureMs;
+                return false;
+            }
+            // 新地址集合：保留仍存在地址的冷却状态
+            std::vector<Candidate> next;
+            for (sockaddr_storage& a : resolved) {
+                if (a.ss_family != AF_INET && a.ss_family != AF_INET6) continue;
+                DnsCache::SetPort(&a, port);
+                bool dup = false;
+                for (const Candidate& n : next) dup = dup || SameAddr(n.addr, a);
+                if (dup) continue;
+                Candidate c{a, 0, 0};
+                if (Candidate* old = FindLocked(reinterpret_cast<const sockaddr*>(&a))) c = *old;
+                next.push_back(c);
+            }
+            if (next.empty()) {
+                m_lastError = EAI_FAIL;
+                return false;
+            }
+            m_addrs.swap(next);
+            m_lastError = 0;
+            return true;
+        }
+
+        // 启动后台刷新线程（幂等）；refreshMs 为 0 或字面量地址时不启动
+        void StartRefresher() {
+            std::lock_guard<std::mutex> lock(m_mtx);
+            if (m_worker.joinable() || m_stopping || m_refreshMs == 0 || m_isLiteral) return;
+            m_worker = std::thread([this]() { RefreshLoop(); });
+        }
+
+        // 停止刷新线程并等待其退出，之后 StartRefresher 不再启动新线程；只由析构与测试调用
+        void Stop() {
+            {
+                std::lock_guard<std::mutex> lock(m_mtx);
+                m_stopping = true;
+            }
+            m_cv.notify_all();
+            if (m_worker.joinable()) m_worker.join();
+        }
+
+        size_t AddressCount() {
+            std::lock_guard<std::mutex> lock(m_mtx);
+            return m_addrs.size();
+        }
+
+        uint64_t RefreshCount() {
+            std::lock_guard<std::mutex> lock(m_mtx);
+            return m_refreshes;
+        }
+
+    private:
+        struct Candidate {
+            sockaddr_storage addr;
+            uint64_t coolUntil;
+            uint32_t failures;
+        };
+
+        static uint64_t SteadyNowMs() {
+            return (uint64_t)std::chrono::duration_cast<std::chrono::milliseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count();
+        }
+
+        static bool ParseLiteral(const std::string& host, uint16_t port, sockaddr_storage* out) {
+            std::memset(out, 0, sizeof(*out));
+            auto* in4 = reinterpret_cast<sockaddr_in*>(out);
+            if (inet_pton(AF_INET, host.c_str(), &in4->sin_addr) == 1) {
+                in4->sin_family = AF_INET;
+                in4->sin_port = htons(port);
+                return true;
+            }
+            auto* in6 = reinterpret_cast<sockaddr_in6*>(out);
+            if (inet_pton(AF_INET6, host.c_str(), &in6->sin6_addr) == 1) {
+                in6->sin6_family = AF_INET6;
+                in6->sin6_port = htons(port);
+                return true;
+            }
+            std::memset(out, 0, sizeof(*out));
+            return false;
+        }
+
+        static void MapToV6(const sockaddr_in& v4, sockaddr_storage* out) {
+            std::memset(out, 0, sizeof(*out));
+            auto* in6 = reinterpret_cast<sockaddr_in6*>(out);
+            in6->sin6_family = AF_INET6;
+            in6->sin6_port = v4.sin_port;
+            uint8_t* bytes = reinterpret_cast<uint8_t*>(&in6->sin6_addr);
+            bytes[10] = 0xFF;
+            bytes[11] = 0xFF;
+            std::memcpy(bytes + 12, &v4.sin_addr, 4);
+        }
+
+        static bool SameAddr(const sockaddr_storage& a, const sockaddr_storage& b) {
+            if (a.ss_family != b.ss_family) return false;
+            if (a.ss_family == AF_INET) {
+                return std::memcmp(&reinterpret_cast<const sockaddr_in&>(a).sin_addr,
+                                   &reinterpret_cast<const sockaddr_in&>(b).sin_addr, 4) == 0;
+            }
+            return std::memcmp(&reinterpret_cast<const sockaddr_in6&>(a).sin6_addr,
+                               &reinterpret_cast<const sockaddr_in6&>(b).sin6_addr, 16) == 0;
+        }
+
+        // 按地址匹配候选；v4-mapped IPv6 与对应的 IPv4 候选视为同一地址
+        Candidate* FindLocked(const sockaddr* addr) {
+            if (!addr) return nullptr;
+            sockaddr_storage key{};
+            if (addr->sa_family == AF_INET) {
+                std::memcpy(&key, addr, sizeof(sockaddr_in));
+            } else if (addr->sa_family == AF_INET6) {
+                const auto* in6 = reinterpret_cast<const sockaddr_in6*>(addr);
+                const uint8_t* bytes = reinterpret_cast<const uint8_t*>(&in6->sin6_addr);
+                static const uint8_t kMappedPrefix[12] = {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0xFF, 0xFF};
+                if (std::memcmp(bytes, kMappedPrefix, 12) == 0) {
+                    auto* in4 = reinterpret_cast<sockaddr_in*>(&key);
+                    in4->sin_family = AF_INET;
+                    std::memcpy(&in4->sin_addr, bytes + 12, 4);
+                } else {
+                    std::memcpy(&key, addr, sizeof(sockaddr_in6));
+                }
+            } else {
+                return nullptr;
+            }
+            for (Candidate& c : m_addrs) {
+                if (SameAddr(c.addr, key)) return &c;
+            }
+            return nullptr;
+        }
+
+        bool EnsureResolved(int* outErr) {
+            {
+                std::lock_guard<std::mutex> lock(m_mtx);
+                if (!m_configured) {
+                    if (outErr) *outErr = EAI_FAIL;
+                    return false;
+                }
+                if (!m_addrs.empty()) return true;
+                if (m_retryAt != 0 && m_now() < m_retryAt) {
+                    if (outErr) *outErr = m_lastError;
+                    return false;
+                }
+            }
+            // 首次解析（或上次失败已过重试间隔）：并发调用方合并为一次同步解析，之后交给后台刷新
+            int rc = 0;
+            const auto status = m_initFlight.Do("resolve", [this]() {
+                int err = 0;
+                if (RefreshNow(&err)) StartRefresher();
+                return err;
+            }, kInitialWaitMs, &rc);
+            if (status == Core::SingleFlight<int>::Status::TimedOut ||
+                status == Core::SingleFlight<int>::Status::Cancelled) {
+                rc = EAI_AGAIN;
+            }
+            std::lock_guard<std::mutex> lock(m_mtx);
+            if (m_addrs.empty() && outErr) *outErr = rc != 0 ? rc : EAI_FAIL;
+            return !m_addrs.empty();
+        }
+
+        void RefreshLoop() {
+            std::unique_lock<std::mutex> lock(m_mtx);
+            while (!m_stopping) {
+                m_cv.wait_for(lock, std::chrono::milliseconds(m_refreshMs ? m_refreshMs : 60000));
+                if (m_stopping) break;
+                lock.unlock();
+                RefreshNow();
+                lock.lock();
+            }
+        }
+
+        std::mutex m_mtx;
+        std::condition_variable m_cv;
+        Resolver m_resolver;
+        NowFn m_now;
+        std::string m_host;
+        uint16_t m_port = 0;
+        bool m_configured = false;
+        bool m_isLiteral = false;
+        uint32_t m_refreshMs = 60000;
+        uint64_t m_generation = 0;
+        std::vector<Candidate> m_addrs;
+        size_t m_cursor = 0;
+        int m_lastError = 0;
+        uint64_t m_retryAt = 0;
+        uint64_t m_refreshes = 0;
+        std::thread m_worker;
+        bool m_stopping = false;
+        Core::SingleFlight<int> m_initFlight;
+    };
+}
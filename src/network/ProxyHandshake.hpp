@@ -0,0 +1,252 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include "HttpConnectCodec.hpp"
+#include "Socks5Codec.hpp"
+
+namespace Network {
+
+    // ============= 非阻塞代理握手状态机（不涉及 socket） =============
+    // 设计意图：阻塞握手（Socks5Client / HttpConnectClient）在 IOCP 完成回调里执行时会卡住应用的
+    // 工作线程。这里把 SOCKS5（逐步/流水线）与 HTTP CONNECT 握手拆成纯状态机：调用方按 Next() 的指示
+    // 发送 SendData()、或读取到 RecvBuffer()，再把实际字节数交回；状态机本身不做 I/O、不分配内存。
+    // - Recv：读取不超过 RecvSize() 字节（SOCKS5 按已知响应边界，不会吞掉隧道首包数据）
+    // - Peek：HTTP 响应头长度未知，先 peek 可读数据交给 OnPeeked，随后的 Recv 只消费到空行为止
+    //   （与 PeekReader 相同的策略）；Peek 时 RecvSize() 为剩余容量
+    // Windows 上由 Hooks 的重叠 I/O 驱动，Linux 测试/基准用 epoll 驱动，协议逻辑只有这一份。
+    class ProxyHandshake {
+    public:
+        enum class Protocol { Socks5, Socks5Pipelined, Http };
+        enum class Want { Send, Recv, Peek, Done, Failed };
+        enum class Error {
+            None,
+            Encode,           // 目标地址无法编码
+            Closed,           // 握手中途连接被关闭
+            BadMethod,        // SOCKS5 认证方式不被接受
+            BadReply,         // 响应不符合协议
+            Rejected,         // 代理拒绝（REP != 0 / 状态码 != 200）
+            TooLong,          // HTTP 响应头超过上限
+            PipelineRejected, // 代理不接受流水线握手（认证响应后断开 / CONNECT 响应无效）
+        };
+
+        // 开始握手；目标无法编码时返回 false（Next() 为 Failed）
+        bool Start(Protocol protocol, const std::string& host, uint16_t port) {
+            m_protocol = protocol;
+            m_error = Error::None;
+            m_replyCode = 0;
+            m_httpStatus = 0;
+            m_outLen = 0;
+            m_outSent = 0;
+            m_connectLen = 0;
+            m_inUsed = 0;
+            m_inWant = 0;
+            m_replyBase = 0;
+            m_headerEnd = 0;
+
+            if (protocol == Protocol::Http) {
+                m_outLen = HttpConnect::EncodeRequest(host, port, (char*)m_out, sizeof(m_out));
+                if (m_outLen == 0) return Fail(Error::Encode);
+                m_stage = Stage::SendHttpRequest;
+                m_want = Want::Send;
+                return true;
+            }
+            // 认证请求与 CONNECT 一次编码；逐步模式先只发认证请求，协商完成后再发后半段
+            const size_t greetingLen = Socks5::EncodeGreeting(m_out, sizeof(m_out));
+            m_connectLen = Socks5::EncodeRequest(Socks5::CMD_CONNECT, host, port, m_out + greetingLen,
+                                                 sizeof(m_out) - greetingLen);
+            if (m_connectLen == 0) return Fail(Error::Encode);
+            m_outLen = protocol == Protocol::Socks5Pipelined ? greetingLen + m_connectLen : greetingLen;
+            m_stage = Stage::SendGreeting;
+            m_want = Want::Send;
+            return true;
+        }
+
+        Want Next() const { return m_want; }
+        Error GetError() const { return m_error; }
+        Protocol GetProtocol() const { return m_protocol; }
+        uint8_t ReplyCode() const { return m_replyCode; }  // SOCKS5 REP
+        int HttpStatus() const { return m_httpStatus; }    // HTTP 状态码（解析失败为 -1）
+
+        // 已收到的响应字节（失败时用于日志摘要）
+        const uint8_t* Received() const { return m_in; }
+        size_t ReceivedSize() const { return m_inUsed; }
+
+        const uint8_t* SendData() const { return m_out + m_outSent; }
+        size_t SendSize() const { return m_outLen - m_outSent; }
+
+        void OnSent(size_t n) {
+            if (m_want != Want::Send) return;
+            m_outSent += n < SendSize() ? n : SendSize();
+            if (SendSize() > 0) return;
+            switch (m_stage) {
+                case Stage::SendGreeting:
+                    ExpectRecv(Stage::RecvMethod, Socks5::kMethodReplyBytes);
+                    break;
+                case Stage::SendConnect:
+                    ExpectRecv(Stage::RecvReply, 4);
+                    break;
+                case Stage::SendHttpRequest:
+                    m_stage = Stage::RecvHttpHeader;
+                    m_want = Want::Peek;
+                    break;
+                default:
+                    break;
+            }
+        }
+
+        uint8_t* RecvBuffer() { return m_in + m_inUsed; }
+        size_t RecvSize() const {
+            if (m_want == Want::Peek) return sizeof(m_in) - m_inUsed;
+            return m_inWant > m_inUsed ? m_inWant - m_inUsed : 0;
+        }
+
+        // Recv 完成：n 为实际读到的字节数，0 表示对端关闭
+        void OnReceived(size_t n) {
+            if (m_want != Want::Recv) return;
+            if (n == 0) {
+                // 流水线：认证响应已到、CONNECT 响应前断开，说明代理丢弃了提前到达的 CONNECT
+                const bool afterMethod = m_protocol == Protocol::Socks5Pipelined && m_stage == Stage::RecvReply;
+                Fail(afterMethod ? Error::PipelineRejected : Error::Closed);
+                return;
+            }
+            m_inUsed += n < RecvSize() ? n : RecvSize();
+            if (m_inUsed < m_inWant) return;
+            switch (m_stage) {
+                case Stage::RecvMethod: OnMethodReply(); break;
+                case Stage::RecvReply: OnConnectReply(); break;
+                case Stage::RecvHttpHeader: OnHttpConsumed(); break;
+                default: break;
+            }
+        }
+
+        // Peek 完成：RecvBuffer() 起的 n 字节为当前可读数据（未消费），0 表示对端关闭
+        void OnPeeked(size_t n) {
+            if (m_want != Want::Peek) return;
+            if (n == 0) {
+                Fail(Error::Closed);
+                return;
+            }
+            const size_t cap = sizeof(m_in) - m_inUsed;
+            if (n > cap) n = cap;
+            const size_t avail = m_inUsed + n;
+            HttpConnect::Response response;
+            switch (HttpConnect::DecodeResponse((const char*)m_in, avail, &response, m_inUsed)) {
+                case HttpConnect::DecodeStatus::Done:
+                    m_headerEnd = response.length;
+                    m_httpStatus = response.status;
+                    m_inWant = response.length;
+                    break;
+                case HttpConnect::DecodeStatus::Invalid:
+                    m_httpStatus = -1;
+                    Fail(Error::BadReply);
+                    return;
+                default:
+                    // 还没见到空行：当前数据都属于响应头，全部消费
+                    m_headerEnd = 0;
+                    m_inWant = avail;
+                    break;
+            }
+            m_want = Want::Recv;
+        }
+
+    private:
+        enum class Stage { SendGreeting, RecvMethod, SendConnect, RecvReply, SendHttpRequest, RecvHttpHeader, Finished };
+
+        bool Fail(Error error) {
+            m_error = error;
+            m_stage = Stage::Finished;
+            m_want = Want::Failed;
+            return false;
+        }
+
+        void Succeed() {
+            m_stage = Stage::Finished;
+            m_want = Want::Done;
+        }
+
+        // 从头开始接收一个新响应（流水线模式下响应紧接在认证响应之后）
+        void ExpectRecv(Stage stage, size_t want) {
+            m_stage = stage;
+            m_want = Want::Recv;
+            m_inWant = m_replyBase + want;
+        }
+
+        void OnMethodReply() {
+            uint8_t method = Socks5::AUTH_NO_ACCEPTABLE;
+            if (Socks5::DecodeMethodReply(m_in, m_inUsed, &method) != Socks5::DecodeStatus::Done ||
+                method != Socks5::AUTH_NONE) {
+                Fail(Error::BadMethod);
+                return;
+            }
+            if (m_protocol == Protocol::Socks5Pipelined) {
+                // CONNECT 已随认证请求发出，直接读响应
+                m_replyBase = Socks5::kMethodReplyBytes;
+                ExpectRecv(Stage::RecvReply, 4);
+                return;
+            }
+            m_inUsed = 0;
+            m_outLen += m_connectLen;
+            m_stage = Stage::SendConnect;
+            m_want = Want::Send;
+        }
+
+        void OnConnectReply() {
+            Socks5::Reply reply;
+            size_t need = 0;
+            const Socks5::DecodeStatus st =
+                Socks5::DecodeReply(m_in + m_replyBase, m_inUsed - m_replyBase, &reply, &need);
+            if (st == Socks5::DecodeStatus::NeedMore) {
+                m_inWant = m_replyBase + need;
+                return;
+            }
+            if (st == Socks5::DecodeStatus::Invalid) {
+                Fail(m_protocol == Protocol::Socks5Pipelined ? Error::PipelineRejected : Error::BadReply);
+                return;
+            }
+            m_replyCode = reply.rep;
+            if (reply.rep != Socks5::REPLY_SUCCESS) {
+                Fail(Error::Rejected);
+                return;
+            }
+            Succeed();
+        }
+
+        void OnHttpConsumed() {
+            if (m_headerEnd == 0) {
+                // 还没见到空行：已消费的字节都属于响应头，继续 peek
+                if (m_inUsed >= sizeof(m_in)) {
+                    Fail(Error::TooLong);
+                    return;
+                }
+                m_want = Want::Peek;
+                return;
+            }
+            if (m_httpStatus != 200) {
+                Fail(Error::Rejected);
+                return;
+            }
+            Succeed();
+        }
+
+        Protocol m_protocol = Protocol::Socks5;
+        Stage m_stage = Stage::Finished;
+        Want m_want = Want::Failed;
+        Error m_error = Error::None;
+        uint8_t m_replyCode = 0;
+        int m_httpStatus = 0;
+
+        uint8_t m_out[HttpConnect::kMaxRequestBytes > Socks5::kGreetingBytes + Socks5::kMaxRequestBytes
+                          ? HttpConnect::kMaxRequestBytes
+                          : Socks5::kGreetingBytes + Socks5::kMaxRequestBytes];
+        size_t m_outLen = 0;
+        size_t m_outSent = 0;
+        size_t m_connectLen = 0;  // SOCKS5 CONNECT 请求长度（紧跟在认证请求之后）
+
+        uint8_t m_in[HttpConnect::kMaxResponseBytes];
+        size_t m_inUsed = 0;
+        size_t m_inWant = 0;      // Recv 时需要读到的总字节数
+        size_t m_replyBase = 0;   // CONNECT 响应在 m_in 中的起始位置（流水线为认证响应之后）
+        size_t m_headerEnd = 0;   // HTTP：本轮 peek 解析出的响应头长度（0 表示还没见到空行）
+    };
+}
@@ -0,0 +1,208 @@
+#pragma once
+#include <cstddef>
+#include <string>
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#else
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace Network {
+    // ============= 命名共享内存段（跨进程） =============
+    // Windows：分页文件支持的命名映射（CreateFileMappingA + MapViewOfFile）
+    // POSIX：shm_open + mmap，仅用于在 Linux 上跨进程测试共享表结构
+    // 名称统一使用 Windows 风格（如 "Local\\Xxx"），POSIX 下转换为 "/Xxx"
+    // 另支持文件支持的映射（OpenFile）：内容随文件持久化，进程重启后仍在
+    class SharedMemoryRegion {
+    public:
+        SharedMemoryRegion() = default;
+        SharedMemoryRegion(const SharedMemoryRegion&) = delete;
+        SharedMemoryRegion& operator=(const SharedMemoryRegion&) = delete;
+        ~SharedMemoryRegion() { Close(); }
+
+        // 打开或创建命名段；created 返回本次是否新建（新建段内容全为 0）
+        bool Open(const std::string& name, size_t bytes, bool* created) {
+            Close();
+            if (created) *created = false;
+#ifdef _WIN32
+            const unsigned long long size64 = bytes;
+            m_handle = CreateFileMappingA(INVALID_HANDLE_VALUE, NULL, PAGE_READWRITE,
+                                          static_cast<DWORD>(size64 >> 32), static_cast<DWORD>(size64 & 0xFFFFFFFF),
+                                          name.c_str());
+            if (!m_handle) return false;
+            const bool isNew = (GetLastError() != ERROR_ALREADY_EXISTS);
+            m_data = MapViewOfFile(m_handle, FILE_MAP_ALL_ACCESS, 0, 0, bytes);
+            if (!m_data) {
+                CloseHandle(m_handle);
+                m_handle = NULL;
+                return false;
+            }
+#else
+            const std::string posixName = PosixName(name);
+            bool isNew = true;
+            int fd = shm_open(posixName.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+            if (fd < 0 && errno == EEXIST) {
+                isNew = false;
+                fd = shm_open(posixName.c_str(), O_RDWR, 0600);
+            }
+            if (fd < 0) return false;
+            struct stat st;
+            if (fstat(fd, &st) != 0 || ((size_t)st.st_size < bytes && ftruncate(fd, (off_t)bytes) != 0)) {
+                close(fd);
+                return false;
+            }
+            void* p = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+            close(fd);
+            if (p == MAP_FAILED) return false;
+            m_data = p;
+#endif
+            m_size = bytes;
+            if (created) *created = isNew;
+            return true;
+        }
+
+        // 打开或创建映射文件并映射前 bytes 字节。所有使用者对文件持有共享锁；
+        // exclusive 返回本进程打开时是否为唯一使用者（此时持有独占锁，可安全地重建内容，
+        // 完成后调用 DowngradeToShared）。非唯一使用者要求文件大小与 bytes 完全一致，
+        // 否则返回 false（不在他人使用中改变文件大小）
+        bool OpenFile(const std::string& path, size_t bytes, bool* exclusive) {
+            Close();
+            if (exclusive) *exclusive = false;
+            if (bytes == 0) return false;
+#ifdef _WIN32
+            m_file = CreateFileA(path.c_str(), GENERIC_READ | GENERIC_WRITE,
+                                 FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, NULL, OPEN_ALWAYS,
+                                 FILE_ATTRIBUTE_NORMAL, NULL);
+            if (m_file == INVALID_HANDLE_VALUE) {
+                m_file = NULL;
+                return false;
+            }
+            OVERLAPPED ov = LockRange();
+            const bool isExclusive =
+                LockFileEx(m_file, LOCKFILE_EXCLUSIVE_LOCK | LOCKFILE_FAIL_IMMEDIATELY, 0, 1, 0, &ov) != FALSE;
+            // 有人正在独占重建时，共享锁会等到对方降级后才返回，不会看到半成品
+            if (!isExclusive && !LockFileEx(m_file, 0, 0, 1, 0, &ov)) {
+                Close();
+                return false;
+            }
+            LARGE_INTEGER size;
+            if (!GetFileSizeEx(m_file, &size)) {
+                Close();
+                return false;
+            }
+            if ((unsigned long long)size.QuadPart != bytes) {
+                LARGE_INTEGER want;
+                want.QuadPart = (LONGLONG)bytes;
+                if (!isExclusive || !SetFilePointerEx(m_file, want, NULL, FILE_BEGIN) || !SetEndOfFile(m_file)) {
+                    Close();
+                    return false;
+                }
+            }
+            m_handle = CreateFileMappingA(m_file, NULL, PAGE_READWRITE, 0, 0, NULL);
+            if (m_handle) m_data = MapViewOfFile(m_handle, FILE_MAP_ALL_ACCESS, 0, 0, bytes);
+#else
+            m_fd = open(path.c_str(), O_RDWR | O_CREAT, 0600);
+            if (m_fd < 0) return false;
+            const bool isExclusive = flock(m_fd, LOCK_EX | LOCK_NB) == 0;
+            if (!isExclusive && flock(m_fd, LOCK_SH) != 0) {
+                Close();
+                return false;
+            }
+            struct stat st;
+            if (fstat(m_fd, &st) != 0 ||
+                ((size_t)st.st_size != bytes && (!isExclusive || ftruncate(m_fd, (off_t)bytes) != 0))) {
+                Close();
+                return false;
+            }
+            void* p = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, m_fd, 0);
+            if (p != MAP_FAILED) m_data = p;
+#endif
+            if (!m_data) {
+                Close();
+                return false;
+            }
+            m_size = bytes;
+            m_exclusive = isExclusive;
+            if (exclusive) *exclusive = isExclusive;
+            return true;
+        }
+
+        // 独占锁降级为共享锁，允许其他进程打开同一文件
+        void DowngradeToShared() {
+            if (!m_exclusive) return;
+            m_exclusive = false;
+#ifdef _WIN32
+            OVERLAPPED ov = LockRange();
+            UnlockFileEx(m_file, 0, 1, 0, &ov);
+            ov = LockRange();
+            LockFileEx(m_file, 0, 0, 1, 0, &ov);
+#else
+            flock(m_fd, LOCK_SH);
+#endif
+        }
+
+        void Close() {
+#ifdef _WIN32
+            if (m_data) UnmapViewOfFile(m_data);
+            if (m_handle) CloseHandle(m_handle);
+            if (m_file) CloseHandle(m_file); // 同时释放文件锁
+            m_handle = NULL;
+            m_file = NULL;
+#else
+            if (m_data) munmap(m_data, m_size);
+            if (m_fd >= 0) close(m_fd);
+            m_fd = -1;
+#endif
+            m_exclusive = false;
+            m_data = nullptr;
+            m_size = 0;
+        }
+
+        // 删除命名段（仅 POSIX 有意义；Windows 下最后一个句柄关闭即自动释放）
+        static void Remove(const std::string& name) {
+#ifdef _WIN32
+            (void)name;
+#else
+            shm_unlink(PosixName(name).c_str());
+#endif
+        }
+
+        void* Data() const { return m_data; }
+        size_t Size() const { return m_size; }
+        bool IsOpen() const { return m_data != nullptr; }
+
+    private:
+#ifdef _WIN32
+        // 文件锁加在远超映射大小的单字节上：只用于协调使用者，不影响映射视图读写
+        static OVERLAPPED LockRange() {
+            OVERLAPPED ov = {};
+            ov.Offset = 0;
+            ov.OffsetHigh = 0x7FFFFFFF;
+            return ov;
+        }
+#else
+        static std::string PosixName(const std::string& name) {
+            const size_t sep = name.find_last_of('\\');
+            return "/" + (sep == std::string::npos ? name : name.substr(sep + 1));
+        }
+#endif
+
+#ifdef _WIN32
+        HANDLE m_handle = NULL; // 映射对象
+        HANDLE m_file = NULL;   // 仅文件映射
+#else
+        int m_fd = -1;          // 仅文件映射（持有 flock）
+#endif
+        void* m_data = nullptr;
+        size_t m_size = 0;
+        bool m_exclusive = false;
+    };
+}
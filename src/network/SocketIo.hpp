@@ -5,6 +5,7 @@
 #include <chrono>
 #include <limits>
 #include <string>
+#include "PeekReader.hpp"
 
 namespace Network {
 namespace SocketIo {
@@ -72,6 +73,20 @@ inline bool WaitWritable(SOCKET sock, int timeoutMs) {
     return false;
 }
 
+// 空闲连接存活检查（不阻塞）：协商完成后代理不应主动发数据，可读即意味着 FIN/RST 或异常数据
+inline bool IsIdleConnectionAlive(SOCKET sock) {
+    if (sock == INVALID_SOCKET) return false;
+    fd_set readSet;
+    FD_ZERO(&readSet);
+    FD_SET(sock, &readSet);
+    timeval tv{};
+    if (select(0, &readSet, nullptr, nullptr, &tv) != 0) return false;
+    int soError = 0;
+    int optLen = sizeof(soError);
+    if (getsockopt(sock, SOL_SOCKET, SO_ERROR, (char*)&soError, &optLen) != 0) return false;
+    return soError == 0;
+}
+
 // 等待连接完成并检查 SO_ERROR，适配非阻塞 connect
 inline bool WaitConnect(SOCKET sock, int timeoutMs) {
     if (!WaitWritable(sock, timeoutMs)) return false;
@@ -139,42 +154,74 @@ inline bool RecvExact(SOCKET sock, uint8_t* buf, int len, int timeoutMs) {
     return true;
 }
 
-// 逐字节接收直到命中分隔符，避免吞掉隧道首包数据
+// 接收至多 len 字节（有数据即返回），返回读到的字节数；失败返回 -1，对端关闭时错误码为 WSAECONNRESET
+inline int RecvSome(SOCKET sock, uint8_t* buf, int len, int timeoutMs) {
+    const auto deadline = BuildDeadline(timeoutMs);
+    for (;;) {
+        int read = recv(sock, (char*)buf, len, 0);
+        if (read > 0) return read;
+        if (read == 0) {
+            WSASetLastError(WSAECONNRESET);
+            return -1;
+        }
+        int err = WSAGetLastError();
+        if (err == WSAEWOULDBLOCK || err == WSAEINPROGRESS) {
+            const int waitMs = RemainingTimeoutMs(deadline);
+            if (waitMs <= 0) return -1;
+            if (!WaitReadable(sock, waitMs)) return -1;
+            continue;
+        }
+        return -1;
+    }
+}
+
+// 接收直到命中分隔符（含分隔符），分隔符之后的隧道首包数据留在 socket 中
+// 基于 MSG_PEEK：先窥视可读数据、再只消费到分隔符末尾，典型响应 2 次系统调用（见 PeekReader.hpp）
 inline bool RecvUntil(SOCKET sock, std::string* out, const std::string& delimiter, int timeoutMs, int maxBytes) {
     if (!out) {
         WSASetLastError(WSAEINVAL);
         return false;
     }
     if (maxBytes <= 0) maxBytes = 1024;
+    struct WinsockIo {
+        SOCKET sock;
+        int Peek(char* buf, int len) { return recv(sock, buf, len, MSG_PEEK); }
+        int Take(char* buf, int len) { return recv(sock, buf, len, 0); }
+        bool WouldBlock() const {
+            const int err = WSAGetLastError();
+            return err == WSAEWOULDBLOCK || err == WSAEINPROGRESS;
+        }
+    };
+    WinsockIo io{sock};
     const auto deadline = BuildDeadline(timeoutMs);
-    out->clear();
-    out->reserve((size_t)maxBytes);
-    while ((int)out->size() < maxBytes) {
-        char ch = '\0';
-        int read = recv(sock, &ch, 1, 0);
-        if (read > 0) {
-            out->push_back(ch);
-            if (out->size() >= delimiter.size() &&
-                out->find(delimiter) != std::string::npos) {
+    out->resize((size_t)maxBytes);
+    size_t used = 0;
+    for (;;) {
+        const PeekReader::Step step = PeekReader::ReadStep(io, &(*out)[0], (size_t)maxBytes, &used, delimiter);
+        switch (step) {
+            case PeekReader::Step::Done:
+                out->resize(used);
                 return true;
+            case PeekReader::Step::Wait: {
+                const int waitMs = RemainingTimeoutMs(deadline);
+                if (waitMs <= 0 || !WaitReadable(sock, waitMs)) {
+                    out->resize(used);
+                    return false;
+                }
+                continue;
             }
-            continue;
-        }
-        if (read == 0) {
-            WSASetLastError(WSAECONNRESET);
-            return false;
-        }
-        int err = WSAGetLastError();
-        if (err == WSAEWOULDBLOCK || err == WSAEINPROGRESS) {
-            const int waitMs = RemainingTimeoutMs(deadline);
-            if (waitMs <= 0) return false;
-            if (!WaitReadable(sock, waitMs)) return false;
-            continue;
+            case PeekReader::Step::Closed:
+                WSASetLastError(WSAECONNRESET);
+                break;
+            case PeekReader::Step::TooLong:
+                WSASetLastError(WSAEMSGSIZE);
+                break;
+            case PeekReader::Step::Failed:
+                break;
         }
+        out->resize(used);
         return false;
     }
-    WSASetLastError(WSAEMSGSIZE);
-    return false;
 }
 
 } // namespace SocketIo
@@ -0,0 +1,127 @@
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace Network {
+    // ============= 按句柄分片的状态表 =============
+    // 设计意图：Hooks 里每个 socket 的状态原先分散在多张全局 unordered_map 中、各自一把全局锁，
+    // 一次 UDP WSASend 要依次拿三把锁，所有 IOCP 线程都汇聚到同几把锁上。这里把同一 key 的状态
+    // 合并成一个 State，按 key 哈希分片，每片一把小锁：
+    // - 分片按缓存行对齐，不同分片的锁与桶头不会落在同一缓存行上互相弹跳
+    // - 回调在分片锁内执行：只做字段读写/拷贝，不要做阻塞 I/O、不要重入本表
+    // - key 为整数或指针（SOCKET / OVERLAPPED*）：低位往往对齐为 0，分片前先做乘法散列
+    // Key 只要求能转成 uintptr_t：Hooks 中为 SOCKET / LPOVERLAPPED，测试与基准用 uintptr_t 模拟。
+    template <typename Key, typename State>
+    class SocketStateTable {
+    public:
+        static constexpr size_t kShardCount = 64; // 须为 2 的幂
+
+        // 在 key 对应的状态上执行 fn(State&)；不存在时返回 false 且不调用 fn
+        template <typename Fn>
+        bool Visit(Key key, Fn&& fn) {
+            Shard& shard = ShardOf(key);
+            std::lock_guard<std::mutex> lock(shard.mtx);
+            auto it = shard.map.find(key);
+            if (it == shard.map.end()) return false;
+            fn(it->second);
+            return true;
+        }
+
+        // 不存在时先默认构造，再执行 fn(State&)
+        template <typename Fn>
+        void Upsert(Key key, Fn&& fn) {
+            Shard& shard = ShardOf(key);
+            std::lock_guard<std::mutex> lock(shard.mtx);
+            fn(shard.map[key]);
+        }
+
+        // 执行 fn(State&) -> bool：返回 false 时删除该条目（用于“清掉一个字段后状态为空”）
+        // 不存在时返回 false 且不调用 fn
+        template <typename Fn>
+        bool Update(Key key, Fn&& fn) {
+            Shard& shard = ShardOf(key);
+            std::lock_guard<std::mutex> lock(shard.mtx);
+            auto it = shard.map.find(key);
+            if (it == shard.map.end()) return false;
+            if (!fn(it->second)) shard.map.erase(it);
+            return true;
+        }
+
+        // 取出并删除；out 可为空（仅删除）
+        bool Take(Key key, State* out) {
+            Shard& shard = ShardOf(key);
+            std::lock_guard<std::mutex> lock(shard.mtx);
+            auto it = shard.map.find(key);
+            if (it == shard.map.end()) return false;
+            if (out) *out = std::move(it->second);
+            shard.map.erase(it);
+            return true;
+        }
+
+        bool Erase(Key key) { return Take(key, nullptr); }
+
+        // 逐分片扫描，pred(Key, State&) 返回 true 的条目被删除；返回删除条数。
+        // 仅用于低频清理（关闭 socket、过期回收），不要放在每次 I/O 的路径上。
+        template <typename Pred>
+        size_t EraseIf(Pred&& pred) {
+            size_t erased = 0;
+            for (Shard& shard : m_shards) {
+                std::lock_guard<std::mutex> lock(shard.mtx);
+                for (auto it = shard.map.begin(); it != shard.map.end();) {
+                    if (pred(it->first, it->second)) {
+                        it = shard.map.erase(it);
+                        erased++;
+                    } else {
+                        ++it;
+                    }
+                }
+            }
+            return erased;
+        }
+
+        // 取出全部条目并清空（卸载时在锁外统一释放资源）
+        std::vector<std::pair<Key, State>> TakeAll() {
+            std::vector<std::pair<Key, State>> all;
+            for (Shard& shard : m_shards) {
+                std::lock_guard<std::mutex> lock(shard.mtx);
+                for (auto& kv : shard.map) all.emplace_back(kv.first, std::move(kv.second));
+                shard.map.clear();
+            }
+            return all;
+        }
+
+        size_t Size() {
+            size_t n = 0;
+            for (Shard& shard : m_shards) {
+                std::lock_guard<std::mutex> lock(shard.mtx);
+                n += shard.map.size();
+            }
+            return n;
+        }
+
+        // 分片下标（测试用于检查散列是否均匀）
+        static size_t ShardIndex(Key key) {
+            static_assert((kShardCount & (kShardCount - 1)) == 0, "kShardCount 须为 2 的幂");
+            // Fibonacci 散列：取乘积高位，SOCKET（4 的倍数）与对齐指针也能均匀分布
+            const uint64_t h = (uint64_t)(uintptr_t)key * 0x9E3779B97F4A7C15ull;
+            return (size_t)(h >> (64 - Log2(kShardCount)));
+        }
+
+    private:
+        struct alignas(64) Shard {
+            std::mutex mtx;
+            std::unordered_map<Key, State> map;
+        };
+
+        static constexpr int Log2(size_t n) { return n <= 1 ? 0 : 1 + Log2(n / 2); }
+
+        Shard& ShardOf(Key key) { return m_shards[ShardIndex(key)]; }
+
+        std::array<Shard, kShardCount> m_shards;
+    };
+}
@@ -1,30 +1,19 @@
 #pragma once
 #include <winsock2.h>
 #include <ws2tcpip.h>
+#include <atomic>
 #include <chrono>
 #include <limits>
 #include <string>
-#include <vector>
 #include <sstream>
 #include <iomanip>
 #include "../core/Config.hpp"
 #include "../core/Logger.hpp"
 #include "SocketIo.hpp"
+#include "Socks5Codec.hpp"
 
 namespace Network {
     
-    // SOCKS5 Protocol Constants
-    namespace Socks5 {
-        constexpr uint8_t VERSION = 0x05;
-        constexpr uint8_t AUTH_NONE = 0x00;
-        constexpr uint8_t CMD_CONNECT = 0x01;
-        constexpr uint8_t CMD_UDP_ASSOCIATE = 0x03;
-        constexpr uint8_t ATYP_IPV4 = 0x01;
-        constexpr uint8_t ATYP_DOMAIN = 0x03;
-        constexpr uint8_t ATYP_IPV6 = 0x04;
-        constexpr uint8_t REPLY_SUCCESS = 0x00;
-    }
-    
     class Socks5Client {
     private:
         using SteadyClock = std::chrono::steady_clock;
@@ -91,7 +80,138 @@ namespace Network {
             return SocketIo::RecvExact(sock, buf, len, timeoutMs);
         }
 
+        // 流水线握手（仅无认证）：认证协商与 CONNECT 一次 send 发出，两个响应从同一缓冲区依次解析，
+        // 比逐步握手少等一个代理 RTT。每次只读到当前已知的响应边界，不会吞掉隧道首包数据。
+        // 回退：认证响应之后连接被关闭，或 CONNECT 响应位置出现非 SOCKS5 字节，说明代理丢弃/误读了
+        // 提前到达的 CONNECT，本次连接失败并置位 PipelineRejected，之后的连接走逐步握手；
+        // 认证方式不被接受、REP 非 0 等与流水线无关的失败不触发回退。
+        static bool HandshakePipelined(SOCKET sock, const std::string& targetHost, uint16_t targetPort,
+                                       const SteadyClock::time_point& deadline, int sendTimeout, int recvTimeout) {
+            const std::string sockText = std::to_string((unsigned long long)sock);
+            uint8_t request[Socks5::kGreetingBytes + Socks5::kMaxRequestBytes];
+            size_t requestLen = Socks5::EncodeGreeting(request, sizeof(request));
+            uint8_t atyp = 0;
+            const size_t connectLen = Socks5::EncodeRequest(Socks5::CMD_CONNECT, targetHost, targetPort,
+                                                            request + requestLen, sizeof(request) - requestLen, &atyp);
+            if (connectLen == 0) {
+                Core::Logger::Error("SOCKS5: [流水线] 目标地址无法编码, sock=" + sockText +
+                                    ", len=" + std::to_string(targetHost.size()));
+                WSASetLastError(WSAEINVAL);
+                return false;
+            }
+            requestLen += connectLen;
+
+            AGP_LOG_DEBUG("SOCKS5: [流水线] 发送认证协商 + CONNECT, sock={}, ATYP={}, payload_len={}",
+                          (unsigned long long)sock, atyp, requestLen);
+            int timeoutMs = RemainingTimeoutMs(deadline, sendTimeout);
+            if (timeoutMs <= 0) {
+                Core::Logger::Error("SOCKS5: [流水线] 发送请求 握手预算耗尽, sock=" + sockText);
+                return false;
+            }
+            if (!SocketIo::SendAll(sock, (const char*)request, (int)requestLen, timeoutMs)) {
+                int err = WSAGetLastError();
+                Core::Logger::Error("SOCKS5: [流水线] 发送请求失败, sock=" + sockText +
+                                    ", WSA错误码=" + std::to_string(err));
+                return false;
+            }
+
+            // 认证响应(2) + CONNECT 响应（变长）；先按最短合法响应读取，解析出真实长度后再补齐
+            uint8_t reply[Socks5::kMethodReplyBytes + Socks5::kMaxReplyBytes];
+            size_t have = 0;
+            size_t want = Socks5::kMethodReplyBytes + Socks5::kMinReplyBytes;
+            bool methodChecked = false;
+            Socks5::Reply parsed;
+            for (;;) {
+                if (!methodChecked && have >= Socks5::kMethodReplyBytes) {
+                    uint8_t method = Socks5::AUTH_NO_ACCEPTABLE;
+                    if (Socks5::DecodeMethodReply(reply, have, &method) != Socks5::DecodeStatus::Done ||
+                        method != Socks5::AUTH_NONE) {
+                        Core::Logger::Error("SOCKS5: [流水线] 不支持的认证方式, sock=" + sockText +
+                                            ", bytes=" + HexDump(reply, Socks5::kMethodReplyBytes, 16));
+                        return false;
+                    }
+                    methodChecked = true;
+                }
+                if (methodChecked) {
+                    size_t need = 0;
+                    const Socks5::DecodeStatus st = Socks5::DecodeReply(
+                        reply + Socks5::kMethodReplyBytes, have - Socks5::kMethodReplyBytes, &parsed, &need);
+                    if (st == Socks5::DecodeStatus::Done) break;
+                    if (st == Socks5::DecodeStatus::Invalid) {
+                        Core::Logger::Error("SOCKS5: [流水线] CONNECT 响应无效, sock=" + sockText +
+                                            ", bytes=" + HexDump(reply, have, 16));
+                        RejectPipeline(sock, "CONNECT 响应无效");
+                        return false;
+                    }
+                    if (Socks5::kMethodReplyBytes + need > want) want = Socks5::kMethodReplyBytes + need;
+                }
+
+                timeoutMs = RemainingTimeoutMs(deadline, recvTimeout);
+                if (timeoutMs <= 0) {
+                    Core::Logger::Error("SOCKS5: [流水线] 读取响应 握手预算耗尽, sock=" + sockText);
+                    return false;
+                }
+                const int n = SocketIo::RecvSome(sock, reply + have, (int)(want - have), timeoutMs);
+                if (n <= 0) {
+                    int err = WSAGetLastError();
+                    Core::Logger::Error("SOCKS5: [流水线] 读取响应失败, sock=" + sockText +
+                                        ", 已读=" + std::to_string(have) + ", WSA错误码=" + std::to_string(err));
+                    if (have >= Socks5::kMethodReplyBytes && (err == WSAECONNRESET || err == WSAECONNABORTED)) {
+                        RejectPipeline(sock, "认证响应后连接被关闭");
+                    }
+                    return false;
+                }
+                have += (size_t)n;
+            }
+            AGP_LOG_DEBUG("SOCKS5: [流水线] 收到响应, sock={}, REP={}, ATYP={}, bytes={}",
+                          (unsigned long long)sock, parsed.rep, parsed.atyp, Core::BinaryLogHex{reply, have});
+
+            if (parsed.rep != Socks5::REPLY_SUCCESS) {
+                Core::Logger::Error("SOCKS5: [流水线] 代理服务器拒绝 CONNECT, sock=" + sockText +
+                                    ", REP=" + std::to_string(parsed.rep) + "(" + ReplyToText(parsed.rep) + ")" +
+                                    ", 目标=" + targetHost + ":" + std::to_string(targetPort) +
+                                    ", bytes=" + HexDump(reply, have, 16));
+                return false;
+            }
+
+            Core::Logger::Info("SOCKS5: 隧道建立成功(流水线), sock=" + sockText +
+                               ", 目标=" + targetHost + ":" + std::to_string(targetPort) +
+                               ", BND.ATYP=" + std::to_string(parsed.atyp) +
+                               ", BND.PORT=" + std::to_string(parsed.bndPort));
+            return true;
+        }
+
     public:
+        // 代理不接受流水线握手后置位（进程级），之后的连接都走逐步握手；ConnectEx 异步握手共用
+        static std::atomic<bool>& PipelineRejected() {
+            static std::atomic<bool> s_rejected{false};
+            return s_rejected;
+        }
+
+        static void RejectPipeline(SOCKET sock, const char* reason) {
+            if (PipelineRejected().exchange(true)) return;
+            Core::Logger::Warn(std::string("SOCKS5: 代理似乎不支持流水线握手(") + reason + "), sock=" +
+                               std::to_string((unsigned long long)sock) + ", 后续连接回退为逐步握手");
+        }
+
+        // 读取 CONNECT / UDP ASSOCIATE 响应：先按最短合法响应读取，再按 DecodeReply 给出的边界补齐，
+        // 不会吞掉隧道数据。buf 至少 kMaxReplyBytes；have 输出已读字节数（日志用）
+        // 返回 Done / Invalid；读取失败或超时返回 NeedMore（错误码见 WSAGetLastError）
+        static Socks5::DecodeStatus RecvReply(SOCKET sock, uint8_t* buf, size_t cap, size_t* have, Socks5::Reply* out,
+                                              const SteadyClock::time_point& deadline, int recvTimeout) {
+            *have = 0;
+            size_t want = Socks5::kMinReplyBytes;
+            for (;;) {
+                if (want > cap) return Socks5::DecodeStatus::Invalid;
+                const int timeoutMs = RemainingTimeoutMs(deadline, recvTimeout);
+                if (timeoutMs <= 0) return Socks5::DecodeStatus::NeedMore;
+                if (!ReadExact(sock, buf + *have, (int)(want - *have), timeoutMs)) return Socks5::DecodeStatus::NeedMore;
+                *have = want;
+                const Socks5::DecodeStatus st = Socks5::DecodeReply(buf, *have, out, &want);
+                if (st != Socks5::DecodeStatus::NeedMore) return st;
+            }
+        }
+
         // Execute SOCKS5 Handshake (No Auth)
         // Returns true if tunnel is established
         static bool Handshake(SOCKET sock, const std::string& targetHost, uint16_t targetPort, int handshakeBudgetMs = -1) {
@@ -121,206 +241,103 @@ namespace Network {
                 return false;
             }
 
-            if (Core::Logger::IsEnabled(Core::LogLevel::Debug)) {
-                Core::Logger::Debug("SOCKS5: 开始握手, sock=" + std::to_string((unsigned long long)sock) +
-                                    ", 目标=" + targetHost + ":" + std::to_string(targetPort) +
-                                    ", 预算=" + std::to_string(handshakeBudgetMs) + "ms");
-            }
+            AGP_LOG_DEBUG("SOCKS5: 开始握手, sock={}, 目标={}:{}, 预算={}ms",
+                          (unsigned long long)sock, targetHost, targetPort, handshakeBudgetMs);
 
-            // 1. Auth Method Negotiation
-            // +----+----------+----------+
-            // |VER | NMETHODS | METHODS  |
-            // +----+----------+----------+
-            // | 1  |    1     | 1 to 255 |
-            // +----+----------+----------+
-            uint8_t authRequest[3] = { Socks5::VERSION, 0x01, Socks5::AUTH_NONE };
-            if (Core::Logger::IsEnabled(Core::LogLevel::Debug)) {
-                Core::Logger::Debug("SOCKS5: [1/3] 发送认证协商, sock=" + std::to_string((unsigned long long)sock) +
-                                    ", bytes=" + HexDump(authRequest, 3, 16));
+            if (config.proxy.socks5_pipeline && !PipelineRejected().load(std::memory_order_relaxed)) {
+                return HandshakePipelined(sock, targetHost, targetPort, deadline, sendTimeout, recvTimeout);
             }
+
+            const std::string sockText = std::to_string((unsigned long long)sock);
+
+            // 1. 认证协商：VER NMETHODS METHODS
+            uint8_t authRequest[Socks5::kGreetingBytes];
+            const size_t authLen = Socks5::EncodeGreeting(authRequest, sizeof(authRequest));
+            AGP_LOG_DEBUG("SOCKS5: [1/3] 发送认证协商, sock={}, bytes={}",
+                          (unsigned long long)sock, Core::BinaryLogHex{authRequest, authLen});
             const int authReqTimeout = stepTimeout(sendTimeout, "[1/3] 发送认证协商");
             if (authReqTimeout <= 0) return false;
-            if (!SocketIo::SendAll(sock, (const char*)authRequest, 3, authReqTimeout)) {
+            if (!SocketIo::SendAll(sock, (const char*)authRequest, (int)authLen, authReqTimeout)) {
                 int err = WSAGetLastError();
-                Core::Logger::Error("SOCKS5: [1/3] 发送认证协商失败, sock=" + std::to_string((unsigned long long)sock) +
+                Core::Logger::Error("SOCKS5: [1/3] 发送认证协商失败, sock=" + sockText +
                                     ", WSA错误码=" + std::to_string(err));
                 return false;
             }
-            
-            // Receive Auth Method Response
-            uint8_t authResponse[2];
+
+            uint8_t authResponse[Socks5::kMethodReplyBytes];
             const int authRespTimeout = stepTimeout(recvTimeout, "[1/3] 读取认证响应");
             if (authRespTimeout <= 0) return false;
-            if (!ReadExact(sock, authResponse, 2, authRespTimeout)) {
+            if (!ReadExact(sock, authResponse, (int)sizeof(authResponse), authRespTimeout)) {
                 int err = WSAGetLastError();
-                Core::Logger::Error("SOCKS5: [1/3] 读取认证响应失败, sock=" + std::to_string((unsigned long long)sock) +
+                Core::Logger::Error("SOCKS5: [1/3] 读取认证响应失败, sock=" + sockText +
                                     ", WSA错误码=" + std::to_string(err));
                 return false;
             }
-            if (Core::Logger::IsEnabled(Core::LogLevel::Debug)) {
-                Core::Logger::Debug("SOCKS5: [1/3] 收到认证响应, sock=" + std::to_string((unsigned long long)sock) +
-                                    ", VER=" + std::to_string(authResponse[0]) + ", METHOD=" + std::to_string(authResponse[1]) +
-                                    ", bytes=" + HexDump(authResponse, 2, 16));
-            }
-            
-            if (authResponse[0] != Socks5::VERSION || authResponse[1] != Socks5::AUTH_NONE) {
-                Core::Logger::Error("SOCKS5: [1/3] 不支持的认证方式, sock=" + std::to_string((unsigned long long)sock) +
+            AGP_LOG_DEBUG("SOCKS5: [1/3] 收到认证响应, sock={}, VER={}, METHOD={}, bytes={}",
+                          (unsigned long long)sock, authResponse[0], authResponse[1], Core::BinaryLogHex{authResponse, 2});
+
+            uint8_t method = Socks5::AUTH_NO_ACCEPTABLE;
+            if (Socks5::DecodeMethodReply(authResponse, sizeof(authResponse), &method) != Socks5::DecodeStatus::Done ||
+                method != Socks5::AUTH_NONE) {
+                Core::Logger::Error("SOCKS5: [1/3] 不支持的认证方式, sock=" + sockText +
                                     ", 版本=" + std::to_string(authResponse[0]) + ", 方法=" + std::to_string(authResponse[1]) +
                                     ", bytes=" + HexDump(authResponse, 2, 16));
                 return false;
             }
-            
-            // 2. Send Connect Request
-            // +----+-----+-------+------+----------+----------+
-            // |VER | CMD |  RSV  | ATYP | DST.ADDR | DST.PORT |
-            // +----+-----+-------+------+----------+----------+
-            std::vector<uint8_t> request;
-            request.push_back(Socks5::VERSION);
-            request.push_back(Socks5::CMD_CONNECT);
-            request.push_back(0x00); // RSV
-            
-            uint8_t atypForLog = Socks5::ATYP_DOMAIN;
-            in_addr addr{};
-            if (inet_pton(AF_INET, targetHost.c_str(), &addr) == 1) {
-                // IPv4 地址
-                atypForLog = Socks5::ATYP_IPV4;
-                request.push_back(atypForLog);
-                request.push_back((addr.s_addr >> 0) & 0xFF);
-                request.push_back((addr.s_addr >> 8) & 0xFF);
-                request.push_back((addr.s_addr >> 16) & 0xFF);
-                request.push_back((addr.s_addr >> 24) & 0xFF);
-            } else {
-                in6_addr addr6{};
-                if (inet_pton(AF_INET6, targetHost.c_str(), &addr6) == 1) {
-                    // IPv6 地址
-                    atypForLog = Socks5::ATYP_IPV6;
-                    request.push_back(atypForLog);
-                    const uint8_t* bytes = reinterpret_cast<const uint8_t*>(&addr6);
-                    for (int i = 0; i < 16; ++i) request.push_back(bytes[i]);
-                } else {
-                    // 域名
-                    if (targetHost.size() > 255) {
-                        Core::Logger::Error("SOCKS5: [2/3] 目标域名过长, sock=" + std::to_string((unsigned long long)sock) +
-                                            ", len=" + std::to_string(targetHost.size()));
-                        WSASetLastError(WSAEINVAL);
-                        return false;
-                    }
-                    atypForLog = Socks5::ATYP_DOMAIN;
-                    request.push_back(atypForLog);
-                    uint8_t len = static_cast<uint8_t>(targetHost.length());
-                    request.push_back(len);
-                    for (char c : targetHost) request.push_back(c);
-                }
-            }
-            
-            // Port (Network Byte Order)
-            request.push_back((targetPort >> 8) & 0xFF);
-            request.push_back(targetPort & 0xFF);
-            
-            if (Core::Logger::IsEnabled(Core::LogLevel::Debug)) {
-                Core::Logger::Debug("SOCKS5: [2/3] 发送 CONNECT 请求, sock=" + std::to_string((unsigned long long)sock) +
-                                    ", ATYP=" + std::to_string(atypForLog) +
-                                    ", payload_len=" + std::to_string(request.size()));
+
+            // 2. CONNECT 请求：VER CMD RSV ATYP DST.ADDR DST.PORT
+            uint8_t request[Socks5::kMaxRequestBytes];
+            uint8_t atypForLog = 0;
+            const size_t requestLen = Socks5::EncodeRequest(Socks5::CMD_CONNECT, targetHost, targetPort,
+                                                            request, sizeof(request), &atypForLog);
+            if (requestLen == 0) {
+                Core::Logger::Error("SOCKS5: [2/3] 目标域名过长, sock=" + sockText +
+                                    ", len=" + std::to_string(targetHost.size()));
+                WSASetLastError(WSAEINVAL);
+                return false;
             }
+            AGP_LOG_DEBUG("SOCKS5: [2/3] 发送 CONNECT 请求, sock={}, ATYP={}, payload_len={}",
+                          (unsigned long long)sock, atypForLog, requestLen);
             const int connectReqTimeout = stepTimeout(sendTimeout, "[2/3] 发送 CONNECT 请求");
             if (connectReqTimeout <= 0) return false;
-            if (!SocketIo::SendAll(sock, (const char*)request.data(), (int)request.size(), connectReqTimeout)) {
+            if (!SocketIo::SendAll(sock, (const char*)request, (int)requestLen, connectReqTimeout)) {
                 int err = WSAGetLastError();
-                Core::Logger::Error("SOCKS5: [2/3] 发送 CONNECT 请求失败, sock=" + std::to_string((unsigned long long)sock) +
+                Core::Logger::Error("SOCKS5: [2/3] 发送 CONNECT 请求失败, sock=" + sockText +
                                     ", WSA错误码=" + std::to_string(err));
                 return false;
             }
-            
-            // 3. Receive Connect Response
-            // We need to handle variable length responses carefully
-            
-            // Read Header: VER, REP, RSV, ATYP
-            uint8_t header[4];
-            const int respHeaderTimeout = stepTimeout(recvTimeout, "[3/3] 读取响应头");
-            if (respHeaderTimeout <= 0) return false;
-            if (!ReadExact(sock, header, 4, respHeaderTimeout)) {
+
+            // 3. CONNECT 响应（变长）：按解码器给出的边界分段读取
+            uint8_t reply[Socks5::kMaxReplyBytes];
+            size_t replyLen = 0;
+            Socks5::Reply parsed;
+            const Socks5::DecodeStatus st = RecvReply(sock, reply, sizeof(reply), &replyLen, &parsed, deadline, recvTimeout);
+            if (st == Socks5::DecodeStatus::NeedMore) {
                 int err = WSAGetLastError();
-                Core::Logger::Error("SOCKS5: [3/3] 读取响应头失败, sock=" + std::to_string((unsigned long long)sock) +
-                                    ", WSA错误码=" + std::to_string(err));
+                Core::Logger::Error("SOCKS5: [3/3] 读取响应失败, sock=" + sockText +
+                                    ", 已读=" + std::to_string(replyLen) + ", WSA错误码=" + std::to_string(err));
                 return false;
             }
-            if (Core::Logger::IsEnabled(Core::LogLevel::Debug)) {
-                Core::Logger::Debug("SOCKS5: [3/3] 收到响应头, sock=" + std::to_string((unsigned long long)sock) +
-                                    ", VER=" + std::to_string(header[0]) + ", REP=" + std::to_string(header[1]) +
-                                    ", ATYP=" + std::to_string(header[3]) + ", bytes=" + HexDump(header, 4, 16));
-            }
-            
-            if (header[0] != Socks5::VERSION) {
-                Core::Logger::Error("SOCKS5: [3/3] 响应版本无效, sock=" + std::to_string((unsigned long long)sock) +
-                                    ", VER=" + std::to_string(header[0]) + ", bytes=" + HexDump(header, 4, 16));
+            if (st == Socks5::DecodeStatus::Invalid) {
+                Core::Logger::Error("SOCKS5: [3/3] 响应无效, sock=" + sockText +
+                                    ", bytes=" + HexDump(reply, replyLen, 16));
                 return false;
             }
-            
-            if (header[1] != Socks5::REPLY_SUCCESS) {
-                Core::Logger::Error("SOCKS5: [3/3] 代理服务器拒绝 CONNECT, sock=" + std::to_string((unsigned long long)sock) +
-                                    ", REP=" + std::to_string(header[1]) + "(" + ReplyToText(header[1]) + ")" +
+            AGP_LOG_DEBUG("SOCKS5: [3/3] 收到响应, sock={}, REP={}, ATYP={}, bytes={}",
+                          (unsigned long long)sock, parsed.rep, parsed.atyp, Core::BinaryLogHex{reply, replyLen});
+
+            if (parsed.rep != Socks5::REPLY_SUCCESS) {
+                Core::Logger::Error("SOCKS5: [3/3] 代理服务器拒绝 CONNECT, sock=" + sockText +
+                                    ", REP=" + std::to_string(parsed.rep) + "(" + ReplyToText(parsed.rep) + ")" +
                                     ", 目标=" + targetHost + ":" + std::to_string(targetPort) +
-                                    ", bytes=" + HexDump(header, 4, 16));
+                                    ", bytes=" + HexDump(reply, replyLen, 16));
                 return false;
             }
-            
-            // Determine Address Length based on ATYP
-            uint8_t atyp = header[3];
-            int addrLen = 0;
-            switch(atyp) {
-                case Socks5::ATYP_IPV4: 
-                    addrLen = 4; 
-                    break;
-                case Socks5::ATYP_IPV6: 
-                    addrLen = 16; 
-                    break;
-                case Socks5::ATYP_DOMAIN: {
-                    uint8_t lenByte;
-                    const int domainLenTimeout = stepTimeout(recvTimeout, "[3/3] 读取 BND.DOMAIN 长度");
-                    if (domainLenTimeout <= 0) return false;
-                    if (!ReadExact(sock, &lenByte, 1, domainLenTimeout)) {
-                        int err = WSAGetLastError();
-                        Core::Logger::Error("SOCKS5: [3/3] 读取 BND.DOMAIN 长度失败, sock=" + std::to_string((unsigned long long)sock) +
-                                            ", WSA错误码=" + std::to_string(err));
-                        return false;
-                    }
-                    addrLen = lenByte;
-                    break;
-                }
-                default:
-                    Core::Logger::Error("SOCKS5: [3/3] 未知的 ATYP, sock=" + std::to_string((unsigned long long)sock) +
-                                        ", ATYP=" + std::to_string(atyp) + ", bytes=" + HexDump(header, 4, 16));
-                    return false;
-            }
-            
-            // Consume Address Bytes (Ignore actual value as we don't need the bind addr)
-            if (addrLen > 0) {
-                std::vector<uint8_t> trash(addrLen);
-                const int bndAddrTimeout = stepTimeout(recvTimeout, "[3/3] 读取 BND.ADDR");
-                if (bndAddrTimeout <= 0) return false;
-                if (!ReadExact(sock, trash.data(), addrLen, bndAddrTimeout)) {
-                    int err = WSAGetLastError();
-                    Core::Logger::Error("SOCKS5: [3/3] 读取 BND.ADDR 失败, sock=" + std::to_string((unsigned long long)sock) +
-                                        ", WSA错误码=" + std::to_string(err));
-                    return false;
-                }
-            }
-            
-            // Consume Port (2 bytes)
-            uint8_t portBuf[2];
-            const int bndPortTimeout = stepTimeout(recvTimeout, "[3/3] 读取 BND.PORT");
-            if (bndPortTimeout <= 0) return false;
-            if (!ReadExact(sock, portBuf, 2, bndPortTimeout)) {
-                int err = WSAGetLastError();
-                Core::Logger::Error("SOCKS5: [3/3] 读取 BND.PORT 失败, sock=" + std::to_string((unsigned long long)sock) +
-                                    ", WSA错误码=" + std::to_string(err));
-                return false;
-            }
-            
-            Core::Logger::Info("SOCKS5: 隧道建立成功, sock=" + std::to_string((unsigned long long)sock) +
+
+            Core::Logger::Info("SOCKS5: 隧道建立成功, sock=" + sockText +
                                ", 目标=" + targetHost + ":" + std::to_string(targetPort) +
-                               ", BND.ATYP=" + std::to_string(atyp) +
-                               ", BND.PORT=" + std::to_string((static_cast<uint16_t>(portBuf[0]) << 8) | portBuf[1]));
+                               ", BND.ATYP=" + std::to_string(parsed.atyp) +
+                               ", BND.PORT=" + std::to_string(parsed.bndPort));
             return true;
         }
     };
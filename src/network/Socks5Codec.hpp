@@ -0,0 +1,240 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#ifdef _WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#else
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#endif
+
+namespace Network {
+
+    // SOCKS5 Protocol Constants
+    namespace Socks5 {
+        constexpr uint8_t VERSION = 0x05;
+        constexpr uint8_t AUTH_NONE = 0x00;
+        constexpr uint8_t AUTH_NO_ACCEPTABLE = 0xFF;
+        constexpr uint8_t CMD_CONNECT = 0x01;
+        constexpr uint8_t CMD_UDP_ASSOCIATE = 0x03;
+        constexpr uint8_t ATYP_IPV4 = 0x01;
+        constexpr uint8_t ATYP_DOMAIN = 0x03;
+        constexpr uint8_t ATYP_IPV6 = 0x04;
+        constexpr uint8_t REPLY_SUCCESS = 0x00;
+
+        // ============= 报文编解码（不涉及 socket） =============
+        // 设计意图：握手的字节格式与 I/O 方式无关。这里只负责写入调用方给定的缓冲区、
+        // 以及从可能不完整的输入中增量解析响应，阻塞 socket、流水线握手和 Linux 基准共用同一份实现。
+
+        // 认证协商请求固定 3 字节：VER NMETHODS=1 METHOD=NONE
+        constexpr size_t kGreetingBytes = 3;
+        constexpr size_t kMethodReplyBytes = 2;
+        // ATYP + DOMAIN_LEN(1) + DOMAIN(255) + PORT(2)
+        constexpr size_t kMaxAddressBytes = 1 + 1 + 255 + 2;
+        // VER CMD RSV + 地址
+        constexpr size_t kMaxRequestBytes = 3 + kMaxAddressBytes;
+        // 响应与请求同构（REP 取代 CMD）
+        constexpr size_t kMaxReplyBytes = kMaxRequestBytes;
+        // 最短的合法响应：ATYP=DOMAIN 且长度为 0
+        constexpr size_t kMinReplyBytes = 4 + 1 + 2;
+        // UDP 头：RSV(2) FRAG(1) + 地址；不含 payload
+        constexpr size_t kMaxUdpHeaderBytes = 3 + kMaxAddressBytes;
+
+        enum class DecodeStatus {
+            NeedMore, // 输入不完整，至少还需要 need 字节（总长）
+            Done,     // 解析完成
+            Invalid,  // 字节不符合协议
+        };
+
+        // CONNECT / UDP ASSOCIATE 响应
+        struct Reply {
+            uint8_t rep = 0;
+            uint8_t atyp = 0;
+            const uint8_t* bndAddr = nullptr; // 指向输入缓冲区（ATYP=DOMAIN 时不含长度字节）
+            uint8_t bndAddrLen = 0;
+            uint16_t bndPort = 0;
+            size_t length = 0; // 响应总字节数
+        };
+
+        // UDP 报文头（RSV FRAG ATYP DST.ADDR DST.PORT）
+        struct UdpHeader {
+            uint8_t atyp = 0;
+            const uint8_t* addr = nullptr; // 指向输入缓冲区（ATYP=DOMAIN 时不含长度字节）
+            uint8_t addrLen = 0;
+            uint16_t port = 0;
+            size_t length = 0; // 头部字节数（payload 从这里开始）
+        };
+
+        inline size_t EncodeGreeting(uint8_t* buf, size_t cap) {
+            if (!buf || cap < kGreetingBytes) return 0;
+            buf[0] = VERSION;
+            buf[1] = 0x01;
+            buf[2] = AUTH_NONE;
+            return kGreetingBytes;
+        }
+
+        // 写入 ATYP + ADDR + PORT；addr 为 4/16 字节地址或域名（不含长度字节），返回字节数，缓冲区不足返回 0
+        inline size_t EncodeAddress(uint8_t atyp, const uint8_t* addr, size_t addrLen, uint16_t port, uint8_t* buf,
+                                    size_t cap) {
+            if (!buf || (addrLen > 0 && !addr)) return 0;
+            if (atyp == ATYP_IPV4 ? addrLen != 4 : atyp == ATYP_IPV6 ? addrLen != 16 : addrLen > 255) return 0;
+            const size_t total = 1 + (atyp == ATYP_DOMAIN ? 1 : 0) + addrLen + 2;
+            if (cap < total) return 0;
+            size_t pos = 0;
+            buf[pos++] = atyp;
+            if (atyp == ATYP_DOMAIN) buf[pos++] = static_cast<uint8_t>(addrLen);
+            if (addrLen > 0) std::memcpy(buf + pos, addr, addrLen);
+            pos += addrLen;
+            buf[pos++] = static_cast<uint8_t>((port >> 8) & 0xFF);
+            buf[pos++] = static_cast<uint8_t>(port & 0xFF);
+            return pos;
+        }
+
+        // host 为 IPv4/IPv6 字面量时按地址编码，否则按域名编码；host 为空/过长时返回 0
+        inline size_t EncodeAddress(const std::string& host, uint16_t port, uint8_t* buf, size_t cap,
+                                    uint8_t* atypOut = nullptr) {
+            if (host.empty()) return 0;
+            uint8_t addr[16];
+            size_t n = 0;
+            if (inet_pton(AF_INET, host.c_str(), addr) == 1) {
+                n = EncodeAddress(ATYP_IPV4, addr, 4, port, buf, cap);
+            } else if (inet_pton(AF_INET6, host.c_str(), addr) == 1) {
+                n = EncodeAddress(ATYP_IPV6, addr, 16, port, buf, cap);
+            } else {
+                n = EncodeAddress(ATYP_DOMAIN, (const uint8_t*)host.data(), host.size(), port, buf, cap);
+            }
+            if (n > 0 && atypOut) *atypOut = buf[0];
+            return n;
+        }
+
+        // 按 sockaddr 编码；addr 为空或不是 IPv4/IPv6 时编码为 0.0.0.0:0（UDP ASSOCIATE 的“由代理学习来源”）
+        inline size_t EncodeAddress(const sockaddr* addr, int addrLen, uint8_t* buf, size_t cap) {
+            if (addr && addr->sa_family == AF_INET && addrLen >= (int)sizeof(sockaddr_in)) {
+                const auto* a4 = (const sockaddr_in*)addr;
+                return EncodeAddress(ATYP_IPV4, (const uint8_t*)&a4->sin_addr, 4, ntohs(a4->sin_port), buf, cap);
+            }
+            if (addr && addr->sa_family == AF_INET6 && addrLen >= (int)sizeof(sockaddr_in6)) {
+                const auto* a6 = (const sockaddr_in6*)addr;
+                return EncodeAddress(ATYP_IPV6, (const uint8_t*)&a6->sin6_addr, 16, ntohs(a6->sin6_port), buf, cap);
+            }
+            static const uint8_t kZero4[4] = {0, 0, 0, 0};
+            return EncodeAddress(ATYP_IPV4, kZero4, 4, 0, buf, cap);
+        }
+
+        // 写入 CONNECT / UDP ASSOCIATE 请求，返回字节数；host 为空/过长或缓冲区不足时返回 0
+        // host 为 IPv4/IPv6 字面量时按地址编码，否则按域名编码；atypOut 可选输出实际使用的 ATYP
+        inline size_t EncodeRequest(uint8_t cmd, const std::string& host, uint16_t port, uint8_t* buf, size_t cap,
+                                    uint8_t* atypOut = nullptr) {
+            if (!buf || cap < 3) return 0;
+            const size_t n = EncodeAddress(host, port, buf + 3, cap - 3, atypOut);
+            if (n == 0) return 0;
+            buf[0] = VERSION;
+            buf[1] = cmd;
+            buf[2] = 0x00; // RSV
+            return 3 + n;
+        }
+
+        inline size_t EncodeRequest(uint8_t cmd, const sockaddr* addr, int addrLen, uint8_t* buf, size_t cap) {
+            if (!buf || cap < 3) return 0;
+            const size_t n = EncodeAddress(addr, addrLen, buf + 3, cap - 3);
+            if (n == 0) return 0;
+            buf[0] = VERSION;
+            buf[1] = cmd;
+            buf[2] = 0x00; // RSV
+            return 3 + n;
+        }
+
+        // 写入 UDP 报文头（FRAG=0，不支持分片），payload 由调用方紧接其后写入或以 gather 方式发送
+        inline size_t EncodeUdpHeader(const std::string& host, uint16_t port, uint8_t* buf, size_t cap) {
+            if (!buf || cap < 3) return 0;
+            const size_t n = EncodeAddress(host, port, buf + 3, cap - 3);
+            if (n == 0) return 0;
+            buf[0] = 0x00; // RSV
+            buf[1] = 0x00;
+            buf[2] = 0x00; // FRAG
+            return 3 + n;
+        }
+
+        // 解析 ATYP 起的地址：offset 为 ATYP 所在位置；NeedMore 时 need 为所需总长，Done 时 need 为地址结束位置
+        inline DecodeStatus DecodeAddress(const uint8_t* p, size_t len, size_t offset, uint8_t* atypOut,
+                                          const uint8_t** addrOut, uint8_t* addrLenOut, uint16_t* portOut,
+                                          size_t* need) {
+            if (len < offset + 1) {
+                *need = offset + 1;
+                return DecodeStatus::NeedMore;
+            }
+            const uint8_t atyp = p[offset];
+            size_t addrOffset = offset + 1;
+            size_t addrLen = 0;
+            switch (atyp) {
+                case ATYP_IPV4: addrLen = 4; break;
+                case ATYP_IPV6: addrLen = 16; break;
+                case ATYP_DOMAIN:
+                    if (len < offset + 2) {
+                        *need = offset + 2;
+                        return DecodeStatus::NeedMore;
+                    }
+                    addrOffset = offset + 2;
+                    addrLen = p[offset + 1];
+                    break;
+                default:
+                    return DecodeStatus::Invalid;
+            }
+            const size_t total = addrOffset + addrLen + 2;
+            *need = total;
+            if (len < total) return DecodeStatus::NeedMore;
+            *atypOut = atyp;
+            *addrOut = p + addrOffset;
+            *addrLenOut = static_cast<uint8_t>(addrLen);
+            *portOut = static_cast<uint16_t>((p[total - 2] << 8) | p[total - 1]);
+            return DecodeStatus::Done;
+        }
+
+        // 认证协商响应：VER METHOD
+        inline DecodeStatus DecodeMethodReply(const uint8_t* p, size_t len, uint8_t* method) {
+            if (len < kMethodReplyBytes) return DecodeStatus::NeedMore;
+            if (p[0] != VERSION) return DecodeStatus::Invalid;
+            if (method) *method = p[1];
+            return DecodeStatus::Done;
+        }
+
+        // CONNECT / UDP ASSOCIATE 响应：VER REP RSV ATYP BND.ADDR BND.PORT
+        // NeedMore 时 need 为继续解析所需的总字节数（不会超过响应实际长度，调用方按它读取不会吞掉隧道数据）
+        inline DecodeStatus DecodeReply(const uint8_t* p, size_t len, Reply* out, size_t* need) {
+            size_t total = 0;
+            if (len < 4) {
+                if (need) *need = 4;
+                return DecodeStatus::NeedMore;
+            }
+            if (p[0] != VERSION) return DecodeStatus::Invalid;
+            Reply r;
+            const DecodeStatus st = DecodeAddress(p, len, 3, &r.atyp, &r.bndAddr, &r.bndAddrLen, &r.bndPort, &total);
+            if (need) *need = total;
+            if (st != DecodeStatus::Done) return st;
+            if (out) {
+                r.rep = p[1];
+                r.length = total;
+                *out = r;
+            }
+            return DecodeStatus::Done;
+        }
+
+        // UDP 报文头（一个完整数据报）：RSV 非 0 或 FRAG 非 0（分片）视为 Invalid，截断返回 NeedMore
+        inline DecodeStatus DecodeUdpHeader(const uint8_t* p, size_t len, UdpHeader* out) {
+            if (len < 3) return DecodeStatus::NeedMore;
+            if (p[0] != 0x00 || p[1] != 0x00 || p[2] != 0x00) return DecodeStatus::Invalid;
+            UdpHeader h;
+            size_t total = 0;
+            const DecodeStatus st = DecodeAddress(p, len, 3, &h.atyp, &h.addr, &h.addrLen, &h.port, &total);
+            if (st != DecodeStatus::Done) return st;
+            if (out) {
+                h.length = total;
+                *out = h;
+            }
+            return DecodeStatus::Done;
+        }
+    }
+}
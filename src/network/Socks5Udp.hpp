@@ -1,6 +1,7 @@
 #pragma once
 #include <winsock2.h>
 #include <ws2tcpip.h>
+#include <chrono>
 #include <cstdint>
 #include <string>
 #include <vector>
@@ -22,7 +23,7 @@ namespace Network {
 
         // SOCKS5 UDP 头最大长度（不含 payload）：
         // RSV(2) + FRAG(1) + ATYP(1) + DOMAIN_LEN(1) + DOMAIN(255) + PORT(2) = 262
-        constexpr size_t kMaxUdpHeaderBytes = 262;
+        constexpr size_t kMaxUdpHeaderBytes = Socks5::kMaxUdpHeaderBytes;
 
         // 失败时输出少量字节摘要（避免刷屏/泄露敏感信息）
         inline std::string HexDump(const uint8_t* data, size_t len, size_t maxBytes) {
@@ -69,6 +70,30 @@ namespace Network {
             return true;
         }
 
+        // 解码出的 IPv4/IPv6 地址转为 sockaddr；域名返回 false
+        inline bool AddressToSockaddr(uint8_t atyp, const uint8_t* addr, uint8_t addrLen, uint16_t port,
+                                      sockaddr_storage* out, int* outLen) {
+            memset(out, 0, sizeof(sockaddr_storage));
+            if (atyp == Socks5::ATYP_IPV4 && addrLen == 4) {
+                auto* a4 = (sockaddr_in*)out;
+                a4->sin_family = AF_INET;
+                memcpy(&a4->sin_addr, addr, 4);
+                a4->sin_port = htons(port);
+                *outLen = (int)sizeof(sockaddr_in);
+                return true;
+            }
+            if (atyp == Socks5::ATYP_IPV6 && addrLen == 16) {
+                auto* a6 = (sockaddr_in6*)out;
+                a6->sin6_family = AF_INET6;
+                memcpy(&a6->sin6_addr, addr, 16);
+                a6->sin6_port = htons(port);
+                *outLen = (int)sizeof(sockaddr_in6);
+                return true;
+            }
+            *outLen = 0;
+            return false;
+        }
+
         inline bool CopyPeerIpAsRelay(SOCKET tcpSock, uint16_t relayPort, sockaddr_storage* out, int* outLen) {
             if (!out || !outLen) return false;
             sockaddr_storage peer{};
@@ -97,21 +122,24 @@ namespace Network {
 
         // 协商 AUTH_NONE
         inline bool NegotiateNoAuth(SOCKET tcpSock, int sendTimeoutMs, int recvTimeoutMs) {
-            uint8_t authRequest[3] = { Socks5::VERSION, 0x01, Socks5::AUTH_NONE };
-            if (!SocketIo::SendAll(tcpSock, (const char*)authRequest, 3, sendTimeoutMs)) {
+            uint8_t authRequest[Socks5::kGreetingBytes];
+            const size_t authLen = Socks5::EncodeGreeting(authRequest, sizeof(authRequest));
+            if (!SocketIo::SendAll(tcpSock, (const char*)authRequest, (int)authLen, sendTimeoutMs)) {
                 int err = WSAGetLastError();
                 Core::Logger::Error("SOCKS5 UDP: 发送认证协商失败, sock=" + std::to_string((unsigned long long)tcpSock) +
                                     ", WSA错误码=" + std::to_string(err));
                 return false;
             }
-            uint8_t authResp[2] = {0, 0};
-            if (!SocketIo::RecvExact(tcpSock, authResp, 2, recvTimeoutMs)) {
+            uint8_t authResp[Socks5::kMethodReplyBytes] = {0, 0};
+            if (!SocketIo::RecvExact(tcpSock, authResp, (int)sizeof(authResp), recvTimeoutMs)) {
                 int err = WSAGetLastError();
                 Core::Logger::Error("SOCKS5 UDP: 读取认证响应失败, sock=" + std::to_string((unsigned long long)tcpSock) +
                                     ", WSA错误码=" + std::to_string(err));
                 return false;
             }
-            if (authResp[0] != Socks5::VERSION || authResp[1] != Socks5::AUTH_NONE) {
+            uint8_t method = Socks5::AUTH_NO_ACCEPTABLE;
+            if (Socks5::DecodeMethodReply(authResp, sizeof(authResp), &method) != Socks5::DecodeStatus::Done ||
+                method != Socks5::AUTH_NONE) {
                 Core::Logger::Error("SOCKS5 UDP: 认证协商失败, sock=" + std::to_string((unsigned long long)tcpSock) +
                                     ", VER=" + std::to_string(authResp[0]) +
                                     ", METHOD=" + std::to_string(authResp[1]) +
@@ -129,7 +157,9 @@ namespace Network {
 
         // SOCKS5 UDP ASSOCIATE
         // - clientAddr/clientAddrLen 可为空：将使用 0.0.0.0:0 或 ::0:0（兼容多数实现）
-        inline bool UdpAssociate(SOCKET tcpSock, const sockaddr* clientAddr, int clientAddrLen, UdpAssociateResult* out) {
+        // - methodNegotiated：连接取自预连接池时已完成认证协商，直接发送 UDP ASSOCIATE
+        inline bool UdpAssociate(SOCKET tcpSock, const sockaddr* clientAddr, int clientAddrLen, UdpAssociateResult* out,
+                                 bool methodNegotiated = false) {
             if (!out) return false;
             out->controlSock = tcpSock;
             out->relayAddrLen = 0;
@@ -143,167 +173,54 @@ namespace Network {
                 Core::Logger::Debug("SOCKS5 UDP: 开始 UDP Associate, sock=" + std::to_string((unsigned long long)tcpSock));
             }
 
-            if (!NegotiateNoAuth(tcpSock, sendTimeout, recvTimeout)) {
+            if (!methodNegotiated && !NegotiateNoAuth(tcpSock, sendTimeout, recvTimeout)) {
                 return false;
             }
 
-            // 2) UDP ASSOCIATE 请求
-            // +----+-----+-------+------+----------+----------+
-            // |VER | CMD |  RSV  | ATYP | DST.ADDR | DST.PORT |
-            // +----+-----+-------+------+----------+----------+
-            // | 1  |  1  | X'00' |  1   | Variable |    2     |
-            // +----+-----+-------+------+----------+----------+
-
-            uint8_t atyp = Socks5::ATYP_IPV4;
-            std::vector<uint8_t> addrBytes;
-            uint16_t port = 0;
-
-            // 默认：0.0.0.0:0（让服务端从 UDP 包源地址学习）
-            in_addr zero4{};
-            addrBytes.resize(4);
-            memcpy(addrBytes.data(), &zero4, 4);
-
-            if (clientAddr && (clientAddr->sa_family == AF_INET || clientAddr->sa_family == AF_INET6) &&
-                clientAddrLen >= (int)sizeof(sockaddr)) {
-                if (clientAddr->sa_family == AF_INET && clientAddrLen >= (int)sizeof(sockaddr_in)) {
-                    const auto* a4 = (const sockaddr_in*)clientAddr;
-                    atyp = Socks5::ATYP_IPV4;
-                    addrBytes.resize(4);
-                    memcpy(addrBytes.data(), &a4->sin_addr, 4);
-                    port = ntohs(a4->sin_port);
-                } else if (clientAddr->sa_family == AF_INET6 && clientAddrLen >= (int)sizeof(sockaddr_in6)) {
-                    const auto* a6 = (const sockaddr_in6*)clientAddr;
-                    atyp = Socks5::ATYP_IPV6;
-                    addrBytes.resize(16);
-                    memcpy(addrBytes.data(), &a6->sin6_addr, 16);
-                    port = ntohs(a6->sin6_port);
-                }
-            }
-
-            std::vector<uint8_t> request;
-            request.reserve(4 + addrBytes.size() + 2);
-            request.push_back(Socks5::VERSION);
-            request.push_back(Socks5::CMD_UDP_ASSOCIATE);
-            request.push_back(0x00); // RSV
-            request.push_back(atyp);
-            request.insert(request.end(), addrBytes.begin(), addrBytes.end());
-            request.push_back((uint8_t)((port >> 8) & 0xFF));
-            request.push_back((uint8_t)(port & 0xFF));
-
-            if (!SocketIo::SendAll(tcpSock, (const char*)request.data(), (int)request.size(), sendTimeout)) {
+            // 2) UDP ASSOCIATE 请求：clientAddr 为空时编码为 0.0.0.0:0（让服务端从 UDP 包源地址学习）
+            uint8_t request[Socks5::kMaxRequestBytes];
+            const size_t requestLen = Socks5::EncodeRequest(Socks5::CMD_UDP_ASSOCIATE, clientAddr, clientAddrLen,
+                                                            request, sizeof(request));
+            if (!SocketIo::SendAll(tcpSock, (const char*)request, (int)requestLen, sendTimeout)) {
                 int err = WSAGetLastError();
                 Core::Logger::Error("SOCKS5 UDP: 发送 UDP Associate 请求失败, sock=" + std::to_string((unsigned long long)tcpSock) +
                                     ", WSA错误码=" + std::to_string(err));
                 return false;
             }
 
-            // 3) 响应头
-            uint8_t header[4] = {0, 0, 0, 0};
-            if (!SocketIo::RecvExact(tcpSock, header, 4, recvTimeout)) {
+            // 3) 响应：VER REP RSV ATYP BND.ADDR BND.PORT
+            uint8_t reply[Socks5::kMaxReplyBytes];
+            size_t replyLen = 0;
+            Socks5::Reply parsed;
+            const auto deadline = std::chrono::steady_clock::now() +
+                                  std::chrono::milliseconds(recvTimeout > 0 ? recvTimeout : 5000);
+            const Socks5::DecodeStatus st =
+                Socks5Client::RecvReply(tcpSock, reply, sizeof(reply), &replyLen, &parsed, deadline, recvTimeout);
+            if (st == Socks5::DecodeStatus::NeedMore) {
                 int err = WSAGetLastError();
-                Core::Logger::Error("SOCKS5 UDP: 读取响应头失败, sock=" + std::to_string((unsigned long long)tcpSock) +
-                                    ", WSA错误码=" + std::to_string(err));
+                Core::Logger::Error("SOCKS5 UDP: 读取响应失败, sock=" + std::to_string((unsigned long long)tcpSock) +
+                                    ", 已读=" + std::to_string(replyLen) + ", WSA错误码=" + std::to_string(err));
                 return false;
             }
-            if (header[0] != Socks5::VERSION || header[2] != 0x00) {
-                Core::Logger::Error("SOCKS5 UDP: 响应头无效, sock=" + std::to_string((unsigned long long)tcpSock) +
-                                    ", bytes=" + HexDump(header, 4, 16));
+            if (st == Socks5::DecodeStatus::Invalid || reply[2] != 0x00) {
+                Core::Logger::Error("SOCKS5 UDP: 响应无效, sock=" + std::to_string((unsigned long long)tcpSock) +
+                                    ", bytes=" + HexDump(reply, replyLen, 16));
                 return false;
             }
-            if (header[1] != Socks5::REPLY_SUCCESS) {
+            if (parsed.rep != Socks5::REPLY_SUCCESS) {
                 Core::Logger::Error("SOCKS5 UDP: 服务器拒绝 UDP Associate, sock=" + std::to_string((unsigned long long)tcpSock) +
-                                    ", REP=" + std::to_string(header[1]) +
-                                    ", bytes=" + HexDump(header, 4, 16));
+                                    ", REP=" + std::to_string(parsed.rep) +
+                                    ", bytes=" + HexDump(reply, replyLen, 16));
                 return false;
             }
 
-            const uint8_t repAtyp = header[3];
+            const uint16_t relayPort = parsed.bndPort;
             sockaddr_storage relay{};
             int relayLen = 0;
-            bool needUsePeerIp = false;
-            uint16_t relayPort = 0;
-
-            if (repAtyp == Socks5::ATYP_IPV4) {
-                uint8_t ip4[4] = {};
-                if (!SocketIo::RecvExact(tcpSock, ip4, 4, recvTimeout)) {
-                    int err = WSAGetLastError();
-                    Core::Logger::Error("SOCKS5 UDP: 读取 BND.IPv4 失败, sock=" + std::to_string((unsigned long long)tcpSock) +
-                                        ", WSA错误码=" + std::to_string(err));
-                    return false;
-                }
-                uint8_t portBuf[2] = {};
-                if (!SocketIo::RecvExact(tcpSock, portBuf, 2, recvTimeout)) {
-                    int err = WSAGetLastError();
-                    Core::Logger::Error("SOCKS5 UDP: 读取 BND.PORT 失败, sock=" + std::to_string((unsigned long long)tcpSock) +
-                                        ", WSA错误码=" + std::to_string(err));
-                    return false;
-                }
-                relayPort = (uint16_t)((portBuf[0] << 8) | portBuf[1]);
-
-                sockaddr_in a4{};
-                a4.sin_family = AF_INET;
-                memcpy(&a4.sin_addr, ip4, 4);
-                a4.sin_port = htons(relayPort);
-                memcpy(&relay, &a4, sizeof(a4));
-                relayLen = (int)sizeof(a4);
-                needUsePeerIp = (a4.sin_addr.s_addr == 0);
-            } else if (repAtyp == Socks5::ATYP_IPV6) {
-                uint8_t ip6[16] = {};
-                if (!SocketIo::RecvExact(tcpSock, ip6, 16, recvTimeout)) {
-                    int err = WSAGetLastError();
-                    Core::Logger::Error("SOCKS5 UDP: 读取 BND.IPv6 失败, sock=" + std::to_string((unsigned long long)tcpSock) +
-                                        ", WSA错误码=" + std::to_string(err));
-                    return false;
-                }
-                uint8_t portBuf[2] = {};
-                if (!SocketIo::RecvExact(tcpSock, portBuf, 2, recvTimeout)) {
-                    int err = WSAGetLastError();
-                    Core::Logger::Error("SOCKS5 UDP: 读取 BND.PORT 失败, sock=" + std::to_string((unsigned long long)tcpSock) +
-                                        ", WSA错误码=" + std::to_string(err));
-                    return false;
-                }
-                relayPort = (uint16_t)((portBuf[0] << 8) | portBuf[1]);
-
-                sockaddr_in6 a6{};
-                a6.sin6_family = AF_INET6;
-                memcpy(&a6.sin6_addr, ip6, 16);
-                a6.sin6_port = htons(relayPort);
-                memcpy(&relay, &a6, sizeof(a6));
-                relayLen = (int)sizeof(a6);
-                needUsePeerIp = IsUnspecifiedAddr((sockaddr*)&a6);
-            } else if (repAtyp == Socks5::ATYP_DOMAIN) {
-                // 少见：返回域名。为避免引入 DNS/FakeIP 干扰，这里直接退化为使用 TCP peer IP。
-                uint8_t dlen = 0;
-                if (!SocketIo::RecvExact(tcpSock, &dlen, 1, recvTimeout)) {
-                    int err = WSAGetLastError();
-                    Core::Logger::Error("SOCKS5 UDP: 读取 BND.DOMAIN 长度失败, sock=" + std::to_string((unsigned long long)tcpSock) +
-                                        ", WSA错误码=" + std::to_string(err));
-                    return false;
-                }
-                if (dlen > 0) {
-                    std::vector<uint8_t> trash(dlen);
-                    if (!SocketIo::RecvExact(tcpSock, trash.data(), (int)trash.size(), recvTimeout)) {
-                        int err = WSAGetLastError();
-                        Core::Logger::Error("SOCKS5 UDP: 读取 BND.DOMAIN 失败, sock=" + std::to_string((unsigned long long)tcpSock) +
-                                            ", WSA错误码=" + std::to_string(err));
-                        return false;
-                    }
-                }
-                uint8_t portBuf[2] = {};
-                if (!SocketIo::RecvExact(tcpSock, portBuf, 2, recvTimeout)) {
-                    int err = WSAGetLastError();
-                    Core::Logger::Error("SOCKS5 UDP: 读取 BND.PORT 失败, sock=" + std::to_string((unsigned long long)tcpSock) +
-                                        ", WSA错误码=" + std::to_string(err));
-                    return false;
-                }
-                relayPort = (uint16_t)((portBuf[0] << 8) | portBuf[1]);
-                needUsePeerIp = true;
-            } else {
-                Core::Logger::Error("SOCKS5 UDP: 未知 ATYP, sock=" + std::to_string((unsigned long long)tcpSock) +
-                                    ", ATYP=" + std::to_string(repAtyp) +
-                                    ", bytes=" + HexDump(header, 4, 16));
-                return false;
-            }
+            // BND 为域名（少见）时不解析：为避免引入 DNS/FakeIP 干扰，直接退化为使用 TCP peer IP
+            const bool needUsePeerIp = !AddressToSockaddr(parsed.atyp, parsed.bndAddr, parsed.bndAddrLen, relayPort,
+                                                          &relay, &relayLen) ||
+                                       IsUnspecifiedAddr((const sockaddr*)&relay);
 
             if (needUsePeerIp) {
                 sockaddr_storage peerRelay{};
@@ -337,110 +254,40 @@ namespace Network {
             size_t payloadLen = 0;
         };
 
-        // 将 host:port + payload 封装为 SOCKS5 UDP Request
+        // 将 host:port + payload 封装为 SOCKS5 UDP Request（头部先写入栈上缓冲区，输出只分配一次）
         inline bool Wrap(const std::string& host, uint16_t port, const uint8_t* payload, size_t payloadLen, std::vector<uint8_t>* outPacket) {
             if (!outPacket) return false;
             outPacket->clear();
-
-            // 解析 host -> ATYP + addrBytes
-            uint8_t atyp = Socks5::ATYP_DOMAIN;
-            std::vector<uint8_t> addrBytes;
-            in_addr addr4{};
-            in6_addr addr6{};
-            if (!host.empty() && inet_pton(AF_INET, host.c_str(), &addr4) == 1) {
-                atyp = Socks5::ATYP_IPV4;
-                addrBytes.resize(4);
-                memcpy(addrBytes.data(), &addr4, 4);
-            } else if (!host.empty() && inet_pton(AF_INET6, host.c_str(), &addr6) == 1) {
-                atyp = Socks5::ATYP_IPV6;
-                addrBytes.resize(16);
-                memcpy(addrBytes.data(), &addr6, 16);
-            } else {
-                // 域名
-                if (host.size() > 255) {
-                    Core::Logger::Error("SOCKS5 UDP: 域名过长，无法封装 (len=" + std::to_string(host.size()) + ")");
-                    return false;
-                }
-                atyp = Socks5::ATYP_DOMAIN;
-                addrBytes.reserve(1 + host.size());
-                addrBytes.push_back((uint8_t)host.size());
-                addrBytes.insert(addrBytes.end(), host.begin(), host.end());
+            uint8_t header[kMaxUdpHeaderBytes];
+            const size_t headerLen = Socks5::EncodeUdpHeader(host, port, header, sizeof(header));
+            if (headerLen == 0) {
+                Core::Logger::Error("SOCKS5 UDP: 目标地址无法封装 (len=" + std::to_string(host.size()) + ")");
+                return false;
             }
-
-            // RSV(2) + FRAG(1) + ATYP(1) + DST.ADDR + DST.PORT(2) + DATA
-            const size_t headerLen = 2 + 1 + 1 + addrBytes.size() + 2;
-            outPacket->reserve(headerLen + payloadLen);
-            outPacket->push_back(0x00);
-            outPacket->push_back(0x00);
-            outPacket->push_back(0x00); // FRAG=0（不支持分片）
-            outPacket->push_back(atyp);
-            outPacket->insert(outPacket->end(), addrBytes.begin(), addrBytes.end());
-            outPacket->push_back((uint8_t)((port >> 8) & 0xFF));
-            outPacket->push_back((uint8_t)(port & 0xFF));
+            outPacket->resize(headerLen + payloadLen);
+            memcpy(outPacket->data(), header, headerLen);
             if (payload && payloadLen > 0) {
-                outPacket->insert(outPacket->end(), payload, payload + payloadLen);
+                memcpy(outPacket->data() + headerLen, payload, payloadLen);
             }
             return true;
         }
 
-        // 解封装 SOCKS5 UDP Reply：提取 src 地址与 payload 指针
+        // 解封装 SOCKS5 UDP Reply：提取 src 地址与 payload 指针（src 为域名时 srcLen=0）
         inline bool Unwrap(const uint8_t* packet, size_t packetLen, UnwrapResult* out) {
-            if (!packet || packetLen < 10 || !out) return false;
+            if (!packet || !out) return false;
             out->srcLen = 0;
             out->payload = nullptr;
             out->payloadLen = 0;
             memset(&out->src, 0, sizeof(out->src));
 
-            // RSV(2)
-            if (packet[0] != 0x00 || packet[1] != 0x00) {
+            // RSV 非 0 / FRAG 非 0（当前实现不支持分片）/ 截断 均丢弃
+            Socks5::UdpHeader header;
+            if (Socks5::DecodeUdpHeader(packet, packetLen, &header) != Socks5::DecodeStatus::Done) {
                 return false;
             }
-            // FRAG
-            if (packet[2] != 0x00) {
-                // 当前实现不支持 SOCKS5 UDP 分片
-                return false;
-            }
-            const uint8_t atyp = packet[3];
-            size_t pos = 4;
-
-            uint16_t port = 0;
-            if (atyp == Socks5::ATYP_IPV4) {
-                if (packetLen < pos + 4 + 2) return false;
-                sockaddr_in a4{};
-                a4.sin_family = AF_INET;
-                memcpy(&a4.sin_addr, packet + pos, 4);
-                pos += 4;
-                port = (uint16_t)((packet[pos] << 8) | packet[pos + 1]);
-                pos += 2;
-                a4.sin_port = htons(port);
-                memcpy(&out->src, &a4, sizeof(a4));
-                out->srcLen = (int)sizeof(a4);
-            } else if (atyp == Socks5::ATYP_IPV6) {
-                if (packetLen < pos + 16 + 2) return false;
-                sockaddr_in6 a6{};
-                a6.sin6_family = AF_INET6;
-                memcpy(&a6.sin6_addr, packet + pos, 16);
-                pos += 16;
-                port = (uint16_t)((packet[pos] << 8) | packet[pos + 1]);
-                pos += 2;
-                a6.sin6_port = htons(port);
-                memcpy(&out->src, &a6, sizeof(a6));
-                out->srcLen = (int)sizeof(a6);
-            } else if (atyp == Socks5::ATYP_DOMAIN) {
-                if (packetLen < pos + 1) return false;
-                const uint8_t dlen = packet[pos++];
-                if (packetLen < pos + dlen + 2) return false;
-                // 域名无法直接塞进 sockaddr；这里跳过并返回 srcLen=0
-                pos += dlen;
-                port = (uint16_t)((packet[pos] << 8) | packet[pos + 1]);
-                pos += 2;
-            } else {
-                return false;
-            }
-
-            if (packetLen < pos) return false;
-            out->payload = packet + pos;
-            out->payloadLen = packetLen - pos;
+            AddressToSockaddr(header.atyp, header.addr, header.addrLen, header.port, &out->src, &out->srcLen);
+            out->payload = packet + header.length;
+            out->payloadLen = packetLen - header.length;
             return true;
         }
     } // namespace Socks5Udp
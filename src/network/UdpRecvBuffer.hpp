@@ -0,0 +1,122 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#include "Socks5Codec.hpp"
+
+namespace Network {
+    // ============= SOCKS5 UDP 接收缓冲与原地解封装 =============
+    // 设计意图：旧实现每次 UDP 接收都分配一个 len + 262 字节的临时 vector，收完解封装再 memcpy 到用户缓冲。
+    // 这里分三种情况：
+    // - 原地：用户缓冲 >= kTailBytes 时按 [用户缓冲, 栈上 tail] 分散接收，头部必然完整落在用户缓冲里，
+    //   解析后把 payload memmove 到开头、再把落进 tail 的至多 262 字节接上，不再有临时缓冲和第二次整包拷贝
+    // - 同步且用户缓冲过小/分成多段：使用线程局部缓冲（只增不减，同线程下次调用前有效）
+    // - overlapped 且无法原地：缓冲需要活到完成（可能在其他线程），从 RecvBufferPool 取、完成后归还
+    // 本文件不依赖 WinSock，Linux 测试/基准可直接包含。
+    namespace UdpRecv {
+        // 分散接收时 tail 的大小：payload 不超过用户缓冲时，头部挤出的字节一定能放进 tail
+        constexpr size_t kTailBytes = Socks5::kMaxUdpHeaderBytes;
+
+        // 解析出的来源地址（域名来源只记录 atyp，无法回填 sockaddr）
+        struct Source {
+            uint8_t atyp = 0;
+            uint8_t addrLen = 0;
+            uint8_t addr[16] = {};
+            uint16_t port = 0;
+        };
+
+        enum class UnwrapStatus {
+            Ok,
+            Truncated, // payload 超过用户缓冲：已拷贝 bufLen 字节（对应 WSAEMSGSIZE）
+            Invalid    // 头部非法/截断/分片
+        };
+
+        // 数据报已按 [buf(bufLen), tail] 分散接收 received 字节：解析 SOCKS5 UDP 头并把 payload 挪到 buf 开头。
+        // 要求 bufLen >= kTailBytes（保证头部完整落在 buf 内）；*payloadLen 为写入 buf 的字节数。
+        inline UnwrapStatus UnwrapInPlace(uint8_t* buf, size_t bufLen, const uint8_t* tail, size_t received,
+                                          Source* src, size_t* payloadLen) {
+            *payloadLen = 0;
+            if (!buf || bufLen < kTailBytes) return UnwrapStatus::Invalid;
+            const size_t inBuf = std::min(received, bufLen);
+            const size_t inTail = received - inBuf;
+            if (inTail > kTailBytes) return UnwrapStatus::Invalid;
+
+            Socks5::UdpHeader header;
+            if (Socks5::DecodeUdpHeader(buf, inBuf, &header) != Socks5::DecodeStatus::Done) {
+                return UnwrapStatus::Invalid;
+            }
+            // memmove 会覆盖头部，先把来源地址拷出来
+            if (src) {
+                src->atyp = header.atyp;
+                const bool ip = header.atyp == Socks5::ATYP_IPV4 || header.atyp == Socks5::ATYP_IPV6;
+                src->addrLen = ip ? header.addrLen : 0;
+                std::memcpy(src->addr, header.addr, src->addrLen);
+                src->port = header.port;
+            }
+
+            const size_t head = inBuf - header.length;
+            if (head > 0) std::memmove(buf, buf + header.length, head);
+            const size_t fromTail = std::min(inTail, bufLen - head);
+            if (fromTail > 0) std::memcpy(buf + head, tail, fromTail);
+            *payloadLen = head + fromTail;
+            return head + inTail > bufLen ? UnwrapStatus::Truncated : UnwrapStatus::Ok;
+        }
+
+        // 线程局部接收缓冲（至少 cap 字节）：同线程下次调用前有效，只增不减
+        inline uint8_t* ThreadScratch(size_t cap) {
+            thread_local std::vector<uint8_t> t_buf;
+            if (t_buf.size() < cap) t_buf.resize(cap);
+            return t_buf.data();
+        }
+
+        // overlapped 接收缓冲的空闲表：完成可能发生在任意线程，因此不能用线程局部缓冲
+        class RecvBufferPool {
+        public:
+            static constexpr size_t kMaxFree = 64;
+            static constexpr size_t kMaxKeepBytes = 65536 + kTailBytes; // 更大的缓冲用完直接释放
+
+            static RecvBufferPool& Instance() {
+                // 有意不析构：进程退出阶段仍可能有 overlapped 完成归还缓冲
+                static RecvBufferPool* s_pool = new RecvBufferPool();
+                return *s_pool;
+            }
+
+            // 取一个 size 字节的缓冲（内容未定义）；空闲表为空时新分配
+            std::vector<uint8_t> Acquire(size_t size) {
+                std::vector<uint8_t> buf;
+                {
+                    std::lock_guard<std::mutex> lock(m_mtx);
+                    if (!m_free.empty()) {
+                        buf = std::move(m_free.back());
+                        m_free.pop_back();
+                    }
+                }
+                buf.resize(size);
+                return buf;
+            }
+
+            void Release(std::vector<uint8_t>&& buf) {
+                if (buf.capacity() == 0 || buf.capacity() > kMaxKeepBytes) return;
+                std::lock_guard<std::mutex> lock(m_mtx);
+                if (m_free.size() >= kMaxFree) return;
+                m_free.push_back(std::move(buf));
+            }
+
+            size_t FreeCount() {
+                std::lock_guard<std::mutex> lock(m_mtx);
+                return m_free.size();
+            }
+
+        private:
+            RecvBufferPool() { m_free.reserve(kMaxFree); }
+
+            std::mutex m_mtx;
+            std::vector<std::vector<uint8_t>> m_free;
+        };
+    }
+}
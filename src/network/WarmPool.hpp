@@ -0,0 +1,261 @@
+#pragma once
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Network {
+    // ============= 代理预连接池 =============
+    // 设计意图：每条 UDP Associate 控制连接都要先付一次到代理的 TCP 建连（SOCKS5 还有一次认证协商）
+    // 才能发出真正的请求。这里在后台预先建好若干条空闲连接（建连 + 认证协商由 dial 完成），
+    // 使用方取走后直接发送 CONNECT / UDP ASSOCIATE，省掉建连与协商的往返。
+    // - 有界：空闲连接最多 maxIdle 条；每条连接存活 ttlMs 后关闭（代理端通常有空闲超时）
+    // - 取用：后进先出（最新建立的连接最不可能被代理回收），取出后在锁外做存活检查，失效连接直接关闭
+    // - 补充：后台线程在连接被取走时立即补充，否则每 refillIntervalMs 巡检一次（淘汰过期、补足数量）；
+    //   dial 失败时本轮停止补充并指数退避，不会对不可用的代理持续重连
+    // - 池空时 Acquire 返回 false，调用方按原路径同步建连，行为与未启用池一致
+    // 句柄类型为模板参数：Hooks 中为 SOCKET，Linux 基准/测试中为 fd；dial/close/alive/时钟均可注入。
+    template <typename Handle>
+    class WarmPool {
+    public:
+        using DialFn = std::function<bool(Handle* out)>;
+        using CloseFn = std::function<void(Handle)>;
+        using AliveFn = std::function<bool(Handle)>;
+        using NowFn = std::function<uint64_t()>;
+
+        static constexpr uint32_t kMaxBackoffMs = 60000;
+
+        struct Options {
+            size_t maxIdle = 2;              // 0 表示禁用
+            uint32_t ttlMs = 30000;
+            uint32_t refillIntervalMs = 1000;
+        };
+
+        struct Stats {
+            uint64_t hits = 0;
+            uint64_t misses = 0;
+            uint64_t dialed = 0;
+            uint64_t dialFailures = 0;
+            uint64_t expired = 0;
+            uint64_t dead = 0;
+        };
+
+        WarmPool(DialFn dial, CloseFn close, AliveFn alive = AliveFn(), NowFn now = NowFn())
+            : m_dial(std::move(dial)), m_close(std::move(close)), m_alive(std::move(alive)),
+              m_now(now ? std::move(now) : NowFn(&SteadyNowMs)) {}
+
+        ~WarmPool() {
+            Stop();
+            Drain();
+        }
+
+        void Configure(const Options& options) {
+            std::vector<Handle> closing;
+            {
+                std::lock_guard<std::mutex> lock(m_mtx);
+                m_options = options;
+                while (m_idle.size() > m_options.maxIdle) {
+                    closing.push_back(m_idle.front().handle);
+                    m_idle.erase(m_idle.begin());
+                }
+            }
+            CloseAll(closing);
+            m_cv.notify_all();
+        }
+
+        // 取一条空闲连接；池空/禁用时返回 false。取走后唤醒后台补充
+        bool Acquire(Handle* out) {
+            if (!out) return false;
+            std::vector<Handle> closing;
+            bool hit = false;
+            bool disabled = false;
+            for (;;) {
+                Entry e{};
+                bool found = false;
+                {
+                    std::lock_guard<std::mutex> lock(m_mtx);
+                    if (m_options.maxIdle == 0) {
+                        disabled = true;
+                        break;
+                    }
+                    const uint64_t now = m_now();
+                    while (!m_idle.empty()) {
+                        e = m_idle.back();
+                        m_idle.pop_back();
+                        if (now >= e.createdMs + m_options.ttlMs) {
+                            m_stats.expired++;
+                            closing.push_back(e.handle);
+                            continue;
+                        }
+                        found = true;
+                        break;
+                    }
+                }
+                if (!found) break;
+                // 存活检查是一次系统调用（select/recv），放在锁外：条目已出池，其他线程不会取到同一连接
+                if (m_alive && !m_alive(e.handle)) {
+                    closing.push_back(e.handle);
+                    std::lock_guard<std::mutex> lock(m_mtx);
+                    m_stats.dead++;
+                    continue;
+                }
+                *out = e.handle;
+                hit = true;
+                break;
+            }
+            if (disabled) {
+                CloseAll(closing);
+                return false;
+            }
+            {
+                std::lock_guard<std::mutex> lock(m_mtx);
+                if (hit) m_stats.hits++;
+                else m_stats.misses++;
+                m_wakeRequested = true;
+            }
+            CloseAll(closing);
+            m_cv.notify_all();
+            return hit;
+        }
+
+        // 淘汰过期连接并同步补足到 maxIdle（后台线程与测试共用），返回新建连接数
+        size_t PumpRefill() {
+            std::vector<Handle> closing;
+            size_t want = 0;
+            {
+                std::lock_guard<std::mutex> lock(m_mtx);
+                const uint64_t now = m_now();
+                for (size_t i = 0; i < m_idle.size();) {
+                    if (now >= m_idle[i].createdMs + m_options.ttlMs) {
+                        m_stats.expired++;
+                        closing.push_back(m_idle[i].handle);
+                        m_idle.erase(m_idle.begin() + (long)i);
+                    } else {
+                        i++;
+                    }
+                }
+                want = m_options.maxIdle > m_idle.size() ? m_options.maxIdle - m_idle.size() : 0;
+            }
+            CloseAll(closing);
+
+            closing.clear();
+            size_t added = 0;
+            for (size_t i = 0; i < want; i++) {
+                Handle h{};
+                // dial 在锁外执行（阻塞建连 + 协商）
+                const bool ok = m_dial(&h);
+                std::lock_guard<std::mutex> lock(m_mtx);
+                if (!ok) {
+                    m_stats.dialFailures++;
+                    break;
+                }
+                m_stats.dialed++;
+                if (m_stopping || m_idle.size() >= m_options.maxIdle) {
+                    closing.push_back(h);
+                    break;
+                }
+                m_idle.push_back(Entry{h, m_now()});
+                added++;
+            }
+            CloseAll(closing);
+            return added;
+        }
+
+        // 启动后台补充线程（幂等）；maxIdle 为 0 时不启动
+        void StartRefiller() {
+            std::lock_guard<std::mutex> lock(m_mtx);
+            if (m_worker.joinable() || m_stopping || m_options.maxIdle == 0) return;
+            m_wakeRequested = true;
+            m_worker = std::thread([this]() { RefillLoop(); });
+        }
+
+        // 停止补充线程并 join（会阻塞）。Hooks 卸载时不调用，只用 Configure(maxIdle=0) 关掉空闲连接
+        void Stop() {
+            {
+                std::lock_guard<std::mutex> lock(m_mtx);
+                m_stopping = true;
+            }
+            m_cv.notify_all();
+            if (m_worker.joinable()) m_worker.join();
+        }
+
+        // 关闭全部空闲连接
+        void Drain() {
+            std::vector<Handle> closing;
+            {
+                std::lock_guard<std::mutex> lock(m_mtx);
+                for (const Entry& e : m_idle) closing.push_back(e.handle);
+                m_idle.clear();
+            }
+            CloseAll(closing);
+        }
+
+        size_t Idle() {
+            std::lock_guard<std::mutex> lock(m_mtx);
+            return m_idle.size();
+        }
+
+        Stats GetStats() {
+            std::lock_guard<std::mutex> lock(m_mtx);
+            return m_stats;
+        }
+
+    private:
+        struct Entry {
+            Handle handle;
+            uint64_t createdMs;
+        };
+
+        static uint64_t SteadyNowMs() {
+            return (uint64_t)std::chrono::duration_cast<std::chrono::milliseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count();
+        }
+
+        void CloseAll(const std::vector<Handle>& handles) {
+            for (const Handle& h : handles) m_close(h);
+        }
+
+        void RefillLoop() {
+            uint32_t backoffMs = 0;
+            std::unique_lock<std::mutex> lock(m_mtx);
+            while (!m_stopping) {
+                if (!m_wakeRequested) {
+                    m_cv.wait_for(lock, std::chrono::milliseconds(std::max<uint32_t>(m_options.refillIntervalMs, 10)),
+                                  [this]() { return m_stopping || m_wakeRequested; });
+                }
+                if (m_stopping) break;
+                m_wakeRequested = false;
+                const uint64_t failuresBefore = m_stats.dialFailures;
+                lock.unlock();
+                PumpRefill();
+                lock.lock();
+                // dial 失败：指数退避（从一个巡检周期起，上限 kMaxBackoffMs），期间的取用不再触发重连
+                if (m_stats.dialFailures != failuresBefore) {
+                    backoffMs = backoffMs == 0 ? std::max<uint32_t>(m_options.refillIntervalMs, 10)
+                                               : std::min<uint32_t>(backoffMs * 2, kMaxBackoffMs);
+                    m_cv.wait_for(lock, std::chrono::milliseconds(backoffMs), [this]() { return m_stopping; });
+                    m_wakeRequested = false;
+                } else {
+                    backoffMs = 0;
+                }
+            }
+        }
+
+        std::mutex m_mtx;
+        std::condition_variable m_cv;
+        DialFn m_dial;
+        CloseFn m_close;
+        AliveFn m_alive;
+        NowFn m_now;
+        Options m_options;
+        std::vector<Entry> m_idle; // 按建立时间升序，back 为最新
+        Stats m_stats;
+        std::thread m_worker;
+        bool m_stopping = false;
+        bool m_wakeRequested = false;
+    };
+}
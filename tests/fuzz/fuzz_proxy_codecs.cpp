@@ -0,0 +1,145 @@
+// libFuzzer 目标：SOCKS5 / HTTP CONNECT 解码器与握手状态机
+// 构建：cmake -DBUILD_FUZZERS=ON -DCMAKE_CXX_COMPILER=clang++ ...，运行 antigravity_fuzz_proxy_codecs [语料目录]
+// 非 clang 编译器可定义 AGP_FUZZ_STANDALONE，按文件逐个回放语料（用于回归）。
+// 除了不崩溃，还检查解码器的约定：
+// - NeedMore 给出的 need 总是大于已有长度，Done 的长度不超过输入（调用方据此读取不会越界/吞数据）
+// - 一次性解析与任意切分的增量解析结果一致
+// - 解码出的 UDP 头重新编码后与原字节相同
+// - 状态机在任意响应字节流上都会在有限步内结束，且不会请求超出缓冲区的读取
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+#include "network/HttpConnectCodec.hpp"
+#include "network/ProxyHandshake.hpp"
+#include "network/Socks5Codec.hpp"
+
+namespace {
+    namespace S5 = Network::Socks5;
+    namespace HC = Network::HttpConnect;
+
+    void Check(bool cond) {
+        if (!cond) std::abort();
+    }
+
+    void FuzzSocks5Reply(const uint8_t* data, size_t size) {
+        uint8_t method = 0;
+        S5::DecodeMethodReply(data, size, &method);
+
+        S5::Reply reply;
+        size_t need = 0;
+        const S5::DecodeStatus st = S5::DecodeReply(data, size, &reply, &need);
+        if (st == S5::DecodeStatus::NeedMore) Check(need > size && need <= S5::kMaxReplyBytes);
+        if (st == S5::DecodeStatus::Done) {
+            Check(reply.length <= size && reply.length == need);
+            Check(reply.bndAddr >= data && reply.bndAddr + reply.bndAddrLen + 2 <= data + size);
+            // 按 need 逐段喂入，结果与一次性解析一致
+            size_t have = S5::kMinReplyBytes < reply.length ? S5::kMinReplyBytes : reply.length;
+            S5::Reply step;
+            size_t stepNeed = 0;
+            for (int guard = 0; guard < 8; guard++) {
+                const S5::DecodeStatus s = S5::DecodeReply(data, have, &step, &stepNeed);
+                if (s == S5::DecodeStatus::Done) break;
+                Check(s == S5::DecodeStatus::NeedMore && stepNeed > have && stepNeed <= reply.length);
+                have = stepNeed;
+            }
+            Check(step.length == reply.length && step.rep == reply.rep && step.bndPort == reply.bndPort);
+        }
+    }
+
+    void FuzzUdpHeader(const uint8_t* data, size_t size) {
+        S5::UdpHeader h;
+        if (S5::DecodeUdpHeader(data, size, &h) != S5::DecodeStatus::Done) return;
+        Check(h.length <= size);
+        uint8_t again[S5::kMaxUdpHeaderBytes];
+        const size_t addrLen = S5::EncodeAddress(h.atyp, h.addr, h.addrLen, h.port, again + 3, sizeof(again) - 3);
+        Check(addrLen > 0 && 3 + addrLen == h.length);
+        Check(std::memcmp(again + 3, data + 3, addrLen) == 0);
+    }
+
+    void FuzzHttpResponse(const uint8_t* data, size_t size) {
+        const char* p = (const char*)data;
+        HC::ParseStatusCode(p, size);
+        HC::Response whole;
+        const HC::DecodeStatus st = HC::DecodeResponse(p, size, &whole);
+        if (st == HC::DecodeStatus::Done) Check(whole.length <= size && whole.length <= HC::kMaxResponseBytes);
+
+        // 以首字节决定的步长增量喂入
+        const size_t stride = size > 0 ? (size_t)data[0] % 13 + 1 : 1;
+        HC::Response inc;
+        HC::DecodeStatus incSt = HC::DecodeStatus::NeedMore;
+        size_t scanned = 0;
+        for (size_t len = 0;;) {
+            incSt = HC::DecodeResponse(p, len, &inc, scanned);
+            if (incSt != HC::DecodeStatus::NeedMore || len == size) break;
+            scanned = len;
+            len = len + stride < size ? len + stride : size;
+        }
+        if (incSt == HC::DecodeStatus::Done) {
+            Check(st == HC::DecodeStatus::Done && inc.length == whole.length && inc.status == whole.status);
+        }
+    }
+
+    void FuzzHandshake(const uint8_t* data, size_t size, Network::ProxyHandshake::Protocol protocol) {
+        using Want = Network::ProxyHandshake::Want;
+        Network::ProxyHandshake hs;
+        if (!hs.Start(protocol, "fuzz.example", 443)) std::abort();
+        size_t pos = 0;
+        // 每次读取的字节数由输入末字节决定，覆盖不同的分片方式
+        const size_t chunk = size > 0 ? (size_t)data[size - 1] % 7 + 1 : 1;
+        for (int guard = 0; guard < 4096; guard++) {
+            switch (hs.Next()) {
+                case Want::Send:
+                    Check(hs.SendSize() > 0);
+                    hs.OnSent(hs.SendSize());
+                    break;
+                case Want::Recv: {
+                    Check(hs.RecvSize() > 0);
+                    size_t n = hs.RecvSize() < chunk ? hs.RecvSize() : chunk;
+                    if (n > size - pos) n = size - pos;
+                    std::memcpy(hs.RecvBuffer(), data + pos, n);
+                    pos += n;
+                    hs.OnReceived(n);
+                    break;
+                }
+                case Want::Peek: {
+                    size_t n = hs.RecvSize() < size - pos ? hs.RecvSize() : size - pos;
+                    std::memcpy(hs.RecvBuffer(), data + pos, n);
+                    hs.OnPeeked(n);
+                    break;
+                }
+                case Want::Done:
+                case Want::Failed:
+                    return;
+            }
+        }
+        std::abort(); // 状态机没有在有限步内结束
+    }
+}
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
+    FuzzSocks5Reply(data, size);
+    FuzzUdpHeader(data, size);
+    FuzzHttpResponse(data, size);
+    FuzzHandshake(data, size, Network::ProxyHandshake::Protocol::Socks5);
+    FuzzHandshake(data, size, Network::ProxyHandshake::Protocol::Socks5Pipelined);
+    FuzzHandshake(data, size, Network::ProxyHandshake::Protocol::Http);
+    return 0;
+}
+
+#ifdef AGP_FUZZ_STANDALONE
+#include <fstream>
+#include <iterator>
+#include <vector>
+
+int main(int argc, char** argv) {
+    for (int i = 1; i < argc; i++) {
+        std::ifstream in(argv[i], std::ios::binary);
+        const std::vector<char> bytes((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+        LLVMFuzzerTestOneInput((const uint8_t*)bytes.data(), bytes.size());
+    }
+    return 0;
+}
+#endif
@@ -0,0 +1,67 @@
+#pragma once
+// 非 Windows 平台的 Logger 替身：仅供 Linux 上的单元测试/基准编译 Config.hpp 等依赖 Logger 的头文件。
+// 注入 DLL 只在 Windows 上构建，真实实现（日志文件、跨进程互斥）见 src/core/Logger.hpp；
+// 这里只保留等级控制，输出直接写 stderr，不落盘。
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <iostream>
+#include <string>
+
+namespace Core {
+    enum class LogLevel : int {
+        Debug = 0,
+        Info  = 1,
+        Warn  = 2,
+        Error = 3,
+    };
+
+    class Logger {
+    private:
+        static std::atomic<int>& LevelStorage() {
+            static std::atomic<int> s_level{static_cast<int>(LogLevel::Info)};
+            return s_level;
+        }
+
+        static void Emit(LogLevel level, const char* tag, const std::string& message) {
+            if (!IsEnabled(level)) return;
+            std::cerr << tag << message << std::endl;
+        }
+
+    public:
+        static bool IsEnabled(LogLevel level) {
+            return static_cast<int>(level) >= LevelStorage().load(std::memory_order_relaxed);
+        }
+
+        static LogLevel GetLevel() {
+            return static_cast<LogLevel>(LevelStorage().load(std::memory_order_relaxed));
+        }
+
+        static void SetLevel(LogLevel level) {
+            LevelStorage().store(static_cast<int>(level), std::memory_order_relaxed);
+        }
+
+        static bool SetLevelFromString(const std::string& levelStr) {
+            std::string s = levelStr;
+            std::transform(s.begin(), s.end(), s.begin(),
+                           [](unsigned char c) { return (char)std::tolower(c); });
+            if (s == "debug") SetLevel(LogLevel::Debug);
+            else if (s == "info") SetLevel(LogLevel::Info);
+            else if (s == "warn" || s == "warning") SetLevel(LogLevel::Warn);
+            else if (s == "error") SetLevel(LogLevel::Error);
+            else return false;
+            return true;
+        }
+
+        // 替身只有同步 stderr 输出，log_async / log_binary 开关不起作用；共享环不可用时返回 false
+        static void SetAsync(bool) {}
+        static void SetBinaryLog(bool) {}
+        static bool SetSharedRing(bool enabled) { return !enabled; }
+
+        static void Log(const std::string& message) { Emit(LogLevel::Info, "", message); }
+        static void Error(const std::string& message) { Emit(LogLevel::Error, "[错误] ", message); }
+        static void Info(const std::string& message) { Emit(LogLevel::Info, "[信息] ", message); }
+        static void Warn(const std::string& message) { Emit(LogLevel::Warn, "[警告] ", message); }
+        static void Debug(const std::string& message) { Emit(LogLevel::Debug, "[调试] ", message); }
+    };
+}
@@ -0,0 +1,62 @@
+#pragma once
+#include <string>
+
+#include "core/Config.hpp"
+
+// 旧版线性扫描路由匹配（逐规则逐模式），作为索引化实现的对照基准。
+// 仅供测试/基准使用：语义应与 ProxyRules::MatchRouting 完全一致。
+inline bool ReferenceMatchRouting(const Core::ProxyRules& rules, const std::string& host, const std::string& ip,
+                                  bool ipIsV6, uint16_t port, const char* protocol,
+                                  std::string* outAction, std::string* outRule) {
+    using PR = Core::ProxyRules;
+    if (!rules.routing.enabled) return false;
+    std::string action = PR::ToLower(rules.routing.default_action);
+    if (action != "proxy" && action != "direct") action = "proxy";
+
+    std::string hostStr = host;
+    if (!hostStr.empty() && hostStr.back() == '.') hostStr.pop_back();
+    hostStr = PR::ToLower(hostStr);
+
+    std::array<uint8_t, 16> ip6{};
+    uint32_t ip4 = 0;
+    bool ip4Valid = false;
+    bool ip6Valid = false;
+    if (!ip.empty()) {
+        if (ipIsV6) ip6Valid = PR::ParseIPv6(ip, &ip6);
+        else ip4Valid = PR::ParseIPv4(ip, &ip4);
+    } else if (!hostStr.empty()) {
+        ip4Valid = PR::ParseIPv4(hostStr, &ip4);
+        ip6Valid = !ip4Valid && PR::ParseIPv6(hostStr, &ip6);
+    }
+
+    for (size_t idx : rules.compiled_order) {
+        const auto& rule = rules.compiled_rules[idx];
+        if (!rule.raw.enabled) continue;
+        if (!PR::MatchProtocol(protocol, rule.protocols)) continue;
+        if (!PR::MatchPort(port, rule.port_ranges)) continue;
+        bool matched = false;
+        if (!hostStr.empty()) {
+            for (const auto& pattern : rule.domains) {
+                if (PR::MatchDomainPattern(pattern, hostStr)) { matched = true; break; }
+            }
+        }
+        if (!matched && ip4Valid) {
+            for (const auto& r : rule.v4) {
+                if (PR::MatchCidrV4(ip4, r)) { matched = true; break; }
+            }
+        }
+        if (!matched && ip6Valid) {
+            for (const auto& r : rule.v6) {
+                if (PR::MatchCidrV6(ip6, r)) { matched = true; break; }
+            }
+        }
+        if (matched) {
+            if (outAction) *outAction = rule.raw.action.empty() ? action : rule.raw.action;
+            if (outRule) *outRule = rule.raw.name;
+            return true;
+        }
+    }
+    if (outAction) *outAction = action;
+    if (outRule) *outRule = "";
+    return false;
+}
@@ -0,0 +1,152 @@
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+#ifdef _WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#else
+#include <arpa/inet.h>
+#include <netdb.h>
+#endif
+
+#include "network/AddrInfoBuilder.hpp"
+
+namespace {
+#ifdef _WIN32
+    constexpr bool kExpandSockTypes = false; // Windows：数字地址 + socktype 0 只返回一条
+#else
+    constexpr bool kExpandSockTypes = true;  // glibc：展开 TCP/UDP/RAW
+#endif
+
+    // 逐条比较本地构造结果与系统 getaddrinfo 对同一 IP 字面量的结果（不比较 ai_flags / canonname）
+    void ExpectSameAsSystem(const char* literal, uint32_t ip, const char* service, int family, int sockType,
+                            int protocol) {
+        addrinfo hints{};
+        hints.ai_family = family;
+        hints.ai_socktype = sockType;
+        hints.ai_protocol = protocol;
+        hints.ai_flags = AI_NUMERICHOST;
+        addrinfo* expected = nullptr;
+        assert(getaddrinfo(literal, service, &hints, &expected) == 0);
+
+        addrinfo* built = nullptr;
+        const uint16_t port = service ? (uint16_t)std::stoi(service) : 0;
+        assert(Network::AddrInfoBuilder::Build(Network::AddrInfoPool::Instance(), ip, port, &hints,
+                                               "example.com", kExpandSockTypes, &built));
+        const addrinfo* a = expected;
+        const addrinfo* b = built;
+        for (; a && b; a = a->ai_next, b = b->ai_next) {
+            assert(a->ai_family == b->ai_family);
+            assert(a->ai_socktype == b->ai_socktype);
+            assert(a->ai_protocol == b->ai_protocol);
+            assert(a->ai_addrlen == b->ai_addrlen);
+            assert(std::memcmp(a->ai_addr, b->ai_addr, a->ai_addrlen) == 0);
+            assert(b->ai_canonname == nullptr);
+        }
+        assert(!a && !b);
+        freeaddrinfo(expected);
+        assert(Network::AddrInfoPool::Instance().Release(built));
+    }
+}
+
+int main() {
+#ifdef _WIN32
+    WSADATA wsa;
+    assert(WSAStartup(MAKEWORD(2, 2), &wsa) == 0);
+#endif
+    auto& pool = Network::AddrInfoPool::Instance();
+    const uint32_t ip = inet_addr("198.18.0.5");
+
+    // ===== 与系统解析 IP 字面量的结果逐字段一致 =====
+    ExpectSameAsSystem("198.18.0.5", ip, "443", AF_INET, SOCK_STREAM, 0);
+    ExpectSameAsSystem("198.18.0.5", ip, "53", AF_UNSPEC, SOCK_DGRAM, IPPROTO_UDP);
+    ExpectSameAsSystem("198.18.0.5", ip, "8080", AF_UNSPEC, 0, 0);
+    ExpectSameAsSystem("198.18.0.5", ip, nullptr, AF_INET, 0, 0);
+    ExpectSameAsSystem("::ffff:198.18.0.5", ip, "443", AF_INET6, SOCK_STREAM, 0);
+    assert(pool.InUse() == 0);
+
+    // ===== AI_CANONNAME：首条结果带原始域名；宽字符版本同样适用 =====
+    {
+        addrinfo hints{};
+        hints.ai_family = AF_UNSPEC;
+        hints.ai_socktype = SOCK_STREAM;
+        hints.ai_flags = AI_CANONNAME;
+        addrinfo* built = nullptr;
+        assert(Network::AddrInfoBuilder::Build(pool, ip, 443, &hints, "api.example.com", false, &built));
+        assert(built->ai_canonname && std::string(built->ai_canonname) == "api.example.com");
+        assert(built->ai_next == nullptr);
+        assert(pool.Release(built));
+
+        struct WideAddrInfo {
+            int ai_flags;
+            int ai_family;
+            int ai_socktype;
+            int ai_protocol;
+            size_t ai_addrlen;
+            wchar_t* ai_canonname;
+            sockaddr* ai_addr;
+            WideAddrInfo* ai_next;
+        };
+        WideAddrInfo wideHints{};
+        wideHints.ai_flags = AI_CANONNAME;
+        wideHints.ai_family = AF_INET;
+        WideAddrInfo* wide = nullptr;
+        assert(Network::AddrInfoBuilder::Build(pool, ip, 443, &wideHints, L"api.example.com", false, &wide));
+        assert(wide->ai_canonname && std::wstring(wide->ai_canonname) == L"api.example.com");
+        assert(reinterpret_cast<sockaddr_in*>(wide->ai_addr)->sin_port == htons(443));
+        assert(pool.Release(wide));
+
+        // canonname 超长或 family 不支持时拒绝构造，*out 不变
+        const std::string longName(Network::AddrInfoBuilder::kMaxCanonChars, 'a');
+        addrinfo* untouched = nullptr;
+        assert(!Network::AddrInfoBuilder::Build(pool, ip, 443, &hints, longName.c_str(), false, &untouched));
+        hints.ai_family = 12345;
+        assert(!Network::AddrInfoBuilder::Build(pool, ip, 443, &hints, "a", false, &untouched));
+        assert(untouched == nullptr && pool.InUse() == 0);
+    }
+
+    // ===== 池：只认自己的块起始地址；多线程借还后全部归还 =====
+    {
+        int foreign = 0;
+        assert(!pool.Owns(&foreign) && !pool.Release(&foreign));
+        addrinfo* built = nullptr;
+        assert(Network::AddrInfoBuilder::Build(pool, ip, 80, (const addrinfo*)nullptr, "x", false, &built));
+        assert(pool.Owns(built) && !pool.Owns(reinterpret_cast<char*>(built) + 8));
+        assert(pool.Release(built));
+
+        std::vector<std::thread> workers;
+        for (int t = 0; t < 4; t++) {
+            workers.emplace_back([&pool, ip]() {
+                std::vector<addrinfo*> held;
+                for (int i = 0; i < 5000; i++) {
+                    addrinfo* r = nullptr;
+                    assert(Network::AddrInfoBuilder::Build(pool, ip, 443, (const addrinfo*)nullptr, "x", false, &r));
+                    held.push_back(r);
+                    if (held.size() == 100) {
+                        for (addrinfo* h : held) assert(pool.Release(h));
+                        held.clear();
+                    }
+                }
+                for (addrinfo* h : held) assert(pool.Release(h));
+            });
+        }
+        for (auto& w : workers) w.join();
+        assert(pool.InUse() == 0);
+    }
+
+    // ===== hostent：h_name 为原始域名，地址表只有虚拟 IP =====
+    {
+        hostent* he = Network::AddrInfoBuilder::BuildHostEnt(ip, "api.example.com");
+        assert(std::string(he->h_name) == "api.example.com");
+        assert(he->h_aliases[0] == nullptr);
+        assert(he->h_addrtype == AF_INET && he->h_length == 4);
+        assert(std::memcmp(he->h_addr_list[0], &ip, 4) == 0 && he->h_addr_list[1] == nullptr);
+    }
+#ifdef _WIN32
+    WSACleanup();
+#endif
+    return 0;
+}
@@ -0,0 +1,155 @@
+#include <atomic>
+#include <cassert>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "core/BinaryLog.hpp"
+
+namespace {
+    std::vector<Core::BinaryLog::DecodedRecord> DecodeFile(const std::string& path, bool* ok) {
+        std::ifstream in(path, std::ios::binary);
+        const std::vector<uint8_t> data((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+        std::vector<Core::BinaryLog::DecodedRecord> out;
+        *ok = Core::BinaryLog::Decode(data.data(), data.size(),
+                                      [&](const Core::BinaryLog::DecodedRecord& r) { out.push_back(r); });
+        return out;
+    }
+}
+
+int main() {
+    using Core::BinaryLog;
+
+    // ===== 文本回退：参数按类型渲染 =====
+    {
+        const uint8_t bytes[] = {0x05, 0x01, 0x00};
+        assert(BinaryLog::FormatText("sock={}, bytes={}", 42ull, Core::BinaryLogHex{bytes, 3}) ==
+               "sock=42, bytes=05 01 00");
+        assert(BinaryLog::FormatText("{} {} {} {}", -7, true, std::string("abc"), "lit") == "-7 true abc lit");
+
+        sockaddr_in in4{};
+        in4.sin_family = AF_INET;
+        in4.sin_port = htons(443);
+        in4.sin_addr.s_addr = htonl(0xC6120001);
+        assert(BinaryLog::FormatText("dst={}", Core::BinaryLogAddr{(const sockaddr*)&in4}) == "dst=198.18.0.1:443");
+        sockaddr_in6 in6{};
+        in6.sin6_family = AF_INET6;
+        in6.sin6_port = htons(80);
+        in6.sin6_addr.s6_addr[15] = 1;
+        assert(BinaryLog::FormatText("dst={}", Core::BinaryLogAddr{(const sockaddr*)&in6}) == "dst=[::1]:80");
+        assert(BinaryLog::FormatText("dst={}", Core::BinaryLogAddr{nullptr}) == "dst=(未知地址)");
+
+        // 超长十六进制截断，占位符多于参数时原样保留
+        std::vector<uint8_t> big(BinaryLog::kMaxHexBytes + 10, 0xAB);
+        const std::string hex = BinaryLog::FormatText("{}", Core::BinaryLogHex{big.data(), big.size()});
+        assert(hex.find(" ...(" + std::to_string(big.size()) + " bytes)") != std::string::npos);
+        assert(BinaryLog::FormatText("a={} b={}", 1) == "a=1 b={}");
+    }
+
+    // ===== 多线程记录 -> 写文件 -> 解码：文本与在线回退一致，同线程内保持顺序 =====
+    {
+        const std::string path = "antigravity_test_binary_log.blog";
+        std::remove(path.c_str());
+        BinaryLog& log = BinaryLog::Instance();
+        const uint16_t idA = log.Register(0, "src/hooks/Hooks.cpp", 10, "closesocket: 完成, sock={}",
+                                          decltype(BinaryLog::SignatureOf(0ull))::value);
+        const uint16_t idB = log.Register(0, "src\\network\\Socks5.hpp", 20, "t={} i={} dst={} name={}",
+                                          decltype(BinaryLog::SignatureOf(0, 0, Core::BinaryLogAddr{nullptr},
+                                                                          std::string()))::value);
+        assert(idA != 0 && idB == idA + 1);
+        assert(log.Start([&]() { return path; }, 64ull * 1024 * 1024));
+
+        // 与 Hooks 一致放在 sockaddr_storage 里（也避免编译器按 16 字节对象分析 IPv6 分支而误报越界）
+        sockaddr_storage ss{};
+        sockaddr_in& in4 = reinterpret_cast<sockaddr_in&>(ss);
+        in4.sin_family = AF_INET;
+        in4.sin_port = htons(7890);
+        in4.sin_addr.s_addr = htonl(0x7F000001);
+        const int threads = 4;
+        const int perThread = 3000;
+        std::vector<std::thread> workers;
+        for (int t = 0; t < threads; t++) {
+            workers.emplace_back([&, t]() {
+                for (int i = 0; i < perThread; i++) {
+                    log.Record(idB, t, i, Core::BinaryLogAddr{(const sockaddr*)&in4}, std::string("example.com"));
+                    // 写线程每 50ms 才取一次，这里主动刷新，避免线程缓冲写满丢弃（与写线程并发刷新）
+                    if ((i & 255) == 255) log.Flush();
+                }
+            });
+        }
+        for (auto& w : workers) w.join();
+        log.Record(idA, 42ull);
+        log.Stop(true);
+        assert(!log.IsRunning());
+
+        bool ok = false;
+        const auto records = DecodeFile(path, &ok);
+        assert(ok);
+        std::vector<int> next(threads, 0);
+        int seenA = 0;
+        for (const auto& r : records) {
+            assert(r.level >= 0); // 未发生丢弃
+            if (r.line == 10) {
+                assert(r.file == "Hooks.cpp" && r.text == "closesocket: 完成, sock=42");
+                seenA++;
+                continue;
+            }
+            assert(r.file == "Socks5.hpp" && r.line == 20);
+            int t = -1, i = -1;
+            assert(std::sscanf(r.text.c_str(), "t=%d i=%d", &t, &i) == 2);
+            assert(t >= 0 && t < threads && i == next[t]);
+            assert(r.text == BinaryLog::FormatText("t={} i={} dst={} name={}", t, i,
+                                                   Core::BinaryLogAddr{(const sockaddr*)&in4}, "example.com"));
+            next[t]++;
+        }
+        assert(seenA == 1);
+        for (int t = 0; t < threads; t++) assert(next[t] == perThread);
+
+        // 截断尾部：已完整的记录照常回调，返回 false
+        std::ifstream in(path, std::ios::binary);
+        std::vector<uint8_t> data((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+        size_t partial = 0;
+        assert(!BinaryLog::Decode(data.data(), data.size() - 3, [&](const BinaryLog::DecodedRecord&) { partial++; }));
+        assert(partial > 0 && partial < records.size());
+        std::remove(path.c_str());
+    }
+
+    // ===== 线程缓冲写满：丢弃并计数，解码出丢弃统计 =====
+    {
+        const std::string path = "antigravity_test_binary_log_drop.blog";
+        std::remove(path.c_str());
+        BinaryLog& log = BinaryLog::Instance();
+        const uint16_t id = log.Register(0, "x.cpp", 1, "{}", decltype(BinaryLog::SignatureOf(std::string()))::value);
+        const uint64_t droppedBefore = log.DroppedCount();
+        const std::string payload(400, 'z');
+        std::thread([&]() {
+            // 写线程未启动，缓冲只进不出
+            for (int i = 0; i < 1000; i++) log.Record(id, payload);
+        }).join();
+        assert(log.DroppedCount() > droppedBefore);
+
+        assert(log.Start([&]() { return path; }, 64ull * 1024 * 1024));
+        log.Stop(true);
+        bool ok = false;
+        const auto records = DecodeFile(path, &ok);
+        assert(ok);
+        size_t kept = 0;
+        uint64_t droppedReported = 0;
+        for (const auto& r : records) {
+            if (r.level < 0) {
+                droppedReported += std::strtoull(r.text.c_str() + std::strlen("线程缓冲已满，丢弃 "), nullptr, 10);
+            } else {
+                assert(r.text == payload);
+                kept++;
+            }
+        }
+        assert(kept > 0 && kept + droppedReported == 1000);
+        std::remove(path.c_str());
+    }
+    return 0;
+}
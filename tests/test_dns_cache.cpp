@@ -0,0 +1,201 @@
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "network/DnsCache.hpp"
+
+namespace {
+    // 假解析后端：按 (name, family) 返回预设 IPv4 地址或错误码，并统计调用次数
+    struct FakeResolver {
+        std::mutex mtx;
+        std::map<std::string, uint32_t> answers; // name -> IPv4（host order）
+        int failure = EAI_NONAME;
+        std::atomic<int> calls{0};
+
+        int Resolve(const std::string& name, int family, std::vector<sockaddr_storage>* out) {
+            calls.fetch_add(1);
+            std::lock_guard<std::mutex> lock(mtx);
+            auto it = answers.find(name);
+            if (it == answers.end() || family != AF_INET) return failure;
+            sockaddr_storage ss{};
+            auto* in4 = reinterpret_cast<sockaddr_in*>(&ss);
+            in4->sin_family = AF_INET;
+            in4->sin_addr.s_addr = htonl(it->second);
+            out->push_back(ss);
+            return 0;
+        }
+
+        void Set(const std::string& name, uint32_t ip) {
+            std::lock_guard<std::mutex> lock(mtx);
+            answers[name] = ip;
+        }
+    };
+
+    uint32_t Ip(const sockaddr_storage& ss) { return ntohl(reinterpret_cast<const sockaddr_in*>(&ss)->sin_addr.s_addr); }
+    uint16_t Port(const sockaddr_storage& ss) { return ntohs(reinterpret_cast<const sockaddr_in*>(&ss)->sin_port); }
+}
+
+int main() {
+    FakeResolver backend;
+    uint64_t now = 1000;
+    Network::DnsCache cache(
+        [&](const std::string& name, int family, std::vector<sockaddr_storage>* out) {
+            return backend.Resolve(name, family, out);
+        },
+        [&]() { return now; });
+    Network::DnsCache::Options options;
+    options.ttlMs = 1000;
+    options.negativeTtlMs = 200;
+    options.refreshAheadMs = 300;
+    options.maxEntries = 4;
+    cache.Configure(options);
+    cache.SetBackgroundRefresh(false);
+    backend.Set("api.example.com", 0x0A000001);
+
+    // ===== 正缓存：同名同族只解析一次，大小写不敏感，端口取用时填入 =====
+    {
+        sockaddr_storage out{};
+        int len = 0;
+        int err = -1;
+        assert(cache.Resolve("api.example.com", AF_INET, 443, &out, &len, &err));
+        assert(err == 0 && len == (int)sizeof(sockaddr_in) && Ip(out) == 0x0A000001 && Port(out) == 443);
+        assert(cache.Resolve("API.Example.com", AF_INET, 80, &out, &len, &err));
+        assert(Port(out) == 80);
+        assert(backend.calls.load() == 1);
+        // 不同地址族是不同的 key
+        assert(!cache.Resolve("api.example.com", AF_INET6, 443, &out, &len, &err) && err == EAI_NONAME);
+        assert(backend.calls.load() == 2);
+    }
+
+    // ===== 负缓存：TTL 内返回同一错误码，过期后重新解析 =====
+    {
+        std::vector<sockaddr_storage> addrs;
+        int err = 0;
+        assert(!cache.ResolveAll("missing.example.com", AF_INET, &addrs, &err) && err == EAI_NONAME);
+        assert(!cache.ResolveAll("missing.example.com", AF_INET, &addrs, &err) && err == EAI_NONAME);
+        assert(backend.calls.load() == 3);
+        backend.Set("missing.example.com", 0x0A000002);
+        now += 250;
+        assert(cache.ResolveAll("missing.example.com", AF_INET, &addrs, &err) && Ip(addrs.front()) == 0x0A000002);
+        assert(backend.calls.load() == 4);
+
+        // EAI_AGAIN 是临时失败：不进负缓存，下一次访问直接重试
+        backend.failure = EAI_AGAIN;
+        assert(!cache.ResolveAll("flaky.example.com", AF_INET, &addrs, &err) && err == EAI_AGAIN);
+        assert(!cache.ResolveAll("flaky.example.com", AF_INET, &addrs, &err) && err == EAI_AGAIN);
+        assert(backend.calls.load() == 6);
+        backend.failure = EAI_NONAME;
+        backend.Set("flaky.example.com", 0x0A000004);
+        assert(cache.ResolveAll("flaky.example.com", AF_INET, &addrs, &err) && Ip(addrs.front()) == 0x0A000004);
+        assert(backend.calls.load() == 7);
+    }
+
+    // ===== 提前刷新：热点条目在过期前窗口内被访问时排队刷新，刷新后结果原地替换 =====
+    {
+        cache.Clear();
+        now = 10000;
+        std::vector<sockaddr_storage> addrs;
+        int err = 0;
+        const int before = backend.calls.load();
+        assert(cache.ResolveAll("api.example.com", AF_INET, &addrs, &err));       // miss，过期时间 11000
+        now = 10800;                                                              // 进入提前刷新窗口
+        assert(cache.ResolveAll("api.example.com", AF_INET, &addrs, &err));       // 第 1 次命中：还不算热点
+        assert(cache.PumpRefresh() == 0);
+        assert(cache.ResolveAll("api.example.com", AF_INET, &addrs, &err));       // 第 2 次命中：排队刷新
+        assert(cache.ResolveAll("api.example.com", AF_INET, &addrs, &err));       // 已在刷新中，不重复排队
+        backend.Set("api.example.com", 0x0A000003);
+        assert(cache.PumpRefresh() == 1);
+        assert(backend.calls.load() == before + 2);
+        now = 11500; // 原过期时间之后：刷新已把过期时间推到 11800
+        assert(cache.ResolveAll("api.example.com", AF_INET, &addrs, &err) && Ip(addrs.front()) == 0x0A000003);
+        assert(backend.calls.load() == before + 2);
+
+        // 刷新失败：保留旧结果直到过期，不被负缓存覆盖
+        assert(cache.ResolveAll("api.example.com", AF_INET, &addrs, &err));
+        {
+            std::lock_guard<std::mutex> lock(backend.mtx);
+            backend.answers.erase("api.example.com");
+        }
+        assert(cache.PumpRefresh() == 1);
+        assert(cache.ResolveAll("api.example.com", AF_INET, &addrs, &err) && Ip(addrs.front()) == 0x0A000003);
+        now = 12000;
+        assert(!cache.ResolveAll("api.example.com", AF_INET, &addrs, &err) && err == EAI_NONAME);
+    }
+
+    // ===== 有界：超过 maxEntries 时淘汰，统计计数完整 =====
+    {
+        cache.Clear();
+        std::vector<sockaddr_storage> addrs;
+        int err = 0;
+        for (int i = 0; i < 10; i++) {
+            const std::string name = "h" + std::to_string(i) + ".example.com";
+            backend.Set(name, 0x0B000000u + (uint32_t)i);
+            assert(cache.ResolveAll(name, AF_INET, &addrs, &err));
+            now += 1;
+        }
+        assert(cache.Size() == 4);
+        const Network::DnsCache::Stats stats = cache.GetStats();
+        assert(stats.evictions >= 6);
+        assert(stats.hits > 0 && stats.negativeHits == 1 && stats.misses > 0 && stats.refreshes == 2);
+        assert(stats.HitRate() > 0.0 && stats.HitRate() < 1.0);
+    }
+
+    // ===== 关闭缓存：每次都走后端 =====
+    {
+        options.enabled = false;
+        cache.Configure(options);
+        std::vector<sockaddr_storage> addrs;
+        int err = 0;
+        const int before = backend.calls.load();
+        assert(cache.ResolveAll("h1.example.com", AF_INET, &addrs, &err));
+        assert(cache.ResolveAll("h1.example.com", AF_INET, &addrs, &err));
+        assert(backend.calls.load() == before + 2 && cache.Size() == 0);
+    }
+
+    // ===== 后台刷新线程 + 并发读者 =====
+    {
+        FakeResolver live;
+        live.Set("live.example.com", 0x0C000001);
+        std::atomic<uint64_t> clock{0};
+        Network::DnsCache bg(
+            [&](const std::string& name, int family, std::vector<sockaddr_storage>* out) {
+                return live.Resolve(name, family, out);
+            },
+            [&]() { return clock.load(); });
+        Network::DnsCache::Options bgOptions;
+        bgOptions.ttlMs = 100;
+        bgOptions.refreshAheadMs = 100; // 每次热点命中都处于刷新窗口
+        bg.Configure(bgOptions);
+
+        std::vector<std::thread> readers;
+        std::atomic<bool> failed{false};
+        for (int t = 0; t < 4; t++) {
+            readers.emplace_back([&]() {
+                std::vector<sockaddr_storage> addrs;
+                int err = 0;
+                for (int i = 0; i < 2000; i++) {
+                    addrs.clear();
+                    if (!bg.ResolveAll("live.example.com", AF_INET, &addrs, &err) || Ip(addrs.front()) != 0x0C000001) {
+                        failed.store(true);
+                    }
+                    if (i % 100 == 0) clock.fetch_add(10);
+                }
+            });
+        }
+        for (auto& r : readers) r.join();
+        for (int i = 0; i < 200 && bg.GetStats().refreshes == 0; i++) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        }
+        assert(!failed.load());
+        assert(bg.GetStats().refreshes > 0);
+        bg.Stop();
+    }
+    return 0;
+}
@@ -0,0 +1,362 @@
+#include <cassert>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+#ifndef _WIN32
+#include <csignal>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+#include "network/FakeIpShared.hpp"
+#include "network/SharedMemory.hpp"
+
+static uint32_t NextRand(uint32_t* state) {
+    *state = *state * 1664525u + 1013904223u;
+    return *state >> 8;
+}
+
+// 旧版语义的参照实现：Ring Buffer + 线性扫描取 tick 最大者（含同 (ip, domain) 只刷新 tick 的规则）
+struct ReferenceTable {
+    struct Row {
+        uint32_t ip = 0;
+        std::string domain;
+        uint64_t tick = 0;
+    };
+    std::vector<Row> rows;
+    uint32_t cursor = 0;
+
+    explicit ReferenceTable(uint32_t capacity) : rows(capacity) {}
+
+    Row* NewestByIp(uint32_t ip) {
+        Row* best = nullptr;
+        for (auto& r : rows) {
+            if (r.ip == ip && !r.domain.empty() && (!best || r.tick >= best->tick)) best = &r;
+        }
+        return best;
+    }
+
+    Row* NewestByDomain(const std::string& domain) {
+        Row* best = nullptr;
+        for (auto& r : rows) {
+            if (r.ip != 0 && r.domain == domain && (!best || r.tick >= best->tick)) best = &r;
+        }
+        return best;
+    }
+
+    void Put(uint32_t ip, const std::string& domain, uint64_t tick) {
+        Row* existing = NewestByDomain(domain);
+        if (existing && existing->ip == ip && NewestByIp(ip) == existing) {
+            existing->tick = tick;
+            return;
+        }
+        Row& r = rows[cursor++ % rows.size()];
+        r.ip = ip;
+        r.domain = domain;
+        r.tick = tick;
+    }
+};
+
+int main() {
+    // ===== 基础语义（普通内存） =====
+    {
+        const uint32_t cap = 8;
+        std::vector<uint8_t> mem(Network::SharedFakeIpTable::RequiredBytes(cap));
+        Network::SharedFakeIpTable table;
+        assert(!table.Attach(mem.data(), mem.size() - 1, cap));
+        assert(table.Attach(mem.data(), mem.size(), cap));
+
+        std::string out;
+        uint32_t ip = 0;
+        assert(!table.Get(0xC6120001, &out));
+        table.Put(0xC6120001, "a.com", 1);
+        assert(table.Get(0xC6120001, &out) && out == "a.com");
+        assert(table.FindDomain("a.com", &ip) && ip == 0xC6120001);
+
+        // 同 IP 新域名：取最新写入
+        table.Put(0xC6120001, "b.com", 2);
+        assert(table.Get(0xC6120001, &out) && out == "b.com");
+        assert(table.FindDomain("a.com", &ip) && ip == 0xC6120001);
+
+        // 超长域名按 255 截断
+        table.Put(0xC6120002, std::string(300, 'x'), 3);
+        assert(table.Get(0xC6120002, &out) && out == std::string(255, 'x'));
+
+        // Ring 回绕后最旧记录被覆盖
+        for (uint32_t i = 0; i < cap; i++) table.Put(0xC6130000 + i, "n" + std::to_string(i), 10 + i);
+        assert(!table.Get(0xC6120001, &out));
+        assert(!table.FindDomain("b.com", &ip));
+        assert(table.Get(0xC6130007, &out) && out == "n7");
+
+        // 重新 Attach 保留内容；容量不一致时拒绝绑定（不在他人使用中重建）
+        Network::SharedFakeIpTable again;
+        assert(again.Attach(mem.data(), mem.size(), cap));
+        assert(again.Get(0xC6130007, &out) && out == "n7");
+        assert(!again.Attach(mem.data(), mem.size(), cap / 2));
+        assert(!again.IsAttached());
+    }
+
+    // ===== 写者中途崩溃：条目 seq 停在奇数 =====
+    {
+        const uint32_t cap = 16;
+        std::vector<uint8_t> mem(Network::SharedFakeIpTable::RequiredBytes(cap));
+        Network::SharedFakeIpTable table;
+        assert(table.Attach(mem.data(), mem.size(), cap));
+        table.Put(0xC6120001, "victim.com", 1);
+        Network::SharedFakeIpTable::Entry* entries = Network::SharedFakeIpTable::EntriesOf(mem.data(), cap);
+
+        // 模拟写者在条目 0 上占有后崩溃：读者不得读到该条目（视为未命中），也不会卡死
+        entries[0].seq.fetch_add(1);
+        entries[0].words[0].store(0x2121212121212121ull); // 半截写入
+        std::string out;
+        assert(!table.Get(0xC6120001, &out));
+
+        // 回绕到条目 0 时写者跳过它，写入下一个条目；其余条目照常工作
+        for (uint32_t i = 1; i < cap; i++) assert(table.Put(0xC6130000 + i, "n" + std::to_string(i), 10 + i));
+        assert(table.Put(0xC6140000, "after.crash", 100));
+        assert(table.Get(0xC6140000, &out) && out == "after.crash");
+        assert(table.Get(0xC613000F, &out) && out == "n15");
+        assert(!table.Get(0xC6130001, &out)); // 条目 1 被回绕覆盖
+        assert(entries[0].seq.load() & 1);
+
+        // 所有条目都被占用时 Put 放弃而非阻塞
+        for (uint32_t i = 0; i < cap; i++) entries[i].seq.fetch_or(1);
+        assert(!table.Put(0xC6150000, "nowhere", 200));
+    }
+
+    // ===== 随机对拍：哈希索引 vs 旧版线性扫描 =====
+    {
+        const uint32_t cap = 4096;
+        std::vector<uint8_t> mem(Network::SharedFakeIpTable::RequiredBytes(cap));
+        Network::SharedFakeIpTable table;
+        assert(table.Attach(mem.data(), mem.size(), cap));
+        ReferenceTable ref(cap);
+
+        uint32_t seed = 99;
+        uint64_t tick = 1;
+        std::string out;
+        for (int i = 0; i < 60000; i++) {
+            const uint32_t ip = 0xC6120000 + 1 + NextRand(&seed) % 6000;
+            const std::string domain = "d" + std::to_string(NextRand(&seed) % 8000) + ".example";
+            table.Put(ip, domain, tick);
+            ref.Put(ip, domain, tick);
+            tick++;
+
+            const uint32_t probe = 0xC6120000 + 1 + NextRand(&seed) % 6000;
+            const ReferenceTable::Row* expect = ref.NewestByIp(probe);
+            const bool found = table.Get(probe, &out);
+            assert(found == (expect != nullptr));
+            if (found) assert(out == expect->domain);
+        }
+    }
+
+    // ===== 命名共享段：两个独立映射视图看到同一张表 =====
+    {
+        const std::string name = "Local\\AntigravityProxy_FakeIP_Test";
+        const uint32_t cap = 256;
+        const size_t bytes = Network::SharedFakeIpTable::RequiredBytes(cap);
+        Network::SharedMemoryRegion::Remove(name);
+
+        Network::SharedMemoryRegion a;
+        bool created = false;
+        assert(a.Open(name, bytes, &created) && created);
+        Network::SharedFakeIpTable ta;
+        assert(ta.Attach(a.Data(), a.Size(), cap));
+        ta.Put(0xC6120010, "shared.example", 1);
+
+        Network::SharedMemoryRegion b;
+        assert(b.Open(name, bytes, &created) && !created);
+        Network::SharedFakeIpTable tb;
+        assert(tb.Attach(b.Data(), b.Size(), cap));
+        std::string out;
+        assert(tb.Get(0xC6120010, &out) && out == "shared.example");
+
+#ifndef _WIN32
+        // 子进程写入、父进程读取（跨进程可见性）
+        const pid_t pid = fork();
+        if (pid == 0) {
+            Network::SharedMemoryRegion c;
+            bool childCreated = true;
+            if (!c.Open(name, bytes, &childCreated) || childCreated) _exit(1);
+            Network::SharedFakeIpTable tc;
+            if (!tc.Attach(c.Data(), c.Size(), cap)) _exit(2);
+            for (uint32_t i = 0; i < 100; i++) tc.Put(0xC6120100 + i, "child" + std::to_string(i), 100 + i);
+            _exit(0);
+        }
+        int status = 0;
+        assert(pid > 0 && waitpid(pid, &status, 0) == pid);
+        assert(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+        for (uint32_t i = 0; i < 100; i++) {
+            assert(ta.Get(0xC6120100 + i, &out) && out == "child" + std::to_string(i));
+        }
+#endif
+        Network::SharedMemoryRegion::Remove(name);
+    }
+
+    // ===== 文件持久化：重开后映射与逻辑时钟仍在；格式不符时由唯一使用者重建 =====
+    {
+        using Table = Network::SharedFakeIpTable;
+        const std::string path = "antigravity_fakeip_test.map";
+        const uint32_t cap = 512;
+        const size_t bytes = Table::FileBytesFor(cap);
+        std::remove(path.c_str());
+        std::string out;
+        uint64_t lastStamp = 0;
+        {
+            Network::SharedMemoryRegion r;
+            bool exclusive = false;
+            assert(r.OpenFile(path, bytes, &exclusive) && exclusive);
+            Table t;
+            assert(t.AttachFile(r.Data(), r.Size(), cap, exclusive));
+            r.DowngradeToShared();
+            for (uint32_t i = 0; i < 100; i++) assert(t.Put(0xC6120001 + i, "p" + std::to_string(i), t.NextStamp()));
+            lastStamp = t.NextStamp();
+
+            // 第二个使用者：非独占；大小不一致时拒绝打开（不在他人使用中改文件）
+            Network::SharedMemoryRegion other;
+            bool otherExclusive = true;
+            assert(!other.OpenFile(path, Table::FileBytesFor(cap * 2), &otherExclusive));
+            assert(other.OpenFile(path, bytes, &otherExclusive) && !otherExclusive);
+            Table t2;
+            assert(t2.AttachFile(other.Data(), other.Size(), cap, otherExclusive));
+            assert(t2.Get(0xC6120001, &out) && out == "p0");
+        }
+        {
+            // “重启”：内容保留，时钟接着递增，新写入仍优先于旧记录
+            Network::SharedMemoryRegion r;
+            bool exclusive = false;
+            assert(r.OpenFile(path, bytes, &exclusive) && exclusive);
+            Table t;
+            assert(t.AttachFile(r.Data(), r.Size(), cap, exclusive));
+            assert(t.Get(0xC6120005, &out) && out == "p4");
+            uint32_t ip = 0;
+            assert(t.FindDomain("p99", &ip) && ip == 0xC6120064);
+            assert(t.NextStamp() > lastStamp);
+            assert(t.Put(0xC6120001, "p0.new", t.NextStamp()));
+            assert(t.Get(0xC6120001, &out) && out == "p0.new");
+
+            // 文件头版本不符：有其他使用者时拒绝绑定
+            static_cast<Table::FileHeader*>(r.Data())->version = Table::kFileVersion + 1;
+            r.DowngradeToShared();
+            Network::SharedMemoryRegion other;
+            bool otherExclusive = true;
+            assert(other.OpenFile(path, bytes, &otherExclusive) && !otherExclusive);
+            Table t2;
+            assert(!t2.AttachFile(other.Data(), other.Size(), cap, otherExclusive));
+        }
+        {
+            // 唯一使用者重建为空表
+            Network::SharedMemoryRegion r;
+            bool exclusive = false;
+            assert(r.OpenFile(path, bytes, &exclusive) && exclusive);
+            Table t;
+            assert(t.AttachFile(r.Data(), r.Size(), cap, exclusive));
+            assert(!t.Get(0xC6120005, &out));
+            assert(t.NextStamp() == 1);
+        }
+        {
+            // 容量变化：唯一使用者调整文件大小并重建
+            Network::SharedMemoryRegion r;
+            bool exclusive = false;
+            assert(r.OpenFile(path, Table::FileBytesFor(cap * 2), &exclusive) && exclusive);
+            Table t;
+            assert(t.AttachFile(r.Data(), r.Size(), cap * 2, exclusive));
+            assert(t.Capacity() == cap * 2 && t.Put(0xC6120001, "grown", t.NextStamp()));
+        }
+        std::remove(path.c_str());
+    }
+
+#ifndef _WIN32
+    // ===== 多进程压力：并发写者 + 并发读者，证明无丢失、无撕裂 =====
+    {
+        const std::string name = "Local\\AntigravityProxy_FakeIP_Torture";
+        const uint32_t cap = 8192;
+        const size_t bytes = Network::SharedFakeIpTable::RequiredBytes(cap);
+        const uint32_t writers = 4;
+        const uint32_t perWriter = 1500;
+        Network::SharedMemoryRegion::Remove(name);
+        Network::SharedMemoryRegion region;
+        bool created = false;
+        assert(region.Open(name, bytes, &created));
+        Network::SharedFakeIpTable table;
+        assert(table.Attach(region.Data(), region.Size(), cap));
+
+        // 域名可由 ip 推出，读者据此校验内容是否属于该 ip、是否完整
+        auto domainOf = [](uint32_t ip) {
+            std::string d = "ip" + std::to_string(ip) + ".";
+            d.append(ip % 180, static_cast<char>('a' + ip % 26));
+            return d + ".example";
+        };
+        auto childMain = [&](int role, uint32_t index) -> int {
+            Network::SharedMemoryRegion r;
+            bool c = false;
+            if (!r.Open(name, bytes, &c)) return 10;
+            Network::SharedFakeIpTable t;
+            if (!t.Attach(r.Data(), r.Size(), cap)) return 11;
+            if (role == 0) {
+                for (uint32_t i = 0; i < perWriter; i++) {
+                    const uint32_t ip = 0xC6120000 + index * 10000 + i + 1;
+                    if (!t.Put(ip, domainOf(ip), 1000 + i)) return 12;
+                }
+                return 0;
+            }
+            uint32_t seed = 31 + index;
+            std::string out;
+            for (int i = 0; i < 200000; i++) {
+                const uint32_t ip = 0xC6120000 + (NextRand(&seed) % writers) * 10000 + NextRand(&seed) % perWriter + 1;
+                if (t.Get(ip, &out) && out != domainOf(ip)) return 13; // 撕裂或串条目
+            }
+            return 0;
+        };
+
+        std::vector<pid_t> pids;
+        for (uint32_t i = 0; i < writers + 2; i++) {
+            const pid_t pid = fork();
+            if (pid == 0) _exit(childMain(i < writers ? 0 : 1, i < writers ? i : i - writers));
+            assert(pid > 0);
+            pids.push_back(pid);
+        }
+        for (pid_t pid : pids) {
+            int status = 0;
+            assert(waitpid(pid, &status, 0) == pid);
+            assert(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+        }
+        std::string out;
+        for (uint32_t w = 0; w < writers; w++) {
+            for (uint32_t i = 0; i < perWriter; i++) {
+                const uint32_t ip = 0xC6120000 + w * 10000 + i + 1;
+                assert(table.Get(ip, &out) && out == domainOf(ip));
+            }
+        }
+
+        // 写者在任意时刻被 SIGKILL：表仍可读、内容不撕裂，后续写入照常
+        for (int round = 0; round < 20; round++) {
+            const pid_t pid = fork();
+            if (pid == 0) {
+                Network::SharedMemoryRegion r;
+                bool c = false;
+                if (!r.Open(name, bytes, &c)) _exit(10);
+                Network::SharedFakeIpTable t;
+                if (!t.Attach(r.Data(), r.Size(), cap)) _exit(11);
+                for (uint32_t i = 0;; i++) {
+                    const uint32_t ip = 0xC6130000 + (i % 20000);
+                    t.Put(ip, domainOf(ip), 5000 + i);
+                }
+            }
+            usleep(2000 + round * 300);
+            kill(pid, SIGKILL);
+            int status = 0;
+            assert(waitpid(pid, &status, 0) == pid);
+        }
+        for (uint32_t i = 0; i < 20000; i++) {
+            const uint32_t ip = 0xC6130000 + i;
+            if (table.Get(ip, &out)) assert(out == domainOf(ip));
+        }
+        assert(table.Put(0xC6140001, domainOf(0xC6140001), 999999));
+        assert(table.Get(0xC6140001, &out) && out == domainOf(0xC6140001));
+        Network::SharedMemoryRegion::Remove(name);
+    }
+#endif
+    return 0;
+}
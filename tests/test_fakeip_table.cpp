@@ -0,0 +1,166 @@
+#include <atomic>
+#include <cassert>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "network/FakeIpTable.hpp"
+
+static uint32_t NextRand(uint32_t* state) {
+    *state = *state * 1664525u + 1013904223u;
+    return *state >> 8;
+}
+
+// 构造可自校验的域名："o<offset>-g<gen>." + 长度随 gen 变化的同一字符填充 + ".test"
+// 读端据此判断结果是否属于该槽位、是否被撕裂
+static std::string MakeDomain(uint32_t offset, uint32_t gen) {
+    std::string d = "o" + std::to_string(offset) + "-g" + std::to_string(gen) + ".";
+    d.append(gen % 200, static_cast<char>('a' + gen % 26));
+    d += ".test";
+    return d;
+}
+
+static bool CheckDomain(const std::string& d, uint32_t offset) {
+    const std::string prefix = "o" + std::to_string(offset) + "-g";
+    if (d.compare(0, prefix.size(), prefix) != 0) return false;
+    const size_t dot = d.find('.', prefix.size());
+    if (dot == std::string::npos) return false;
+    const uint32_t gen = static_cast<uint32_t>(std::stoul(d.substr(prefix.size(), dot - prefix.size())));
+    return d == MakeDomain(offset, gen);
+}
+
+int main() {
+    // ===== 基础语义 =====
+    {
+        Network::FakeIpSlotTable table;
+        table.Reset(1000);
+        assert(table.SlotCount() == 1000);
+        assert(table.GetMemoryStats().slotBytes == 0);
+
+        std::string out;
+        assert(!table.Read(5, &out));
+        assert(table.Publish(5, "example.com"));
+        assert(table.Read(5, &out) && out == "example.com");
+        assert(table.GetMemoryStats().slotBytes > 0 && table.GetMemoryStats().arenaBytes > 0);
+
+        assert(table.Publish(5, "a.very.long.subdomain.example.org"));
+        assert(table.Read(5, &out) && out == "a.very.long.subdomain.example.org");
+        assert(table.Publish(5, "b.io"));
+        assert(table.Read(5, &out) && out == "b.io");
+        assert(table.Publish(5, ""));
+        assert(!table.Read(5, &out));
+
+        const std::string maxLen(Network::FakeIpSlotTable::kDomainMax, 'x');
+        assert(table.Publish(999, maxLen));
+        assert(table.Read(999, &out) && out == maxLen);
+        assert(!table.Publish(998, maxLen + "x"));
+        assert(!table.Publish(1000, "out.of.range"));
+        assert(!table.Read(1000, &out));
+
+        char buf[Network::FakeIpSlotTable::kDomainMax + 8];
+        assert(table.WriterRead(999, buf) == maxLen.size());
+
+        table.Reset(0);
+        assert(!table.Publish(0, "x"));
+    }
+
+    // ===== 正向索引：回收、同名改指向、扩容与随机改写对拍 =====
+    {
+        Network::FakeIpSlotTable table;
+        table.Reset(1u << 17);
+        uint32_t offset = 0;
+        assert(!table.FindDomain("a.com", &offset));
+        assert(table.Publish(10, "a.com"));
+        assert(table.FindDomain("a.com", &offset) && offset == 10);
+
+        // 回收：槽位改写后旧域名不再可查
+        assert(table.Publish(10, "b.com"));
+        assert(!table.FindDomain("a.com", &offset));
+        assert(table.FindDomain("b.com", &offset) && offset == 10);
+
+        // 同名写入另一槽位（共享映射回填）：索引改指向新槽位；旧槽位回收时不影响索引
+        assert(table.Publish(20, "b.com"));
+        assert(table.FindDomain("b.com", &offset) && offset == 20);
+        assert(table.Publish(10, "c.com"));
+        assert(table.FindDomain("b.com", &offset) && offset == 20);
+        assert(table.Publish(20, ""));
+        assert(!table.FindDomain("b.com", &offset));
+
+        // 随机改写：与 std::unordered_map 参照实现逐步对拍（覆盖扩容与后移删除）
+        std::vector<std::string> slotDomain(1u << 17);
+        slotDomain[10] = "c.com";
+        std::unordered_map<std::string, uint32_t> ref = {{"c.com", 10}};
+        uint32_t seed = 4242;
+        for (int i = 0; i < 200000; i++) {
+            const uint32_t slot = NextRand(&seed) % 5000;
+            const std::string domain = "d" + std::to_string(NextRand(&seed) % 8000) + ".example";
+            if (!slotDomain[slot].empty()) {
+                auto it = ref.find(slotDomain[slot]);
+                if (it != ref.end() && it->second == slot) ref.erase(it);
+            }
+            assert(table.Publish(slot, domain));
+            slotDomain[slot] = domain;
+            ref[domain] = slot;
+            // 无锁提示：刚发布的域名必然命中；任意域名命中时槽位内容必然一致
+            const uint32_t hash = Network::FakeIpSlotTable::HashDomain(domain);
+            assert(table.TryFindDomain(domain, hash, &offset) && offset == slot);
+            const std::string other = "d" + std::to_string(NextRand(&seed) % 8000) + ".example";
+            if (table.TryFindDomain(other, Network::FakeIpSlotTable::HashDomain(other), &offset)) {
+                assert(slotDomain[offset] == other);
+            }
+            if (i % 1000 == 0) {
+                for (const auto& kv : ref) {
+                    assert(table.FindDomain(kv.first, &offset) && offset == kv.second);
+                }
+                assert(table.GetMemoryStats().liveDomains == ref.size());
+            }
+        }
+        std::string out;
+        for (uint32_t i = 0; i < 5000; i++) {
+            if (slotDomain[i].empty()) continue;
+            assert(table.Read(i, &out) && out == slotDomain[i]);
+        }
+    }
+
+    // ===== 并发压力：单写者反复改写，多读者校验无撕裂、无串槽 =====
+    {
+        constexpr uint32_t kSlots = 512;
+        Network::FakeIpSlotTable table;
+        table.Reset(kSlots);
+        for (uint32_t i = 0; i < kSlots; i++) assert(table.Publish(i, MakeDomain(i, 0)));
+
+        std::atomic<bool> stop{false};
+        std::atomic<uint64_t> reads{0};
+        std::atomic<uint64_t> bad{0};
+        std::vector<std::thread> readers;
+        const unsigned readerCount = 4;
+        for (unsigned r = 0; r < readerCount; r++) {
+            readers.emplace_back([&, r]() {
+                uint32_t seed = 1000 + r;
+                std::string out;
+                uint64_t n = 0;
+                while (!stop.load(std::memory_order_relaxed)) {
+                    const uint32_t offset = NextRand(&seed) % kSlots;
+                    if (!table.Read(offset, &out) || !CheckDomain(out, offset)) bad.fetch_add(1);
+                    n++;
+                }
+                reads.fetch_add(n);
+            });
+        }
+
+        uint32_t seed = 7;
+        for (uint32_t gen = 1; gen <= 300000; gen++) {
+            // 一半写热点槽位（制造读写冲突），一半随机
+            const uint32_t offset = (gen & 1) ? (NextRand(&seed) % 8) : (NextRand(&seed) % kSlots);
+            assert(table.Publish(offset, MakeDomain(offset, gen)));
+        }
+        stop.store(true);
+        for (auto& t : readers) t.join();
+
+        assert(bad.load() == 0);
+        assert(reads.load() > 0);
+    }
+    return 0;
+}
@@ -0,0 +1,72 @@
+#include <cassert>
+#include <cstring>
+#include <string>
+
+#include "network/HttpConnectCodec.hpp"
+
+namespace HC = Network::HttpConnect;
+
+int main() {
+    // ===== 请求编码 =====
+    {
+        char buf[HC::kMaxRequestBytes];
+        size_t n = HC::EncodeRequest("example.com", 443, buf, sizeof(buf));
+        const std::string expect = "CONNECT example.com:443 HTTP/1.1\r\nHost: example.com:443\r\n\r\n";
+        assert(n == expect.size() && std::memcmp(buf, expect.data(), n) == 0);
+        assert(HC::EncodeRequest("example.com", 443, buf, n - 1) == 0);
+
+        n = HC::EncodeRequest("::1", 8080, buf, sizeof(buf));
+        assert(std::string(buf, n) == "CONNECT [::1]:8080 HTTP/1.1\r\nHost: [::1]:8080\r\n\r\n");
+
+        // 最长主机名 + 最长端口恰好放得下
+        n = HC::EncodeRequest(std::string(255, 'h'), 65535, buf, sizeof(buf));
+        assert(n > 0 && n <= sizeof(buf));
+        assert(HC::EncodeRequest(std::string(256, 'h'), 80, buf, sizeof(buf)) == 0);
+        assert(HC::EncodeRequest("", 80, buf, sizeof(buf)) == 0);
+    }
+
+    // ===== 状态行 =====
+    {
+        const std::string ok = "HTTP/1.1 200 Connection established\r\n";
+        assert(HC::ParseStatusCode(ok.data(), ok.size()) == 200);
+        const std::string v10 = "HTTP/1.0 407 Proxy Authentication Required\r\n";
+        assert(HC::ParseStatusCode(v10.data(), v10.size()) == 407);
+        const std::string bad = "SSH-2.0-OpenSSH_9.0\r\n";
+        assert(HC::ParseStatusCode(bad.data(), bad.size()) == -1);
+        const std::string letters = "HTTP/1.1 2x0 Weird\r\n";
+        assert(HC::ParseStatusCode(letters.data(), letters.size()) == -1);
+        assert(HC::ParseStatusCode(nullptr, 0) == -1);
+    }
+
+    // ===== 响应头：增量输入，只消费到空行 =====
+    {
+        const std::string header = "HTTP/1.1 200 OK\r\nProxy-Agent: x\r\n\r\n";
+        const std::string wire = header + "\x16\x03\x01";
+        HC::Response r;
+        size_t scanned = 0;
+        for (size_t len = 0; len < header.size(); len++) {
+            assert(HC::DecodeResponse(wire.data(), len, &r, scanned) == HC::DecodeStatus::NeedMore);
+            scanned = len;
+        }
+        assert(HC::DecodeResponse(wire.data(), wire.size(), &r, scanned) == HC::DecodeStatus::Done);
+        assert(r.status == 200 && r.length == header.size());
+
+        // 空行跨越两次输入：scanFrom 回看分隔符前缀
+        const size_t split = header.size() - 2;
+        assert(HC::DecodeResponse(wire.data(), split, &r, 0) == HC::DecodeStatus::NeedMore);
+        assert(HC::DecodeResponse(wire.data(), header.size(), &r, split) == HC::DecodeStatus::Done);
+        assert(r.length == header.size());
+
+        const std::string rejected = "HTTP/1.1 403 Forbidden\r\n\r\n";
+        assert(HC::DecodeResponse(rejected.data(), rejected.size(), &r) == HC::DecodeStatus::Done && r.status == 403);
+
+        const std::string junk = "garbage\r\n\r\n";
+        assert(HC::DecodeResponse(junk.data(), junk.size(), &r) == HC::DecodeStatus::Invalid);
+
+        const std::string longHeader = "HTTP/1.1 200 OK\r\nX: " + std::string(HC::kMaxResponseBytes, 'a');
+        assert(HC::DecodeResponse(longHeader.data(), longHeader.size(), &r) == HC::DecodeStatus::TooLong);
+        const std::string lateEnd = longHeader + "\r\n\r\n";
+        assert(HC::DecodeResponse(lateEnd.data(), lateEnd.size(), &r) == HC::DecodeStatus::TooLong);
+    }
+    return 0;
+}
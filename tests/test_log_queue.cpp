@@ -0,0 +1,95 @@
+#include <atomic>
+#include <cassert>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "core/LogQueue.hpp"
+
+int main() {
+    // ===== 队列满：丢弃并计数，Flush 时一并上报 =====
+    {
+        std::vector<std::string> batches;
+        std::vector<uint64_t> drops;
+        Core::AsyncLogWriter writer(8, [&](const std::string& batch, uint64_t dropped) {
+            batches.push_back(batch);
+            drops.push_back(dropped);
+        });
+        int accepted = 0;
+        for (int i = 0; i < 20; i++) {
+            std::string line = "line" + std::to_string(i);
+            if (writer.Push(line, false)) {
+                accepted++;
+                assert(line.empty()); // 换回的是已清空的旧缓冲
+            } else {
+                assert(line == "line" + std::to_string(i));
+            }
+        }
+        assert(accepted == 8 && writer.Dropped() == 12);
+
+        writer.Flush();
+        assert(batches.size() == 1 && drops[0] == 12);
+        std::string expect;
+        for (int i = 0; i < 8; i++) expect += "line" + std::to_string(i) + "\n";
+        assert(batches[0] == expect);
+
+        // 无新日志、无新丢弃：不再调用 sink；腾出空间后可继续入队
+        writer.Flush();
+        assert(batches.size() == 1);
+        std::string line = "again";
+        assert(writer.Push(line, false));
+        writer.Flush();
+        assert(batches.size() == 2 && batches[1] == "again\n" && drops[1] == 0);
+    }
+
+    // ===== 多生产者 + 写线程：每条恰好写出一次，同一生产者内保持顺序 =====
+    {
+        const int producers = 4;
+        const int perProducer = 20000;
+        std::mutex mtx;
+        std::string all;
+        uint64_t droppedTotal = 0;
+        Core::AsyncLogWriter writer(1024, [&](const std::string& batch, uint64_t dropped) {
+            std::lock_guard<std::mutex> lock(mtx);
+            all += batch;
+            droppedTotal += dropped;
+        });
+        writer.Start();
+
+        std::atomic<int> accepted{0};
+        std::vector<std::thread> threads;
+        for (int p = 0; p < producers; p++) {
+            threads.emplace_back([&, p]() {
+                for (int i = 0; i < perProducer; i++) {
+                    std::string line = std::to_string(p) + ":" + std::to_string(i);
+                    while (!writer.Push(line, (i & 1023) == 0)) std::this_thread::yield();
+                    accepted.fetch_add(1);
+                }
+            });
+        }
+        for (auto& t : threads) t.join();
+        writer.Stop();
+        assert(accepted.load() == producers * perProducer);
+        assert(droppedTotal == writer.Dropped());
+
+        std::vector<int> next(producers, 0);
+        size_t pos = 0;
+        int lines = 0;
+        while (pos < all.size()) {
+            const size_t nl = all.find('\n', pos);
+            assert(nl != std::string::npos);
+            const std::string line = all.substr(pos, nl - pos);
+            const size_t colon = line.find(':');
+            const int p = std::stoi(line.substr(0, colon));
+            const int i = std::stoi(line.substr(colon + 1));
+            assert(p >= 0 && p < producers && i == next[p]);
+            next[p]++;
+            lines++;
+            pos = nl + 1;
+        }
+        assert(lines == producers * perProducer);
+    }
+    return 0;
+}
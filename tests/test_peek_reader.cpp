@@ -0,0 +1,127 @@
+#include <cassert>
+#include <cstring>
+#include <deque>
+#include <string>
+
+#include "network/PeekReader.hpp"
+
+namespace {
+    using Network::PeekReader::Step;
+
+    // 假 socket：available 为当前可读数据，pending 为之后逐批到达的数据；统计系统调用次数
+    struct FakeIo {
+        std::string available;
+        std::deque<std::string> pending;
+        bool closed = false;
+        bool wouldBlock = false;
+        int peeks = 0;
+        int takes = 0;
+
+        int Peek(char* buf, int len) {
+            peeks++;
+            if (available.empty()) {
+                if (closed) return 0;
+                wouldBlock = true;
+                return -1;
+            }
+            const int n = (int)std::min<size_t>((size_t)len, available.size());
+            std::memcpy(buf, available.data(), (size_t)n);
+            return n;
+        }
+        int Take(char* buf, int len) {
+            takes++;
+            const int n = (int)std::min<size_t>((size_t)len, available.size());
+            std::memcpy(buf, available.data(), (size_t)n);
+            available.erase(0, (size_t)n);
+            return n;
+        }
+        bool WouldBlock() const { return wouldBlock; }
+        // 模拟 WaitReadable：下一批数据到达
+        bool Arrive() {
+            if (pending.empty()) return false;
+            available += pending.front();
+            pending.pop_front();
+            return true;
+        }
+    };
+
+    // 驱动 ReadStep 直到结束（Wait 时投递下一批数据；已关闭时再读一次得到 Closed）
+    Step Drive(FakeIo& io, char* buf, size_t cap, size_t* used, const std::string& delim = "\r\n\r\n") {
+        for (;;) {
+            const Step st = Network::PeekReader::ReadStep(io, buf, cap, used, delim);
+            if (st != Step::Wait) return st;
+            if (!io.Arrive() && !io.closed) return Step::Wait;
+        }
+    }
+}
+
+int main() {
+    const std::string header = "HTTP/1.1 200 Connection established\r\nProxy-Agent: test\r\n\r\n";
+
+    // ===== FindEnd =====
+    {
+        using Network::PeekReader::FindEnd;
+        const std::string s = "ab\r\n\r\ncd";
+        assert(FindEnd(s.data(), s.size(), 0, "\r\n\r\n") == 6);
+        assert(FindEnd(s.data(), s.size(), 3, "\r\n\r\n") == std::string::npos);
+        assert(FindEnd(s.data(), 5, 0, "\r\n\r\n") == std::string::npos);
+        assert(FindEnd("\r\r\n\r\n", 5, 0, "\r\n\r\n") == 5);
+        assert(FindEnd("x", 1, 0, "") == std::string::npos);
+    }
+
+    // ===== 一次到达：2 次系统调用，隧道数据不被吞掉 =====
+    {
+        FakeIo io;
+        io.available = header + "TUNNEL";
+        char buf[1024];
+        size_t used = 0;
+        assert(Drive(io, buf, sizeof(buf), &used) == Step::Done);
+        assert(used == header.size() && std::string(buf, used) == header);
+        assert(io.available == "TUNNEL");
+        assert(io.peeks == 1 && io.takes == 1);
+    }
+
+    // ===== 分隔符跨批次到达（逐段、甚至逐字节） =====
+    {
+        FakeIo io;
+        io.pending = {"HTTP/1.1 200 OK\r", "\n", "\r", "\n\x16\x03"};
+        char buf[1024];
+        size_t used = 0;
+        assert(Drive(io, buf, sizeof(buf), &used) == Step::Done);
+        assert(std::string(buf, used) == "HTTP/1.1 200 OK\r\n\r\n");
+        assert(io.available == "\x16\x03");
+
+        FakeIo bytewise;
+        for (char c : header) bytewise.pending.push_back(std::string(1, c));
+        bytewise.pending.back() += "X";
+        used = 0;
+        assert(Drive(bytewise, buf, sizeof(buf), &used) == Step::Done);
+        assert(std::string(buf, used) == header && bytewise.available == "X");
+    }
+
+    // ===== 头部过长 / 对端关闭 / 暂无数据 =====
+    {
+        FakeIo io;
+        io.available = std::string(64, 'a');
+        char buf[32];
+        size_t used = 0;
+        assert(Drive(io, buf, sizeof(buf), &used) == Step::TooLong && used == sizeof(buf));
+
+        // 分隔符恰好落在缓冲区末尾仍然成功
+        FakeIo exact;
+        exact.available = std::string(28, 'a') + "\r\n\r\n" + "rest";
+        used = 0;
+        assert(Drive(exact, buf, sizeof(buf), &used) == Step::Done && used == 32 && exact.available == "rest");
+
+        FakeIo closed;
+        closed.available = "HTTP/1.1 200";
+        closed.closed = true;
+        used = 0;
+        assert(Drive(closed, buf, sizeof(buf), &used) == Step::Closed && used == 12);
+
+        FakeIo idle;
+        used = 0;
+        assert(Network::PeekReader::ReadStep(idle, buf, sizeof(buf), &used, "\r\n\r\n") == Step::Wait && used == 0);
+    }
+    return 0;
+}
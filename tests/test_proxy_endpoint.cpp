@@ -0,0 +1,227 @@
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "network/ProxyEndpoint.hpp"
+
+namespace {
+    // 假解析后端：返回预设的 A/AAAA 列表或错误码，并统计调用次数
+    struct FakeResolver {
+        std::mutex mtx;
+        std::vector<uint32_t> v4;           // host order
+        std::vector<uint8_t> v6LastByte;     // 2001:db8::<n>
+        int failure = 0;
+        std::atomic<int> calls{0};
+
+        int Resolve(const std::string&, int family, std::vector<sockaddr_storage>* out) {
+            calls.fetch_add(1);
+            assert(family == AF_UNSPEC);
+            std::lock_guard<std::mutex> lock(mtx);
+            if (failure != 0) return failure;
+            for (uint8_t b : v6LastByte) {
+                sockaddr_storage ss{};
+                auto* in6 = reinterpret_cast<sockaddr_in6*>(&ss);
+                in6->sin6_family = AF_INET6;
+                uint8_t* bytes = reinterpret_cast<uint8_t*>(&in6->sin6_addr);
+                bytes[0] = 0x20; bytes[1] = 0x01; bytes[2] = 0x0d; bytes[3] = 0xb8;
+                bytes[15] = b;
+                out->push_back(ss);
+            }
+            for (uint32_t ip : v4) {
+                sockaddr_storage ss{};
+                auto* in4 = reinterpret_cast<sockaddr_in*>(&ss);
+                in4->sin_family = AF_INET;
+                in4->sin_addr.s_addr = htonl(ip);
+                out->push_back(ss);
+            }
+            return 0;
+        }
+    };
+
+    uint32_t Ip(const sockaddr_storage& ss) { return ntohl(reinterpret_cast<const sockaddr_in*>(&ss)->sin_addr.s_addr); }
+    uint16_t Port(const sockaddr_storage& ss) { return ntohs(reinterpret_cast<const sockaddr_in*>(&ss)->sin_port); }
+    const uint8_t* Bytes6(const sockaddr_storage& ss) {
+        return reinterpret_cast<const uint8_t*>(&reinterpret_cast<const sockaddr_in6*>(&ss)->sin6_addr);
+    }
+
+    uint32_t PickV4(Network::ProxyEndpoint& ep) {
+        sockaddr_storage ss{};
+        int len = 0;
+        int err = 0;
+        const bool ok = ep.Pick(AF_INET, &ss, &len, &err);
+        assert(ok && err == 0 && ss.ss_family == AF_INET && len == (int)sizeof(sockaddr_in));
+        return Ip(ss);
+    }
+
+    // 与 Hooks 的调用方一致：报告地址放在 sockaddr_storage 中
+    sockaddr_storage V4(uint32_t ip) {
+        sockaddr_storage ss{};
+        auto* in4 = reinterpret_cast<sockaddr_in*>(&ss);
+        in4->sin_family = AF_INET;
+        in4->sin_addr.s_addr = htonl(ip);
+        return ss;
+    }
+
+    void Fail(Network::ProxyEndpoint& ep, uint32_t ip) {
+        const sockaddr_storage ss = V4(ip);
+        ep.ReportFailure(reinterpret_cast<const sockaddr*>(&ss));
+    }
+}
+
+int main() {
+    // ===== IP 字面量：固定地址，不调用解析器 =====
+    {
+        FakeResolver backend;
+        Network::ProxyEndpoint ep([&](const std::string& n, int f, std::vector<sockaddr_storage>* o) {
+            return backend.Resolve(n, f, o);
+        });
+        ep.Configure("127.0.0.1", 7890, 0);
+        sockaddr_storage ss{};
+        int len = 0;
+        assert(ep.Pick(AF_INET, &ss, &len, nullptr) && Ip(ss) == 0x7F000001 && Port(ss) == 7890);
+        // 双栈 socket 拿到 v4-mapped 形式
+        assert(ep.Pick(AF_INET6, &ss, &len, nullptr) && ss.ss_family == AF_INET6);
+        assert(Bytes6(ss)[10] == 0xFF && Bytes6(ss)[11] == 0xFF && Bytes6(ss)[12] == 127 && Bytes6(ss)[15] == 1);
+        assert(len == (int)sizeof(sockaddr_in6));
+        // IPv6 字面量不能给 AF_INET socket
+        ep.Configure("::1", 7890, 0);
+        int err = 0;
+        assert(!ep.Pick(AF_INET, &ss, &len, &err) && err == EAI_FAMILY);
+        assert(ep.Pick(AF_INET6, &ss, &len, nullptr) && Bytes6(ss)[15] == 1);
+        assert(backend.calls.load() == 0);
+    }
+
+    FakeResolver backend;
+    backend.v4 = {0x0A000001, 0x0A000002, 0x0A000003};
+    backend.v6LastByte = {9};
+    uint64_t now = 1000;
+    Network::ProxyEndpoint ep(
+        [&](const std::string& n, int f, std::vector<sockaddr_storage>* o) { return backend.Resolve(n, f, o); },
+        [&]() { return now; });
+    // refreshMs=0：不启动后台线程，刷新由测试显式调用
+    ep.Configure("proxy.example.com", 1080, 0);
+
+    // ===== 首次使用解析一次，之后只读缓存；地址间轮换 =====
+    {
+        std::vector<int> seen(4, 0);
+        for (int i = 0; i < 30; i++) {
+            const uint32_t ip = PickV4(ep);
+            assert(ip >= 0x0A000001 && ip <= 0x0A000003);
+            seen[ip - 0x0A000000]++;
+        }
+        assert(seen[1] == 10 && seen[2] == 10 && seen[3] == 10);
+        assert(backend.calls.load() == 1 && ep.AddressCount() == 4);
+
+        sockaddr_storage ss{};
+        int len = 0;
+        assert(ep.Pick(AF_INET, &ss, &len, nullptr) && Port(ss) == 1080);
+        // AF_INET6 优先 AAAA
+        assert(ep.Pick(AF_INET6, &ss, &len, nullptr) && ss.ss_family == AF_INET6 && Bytes6(ss)[0] == 0x20);
+        assert(Bytes6(ss)[15] == 9);
+        // AAAA 冷却时退到 A 的 v4-mapped 形式
+        ep.ReportFailure(reinterpret_cast<const sockaddr*>(&ss));
+        assert(ep.Pick(AF_INET6, &ss, &len, nullptr) && Bytes6(ss)[10] == 0xFF && Bytes6(ss)[12] == 10);
+    }
+
+    // ===== 故障转移：失败地址进入冷却，冷却结束后恢复轮换 =====
+    {
+        Fail(ep, 0x0A000001);
+        Fail(ep, 0x0A000002);
+        for (int i = 0; i < 5; i++) assert(PickV4(ep) == 0x0A000003);
+
+        // 全部冷却：返回最早恢复的地址（.1 与 .2 冷却 5s，.3 再失败两次冷却 10s）
+        Fail(ep, 0x0A000003);
+        Fail(ep, 0x0A000003);
+        const uint32_t ip = PickV4(ep);
+        assert(ip == 0x0A000001 || ip == 0x0A000002);
+
+        // 成功清除冷却
+        const sockaddr_storage ok = V4(0x0A000003);
+        ep.ReportSuccess(reinterpret_cast<const sockaddr*>(&ok));
+        for (int i = 0; i < 3; i++) assert(PickV4(ep) == 0x0A000003);
+
+        // v4-mapped 报告与对应 IPv4 地址视为同一个
+        sockaddr_storage mapped{};
+        int len = 0;
+        ep.Configure("proxy.example.com", 1080, 0); // 同配置：无操作
+        backend.v6LastByte.clear();
+        now += Network::ProxyEndpoint::kMaxCooldownMs;
+        assert(ep.RefreshNow());
+        assert(ep.AddressCount() == 3);
+        assert(ep.Pick(AF_INET6, &mapped, &len, nullptr) && Bytes6(mapped)[10] == 0xFF);
+        const uint32_t mappedIp = (uint32_t)Bytes6(mapped)[12] << 24 | (uint32_t)Bytes6(mapped)[13] << 16 |
+                                  (uint32_t)Bytes6(mapped)[14] << 8 | Bytes6(mapped)[15];
+        ep.ReportFailure(reinterpret_cast<sockaddr*>(&mapped));
+        for (int i = 0; i < 6; i++) assert(PickV4(ep) != mappedIp);
+    }
+
+    // ===== 刷新：失败保留旧地址；成功替换集合并保留冷却状态 =====
+    {
+        const int before = backend.calls.load();
+        backend.failure = EAI_AGAIN;
+        int err = 0;
+        assert(!ep.RefreshNow(&err) && err == EAI_AGAIN);
+        assert(ep.AddressCount() == 3);
+        PickV4(ep);
+
+        backend.failure = 0;
+        backend.v4 = {0x0A000001, 0x0A000004};
+        Fail(ep, 0x0A000001);
+        assert(ep.RefreshNow());
+        assert(ep.AddressCount() == 2);
+        for (int i = 0; i < 4; i++) assert(PickV4(ep) == 0x0A000004);
+        assert(backend.calls.load() == before + 2 && ep.RefreshCount() >= 3);
+    }
+
+    // ===== 解析从未成功：失败后在重试间隔内不再打解析器 =====
+    {
+        FakeResolver dead;
+        dead.failure = EAI_NONAME;
+        uint64_t t = 0;
+        Network::ProxyEndpoint ep2(
+            [&](const std::string& n, int f, std::vector<sockaddr_storage>* o) { return dead.Resolve(n, f, o); },
+            [&]() { return t; });
+        ep2.Configure("gone.example.com", 1080, 0);
+        sockaddr_storage ss{};
+        int len = 0;
+        int err = 0;
+        for (int i = 0; i < 50; i++) {
+            assert(!ep2.Pick(AF_INET, &ss, &len, &err) && err == EAI_NONAME);
+        }
+        assert(dead.calls.load() == 1);
+        t += Network::ProxyEndpoint::kRetryAfterFailureMs;
+        assert(!ep2.Pick(AF_INET, &ss, &len, &err));
+        assert(dead.calls.load() == 2);
+
+        // 恢复后立即可用；换主机重新解析
+        dead.failure = 0;
+        dead.v4 = {0xC0A80001};
+        t += Network::ProxyEndpoint::kRetryAfterFailureMs;
+        assert(PickV4(ep2) == 0xC0A80001 && dead.calls.load() == 3);
+        ep2.Ensure("other.example.com", 1080, 0);
+        assert(ep2.AddressCount() == 0);
+        assert(PickV4(ep2) == 0xC0A80001 && dead.calls.load() == 4);
+    }
+
+    // ===== 后台刷新线程：按 refreshMs 刷新，Stop 可 join =====
+    {
+        FakeResolver bg;
+        bg.v4 = {0x0B000001};
+        Network::ProxyEndpoint ep3(
+            [&](const std::string& n, int f, std::vector<sockaddr_storage>* o) { return bg.Resolve(n, f, o); });
+        ep3.Configure("bg.example.com", 1080, 5);
+        // 首次 Pick 才会解析并启动刷新线程：不能只放在 assert 里（NDEBUG 下会被去掉，下面的等待永不结束）
+        const uint32_t first = PickV4(ep3);
+        assert(first == 0x0B000001);
+        (void)first;
+        while (ep3.RefreshCount() < 3) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        ep3.Stop();
+    }
+    return 0;
+}
@@ -0,0 +1,218 @@
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <string>
+
+#include "network/ProxyHandshake.hpp"
+
+namespace {
+    using Network::ProxyHandshake;
+    using Want = ProxyHandshake::Want;
+    using Error = ProxyHandshake::Error;
+
+    // 假连接：wire 为代理按顺序发回的全部字节（含隧道数据），每次读取最多 chunk 字节；
+    // sent 记录客户端发出的字节。closeAfter 为代理发完多少字节后断开（npos 表示不断开）
+    struct Script {
+        std::string wire;
+        size_t chunk = 1;
+        size_t closeAfter = std::string::npos;
+        size_t sendChunk = 64;
+
+        std::string sent;
+        size_t readPos = 0;
+        int sends = 0;
+        int recvs = 0;
+        int peeks = 0;
+    };
+
+    size_t Available(const Script& s) {
+        const size_t end = std::min(s.wire.size(), s.closeAfter);
+        return end > s.readPos ? end - s.readPos : 0;
+    }
+
+    Want Drive(ProxyHandshake& hs, Script& s) {
+        for (int guard = 0; guard < 10000; guard++) {
+            switch (hs.Next()) {
+                case Want::Send: {
+                    const size_t n = std::min(hs.SendSize(), s.sendChunk);
+                    assert(n > 0);
+                    s.sent.append((const char*)hs.SendData(), n);
+                    s.sends++;
+                    hs.OnSent(n);
+                    break;
+                }
+                case Want::Recv: {
+                    s.recvs++;
+                    const size_t n = std::min({hs.RecvSize(), s.chunk, Available(s)});
+                    assert(hs.RecvSize() > 0);
+                    std::memcpy(hs.RecvBuffer(), s.wire.data() + s.readPos, n);
+                    s.readPos += n;
+                    hs.OnReceived(n);
+                    break;
+                }
+                case Want::Peek: {
+                    s.peeks++;
+                    const size_t n = std::min({hs.RecvSize(), s.chunk, Available(s)});
+                    std::memcpy(hs.RecvBuffer(), s.wire.data() + s.readPos, n);
+                    hs.OnPeeked(n);
+                    break;
+                }
+                default:
+                    return hs.Next();
+            }
+        }
+        assert(false && "handshake did not finish");
+        return Want::Failed;
+    }
+
+    std::string Bytes(std::initializer_list<int> v) {
+        std::string s;
+        for (int b : v) s.push_back((char)b);
+        return s;
+    }
+
+    const std::string kGreeting = Bytes({5, 1, 0});
+    const std::string kMethodOk = Bytes({5, 0});
+    const std::string kReplyV4 = Bytes({5, 0, 0, 1, 10, 0, 0, 1, 0x1F, 0x90});
+    const std::string kReplyDomain = Bytes({5, 0, 0, 3, 3, 'a', 'b', 'c', 0, 80});
+    const std::string kTunnel = "TUNNEL-DATA";
+}
+
+int main() {
+    const std::string host = "example.com";
+    const std::string connectReq = Bytes({5, 1, 0, 3, 11}) + host + Bytes({0x01, 0xBB});
+
+    // ===== SOCKS5 逐步：任意分片下结果一致，且不读走隧道数据 =====
+    for (size_t chunk = 1; chunk <= 16; chunk++) {
+        for (const std::string& reply : {kReplyV4, kReplyDomain}) {
+            ProxyHandshake hs;
+            assert(hs.Start(ProxyHandshake::Protocol::Socks5, host, 443));
+            Script s;
+            s.wire = kMethodOk + reply + kTunnel;
+            s.chunk = chunk;
+            s.sendChunk = chunk;
+            assert(Drive(hs, s) == Want::Done);
+            assert(s.sent == kGreeting + connectReq);
+            assert(s.readPos == kMethodOk.size() + reply.size());
+            assert(hs.ReplyCode() == 0 && hs.GetError() == Error::None);
+        }
+    }
+
+    // ===== SOCKS5 流水线：认证 + CONNECT 一次发出 =====
+    {
+        ProxyHandshake hs;
+        assert(hs.Start(ProxyHandshake::Protocol::Socks5Pipelined, host, 443));
+        assert(hs.SendSize() == kGreeting.size() + connectReq.size());
+        Script s;
+        s.wire = kMethodOk + kReplyDomain + kTunnel;
+        s.chunk = 3;
+        assert(Drive(hs, s) == Want::Done);
+        assert(s.sends == 1 && s.sent == kGreeting + connectReq);
+        assert(s.readPos == kMethodOk.size() + kReplyDomain.size());
+    }
+
+    // ===== 流水线回退信号：认证响应后断开 / CONNECT 位置出现非 SOCKS5 字节 =====
+    {
+        ProxyHandshake hs;
+        hs.Start(ProxyHandshake::Protocol::Socks5Pipelined, host, 443);
+        Script s;
+        s.wire = kMethodOk;
+        s.closeAfter = kMethodOk.size();
+        assert(Drive(hs, s) == Want::Failed && hs.GetError() == Error::PipelineRejected);
+
+        ProxyHandshake hs2;
+        hs2.Start(ProxyHandshake::Protocol::Socks5Pipelined, host, 443);
+        Script s2;
+        s2.wire = kMethodOk + "HTTP/1.1 400 Bad Request\r\n\r\n";
+        assert(Drive(hs2, s2) == Want::Failed && hs2.GetError() == Error::PipelineRejected);
+
+        // 逐步模式下同样的情况只是普通失败
+        ProxyHandshake hs3;
+        hs3.Start(ProxyHandshake::Protocol::Socks5, host, 443);
+        Script s3;
+        s3.wire = kMethodOk;
+        s3.closeAfter = kMethodOk.size();
+        assert(Drive(hs3, s3) == Want::Failed && hs3.GetError() == Error::Closed);
+    }
+
+    // ===== SOCKS5 失败：认证方式 / REP / ATYP / 目标编码 =====
+    {
+        ProxyHandshake hs;
+        hs.Start(ProxyHandshake::Protocol::Socks5, host, 443);
+        Script s;
+        s.wire = Bytes({5, 0xFF});
+        assert(Drive(hs, s) == Want::Failed && hs.GetError() == Error::BadMethod);
+
+        ProxyHandshake hs2;
+        hs2.Start(ProxyHandshake::Protocol::Socks5, "10.0.0.1", 80);
+        Script s2;
+        s2.wire = kMethodOk + Bytes({5, 5, 0, 1, 0, 0, 0, 0, 0, 0});
+        assert(Drive(hs2, s2) == Want::Failed && hs2.GetError() == Error::Rejected && hs2.ReplyCode() == 5);
+        assert(s2.sent.substr(3) == Bytes({5, 1, 0, 1, 10, 0, 0, 1, 0, 80}));
+
+        ProxyHandshake hs3;
+        hs3.Start(ProxyHandshake::Protocol::Socks5, host, 443);
+        Script s3;
+        s3.wire = kMethodOk + Bytes({5, 0, 0, 9, 0, 0, 0, 0});
+        assert(Drive(hs3, s3) == Want::Failed && hs3.GetError() == Error::BadReply);
+
+        ProxyHandshake hs4;
+        assert(!hs4.Start(ProxyHandshake::Protocol::Socks5, std::string(256, 'a'), 443));
+        assert(hs4.Next() == Want::Failed && hs4.GetError() == Error::Encode);
+        assert(!hs4.Start(ProxyHandshake::Protocol::Http, "", 443));
+    }
+
+    // ===== HTTP CONNECT：peek 找空行，只消费响应头 =====
+    const std::string okResponse = "HTTP/1.1 200 Connection Established\r\nProxy-Agent: x\r\n\r\n";
+    for (size_t chunk = 1; chunk <= 80; chunk += 7) {
+        ProxyHandshake hs;
+        assert(hs.Start(ProxyHandshake::Protocol::Http, host, 443));
+        Script s;
+        s.wire = okResponse + kTunnel;
+        s.chunk = chunk;
+        assert(Drive(hs, s) == Want::Done);
+        assert(s.sent == "CONNECT example.com:443 HTTP/1.1\r\nHost: example.com:443\r\n\r\n");
+        assert(s.readPos == okResponse.size() && hs.HttpStatus() == 200);
+    }
+    {
+        // 整段到达：一次 peek + 一次消费
+        ProxyHandshake hs;
+        hs.Start(ProxyHandshake::Protocol::Http, "2001:db8::1", 8080);
+        Script s;
+        s.wire = okResponse + kTunnel;
+        s.chunk = 4096;
+        assert(Drive(hs, s) == Want::Done && s.peeks == 1 && s.recvs == 1);
+        assert(s.sent.compare(0, 30, "CONNECT [2001:db8::1]:8080 HTT") == 0);
+    }
+
+    // ===== HTTP 失败：非 200 / 无法解析 / 过长 / 中途断开 =====
+    {
+        ProxyHandshake hs;
+        hs.Start(ProxyHandshake::Protocol::Http, host, 443);
+        Script s;
+        s.wire = "HTTP/1.1 407 Proxy Authentication Required\r\n\r\n";
+        s.chunk = 5;
+        assert(Drive(hs, s) == Want::Failed && hs.GetError() == Error::Rejected && hs.HttpStatus() == 407);
+
+        ProxyHandshake hs2;
+        hs2.Start(ProxyHandshake::Protocol::Http, host, 443);
+        Script s2;
+        s2.wire = "SSH-2.0-OpenSSH\r\n\r\n";
+        assert(Drive(hs2, s2) == Want::Failed && hs2.GetError() == Error::BadReply);
+
+        ProxyHandshake hs3;
+        hs3.Start(ProxyHandshake::Protocol::Http, host, 443);
+        Script s3;
+        s3.wire = "HTTP/1.1 200 OK\r\nX: " + std::string(2000, 'a');
+        s3.chunk = 300;
+        assert(Drive(hs3, s3) == Want::Failed && hs3.GetError() == Error::TooLong);
+
+        ProxyHandshake hs4;
+        hs4.Start(ProxyHandshake::Protocol::Http, host, 443);
+        Script s4;
+        s4.wire = "HTTP/1.1 200 OK\r\n";
+        s4.closeAfter = s4.wire.size();
+        assert(Drive(hs4, s4) == Want::Failed && hs4.GetError() == Error::Closed);
+    }
+    return 0;
+}
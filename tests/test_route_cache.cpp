@@ -0,0 +1,95 @@
+#include <cassert>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "core/RouteCache.hpp"
+
+struct TraceEvent {
+    std::string host;
+    std::string ip;
+    uint16_t port;
+    Core::RouteProtocol protocol;
+};
+
+static uint32_t NextRand(uint32_t* state) {
+    *state = *state * 1664525u + 1013904223u;
+    return *state >> 8;
+}
+
+static bool SameDecision(const Core::RouteDecision& a, const Core::RouteDecision& b) {
+    return a.action == b.action && a.ruleIndex == b.ruleIndex;
+}
+
+// 合成 connect 轨迹：少量热点 host 反复出现（模拟浏览器连接复用模式），夹杂长尾
+static std::vector<TraceEvent> BuildTrace(size_t count) {
+    std::vector<TraceEvent> trace;
+    uint32_t seed = 2024;
+    for (size_t i = 0; i < count; i++) {
+        TraceEvent ev;
+        const uint32_t r = NextRand(&seed) % 100;
+        const uint32_t id = (r < 80) ? (NextRand(&seed) % 200) : (200 + NextRand(&seed) % 20000);
+        ev.host = "h" + std::to_string(id) + ((id % 3 == 0) ? ".cn" : ".example.com");
+        ev.ip = (id % 5 == 0) ? ("10.0." + std::to_string(id % 256) + ".1") : "";
+        ev.port = (id % 4 == 0) ? 80 : 443;
+        ev.protocol = (id % 7 == 0) ? Core::RouteProtocol::Udp : Core::RouteProtocol::Tcp;
+        trace.push_back(ev);
+    }
+    return trace;
+}
+
+int main() {
+    Core::ProxyRules rules;
+    Core::RoutingRule cn;
+    cn.name = "cn";
+    cn.action = "direct";
+    cn.domains = {".cn"};
+    rules.routing.rules.push_back(cn);
+    Core::RoutingRule web;
+    web.name = "web80";
+    web.action = "direct";
+    web.domains = {"*.example.com"};
+    web.ports = {"80"};
+    rules.routing.rules.push_back(web);
+    rules.CompileRoutingRules();
+
+    const std::vector<TraceEvent> trace = BuildTrace(50000);
+
+    // ===== 回放：缓存结果必须与直接匹配逐条一致 =====
+    Core::RouteDecisionCache cache(64); // 16 分片 × 64 = 1024 条，小于长尾规模以触发淘汰
+    for (const auto& ev : trace) {
+        const auto cached = cache.Match(rules, ev.host, ev.ip, false, ev.port, ev.protocol);
+        const auto direct = rules.MatchRouting(ev.host, ev.ip, false, ev.port, ev.protocol);
+        assert(SameDecision(cached, direct));
+    }
+    auto stats = cache.GetStats();
+    assert(stats.hits + stats.misses == trace.size());
+    assert(stats.hits > stats.misses); // 热点集中，命中率应明显过半
+    assert(stats.evictions > 0);
+    assert(cache.Size() <= Core::RouteDecisionCache::kShardCount * 64);
+
+    // ===== 规则重编译：代次变化后旧条目不得再命中 =====
+    const auto before = cache.Match(rules, "h3.cn", "", false, 443, Core::RouteProtocol::Tcp);
+    assert(before.IsDirect());
+    rules.routing.rules[0].action = "proxy";
+    rules.CompileRoutingRules();
+    const auto after = cache.Match(rules, "h3.cn", "", false, 443, Core::RouteProtocol::Tcp);
+    assert(!after.IsDirect());
+    assert(SameDecision(after, rules.MatchRouting("h3.cn", "", false, 443, Core::RouteProtocol::Tcp)));
+
+    // ===== key 各字段都参与区分 =====
+    const auto p80 = cache.Match(rules, "a.example.com", "", false, 80, Core::RouteProtocol::Tcp);
+    const auto p443 = cache.Match(rules, "a.example.com", "", false, 443, Core::RouteProtocol::Tcp);
+    assert(p80.IsDirect() && !p443.IsDirect());
+
+    // routing 关闭：直接返回默认（不污染缓存）
+    rules.routing.enabled = false;
+    const size_t sizeBefore = cache.Size();
+    const auto off = cache.Match(rules, "h3.cn", "", false, 443, Core::RouteProtocol::Tcp);
+    assert(!off.Matched() && !off.IsDirect());
+    assert(cache.Size() == sizeBefore);
+
+    cache.Clear();
+    assert(cache.Size() == 0);
+    return 0;
+}
@@ -0,0 +1,235 @@
+#include <cassert>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "core/Config.hpp"
+#include "routing_reference.hpp"
+
+static Core::RoutingRule MakeRule(const std::string& name, const std::string& action,
+                                  std::vector<std::string> domains) {
+    Core::RoutingRule r;
+    r.name = name;
+    r.action = action;
+    r.domains = std::move(domains);
+    return r;
+}
+
+static std::string RuleOf(const Core::ProxyRules& rules, const std::string& host, uint16_t port = 443,
+                          const char* proto = "tcp") {
+    std::string action;
+    std::string rule;
+    rules.MatchRouting(host, "", false, port, proto, &action, &rule);
+    return rule;
+}
+
+// 与旧版线性扫描逐条对拍
+static void CrossCheck(const Core::ProxyRules& rules, const std::string& host, const std::string& ip,
+                       bool ipIsV6, uint16_t port, const char* proto) {
+    std::string a1, r1, a2, r2;
+    const bool m1 = rules.MatchRouting(host, ip, ipIsV6, port, proto, &a1, &r1);
+    const bool m2 = ReferenceMatchRouting(rules, host, ip, ipIsV6, port, proto, &a2, &r2);
+    assert(m1 == m2);
+    assert(a1 == a2);
+    assert(r1 == r2);
+}
+
+static uint32_t NextRand(uint32_t* state) {
+    *state = *state * 1664525u + 1013904223u;
+    return *state >> 8;
+}
+
+int main() {
+    // ===== DomainSuffixTrie 基础语义 =====
+    {
+        Core::DomainSuffixTrie trie;
+        assert(trie.Insert("example.com", 0));
+        assert(trie.Insert(".google.com", 1));
+        assert(trie.Insert("*.github.com", 2));
+        assert(!trie.Insert("*google*", 3));   // 中间通配符不可索引
+        assert(!trie.Insert("exa?ple.com", 3));
+        assert(!trie.Insert(".", 3));
+        assert(trie.PatternCount() == 3);
+
+        auto first = [&](const std::string& host) -> int {
+            int hit = -1;
+            trie.Lookup(host, [&](const std::vector<uint32_t>& ranks) {
+                if (hit < 0 || (int)ranks.front() < hit) hit = (int)ranks.front();
+                return true;
+            });
+            return hit;
+        };
+        assert(first("example.com") == 0);
+        assert(first("www.example.com") == -1);
+        assert(first("google.com") == 1);
+        assert(first("mail.google.com") == 1);
+        assert(first("a.b.google.com") == 1);
+        assert(first("notgoogle.com") == -1);
+        assert(first("github.com") == -1);
+        assert(first("api.github.com") == 2);
+        assert(first(".github.com") == 2);
+        assert(first("com") == -1);
+    }
+
+    // ===== MatchRouting：优先级与过滤 =====
+    {
+        Core::ProxyRules rules;
+        rules.routing.use_default_private = false;
+        rules.routing.rules.push_back(MakeRule("cn-direct", "direct", {".cn", "baidu.com"}));
+        rules.routing.rules.push_back(MakeRule("google", "proxy", {".google.com", "*.gstatic.com"}));
+        rules.routing.rules.push_back(MakeRule("glob", "direct", {"*goog*"}));
+        auto web = MakeRule("web-only", "direct", {".example.org"});
+        web.ports = {"80"};
+        rules.routing.rules.push_back(web);
+        auto off = MakeRule("disabled", "direct", {"disabled.test"});
+        off.enabled = false;
+        rules.routing.rules.push_back(off);
+        rules.CompileRoutingRules();
+
+        assert(RuleOf(rules, "www.baidu.com").empty());
+        assert(RuleOf(rules, "BAIDU.COM.") == "cn-direct");
+        assert(RuleOf(rules, "www.gov.cn") == "cn-direct");
+        assert(RuleOf(rules, "google.com") == "google");
+        assert(RuleOf(rules, "fonts.gstatic.com") == "google");
+        assert(RuleOf(rules, "gstatic.com").empty());
+        assert(RuleOf(rules, "googleapis.com") == "glob");
+        assert(RuleOf(rules, "www.example.org", 443).empty());
+        assert(RuleOf(rules, "www.example.org", 80) == "web-only");
+        assert(RuleOf(rules, "disabled.test").empty());
+
+        // number 模式：高 priority 覆盖配置顺序
+        rules.routing.priority_mode = "number";
+        rules.routing.rules[2].priority = 10;
+        rules.CompileRoutingRules();
+        assert(RuleOf(rules, "mail.google.com") == "glob");
+    }
+
+    // ===== 随机对拍：Trie/通配符/CIDR 索引 vs 线性扫描 =====
+    {
+        const char* tlds[] = {"com", "net", "org", "cn", "io"};
+        const char* words[] = {"alpha", "beta", "gamma", "delta", "www", "api", "cdn", "mail", "img", "x"};
+        uint32_t seed = 12345;
+        auto randomHost = [&](int labels) {
+            std::string h;
+            for (int i = 0; i < labels; i++) {
+                h += words[NextRand(&seed) % 10];
+                h += ".";
+            }
+            h += tlds[NextRand(&seed) % 5];
+            return h;
+        };
+
+        Core::ProxyRules rules;
+        rules.routing.priority_mode = "number";
+        for (int i = 0; i < 60; i++) {
+            Core::RoutingRule r;
+            r.name = "r" + std::to_string(i);
+            r.action = (i % 2) ? "direct" : "proxy";
+            r.priority = (int)(NextRand(&seed) % 5);
+            r.enabled = (i % 13) != 0;
+            for (int k = 0; k < 8; k++) {
+                const uint32_t kind = NextRand(&seed) % 5;
+                const std::string base = randomHost(1 + (int)(NextRand(&seed) % 2));
+                if (kind == 0) r.domains.push_back(base);
+                else if (kind == 1) r.domains.push_back("." + base);
+                else if (kind == 2) r.domains.push_back("*." + base);
+                else if (kind == 3) r.domains.push_back("*" + std::string(words[NextRand(&seed) % 10]) + "*");
+                else r.domains.push_back(base.substr(0, 2) + "?" + base.substr(3));
+            }
+            if (i % 7 == 0) r.ports = {"80", "8000-9000"};
+            if (i % 11 == 0) r.protocols = {"udp"};
+            if (i % 5 == 0) r.ip_cidrs_v4 = {std::to_string(NextRand(&seed) % 256) + ".0.0.0/8"};
+            rules.routing.rules.push_back(r);
+        }
+        rules.CompileRoutingRules();
+
+        const uint16_t ports[] = {80, 443, 8080, 0};
+        const char* protos[] = {"tcp", "udp", "TCP"};
+        for (int i = 0; i < 20000; i++) {
+            std::string host = randomHost((int)(NextRand(&seed) % 4));
+            if (NextRand(&seed) % 10 == 0) host = "." + host;
+            if (NextRand(&seed) % 10 == 0) host += ".";
+            std::string ip;
+            if (NextRand(&seed) % 3 == 0) ip = std::to_string(NextRand(&seed) % 256) + ".1.2.3";
+            CrossCheck(rules, host, ip, false, ports[NextRand(&seed) % 4], protos[NextRand(&seed) % 3]);
+        }
+        CrossCheck(rules, "10.1.2.3", "", false, 443, "tcp");
+        CrossCheck(rules, "::1", "", false, 443, "tcp");
+        CrossCheck(rules, "", "fe80::1", true, 443, "tcp");
+    }
+
+    // ===== CIDR 前缀树：默认私网规则 =====
+    {
+        Core::ProxyRules rules;
+        Core::RoutingRule cn;
+        cn.name = "cn-ip";
+        cn.action = "direct";
+        cn.ip_cidrs_v4 = {"1.0.1.0/24", "36.0.0.0/10", "0.0.0.0/0"};
+        cn.ip_cidrs_v6 = {"2400:3200::/32"};
+        cn.protocols = {"udp"};
+        rules.routing.rules.push_back(cn);
+        rules.CompileRoutingRules();
+
+        std::string action, rule;
+        assert(rules.MatchRouting("", "10.1.2.3", false, 443, "tcp", &action, &rule));
+        assert(rule == "default-private" && action == "direct");
+        assert(rules.MatchRouting("192.168.1.1", "", false, 443, "tcp", &action, &rule));
+        assert(rule == "default-private");
+        assert(rules.MatchRouting("::1", "", false, 443, "tcp", &action, &rule));
+        assert(rule == "default-private");
+        assert(!rules.MatchRouting("", "8.8.8.8", false, 443, "tcp", &action, &rule));
+        assert(rules.MatchRouting("", "8.8.8.8", false, 443, "udp", &action, &rule));
+        assert(rule == "cn-ip");
+        assert(rules.MatchRouting("", "2400:3200::1", true, 53, "udp", &action, &rule));
+        assert(rule == "cn-ip");
+        // default-private 仅限 tcp：udp 下私网地址落到 cn-ip 的 /0
+        assert(rules.MatchRouting("", "10.1.2.3", false, 53, "udp", &action, &rule));
+        assert(rule == "cn-ip");
+    }
+
+    // ===== 随机对拍：大规模 CIDR 语料（约 8k v4 + 2k v6 前缀） =====
+    {
+        uint32_t seed = 777;
+        auto randomV4 = [&](int bits) {
+            const uint32_t a = NextRand(&seed) ^ (NextRand(&seed) << 16);
+            return std::to_string(a >> 24) + "." + std::to_string((a >> 16) & 0xFF) + "." +
+                   std::to_string((a >> 8) & 0xFF) + "." + std::to_string(a & 0xFF) + "/" + std::to_string(bits);
+        };
+        auto randomV6 = [&](int bits) {
+            char buf[64];
+            std::snprintf(buf, sizeof(buf), "24%02x:%x:%x::%x/%d", NextRand(&seed) % 4, NextRand(&seed) % 8,
+                          NextRand(&seed) % 0xFFFF, NextRand(&seed) % 0xFFFF, bits);
+            return std::string(buf);
+        };
+
+        Core::ProxyRules rules;
+        rules.routing.priority_mode = "number";
+        for (int i = 0; i < 8; i++) {
+            Core::RoutingRule r;
+            r.name = "ip" + std::to_string(i);
+            r.action = (i % 2) ? "direct" : "proxy";
+            r.priority = (int)(NextRand(&seed) % 3);
+            if (i == 3) r.ports = {"443"};
+            if (i == 5) r.protocols = {"udp"};
+            for (int k = 0; k < 1000; k++) r.ip_cidrs_v4.push_back(randomV4(8 + (int)(NextRand(&seed) % 17)));
+            for (int k = 0; k < 250; k++) r.ip_cidrs_v6.push_back(randomV6(16 + (int)(NextRand(&seed) % 33)));
+            rules.routing.rules.push_back(r);
+        }
+        rules.CompileRoutingRules();
+        assert(rules.compiled_cidr_v4_trie.PrefixCount() == 8000 + 5);
+        assert(rules.compiled_cidr_v6_trie.PrefixCount() == 2000 + 3);
+
+        for (int i = 0; i < 20000; i++) {
+            std::string ip = randomV4(32);
+            ip = ip.substr(0, ip.find('/'));
+            CrossCheck(rules, "", ip, false, (i % 3) ? 443 : 80, (i % 4) ? "tcp" : "udp");
+            std::string ip6 = randomV6(128);
+            ip6 = ip6.substr(0, ip6.find('/'));
+            CrossCheck(rules, "", ip6, true, 443, (i % 4) ? "tcp" : "udp");
+            CrossCheck(rules, ip6, "", false, 443, "tcp");
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,258 @@
+#include <atomic>
+#include <cassert>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#ifndef _WIN32
+#include <csignal>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+#include "core/SharedLogRing.hpp"
+
+namespace {
+    // 按 "p:i" 解析每行，校验同一来源内严格递增且不重复；返回总行数
+    int CheckLines(const std::string& all, int sources, int perSource) {
+        std::vector<int> next(sources, 0);
+        size_t pos = 0;
+        int lines = 0;
+        while (pos < all.size()) {
+            const size_t nl = all.find('\n', pos);
+            assert(nl != std::string::npos);
+            const std::string line = all.substr(pos, nl - pos);
+            const size_t colon = line.find(':');
+            assert(colon != std::string::npos);
+            const int p = std::atoi(line.substr(0, colon).c_str());
+            const int i = std::atoi(line.substr(colon + 1).c_str());
+            assert(p >= 0 && p < sources && i == next[p]);
+            next[p]++;
+            lines++;
+            pos = nl + 1;
+        }
+        for (int p = 0; p < sources; p++) assert(perSource < 0 || next[p] == perSource);
+        return lines;
+    }
+
+#ifndef _WIN32
+    void SleepMs(int ms) { std::this_thread::sleep_for(std::chrono::milliseconds(ms)); }
+#endif
+}
+
+int main() {
+    // ===== 单环：多线程生产 + 并发消费，跨越环尾多圈；满时丢弃并计数 =====
+    {
+        const uint32_t capacity = 4096;
+        std::unique_ptr<uint64_t[]> storage(new uint64_t[Core::SharedLogRing::RequiredBytes(capacity) / 8 + 1]());
+        Core::SharedLogRing producer;
+        Core::SharedLogRing consumer;
+        assert(producer.Attach(storage.get(), Core::SharedLogRing::RequiredBytes(capacity), capacity, 1));
+        assert(consumer.Attach(storage.get(), Core::SharedLogRing::RequiredBytes(capacity), capacity, 1));
+        assert(!consumer.Attach(storage.get(), Core::SharedLogRing::RequiredBytes(capacity), capacity * 2, 1));
+        assert(consumer.Attach(storage.get(), Core::SharedLogRing::RequiredBytes(capacity), capacity, 1));
+
+        // 超长行截断到 MaxPayload
+        const std::string longLine(capacity, 'x');
+        assert(producer.TryWrite(1, longLine.data(), longLine.size()));
+        size_t seenLen = 0;
+        assert(consumer.Drain([&](uint64_t, std::string_view line) { seenLen = line.size(); }) == 1);
+        assert(seenLen == producer.MaxPayload() && consumer.PendingBytes() == 0);
+
+        const int threads = 4;
+        const int perThread = 20000;
+        std::atomic<bool> done{false};
+        std::atomic<int> accepted{0};
+        std::string all;
+        std::thread reader([&]() {
+            for (;;) {
+                const bool finished = done.load();
+                consumer.Drain([&](uint64_t, std::string_view line) {
+                    all.append(line.data(), line.size());
+                    all.push_back('\n');
+                });
+                if (finished && consumer.PendingBytes() == 0) break;
+                std::this_thread::yield();
+            }
+        });
+        std::vector<std::thread> writers;
+        for (int t = 0; t < threads; t++) {
+            writers.emplace_back([&, t]() {
+                // 丢弃的序号不再重发，因此按“已接受条数”编号，保证输出序列连续可校验
+                int sent = 0;
+                for (int i = 0; i < perThread; i++) {
+                    const std::string line = std::to_string(t) + ":" + std::to_string(sent);
+                    if (producer.TryWrite((uint64_t)i, line.data(), line.size())) {
+                        sent++;
+                        accepted.fetch_add(1);
+                    }
+                }
+            });
+        }
+        for (auto& w : writers) w.join();
+        done.store(true);
+        reader.join();
+        assert(!consumer.IsCorrupt());
+        assert(CheckLines(all, threads, -1) == accepted.load());
+        assert(accepted.load() + (int)producer.Dropped() == threads * perThread);
+    }
+
+#ifndef _WIN32
+    // ===== 退出与并发 Push：Stop 等在途写入结束才取空并解除映射，写入成功的行一条不少 =====
+    {
+        const std::string prefix = "Local\\AgpTestLogExit_" + std::to_string(getpid());
+        const int threads = 4;
+        for (int round = 0; round < 20; round++) {
+            std::string all;
+            Core::SharedLogHub hub(prefix, 1u << 16, [&](const std::string& batch, uint64_t) { all += batch; });
+            assert(hub.Start(false));
+            std::atomic<int> accepted{0};
+            std::atomic<int> running{0};
+            std::vector<std::thread> writers;
+            for (int t = 0; t < threads; t++) {
+                writers.emplace_back([&, t]() {
+                    running.fetch_add(1);
+                    // 行号只在写入成功时递增，便于 CheckLines 校验无缺失
+                    for (int k = 0, misses = 0; misses < 1000;) {
+                        if (hub.Push(std::to_string(t) + ":" + std::to_string(k))) {
+                            k++;
+                            accepted.fetch_add(1);
+                        } else {
+                            misses++;
+                        }
+                    }
+                });
+            }
+            while (running.load() < threads) std::this_thread::yield();
+            hub.Stop();
+            for (auto& w : writers) w.join();
+            assert(CheckLines(all, threads, -1) == accepted.load());
+        }
+        Network::SharedMemoryRegion::Remove(prefix + "_Dir");
+    }
+
+    // ===== 多进程：各子进程只写自己的环，父进程当选收集者合并写出 =====
+    {
+        const std::string prefix = "Local\\AgpTestLog_" + std::to_string(getpid());
+        const int children = 4;
+        const int perChild = 5000;
+        std::string all;
+        uint64_t dropped = 0;
+        Core::SharedLogHub hub(prefix, 1u << 20, [&](const std::string& batch, uint64_t d) {
+            all += batch;
+            dropped += d;
+        });
+        assert(hub.Start(false));
+        hub.PumpOnce();
+        assert(hub.IsCollector());
+
+        // 子进程退出时若收集者尚未认领它的环，会自己取空写出：这部分写到旁路文件，最后并入
+        const std::string selfDrained = "antigravity_test_shared_log_" + std::to_string(getpid()) + ".txt";
+        std::remove(selfDrained.c_str());
+        std::vector<pid_t> pids;
+        for (int c = 0; c < children; c++) {
+            const pid_t pid = fork();
+            if (pid == 0) {
+                Core::SharedLogHub child(prefix, 1u << 20, [&](const std::string& batch, uint64_t) {
+                    FILE* f = std::fopen(selfDrained.c_str(), "ab");
+                    if (!f) _exit(3);
+                    std::fwrite(batch.data(), 1, batch.size(), f);
+                    std::fclose(f);
+                });
+                if (!child.Start(true)) _exit(2);
+                if (child.IsCollector()) _exit(4);
+                for (int i = 0; i < perChild; i++) {
+                    if (!child.Push(std::to_string(c) + ":" + std::to_string(i))) _exit(5);
+                }
+                SleepMs(100); // 通常此时父进程已认领本环：退出流程只标记退出，由父进程收尾
+                child.Stop();
+                _exit(0);
+            }
+            pids.push_back(pid);
+        }
+        int exited = 0;
+        std::vector<bool> reaped(children, false);
+        while (exited < children) {
+            hub.PumpOnce();
+            for (int c = 0; c < children; c++) {
+                int status = 0;
+                if (!reaped[c] && waitpid(pids[c], &status, WNOHANG) == pids[c]) {
+                    assert(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+                    reaped[c] = true;
+                    exited++;
+                }
+            }
+            SleepMs(5);
+        }
+        hub.PumpOnce();
+        if (FILE* f = std::fopen(selfDrained.c_str(), "rb")) {
+            char buf[4096];
+            size_t n = 0;
+            while ((n = std::fread(buf, 1, sizeof(buf), f)) > 0) all.append(buf, n);
+            std::fclose(f);
+            std::remove(selfDrained.c_str());
+        }
+        assert(dropped == 0);
+        assert(CheckLines(all, children, perChild) == children * perChild);
+        hub.Stop();
+        assert(!hub.IsCollector());
+        Network::SharedMemoryRegion::Remove(prefix + "_Dir");
+    }
+
+    // ===== 收集者被强制终止：租约过期后由存活进程接替，并接管前任认领的环 =====
+    {
+        const std::string prefix = "Local\\AgpTestLogTakeover_" + std::to_string(getpid());
+        const uint64_t staleMs = 200;
+        int toParent[2];
+        assert(pipe(toParent) == 0);
+
+        const pid_t collector = fork();
+        if (collector == 0) {
+            // 收集者：写到 /dev/null，认领环后一直在任，直到被 SIGKILL
+            Core::SharedLogHub hub(prefix, 1u << 16, [](const std::string&, uint64_t) {}, staleMs);
+            if (!hub.Start(true)) _exit(2);
+            while (!hub.IsCollector()) SleepMs(5);
+            const char ok = 'c';
+            if (write(toParent[1], &ok, 1) != 1) _exit(3);
+            for (;;) SleepMs(100);
+        }
+        char signal = 0;
+        assert(read(toParent[0], &signal, 1) == 1 && signal == 'c');
+
+        std::string all;
+        Core::SharedLogHub hub(prefix, 1u << 16, [&](const std::string& batch, uint64_t) { all += batch; }, staleMs);
+        assert(hub.Start(false));
+        hub.PumpOnce();
+        assert(!hub.IsCollector());
+        for (int i = 0; i < 15; i++) { // 保持心跳，等收集者认领本进程的环
+            SleepMs(20);
+            hub.PumpOnce();
+        }
+
+        kill(collector, SIGKILL);
+        int status = 0;
+        waitpid(collector, &status, 0);
+        // 前任死后写入的日志一直积压在环中，直到接替者出现
+        for (int i = 0; i < 100; i++) assert(hub.Push("0:" + std::to_string(i)));
+        hub.PumpOnce();
+        assert(!hub.IsCollector() && all.empty());
+        for (int i = 0; i < 100 && !hub.IsCollector(); i++) {
+            SleepMs(20);
+            hub.PumpOnce();
+        }
+        assert(hub.IsCollector());
+        assert(CheckLines(all, 1, 100) == 100);
+
+        hub.Stop();
+        close(toParent[0]);
+        close(toParent[1]);
+        Network::SharedMemoryRegion::Remove(prefix + "_Ring_" + std::to_string(collector));
+        Network::SharedMemoryRegion::Remove(prefix + "_Dir");
+    }
+#endif
+    return 0;
+}
@@ -0,0 +1,121 @@
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "core/SingleFlight.hpp"
+
+namespace {
+    using Flight = Core::SingleFlight<int>;
+
+    void SleepMs(int ms) { std::this_thread::sleep_for(std::chrono::milliseconds(ms)); }
+
+    // 等到 key 挂起 n 个 waiter（单核环境下线程调度不确定，轮询而不是固定 sleep）
+    void WaitForWaiters(Flight& flight, const std::string& key, size_t n) {
+        while (flight.Waiters(key) < n) SleepMs(1);
+    }
+
+    // 启动一个被 gate 阻塞的 leader，返回时 key 已在途
+    std::thread StartLeader(Flight& flight, const std::string& key, std::atomic<bool>& gate, std::atomic<int>& calls,
+                            int value) {
+        std::thread leader([&flight, key, &gate, &calls, value]() {
+            int out = 0;
+            const Flight::Status st = flight.Do(key, [&]() {
+                calls.fetch_add(1);
+                while (!gate.load()) SleepMs(1);
+                return value;
+            }, 0, &out);
+            assert(st == Flight::Status::Leader && out == value);
+        });
+        while (flight.InFlight() == 0) SleepMs(1);
+        return leader;
+    }
+}
+
+int main() {
+    // ===== 合并：并发调用同一 key 只执行一次，所有 waiter 拿到同一结果 =====
+    {
+        Flight flight;
+        std::atomic<bool> gate{false};
+        std::atomic<int> calls{0};
+        std::thread leader = StartLeader(flight, "a.com", gate, calls, 42);
+
+        const int waiters = 16;
+        std::atomic<int> shared{0};
+        std::vector<std::thread> threads;
+        for (int i = 0; i < waiters; i++) {
+            threads.emplace_back([&]() {
+                int out = 0;
+                const Flight::Status st = flight.Do("a.com", [&]() { calls.fetch_add(1); return -1; }, 10000, &out);
+                if (st == Flight::Status::Shared && out == 42) shared.fetch_add(1);
+            });
+        }
+        WaitForWaiters(flight, "a.com", waiters);
+        gate.store(true);
+        leader.join();
+        for (auto& t : threads) t.join();
+        assert(calls.load() == 1 && shared.load() == waiters);
+        assert(flight.InFlight() == 0);
+        const Flight::Stats stats = flight.GetStats();
+        assert(stats.leaders == 1 && stats.shared == (uint64_t)waiters);
+
+        // 不同 key 互不合并；完成后的同名调用重新执行
+        int out = 0;
+        assert(flight.Do("b.com", []() { return 7; }, 100, &out) == Flight::Status::Leader && out == 7);
+        assert(flight.Do("a.com", []() { return 8; }, 100, &out) == Flight::Status::Leader && out == 8);
+    }
+
+    // ===== 有界等待：leader 迟迟不返回时 waiter 超时 =====
+    {
+        Flight flight;
+        std::atomic<bool> gate{false};
+        std::atomic<int> calls{0};
+        std::thread leader = StartLeader(flight, "slow.com", gate, calls, 1);
+        int out = -1;
+        const auto t0 = std::chrono::steady_clock::now();
+        assert(flight.Do("slow.com", []() { return 2; }, 30, &out) == Flight::Status::TimedOut);
+        assert(std::chrono::steady_clock::now() - t0 >= std::chrono::milliseconds(30));
+        assert(out == -1 && flight.GetStats().timeouts == 1);
+        gate.store(true);
+        leader.join();
+    }
+
+    // ===== 取消：Cancel 唤醒 waiter，之后的调用方重新发起；cancelToken 单独取消一个 waiter =====
+    {
+        Flight flight;
+        std::atomic<bool> gate{false};
+        std::atomic<int> calls{0};
+        std::thread leader = StartLeader(flight, "c.com", gate, calls, 3);
+
+        std::atomic<int> cancelled{0};
+        std::atomic<bool> token{false};
+        std::vector<std::thread> threads;
+        for (int i = 0; i < 3; i++) {
+            threads.emplace_back([&, i]() {
+                int out = 0;
+                const Flight::Status st =
+                    flight.Do("c.com", []() { return -1; }, 10000, &out, i == 0 ? &token : nullptr);
+                if (st == Flight::Status::Cancelled) cancelled.fetch_add(1);
+            });
+        }
+        WaitForWaiters(flight, "c.com", 3);
+        token.store(true);
+        while (cancelled.load() < 1) SleepMs(1);
+        assert(flight.Waiters("c.com") == 2);
+        assert(flight.Cancel("c.com") == 2);
+        for (auto& t : threads) t.join();
+        assert(cancelled.load() == 3);
+        assert(flight.InFlight() == 0);
+
+        // 原 leader 仍在执行，新调用方不再等它
+        int out = 0;
+        assert(flight.Do("c.com", []() { return 9; }, 100, &out) == Flight::Status::Leader && out == 9);
+        gate.store(true);
+        leader.join();
+        assert(flight.InFlight() == 0 && flight.GetStats().cancels == 3);
+        assert(flight.CancelAll() == 0);
+    }
+    return 0;
+}
@@ -0,0 +1,131 @@
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "network/SocketStateTable.hpp"
+
+namespace {
+    // 与 Hooks 中的 SocketState 同构：目标 + 可选的 UDP 上下文 + 类型缓存
+    struct State {
+        std::string host;
+        uint16_t port = 0;
+        std::unique_ptr<int> udp;
+        int soType = 0;
+
+        bool Empty() const { return host.empty() && !udp && soType == 0; }
+    };
+
+    using Table = Network::SocketStateTable<uintptr_t, State>;
+}
+
+int main() {
+    // ===== 基本操作：Upsert / Visit / Update / Take / Erase =====
+    {
+        auto table = std::make_unique<Table>();
+        assert(!table->Visit(4, [](State&) { assert(false); }));
+        table->Upsert(4, [](State& st) {
+            st.host = "example.com";
+            st.port = 443;
+        });
+        table->Upsert(4, [](State& st) { st.soType = 1; }); // 已存在：不重建，字段保留
+        std::string host;
+        assert(table->Visit(4, [&](State& st) { host = st.host + ":" + std::to_string(st.port); }));
+        assert(host == "example.com:443");
+        assert(table->Size() == 1);
+
+        // Update 返回 false 时删除条目
+        table->Upsert(8, [](State& st) { st.udp.reset(new int(7)); });
+        assert(table->Update(8, [](State& st) {
+            st.udp.reset();
+            return !st.Empty();
+        }));
+        assert(!table->Visit(8, [](State&) {}));
+        assert(!table->Update(8, [](State&) { return true; }));
+
+        // Update 返回 true 时保留
+        assert(table->Update(4, [](State& st) {
+            st.soType = 2;
+            return !st.Empty();
+        }));
+
+        State taken;
+        assert(table->Take(4, &taken) && taken.host == "example.com" && taken.soType == 2);
+        assert(!table->Take(4, &taken));
+        assert(table->Size() == 0);
+
+        table->Upsert(12, [](State& st) { st.soType = 2; });
+        assert(table->Erase(12) && !table->Erase(12));
+    }
+
+    // ===== EraseIf / TakeAll：跨分片扫描 =====
+    {
+        auto table = std::make_unique<Table>();
+        for (uintptr_t s = 4; s <= 4000; s += 4) {
+            table->Upsert(s, [s](State& st) { st.soType = (s % 8 == 0) ? 2 : 1; });
+        }
+        assert(table->Size() == 1000);
+        const size_t erased = table->EraseIf([](uintptr_t, State& st) { return st.soType == 2; });
+        assert(erased == 500 && table->Size() == 500);
+        auto all = table->TakeAll();
+        assert(all.size() == 500 && table->Size() == 0);
+        for (auto& kv : all) assert(kv.first % 8 == 4 && kv.second.soType == 1);
+    }
+
+    // ===== 分片散列：SOCKET（4 的倍数）与对齐指针都应铺满全部分片 =====
+    {
+        std::vector<size_t> socketHits(Table::kShardCount, 0);
+        std::vector<size_t> pointerHits(Table::kShardCount, 0);
+        const size_t n = 64 * 1024;
+        for (size_t i = 0; i < n; i++) {
+            socketHits[Table::ShardIndex((uintptr_t)(0x100 + i * 4))]++;
+            pointerHits[Table::ShardIndex((uintptr_t)(0x7ff000000000ull + i * 64))]++;
+        }
+        const size_t expected = n / Table::kShardCount;
+        for (size_t i = 0; i < Table::kShardCount; i++) {
+            assert(socketHits[i] > expected / 2 && socketHits[i] < expected * 2);
+            assert(pointerHits[i] > expected / 2 && pointerHits[i] < expected * 2);
+        }
+    }
+
+    // ===== 并发：多线程各自 churn 一段 key，同时有线程访问全部 key =====
+    {
+        auto table = std::make_unique<Table>();
+        const int threads = 4;
+        const uintptr_t perThread = 2000;
+        std::vector<std::thread> workers;
+        for (int t = 0; t < threads; t++) {
+            workers.emplace_back([&, t]() {
+                const uintptr_t base = (uintptr_t)t * perThread * 4;
+                for (int round = 0; round < 20; round++) {
+                    for (uintptr_t i = 0; i < perThread; i++) {
+                        const uintptr_t key = base + i * 4;
+                        table->Upsert(key, [&](State& st) {
+                            st.port = (uint16_t)round;
+                            st.udp.reset(new int((int)key));
+                        });
+                    }
+                    for (uintptr_t i = 0; i < perThread; i += 2) table->Erase(base + i * 4);
+                }
+            });
+        }
+        std::thread reader([&]() {
+            for (int round = 0; round < 20; round++) {
+                for (uintptr_t key = 0; key < threads * perThread * 4; key += 4) {
+                    table->Visit(key, [&](State& st) { assert(st.udp && *st.udp == (int)key); });
+                }
+            }
+        });
+        for (auto& w : workers) w.join();
+        reader.join();
+        // 每个线程最后一轮留下奇数下标的 key
+        assert(table->Size() == threads * perThread / 2);
+        for (uintptr_t key = 4; key < threads * perThread * 4; key += 8) {
+            assert(table->Visit(key, [](State& st) { assert(st.port == 19); }));
+        }
+    }
+    return 0;
+}
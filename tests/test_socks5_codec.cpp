@@ -0,0 +1,137 @@
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+#include "network/Socks5Codec.hpp"
+
+namespace S5 = Network::Socks5;
+
+int main() {
+    uint8_t buf[S5::kGreetingBytes + S5::kMaxRequestBytes];
+
+    // ===== 编码 =====
+    {
+        assert(S5::EncodeGreeting(buf, 2) == 0);
+        assert(S5::EncodeGreeting(buf, sizeof(buf)) == 3);
+        assert(buf[0] == 0x05 && buf[1] == 0x01 && buf[2] == 0x00);
+
+        uint8_t atyp = 0;
+        size_t n = S5::EncodeRequest(S5::CMD_CONNECT, "1.2.3.4", 443, buf, sizeof(buf), &atyp);
+        const uint8_t v4[] = {0x05, 0x01, 0x00, 0x01, 1, 2, 3, 4, 0x01, 0xBB};
+        assert(n == sizeof(v4) && std::memcmp(buf, v4, n) == 0 && atyp == S5::ATYP_IPV4);
+
+        n = S5::EncodeRequest(S5::CMD_UDP_ASSOCIATE, "::1", 53, buf, sizeof(buf), &atyp);
+        assert(n == 22 && buf[1] == S5::CMD_UDP_ASSOCIATE && atyp == S5::ATYP_IPV6);
+        assert(buf[19] == 1 && buf[20] == 0 && buf[21] == 53);
+
+        n = S5::EncodeRequest(S5::CMD_CONNECT, "example.com", 80, buf, sizeof(buf), &atyp);
+        assert(n == 4 + 1 + 11 + 2 && atyp == S5::ATYP_DOMAIN && buf[4] == 11);
+        assert(std::memcmp(buf + 5, "example.com", 11) == 0 && buf[16] == 0 && buf[17] == 80);
+
+        // 空主机、超长域名、缓冲区不足
+        assert(S5::EncodeRequest(S5::CMD_CONNECT, "", 80, buf, sizeof(buf)) == 0);
+        assert(S5::EncodeRequest(S5::CMD_CONNECT, std::string(256, 'a'), 80, buf, sizeof(buf)) == 0);
+        assert(S5::EncodeRequest(S5::CMD_CONNECT, std::string(255, 'a'), 80, buf, sizeof(buf)) == S5::kMaxRequestBytes);
+        assert(S5::EncodeRequest(S5::CMD_CONNECT, "example.com", 80, buf, 17) == 0);
+    }
+
+    // ===== 认证响应 =====
+    {
+        const uint8_t ok[] = {0x05, 0x00};
+        uint8_t method = 0xAA;
+        assert(S5::DecodeMethodReply(ok, 1, &method) == S5::DecodeStatus::NeedMore && method == 0xAA);
+        assert(S5::DecodeMethodReply(ok, 2, &method) == S5::DecodeStatus::Done && method == S5::AUTH_NONE);
+        const uint8_t bad[] = {0x04, 0x00};
+        assert(S5::DecodeMethodReply(bad, 2, &method) == S5::DecodeStatus::Invalid);
+    }
+
+    // ===== CONNECT 响应：逐字节喂入，need 不超过实际长度 =====
+    {
+        const uint8_t v4[] = {0x05, 0x00, 0x00, 0x01, 10, 0, 0, 1, 0x1F, 0x90, 0xEE /* 隧道数据 */};
+        S5::Reply r;
+        size_t need = 0;
+        for (size_t len = 0; len < 10; len++) {
+            assert(S5::DecodeReply(v4, len, &r, &need) == S5::DecodeStatus::NeedMore);
+            assert(need > len && need <= 10);
+        }
+        assert(S5::DecodeReply(v4, sizeof(v4), &r, &need) == S5::DecodeStatus::Done);
+        assert(r.length == 10 && r.rep == 0 && r.atyp == S5::ATYP_IPV4 && r.bndPort == 8080);
+        assert(r.bndAddrLen == 4 && r.bndAddr == v4 + 4);
+
+        const uint8_t dom[] = {0x05, 0x05, 0x00, 0x03, 3, 'a', 'b', 'c', 0x00, 0x50};
+        for (size_t len = 0; len < sizeof(dom); len++) {
+            assert(S5::DecodeReply(dom, len, &r, &need) == S5::DecodeStatus::NeedMore && need <= sizeof(dom));
+        }
+        assert(S5::DecodeReply(dom, sizeof(dom), &r, &need) == S5::DecodeStatus::Done);
+        assert(r.rep == 0x05 && r.length == sizeof(dom) && r.bndAddrLen == 3 && r.bndAddr == dom + 5 && r.bndPort == 80);
+
+        uint8_t v6[4 + 16 + 2] = {0x05, 0x00, 0x00, 0x04};
+        assert(S5::DecodeReply(v6, 4, &r, &need) == S5::DecodeStatus::NeedMore && need == sizeof(v6));
+        assert(S5::DecodeReply(v6, sizeof(v6), &r, &need) == S5::DecodeStatus::Done && r.bndAddrLen == 16);
+
+        const uint8_t badVer[] = {0x04, 0x00, 0x00, 0x01};
+        const uint8_t badAtyp[] = {0x05, 0x00, 0x00, 0x09};
+        assert(S5::DecodeReply(badVer, sizeof(badVer), &r, &need) == S5::DecodeStatus::Invalid);
+        assert(S5::DecodeReply(badAtyp, sizeof(badAtyp), &r, &need) == S5::DecodeStatus::Invalid);
+    }
+
+    // ===== UDP ASSOCIATE：按 sockaddr 编码，空地址为 0.0.0.0:0 =====
+    {
+        size_t n = S5::EncodeRequest(S5::CMD_UDP_ASSOCIATE, nullptr, 0, buf, sizeof(buf));
+        const uint8_t zero[] = {0x05, 0x03, 0x00, 0x01, 0, 0, 0, 0, 0, 0};
+        assert(n == sizeof(zero) && std::memcmp(buf, zero, n) == 0);
+
+        sockaddr_in a4{};
+        a4.sin_family = AF_INET;
+        a4.sin_port = htons(5353);
+        inet_pton(AF_INET, "192.168.1.2", &a4.sin_addr);
+        n = S5::EncodeRequest(S5::CMD_UDP_ASSOCIATE, (const sockaddr*)&a4, (int)sizeof(a4), buf, sizeof(buf));
+        const uint8_t v4[] = {0x05, 0x03, 0x00, 0x01, 192, 168, 1, 2, 0x14, 0xE9};
+        assert(n == sizeof(v4) && std::memcmp(buf, v4, n) == 0);
+
+        sockaddr_in6 a6{};
+        a6.sin6_family = AF_INET6;
+        a6.sin6_port = htons(443);
+        inet_pton(AF_INET6, "2001:db8::1", &a6.sin6_addr);
+        n = S5::EncodeRequest(S5::CMD_UDP_ASSOCIATE, (const sockaddr*)&a6, (int)sizeof(a6), buf, sizeof(buf));
+        assert(n == 22 && buf[3] == S5::ATYP_IPV6 && buf[4] == 0x20 && buf[21] == 0xBB);
+        // 长度不足按空地址处理
+        assert(S5::EncodeRequest(S5::CMD_UDP_ASSOCIATE, (const sockaddr*)&a6, 8, buf, sizeof(buf)) == 10);
+    }
+
+    // ===== UDP 头：编码后解码得到原地址，payload 紧随其后 =====
+    {
+        uint8_t pkt[S5::kMaxUdpHeaderBytes + 8];
+        size_t n = S5::EncodeUdpHeader("8.8.4.4", 53, pkt, sizeof(pkt));
+        const uint8_t v4[] = {0, 0, 0, 0x01, 8, 8, 4, 4, 0, 53};
+        assert(n == sizeof(v4) && std::memcmp(pkt, v4, n) == 0);
+        std::memcpy(pkt + n, "DATA", 4);
+        S5::UdpHeader h;
+        assert(S5::DecodeUdpHeader(pkt, n + 4, &h) == S5::DecodeStatus::Done);
+        assert(h.length == n && h.atyp == S5::ATYP_IPV4 && h.port == 53 && h.addr == pkt + 4 && h.addrLen == 4);
+        for (size_t len = 0; len < n; len++) {
+            assert(S5::DecodeUdpHeader(pkt, len, &h) == S5::DecodeStatus::NeedMore);
+        }
+
+        n = S5::EncodeUdpHeader("quic.example", 443, pkt, sizeof(pkt));
+        assert(n == 3 + 1 + 1 + 12 + 2);
+        assert(S5::DecodeUdpHeader(pkt, n, &h) == S5::DecodeStatus::Done);
+        assert(h.atyp == S5::ATYP_DOMAIN && h.addrLen == 12 && std::memcmp(h.addr, "quic.example", 12) == 0);
+        assert(h.port == 443 && h.length == n);
+
+        assert(S5::EncodeUdpHeader(std::string(255, 'q'), 1, pkt, sizeof(pkt)) == S5::kMaxUdpHeaderBytes);
+        assert(S5::EncodeUdpHeader(std::string(256, 'q'), 1, pkt, sizeof(pkt)) == 0);
+        assert(S5::EncodeUdpHeader("::1", 1, pkt, 21) == 0);
+        assert(S5::EncodeUdpHeader("::1", 1, pkt, 22) == 22);
+
+        // RSV / FRAG 非 0、未知 ATYP
+        const uint8_t frag[] = {0, 0, 1, 0x01, 1, 2, 3, 4, 0, 53};
+        const uint8_t rsv[] = {0, 1, 0, 0x01, 1, 2, 3, 4, 0, 53};
+        const uint8_t atyp[] = {0, 0, 0, 0x07, 1, 2, 3, 4, 0, 53};
+        assert(S5::DecodeUdpHeader(frag, sizeof(frag), &h) == S5::DecodeStatus::Invalid);
+        assert(S5::DecodeUdpHeader(rsv, sizeof(rsv), &h) == S5::DecodeStatus::Invalid);
+        assert(S5::DecodeUdpHeader(atyp, sizeof(atyp), &h) == S5::DecodeStatus::Invalid);
+    }
+    return 0;
+}
@@ -0,0 +1,136 @@
+#include <cassert>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "network/UdpRecvBuffer.hpp"
+
+namespace {
+    namespace S5 = Network::Socks5;
+    using Network::UdpRecv::kTailBytes;
+    using Network::UdpRecv::Source;
+    using Network::UdpRecv::UnwrapStatus;
+
+    std::vector<uint8_t> Datagram(const std::string& host, uint16_t port, size_t payloadLen) {
+        std::vector<uint8_t> d(S5::kMaxUdpHeaderBytes + payloadLen);
+        const size_t n = S5::EncodeUdpHeader(host, port, d.data(), d.size());
+        assert(n > 0);
+        for (size_t i = 0; i < payloadLen; i++) d[n + i] = (uint8_t)(i * 7 + 1);
+        d.resize(n + payloadLen);
+        return d;
+    }
+
+    // 模拟 [buf(bufLen), tail] 分散接收：返回实际写入的字节数
+    size_t Scatter(const std::vector<uint8_t>& d, uint8_t* buf, size_t bufLen, uint8_t* tail) {
+        const size_t inBuf = std::min(d.size(), bufLen);
+        std::memcpy(buf, d.data(), inBuf);
+        const size_t inTail = std::min(d.size() - inBuf, kTailBytes);
+        std::memcpy(tail, d.data() + inBuf, inTail);
+        return inBuf + inTail;
+    }
+
+    bool PayloadOk(const uint8_t* p, size_t n) {
+        for (size_t i = 0; i < n; i++) {
+            if (p[i] != (uint8_t)(i * 7 + 1)) return false;
+        }
+        return true;
+    }
+}
+
+int main() {
+    // ===== 原地解封装：IPv4 / IPv6 / 域名，payload 只在 buf、跨入 tail、超出 buf =====
+    const std::string hosts[] = {"203.0.113.7", "2001:db8::1", "quic.example.com", std::string(255, 'a')};
+    for (const std::string& host : hosts) {
+        for (size_t bufLen : {kTailBytes, (size_t)1200, (size_t)1500}) {
+            for (size_t payloadLen : {(size_t)0, (size_t)1, (size_t)100, bufLen - 10, bufLen, bufLen + 1}) {
+                const std::vector<uint8_t> d = Datagram(host, 443, payloadLen);
+                const size_t headerLen = d.size() - payloadLen;
+                if (d.size() > bufLen + kTailBytes) continue; // 系统层面即 WSAEMSGSIZE，不会走到解封装
+                std::vector<uint8_t> buf(bufLen);
+                uint8_t tail[kTailBytes];
+                const size_t received = Scatter(d, buf.data(), bufLen, tail);
+                Source src;
+                size_t got = 0;
+                const UnwrapStatus st = Network::UdpRecv::UnwrapInPlace(buf.data(), bufLen, tail, received, &src, &got);
+                if (payloadLen > bufLen) {
+                    assert(st == UnwrapStatus::Truncated && got == bufLen);
+                } else {
+                    assert(st == UnwrapStatus::Ok && got == payloadLen);
+                }
+                assert(PayloadOk(buf.data(), got));
+                assert(src.port == 443);
+                if (host == hosts[0]) {
+                    assert(src.atyp == S5::ATYP_IPV4 && src.addrLen == 4 && src.addr[0] == 203 && src.addr[3] == 7);
+                } else if (host == hosts[1]) {
+                    assert(src.atyp == S5::ATYP_IPV6 && src.addrLen == 16 && src.addr[0] == 0x20 && src.addr[15] == 1);
+                } else {
+                    assert(src.atyp == S5::ATYP_DOMAIN && src.addrLen == 0);
+                }
+                (void)headerLen;
+            }
+        }
+    }
+
+    // ===== 非法输入：FRAG 非 0 / 截断头 / buf 小于 kTailBytes / tail 超长 =====
+    {
+        std::vector<uint8_t> d = Datagram("10.0.0.1", 53, 32);
+        std::vector<uint8_t> buf(512);
+        uint8_t tail[kTailBytes];
+        size_t got = 99;
+        d[2] = 1; // FRAG
+        size_t received = Scatter(d, buf.data(), buf.size(), tail);
+        assert(Network::UdpRecv::UnwrapInPlace(buf.data(), buf.size(), tail, received, nullptr, &got) ==
+               UnwrapStatus::Invalid && got == 0);
+
+        d = Datagram("10.0.0.1", 53, 0);
+        received = Scatter(d, buf.data(), buf.size(), tail);
+        assert(Network::UdpRecv::UnwrapInPlace(buf.data(), buf.size(), tail, received - 1, nullptr, &got) ==
+               UnwrapStatus::Invalid);
+        assert(Network::UdpRecv::UnwrapInPlace(buf.data(), kTailBytes - 1, tail, received, nullptr, &got) ==
+               UnwrapStatus::Invalid);
+        assert(Network::UdpRecv::UnwrapInPlace(buf.data(), buf.size(), tail, buf.size() + kTailBytes + 1, nullptr,
+                                               &got) == UnwrapStatus::Invalid);
+
+        // 空数据报之外，恰好只有头：payload 为 0
+        assert(Network::UdpRecv::UnwrapInPlace(buf.data(), buf.size(), tail, received, nullptr, &got) ==
+               UnwrapStatus::Ok && got == 0);
+    }
+
+    // ===== 线程局部缓冲：只增不减，不同线程互不相同 =====
+    {
+        uint8_t* a = Network::UdpRecv::ThreadScratch(100);
+        uint8_t* b = Network::UdpRecv::ThreadScratch(50);
+        assert(a == b);
+        a[99] = 0x5A;
+        uint8_t* other = nullptr;
+        std::thread t([&]() { other = Network::UdpRecv::ThreadScratch(100); });
+        t.join();
+        assert(other != a);
+        assert(Network::UdpRecv::ThreadScratch(4096) != nullptr);
+    }
+
+    // ===== overlapped 缓冲池：归还后复用同一块内存，超大缓冲不入池 =====
+    {
+        auto& pool = Network::UdpRecv::RecvBufferPool::Instance();
+        const size_t before = pool.FreeCount();
+        std::vector<uint8_t> a = pool.Acquire(1500);
+        assert(a.size() == 1500);
+        const uint8_t* p = a.data();
+        pool.Release(std::move(a));
+        assert(pool.FreeCount() == before + 1);
+        std::vector<uint8_t> b = pool.Acquire(1200);
+        assert(b.data() == p && b.size() == 1200);
+        pool.Release(std::move(b));
+
+        std::vector<uint8_t> big(Network::UdpRecv::RecvBufferPool::kMaxKeepBytes + 1);
+        pool.Release(std::move(big));
+        assert(pool.FreeCount() == before + 1);
+
+        std::vector<std::vector<uint8_t>> many;
+        for (size_t i = 0; i < Network::UdpRecv::RecvBufferPool::kMaxFree + 8; i++) many.push_back(pool.Acquire(64));
+        for (auto& v : many) pool.Release(std::move(v));
+        assert(pool.FreeCount() == Network::UdpRecv::RecvBufferPool::kMaxFree);
+    }
+    return 0;
+}
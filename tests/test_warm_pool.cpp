@@ -0,0 +1,176 @@
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <vector>
+
+#include "network/WarmPool.hpp"
+
+namespace {
+    // 假连接后端：句柄为递增整数，记录关闭与失效的句柄
+    struct FakeBackend {
+        std::mutex mtx;
+        int next = 1;
+        bool failing = false;
+        std::set<int> open;
+        std::set<int> dead;
+        std::atomic<int> dials{0};
+
+        bool Dial(int* out) {
+            dials.fetch_add(1);
+            std::lock_guard<std::mutex> lock(mtx);
+            if (failing) return false;
+            *out = next++;
+            open.insert(*out);
+            return true;
+        }
+
+        void Close(int h) {
+            std::lock_guard<std::mutex> lock(mtx);
+            assert(open.erase(h) == 1);
+        }
+
+        bool Alive(int h) {
+            std::lock_guard<std::mutex> lock(mtx);
+            return dead.count(h) == 0;
+        }
+
+        size_t OpenCount() {
+            std::lock_guard<std::mutex> lock(mtx);
+            return open.size();
+        }
+    };
+
+    using Pool = Network::WarmPool<int>;
+
+    Pool::Options Opts(size_t maxIdle, uint32_t ttlMs) {
+        Pool::Options o;
+        o.maxIdle = maxIdle;
+        o.ttlMs = ttlMs;
+        o.refillIntervalMs = 10;
+        return o;
+    }
+}
+
+int main() {
+    FakeBackend backend;
+    uint64_t now = 1000;
+    Pool pool([&](int* out) { return backend.Dial(out); }, [&](int h) { backend.Close(h); },
+              [&](int h) { return backend.Alive(h); }, [&]() { return now; });
+
+    // ===== 补足到 maxIdle；后进先出 =====
+    {
+        pool.Configure(Opts(3, 5000));
+        assert(pool.PumpRefill() == 3 && pool.Idle() == 3);
+        assert(pool.PumpRefill() == 0);
+        int h = 0;
+        assert(pool.Acquire(&h) && h == 3);
+        assert(pool.Acquire(&h) && h == 2);
+        backend.Close(3);
+        backend.Close(2);
+        assert(pool.PumpRefill() == 2 && pool.Idle() == 3);
+        assert(pool.GetStats().hits == 2 && pool.GetStats().dialed == 5);
+    }
+
+    // ===== TTL：过期连接在补充或取用时关闭，不会交给调用方 =====
+    {
+        now += 5000;
+        assert(pool.PumpRefill() == 3);
+        assert(pool.GetStats().expired == 3 && backend.OpenCount() == 3);
+
+        now += 4999;
+        int h = 0;
+        assert(pool.Acquire(&h) && h == 8);
+        backend.Close(h);
+        now += 1;
+        assert(!pool.Acquire(&h));
+        assert(pool.GetStats().expired == 5 && pool.GetStats().misses == 1 && backend.OpenCount() == 0);
+    }
+
+    // ===== 存活检查：对端已断开的连接被丢弃，取下一条 =====
+    {
+        assert(pool.PumpRefill() == 3);
+        {
+            std::lock_guard<std::mutex> lock(backend.mtx);
+            backend.dead.insert(11);
+        }
+        int h = 0;
+        assert(pool.Acquire(&h) && h == 10);
+        backend.Close(h);
+        assert(pool.GetStats().dead == 1 && pool.Idle() == 1);
+    }
+
+    // ===== 存活检查在锁外执行：检查期间其他线程仍可访问池 =====
+    {
+        FakeBackend slow;
+        std::atomic<bool> checking{false};
+        std::atomic<bool> queried{false};
+        std::atomic<bool> queriedDuringCheck{false};
+        Pool p([&](int* out) { return slow.Dial(out); }, [&](int h) { slow.Close(h); },
+               [&](int h) {
+                   checking.store(true);
+                   // 检查若仍在池锁内，另一线程的 Idle() 拿不到锁，这里只能等到超时
+                   const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(2);
+                   while (!queried.load() && std::chrono::steady_clock::now() < deadline) std::this_thread::yield();
+                   queriedDuringCheck.store(queried.load());
+                   return slow.Alive(h);
+               },
+               [&]() { return now; });
+        p.Configure(Opts(2, 5000));
+        assert(p.PumpRefill() == 2);
+        std::thread other([&]() {
+            while (!checking.load()) std::this_thread::yield();
+            (void)p.Idle();
+            queried.store(true);
+        });
+        int h = 0;
+        assert(p.Acquire(&h) && h == 2);
+        other.join();
+        assert(queriedDuringCheck.load());
+        slow.Close(h);
+    }
+
+    // ===== dial 失败：本轮停止补充 =====
+    {
+        backend.failing = true;
+        const int before = backend.dials.load();
+        assert(pool.PumpRefill() == 0);
+        assert(backend.dials.load() == before + 1 && pool.GetStats().dialFailures == 1);
+        backend.failing = false;
+    }
+
+    // ===== 缩小 maxIdle 关闭多余连接；maxIdle=0 即禁用 =====
+    {
+        assert(pool.PumpRefill() == 2 && pool.Idle() == 3);
+        pool.Configure(Opts(1, 5000));
+        assert(pool.Idle() == 1 && backend.OpenCount() == 1);
+        pool.Configure(Opts(0, 5000));
+        int h = 0;
+        assert(!pool.Acquire(&h) && pool.Idle() == 0 && backend.OpenCount() == 0);
+        assert(pool.PumpRefill() == 0);
+    }
+
+    // ===== 后台补充：启动即补足，取走后立即补回；Stop 后 Drain 关闭全部 =====
+    {
+        FakeBackend bg;
+        Pool live([&](int* out) { return bg.Dial(out); }, [&](int h) { bg.Close(h); });
+        live.Configure(Opts(2, 60000));
+        live.StartRefiller();
+        live.StartRefiller();
+        const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+        while (live.Idle() < 2 && std::chrono::steady_clock::now() < deadline) std::this_thread::yield();
+        assert(live.Idle() == 2);
+        int h = 0;
+        assert(live.Acquire(&h));
+        bg.Close(h);
+        while (live.GetStats().dialed < 3 && std::chrono::steady_clock::now() < deadline) std::this_thread::yield();
+        assert(live.GetStats().dialed == 3);
+        live.Stop();
+        live.Drain();
+        assert(bg.OpenCount() == 0);
+    }
+    return 0;
+}
@@ -0,0 +1,70 @@
+// 二进制调试日志（.blog）解码工具：把 log_binary 写出的文件还原为与文本日志一致的行格式
+// 用法：antigravity_blog_decode <proxy-YYYYMMDD-PID.blog>...
+// 输出：[时间] [PID:x][TID:y] [调试] 文本 (文件:行号)；文件尾部截断（进程被强制结束）时提示后退出码为 2
+#include <cstdint>
+#include <cstdio>
+#include <ctime>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include "core/BinaryLog.hpp"
+
+namespace {
+    const char* LevelName(int level) {
+        switch (level) {
+        case 0: return "调试";
+        case 1: return "信息";
+        case 2: return "警告";
+        case 3: return "错误";
+        default: return "统计";
+        }
+    }
+
+    std::string FormatWallTime(int64_t wallNs) {
+        const time_t seconds = static_cast<time_t>(wallNs / 1000000000);
+        const int millis = static_cast<int>((wallNs / 1000000) % 1000);
+        struct tm tm;
+#ifdef _WIN32
+        localtime_s(&tm, &seconds);
+#else
+        localtime_r(&seconds, &tm);
+#endif
+        char buf[80];
+        std::snprintf(buf, sizeof(buf), "%04d-%02d-%02d %02d:%02d:%02d.%03d",
+                      tm.tm_year + 1900, tm.tm_mon + 1, tm.tm_mday, tm.tm_hour, tm.tm_min, tm.tm_sec, millis);
+        return buf;
+    }
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        std::fprintf(stderr, "用法: %s <file.blog>...\n", argv[0]);
+        return 1;
+    }
+    int rc = 0;
+    for (int i = 1; i < argc; i++) {
+        std::ifstream in(argv[i], std::ios::binary);
+        if (!in) {
+            std::fprintf(stderr, "无法打开: %s\n", argv[i]);
+            rc = 1;
+            continue;
+        }
+        const std::vector<uint8_t> data((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+        const bool ok = Core::BinaryLog::Decode(data.data(), data.size(), [](const Core::BinaryLog::DecodedRecord& r) {
+            if (r.level < 0) {
+                std::printf("[%s] [PID:%u][TID:%u] [%s] %s\n", FormatWallTime(r.wallNs).c_str(),
+                            r.pid, r.tid, LevelName(r.level), r.text.c_str());
+                return;
+            }
+            std::printf("[%s] [PID:%u][TID:%u] [%s] %s (%s:%d)\n", FormatWallTime(r.wallNs).c_str(),
+                        r.pid, r.tid, LevelName(r.level), r.text.c_str(), r.file.c_str(), r.line);
+        });
+        if (!ok) {
+            std::fprintf(stderr, "%s: 文件头无效或尾部不完整，已输出可解码部分\n", argv[i]);
+            if (rc == 0) rc = 2;
+        }
+    }
+    return rc;
+}